@@ -0,0 +1,682 @@
+//! Headless benchmarks for the desktop client's hot paths
+//!
+//! Everything here runs without a window or GPU: pure functions are called directly and
+//! ECS work goes through an `App` built from Bevy's `MinimalPlugins`. Fixtures are
+//! deterministic so results are comparable between runs. Use `cargo xtask bench` to save
+//! a baseline and flag regressions against it.
+
+use bevy::ecs::system::Deferred;
+use bevy::prelude::*;
+use criterion::{BatchSize, BenchmarkId, Criterion, Throughput, criterion_group, criterion_main};
+use std::hint::black_box;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::mpsc;
+use std::time::Instant;
+
+use iotcraft_desktop_client::console::command_parser::CommandParser;
+use iotcraft_desktop_client::devices::{DeviceIndex, DeviceType};
+use iotcraft_desktop_client::environment::{
+    BlockType, VoxelEdits, VoxelEditsPlugin, VoxelSet, VoxelWorld,
+};
+use iotcraft_desktop_client::inventory::{PlaceBlockEvent, PlayerInventory};
+use iotcraft_desktop_client::minimap::{MinimapDevice, generate_minimap_texture_sync};
+use iotcraft_desktop_client::mqtt::core_service::route_incoming_message;
+use iotcraft_desktop_client::multiplayer::{PoseMessage, SharedWorldInfo, chunk_world_data};
+use iotcraft_desktop_client::player_controller::check_voxel_collision;
+use iotcraft_desktop_client::script::script_compiler::{ScriptCache, compile_script};
+use iotcraft_desktop_client::world::world_systems::{load_world_save, store_world_save};
+use iotcraft_desktop_client::world::{
+    VoxelBlockData, WorldMetadata, WorldSaveData, parse_template_file,
+};
+
+/// Small linear congruential generator so fixtures are identical on every run
+struct Lcg(u64);
+
+impl Lcg {
+    fn next_u32(&mut self) -> u32 {
+        self.0 = self
+            .0
+            .wrapping_mul(6364136223846793005)
+            .wrapping_add(1442695040888963407);
+        (self.0 >> 33) as u32
+    }
+
+    fn range(&mut self, min: i32, max: i32) -> i32 {
+        min + (self.next_u32() % (max - min + 1) as u32) as i32
+    }
+}
+
+/// Flat grass plain of `(2 * radius + 1)^2` blocks with scattered stone pillars on top
+fn terrain(radius: i32) -> VoxelWorld {
+    let mut world = VoxelWorld::default();
+    world.generate_flat_terrain(radius, 0);
+    let mut rng = Lcg(42);
+    for _ in 0..(radius * radius / 8).max(1) {
+        let (x, z) = (rng.range(-radius, radius), rng.range(-radius, radius));
+        for y in 1..=rng.range(1, 4) {
+            world.set_block(IVec3::new(x, y, z), BlockType::Stone);
+        }
+    }
+    world
+}
+
+fn save_data(world: &VoxelWorld) -> WorldSaveData {
+    let mut blocks: Vec<VoxelBlockData> = world
+        .blocks
+        .iter()
+        .map(|(pos, block_type)| VoxelBlockData {
+            x: pos.x,
+            y: pos.y,
+            z: pos.z,
+            block_type: *block_type,
+        })
+        .collect();
+    blocks.sort_by_key(|b| (b.x, b.y, b.z));
+    WorldSaveData {
+        metadata: WorldMetadata {
+            name: "bench_world".to_string(),
+            description: "Benchmark fixture".to_string(),
+            created_at: "2025-01-01T00:00:00Z".to_string(),
+            last_played: "2025-01-01T00:00:00Z".to_string(),
+            version: "1.0.0".to_string(),
+        },
+        blocks,
+        player_position: Vec3::new(0.0, 3.0, 0.0),
+        player_rotation: Quat::IDENTITY,
+        inventory: PlayerInventory::new(),
+    }
+}
+
+fn voxel_world(c: &mut Criterion) {
+    let mut group = c.benchmark_group("voxel_world");
+    let positions: Vec<IVec3> = {
+        let mut rng = Lcg(7);
+        (0..4096)
+            .map(|_| IVec3::new(rng.range(-64, 64), rng.range(0, 16), rng.range(-64, 64)))
+            .collect()
+    };
+    group.throughput(Throughput::Elements(positions.len() as u64));
+
+    group.bench_function("set_block", |b| {
+        b.iter_batched_ref(
+            VoxelWorld::default,
+            |world| {
+                for pos in &positions {
+                    world.set_block(*pos, BlockType::Stone);
+                }
+            },
+            BatchSize::SmallInput,
+        )
+    });
+
+    let filled = terrain(64);
+    group.bench_function("is_block_at", |b| {
+        b.iter(|| {
+            positions
+                .iter()
+                .filter(|pos| filled.is_block_at(**pos))
+                .count()
+        })
+    });
+
+    group.bench_function("remove_block", |b| {
+        b.iter_batched_ref(
+            || {
+                let mut world = VoxelWorld::default();
+                for pos in &positions {
+                    world.set_block(*pos, BlockType::Dirt);
+                }
+                world
+            },
+            |world| {
+                for pos in &positions {
+                    black_box(world.remove_block(pos));
+                }
+            },
+            BatchSize::SmallInput,
+        )
+    });
+    group.finish();
+}
+
+fn collision(c: &mut Criterion) {
+    let world = terrain(64);
+    let mut rng = Lcg(11);
+    let probes: Vec<Vec3> = (0..1024)
+        .map(|_| {
+            Vec3::new(
+                rng.range(-6400, 6400) as f32 / 100.0,
+                rng.range(100, 600) as f32 / 100.0,
+                rng.range(-6400, 6400) as f32 / 100.0,
+            )
+        })
+        .collect();
+
+    let mut group = c.benchmark_group("collision");
+    group.throughput(Throughput::Elements(probes.len() as u64));
+    group.bench_function("check_voxel_collision", |b| {
+        b.iter(|| {
+            probes
+                .iter()
+                .filter(|pos| check_voxel_collision(**pos, 1.8, 0.4, &world))
+                .count()
+        })
+    });
+    group.finish();
+}
+
+/// Id lookups, minimap-sized proximity queries and cursor picks over announced devices,
+/// through [`DeviceIndex`] and by scanning every device as the systems used to
+fn device_index(c: &mut Criterion) {
+    let mut group = c.benchmark_group("device_index");
+    for count in [100u32, 5000] {
+        let mut world = World::new();
+        let mut rng = Lcg(23);
+        let mut index = DeviceIndex::default();
+        let devices: Vec<(String, Entity, Vec3)> = (0..count)
+            .map(|i| {
+                let position = Vec3::new(
+                    rng.range(-500, 500) as f32,
+                    rng.range(0, 4) as f32 + 0.5,
+                    rng.range(-500, 500) as f32,
+                );
+                (format!("device_{}", i), world.spawn_empty().id(), position)
+            })
+            .collect();
+        for (device_id, entity, position) in &devices {
+            index.insert(device_id, *entity, *position);
+        }
+        let probes: Vec<Ray3d> = (0..64)
+            .map(|_| {
+                let origin = Vec3::new(
+                    rng.range(-400, 400) as f32,
+                    2.0,
+                    rng.range(-400, 400) as f32,
+                );
+                let direction = Vec3::new(rng.range(-100, 100) as f32, -5.0, 100.0);
+                Ray3d::new(origin, Dir3::new(direction).unwrap())
+            })
+            .collect();
+        let lookup_id = format!("device_{}", count / 2);
+
+        group.bench_function(BenchmarkId::new("lookup/scan", count), |b| {
+            b.iter(|| {
+                devices
+                    .iter()
+                    .find(|(id, ..)| *id == lookup_id)
+                    .map(|d| d.1)
+            })
+        });
+        group.bench_function(BenchmarkId::new("lookup/index", count), |b| {
+            b.iter(|| index.get(black_box(&lookup_id)))
+        });
+        group.bench_function(BenchmarkId::new("square/scan", count), |b| {
+            b.iter(|| {
+                probes
+                    .iter()
+                    .map(|ray| {
+                        devices
+                            .iter()
+                            .filter(|(_, _, p)| {
+                                (p.x - ray.origin.x).abs() <= 25.0
+                                    && (p.z - ray.origin.z).abs() <= 25.0
+                            })
+                            .count()
+                    })
+                    .sum::<usize>()
+            })
+        });
+        group.bench_function(BenchmarkId::new("square/index", count), |b| {
+            b.iter(|| {
+                probes
+                    .iter()
+                    .map(|ray| index.within_square(ray.origin, 25.0).len())
+                    .sum::<usize>()
+            })
+        });
+        group.bench_function(BenchmarkId::new("ray/scan", count), |b| {
+            b.iter(|| {
+                probes
+                    .iter()
+                    .filter_map(|ray| {
+                        devices
+                            .iter()
+                            .filter_map(|(_, entity, p)| {
+                                let projection = (*p - ray.origin).dot(*ray.direction);
+                                let closest = ray.origin + ray.direction * projection;
+                                (projection >= 0.0 && closest.distance(*p) <= 0.7)
+                                    .then_some((*entity, projection))
+                            })
+                            .min_by(|a, b| a.1.total_cmp(&b.1))
+                    })
+                    .count()
+            })
+        });
+        group.bench_function(BenchmarkId::new("ray/index", count), |b| {
+            b.iter(|| {
+                probes
+                    .iter()
+                    .filter_map(|ray| index.ray_cast(*ray, 0.7, |_| true))
+                    .count()
+            })
+        });
+    }
+    group.finish();
+}
+
+fn minimap(c: &mut Criterion) {
+    let world = terrain(64);
+    let devices: Vec<MinimapDevice> = (0..16)
+        .map(|i| MinimapDevice {
+            position: Vec3::new((i * 7 - 56) as f32, 1.0, (i * 5 - 40) as f32),
+            device_type: if i % 2 == 0 {
+                DeviceType::Lamp
+            } else {
+                DeviceType::Door
+            },
+            is_on: i % 3 == 0,
+        })
+        .collect();
+
+    let mut group = c.benchmark_group("minimap");
+    for texture_size in [128u32, 256] {
+        group.bench_with_input(
+            BenchmarkId::new("generate_texture", texture_size),
+            &texture_size,
+            |b, &texture_size| {
+                b.iter_batched(
+                    || (world.blocks.clone(), devices.clone()),
+                    |(blocks, devices)| {
+                        generate_minimap_texture_sync(
+                            blocks,
+                            devices,
+                            Vec3::new(3.5, 2.0, -4.5),
+                            Some(0.7),
+                            texture_size,
+                            48,
+                        )
+                    },
+                    BatchSize::LargeInput,
+                )
+            },
+        );
+    }
+    group.finish();
+}
+
+fn world_chunking(c: &mut Criterion) {
+    let mut group = c.benchmark_group("world_chunking");
+    for radius in [32, 96] {
+        let data = save_data(&terrain(radius));
+        group.throughput(Throughput::Elements(data.blocks.len() as u64));
+        group.bench_with_input(
+            BenchmarkId::new("chunk_world_data", data.blocks.len()),
+            &data,
+            |b, data| b.iter(|| chunk_world_data(data, "bench_world").unwrap()),
+        );
+    }
+    group.finish();
+}
+
+fn mqtt_routing(c: &mut Criterion) {
+    let (temp_tx, temp_rx) = mpsc::channel();
+    let (device_tx, device_rx) = mpsc::channel();
+    let (pose_tx, pose_rx) = mpsc::channel();
+    let (world_discovery_tx, world_discovery_rx) = mpsc::channel();
+    let (world_data_tx, world_data_rx) = mpsc::channel();
+    let (block_change_tx, block_change_rx) = mpsc::channel();
+
+    let pose = serde_json::to_vec(&PoseMessage {
+        player_id: "bob".to_string(),
+        player_name: "Bob".to_string(),
+        pos: [1.5, 2.0, -3.25],
+        yaw: 0.5,
+        pitch: -0.1,
+        ts: 1_700_000_000_000,
+    })
+    .unwrap();
+    let block = serde_json::to_vec(&serde_json::json!({
+        "player_id": "bob",
+        "player_name": "Bob",
+        "change": { "Placed": { "x": 5, "y": 2, "z": -7, "block_type": "Stone" } },
+    }))
+    .unwrap();
+    let info = serde_json::to_vec(&SharedWorldInfo {
+        world_id: "bench_world".to_string(),
+        world_name: "Bench World".to_string(),
+        description: "Benchmark fixture".to_string(),
+        host_player: "bob".to_string(),
+        host_name: "Bob".to_string(),
+        created_at: "2025-01-01T00:00:00Z".to_string(),
+        last_updated: "2025-01-01T00:00:00Z".to_string(),
+        player_count: 1,
+        max_players: 4,
+        is_public: true,
+        version: "1.0.0".to_string(),
+    })
+    .unwrap();
+    let data = serde_json::to_vec(&save_data(&terrain(32))).unwrap();
+
+    let messages: [(&str, &str, &[u8]); 6] = [
+        ("temperature", "home/sensor/temperature", b"21.5"),
+        (
+            "device_announce",
+            "devices/announce",
+            br#"{"device_id":"lamp-1","device_type":"lamp"}"#,
+        ),
+        (
+            "pose",
+            "iotcraft/worlds/bench_world/players/bob/pose",
+            &pose,
+        ),
+        (
+            "block_change",
+            "iotcraft/worlds/bench_world/state/blocks/placed",
+            &block,
+        ),
+        ("world_info", "iotcraft/worlds/bench_world/info", &info),
+        ("world_data", "iotcraft/worlds/bench_world/data", &data),
+    ];
+
+    let mut group = c.benchmark_group("mqtt_routing");
+    for (name, topic, payload) in messages {
+        group.throughput(Throughput::Bytes(payload.len() as u64));
+        group.bench_function(name, |b| {
+            b.iter(|| {
+                route_incoming_message(
+                    topic,
+                    black_box(payload),
+                    &temp_tx,
+                    &device_tx,
+                    &pose_tx,
+                    &world_discovery_tx,
+                    &world_data_tx,
+                    &block_change_tx,
+                    "alice",
+                );
+                // Keep the channels empty so every iteration does the same work
+                temp_rx.try_iter().for_each(drop);
+                device_rx.try_iter().for_each(drop);
+                pose_rx.try_iter().for_each(drop);
+                world_discovery_rx.try_iter().for_each(drop);
+                world_data_rx.try_iter().for_each(drop);
+                block_change_rx.try_iter().for_each(drop);
+            })
+        });
+    }
+    group.finish();
+}
+
+fn templates(c: &mut Criterion) {
+    let template_dir = concat!(env!("CARGO_MANIFEST_DIR"), "/scripts/world_templates");
+    let mut group = c.benchmark_group("templates");
+    for name in ["default", "medieval", "modern"] {
+        let path = format!("{}/{}.txt", template_dir, name);
+        group.bench_function(name, |b| b.iter(|| parse_template_file(&path).unwrap()));
+    }
+    group.finish();
+}
+
+fn world_save(c: &mut Criterion) {
+    let dir = tempfile::tempdir().unwrap();
+    let mut group = c.benchmark_group("world_save");
+    group.sample_size(20);
+    for radius in [32, 96] {
+        let data = save_data(&terrain(radius));
+        let path = dir.path().join(format!("world_{}.json", radius));
+        store_world_save(&path, &data).unwrap();
+        group.throughput(Throughput::Elements(data.blocks.len() as u64));
+        group.bench_with_input(
+            BenchmarkId::new("store", data.blocks.len()),
+            &data,
+            |b, data| b.iter(|| store_world_save(&path, data).unwrap()),
+        );
+        group.bench_with_input(
+            BenchmarkId::new("load", data.blocks.len()),
+            &path,
+            |b, path| b.iter(|| load_world_save(path).unwrap()),
+        );
+    }
+    group.finish();
+}
+
+#[derive(Resource)]
+struct EditCursor(Lcg);
+
+/// Place and remove a batch of blocks per frame, like a busy multiplayer session
+fn edit_blocks(mut cursor: ResMut<EditCursor>, mut voxel_world: ResMut<VoxelWorld>) {
+    for _ in 0..64 {
+        let pos = IVec3::new(
+            cursor.0.range(-64, 64),
+            cursor.0.range(1, 8),
+            cursor.0.range(-64, 64),
+        );
+        if voxel_world.remove_block(&pos).is_none() {
+            voxel_world.set_block(pos, BlockType::Stone);
+        }
+    }
+}
+
+fn app_update(c: &mut Criterion) {
+    let mut app = App::new();
+    app.add_plugins(MinimalPlugins)
+        .insert_resource(terrain(64))
+        .insert_resource(EditCursor(Lcg(3)))
+        .add_systems(Update, edit_blocks);
+    app.update();
+
+    let mut group = c.benchmark_group("app");
+    group.bench_function("update_with_block_edits", |b| b.iter(|| app.update()));
+    group.finish();
+}
+
+/// Run time of the schedule benchmark's systems, in nanoseconds
+static BUSY_NANOS: AtomicU64 = AtomicU64::new(0);
+
+/// Adds the time until it is dropped to [`BUSY_NANOS`]
+struct BusyTimer(Instant);
+
+impl Drop for BusyTimer {
+    fn drop(&mut self) {
+        BUSY_NANOS.fetch_add(self.0.elapsed().as_nanos() as u64, Ordering::Relaxed);
+    }
+}
+
+/// The 256 positions a producer edits in `frame`; pairs of frames place then remove them
+fn edit_batch(seed: u64, frame: u64) -> impl Iterator<Item = (IVec3, bool)> {
+    let mut rng = Lcg(seed * 7919 + frame / 2);
+    let place = frame % 2 == 0;
+    (0..256).map(move |_| {
+        let pos = IVec3::new(rng.range(-64, 64), rng.range(1, 8), rng.range(-64, 64));
+        (pos, place)
+    })
+}
+
+/// Edit producer in the old layout, holding the world mutably while it runs
+fn produce_edits_direct<const SEED: u64>(
+    mut frame: Local<u64>,
+    mut voxel_world: ResMut<VoxelWorld>,
+) {
+    let _busy = BusyTimer(Instant::now());
+    *frame += 1;
+    for (pos, place) in edit_batch(SEED, *frame) {
+        if place {
+            voxel_world.set_block(pos, BlockType::Stone);
+        } else {
+            voxel_world.remove_block(&pos);
+        }
+    }
+}
+
+/// The same producer queueing its edits for `apply_voxel_edits`
+fn produce_edits_queued<const SEED: u64>(mut frame: Local<u64>, mut edits: Deferred<VoxelEdits>) {
+    let _busy = BusyTimer(Instant::now());
+    *frame += 1;
+    for (pos, place) in edit_batch(SEED, *frame) {
+        if place {
+            edits.place(pos, BlockType::Stone);
+        } else {
+            edits.remove(pos);
+        }
+    }
+}
+
+/// Read-only consumer doing point lookups, like collision, raycasts and the minimap
+fn probe_world<const SEED: u64>(mut frame: Local<u64>, voxel_world: Res<VoxelWorld>) {
+    let _busy = BusyTimer(Instant::now());
+    *frame += 1;
+    let mut rng = Lcg(SEED * 104729 + *frame);
+    let mut solid = 0;
+    for _ in 0..8192 {
+        let pos = IVec3::new(rng.range(-64, 64), rng.range(0, 4), rng.range(-64, 64));
+        solid += voxel_world.is_block_at(pos) as u32;
+    }
+    black_box(solid);
+}
+
+/// Update schedule as it was: producers borrow the world mutably, unordered with readers
+fn serialized_schedule_app() -> App {
+    let mut app = App::new();
+    app.add_plugins(MinimalPlugins)
+        .insert_resource(terrain(64))
+        .add_systems(
+            Update,
+            (
+                produce_edits_direct::<1>,
+                produce_edits_direct::<2>,
+                produce_edits_direct::<3>,
+                probe_world::<1>,
+                probe_world::<2>,
+                probe_world::<3>,
+                probe_world::<4>,
+            ),
+        );
+    app
+}
+
+/// Update schedule with producers queueing edits and readers in `VoxelSet::Read`
+fn split_schedule_app() -> App {
+    let mut app = App::new();
+    app.add_plugins((MinimalPlugins, VoxelEditsPlugin))
+        .insert_resource(terrain(64))
+        .add_systems(
+            Update,
+            (
+                produce_edits_queued::<1>,
+                produce_edits_queued::<2>,
+                produce_edits_queued::<3>,
+            )
+                .in_set(VoxelSet::Edit),
+        )
+        .add_systems(
+            Update,
+            (
+                probe_world::<1>,
+                probe_world::<2>,
+                probe_world::<3>,
+                probe_world::<4>,
+            )
+                .in_set(VoxelSet::Read),
+        );
+    app
+}
+
+/// Busy system time per unit of wall time over `frames` updates; 1.0 means the
+/// benchmark's systems effectively ran one at a time
+fn parallel_utilization(app: &mut App, frames: u32) -> f64 {
+    app.update();
+    BUSY_NANOS.store(0, Ordering::Relaxed);
+    let start = Instant::now();
+    for _ in 0..frames {
+        app.update();
+    }
+    BUSY_NANOS.load(Ordering::Relaxed) as f64 / start.elapsed().as_nanos() as f64
+}
+
+fn schedule_layout(c: &mut Criterion) {
+    let mut group = c.benchmark_group("schedule");
+    for (name, mut app) in [
+        ("serialized", serialized_schedule_app()),
+        ("split", split_schedule_app()),
+    ] {
+        println!(
+            "schedule/{}: parallel utilization {:.2}",
+            name,
+            parallel_utilization(&mut app, 200)
+        );
+        group.bench_function(name, |b| b.iter(|| app.update()));
+    }
+    group.finish();
+}
+
+/// Startup scripts run line by line through the console parser versus compiled into
+/// merged region edits, cold and from the cache
+fn scripts(c: &mut Criterion) {
+    let scripts_dir = concat!(env!("CARGO_MANIFEST_DIR"), "/scripts");
+    let mut group = c.benchmark_group("scripts");
+    for name in ["house", "background_world", "world_templates/default"] {
+        let source = std::fs::read_to_string(format!("{}/{}.txt", scripts_dir, name)).unwrap();
+        let label = name.rsplit('/').next().unwrap();
+
+        group.bench_function(BenchmarkId::new("line_by_line", label), |b| {
+            b.iter_batched(
+                || {
+                    let mut world = World::new();
+                    world.init_resource::<VoxelWorld>();
+                    world.init_resource::<Events<PlaceBlockEvent>>();
+                    world
+                },
+                |mut world| {
+                    let mut parser = CommandParser::new();
+                    for line in source.lines() {
+                        let line = line.trim();
+                        if !line.is_empty() && !line.starts_with('#') {
+                            black_box(parser.parse_command(line, &mut world));
+                        }
+                    }
+                    world
+                },
+                BatchSize::SmallInput,
+            )
+        });
+        group.bench_function(BenchmarkId::new("compiled", label), |b| {
+            b.iter_batched(
+                VoxelWorld::default,
+                |mut voxel_world| {
+                    let edits = compile_script(&source).execute(&mut voxel_world);
+                    (voxel_world, edits)
+                },
+                BatchSize::SmallInput,
+            )
+        });
+        let mut cache = ScriptCache::default();
+        cache.compile(&source);
+        group.bench_function(BenchmarkId::new("cached", label), |b| {
+            b.iter_batched(
+                VoxelWorld::default,
+                |mut voxel_world| {
+                    let edits = cache.compile(&source).execute(&mut voxel_world);
+                    (voxel_world, edits)
+                },
+                BatchSize::SmallInput,
+            )
+        });
+    }
+    group.finish();
+}
+
+criterion_group!(
+    benches,
+    voxel_world,
+    collision,
+    device_index,
+    minimap,
+    world_chunking,
+    mqtt_routing,
+    templates,
+    world_save,
+    app_update,
+    schedule_layout,
+    scripts
+);
+criterion_main!(benches);
@@ -122,6 +122,50 @@ enum Commands {
     TestSuite,
     /// Interactive mode
     Interactive,
+    /// Measure tool calls per second with pipelined requests
+    Bench {
+        /// Tool to call: place_block, or ping for the protocol overhead alone
+        #[arg(long, default_value = "place_block")]
+        tool: String,
+        /// Total tool calls
+        #[arg(long, default_value = "10000")]
+        calls: usize,
+        /// Calls in flight per connection; 1 waits for each response before the next call
+        #[arg(long, default_value = "64")]
+        pipeline: usize,
+        /// Connections the calls are spread over
+        #[arg(long, default_value = "1")]
+        connections: usize,
+        /// Then place the same blocks again with a single place_blocks call and compare
+        #[arg(long)]
+        bulk: bool,
+        /// File to write the JSON results to (optional)
+        #[arg(long)]
+        output: Option<String>,
+    },
+}
+
+#[derive(Debug, Serialize, Deserialize)]
+struct BenchReport {
+    timestamp: String,
+    server_address: String,
+    tool: String,
+    calls: usize,
+    pipeline: usize,
+    connections: usize,
+    completed: usize,
+    errors: usize,
+    duration_ms: u64,
+    calls_per_sec: f64,
+    latency_ms_p50: f64,
+    latency_ms_p90: f64,
+    latency_ms_p99: f64,
+    latency_ms_max: f64,
+    /// Duration of the single place_blocks call covering the same positions, with --bulk
+    #[serde(skip_serializing_if = "Option::is_none")]
+    bulk_duration_ms: Option<f64>,
+    #[serde(skip_serializing_if = "Option::is_none")]
+    bulk_speedup: Option<f64>,
 }
 
 #[cfg(not(target_arch = "wasm32"))]
@@ -160,6 +204,25 @@ async fn main() -> Result<(), Box<dyn std::error::Error>> {
         } => test_spawn_device(&server_addr, &device_id, &device_type, x, y, z).await?,
         Commands::TestSuite => test_suite(&server_addr).await?,
         Commands::Interactive => interactive_mode(&server_addr).await?,
+        Commands::Bench {
+            tool,
+            calls,
+            pipeline,
+            connections,
+            bulk,
+            output,
+        } => {
+            run_bench(
+                &server_addr,
+                &tool,
+                calls,
+                pipeline,
+                connections,
+                bulk,
+                output.as_deref(),
+            )
+            .await?
+        }
     }
 
     Ok(())
@@ -927,6 +990,233 @@ async fn send_request_quiet(
     Ok(response)
 }
 
+/// Position of benchmark block `index`; blocks go to distinct positions above ground
+#[cfg(not(target_arch = "wasm32"))]
+fn bench_position(index: usize) -> [i32; 3] {
+    [
+        (index % 64) as i32,
+        20 + ((index / 4096) % 8) as i32,
+        ((index / 64) % 64) as i32,
+    ]
+}
+
+/// Tool call number `index` of a benchmark
+#[cfg(not(target_arch = "wasm32"))]
+fn bench_request(tool: &str, index: usize) -> Value {
+    let arguments = match tool {
+        "place_block" => {
+            let [x, y, z] = bench_position(index);
+            json!({"block_type": "stone", "x": x, "y": y, "z": z})
+        }
+        _ => json!({}),
+    };
+    json!({
+        "jsonrpc": "2.0",
+        "id": index,
+        "method": "tools/call",
+        "params": {"name": tool, "arguments": arguments}
+    })
+}
+
+/// Send `count` calls over one connection, keeping up to `pipeline` in flight, and
+/// return their latencies in milliseconds and the number of error responses
+#[cfg(not(target_arch = "wasm32"))]
+async fn bench_connection(
+    server_addr: String,
+    tool: String,
+    first: usize,
+    count: usize,
+    pipeline: usize,
+) -> Result<(Vec<f64>, usize), String> {
+    use std::sync::{Arc, Mutex};
+
+    let stream = TcpStream::connect(&server_addr)
+        .await
+        .map_err(|e| e.to_string())?;
+    let (reader, mut writer) = stream.into_split();
+    let sent_at = Arc::new(Mutex::new(HashMap::<u64, Instant>::new()));
+    let window = Arc::new(tokio::sync::Semaphore::new(pipeline.max(1)));
+
+    let reader_sent_at = sent_at.clone();
+    let reader_window = window.clone();
+    let responses = tokio::spawn(async move {
+        let mut reader = BufReader::new(reader);
+        let mut latencies = Vec::with_capacity(count);
+        let mut errors = 0;
+        while latencies.len() < count {
+            let mut line = String::new();
+            match tokio::time::timeout(Duration::from_secs(60), reader.read_line(&mut line)).await {
+                Ok(Ok(0)) => return Err("Server closed the connection".to_string()),
+                Ok(Ok(_)) => {}
+                Ok(Err(e)) => return Err(e.to_string()),
+                Err(_) => return Err("No response within 60 s".to_string()),
+            }
+            let response: Value = serde_json::from_str(line.trim()).map_err(|e| e.to_string())?;
+            let sent = response["id"]
+                .as_u64()
+                .and_then(|id| reader_sent_at.lock().unwrap().remove(&id));
+            let Some(sent) = sent else {
+                errors += 1;
+                continue;
+            };
+            latencies.push(sent.elapsed().as_secs_f64() * 1000.0);
+            if response.get("error").is_some() || response["result"]["is_error"] == json!(true) {
+                errors += 1;
+            }
+            reader_window.add_permits(1);
+        }
+        Ok((latencies, errors))
+    });
+
+    for index in first..first + count {
+        window.acquire().await.map_err(|e| e.to_string())?.forget();
+        let line = format!("{}\n", bench_request(&tool, index));
+        sent_at.lock().unwrap().insert(index as u64, Instant::now());
+        writer
+            .write_all(line.as_bytes())
+            .await
+            .map_err(|e| e.to_string())?;
+    }
+    responses.await.map_err(|e| e.to_string())?
+}
+
+/// Place the first `calls` benchmark positions with one place_blocks call and return
+/// how long it took in milliseconds. Uses a different block type than the single
+/// calls so every position is a real edit rather than a no-op.
+#[cfg(not(target_arch = "wasm32"))]
+async fn bench_bulk(server_addr: &str, calls: usize) -> Result<f64, Box<dyn std::error::Error>> {
+    let positions: Vec<i32> = (0..calls).flat_map(bench_position).collect();
+    let request = json!({
+        "jsonrpc": "2.0",
+        "id": 1,
+        "method": "tools/call",
+        "params": {
+            "name": "place_blocks",
+            "arguments": {"block_type": "dirt", "positions": positions}
+        }
+    });
+    let line = format!("{}\n", request);
+
+    let stream = TcpStream::connect(server_addr).await?;
+    let (reader, mut writer) = stream.into_split();
+    let mut reader = BufReader::new(reader);
+    let start_time = Instant::now();
+    writer.write_all(line.as_bytes()).await?;
+    let mut response_line = String::new();
+    tokio::time::timeout(
+        Duration::from_secs(60),
+        reader.read_line(&mut response_line),
+    )
+    .await??;
+    let elapsed = start_time.elapsed();
+
+    let response: Value = serde_json::from_str(response_line.trim())?;
+    if response.get("error").is_some() || response["result"]["is_error"] == json!(true) {
+        return Err(format!("place_blocks failed: {}", response).into());
+    }
+    Ok(elapsed.as_secs_f64() * 1000.0)
+}
+
+#[cfg(not(target_arch = "wasm32"))]
+async fn run_bench(
+    server_addr: &str,
+    tool: &str,
+    calls: usize,
+    pipeline: usize,
+    connections: usize,
+    bulk: bool,
+    output_file: Option<&str>,
+) -> Result<(), Box<dyn std::error::Error>> {
+    if bulk && tool != "place_block" {
+        return Err("--bulk compares against place_block calls".into());
+    }
+    let connections = connections.max(1);
+    println!(
+        "⏱️  Benchmarking {} x {} over {} connection(s), {} in flight each...",
+        calls, tool, connections, pipeline
+    );
+
+    let start_time = Instant::now();
+    let handles: Vec<_> = (0..connections)
+        .map(|connection| {
+            let first = calls * connection / connections;
+            let count = calls * (connection + 1) / connections - first;
+            tokio::spawn(bench_connection(
+                server_addr.to_string(),
+                tool.to_string(),
+                first,
+                count,
+                pipeline,
+            ))
+        })
+        .collect();
+    let mut latencies = Vec::with_capacity(calls);
+    let mut errors = 0;
+    for handle in handles {
+        let (connection_latencies, connection_errors) = handle.await??;
+        latencies.extend(connection_latencies);
+        errors += connection_errors;
+    }
+    let elapsed = start_time.elapsed();
+
+    let bulk_duration_ms = if bulk {
+        Some(bench_bulk(server_addr, calls).await?)
+    } else {
+        None
+    };
+
+    latencies.sort_by(f64::total_cmp);
+    let percentile = |q: f64| {
+        if latencies.is_empty() {
+            return 0.0;
+        }
+        latencies[((latencies.len() - 1) as f64 * q).round() as usize]
+    };
+    let report = BenchReport {
+        timestamp: chrono::Utc::now().to_rfc3339(),
+        server_address: server_addr.to_string(),
+        tool: tool.to_string(),
+        calls,
+        pipeline,
+        connections,
+        completed: latencies.len(),
+        errors,
+        duration_ms: elapsed.as_millis() as u64,
+        calls_per_sec: latencies.len() as f64 / elapsed.as_secs_f64().max(1e-9),
+        latency_ms_p50: percentile(0.5),
+        latency_ms_p90: percentile(0.9),
+        latency_ms_p99: percentile(0.99),
+        latency_ms_max: percentile(1.0),
+        bulk_duration_ms,
+        bulk_speedup: bulk_duration_ms
+            .map(|bulk_ms| elapsed.as_secs_f64() * 1000.0 / bulk_ms.max(1e-3)),
+    };
+
+    println!("\n📊 MCP Benchmark");
+    println!("===============");
+    println!(
+        "{} calls in {} ms: {:.0} calls/s ({} errors)",
+        report.completed, report.duration_ms, report.calls_per_sec, report.errors
+    );
+    println!(
+        "Latency: p50 {:.2} ms, p90 {:.2} ms, p99 {:.2} ms, max {:.2} ms",
+        report.latency_ms_p50, report.latency_ms_p90, report.latency_ms_p99, report.latency_ms_max
+    );
+    if let (Some(bulk_ms), Some(speedup)) = (report.bulk_duration_ms, report.bulk_speedup) {
+        println!(
+            "Bulk: one place_blocks call for the same {} blocks in {:.2} ms ({:.1}x faster)",
+            calls, bulk_ms, speedup
+        );
+    }
+
+    if let Some(output_path) = output_file {
+        fs::write(output_path, serde_json::to_string_pretty(&report)?)?;
+        println!("\n📄 Results written to: {}", output_path);
+    }
+
+    Ok(())
+}
+
 fn print_text_report(report: &TestReport) {
     println!("\n🧪 MCP Test Report");
     println!("==================");
@@ -63,6 +63,10 @@ impl CommandParser {
             "blink" => self.handle_blink_command(args, world),
             "mqtt" => self.handle_mqtt_command(args, world),
             "test_error" => self.handle_test_error_command(args, world),
+            "memory" => self.handle_memory_command(args, world),
+            "lod" => self.handle_lod_command(args, world),
+            #[cfg(not(target_arch = "wasm32"))]
+            "profile" => self.handle_profile_command(args, world),
             // Inventory and environment commands (desktop only due to dependencies)
             #[cfg(not(target_arch = "wasm32"))]
             "place" => self.handle_place_command(args, world),
@@ -137,7 +141,8 @@ impl CommandParser {
             | "place"
             | "remove"
             | "wall"
-            | "give" => ConsoleResult::Success(format!(
+            | "give"
+            | "profile" => ConsoleResult::Success(format!(
                 "{} command is not available in web version",
                 command
             )),
@@ -175,6 +180,9 @@ impl CommandParser {
             "  move <device_id> <x> <y> <z> - Move a device",
             "  list - List all connected devices",
             "  test_error <message> - Test error indicator",
+            "  memory [trim] - Show memory usage, or free pooled buffers",
+            "  lod [on|off|distance <blocks>|bench [radius]] - Chunk level of detail",
+            "  profile [on|off|capture <frames> [file]] - Profiler panel (F6) and Chrome traces",
             "",
             "World management commands:",
             "  create_world <world_name> [description] - Create a new world and switch to it",
@@ -274,6 +282,121 @@ impl CommandParser {
         }
     }
 
+    fn handle_memory_command(&self, args: &[&str], world: &mut World) -> ConsoleResult {
+        match args {
+            [] => match world.get_resource::<crate::memory_governor::MemoryStats>() {
+                Some(stats) => ConsoleResult::Success(stats.report()),
+                None => ConsoleResult::Error("Memory governor is not running".to_string()),
+            },
+            ["trim"] => {
+                let freed = crate::memory_governor::message_pool_stats().pooled_bytes;
+                crate::memory_governor::trim_message_pool();
+                ConsoleResult::Success(format!("Freed {} bytes of pooled buffers", freed))
+            }
+            _ => ConsoleResult::InvalidArgs("Usage: memory [trim]".to_string()),
+        }
+    }
+
+    fn handle_lod_command(&self, args: &[&str], world: &mut World) -> ConsoleResult {
+        use crate::world::chunk_lod::{ChunkLodSettings, ChunkLodStats, LodBenchmark};
+
+        let Some(mut settings) = world.get_resource::<ChunkLodSettings>().cloned() else {
+            return ConsoleResult::Error("Chunk LOD is not running".to_string());
+        };
+        let message = match args {
+            [] => {
+                let stats = world.get_resource::<ChunkLodStats>().cloned();
+                return ConsoleResult::Success(stats.unwrap_or_default().report(&settings));
+            }
+            ["on"] | ["off"] => {
+                settings.enabled = args[0] == "on";
+                format!("Chunk LOD {}", args[0])
+            }
+            ["distance", distance] => match distance.parse::<f32>() {
+                Ok(distance) if distance > 0.0 => {
+                    settings.lod_distance = distance;
+                    format!("Chunk LOD starts at {} blocks", distance)
+                }
+                _ => return ConsoleResult::InvalidArgs("Invalid distance".to_string()),
+            },
+            ["bench"] | ["bench", _] => {
+                let radius = match args.get(1).map(|r| r.parse::<i32>()) {
+                    None => 8,
+                    Some(Ok(radius)) if radius > 0 => radius,
+                    Some(_) => return ConsoleResult::InvalidArgs("Invalid radius".to_string()),
+                };
+                let Some(mut benchmark) = world.get_resource_mut::<LodBenchmark>() else {
+                    return ConsoleResult::Error("Chunk LOD is not running".to_string());
+                };
+                if benchmark.is_running() {
+                    return ConsoleResult::Error("LOD benchmark already running".to_string());
+                }
+                benchmark.start(radius);
+                return ConsoleResult::Success(format!(
+                    "LOD benchmark started ({} chunk radius, chunk meshes only); the world is \
+                     restored when it finishes, results follow in the log and `lod`",
+                    radius
+                ));
+            }
+            _ => {
+                return ConsoleResult::InvalidArgs(
+                    "Usage: lod [on|off|distance <blocks>|bench [radius]]".to_string(),
+                );
+            }
+        };
+        world.insert_resource(settings);
+        ConsoleResult::Success(message)
+    }
+
+    #[cfg(not(target_arch = "wasm32"))]
+    fn handle_profile_command(&self, args: &[&str], world: &mut World) -> ConsoleResult {
+        use crate::debug::profiler::{ProfilerPanel, default_trace_path, start_trace_capture};
+
+        let usage = "Usage: profile [on|off|capture <frames> [file]]";
+        match args {
+            [] => {
+                let visible = world
+                    .get_resource::<ProfilerPanel>()
+                    .is_some_and(|panel| panel.visible);
+                ConsoleResult::Success(format!(
+                    "Profiler panel is {} (F6 to toggle). {}",
+                    if visible { "on" } else { "off" },
+                    usage
+                ))
+            }
+            ["on"] | ["off"] => match world.get_resource_mut::<ProfilerPanel>() {
+                Some(mut panel) => {
+                    panel.visible = args[0] == "on";
+                    ConsoleResult::Success(format!("Profiler panel {}", args[0]))
+                }
+                None => ConsoleResult::Error("Profiler is not running".to_string()),
+            },
+            ["capture", frames] | ["capture", frames, _] => {
+                let Ok(frames) = frames.parse::<u32>() else {
+                    return ConsoleResult::InvalidArgs("Invalid frame count".to_string());
+                };
+                let path = args
+                    .get(2)
+                    .map(std::path::PathBuf::from)
+                    .unwrap_or_else(default_trace_path);
+                match start_trace_capture(frames, &path) {
+                    Ok(()) => ConsoleResult::Success(format!(
+                        "Capturing {} frames to {}{}",
+                        frames,
+                        path.display(),
+                        if cfg!(feature = "profiler") {
+                            ""
+                        } else {
+                            " (build with --features profiler to include system spans)"
+                        }
+                    )),
+                    Err(e) => ConsoleResult::Error(e),
+                }
+            }
+            _ => ConsoleResult::InvalidArgs(usage.to_string()),
+        }
+    }
+
     #[cfg(not(target_arch = "wasm32"))]
     fn handle_spawn_command(&self, args: &[&str], _world: &mut World) -> ConsoleResult {
         if args.len() != 4 {
@@ -530,7 +653,7 @@ impl CommandParser {
                 Ok(_) => ConsoleResult::Success(format!(
                     "Map saved to '{}' with {} blocks",
                     filename,
-                    voxel_world.blocks.len()
+                    voxel_world.blocks().len()
                 )),
                 Err(e) => ConsoleResult::Error(format!("Failed to save map: {}", e)),
             }
@@ -1137,6 +1260,83 @@ mod tests {
         );
     }
 
+    #[test]
+    fn test_memory_command() {
+        let mut parser = CommandParser::new();
+        let mut world = create_test_world();
+
+        let result = parser.parse_command("memory", &mut world);
+        assert!(matches!(result, ConsoleResult::Error(_)));
+
+        world.insert_resource(crate::memory_governor::MemoryStats {
+            resident_chunks: 3,
+            max_resident_chunks: 200,
+            ..Default::default()
+        });
+        let result = parser.parse_command("memory", &mut world);
+        assert!(
+            matches!(result, ConsoleResult::Success(msg) if msg.contains("chunk meshes: 3/200 resident"))
+        );
+
+        let result = parser.parse_command("memory trim", &mut world);
+        assert!(matches!(result, ConsoleResult::Success(_)));
+        let result = parser.parse_command("memory everything", &mut world);
+        assert!(matches!(result, ConsoleResult::InvalidArgs(_)));
+    }
+
+    #[test]
+    fn test_lod_command() {
+        use crate::world::chunk_lod::{ChunkLodSettings, LodBenchmark};
+
+        let mut parser = CommandParser::new();
+        let mut world = create_test_world();
+
+        let result = parser.parse_command("lod", &mut world);
+        assert!(matches!(result, ConsoleResult::Error(_)));
+
+        world.insert_resource(ChunkLodSettings::default());
+        world.insert_resource(LodBenchmark::default());
+        let result = parser.parse_command("lod distance 64", &mut world);
+        assert!(matches!(result, ConsoleResult::Success(_)));
+        let result = parser.parse_command("lod off", &mut world);
+        assert!(matches!(result, ConsoleResult::Success(_)));
+        let settings = world.resource::<ChunkLodSettings>();
+        assert!(!settings.enabled);
+        assert_eq!(settings.lod_distance, 64.0);
+
+        let result = parser.parse_command("lod", &mut world);
+        assert!(matches!(result, ConsoleResult::Success(msg) if msg.contains("LOD off")));
+        let result = parser.parse_command("lod bench 4", &mut world);
+        assert!(matches!(result, ConsoleResult::Success(_)));
+        assert!(world.resource::<LodBenchmark>().is_running());
+        let result = parser.parse_command("lod distance -1", &mut world);
+        assert!(matches!(result, ConsoleResult::InvalidArgs(_)));
+    }
+
+    #[test]
+    #[cfg(not(target_arch = "wasm32"))]
+    fn test_profile_command() {
+        use crate::debug::profiler::ProfilerPanel;
+
+        let mut parser = CommandParser::new();
+        let mut world = create_test_world();
+
+        let result = parser.parse_command("profile on", &mut world);
+        assert!(matches!(result, ConsoleResult::Error(_)));
+
+        world.insert_resource(ProfilerPanel::default());
+        let result = parser.parse_command("profile on", &mut world);
+        assert!(matches!(result, ConsoleResult::Success(_)));
+        assert!(world.resource::<ProfilerPanel>().visible);
+        let result = parser.parse_command("profile", &mut world);
+        assert!(matches!(result, ConsoleResult::Success(msg) if msg.contains("is on")));
+
+        let result = parser.parse_command("profile capture 0", &mut world);
+        assert!(matches!(result, ConsoleResult::Error(_)));
+        let result = parser.parse_command("profile capture many", &mut world);
+        assert!(matches!(result, ConsoleResult::InvalidArgs(_)));
+    }
+
     #[test]
     fn test_clear_command() {
         let mut parser = CommandParser::new();
@@ -1429,7 +1629,7 @@ mod tests {
         let voxel_world = world.get_resource::<VoxelWorld>().unwrap();
         let position = IVec3::new(5, 10, 15);
         assert!(voxel_world.is_block_at(position));
-        assert_eq!(voxel_world.blocks.get(&position), Some(&BlockType::Grass));
+        assert_eq!(voxel_world.blocks().get(&position), Some(&BlockType::Grass));
 
         // Event emission test would go here, but we'll skip it for compatibility
         // In a real system, PlaceBlockEvent would be emitted and handled by systems
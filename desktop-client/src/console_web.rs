@@ -302,13 +302,13 @@ fn create_block_material(
 /// Web-specific save functionality using localStorage
 #[cfg(target_arch = "wasm32")]
 fn save_map_to_local_storage(filename: &str, voxel_world: &VoxelWorld) {
-    if let Ok(world_data) = serde_json::to_string(&voxel_world.blocks) {
+    if let Ok(world_data) = serde_json::to_string(voxel_world.blocks()) {
         if let Some(window) = web_sys::window() {
             if let Ok(Some(local_storage)) = window.local_storage() {
                 let storage_key = format!("iotcraft_map_{}", filename);
                 match local_storage.set_item(&storage_key, &world_data) {
                     Ok(_) => {
-                        info!("Map '{}' saved to browser storage with {} blocks", filename, voxel_world.blocks.len());
+                        info!("Map '{}' saved to browser storage with {} blocks", filename, voxel_world.blocks().len());
                     }
                     Err(_) => {
                         warn!("Failed to save map '{}' to localStorage", filename);
@@ -347,11 +347,11 @@ fn load_map_from_local_storage(
                                 commands.entity(entity).despawn();
                             }
 
-                            voxel_world.blocks = loaded_blocks;
+                            voxel_world.replace_blocks(loaded_blocks);
 
                             // Spawn all blocks
                             let cube_mesh = meshes.add(Cuboid::new(CUBE_SIZE, CUBE_SIZE, CUBE_SIZE));
-                            for (position, block_type) in voxel_world.blocks.iter() {
+                            for (position, block_type) in voxel_world.blocks().iter() {
                                 let material = create_block_material(*block_type, asset_server, materials);
 
                                 commands.spawn((
@@ -366,7 +366,7 @@ fn load_map_from_local_storage(
                                 ));
                             }
 
-                            info!("Map '{}' loaded from browser storage with {} blocks", filename, voxel_world.blocks.len());
+                            info!("Map '{}' loaded from browser storage with {} blocks", filename, voxel_world.blocks().len());
                         }
                         Err(_) => {
                             warn!("Failed to parse stored map data for '{}'", filename);
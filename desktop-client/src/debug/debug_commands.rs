@@ -86,7 +86,7 @@ pub fn update_diagnostics_content_bundled(mut params: ComprehensiveDebugParams)
             let device_count = params.game_state.device_query.iter().count();
             #[cfg(target_arch = "wasm32")]
             let device_count = 0;
-            let block_count = params.game_state.voxel_world.blocks.len();
+            let block_count = params.game_state.voxel_world.blocks().len();
             let selected_slot = params.game_state.inventory.selected_slot + 1; // 1-indexed for display
 
             // Get selected item info
@@ -203,6 +203,7 @@ pub fn update_diagnostics_content_bundled(mut params: ComprehensiveDebugParams)
                 "iotcraft/worlds/+/changes".to_string(),
                 "iotcraft/worlds/+/state/blocks/placed".to_string(),
                 "iotcraft/worlds/+/state/blocks/removed".to_string(),
+                "iotcraft/worlds/+/state/blocks/batch".to_string(),
             ];
 
             // Get last messages from WorldDiscovery resource
@@ -2,3 +2,5 @@
 
 pub mod debug_commands;
 pub mod debug_params;
+#[cfg(not(target_arch = "wasm32"))]
+pub mod profiler;
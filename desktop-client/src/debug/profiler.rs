@@ -0,0 +1,730 @@
+//! In-game profiler
+//!
+//! F6 (or the `profile on` console command) shows a panel with per-system execution time,
+//! a frame-time histogram, entity counts by component, MQTT queue depths and mesh/material
+//! asset counts. `profile capture <frames> [file]` records every system and schedule run of
+//! the next frames into a Chrome trace that can be opened in `chrome://tracing` or Perfetto.
+//!
+//! System timings come from the tracing spans Bevy opens around each system and schedule
+//! run. Bevy only emits those with its `trace` feature, so build with `--features profiler`
+//! to get them; the rest of the panel works in every build. Spans are only timed while the
+//! panel is visible or a capture is running.
+
+use bevy::ecs::component::ComponentId;
+use bevy::log::BoxedLayer;
+use bevy::prelude::*;
+use std::collections::{HashMap, VecDeque};
+use std::fmt;
+use std::io::Write;
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicBool, AtomicU64, Ordering};
+use std::sync::{Arc, LazyLock, Mutex, MutexGuard, PoisonError};
+use std::time::{Duration, Instant};
+use tracing::Subscriber;
+use tracing::field::{Field, Visit};
+use tracing::span::{Attributes, Id};
+use tracing_subscriber::Layer;
+use tracing_subscriber::layer::Context;
+use tracing_subscriber::registry::LookupSpan;
+
+use crate::fonts::Fonts;
+use crate::mqtt::core_service::MqttQueue;
+
+/// Frames kept for the frame-time histogram
+const FRAME_HISTORY: usize = 240;
+
+/// Upper bounds of the frame-time histogram buckets, in milliseconds
+const FRAME_BUCKETS_MS: [f32; 6] = [8.3, 16.7, 33.3, 50.0, 100.0, f32::INFINITY];
+
+/// How often the panel text is rebuilt
+const PANEL_REFRESH_SECS: f32 = 0.5;
+
+const TOP_SYSTEMS: usize = 15;
+const TOP_COMPONENTS: usize = 12;
+
+/// Longest capture accepted by [`start_trace_capture`]
+pub const MAX_CAPTURE_FRAMES: u32 = 600;
+
+/// Whether the layer times spans at all; off unless the panel is open or a capture runs
+static RECORDING: AtomicBool = AtomicBool::new(false);
+
+static RECORDER: LazyLock<Mutex<SpanRecorder>> = LazyLock::new(Default::default);
+
+static NEXT_THREAD_ID: AtomicU64 = AtomicU64::new(1);
+
+thread_local! {
+    /// Small stable id of the current thread for trace events
+    static THREAD_ID: u64 = NEXT_THREAD_ID.fetch_add(1, Ordering::Relaxed);
+}
+
+fn recorder() -> MutexGuard<'static, SpanRecorder> {
+    RECORDER.lock().unwrap_or_else(PoisonError::into_inner)
+}
+
+/// Label of a system or schedule span, kept in the span's extensions
+struct ProfiledSpan {
+    name: Arc<str>,
+    category: &'static str,
+}
+
+struct EnteredAt(Instant);
+
+/// Pulls the `name` field out of Bevy's `system` and `schedule` spans
+struct SpanName(Option<String>);
+
+impl Visit for SpanName {
+    fn record_str(&mut self, field: &Field, value: &str) {
+        if field.name() == "name" {
+            self.0 = Some(value.to_string());
+        }
+    }
+
+    fn record_debug(&mut self, field: &Field, value: &dyn fmt::Debug) {
+        if field.name() == "name" && self.0.is_none() {
+            self.0 = Some(format!("{:?}", value).trim_matches('"').to_string());
+        }
+    }
+}
+
+/// Tracing layer that times Bevy's system and schedule spans
+pub struct ProfilerLayer;
+
+impl<S> Layer<S> for ProfilerLayer
+where
+    S: Subscriber + for<'a> LookupSpan<'a>,
+{
+    fn on_new_span(&self, attrs: &Attributes<'_>, id: &Id, ctx: Context<'_, S>) {
+        let category = match attrs.metadata().name() {
+            "system" => "system",
+            "schedule" => "schedule",
+            _ => return,
+        };
+        let mut name = SpanName(None);
+        attrs.record(&mut name);
+        if let (Some(name), Some(span)) = (name.0, ctx.span(id)) {
+            span.extensions_mut().insert(ProfiledSpan {
+                name: name.into(),
+                category,
+            });
+        }
+    }
+
+    fn on_enter(&self, id: &Id, ctx: Context<'_, S>) {
+        if !RECORDING.load(Ordering::Relaxed) {
+            return;
+        }
+        if let Some(span) = ctx.span(id) {
+            if span.extensions().get::<ProfiledSpan>().is_some() {
+                span.extensions_mut().replace(EnteredAt(Instant::now()));
+            }
+        }
+    }
+
+    fn on_exit(&self, id: &Id, ctx: Context<'_, S>) {
+        let Some(span) = ctx.span(id) else {
+            return;
+        };
+        let mut extensions = span.extensions_mut();
+        let Some(EnteredAt(start)) = extensions.remove::<EnteredAt>() else {
+            return;
+        };
+        let elapsed = start.elapsed();
+        if let Some(label) = extensions.get_mut::<ProfiledSpan>() {
+            recorder().record(label, start, elapsed);
+        }
+    }
+}
+
+/// `LogPlugin::custom_layer` hook that installs the [`ProfilerLayer`]
+pub fn profiler_layer(_app: &mut App) -> Option<BoxedLayer> {
+    Some(Box::new(ProfilerLayer))
+}
+
+/// Accumulated run time of one system since the panel last refreshed
+#[derive(Debug, Clone, Default, PartialEq)]
+pub struct SystemTiming {
+    pub name: String,
+    pub calls: u64,
+    pub total: Duration,
+    pub max: Duration,
+}
+
+#[derive(Default)]
+struct SpanRecorder {
+    systems: HashMap<Arc<str>, SystemTiming>,
+    trace: Option<TraceCapture>,
+}
+
+impl SpanRecorder {
+    fn record(&mut self, span: &ProfiledSpan, start: Instant, elapsed: Duration) {
+        if span.category == "system" {
+            let timing = self.systems.entry(span.name.clone()).or_default();
+            timing.calls += 1;
+            timing.total += elapsed;
+            timing.max = timing.max.max(elapsed);
+        }
+        if let Some(trace) = &mut self.trace {
+            trace.push(span, start, elapsed);
+        }
+    }
+
+    /// Timings since the last call, slowest first
+    fn take_system_timings(&mut self) -> Vec<SystemTiming> {
+        let mut timings: Vec<SystemTiming> = self
+            .systems
+            .drain()
+            .map(|(name, timing)| SystemTiming {
+                name: short_type_name(&name),
+                ..timing
+            })
+            .collect();
+        timings.sort_by(|a, b| b.total.cmp(&a.total));
+        timings
+    }
+}
+
+struct TraceSpan {
+    name: Arc<str>,
+    category: &'static str,
+    thread: u64,
+    start_us: f64,
+    duration_us: f64,
+}
+
+/// Spans recorded for a Chrome trace
+struct TraceCapture {
+    path: PathBuf,
+    frames_left: u32,
+    started: Instant,
+    spans: Vec<TraceSpan>,
+    frame_ends_us: Vec<f64>,
+    threads: HashMap<u64, String>,
+}
+
+impl TraceCapture {
+    fn new(path: PathBuf, frames: u32) -> Self {
+        Self {
+            path,
+            frames_left: frames,
+            started: Instant::now(),
+            spans: Vec::new(),
+            frame_ends_us: Vec::new(),
+            threads: HashMap::new(),
+        }
+    }
+
+    fn micros_since_start(&self, at: Instant) -> f64 {
+        at.saturating_duration_since(self.started).as_secs_f64() * 1e6
+    }
+
+    fn push(&mut self, span: &ProfiledSpan, start: Instant, elapsed: Duration) {
+        let thread = THREAD_ID.with(|id| *id);
+        self.threads.entry(thread).or_insert_with(|| {
+            std::thread::current()
+                .name()
+                .unwrap_or("worker")
+                .to_string()
+        });
+        self.spans.push(TraceSpan {
+            name: span.name.clone(),
+            category: span.category,
+            thread,
+            start_us: self.micros_since_start(start),
+            duration_us: elapsed.as_secs_f64() * 1e6,
+        });
+    }
+
+    /// Events in Chrome's trace event format: thread names, spans and frame markers
+    fn chrome_events(&self) -> Vec<serde_json::Value> {
+        let threads = self.threads.iter().map(|(tid, name)| {
+            serde_json::json!({
+                "name": "thread_name", "ph": "M", "pid": 1, "tid": tid,
+                "args": { "name": name },
+            })
+        });
+        let spans = self.spans.iter().map(|span| {
+            serde_json::json!({
+                "name": short_type_name(&span.name), "cat": span.category, "ph": "X",
+                "ts": span.start_us, "dur": span.duration_us, "pid": 1, "tid": span.thread,
+            })
+        });
+        let frames = self.frame_ends_us.iter().enumerate().map(|(frame, ts)| {
+            serde_json::json!({
+                "name": format!("frame {}", frame + 1), "cat": "frame", "ph": "i", "s": "g",
+                "ts": ts, "pid": 1, "tid": 0,
+            })
+        });
+        threads.chain(spans).chain(frames).collect()
+    }
+
+    fn write(&self) -> std::io::Result<()> {
+        let mut out = std::io::BufWriter::new(std::fs::File::create(&self.path)?);
+        out.write_all(b"{\"displayTimeUnit\":\"ms\",\"traceEvents\":[")?;
+        for (i, event) in self.chrome_events().iter().enumerate() {
+            if i > 0 {
+                out.write_all(b",\n")?;
+            }
+            serde_json::to_writer(&mut out, event)?;
+        }
+        out.write_all(b"]}\n")?;
+        out.flush()
+    }
+}
+
+/// Start recording the next `frames` frames into a Chrome trace at `path`
+pub fn start_trace_capture(frames: u32, path: &Path) -> Result<(), String> {
+    if frames == 0 || frames > MAX_CAPTURE_FRAMES {
+        return Err(format!(
+            "Frame count must be between 1 and {}",
+            MAX_CAPTURE_FRAMES
+        ));
+    }
+    let mut recorder = recorder();
+    if recorder.trace.is_some() {
+        return Err("A trace capture is already running".to_string());
+    }
+    recorder.trace = Some(TraceCapture::new(path.to_path_buf(), frames));
+    RECORDING.store(true, Ordering::Relaxed);
+    Ok(())
+}
+
+/// Default file name for a capture started now
+pub fn default_trace_path() -> PathBuf {
+    PathBuf::from(
+        chrono::Local::now()
+            .format("iotcraft_trace_%Y%m%d_%H%M%S.json")
+            .to_string(),
+    )
+}
+
+/// Strip module paths from a type or system name, including inside generics
+pub fn short_type_name(name: &str) -> String {
+    fn last_segment(path: &str) -> &str {
+        path.rsplit("::").next().unwrap_or(path)
+    }
+
+    let mut short = String::with_capacity(name.len());
+    let mut segment_start = 0;
+    for (i, c) in name.char_indices() {
+        if matches!(c, '<' | '>' | ',' | ' ' | '(' | ')' | '[' | ']' | ';' | '&') {
+            short.push_str(last_segment(&name[segment_start..i]));
+            short.push(c);
+            segment_start = i + c.len_utf8();
+        }
+    }
+    short.push_str(last_segment(&name[segment_start..]));
+    short
+}
+
+/// Recent frame durations, in milliseconds
+#[derive(Resource, Debug, Default)]
+pub struct FrameTimes {
+    samples: VecDeque<f32>,
+}
+
+/// Percentiles over the frame history
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct FrameTimeSummary {
+    pub average_ms: f32,
+    pub p50_ms: f32,
+    pub p95_ms: f32,
+    pub p99_ms: f32,
+    pub max_ms: f32,
+}
+
+impl FrameTimes {
+    pub fn push(&mut self, frame_ms: f32) {
+        if self.samples.len() == FRAME_HISTORY {
+            self.samples.pop_front();
+        }
+        self.samples.push_back(frame_ms);
+    }
+
+    pub fn summary(&self) -> Option<FrameTimeSummary> {
+        if self.samples.is_empty() {
+            return None;
+        }
+        let mut sorted: Vec<f32> = self.samples.iter().copied().collect();
+        sorted.sort_by(f32::total_cmp);
+        let percentile = |p: f32| sorted[((sorted.len() - 1) as f32 * p).round() as usize];
+        Some(FrameTimeSummary {
+            average_ms: sorted.iter().sum::<f32>() / sorted.len() as f32,
+            p50_ms: percentile(0.50),
+            p95_ms: percentile(0.95),
+            p99_ms: percentile(0.99),
+            max_ms: sorted[sorted.len() - 1],
+        })
+    }
+
+    /// Frame counts per [`FRAME_BUCKETS_MS`] bucket
+    pub fn histogram(&self) -> [usize; FRAME_BUCKETS_MS.len()] {
+        let mut buckets = [0; FRAME_BUCKETS_MS.len()];
+        for sample in &self.samples {
+            let bucket = FRAME_BUCKETS_MS
+                .iter()
+                .position(|bound| sample < bound)
+                .unwrap_or(FRAME_BUCKETS_MS.len() - 1);
+            buckets[bucket] += 1;
+        }
+        buckets
+    }
+
+    pub fn report(&self) -> String {
+        let Some(summary) = self.summary() else {
+            return "FRAME TIME\n  no frames yet".to_string();
+        };
+        let mut lines = vec![
+            format!("FRAME TIME (last {} frames)", self.samples.len()),
+            format!(
+                "  avg {:.1} ms ({:.0} fps)  p50 {:.1}  p95 {:.1}  p99 {:.1}  max {:.1}",
+                summary.average_ms,
+                1000.0 / summary.average_ms.max(0.001),
+                summary.p50_ms,
+                summary.p95_ms,
+                summary.p99_ms,
+                summary.max_ms
+            ),
+        ];
+        let histogram = self.histogram();
+        let tallest = histogram.iter().copied().max().unwrap_or(0).max(1);
+        let mut lower = 0.0;
+        for (bound, count) in FRAME_BUCKETS_MS.iter().zip(histogram) {
+            let label = if bound.is_finite() {
+                format!("{:>5.1}-{:<5.1} ms", lower, bound)
+            } else {
+                format!("  >= {:<6.1} ms", lower)
+            };
+            lines.push(format!(
+                "  {} |{:<30}| {}",
+                label,
+                "#".repeat(count * 30 / tallest),
+                count
+            ));
+            lower = *bound;
+        }
+        lines.join("\n")
+    }
+}
+
+fn system_report(timings: &[SystemTiming], frames: u32) -> String {
+    if timings.is_empty() {
+        return if cfg!(feature = "profiler") {
+            "SYSTEMS\n  collecting...".to_string()
+        } else {
+            "SYSTEMS\n  build with --features profiler for per-system timings".to_string()
+        };
+    }
+    let frames = frames.max(1) as f64;
+    let frame_total: f64 = timings.iter().map(|t| t.total.as_secs_f64()).sum::<f64>() / frames;
+    let mut lines = vec![format!(
+        "SYSTEMS (ms per frame, {:.2} ms total across {} systems)",
+        frame_total * 1e3,
+        timings.len()
+    )];
+    for timing in timings.iter().take(TOP_SYSTEMS) {
+        lines.push(format!(
+            "  {:>7.3}  max {:>7.3}  {}",
+            timing.total.as_secs_f64() * 1e3 / frames,
+            timing.max.as_secs_f64() * 1e3,
+            timing.name
+        ));
+    }
+    lines.join("\n")
+}
+
+/// Live entities per component type, most common first
+pub fn entity_counts_by_component(world: &World) -> Vec<(String, usize)> {
+    let mut counts: HashMap<ComponentId, usize> = HashMap::new();
+    for archetype in world.archetypes().iter() {
+        if archetype.is_empty() {
+            continue;
+        }
+        for component in archetype.components() {
+            *counts.entry(component).or_default() += archetype.len() as usize;
+        }
+    }
+    let mut named: Vec<(String, usize)> = counts
+        .into_iter()
+        .filter_map(|(id, count)| {
+            let info = world.components().get_info(id)?;
+            Some((short_type_name(&info.name().to_string()), count))
+        })
+        .collect();
+    named.sort_by(|a, b| b.1.cmp(&a.1).then_with(|| a.0.cmp(&b.0)));
+    named
+}
+
+fn world_report(world: &World) -> String {
+    let counts = entity_counts_by_component(world);
+    let mut lines = vec![format!("ENTITIES ({} total)", world.entities().len())];
+    for (name, count) in counts.iter().take(TOP_COMPONENTS) {
+        lines.push(format!("  {:>7}  {}", count, name));
+    }
+
+    let queues = MqttQueue::ALL
+        .iter()
+        .map(|queue| format!("{} {}", queue.name(), queue.depth()))
+        .collect::<Vec<_>>();
+    lines.push("MQTT QUEUES (messages waiting)".to_string());
+    lines.push(format!("  {}", queues.join("  ")));
+
+    let meshes = world.get_resource::<Assets<Mesh>>().map_or(0, |a| a.len());
+    let materials = world
+        .get_resource::<Assets<StandardMaterial>>()
+        .map_or(0, |a| a.len());
+    let images = world.get_resource::<Assets<Image>>().map_or(0, |a| a.len());
+    lines.push("ASSETS".to_string());
+    lines.push(format!(
+        "  meshes {}  materials {}  images {}",
+        meshes, materials, images
+    ));
+    lines.join("\n")
+}
+
+/// Panel visibility and refresh state
+#[derive(Resource, Debug)]
+pub struct ProfilerPanel {
+    pub visible: bool,
+    refresh: Timer,
+    frames: u32,
+}
+
+impl Default for ProfilerPanel {
+    fn default() -> Self {
+        Self {
+            visible: false,
+            refresh: Timer::from_seconds(PANEL_REFRESH_SECS, TimerMode::Repeating),
+            frames: 0,
+        }
+    }
+}
+
+#[derive(Component)]
+pub struct ProfilerOverlay;
+
+#[derive(Component)]
+pub struct ProfilerText;
+
+/// Plugin for the profiler panel and trace captures
+pub struct ProfilerPlugin;
+
+impl Plugin for ProfilerPlugin {
+    fn build(&self, app: &mut App) {
+        app.init_resource::<ProfilerPanel>()
+            .init_resource::<FrameTimes>()
+            .add_systems(Startup, setup_profiler_panel)
+            .add_systems(
+                Update,
+                (
+                    record_frame_time,
+                    toggle_profiler_panel,
+                    show_profiler_panel,
+                )
+                    .chain(),
+            )
+            .add_systems(
+                Last,
+                (
+                    advance_trace_capture,
+                    update_profiler_panel.run_if(|panel: Res<ProfilerPanel>| panel.visible),
+                ),
+            );
+    }
+}
+
+fn setup_profiler_panel(mut commands: Commands, fonts: Res<Fonts>) {
+    commands
+        .spawn((
+            Node {
+                position_type: PositionType::Absolute,
+                right: Val::Px(10.0),
+                top: Val::Px(10.0),
+                width: Val::Px(620.0),
+                padding: UiRect::all(Val::Px(12.0)),
+                flex_direction: FlexDirection::Column,
+                ..default()
+            },
+            BackgroundColor(Color::srgba(0.0, 0.0, 0.0, 0.85)),
+            Visibility::Hidden,
+            ProfilerOverlay,
+        ))
+        .with_children(|parent| {
+            parent.spawn((
+                Text::new("Profiler (F6 to toggle)\n\nCollecting..."),
+                TextFont {
+                    font: fonts.regular.clone(),
+                    font_size: 13.0,
+                    ..default()
+                },
+                TextColor(Color::WHITE),
+                ProfilerText,
+            ));
+        });
+}
+
+fn record_frame_time(time: Res<Time>, mut frame_times: ResMut<FrameTimes>) {
+    frame_times.push(time.delta_secs() * 1000.0);
+}
+
+fn toggle_profiler_panel(
+    keyboard_input: Res<ButtonInput<KeyCode>>,
+    mut panel: ResMut<ProfilerPanel>,
+) {
+    if keyboard_input.just_pressed(KeyCode::F6) {
+        panel.visible = !panel.visible;
+        info!("Profiler panel toggled: {}", panel.visible);
+    }
+}
+
+/// Apply panel visibility set by F6 or the `profile` command
+fn show_profiler_panel(
+    panel: Res<ProfilerPanel>,
+    mut shown: Local<bool>,
+    mut overlay_query: Query<&mut Visibility, With<ProfilerOverlay>>,
+) {
+    if panel.visible == *shown {
+        return;
+    }
+    *shown = panel.visible;
+    for mut visibility in overlay_query.iter_mut() {
+        *visibility = if panel.visible {
+            Visibility::Visible
+        } else {
+            Visibility::Hidden
+        };
+    }
+    let mut recorder = recorder();
+    // Do not average the first refresh over timings left from a capture
+    recorder.systems.clear();
+    RECORDING.store(panel.visible || recorder.trace.is_some(), Ordering::Relaxed);
+}
+
+fn advance_trace_capture(panel: Res<ProfilerPanel>) {
+    let finished = {
+        let mut recorder = recorder();
+        let Some(trace) = recorder.trace.as_mut() else {
+            return;
+        };
+        let frame_end = trace.micros_since_start(Instant::now());
+        trace.frame_ends_us.push(frame_end);
+        trace.frames_left -= 1;
+        if trace.frames_left > 0 {
+            return;
+        }
+        recorder.trace.take()
+    };
+    RECORDING.store(panel.visible, Ordering::Relaxed);
+
+    if let Some(trace) = finished {
+        // Writing can take a while for long captures; keep it off the frame
+        std::thread::spawn(move || match trace.write() {
+            Ok(()) => info!(
+                "Wrote {} spans over {} frames to {}",
+                trace.spans.len(),
+                trace.frame_ends_us.len(),
+                trace.path.display()
+            ),
+            Err(e) => error!("Failed to write trace to {}: {}", trace.path.display(), e),
+        });
+    }
+}
+
+fn update_profiler_panel(world: &mut World) {
+    let delta = world.resource::<Time>().delta();
+    let frames = {
+        let mut panel = world.resource_mut::<ProfilerPanel>();
+        panel.frames += 1;
+        if !panel.refresh.tick(delta).just_finished() {
+            return;
+        }
+        std::mem::take(&mut panel.frames)
+    };
+
+    let timings = recorder().take_system_timings();
+    let report = [
+        "Profiler (F6 to toggle, `profile capture <frames>` for a Chrome trace)".to_string(),
+        world.resource::<FrameTimes>().report(),
+        system_report(&timings, frames),
+        world_report(world),
+    ]
+    .join("\n\n");
+
+    let mut texts = world.query_filtered::<&mut Text, With<ProfilerText>>();
+    for mut text in texts.iter_mut(world) {
+        text.0.clone_from(&report);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_short_type_name() {
+        assert_eq!(
+            short_type_name("iotcraft::minimap::update_minimap"),
+            "update_minimap"
+        );
+        assert_eq!(
+            short_type_name("bevy_ecs::query::With<iotcraft::environment::VoxelBlock>"),
+            "With<VoxelBlock>"
+        );
+        assert_eq!(
+            short_type_name("core::option::Option<(a::B, c::D)>"),
+            "Option<(B, D)>"
+        );
+    }
+
+    #[test]
+    fn test_frame_time_summary_and_histogram() {
+        let mut frame_times = FrameTimes::default();
+        assert!(frame_times.summary().is_none());
+        for ms in [5.0, 10.0, 10.0, 20.0, 200.0] {
+            frame_times.push(ms);
+        }
+        let summary = frame_times.summary().unwrap();
+        assert_eq!(summary.average_ms, 49.0);
+        assert_eq!(summary.p50_ms, 10.0);
+        assert_eq!(summary.max_ms, 200.0);
+        assert_eq!(frame_times.histogram(), [1, 2, 1, 0, 0, 1]);
+
+        for _ in 0..FRAME_HISTORY {
+            frame_times.push(16.0);
+        }
+        assert_eq!(frame_times.histogram()[1], FRAME_HISTORY);
+    }
+
+    #[test]
+    fn test_chrome_trace_events() {
+        let mut recorder = SpanRecorder::default();
+        recorder.trace = Some(TraceCapture::new(PathBuf::from("unused.json"), 1));
+        let system = ProfiledSpan {
+            name: "iotcraft::minimap::update_minimap".into(),
+            category: "system",
+        };
+        let start = Instant::now();
+        recorder.record(&system, start, Duration::from_micros(250));
+        recorder.record(&system, start, Duration::from_micros(750));
+
+        let timings = recorder.take_system_timings();
+        assert_eq!(timings.len(), 1);
+        assert_eq!(timings[0].name, "update_minimap");
+        assert_eq!(timings[0].calls, 2);
+        assert_eq!(timings[0].max, Duration::from_micros(750));
+        assert!(recorder.systems.is_empty());
+
+        let trace = recorder.trace.as_mut().unwrap();
+        trace.frame_ends_us.push(1000.0);
+        let events = trace.chrome_events();
+        let spans: Vec<_> = events.iter().filter(|e| e["ph"] == "X").collect();
+        assert_eq!(spans.len(), 2);
+        assert_eq!(spans[0]["name"], "update_minimap");
+        assert_eq!(spans[1]["dur"], 750.0);
+        assert!(events.iter().any(|e| e["ph"] == "M"));
+        assert!(
+            events
+                .iter()
+                .any(|e| e["ph"] == "i" && e["name"] == "frame 1")
+        );
+    }
+}
@@ -0,0 +1,447 @@
+//! Spatial index of device entities
+//!
+//! [`DeviceIndex`] maps device ids to entities and buckets device positions in a uniform
+//! grid over the XZ plane, so id lookups, proximity queries (minimap markers) and cursor
+//! picks touch only the devices near the query instead of every [`DeviceEntity`].
+//! [`update_device_index`] keeps it in sync with spawned, moved and despawned devices.
+
+use bevy::prelude::*;
+use std::collections::HashMap;
+
+use super::device_types::DeviceEntity;
+
+/// Side length of a grid cell in world units
+pub const DEVICE_CELL_SIZE: f32 = 4.0;
+
+#[derive(Debug, Clone)]
+struct IndexedDevice {
+    device_id: String,
+    position: Vec3,
+    cell: IVec2,
+}
+
+/// Device id → entity map plus a uniform XZ grid of device positions
+#[derive(Resource, Debug, Default)]
+pub struct DeviceIndex {
+    by_id: HashMap<String, Entity>,
+    devices: HashMap<Entity, IndexedDevice>,
+    cells: HashMap<IVec2, Vec<Entity>>,
+    /// Smallest and largest cell that has held a device; bounds ray traversal
+    bounds: Option<(IVec2, IVec2)>,
+}
+
+fn cell_of(position: Vec3) -> IVec2 {
+    IVec2::new(
+        (position.x / DEVICE_CELL_SIZE).floor() as i32,
+        (position.z / DEVICE_CELL_SIZE).floor() as i32,
+    )
+}
+
+impl DeviceIndex {
+    pub fn len(&self) -> usize {
+        self.devices.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.devices.is_empty()
+    }
+
+    /// Entity of the device with this id
+    pub fn get(&self, device_id: &str) -> Option<Entity> {
+        self.by_id.get(device_id).copied()
+    }
+
+    /// Last indexed position of a device entity
+    pub fn position(&self, entity: Entity) -> Option<Vec3> {
+        self.devices.get(&entity).map(|device| device.position)
+    }
+
+    /// Index a device, or move it if the entity is already indexed under the same id
+    pub fn insert(&mut self, device_id: &str, entity: Entity, position: Vec3) {
+        if let Some(device) = self.devices.get(&entity) {
+            if device.device_id == device_id {
+                self.move_to(entity, position);
+                return;
+            }
+            self.remove(entity);
+        }
+        if let Some(previous) = self.by_id.get(device_id).copied() {
+            self.remove(previous);
+        }
+
+        let cell = cell_of(position);
+        self.link(cell, entity);
+        self.by_id.insert(device_id.to_string(), entity);
+        self.devices.insert(
+            entity,
+            IndexedDevice {
+                device_id: device_id.to_string(),
+                position,
+                cell,
+            },
+        );
+    }
+
+    /// Update the position of an indexed device; unknown entities are ignored
+    pub fn move_to(&mut self, entity: Entity, position: Vec3) {
+        let Some(device) = self.devices.get_mut(&entity) else {
+            return;
+        };
+        device.position = position;
+        let (old_cell, new_cell) = (device.cell, cell_of(position));
+        if old_cell != new_cell {
+            device.cell = new_cell;
+            self.unlink(old_cell, entity);
+            self.link(new_cell, entity);
+        }
+    }
+
+    /// Drop a device from the index, returning its id
+    pub fn remove(&mut self, entity: Entity) -> Option<String> {
+        let device = self.devices.remove(&entity)?;
+        self.unlink(device.cell, entity);
+        if self.by_id.get(&device.device_id) == Some(&entity) {
+            self.by_id.remove(&device.device_id);
+        }
+        Some(device.device_id)
+    }
+
+    fn link(&mut self, cell: IVec2, entity: Entity) {
+        self.cells.entry(cell).or_default().push(entity);
+        self.bounds = Some(match self.bounds {
+            Some((min, max)) => (min.min(cell), max.max(cell)),
+            None => (cell, cell),
+        });
+    }
+
+    fn unlink(&mut self, cell: IVec2, entity: Entity) {
+        if let Some(entities) = self.cells.get_mut(&cell) {
+            if let Some(slot) = entities.iter().position(|e| *e == entity) {
+                entities.swap_remove(slot);
+            }
+            if entities.is_empty() {
+                self.cells.remove(&cell);
+            }
+        }
+    }
+
+    /// Devices in the cells overlapping the XZ square around `center`
+    fn candidates(&self, center: Vec3, half_extent: f32) -> Vec<(Entity, Vec3)> {
+        let min = cell_of(center - Vec3::splat(half_extent));
+        let max = cell_of(center + Vec3::splat(half_extent));
+        let span = (max - min + IVec2::ONE).as_i64vec2();
+        let in_range = |cell: &IVec2| cell.cmpge(min).all() && cell.cmple(max).all();
+
+        // Large queries over a sparse grid walk the occupied cells instead
+        let entities: Vec<Entity> = if span.x * span.y > self.cells.len() as i64 {
+            self.cells
+                .iter()
+                .filter(|(cell, _)| in_range(cell))
+                .flat_map(|(_, entities)| entities.iter().copied())
+                .collect()
+        } else {
+            (min.x..=max.x)
+                .flat_map(|x| (min.y..=max.y).map(move |z| IVec2::new(x, z)))
+                .filter_map(|cell| self.cells.get(&cell))
+                .flat_map(|entities| entities.iter().copied())
+                .collect()
+        };
+        entities
+            .into_iter()
+            .map(|entity| (entity, self.devices[&entity].position))
+            .collect()
+    }
+
+    /// Devices within `radius` of `center`
+    pub fn within_radius(&self, center: Vec3, radius: f32) -> Vec<(Entity, Vec3)> {
+        let mut devices = self.candidates(center, radius);
+        devices.retain(|(_, position)| position.distance_squared(center) <= radius * radius);
+        devices
+    }
+
+    /// Devices whose X and Z are within `half_extent` of `center`, at any height
+    pub fn within_square(&self, center: Vec3, half_extent: f32) -> Vec<(Entity, Vec3)> {
+        let mut devices = self.candidates(center, half_extent);
+        devices.retain(|(_, position)| {
+            (position.x - center.x).abs() <= half_extent
+                && (position.z - center.z).abs() <= half_extent
+        });
+        devices
+    }
+
+    /// Nearest device whose sphere of `radius` the ray passes through, with its distance
+    /// along the ray. Devices rejected by `filter` are skipped.
+    ///
+    /// Walks the grid cells under the ray in order, checking each cell's neighbours too,
+    /// and stops once the walk is past the best hit. `radius` must not exceed
+    /// [`DEVICE_CELL_SIZE`].
+    pub fn ray_cast(
+        &self,
+        ray: Ray3d,
+        radius: f32,
+        filter: impl Fn(Entity) -> bool,
+    ) -> Option<(Entity, f32)> {
+        debug_assert!(radius <= DEVICE_CELL_SIZE);
+        let (min_cell, max_cell) = self.bounds?;
+        let direction = *ray.direction;
+        let origin = Vec2::new(ray.origin.x, ray.origin.z);
+        let step_dir = Vec2::new(direction.x, direction.z);
+
+        // Clip the ray to the occupied area, padded by one cell for the neighbour checks
+        let min = (min_cell - IVec2::ONE).as_vec2() * DEVICE_CELL_SIZE;
+        let max = (max_cell + IVec2::splat(2)).as_vec2() * DEVICE_CELL_SIZE;
+        let mut t_enter = 0.0f32;
+        let mut t_exit = f32::INFINITY;
+        for axis in 0..2 {
+            if step_dir[axis] == 0.0 {
+                if origin[axis] < min[axis] || origin[axis] > max[axis] {
+                    return None;
+                }
+                continue;
+            }
+            let t1 = (min[axis] - origin[axis]) / step_dir[axis];
+            let t2 = (max[axis] - origin[axis]) / step_dir[axis];
+            t_enter = t_enter.max(t1.min(t2));
+            t_exit = t_exit.min(t1.max(t2));
+        }
+        if t_enter > t_exit {
+            return None;
+        }
+
+        // Grid walk (Amanatides & Woo) from the entry point
+        let start = origin + step_dir * t_enter;
+        let mut cell = (start / DEVICE_CELL_SIZE).floor().as_ivec2();
+        let mut step = IVec2::ZERO;
+        let mut t_next = Vec2::INFINITY;
+        let mut t_delta = Vec2::INFINITY;
+        for axis in 0..2 {
+            if step_dir[axis] > 0.0 {
+                step[axis] = 1;
+                t_next[axis] =
+                    ((cell[axis] + 1) as f32 * DEVICE_CELL_SIZE - origin[axis]) / step_dir[axis];
+            } else if step_dir[axis] < 0.0 {
+                step[axis] = -1;
+                t_next[axis] =
+                    (cell[axis] as f32 * DEVICE_CELL_SIZE - origin[axis]) / step_dir[axis];
+            } else {
+                continue;
+            }
+            t_delta[axis] = DEVICE_CELL_SIZE / step_dir[axis].abs();
+        }
+
+        let mut best: Option<(Entity, f32)> = None;
+        // A vertical ray stays in its starting cell, after which `cell_t` becomes infinite
+        let mut cell_t = t_enter;
+        while cell_t.is_finite()
+            && cell_t <= t_exit
+            && best.is_none_or(|(_, best_t)| cell_t <= best_t)
+        {
+            for dx in -1..=1 {
+                for dz in -1..=1 {
+                    let Some(entities) = self.cells.get(&(cell + IVec2::new(dx, dz))) else {
+                        continue;
+                    };
+                    for &entity in entities {
+                        let position = self.devices[&entity].position;
+                        let projection = (position - ray.origin).dot(direction);
+                        if projection < 0.0
+                            || best.is_some_and(|(_, best_t)| projection >= best_t)
+                            || (ray.origin + direction * projection).distance(position) > radius
+                            || !filter(entity)
+                        {
+                            continue;
+                        }
+                        best = Some((entity, projection));
+                    }
+                }
+            }
+
+            if t_next.x < t_next.y {
+                cell_t = t_next.x;
+                cell.x += step.x;
+                t_next.x += t_delta.x;
+            } else {
+                cell_t = t_next.y;
+                cell.y += step.y;
+                t_next.y += t_delta.y;
+            }
+        }
+        best
+    }
+}
+
+/// Keeps [`DeviceIndex`] in step with spawned, moved and despawned devices
+pub fn update_device_index(
+    mut index: ResMut<DeviceIndex>,
+    devices: Query<
+        (Entity, &DeviceEntity, &Transform),
+        Or<(Added<DeviceEntity>, Changed<Transform>)>,
+    >,
+    mut removed: RemovedComponents<DeviceEntity>,
+) {
+    for entity in removed.read() {
+        index.remove(entity);
+    }
+    for (entity, device, transform) in devices.iter() {
+        index.insert(&device.device_id, entity, transform.translation);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use bevy::ecs::system::IntoSystem;
+
+    /// Deterministic scatter of devices over a 400x400 area
+    fn scattered_index(count: u32) -> (World, DeviceIndex) {
+        let mut world = World::new();
+        let mut index = DeviceIndex::default();
+        let mut seed = 0x2545_f491_4f6c_dd1du64;
+        for i in 0..count {
+            seed = seed
+                .wrapping_mul(6364136223846793005)
+                .wrapping_add(1442695040888963407);
+            let x = (seed >> 33) as f32 / (1u64 << 31) as f32 * 400.0 - 200.0;
+            let z = ((seed >> 1) & 0xffff_ffff) as f32 / (1u64 << 32) as f32 * 400.0 - 200.0;
+            let y = (i % 5) as f32;
+            let entity = world.spawn_empty().id();
+            index.insert(&format!("device_{}", i), entity, Vec3::new(x, y, z));
+        }
+        (world, index)
+    }
+
+    #[test]
+    fn test_insert_move_remove() {
+        let mut world = World::new();
+        let mut index = DeviceIndex::default();
+        let lamp = world.spawn_empty().id();
+
+        index.insert("lamp_1", lamp, Vec3::new(1.0, 0.5, 1.0));
+        assert_eq!(index.get("lamp_1"), Some(lamp));
+
+        index.move_to(lamp, Vec3::new(41.0, 0.5, -9.0));
+        assert!(
+            index
+                .within_radius(Vec3::new(1.0, 0.5, 1.0), 2.0)
+                .is_empty()
+        );
+        assert_eq!(
+            index.within_radius(Vec3::new(40.0, 0.5, -9.0), 2.0),
+            vec![(lamp, Vec3::new(41.0, 0.5, -9.0))]
+        );
+
+        // A repeated announcement under the same id replaces the old entity
+        let replacement = world.spawn_empty().id();
+        index.insert("lamp_1", replacement, Vec3::ZERO);
+        assert_eq!(index.get("lamp_1"), Some(replacement));
+        assert_eq!(index.len(), 1);
+
+        assert_eq!(index.remove(replacement).as_deref(), Some("lamp_1"));
+        assert!(index.get("lamp_1").is_none());
+        assert!(index.is_empty());
+    }
+
+    #[test]
+    fn test_radius_queries_match_brute_force() {
+        let (_world, index) = scattered_index(2000);
+        for (center, radius) in [
+            (Vec3::ZERO, 10.0),
+            (Vec3::new(-150.0, 2.0, 75.0), 25.0),
+            (Vec3::new(30.0, 0.0, -30.0), 500.0),
+        ] {
+            let mut expected: Vec<Entity> = index
+                .devices
+                .iter()
+                .filter(|(_, device)| device.position.distance(center) <= radius)
+                .map(|(entity, _)| *entity)
+                .collect();
+            let mut found: Vec<Entity> = index
+                .within_radius(center, radius)
+                .into_iter()
+                .map(|(entity, _)| entity)
+                .collect();
+            expected.sort();
+            found.sort();
+            assert_eq!(found, expected);
+        }
+    }
+
+    #[test]
+    fn test_ray_cast_matches_brute_force() {
+        let (_world, index) = scattered_index(2000);
+        let radius = 0.7;
+        let rays = [
+            Ray3d::new(
+                Vec3::new(-210.0, 1.0, 3.0),
+                Dir3::new(Vec3::new(1.0, 0.0, 0.02)).unwrap(),
+            ),
+            Ray3d::new(
+                Vec3::new(0.0, 20.0, 0.0),
+                Dir3::new(Vec3::new(0.3, -0.1, -0.9)).unwrap(),
+            ),
+            Ray3d::new(
+                Vec3::new(50.0, 2.0, 50.0),
+                Dir3::new(Vec3::new(-1.0, 0.0, -1.0)).unwrap(),
+            ),
+            Ray3d::new(Vec3::new(10.0, 30.0, 10.0), Dir3::NEG_Y),
+        ];
+        for ray in rays {
+            let expected = index
+                .devices
+                .iter()
+                .filter_map(|(entity, device)| {
+                    let projection = (device.position - ray.origin).dot(*ray.direction);
+                    let closest = ray.origin + *ray.direction * projection;
+                    (projection >= 0.0 && closest.distance(device.position) <= radius)
+                        .then_some((*entity, projection))
+                })
+                .min_by(|a, b| a.1.total_cmp(&b.1));
+            assert_eq!(index.ray_cast(ray, radius, |_| true), expected);
+        }
+
+        // Filtered devices are skipped
+        let ray = Ray3d::new(Vec3::new(-3.0, 0.0, 0.0), Dir3::X);
+        let mut world = World::new();
+        let mut index = DeviceIndex::default();
+        let near = world.spawn_empty().id();
+        let far = world.spawn_empty().id();
+        index.insert("near", near, Vec3::new(2.0, 0.0, 0.0));
+        index.insert("far", far, Vec3::new(30.0, 0.0, 0.3));
+        assert_eq!(index.ray_cast(ray, radius, |_| true), Some((near, 5.0)));
+        assert_eq!(
+            index.ray_cast(ray, radius, |e| e != near),
+            Some((far, 33.0))
+        );
+    }
+
+    #[test]
+    fn test_update_device_index_tracks_entities() {
+        let mut world = World::new();
+        world.init_resource::<DeviceIndex>();
+        let mut system = IntoSystem::into_system(update_device_index);
+        system.initialize(&mut world);
+
+        let door = world
+            .spawn((
+                DeviceEntity {
+                    device_id: "door_1".to_string(),
+                    device_type: "door".to_string(),
+                },
+                Transform::from_xyz(2.0, 1.0, 2.0),
+            ))
+            .id();
+        let _ = system.run((), &mut world);
+        assert_eq!(world.resource::<DeviceIndex>().get("door_1"), Some(door));
+
+        world.get_mut::<Transform>(door).unwrap().translation = Vec3::new(-20.0, 1.0, 6.0);
+        let _ = system.run((), &mut world);
+        assert_eq!(
+            world.resource::<DeviceIndex>().position(door),
+            Some(Vec3::new(-20.0, 1.0, 6.0))
+        );
+
+        world.despawn(door);
+        let _ = system.run((), &mut world);
+        assert!(world.resource::<DeviceIndex>().is_empty());
+    }
+}
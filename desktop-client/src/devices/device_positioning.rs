@@ -1,3 +1,4 @@
+use super::device_index::DeviceIndex;
 use super::device_types::*;
 use crate::config::MqttConfig;
 use crate::fonts::Fonts;
@@ -142,10 +143,8 @@ fn handle_device_drag_input(
     keyboard_input: Res<ButtonInput<KeyCode>>,
     camera_query: Single<(&Camera, &GlobalTransform)>,
     windows: Query<&Window>,
-    device_query: Query<
-        (Entity, &GlobalTransform, &DeviceEntity),
-        (With<DeviceEntity>, Without<BeingDragged>),
-    >,
+    device_query: Query<&GlobalTransform, (With<DeviceEntity>, Without<BeingDragged>)>,
+    device_index: Res<DeviceIndex>,
     mut commands: Commands,
     mut drag_state: ResMut<DragState>,
     #[cfg(feature = "console")] game_state: Res<State<crate::ui::GameState>>,
@@ -186,30 +185,14 @@ fn handle_device_drag_input(
             return;
         };
 
-        let mut closest_device = None;
-        let mut closest_distance = f32::MAX;
-
         // Find the closest device to the cursor
-        for (entity, transform, _device) in device_query.iter() {
-            let device_position = transform.translation();
-
-            // Simple sphere collision detection
-            let sphere_radius = 0.7;
-            let to_sphere = device_position - ray.origin;
-            let projection_length = to_sphere.dot(*ray.direction);
-
-            if projection_length < 0.0 {
-                continue;
-            }
-
-            let closest_point = ray.origin + ray.direction * projection_length;
-            let distance_to_sphere = (closest_point - device_position).length();
-
-            if distance_to_sphere <= sphere_radius && projection_length < closest_distance {
-                closest_distance = projection_length;
-                closest_device = Some((entity, device_position));
-            }
-        }
+        let sphere_radius = 0.7;
+        let closest_device = device_index
+            .ray_cast(ray, sphere_radius, |entity| device_query.contains(entity))
+            .and_then(|(entity, _)| {
+                let transform = device_query.get(entity).ok()?;
+                Some((entity, transform.translation()))
+            });
 
         // Start dragging the closest device
         if let Some((entity, device_position)) = closest_device {
@@ -3,6 +3,7 @@ use bevy::prelude::*;
 use log::info;
 use serde_json;
 
+use super::device_index::{DeviceIndex, update_device_index};
 use super::device_types::*;
 #[cfg(feature = "console")]
 use crate::console::BlinkCube;
@@ -15,6 +16,9 @@ impl Plugin for DevicePlugin {
         app.insert_resource(DevicesTracker {
             spawned_devices: std::collections::HashSet::new(),
         })
+        .init_resource::<DeviceIndex>()
+        // Index last frame's spawns, moves and despawns before anything looks devices up
+        .add_systems(PreUpdate, update_device_index)
         // Device announcement listener should run in Update stage to ensure
         // it runs after command execution systems that might affect devices
         .add_systems(Update, listen_for_device_announcements);
@@ -28,10 +32,11 @@ pub fn listen_for_device_announcements(
     mut meshes: ResMut<Assets<Mesh>>,
     mut tracker: ResMut<DevicesTracker>,
     asset_server: Res<AssetServer>,
-    device_entities: Query<(Entity, &DeviceEntity)>,
+    device_index: Res<DeviceIndex>,
 ) {
     if let Ok(rx) = device_receiver.0.lock() {
         if let Ok(device_json) = rx.try_recv() {
+            crate::mqtt::core_service::MqttQueue::Devices.dequeued();
             info!("📨 Received device announcement: {}", device_json);
 
             // Parse the JSON device announcement
@@ -154,13 +159,10 @@ pub fn listen_for_device_announcements(
                             info!("🔌 Device {} going offline, removing from world", device_id);
 
                             // Find and despawn the device entity
-                            for (entity, device_entity) in device_entities.iter() {
-                                if device_entity.device_id == device_id {
-                                    commands.entity(entity).despawn();
-                                    tracker.spawned_devices.remove(device_id);
-                                    info!("🗑️ Removed device {} from 3D world", device_id);
-                                    break;
-                                }
+                            if let Some(entity) = device_index.get(device_id) {
+                                commands.entity(entity).despawn();
+                                tracker.spawned_devices.remove(device_id);
+                                info!("🗑️ Removed device {} from 3D world", device_id);
                             }
                         }
                         _ => {
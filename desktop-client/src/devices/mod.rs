@@ -1,8 +1,10 @@
 pub mod device_helpers;
+pub mod device_index;
 pub mod device_positioning;
 pub mod device_systems;
 pub mod device_types;
 
+pub use device_index::*;
 pub use device_positioning::*;
 pub use device_systems::*;
 pub use device_types::*;
@@ -10,7 +10,7 @@ use crate::console::BlinkCube;
 use crate::lib_gradual::CameraController;
 use crate::mqtt::TemperatureResource;
 #[cfg(not(target_arch = "wasm32"))]
-use crate::script::script_types::PendingCommands;
+use crate::script::script_types::{PendingScripts, QueuedScript};
 
 pub struct EnvironmentPlugin;
 
@@ -42,7 +42,8 @@ impl Plugin for EnvironmentPlugin {
             PreUpdate,
             setup_background_world
                 .run_if(|setup_complete: Res<BackgroundWorldSetupComplete>| !setup_complete.0)
-                .run_if(resource_exists::<PendingCommands>),
+                .run_if(resource_exists::<PendingScripts>)
+                .before(crate::script::script_systems::execute_pending_scripts),
         );
     }
 }
@@ -69,7 +70,7 @@ fn setup_environment(
     let voxel_mesh = meshes.add(Cuboid::new(CUBE_SIZE, CUBE_SIZE, CUBE_SIZE));
 
     // spawn voxel blocks
-    for (position, block_type) in voxel_world.blocks.iter() {
+    for (position, block_type) in voxel_world.blocks().iter() {
         let material = match block_type {
             BlockType::Grass => grass_material_handle.clone(),
             _ => grass_material_handle.clone(), // Placeholder for other materials
@@ -207,7 +208,7 @@ fn update_thermometer_scale(
 /// Setup background world by executing the background world script (desktop only)
 #[cfg(not(target_arch = "wasm32"))]
 fn setup_background_world(
-    mut pending_commands: ResMut<PendingCommands>,
+    mut pending_scripts: ResMut<PendingScripts>,
     mut setup_complete: ResMut<BackgroundWorldSetupComplete>,
 ) {
     // Execute background world script if it exists
@@ -215,18 +216,11 @@ fn setup_background_world(
     if std::path::Path::new(background_script_path).exists() {
         match std::fs::read_to_string(background_script_path) {
             Ok(content) => {
-                let commands = content
-                    .lines()
-                    .map(|line| line.trim())
-                    .filter(|line| !line.is_empty() && !line.starts_with('#'))
-                    .map(|line| line.to_string())
-                    .collect::<Vec<String>>();
-
-                info!(
-                    "Executing background world script with {} commands",
-                    commands.len()
-                );
-                pending_commands.commands.extend(commands);
+                info!("Executing background world script");
+                pending_scripts.scripts.push(QueuedScript {
+                    name: background_script_path.to_string(),
+                    source: content,
+                });
             }
             Err(e) => {
                 error!("Failed to read background world script: {}", e);
@@ -1,6 +1,6 @@
 use bevy::prelude::*;
 use serde::{Deserialize, Serialize};
-use std::collections::HashMap;
+use std::collections::{HashMap, VecDeque};
 
 /// Standard size for all cubes in the world (voxels, devices, etc.)
 pub const CUBE_SIZE: f32 = 1.0;
@@ -35,29 +35,161 @@ pub enum BlockType {
     Water,
 }
 
+impl BlockType {
+    /// All block types, indexed by [`BlockType::index`]
+    pub const ALL: [BlockType; 7] = [
+        BlockType::Grass,
+        BlockType::Dirt,
+        BlockType::Stone,
+        BlockType::QuartzBlock,
+        BlockType::GlassPane,
+        BlockType::CyanTerracotta,
+        BlockType::Water,
+    ];
+
+    /// Stable numeric id used by compact (non-JSON) encodings
+    pub fn index(self) -> u32 {
+        self as u32
+    }
+
+    pub fn from_index(index: u32) -> Option<Self> {
+        Self::ALL.get(index as usize).copied()
+    }
+
+    /// Texture asset for the block's faces
+    pub fn texture_path(self) -> &'static str {
+        match self {
+            BlockType::Grass => "textures/grass.webp",
+            BlockType::Dirt => "textures/dirt.webp",
+            BlockType::Stone => "textures/stone.webp",
+            BlockType::QuartzBlock => "textures/quartz_block.webp",
+            BlockType::GlassPane => "textures/glass_pane.webp",
+            BlockType::CyanTerracotta => "textures/cyan_terracotta.webp",
+            BlockType::Water => "textures/water.webp",
+        }
+    }
+}
+
+/// Edits kept in the [`VoxelWorld`] journal; consumers further behind resync from `blocks`
+pub const WORLD_JOURNAL_CAPACITY: usize = 4096;
+
+/// One block edit recorded in the [`VoxelWorld`] journal
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct BlockEdit {
+    pub position: IVec3,
+    pub old: Option<BlockType>,
+    pub new: Option<BlockType>,
+}
+
+/// What a consumer has to apply to catch up with the world, see [`VoxelWorld::changes_since`]
+#[derive(Debug)]
+pub enum WorldChanges<'a> {
+    /// Edits made since the consumer's generation, oldest first (empty when up to date)
+    Edits(std::collections::vec_deque::Iter<'a, BlockEdit>),
+    /// The journal no longer reaches back to the consumer's generation, or the world was
+    /// replaced wholesale: rebuild from `blocks`
+    Resync,
+}
+
 /// Resource to manage the voxel world state
-#[derive(Resource)]
+///
+/// Edits made through [`set_block`](Self::set_block) and [`remove_block`](Self::remove_block)
+/// go into a bounded journal with a generation counter, so visual, minimap and network
+/// consumers can apply only what changed since the generation they last saw. The blocks
+/// are only writable through these methods; use [`clear`](Self::clear) or
+/// [`replace_blocks`](Self::replace_blocks) for bulk loads.
+#[derive(Resource, Default)]
 pub struct VoxelWorld {
-    pub blocks: HashMap<IVec3, BlockType>,
+    blocks: HashMap<IVec3, BlockType>,
+    journal: VecDeque<BlockEdit>,
+    generation: u64,
 }
 
-impl Default for VoxelWorld {
-    fn default() -> Self {
-        Self {
-            blocks: HashMap::new(),
+impl VoxelWorld {
+    /// Every block of the world
+    pub fn blocks(&self) -> &HashMap<IVec3, BlockType> {
+        &self.blocks
+    }
+
+    /// Generation of the latest edit; consumers remember it to ask for later changes
+    pub fn generation(&self) -> u64 {
+        self.generation
+    }
+
+    /// Changes made after `generation`
+    pub fn changes_since(&self, generation: u64) -> WorldChanges<'_> {
+        let oldest = self.generation - self.journal.len() as u64;
+        if generation < oldest || generation > self.generation {
+            return WorldChanges::Resync;
         }
+        WorldChanges::Edits(self.journal.range((generation - oldest) as usize..))
+    }
+
+    fn record(&mut self, position: IVec3, old: Option<BlockType>, new: Option<BlockType>) {
+        if self.journal.len() == WORLD_JOURNAL_CAPACITY {
+            self.journal.pop_front();
+        }
+        self.journal.push_back(BlockEdit { position, old, new });
+        self.generation += 1;
+    }
+
+    /// Start a new journal: every consumer that has not seen the current generation resyncs
+    fn reset_journal(&mut self) {
+        self.journal.clear();
+        self.generation += 1;
     }
-}
 
-impl VoxelWorld {
     /// Add a block at the given position
     pub fn set_block(&mut self, position: IVec3, block_type: BlockType) {
-        self.blocks.insert(position, block_type);
+        let old = self.blocks.insert(position, block_type);
+        if old != Some(block_type) {
+            self.record(position, old, Some(block_type));
+        }
     }
 
     /// Remove a block at the given position
     pub fn remove_block(&mut self, position: &IVec3) -> Option<BlockType> {
-        self.blocks.remove(position)
+        let old = self.blocks.remove(position);
+        if old.is_some() {
+            self.record(*position, old, None);
+        }
+        old
+    }
+
+    /// Remove every block
+    pub fn clear(&mut self) {
+        self.blocks.clear();
+        self.reset_journal();
+    }
+
+    /// Replace the whole world, e.g. with a loaded save
+    pub fn replace_blocks(&mut self, blocks: HashMap<IVec3, BlockType>) {
+        self.blocks = blocks;
+        self.reset_journal();
+    }
+
+    /// Apply many edits at once (`None` removes). They are journaled one by one like
+    /// [`set_block`](Self::set_block), unless there are more than the journal holds; then
+    /// consumers resync once instead of finding their generation dropped mid-way.
+    pub fn apply_bulk(&mut self, edits: &[(IVec3, Option<BlockType>)]) {
+        if edits.len() <= WORLD_JOURNAL_CAPACITY {
+            for &(position, block_type) in edits {
+                match block_type {
+                    Some(block_type) => self.set_block(position, block_type),
+                    None => {
+                        self.remove_block(&position);
+                    }
+                }
+            }
+            return;
+        }
+        for &(position, block_type) in edits {
+            match block_type {
+                Some(block_type) => self.blocks.insert(position, block_type),
+                None => self.blocks.remove(&position),
+            };
+        }
+        self.reset_journal();
     }
 
     /// Check if there's a block at the given position
@@ -109,3 +241,81 @@ pub struct VoxelBlockData {
 pub struct VoxelMapData {
     pub blocks: Vec<VoxelBlockData>,
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn edits(world: &VoxelWorld, generation: u64) -> Option<Vec<BlockEdit>> {
+        match world.changes_since(generation) {
+            WorldChanges::Edits(edits) => Some(edits.copied().collect()),
+            WorldChanges::Resync => None,
+        }
+    }
+
+    #[test]
+    fn journal_reports_edits_since_a_generation() {
+        let mut world = VoxelWorld::default();
+        let a = IVec3::new(1, 2, 3);
+        world.set_block(a, BlockType::Stone);
+        let seen = world.generation();
+        world.set_block(a, BlockType::Stone);
+        world.set_block(a, BlockType::Dirt);
+        world.remove_block(&a);
+        world.remove_block(&a);
+
+        assert_eq!(world.generation(), seen + 2);
+        assert_eq!(
+            edits(&world, seen).unwrap(),
+            vec![
+                BlockEdit {
+                    position: a,
+                    old: Some(BlockType::Stone),
+                    new: Some(BlockType::Dirt),
+                },
+                BlockEdit {
+                    position: a,
+                    old: Some(BlockType::Dirt),
+                    new: None,
+                },
+            ]
+        );
+        assert_eq!(edits(&world, world.generation()).unwrap(), vec![]);
+        assert_eq!(edits(&world, 0).unwrap().len(), 3);
+    }
+
+    #[test]
+    fn journal_falls_back_to_resync() {
+        let mut world = VoxelWorld::default();
+        for x in 0..WORLD_JOURNAL_CAPACITY as i32 + 10 {
+            world.set_block(IVec3::new(x, 0, 0), BlockType::Grass);
+        }
+        assert!(edits(&world, 0).is_none());
+        assert_eq!(edits(&world, 10).unwrap().len(), WORLD_JOURNAL_CAPACITY);
+
+        let seen = world.generation();
+        world.clear();
+        assert!(edits(&world, seen).is_none());
+        let cleared = world.generation();
+        world.replace_blocks(HashMap::from([(IVec3::ZERO, BlockType::Water)]));
+        assert!(edits(&world, cleared).is_none());
+        assert_eq!(edits(&world, world.generation()).unwrap(), vec![]);
+    }
+
+    #[test]
+    fn bulk_edits_journal_until_capacity() {
+        let mut world = VoxelWorld::default();
+        world.set_block(IVec3::ZERO, BlockType::Stone);
+        let seen = world.generation();
+        world.apply_bulk(&[(IVec3::ZERO, None), (IVec3::X, Some(BlockType::Dirt))]);
+        assert_eq!(edits(&world, seen).unwrap().len(), 2);
+
+        let seen = world.generation();
+        let many: Vec<_> = (0..WORLD_JOURNAL_CAPACITY as i32 + 1)
+            .map(|x| (IVec3::new(x, 1, 0), Some(BlockType::Grass)))
+            .collect();
+        world.apply_bulk(&many);
+        assert!(edits(&world, seen).is_none());
+        assert_eq!(world.blocks.len(), WORLD_JOURNAL_CAPACITY + 2);
+    }
+}
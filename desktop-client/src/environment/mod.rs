@@ -8,6 +8,7 @@ pub mod chunk_types;
 pub mod chunked_voxel_world;
 pub mod environment_systems;
 pub mod environment_types;
+pub mod voxel_edits;
 
 #[cfg(all(test, feature = "chunk_world"))]
 mod chunk_tests;
@@ -16,3 +17,4 @@ mod chunk_tests;
 pub use chunked_voxel_world::*;
 pub use environment_systems::*;
 pub use environment_types::*;
+pub use voxel_edits::*;
@@ -0,0 +1,220 @@
+//! Deferred voxel edits
+//!
+//! Gameplay and network systems do not borrow [`VoxelWorld`] mutably. They queue edits in a
+//! [`VoxelEdits`] system buffer, Bevy moves those into the [`VoxelEditQueue`] at the sync
+//! point after [`VoxelSet::Edit`], and [`apply_voxel_edits`] writes them to the world. Edit
+//! producers therefore run in parallel with each other, and read-only consumers in
+//! [`VoxelSet::Read`] (collision, raycasts, minimap) share the world once the frame's edits
+//! are in. Bulk replacements (world loads, shared world snapshots) still write directly,
+//! but only on frames where their event arrives, in [`VoxelSet::Replace`]. That runs after
+//! the queue is drained, so edits queued against the old world never land in the new one.
+
+use bevy::ecs::system::{SystemBuffer, SystemMeta};
+use bevy::prelude::*;
+
+use super::environment_types::{BlockType, VoxelWorld};
+
+/// Frame phases around [`VoxelWorld`] access, chained in this order in `Update`
+#[derive(SystemSet, Debug, Clone, PartialEq, Eq, Hash)]
+pub enum VoxelSet {
+    /// Systems that queue edits through [`VoxelEdits`]
+    Edit,
+    /// [`apply_voxel_edits`], the only writer for queued edits
+    Apply,
+    /// Event-driven bulk loaders that replace or rebuild the world
+    Replace,
+    /// Read-only consumers that should see this frame's edits
+    Read,
+}
+
+/// A single queued change to the world
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum VoxelEdit {
+    Place {
+        position: IVec3,
+        block_type: BlockType,
+    },
+    Remove {
+        position: IVec3,
+    },
+}
+
+/// Per-system edit buffer, used as `mut edits: Deferred<VoxelEdits>`
+///
+/// Every system gets its own buffer, so systems queueing edits never conflict with each
+/// other or with readers of the world.
+#[derive(Debug, Default)]
+pub struct VoxelEdits(Vec<VoxelEdit>);
+
+impl VoxelEdits {
+    pub fn place(&mut self, position: IVec3, block_type: BlockType) {
+        self.0.push(VoxelEdit::Place {
+            position,
+            block_type,
+        });
+    }
+
+    pub fn remove(&mut self, position: IVec3) {
+        self.0.push(VoxelEdit::Remove { position });
+    }
+
+    /// Queue many edits at once (`None` removes), e.g. a compiled script's regions
+    pub fn extend(&mut self, edits: impl IntoIterator<Item = (IVec3, Option<BlockType>)>) {
+        self.0.extend(edits.into_iter().map(VoxelEdit::from));
+    }
+}
+
+impl From<(IVec3, Option<BlockType>)> for VoxelEdit {
+    fn from((position, block_type): (IVec3, Option<BlockType>)) -> Self {
+        match block_type {
+            Some(block_type) => VoxelEdit::Place {
+                position,
+                block_type,
+            },
+            None => VoxelEdit::Remove { position },
+        }
+    }
+}
+
+impl From<VoxelEdit> for (IVec3, Option<BlockType>) {
+    fn from(edit: VoxelEdit) -> Self {
+        match edit {
+            VoxelEdit::Place {
+                position,
+                block_type,
+            } => (position, Some(block_type)),
+            VoxelEdit::Remove { position } => (position, None),
+        }
+    }
+}
+
+impl SystemBuffer for VoxelEdits {
+    fn apply(&mut self, _system_meta: &SystemMeta, world: &mut World) {
+        if self.0.is_empty() {
+            return;
+        }
+        world
+            .get_resource_or_init::<VoxelEditQueue>()
+            .0
+            .append(&mut self.0);
+    }
+}
+
+/// Edits from all systems, in the order their buffers were applied
+#[derive(Resource, Debug, Default)]
+pub struct VoxelEditQueue(Vec<VoxelEdit>);
+
+impl VoxelEditQueue {
+    pub fn len(&self) -> usize {
+        self.0.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.0.is_empty()
+    }
+}
+
+/// The single writer for queued edits. They go in as one bulk edit, so a frame with more
+/// edits than the journal holds resyncs its consumers once instead of cycling the journal.
+pub fn apply_voxel_edits(mut queue: ResMut<VoxelEditQueue>, mut voxel_world: ResMut<VoxelWorld>) {
+    let edits: Vec<(IVec3, Option<BlockType>)> = queue.0.drain(..).map(Into::into).collect();
+    voxel_world.apply_bulk(&edits);
+}
+
+/// Plugin for the edit queue and the [`VoxelSet`] ordering
+pub struct VoxelEditsPlugin;
+
+impl Plugin for VoxelEditsPlugin {
+    fn build(&self, app: &mut App) {
+        app.init_resource::<VoxelEditQueue>()
+            .configure_sets(
+                Update,
+                (
+                    VoxelSet::Edit,
+                    VoxelSet::Apply,
+                    VoxelSet::Replace,
+                    VoxelSet::Read,
+                )
+                    .chain(),
+            )
+            .add_systems(
+                Update,
+                apply_voxel_edits
+                    .run_if(|queue: Res<VoxelEditQueue>| !queue.is_empty())
+                    .in_set(VoxelSet::Apply),
+            );
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use bevy::ecs::system::Deferred;
+
+    #[test]
+    fn test_queued_edits_apply_in_order() {
+        let mut app = App::new();
+        app.add_plugins(VoxelEditsPlugin)
+            .init_resource::<VoxelWorld>()
+            .add_systems(
+                Update,
+                (|mut edits: Deferred<VoxelEdits>| {
+                    edits.place(IVec3::new(1, 0, 0), BlockType::Stone);
+                    edits.place(IVec3::new(2, 0, 0), BlockType::Grass);
+                    edits.remove(IVec3::new(1, 0, 0));
+                })
+                .run_if(|mut ran: Local<bool>| !std::mem::replace(&mut *ran, true))
+                .in_set(VoxelSet::Edit),
+            )
+            .add_systems(
+                Update,
+                (|voxel_world: Res<VoxelWorld>| {
+                    // Readers see the edits queued earlier in the same frame
+                    assert!(voxel_world.is_block_at(IVec3::new(2, 0, 0)));
+                })
+                .in_set(VoxelSet::Read),
+            );
+        app.update();
+
+        let voxel_world = app.world().resource::<VoxelWorld>();
+        assert!(!voxel_world.is_block_at(IVec3::new(1, 0, 0)));
+        assert_eq!(
+            voxel_world.blocks().get(&IVec3::new(2, 0, 0)),
+            Some(&BlockType::Grass)
+        );
+        assert_eq!(voxel_world.generation(), 3);
+        assert!(app.world().resource::<VoxelEditQueue>().is_empty());
+    }
+
+    #[test]
+    fn test_replacement_drops_edits_queued_for_the_old_world() {
+        let once = |mut ran: Local<bool>| !std::mem::replace(&mut *ran, true);
+        let mut app = App::new();
+        app.add_plugins(VoxelEditsPlugin)
+            .init_resource::<VoxelWorld>()
+            .add_systems(
+                Update,
+                (|mut edits: Deferred<VoxelEdits>| {
+                    edits.place(IVec3::new(1, 0, 0), BlockType::Stone);
+                })
+                .run_if(once)
+                .in_set(VoxelSet::Edit),
+            )
+            .add_systems(
+                Update,
+                (|mut voxel_world: ResMut<VoxelWorld>| {
+                    let loaded = [(IVec3::new(5, 0, 0), BlockType::Grass)];
+                    voxel_world.replace_blocks(loaded.into_iter().collect());
+                })
+                .run_if(once)
+                .in_set(VoxelSet::Replace),
+            );
+        app.update();
+        app.update();
+
+        let voxel_world = app.world().resource::<VoxelWorld>();
+        assert!(!voxel_world.is_block_at(IVec3::new(1, 0, 0)));
+        assert!(voxel_world.is_block_at(IVec3::new(5, 0, 0)));
+        assert!(app.world().resource::<VoxelEditQueue>().is_empty());
+    }
+}
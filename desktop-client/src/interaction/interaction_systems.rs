@@ -7,11 +7,11 @@ use std::time::Duration;
 use super::interaction_types::*;
 use crate::config::MqttConfig;
 use crate::devices::{
-    DeviceEntity,
+    DeviceEntity, DeviceIndex,
     device_types::{DoorState, OriginalPosition},
 };
 use crate::environment::Ground;
-use crate::environment::VoxelWorld;
+use crate::environment::{VoxelSet, VoxelWorld};
 use crate::inventory::{ItemType, PlaceBlockEvent, PlayerInventory};
 
 pub struct InteractionPlugin;
@@ -39,6 +39,7 @@ impl Plugin for InteractionPlugin {
                     draw_crosshair,
                 )
                     .chain()
+                    .in_set(VoxelSet::Read)
                     .run_if(in_state(crate::ui::GameState::InGame)),
             );
     }
@@ -48,7 +49,7 @@ impl Plugin for InteractionPlugin {
 mod tests {
     use super::*;
     use crate::devices::{
-        DeviceEntity,
+        DeviceEntity, DeviceIndex,
         device_types::{DoorState, OriginalPosition},
     };
     use bevy::ecs::system::IntoSystem;
@@ -110,6 +111,9 @@ mod tests {
                 Transform::from_translation(Vec3::new(1.0, 0.0, 1.0)),
             ))
             .id();
+        let mut device_index = DeviceIndex::default();
+        device_index.insert("test_door", device_entity, Vec3::new(1.0, 0.0, 1.0));
+        world.insert_resource(device_index);
 
         // Send door toggle event
         let mut event_writer = world.resource_mut::<Events<DoorToggleEvent>>();
@@ -232,7 +236,8 @@ fn setup_door_materials(
 fn raycast_interaction_system(
     camera_query: Single<(&Camera, &GlobalTransform)>,
     windows: Query<&Window>,
-    interactable_query: Query<(Entity, &GlobalTransform), With<Interactable>>,
+    interactable_query: Query<(), With<Interactable>>,
+    device_index: Res<DeviceIndex>,
     mut hovered_entity: ResMut<HoveredEntity>,
     #[cfg(feature = "console")] game_state: Res<State<crate::ui::GameState>>,
 ) {
@@ -267,34 +272,14 @@ fn raycast_interaction_system(
         return;
     };
 
-    let mut closest_entity = None;
-    let mut closest_distance = f32::MAX;
-
-    // Check all interactable entities
-    for (entity, transform) in interactable_query.iter() {
-        let entity_position = transform.translation();
-
-        // Simple sphere collision detection (assuming 1x1x1 cubes)
-        let sphere_radius = 0.7; // Slightly smaller than cube for better UX
-
-        // Calculate closest point on ray to sphere center
-        let to_sphere = entity_position - ray.origin;
-        let projection_length = to_sphere.dot(*ray.direction);
-
-        if projection_length < 0.0 {
-            continue; // Behind the camera
-        }
-
-        let closest_point = ray.origin + ray.direction * projection_length;
-        let distance_to_sphere = (closest_point - entity_position).length();
-
-        if distance_to_sphere <= sphere_radius && projection_length < closest_distance {
-            closest_distance = projection_length;
-            closest_entity = Some(entity);
-        }
-    }
-
-    hovered_entity.entity = closest_entity;
+    // Interactables are devices, so pick through the device index; spheres are slightly
+    // smaller than the 1x1x1 cubes for better UX
+    let sphere_radius = 0.7;
+    hovered_entity.entity = device_index
+        .ray_cast(ray, sphere_radius, |entity| {
+            interactable_query.contains(entity)
+        })
+        .map(|(entity, _)| entity);
 }
 
 /// Updates the ghost block preview
@@ -582,23 +567,14 @@ fn handle_interaction_events(
 fn handle_lamp_toggle_events(
     mut lamp_toggle_events: EventReader<LampToggleEvent>,
     mut lamp_query: Query<&mut LampState>,
-    device_query: Query<(Entity, &DeviceEntity)>,
+    device_index: Res<DeviceIndex>,
     mut commands: Commands,
     mqtt_config: Res<MqttConfig>,
 ) {
     for event in lamp_toggle_events.read() {
         info!("Toggling lamp {} to {}", event.device_id, event.new_state);
 
-        // Find the entity with this device_id
-        let mut found_entity = None;
-        for (entity, device) in device_query.iter() {
-            if device.device_id == event.device_id {
-                found_entity = Some(entity);
-                break;
-            }
-        }
-
-        if let Some(entity) = found_entity {
+        if let Some(entity) = device_index.get(&event.device_id) {
             // Update or add lamp state component
             if let Ok(mut lamp_state) = lamp_query.get_mut(entity) {
                 lamp_state.is_on = event.new_state;
@@ -656,7 +632,7 @@ fn handle_lamp_toggle_events(
 fn handle_door_toggle_events(
     mut door_toggle_events: EventReader<DoorToggleEvent>,
     mut door_query: Query<&mut DoorState>,
-    device_query: Query<(Entity, &DeviceEntity)>,
+    device_index: Res<DeviceIndex>,
     mut commands: Commands,
 ) {
     for event in door_toggle_events.read() {
@@ -666,16 +642,7 @@ fn handle_door_toggle_events(
             if event.new_state { "open" } else { "closed" }
         );
 
-        // Find the entity with this device_id
-        let mut found_entity = None;
-        for (entity, device) in device_query.iter() {
-            if device.device_id == event.device_id {
-                found_entity = Some(entity);
-                break;
-            }
-        }
-
-        if let Some(entity) = found_entity {
+        if let Some(entity) = device_index.get(&event.device_id) {
             // Update or add door state component
             if let Ok(mut door_state) = door_query.get_mut(entity) {
                 door_state.is_open = event.new_state;
@@ -122,15 +122,7 @@ pub fn place_block_system_bundled(
                 let cube_mesh = visuals_params
                     .meshes
                     .add(Cuboid::new(CUBE_SIZE, CUBE_SIZE, CUBE_SIZE));
-                let texture_path = match block_type {
-                    BlockType::Grass => "textures/grass.webp",
-                    BlockType::Dirt => "textures/dirt.webp",
-                    BlockType::Stone => "textures/stone.webp",
-                    BlockType::QuartzBlock => "textures/quartz_block.webp",
-                    BlockType::GlassPane => "textures/glass_pane.webp",
-                    BlockType::CyanTerracotta => "textures/cyan_terracotta.webp",
-                    BlockType::Water => "textures/water.webp",
-                };
+                let texture_path = block_type.texture_path();
                 let texture: Handle<Image> = visuals_params.asset_server.load(texture_path);
                 let material = visuals_params.materials.add(StandardMaterial {
                     base_color_texture: Some(texture),
@@ -179,15 +171,7 @@ pub fn comprehensive_place_block_system_bundled(mut params: ComprehensiveBlockPl
                     .visuals
                     .meshes
                     .add(Cuboid::new(CUBE_SIZE, CUBE_SIZE, CUBE_SIZE));
-                let texture_path = match block_type {
-                    BlockType::Grass => "textures/grass.webp",
-                    BlockType::Dirt => "textures/dirt.webp",
-                    BlockType::Stone => "textures/stone.webp",
-                    BlockType::QuartzBlock => "textures/quartz_block.webp",
-                    BlockType::GlassPane => "textures/glass_pane.webp",
-                    BlockType::CyanTerracotta => "textures/cyan_terracotta.webp",
-                    BlockType::Water => "textures/water.webp",
-                };
+                let texture_path = block_type.texture_path();
                 let texture: Handle<Image> = params.visuals.asset_server.load(texture_path);
                 let material = params.visuals.materials.add(StandardMaterial {
                     base_color_texture: Some(texture),
@@ -1,7 +1,9 @@
-use crate::environment::{BlockType, VoxelWorld};
+use crate::environment::VoxelEdits;
 use crate::inventory::{
     BreakBlockEvent, GiveItemEvent, ItemType, PlaceBlockEvent, PlayerInventory,
 };
+use crate::shared_materials::SharedBlockMaterials;
+use bevy::ecs::system::Deferred;
 use bevy::prelude::*;
 
 /// System to handle give item events
@@ -24,7 +26,7 @@ pub fn give_item_system(
 #[cfg(test)]
 mod tests {
     use super::*;
-    use crate::environment::{BlockType, VoxelWorld};
+    use crate::environment::{BlockType, VoxelWorld, apply_voxel_edits};
     use crate::inventory::{
         BreakBlockEvent, GiveItemEvent, ItemType, PlaceBlockEvent, PlayerInventory,
     };
@@ -129,6 +131,16 @@ mod tests {
         system.initialize(&mut world);
         let _ = system.run((), &mut world);
 
+        // The removal is queued until the writer system runs
+        assert!(
+            world
+                .resource::<VoxelWorld>()
+                .is_block_at(IVec3::new(5, 5, 5))
+        );
+        let mut apply_system = IntoSystem::into_system(apply_voxel_edits);
+        apply_system.initialize(&mut world);
+        let _ = apply_system.run((), &mut world);
+
         let voxel_world = world.resource::<VoxelWorld>();
         // Block should be removed
         assert!(!voxel_world.is_block_at(IVec3::new(5, 5, 5)));
@@ -138,12 +150,10 @@ mod tests {
 /// System to handle item placement
 pub fn place_block_system(
     mut inventory: ResMut<PlayerInventory>,
-    mut voxel_world: ResMut<VoxelWorld>,
+    mut voxel_edits: Deferred<VoxelEdits>,
     mut events: EventReader<PlaceBlockEvent>,
     mut commands: Commands,
-    mut meshes: ResMut<Assets<Mesh>>,
-    mut materials: ResMut<Assets<StandardMaterial>>,
-    asset_server: Res<AssetServer>,
+    shared_materials: Res<SharedBlockMaterials>,
 ) {
     for event in events.read() {
         // Determine block type: either from event (for MCP commands) or from selected inventory item
@@ -163,37 +173,18 @@ pub fn place_block_system(
                 continue; // No selected item and no block type specified
             };
 
-        // Update the voxel world data
-        voxel_world.set_block(event.position, block_type);
-        info!(
-            "Placed block {:?} at {:?} in VoxelWorld",
-            block_type, event.position
-        );
-
-        // Spawn the visual block
-        let cube_mesh = meshes.add(Cuboid::new(
-            crate::environment::CUBE_SIZE,
-            crate::environment::CUBE_SIZE,
-            crate::environment::CUBE_SIZE,
-        ));
-        let texture_path = match block_type {
-            BlockType::Grass => "textures/grass.webp",
-            BlockType::Dirt => "textures/dirt.webp",
-            BlockType::Stone => "textures/stone.webp",
-            BlockType::QuartzBlock => "textures/quartz_block.webp",
-            BlockType::GlassPane => "textures/glass_pane.webp",
-            BlockType::CyanTerracotta => "textures/cyan_terracotta.webp",
-            BlockType::Water => "textures/water.webp",
-        };
-        let texture: Handle<Image> = asset_server.load(texture_path);
-        let material = materials.add(StandardMaterial {
-            base_color_texture: Some(texture),
-            ..default()
-        });
+        // Queue the voxel world update for apply_voxel_edits
+        voxel_edits.place(event.position, block_type);
+        info!("Placed block {:?} at {:?}", block_type, event.position);
 
+        // Spawn the visual block with the shared cube mesh and material
         commands.spawn((
-            Mesh3d(cube_mesh),
-            MeshMaterial3d(material),
+            Mesh3d(shared_materials.shared_mesh.clone()),
+            MeshMaterial3d(
+                shared_materials
+                    .get_material(block_type)
+                    .unwrap_or_default(),
+            ),
             Transform::from_translation(event.position.as_vec3()),
             crate::environment::VoxelBlock {
                 position: event.position,
@@ -327,13 +318,13 @@ pub fn place_block_multiplayer_sync_system(
 /// System to handle block breaking with visual entity removal
 pub fn break_block_system(
     mut events: EventReader<BreakBlockEvent>,
-    mut voxel_world: ResMut<VoxelWorld>,
+    mut voxel_edits: Deferred<VoxelEdits>,
     mut commands: Commands,
     existing_blocks_query: Query<(Entity, &crate::environment::VoxelBlock)>,
 ) {
     for event in events.read() {
-        // Remove from voxel world data
-        voxel_world.remove_block(&event.position);
+        // Queue the removal for apply_voxel_edits
+        voxel_edits.remove(event.position);
 
         // Remove visual entity if it exists
         for (entity, block) in existing_blocks_query.iter() {
@@ -344,7 +335,7 @@ pub fn break_block_system(
             }
         }
 
-        info!("Block removed from VoxelWorld at {:?}", event.position);
+        info!("Block removed at {:?}", event.position);
     }
 }
 
@@ -24,9 +24,9 @@ impl Plugin for InventoryPlugin {
                 Update,
                 (
                     give_item_system,
-                    place_block_system,
+                    place_block_system.in_set(crate::environment::VoxelSet::Edit),
                     place_block_multiplayer_sync_system,
-                    break_block_system,
+                    break_block_system.in_set(crate::environment::VoxelSet::Edit),
                     break_block_multiplayer_sync_system,
                 ),
             );
@@ -107,6 +107,9 @@ pub mod minimap;
 // WASM performance limits and safety constants
 pub mod wasm_limits;
 
+// Memory budget enforcement (buffer pools, chunk mesh residency)
+pub mod memory_governor;
+
 #[cfg(not(target_arch = "wasm32"))]
 pub mod player_avatar;
 
@@ -116,6 +119,9 @@ pub use lib_gradual::*;
 #[cfg(target_arch = "wasm32")]
 pub use lib_debug::{debug_set_panic_hook, debug_start};
 
+#[cfg(target_arch = "wasm32")]
+pub use mqtt::web::bench_mqtt_decode;
+
 // Cross-platform tests that work on both desktop and WASM
 #[cfg(test)]
 mod tests {
@@ -735,6 +735,7 @@ pub fn start() {
         .add_plugins(crate::console::ConsolePlugin) // Add full desktop console (with T key)
         .add_plugins(crate::web_player_controller::WebPlayerControllerPlugin) // Add web player controller with gravity and fly mode
         .add_plugins(crate::inventory::InventoryPlugin) // Add inventory system
+        .add_plugins(crate::environment::VoxelEditsPlugin) // Single writer for queued block edits
         .add_plugins(crate::ui::InventoryUiPlugin) // Add inventory UI (hotbar)
         // Add error indicator plugin for ErrorResource (used by world systems)
         .add_plugins(crate::ui::error_indicator::ErrorIndicatorPlugin)
@@ -742,6 +743,8 @@ pub fn start() {
         .add_plugins(crate::multiplayer_web::WebMultiplayerPlugin) // Add web multiplayer for block sync
         // Add world plugin for world management (DiscoveredWorlds resource)
         .add_plugins(crate::world::WorldPlugin)
+        // Shared per-block-type materials, used by chunk meshes
+        .add_plugins(crate::shared_materials::SharedMaterialsPlugin)
         // Add minimap plugin (same as desktop)
         .add_plugins(crate::minimap::MinimapPlugin)
         // Note: OnlineWorlds resource initialized by MainMenuPlugin for WASM compatibility
@@ -1830,14 +1833,14 @@ fn execute_pending_commands_web_wrapper(
         info!(
             "Web: Completed execution of {} template commands. World now has {} blocks.",
             total_commands,
-            voxel_world.blocks.len()
+            voxel_world.blocks().len()
         );
         #[cfg(target_arch = "wasm32")]
         web_sys::console::log_1(
             &format!(
                 "✅ Web: Template execution complete! {} commands processed, {} blocks in world",
                 total_commands,
-                voxel_world.blocks.len()
+                voxel_world.blocks().len()
             )
             .into(),
         );
@@ -1860,58 +1863,110 @@ fn parse_block_type(block_type_str: &str) -> Option<crate::environment::BlockTyp
 
 /// System to synchronize visual block entities with VoxelWorld data for WASM
 /// This ensures blocks added via template scripts get visual representation
-/// Same as desktop version but specifically for WASM context
+/// Same as desktop version but specifically for WASM context.
+/// Blocks inside chunk-meshed chunks are not given entities; edited chunks are remeshed.
+/// Only the edits journaled since the last sync are visited, with a full diff against
+/// the world when the journal no longer reaches back that far.
 fn sync_block_visuals_web(
     voxel_world: Res<crate::environment::VoxelWorld>,
-    existing_blocks_query: Query<&crate::environment::VoxelBlock>,
+    mut synced_generation: Local<u64>,
+    existing_blocks_query: Query<(
+        Entity,
+        &crate::environment::VoxelBlock,
+        &MeshMaterial3d<StandardMaterial>,
+    )>,
     mut commands: Commands,
     mut meshes: ResMut<Assets<Mesh>>,
-    mut materials: ResMut<Assets<StandardMaterial>>,
-    asset_server: Res<AssetServer>,
+    mut meshed_chunks: ResMut<crate::world::chunk_mesh::MeshedChunks>,
+    shared_materials: Res<crate::shared_materials::SharedBlockMaterials>,
 ) {
     // Only run this sync when voxel world changes to avoid performance issues
-    if !voxel_world.is_changed() {
+    if voxel_world.generation() == *synced_generation {
         return;
     }
 
-    // Get all existing visual block positions
-    let existing_positions: std::collections::HashSet<bevy::math::IVec3> = existing_blocks_query
-        .iter()
-        .map(|block| block.position)
-        .collect();
+    let edited: Option<std::collections::HashSet<bevy::math::IVec3>> =
+        match voxel_world.changes_since(*synced_generation) {
+            crate::environment::WorldChanges::Edits(edits) => {
+                Some(edits.map(|edit| edit.position).collect())
+            }
+            crate::environment::WorldChanges::Resync => None,
+        };
+    *synced_generation = voxel_world.generation();
+
+    if !meshed_chunks.chunks.is_empty() {
+        let stale = match &edited {
+            Some(edited) => meshed_chunks.chunks_touched(edited.iter().copied()),
+            None => meshed_chunks.stale_chunks(voxel_world.blocks()),
+        };
+        if !stale.is_empty() {
+            crate::world::chunk_mesh::remesh_chunks(
+                &mut commands,
+                &mut meshes,
+                &shared_materials,
+                &mut meshed_chunks,
+                voxel_world.blocks(),
+                &stale,
+            );
+            info!("Web: Remeshed {} edited chunks", stale.len());
 
-    // Create visual entities for blocks that don't have them
-    let mut created_visuals = 0;
-    for (pos, block_type) in voxel_world.blocks.iter() {
-        if !existing_positions.contains(pos) {
-            // Create visual entity for this block
-            let cube_mesh = meshes.add(bevy::math::primitives::Cuboid::new(
-                crate::environment::CUBE_SIZE,
-                crate::environment::CUBE_SIZE,
-                crate::environment::CUBE_SIZE,
-            ));
+            // Blocks placed by the interaction handlers are now part of the chunk mesh
+            for (entity, block, _) in existing_blocks_query.iter() {
+                if meshed_chunks.contains_block(block.position) {
+                    commands.entity(entity).despawn();
+                }
+            }
+        }
+    }
 
-            let texture_path = match block_type {
-                crate::environment::BlockType::Grass => "textures/grass.webp",
-                crate::environment::BlockType::Dirt => "textures/dirt.webp",
-                crate::environment::BlockType::Stone => "textures/stone.webp",
-                crate::environment::BlockType::QuartzBlock => "textures/quartz_block.webp",
-                crate::environment::BlockType::GlassPane => "textures/glass_pane.webp",
-                crate::environment::BlockType::CyanTerracotta => "textures/cyan_terracotta.webp",
-                crate::environment::BlockType::Water => "textures/water.webp",
-            };
+    // Visual blocks at the positions that matter for this sync: despawn the ones whose
+    // block is gone and recolour the ones whose block changed type
+    let mut existing_positions = std::collections::HashSet::new();
+    for (entity, block, material) in existing_blocks_query.iter() {
+        if edited
+            .as_ref()
+            .is_some_and(|edited| !edited.contains(&block.position))
+        {
+            continue;
+        }
+        let Some(block_type) = voxel_world.blocks().get(&block.position) else {
+            commands.entity(entity).despawn();
+            continue;
+        };
+        let expected = shared_materials
+            .get_material(*block_type)
+            .unwrap_or_default();
+        if material.0 != expected {
+            commands.entity(entity).insert(MeshMaterial3d(expected));
+        }
+        existing_positions.insert(block.position);
+    }
+    let candidates: Vec<(bevy::math::IVec3, crate::environment::BlockType)> = match &edited {
+        Some(edited) => edited
+            .iter()
+            .filter_map(|pos| voxel_world.blocks().get(pos).map(|block| (*pos, *block)))
+            .collect(),
+        None => voxel_world
+            .blocks()
+            .iter()
+            .map(|(pos, block)| (*pos, *block))
+            .collect(),
+    };
 
-            let texture: Handle<Image> = asset_server.load(texture_path);
-            let material = materials.add(StandardMaterial {
-                base_color_texture: Some(texture),
-                ..default()
-            });
+    // Create visual entities for blocks that don't have them
+    let mut created_visuals = 0;
+    for (pos, block_type) in candidates {
+        if !existing_positions.contains(&pos) && !meshed_chunks.contains_block(pos) {
+            // Create visual entity for this block with the shared cube mesh and material
+            let material = shared_materials
+                .get_material(block_type)
+                .unwrap_or_default();
 
             commands.spawn((
-                Mesh3d(cube_mesh),
+                Mesh3d(shared_materials.shared_mesh.clone()),
                 MeshMaterial3d(material),
                 Transform::from_translation(pos.as_vec3()),
-                crate::environment::VoxelBlock { position: *pos },
+                crate::environment::VoxelBlock { position: pos },
                 Name::new(format!("WebSyncBlock-{}-{}-{}", pos.x, pos.y, pos.z)),
             ));
 
@@ -1930,7 +1985,7 @@ fn sync_block_visuals_web(
             &format!(
                 "Web: Synced {} visual entities for VoxelWorld blocks (total blocks: {})",
                 created_visuals,
-                voxel_world.blocks.len()
+                voxel_world.blocks().len()
             )
             .into(),
         );
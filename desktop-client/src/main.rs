@@ -51,6 +51,8 @@ mod localization;
 #[cfg(not(target_arch = "wasm32"))]
 mod mcp;
 #[cfg(not(target_arch = "wasm32"))]
+mod memory_governor;
+#[cfg(not(target_arch = "wasm32"))]
 mod minimap;
 #[cfg(not(target_arch = "wasm32"))]
 mod mqtt;
@@ -74,6 +76,8 @@ mod rendering;
 #[cfg(not(target_arch = "wasm32"))]
 mod shared_materials;
 #[cfg(not(target_arch = "wasm32"))]
+mod wasm_limits;
+#[cfg(not(target_arch = "wasm32"))]
 mod world;
 
 // Re-export types for easier access
@@ -189,9 +193,7 @@ struct ExecuteCommandsParams<'w, 's> {
     mqtt_config: Res<'w, MqttConfig>,
     voxel_world: ResMut<'w, VoxelWorld>,
     commands: Commands<'w, 's>,
-    meshes: ResMut<'w, Assets<Mesh>>,
-    materials: ResMut<'w, Assets<StandardMaterial>>,
-    asset_server: Res<'w, AssetServer>,
+    shared_materials: Res<'w, shared_materials::SharedBlockMaterials>,
     block_query: Query<'w, 's, (Entity, &'static VoxelBlock)>,
     device_query: Query<'w, 's, (&'static DeviceEntity, &'static Transform), Without<Camera>>,
     inventory: ResMut<'w, PlayerInventory>,
@@ -322,7 +324,7 @@ fn execute_pending_commands(mut params: ExecuteCommandsParams) {
                 }
             }
             "get_world_status" => {
-                let block_count = params.voxel_world.blocks.len();
+                let block_count = params.voxel_world.blocks().len();
                 let device_count = params.device_query.iter().count();
 
                 let result_msg = json!({
@@ -596,39 +598,14 @@ fn execute_pending_commands(mut params: ExecuteCommandsParams) {
                                     .voxel_world
                                     .set_block(IVec3::new(x, y, z), block_type);
 
-                                // Spawn the block
-                                let cube_mesh = params
-                                    .meshes
-                                    .add(Cuboid::new(CUBE_SIZE, CUBE_SIZE, CUBE_SIZE));
-                                let material = match block_type {
-                                    BlockType::Water => params.materials.add(StandardMaterial {
-                                        base_color: Color::srgba(0.0, 0.35, 0.9, 0.6),
-                                        alpha_mode: AlphaMode::Blend,
-                                        ..default()
-                                    }),
-                                    _ => {
-                                        let texture_path = match block_type {
-                                            BlockType::Grass => "textures/grass.webp",
-                                            BlockType::Dirt => "textures/dirt.webp",
-                                            BlockType::Stone => "textures/stone.webp",
-                                            BlockType::QuartzBlock => "textures/quartz_block.webp",
-                                            BlockType::GlassPane => "textures/glass_pane.webp",
-                                            BlockType::CyanTerracotta => {
-                                                "textures/cyan_terracotta.webp"
-                                            }
-                                            _ => unreachable!(),
-                                        };
-                                        let texture: Handle<Image> =
-                                            params.asset_server.load(texture_path);
-                                        params.materials.add(StandardMaterial {
-                                            base_color_texture: Some(texture),
-                                            ..default()
-                                        })
-                                    }
-                                };
+                                // Spawn the block with the shared cube mesh and material
+                                let material = params
+                                    .shared_materials
+                                    .get_material(block_type)
+                                    .unwrap_or_default();
 
                                 params.commands.spawn((
-                                    Mesh3d(cube_mesh),
+                                    Mesh3d(params.shared_materials.shared_mesh.clone()),
                                     MeshMaterial3d(material),
                                     Transform::from_translation(Vec3::new(
                                         x as f32, y as f32, z as f32,
@@ -751,51 +728,19 @@ fn execute_pending_commands(mut params: ExecuteCommandsParams) {
                                             // Debug: VoxelWorld before adding blocks
                                             info!(
                                                 "[DEBUG] VoxelWorld before wall command: {} blocks",
-                                                params.voxel_world.blocks.len()
+                                                params.voxel_world.blocks().len()
                                             );
                                             info!(
                                                 "[DEBUG] Wall command: {} from ({}, {}, {}) to ({}, {}, {})",
                                                 block_type_str, x1, y1, z1, x2, y2, z2
                                             );
 
-                                            let material = match block_type_enum {
-                                                BlockType::Water => {
-                                                    params.materials.add(StandardMaterial {
-                                                        base_color: Color::srgba(
-                                                            0.0, 0.35, 0.9, 0.6,
-                                                        ),
-                                                        alpha_mode: AlphaMode::Blend,
-                                                        ..default()
-                                                    })
-                                                }
-                                                _ => {
-                                                    let texture_path = match block_type_enum {
-                                                        BlockType::Grass => "textures/grass.webp",
-                                                        BlockType::Dirt => "textures/dirt.webp",
-                                                        BlockType::Stone => "textures/stone.webp",
-                                                        BlockType::QuartzBlock => {
-                                                            "textures/quartz_block.webp"
-                                                        }
-                                                        BlockType::GlassPane => {
-                                                            "textures/glass_pane.webp"
-                                                        }
-                                                        BlockType::CyanTerracotta => {
-                                                            "textures/cyan_terracotta.webp"
-                                                        }
-                                                        _ => unreachable!(),
-                                                    };
-                                                    let texture: Handle<Image> =
-                                                        params.asset_server.load(texture_path);
-                                                    params.materials.add(StandardMaterial {
-                                                        base_color_texture: Some(texture),
-                                                        ..default()
-                                                    })
-                                                }
-                                            };
-
-                                            let cube_mesh = params
-                                                .meshes
-                                                .add(Cuboid::new(CUBE_SIZE, CUBE_SIZE, CUBE_SIZE));
+                                            let material = params
+                                                .shared_materials
+                                                .get_material(block_type_enum)
+                                                .unwrap_or_default();
+                                            let cube_mesh =
+                                                params.shared_materials.shared_mesh.clone();
 
                                             let mut blocks_added = 0;
                                             for x in x1..=x2 {
@@ -825,7 +770,7 @@ fn execute_pending_commands(mut params: ExecuteCommandsParams) {
                                             // Debug: VoxelWorld after adding blocks
                                             info!(
                                                 "VoxelWorld after wall command: {} blocks (added {})",
-                                                params.voxel_world.blocks.len(),
+                                                params.voxel_world.blocks().len(),
                                                 blocks_added
                                             );
 
@@ -1308,7 +1253,7 @@ mod wall_command_tests {
         // Example: wall stone 21 1 -21 26 1 -26 created 0 blocks because -21 > -26
 
         let mut voxel_world = VoxelWorld::default();
-        let initial_count = voxel_world.blocks.len();
+        let initial_count = voxel_world.blocks().len();
 
         // Test case 1: Backwards Z coordinates (the problematic case from new_world.txt)
         // This should create 0 blocks due to invalid range (start > end)
@@ -1331,7 +1276,7 @@ mod wall_command_tests {
             "Backwards Z coordinates (-21 to -26) should create 0 blocks"
         );
         assert_eq!(
-            voxel_world.blocks.len(),
+            voxel_world.blocks().len(),
             initial_count,
             "VoxelWorld should have no new blocks with invalid coordinate range"
         );
@@ -1357,7 +1302,7 @@ mod wall_command_tests {
             "Correctly ordered coordinates should create 36 blocks"
         );
         assert_eq!(
-            voxel_world.blocks.len(),
+            voxel_world.blocks().len(),
             initial_count + 36,
             "VoxelWorld should have 36 new blocks with valid coordinate range"
         );
@@ -1438,15 +1383,23 @@ async fn main() {
     let window_x = 50.0 + (client_offset as f32 * 300.0); // Offset by 300px per client
     let window_y = 50.0 + (client_offset as f32 * 50.0); // Offset by 50px per client
 
-    app.add_plugins(DefaultPlugins.set(WindowPlugin {
-        primary_window: Some(Window {
-            title: window_title,
-            resolution: bevy::window::WindowResolution::new(1280, 720),
-            position: WindowPosition::At(IVec2::new(window_x as i32, window_y as i32)),
-            ..default()
-        }),
-        ..default()
-    }));
+    app.add_plugins(
+        DefaultPlugins
+            .set(WindowPlugin {
+                primary_window: Some(Window {
+                    title: window_title,
+                    resolution: bevy::window::WindowResolution::new(1280, 720),
+                    position: WindowPosition::At(IVec2::new(window_x as i32, window_y as i32)),
+                    ..default()
+                }),
+                ..default()
+            })
+            .set(bevy::log::LogPlugin {
+                // Times system spans for the profiler panel and trace captures
+                custom_layer: debug::profiler::profiler_layer,
+                ..default()
+            }),
+    );
 
     // Initialize fonts resource immediately after AssetServer is available
     // We need to do this in a way that ensures AssetServer exists
@@ -1472,6 +1425,7 @@ async fn main() {
     app.add_plugins(DevicePlugin)
         .add_plugins(DevicePositioningPlugin)
         .add_plugins(EnvironmentPlugin)
+        .add_plugins(VoxelEditsPlugin)
         .add_plugins(MyInteractionPlugin)
         .add_plugins(MqttPlugin)
         .add_plugins(InventoryPlugin)
@@ -1485,7 +1439,8 @@ async fn main() {
         .add_plugins(SharedWorldPlugin)
         .add_plugins(WorldPublisherPlugin)
         .add_plugins(WorldDiscoveryPlugin)
-        .add_plugins(PlayerAvatarPlugin);
+        .add_plugins(PlayerAvatarPlugin)
+        .add_plugins(debug::profiler::ProfilerPlugin);
 
     // Add CommandExecutedEvent unconditionally since it's used by execute_pending_commands
     app.add_event::<CommandExecutedEvent>();
@@ -1535,7 +1490,9 @@ async fn main() {
             // Commands must run first to spawn entities - run in PreUpdate for better isolation
             execute_pending_commands,
             execute_console_commands,
-        ),
+        )
+            // Scripts queue their non-block commands for these
+            .after(script::script_systems::execute_pending_scripts),
     );
 
     app.add_systems(
@@ -1741,7 +1698,7 @@ fn update_diagnostics_content(
 
             // Calculate additional useful information
             let device_count = device_query.iter().count();
-            let block_count = voxel_world.blocks.len();
+            let block_count = voxel_world.blocks().len();
             let selected_slot = inventory.selected_slot + 1; // 1-indexed for display
 
             // Get selected item info
@@ -1838,6 +1795,7 @@ fn update_diagnostics_content(
                 "iotcraft/worlds/+/changes".to_string(),
                 "iotcraft/worlds/+/state/blocks/placed".to_string(),
                 "iotcraft/worlds/+/state/blocks/removed".to_string(),
+                "iotcraft/worlds/+/state/blocks/batch".to_string(),
             ];
 
             // Get last messages from WorldDiscovery resource
@@ -60,7 +60,7 @@ pub fn execute_mcp_command_bundled(
             execute_get_mqtt_status_command(_core_params, multiplayer_params)
         }
         "get_world_status" => {
-            let block_count = world_params.voxel_world.blocks.len();
+            let block_count = world_params.voxel_world.blocks().len();
 
             // TEMPORARY DEBUG: Comment out device_query to isolate blocking issue
             // let device_count = entity_params.device_query.iter().count();
@@ -119,6 +119,19 @@ pub fn execute_mcp_command_bundled(
         "create_wall" => {
             execute_create_wall_command(arguments, world_params)
         }
+        // Bulk block commands, applied in this pass
+        "place_blocks" => {
+            execute_place_blocks_command(arguments, world_params, multiplayer_params)
+        }
+        "fill_region" => {
+            execute_fill_region_command(arguments, world_params, multiplayer_params)
+        }
+        "copy_region" => {
+            execute_copy_region_command(arguments, world_params)
+        }
+        "paste_region" => {
+            execute_paste_region_command(arguments, world_params, multiplayer_params)
+        }
         // Camera and movement commands
         "player_move" => {
             execute_player_move_command(arguments, entity_params)
@@ -768,6 +781,286 @@ fn execute_create_wall_command(arguments: &Value, world_params: &mut WorldMcpPar
     }
 }
 
+/// Apply bulk block edits (`None` removes) to the VoxelWorld with one
+/// [`apply_bulk`](crate::environment::VoxelWorld::apply_bulk) call; edits that change
+/// nothing are skipped. `sync_block_visuals`, which runs after the MCP commands, spawns,
+/// despawns or recolours the visuals of the journaled edits. In multiplayer the effective edits are broadcast as one batch, which goes out as a few
+/// `state/blocks/batch` messages rather than one message per block.
+/// Returns (placed, removed).
+fn apply_bulk_edits(
+    edits: impl IntoIterator<Item = (IVec3, Option<crate::environment::BlockType>)>,
+    world_params: &mut WorldMcpParams,
+    multiplayer_params: &MultiplayerMcpParams,
+) -> (usize, usize) {
+    use crate::multiplayer::{BlockChangeBatchEvent, BlockChangeType, MultiplayerMode};
+
+    let world_id = match multiplayer_params.multiplayer_mode.as_deref() {
+        Some(
+            MultiplayerMode::HostingWorld { world_id, .. }
+            | MultiplayerMode::JoinedWorld { world_id, .. },
+        ) => Some(world_id.clone()),
+        _ => None,
+    };
+
+    let (mut placed, mut removed) = (0, 0);
+    let mut effective = Vec::new();
+    // Later edits of the same position see the earlier ones
+    let mut pending = std::collections::HashMap::new();
+    let mut changes = Vec::new();
+    for (position, block_type) in edits {
+        let old = match pending.get(&position) {
+            Some(&pending) => pending,
+            None => world_params.voxel_world.blocks().get(&position).copied(),
+        };
+        if old == block_type {
+            continue;
+        }
+        pending.insert(position, block_type);
+        effective.push((position, block_type));
+        let change_type = match block_type {
+            Some(block_type) => {
+                placed += 1;
+                BlockChangeType::Placed {
+                    x: position.x,
+                    y: position.y,
+                    z: position.z,
+                    block_type,
+                }
+            }
+            None => {
+                removed += 1;
+                BlockChangeType::Removed {
+                    x: position.x,
+                    y: position.y,
+                    z: position.z,
+                }
+            }
+        };
+        if world_id.is_some() {
+            changes.push(change_type);
+        }
+    }
+    if !effective.is_empty() {
+        world_params.voxel_world.apply_bulk(&effective);
+    }
+
+    if let Some(world_id) = world_id.filter(|_| !changes.is_empty()) {
+        let (player_id, player_name) = world_params
+            .player_profile
+            .as_deref()
+            .map(|p| (p.player_id.clone(), p.player_name.clone()))
+            .unwrap_or_default();
+        world_params
+            .block_change_batches
+            .write(BlockChangeBatchEvent {
+                world_id,
+                player_id,
+                player_name,
+                changes,
+            });
+    }
+    (placed, removed)
+}
+
+/// Both corners (x1..z2) of a bulk region, as (min, max)
+fn parse_region_corners(arguments: &Value) -> Option<(IVec3, IVec3)> {
+    let corner = |suffix: &str| -> Option<IVec3> {
+        let axis = |name: &str| {
+            arguments
+                .get(format!("{}{}", name, suffix))
+                .and_then(|v| v.as_i64())
+                .and_then(|v| i32::try_from(v).ok())
+        };
+        Some(IVec3::new(axis("x")?, axis("y")?, axis("z")?))
+    };
+    let (a, b) = (corner("1")?, corner("2")?);
+    Some((a.min(b), a.max(b)))
+}
+
+/// Error text for a region over the bulk size limit, if it is
+fn check_region_size(min: IVec3, max: IVec3) -> Option<String> {
+    let cells = iotcraft_mcp_protocol::bulk::region_cells(min.to_array(), max.to_array());
+    (cells > iotcraft_mcp_protocol::bulk::MAX_BULK_BLOCKS).then(|| {
+        format!(
+            "Error: region of {} blocks exceeds the limit of {}",
+            cells,
+            iotcraft_mcp_protocol::bulk::MAX_BULK_BLOCKS
+        )
+    })
+}
+
+/// Place blocks command implementation: many positions of one block type
+fn execute_place_blocks_command(
+    arguments: &Value,
+    world_params: &mut WorldMcpParams,
+    multiplayer_params: &MultiplayerMcpParams,
+) -> String {
+    let (Some(block_type), Some(positions)) = (
+        arguments.get("block_type").and_then(|v| v.as_str()),
+        arguments.get("positions").and_then(|v| v.as_array()),
+    ) else {
+        return "Error: place_blocks requires block_type and positions parameters".to_string();
+    };
+    let Some(block_type_enum) = parse_block_type(block_type) else {
+        return format!("Error: Unknown block type '{}'", block_type);
+    };
+    let Some(packed) = positions
+        .iter()
+        .map(|v| v.as_i64())
+        .collect::<Option<Vec<_>>>()
+    else {
+        return "Error: positions must be integers".to_string();
+    };
+    let positions = match iotcraft_mcp_protocol::bulk::unpack_positions(&packed) {
+        Ok(positions) => positions,
+        Err(e) => return format!("Error: {}", e),
+    };
+
+    let requested = positions.len();
+    let (placed, _) = apply_bulk_edits(
+        positions
+            .into_iter()
+            .map(|p| (IVec3::from_array(p), Some(block_type_enum))),
+        world_params,
+        multiplayer_params,
+    );
+    format!(
+        "Placed {} {} blocks ({} already there)",
+        placed,
+        block_type,
+        requested - placed
+    )
+}
+
+/// Fill region command implementation; "air" clears the region
+fn execute_fill_region_command(
+    arguments: &Value,
+    world_params: &mut WorldMcpParams,
+    multiplayer_params: &MultiplayerMcpParams,
+) -> String {
+    let (Some(block_type), Some((min, max))) = (
+        arguments.get("block_type").and_then(|v| v.as_str()),
+        parse_region_corners(arguments),
+    ) else {
+        return "Error: fill_region requires block_type, x1, y1, z1, x2, y2, z2 parameters"
+            .to_string();
+    };
+    let fill = match block_type {
+        "air" => None,
+        _ => match parse_block_type(block_type) {
+            Some(block_type_enum) => Some(block_type_enum),
+            None => return format!("Error: Unknown block type '{}'", block_type),
+        },
+    };
+    if let Some(error) = check_region_size(min, max) {
+        return error;
+    }
+
+    let cells = (min.y..=max.y).flat_map(move |y| {
+        (min.z..=max.z).flat_map(move |z| (min.x..=max.x).map(move |x| (IVec3::new(x, y, z), fill)))
+    });
+    let (placed, removed) = apply_bulk_edits(cells, world_params, multiplayer_params);
+    format!(
+        "Filled region ({},{},{}) to ({},{},{}) with {}: {} placed, {} removed",
+        min.x, min.y, min.z, max.x, max.y, max.z, block_type, placed, removed
+    )
+}
+
+/// Copy region command implementation: returns the region in the compact encoding
+fn execute_copy_region_command(arguments: &Value, world_params: &WorldMcpParams) -> String {
+    let Some((min, max)) = parse_region_corners(arguments) else {
+        return "Error: copy_region requires x1, y1, z1, x2, y2, z2 parameters".to_string();
+    };
+    if let Some(error) = check_region_size(min, max) {
+        return error;
+    }
+
+    let size = (max - min + IVec3::ONE).as_uvec3().to_array();
+    let region = iotcraft_mcp_protocol::bulk::BlockRegion::encode(size, |[x, y, z]| {
+        let position = min + IVec3::new(x as i32, y as i32, z as i32);
+        world_params
+            .voxel_world
+            .blocks()
+            .get(&position)
+            .map(|block_type| protocol_block_type(*block_type))
+    });
+    json!({
+        "origin": [min.x, min.y, min.z],
+        "region": region,
+    })
+    .to_string()
+}
+
+/// Paste region command implementation
+fn execute_paste_region_command(
+    arguments: &Value,
+    world_params: &mut WorldMcpParams,
+    multiplayer_params: &MultiplayerMcpParams,
+) -> String {
+    let (Some(x), Some(y), Some(z), Some(region)) = (
+        arguments.get("x").and_then(|v| v.as_i64()),
+        arguments.get("y").and_then(|v| v.as_i64()),
+        arguments.get("z").and_then(|v| v.as_i64()),
+        arguments.get("region"),
+    ) else {
+        return "Error: paste_region requires x, y, z and region parameters".to_string();
+    };
+    let region: iotcraft_mcp_protocol::bulk::BlockRegion =
+        match serde_json::from_value(region.clone()) {
+            Ok(region) => region,
+            Err(e) => return format!("Error: invalid region: {}", e),
+        };
+    let include_air = arguments
+        .get("include_air")
+        .and_then(|v| v.as_bool())
+        .unwrap_or(false);
+
+    let (Ok(ox), Ok(oy), Ok(oz)) = (i32::try_from(x), i32::try_from(y), i32::try_from(z)) else {
+        return format!(
+            "Error: paste_region origin ({},{},{}) is out of range",
+            x, y, z
+        );
+    };
+
+    let mut edits = Vec::new();
+    let mut out_of_range = false;
+    let decoded = region.for_each_cell(|offset, block_type| {
+        if out_of_range || (block_type.is_none() && !include_air) {
+            return;
+        }
+        let axis = |origin: i32, offset: u32| {
+            i32::try_from(offset)
+                .ok()
+                .and_then(|offset| origin.checked_add(offset))
+        };
+        let (Some(px), Some(py), Some(pz)) = (
+            axis(ox, offset[0]),
+            axis(oy, offset[1]),
+            axis(oz, offset[2]),
+        ) else {
+            out_of_range = true;
+            return;
+        };
+        let block_type = block_type.and_then(|b| parse_block_type(b.as_str()));
+        edits.push((IVec3::new(px, py, pz), block_type));
+    });
+    if let Err(e) = decoded {
+        return format!("Error: {}", e);
+    }
+    if out_of_range {
+        return format!(
+            "Error: {}x{}x{} region at ({},{},{}) extends past the world coordinate range",
+            region.size[0], region.size[1], region.size[2], x, y, z
+        );
+    }
+
+    let (placed, removed) = apply_bulk_edits(edits, world_params, multiplayer_params);
+    format!(
+        "Pasted {}x{}x{} region at ({},{},{}): {} placed, {} removed",
+        region.size[0], region.size[1], region.size[2], x, y, z, placed, removed
+    )
+}
+
 /// Player move command implementation
 fn execute_player_move_command(arguments: &Value, entity_params: &mut EntityMcpParams) -> String {
     if let (Some(x), Some(y), Some(z)) = (
@@ -1004,6 +1297,23 @@ pub fn execute_create_world_command(
     }
 }
 
+/// The shared protocol's name for a block type
+fn protocol_block_type(
+    block_type: crate::environment::BlockType,
+) -> iotcraft_mcp_protocol::BlockType {
+    use crate::environment::BlockType;
+    use iotcraft_mcp_protocol::BlockType as Protocol;
+    match block_type {
+        BlockType::Grass => Protocol::Grass,
+        BlockType::Dirt => Protocol::Dirt,
+        BlockType::Stone => Protocol::Stone,
+        BlockType::QuartzBlock => Protocol::QuartzBlock,
+        BlockType::GlassPane => Protocol::GlassPane,
+        BlockType::CyanTerracotta => Protocol::CyanTerracotta,
+        BlockType::Water => Protocol::Water,
+    }
+}
+
 /// Parse block type from string for MCP commands
 fn parse_block_type(block_type_str: &str) -> Option<crate::environment::BlockType> {
     match block_type_str.to_lowercase().as_str() {
@@ -1052,6 +1362,29 @@ mod tests {
         assert!(valid_args.get("x").and_then(|v| v.as_i64()).is_some());
     }
 
+    #[test]
+    fn test_bulk_region_arguments() {
+        let corners = json!({"x1": 4, "y1": -2, "z1": 0, "x2": 1, "y2": 3, "z2": 0});
+        assert_eq!(
+            parse_region_corners(&corners),
+            Some((IVec3::new(1, -2, 0), IVec3::new(4, 3, 0)))
+        );
+        assert_eq!(
+            parse_region_corners(&json!({"x1": 0, "y1": 0, "z1": 0})),
+            None
+        );
+        assert!(check_region_size(IVec3::ZERO, IVec3::splat(15)).is_none());
+        assert!(check_region_size(IVec3::ZERO, IVec3::splat(4096)).is_some());
+
+        // Copied regions name blocks the way paste_region parses them back
+        for block_type in BlockType::ALL {
+            assert_eq!(
+                parse_block_type(protocol_block_type(block_type).as_str()),
+                Some(block_type)
+            );
+        }
+    }
+
     #[test]
     fn test_invalid_command_arguments() {
         // Test missing required arguments
@@ -44,6 +44,9 @@ pub struct WorldMcpParams<'w, 's> {
     pub inventory: ResMut<'w, crate::inventory::PlayerInventory>,
     pub place_events: EventWriter<'w, crate::inventory::PlaceBlockEvent>,
     pub break_events: EventWriter<'w, crate::inventory::BreakBlockEvent>,
+    /// Multiplayer broadcast of edits made by the bulk block tools
+    pub block_change_batches: EventWriter<'w, crate::multiplayer::BlockChangeBatchEvent>,
+    pub player_profile: Option<Res<'w, crate::profile::PlayerProfile>>,
     // PhantomData to use the 's lifetime
     _phantom: std::marker::PhantomData<&'s ()>,
 }
@@ -133,6 +136,7 @@ mod tests {
         world.insert_resource(crate::inventory::PlayerInventory::new());
         world.init_resource::<Events<crate::inventory::PlaceBlockEvent>>();
         world.init_resource::<Events<crate::inventory::BreakBlockEvent>>();
+        world.init_resource::<Events<crate::multiplayer::BlockChangeEvent>>();
 
         // Test system that uses WorldMcpParams
         let test_system = |_params: WorldMcpParams| {
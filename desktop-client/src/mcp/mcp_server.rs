@@ -1,7 +1,7 @@
 use crate::{
     config::MqttConfig,
     devices::device_types::DeviceEntity,
-    environment::VoxelWorld,
+    environment::{BlockType, VoxelWorld},
     mcp::{mcp_protocol::error_codes, mcp_tools::McpToolRegistry, mcp_types::*},
     mqtt::TemperatureResource,
     profile::PlayerProfile,
@@ -41,11 +41,22 @@ impl Plugin for McpPlugin {
 
         // Add systems
         app.add_systems(Startup, (start_mcp_server, setup_mcp_mqtt_client))
-            // Add update systems separately to avoid scheduling tuple type issues
-            .add_systems(Update, process_mcp_requests)
-            .add_systems(Update, handle_command_results)
-            .add_systems(Update, execute_mcp_commands)
-            .add_systems(Update, sync_block_visuals);
+            // Chained so a tool call is queued, executed and answered within one frame
+            .add_systems(
+                Update,
+                (
+                    process_mcp_requests,
+                    execute_mcp_commands,
+                    handle_command_results,
+                )
+                    .chain(),
+            )
+            // Before the visual sync, so entities dropped by bulk edits are gone when it
+            // respawns them
+            .add_systems(
+                Update,
+                execute_mcp_commands.before(crate::world::block_visuals::sync_block_visuals),
+            );
 
         info!("MCP Plugin initialized");
     }
@@ -112,13 +123,24 @@ async fn run_mcp_server(
     }
 }
 
+/// Most requests of one connection awaiting their responses; reading pauses beyond this
+const MAX_IN_FLIGHT_PER_CONNECTION: usize = 256;
+
 /// Handle a TCP connection for MCP JSON-RPC
-async fn handle_mcp_connection(
+///
+/// Requests are pipelined: each one is handed to Bevy as soon as its line is read, in
+/// order, so tool calls still execute in the order they were sent. Responses are written
+/// by a separate task as they complete, possibly out of order; clients match them by
+/// `id`. A line holding a JSON array is a JSON-RPC batch and gets one array response.
+pub(super) async fn handle_mcp_connection(
     stream: TcpStream,
     request_sender: async_channel::Sender<McpRequest>,
 ) -> Result<(), Box<dyn std::error::Error + Send + Sync>> {
-    let (reader, mut writer) = stream.into_split();
+    let (reader, writer) = stream.into_split();
     let mut reader = BufReader::new(reader);
+    let (response_tx, response_rx) = tokio::sync::mpsc::unbounded_channel();
+    let writer_task = tokio::spawn(write_responses(writer, response_rx));
+    let in_flight = std::sync::Arc::new(tokio::sync::Semaphore::new(MAX_IN_FLIGHT_PER_CONNECTION));
 
     loop {
         let mut line = String::new();
@@ -137,59 +159,73 @@ async fn handle_mcp_connection(
                 debug!("MCP server received: {}", line);
 
                 // Parse JSON-RPC request
-                match serde_json::from_str::<serde_json::Value>(line) {
+                let requests = match serde_json::from_str::<serde_json::Value>(line) {
+                    Ok(Value::Array(requests)) if !requests.is_empty() => requests,
+                    Ok(Value::Array(_)) => {
+                        let _ = response_tx.send(json!({
+                            "jsonrpc": "2.0",
+                            "id": null,
+                            "error": {
+                                "code": -32600, // Invalid Request
+                                "message": "Empty batch"
+                            }
+                        }));
+                        continue;
+                    }
                     Ok(json_request) => {
-                        // Check if this is a notification (no id field)
+                        // Notifications (no id field) get no response
                         if json_request.get("id").is_none() {
-                            debug!(
-                                "Received notification: {}",
-                                json_request.get("method").unwrap_or(&json!("unknown"))
-                            );
-                            // For notifications, just handle them but don't send a response
-                            if let Some(method) =
-                                json_request.get("method").and_then(|m| m.as_str())
-                            {
-                                match method {
-                                    "notifications/initialized" => {
-                                        info!(
-                                            "MCP client initialization notification received - connection ready"
-                                        );
-                                    }
-                                    _ => {
-                                        warn!("Unknown notification method: {}", method);
-                                    }
-                                }
-                            }
-                            // Don't send a response for notifications
+                            handle_notification(&json_request);
                             continue;
                         }
 
-                        let response = handle_json_rpc_request(json_request, &request_sender).await;
-
-                        // Send response
-                        let response_str = serde_json::to_string(&response)?;
-                        debug!("MCP server sending: {}", response_str);
-
-                        writer.write_all(response_str.as_bytes()).await?;
-                        writer.write_all(b"\n").await?;
+                        let permit = in_flight.clone().acquire_owned().await?;
+                        let submitted =
+                            submit_json_rpc_request(json_request, &request_sender).await;
+                        let response_tx = response_tx.clone();
+                        tokio::spawn(async move {
+                            let _ = response_tx.send(finish_json_rpc_request(submitted).await);
+                            drop(permit);
+                        });
+                        continue;
                     }
                     Err(e) => {
                         error!("Failed to parse JSON-RPC request: {}", e);
 
-                        let error_response = json!({
+                        let _ = response_tx.send(json!({
                             "jsonrpc": "2.0",
                             "id": null,
                             "error": {
                                 "code": -32700, // Parse error
                                 "message": format!("Parse error: {}", e)
                             }
-                        });
+                        }));
+                        continue;
+                    }
+                };
 
-                        let error_str = serde_json::to_string(&error_response)?;
-                        writer.write_all(error_str.as_bytes()).await?;
-                        writer.write_all(b"\n").await?;
+                // Batch: submit every request in order, answer once all are done
+                let permit = in_flight.clone().acquire_owned().await?;
+                let mut submitted = Vec::with_capacity(requests.len());
+                for request in requests {
+                    if request.get("id").is_none() {
+                        handle_notification(&request);
+                    } else {
+                        submitted.push(submit_json_rpc_request(request, &request_sender).await);
                     }
                 }
+                if submitted.is_empty() {
+                    continue;
+                }
+                let response_tx = response_tx.clone();
+                tokio::spawn(async move {
+                    let mut responses = Vec::with_capacity(submitted.len());
+                    for request in submitted {
+                        responses.push(finish_json_rpc_request(request).await);
+                    }
+                    let _ = response_tx.send(Value::Array(responses));
+                    drop(permit);
+                });
             }
             Err(e) => {
                 error!("Failed to read from TCP stream: {}", e);
@@ -198,9 +234,52 @@ async fn handle_mcp_connection(
         }
     }
 
+    // The writer finishes once every in-flight request has sent its response
+    drop(response_tx);
+    writer_task.await??;
+    Ok(())
+}
+
+/// Write responses as they complete, coalescing those ready together into one write
+async fn write_responses(
+    mut writer: tokio::net::tcp::OwnedWriteHalf,
+    mut responses: tokio::sync::mpsc::UnboundedReceiver<Value>,
+) -> std::io::Result<()> {
+    let mut buffer = Vec::new();
+    while let Some(response) = responses.recv().await {
+        let mut next = Some(response);
+        while let Some(response) = next {
+            if let Err(e) = serde_json::to_writer(&mut buffer, &response) {
+                error!("Failed to serialize MCP response: {}", e);
+            }
+            buffer.push(b'\n');
+            next = responses.try_recv().ok();
+        }
+        debug!("MCP server sending {} bytes", buffer.len());
+        writer.write_all(&buffer).await?;
+        buffer.clear();
+    }
     Ok(())
 }
 
+/// Handle a JSON-RPC notification; these never get a response
+fn handle_notification(notification: &Value) {
+    debug!(
+        "Received notification: {}",
+        notification.get("method").unwrap_or(&json!("unknown"))
+    );
+    if let Some(method) = notification.get("method").and_then(|m| m.as_str()) {
+        match method {
+            "notifications/initialized" => {
+                info!("MCP client initialization notification received - connection ready");
+            }
+            _ => {
+                warn!("Unknown notification method: {}", method);
+            }
+        }
+    }
+}
+
 /// Get appropriate timeout duration for different MCP methods
 fn get_method_timeout(method: &str) -> std::time::Duration {
     match method {
@@ -220,36 +299,39 @@ fn get_method_timeout(method: &str) -> std::time::Duration {
     }
 }
 
-/// Handle JSON-RPC request from TCP connection
-async fn handle_json_rpc_request(
+/// A JSON-RPC request handed to Bevy, or its response when it never got that far
+enum SubmittedRequest {
+    Pending {
+        id: Option<Value>,
+        method: String,
+        response_rx: tokio::sync::oneshot::Receiver<Value>,
+    },
+    Answered(Value),
+}
+
+/// Validate a JSON-RPC request and hand it to Bevy for processing
+async fn submit_json_rpc_request(
     request: serde_json::Value,
     request_sender: &async_channel::Sender<McpRequest>,
-) -> serde_json::Value {
+) -> SubmittedRequest {
     // Parse the JSON-RPC request
     let method = match request.get("method").and_then(|m| m.as_str()) {
         Some(m) => m,
         None => {
-            return json!({
+            return SubmittedRequest::Answered(json!({
                 "jsonrpc": "2.0",
                 "id": request.get("id"),
                 "error": {
                     "code": -32600, // Invalid Request
                     "message": "Missing method field"
                 }
-            });
+            }));
         }
     };
 
     let id = request.get("id").cloned();
     let params = request.get("params").cloned().unwrap_or(json!({}));
 
-    // Handle notifications (no response expected)
-    if id.is_none() {
-        debug!("Received notification: {}", method);
-        // For notifications, we don't send a response
-        return json!({});
-    }
-
     // Create a response channel for this request
     let (response_tx, response_rx) = tokio::sync::oneshot::channel();
 
@@ -263,16 +345,34 @@ async fn handle_json_rpc_request(
     // Send to Bevy for processing
     if let Err(e) = request_sender.send(mcp_request).await {
         error!("Failed to send MCP request to Bevy: {}", e);
-        return json!({
+        return SubmittedRequest::Answered(json!({
             "jsonrpc": "2.0",
             "id": id,
             "error": {
                 "code": -32603, // Internal error
                 "message": "Internal server error"
             }
-        });
+        }));
     }
 
+    SubmittedRequest::Pending {
+        id,
+        method: method.to_string(),
+        response_rx,
+    }
+}
+
+/// Wait for Bevy's result of a submitted request and build the JSON-RPC response
+async fn finish_json_rpc_request(submitted: SubmittedRequest) -> serde_json::Value {
+    let (id, method, response_rx) = match submitted {
+        SubmittedRequest::Pending {
+            id,
+            method,
+            response_rx,
+        } => (id, method, response_rx),
+        SubmittedRequest::Answered(response) => return response,
+    };
+
     // Wait for the response from Bevy with appropriate timeout based on method
     let timeout_duration = get_method_timeout(&method);
     let response_result = tokio::time::timeout(timeout_duration, response_rx).await;
@@ -472,7 +572,7 @@ fn handle_async_tool_call_request(
 
     // Generate a unique request ID for tracking
     let request_id = uuid::Uuid::new_v4().to_string();
-    info!(
+    debug!(
         "Handling MCP tool '{}' with request ID: {}",
         tool_name, request_id
     );
@@ -496,13 +596,16 @@ fn handle_async_tool_call_request(
 
     // Add to dedicated MCP execution queue
     pending_executions.mcp_commands.push(mcp_command);
-    info!(
+    debug!(
         "Queued MCP command '{}' for execution (queue size: {})",
         tool_name,
         pending_executions.mcp_commands.len()
     );
 }
 
+/// Most queued tool calls one frame applies
+const MAX_MCP_COMMANDS_PER_FRAME: usize = 512;
+
 /// Dedicated MCP command execution system with parameter bundling to restore full functionality
 /// This replaces the simplified version and supports all multiplayer commands
 fn execute_mcp_commands(
@@ -533,16 +636,19 @@ fn execute_mcp_commands(
         );
     }
 
-    // Take all queued MCP commands to avoid multiple mutable borrows
+    // Take the queued MCP commands to avoid multiple mutable borrows; pipelined clients
+    // can queue thousands, so a frame applies at most MAX_MCP_COMMANDS_PER_FRAME of them
+    // and leaves the rest for the next one
+    let queued = core_params.pending_executions.mcp_commands.len();
     let mcp_commands: Vec<_> = core_params
         .pending_executions
         .mcp_commands
-        .drain(..)
+        .drain(..queued.min(MAX_MCP_COMMANDS_PER_FRAME))
         .collect();
 
-    // Process all queued MCP commands
+    // Process the batch of queued MCP commands
     for mcp_command in mcp_commands {
-        info!(
+        debug!(
             "Executing MCP command: {} (ID: {})",
             mcp_command.tool_name, mcp_command.request_id
         );
@@ -626,73 +732,6 @@ fn execute_mcp_commands(
     }
 }
 
-/// System to synchronize visual block entities with VoxelWorld data
-/// This ensures blocks added via MCP get visual representation
-fn sync_block_visuals(
-    voxel_world: Res<VoxelWorld>,
-    existing_blocks_query: Query<&crate::environment::VoxelBlock>,
-    mut commands: Commands,
-    mut meshes: ResMut<Assets<Mesh>>,
-    mut materials: ResMut<Assets<StandardMaterial>>,
-    asset_server: Res<AssetServer>,
-) {
-    // Only run this sync when voxel world changes to avoid performance issues
-    if !voxel_world.is_changed() {
-        return;
-    }
-
-    // Get all existing visual block positions
-    let existing_positions: std::collections::HashSet<bevy::math::IVec3> = existing_blocks_query
-        .iter()
-        .map(|block| block.position)
-        .collect();
-
-    // Create visual entities for blocks that don't have them
-    let mut created_visuals = 0;
-    for (pos, block_type) in voxel_world.blocks.iter() {
-        if !existing_positions.contains(pos) {
-            // Create visual entity for this block
-            let cube_mesh = meshes.add(bevy::math::primitives::Cuboid::new(
-                crate::environment::CUBE_SIZE,
-                crate::environment::CUBE_SIZE,
-                crate::environment::CUBE_SIZE,
-            ));
-
-            let texture_path = match block_type {
-                crate::environment::BlockType::Grass => "textures/grass.webp",
-                crate::environment::BlockType::Dirt => "textures/dirt.webp",
-                crate::environment::BlockType::Stone => "textures/stone.webp",
-                crate::environment::BlockType::QuartzBlock => "textures/quartz_block.webp",
-                crate::environment::BlockType::GlassPane => "textures/glass_pane.webp",
-                crate::environment::BlockType::CyanTerracotta => "textures/cyan_terracotta.webp",
-                crate::environment::BlockType::Water => "textures/water.webp",
-            };
-
-            let texture: Handle<Image> = asset_server.load(texture_path);
-            let material = materials.add(StandardMaterial {
-                base_color_texture: Some(texture),
-                ..Default::default()
-            });
-
-            commands.spawn((
-                Mesh3d(cube_mesh),
-                MeshMaterial3d(material),
-                Transform::from_translation(pos.as_vec3()),
-                crate::environment::VoxelBlock { position: *pos },
-            ));
-
-            created_visuals += 1;
-        }
-    }
-
-    if created_visuals > 0 {
-        info!(
-            "Synced {} visual entities for VoxelWorld blocks",
-            created_visuals
-        );
-    }
-}
-
 /// Gets the worlds directory path
 #[cfg(not(target_arch = "wasm32"))]
 fn get_worlds_directory() -> std::path::PathBuf {
@@ -797,7 +836,7 @@ fn execute_mcp_command_directly(
         })
         .to_string(),
         "get_world_status" => {
-            let block_count = voxel_world.blocks.len();
+            let block_count = voxel_world.blocks().len();
             let device_count = device_query.iter().count();
             let world_name = current_world
                 .map(|cw| cw.name.as_str())
@@ -957,7 +996,7 @@ fn execute_mcp_command_directly(
                 );
 
                 // Clear voxel world blocks
-                voxel_world.blocks.clear();
+                voxel_world.clear();
                 info!("MCP: Cleared voxel world blocks");
 
                 // Set current world resource
@@ -1008,7 +1047,7 @@ fn execute_mcp_command_directly(
                                     ) {
                                         if let Some(block_type) = parse_block_type(parts[1]) {
                                             let pos = bevy::math::IVec3::new(x, y, z);
-                                            voxel_world.blocks.insert(pos, block_type);
+                                            voxel_world.set_block(pos, block_type);
                                             blocks_created += 1;
                                             info!(
                                                 "MCP: Placed {} block at ({}, {}, {}) - visual will be created by sync system",
@@ -1041,7 +1080,7 @@ fn execute_mcp_command_directly(
                                                 for y in min_y..=max_y {
                                                     for z in min_z..=max_z {
                                                         let pos = bevy::math::IVec3::new(x, y, z);
-                                                        voxel_world.blocks.insert(pos, block_type);
+                                                        voxel_world.set_block(pos, block_type);
                                                         blocks_created += 1;
                                                     }
                                                 }
@@ -1707,7 +1746,7 @@ fn handle_command_results(
 ) {
     for event in command_executed_events.read() {
         if let Some(execution) = pending_executions.executions.remove(&event.request_id) {
-            info!(
+            debug!(
                 "Sending MCP response for request {}: {}",
                 event.request_id, event.result
             );
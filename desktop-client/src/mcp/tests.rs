@@ -468,4 +468,75 @@ mod mcp_tests {
             assert!(text.contains("devices_online"));
         }
     }
+
+    #[tokio::test]
+    async fn test_connection_pipelines_requests() {
+        use super::super::mcp_server::handle_mcp_connection;
+        use tokio::io::{AsyncBufReadExt, AsyncWriteExt, BufReader};
+
+        let listener = tokio::net::TcpListener::bind("127.0.0.1:0").await.unwrap();
+        let addr = listener.local_addr().unwrap();
+        let (request_tx, request_rx) = async_channel::unbounded();
+        tokio::spawn(async move {
+            let (stream, _) = listener.accept().await.unwrap();
+            let _ = handle_mcp_connection(stream, request_tx).await;
+        });
+        let stream = tokio::net::TcpStream::connect(addr).await.unwrap();
+        let (reader, mut writer) = stream.into_split();
+        let mut reader = BufReader::new(reader);
+        let mut read_response = async || {
+            let mut line = String::new();
+            reader.read_line(&mut line).await.unwrap();
+            serde_json::from_str::<serde_json::Value>(&line).unwrap()
+        };
+
+        // Three calls written back to back, without waiting for responses
+        let mut lines = String::new();
+        for id in 1..=3 {
+            let request = json!({
+                "jsonrpc": "2.0",
+                "id": id,
+                "method": "tools/call",
+                "params": {"name": "place_block", "arguments": {"x": id}}
+            });
+            lines.push_str(&format!("{}\n", request));
+        }
+        writer.write_all(lines.as_bytes()).await.unwrap();
+
+        // They reach Bevy in the order they were sent, before any is answered
+        let mut requests = Vec::new();
+        for _ in 0..3 {
+            requests.push(request_rx.recv().await.unwrap());
+        }
+        let order: Vec<_> = requests
+            .iter()
+            .map(|request| request.params["arguments"]["x"].as_i64().unwrap())
+            .collect();
+        assert_eq!(order, vec![1, 2, 3]);
+
+        // Answered last first, the responses come back in that order, matched by id
+        for request in requests.into_iter().rev() {
+            let x = request.params["arguments"]["x"].clone();
+            request.response_sender.send(json!({"x": x})).unwrap();
+            let response = read_response().await;
+            assert_eq!(response["id"], x);
+            assert_eq!(response["result"]["x"], x);
+        }
+
+        // A batch gets one array response, without entries for its notifications
+        let batch = json!([
+            {"jsonrpc": "2.0", "id": 4, "method": "ping"},
+            {"jsonrpc": "2.0", "method": "notifications/initialized"}
+        ]);
+        writer
+            .write_all(format!("{}\n", batch).as_bytes())
+            .await
+            .unwrap();
+        let request = request_rx.recv().await.unwrap();
+        assert_eq!(request.method, "ping");
+        request.response_sender.send(json!({})).unwrap();
+        let response = read_response().await;
+        assert_eq!(response.as_array().map(Vec::len), Some(1));
+        assert_eq!(response[0]["id"], 4);
+    }
 }
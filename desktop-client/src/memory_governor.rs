@@ -0,0 +1,491 @@
+//! Memory governor
+//!
+//! A wasm page's linear memory never shrinks, and mobile browsers kill tabs long
+//! before the 2GB wasm limit, so the web client has to stay inside a budget rather
+//! than just free things eventually. The governor enforces the limits from
+//! [`crate::wasm_limits`]:
+//!
+//! - transient message buffers come from a bounded [`BufferPool`] instead of a fresh
+//!   allocation per message
+//! - at most [`get_max_resident_chunk_meshes`] chunk meshes stay resident; chunks out
+//!   of render distance are evicted least-recently-seen first and remeshed on return
+//! - under memory pressure the chunk cap is halved; pressure is judged on live
+//!   allocations (which shrink again) with hysteresis, not on the linear memory size
+//! - [`MemoryStats`] collects the numbers shown by the `memory` console command
+
+use bevy::ecs::entity::Entities;
+use bevy::prelude::*;
+use std::cell::RefCell;
+use std::collections::{HashMap, HashSet};
+use std::sync::atomic::{AtomicUsize, Ordering};
+
+use crate::environment::{VoxelBlock, VoxelWorld};
+use crate::shared_materials::SharedBlockMaterials;
+use crate::wasm_limits::{
+    MEMORY_PRESSURE_RELEASE_BYTES, MEMORY_WARNING_THRESHOLD_BYTES, MESSAGE_POOL_MAX_BUFFER_BYTES,
+    get_max_resident_chunk_meshes, get_message_pool_buffers, get_render_distance, live_heap_bytes,
+    log_performance_warning, wasm_heap_bytes,
+};
+use crate::world::chunk_mesh::{
+    MESH_CHUNK_SIZE, MeshedChunk, MeshedChunks, chunk_origin, remesh_chunks,
+};
+
+/// How often residency is re-evaluated
+const GOVERNOR_INTERVAL_SECS: f32 = 0.25;
+
+/// Chunks remeshed per governor tick when the player returns to an evicted area
+const RESTORES_PER_TICK: usize = 8;
+
+/// Usage counters of a [`BufferPool`]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct PoolStats {
+    pub acquired: u64,
+    pub reused: u64,
+    pub dropped: u64,
+    pub pooled_buffers: usize,
+    pub pooled_bytes: usize,
+}
+
+/// Bounded free list of byte buffers for short-lived decode scratch space
+#[derive(Debug)]
+pub struct BufferPool {
+    free: Vec<Vec<u8>>,
+    max_buffers: usize,
+    max_buffer_bytes: usize,
+    stats: PoolStats,
+}
+
+impl BufferPool {
+    pub fn new(max_buffers: usize, max_buffer_bytes: usize) -> Self {
+        Self {
+            free: Vec::with_capacity(max_buffers),
+            max_buffers,
+            max_buffer_bytes,
+            stats: PoolStats::default(),
+        }
+    }
+
+    /// Take an empty buffer with at least `min_capacity` bytes of capacity.
+    /// The smallest pooled buffer that fits is preferred.
+    pub fn acquire(&mut self, min_capacity: usize) -> Vec<u8> {
+        self.stats.acquired += 1;
+        let fitting = self
+            .free
+            .iter()
+            .enumerate()
+            .filter(|(_, buffer)| buffer.capacity() >= min_capacity)
+            .min_by_key(|(_, buffer)| buffer.capacity())
+            .map(|(index, _)| index);
+        let index = fitting
+            .or_else(|| (0..self.free.len()).max_by_key(|&index| self.free[index].capacity()));
+
+        match index {
+            Some(index) => {
+                self.stats.reused += 1;
+                let mut buffer = self.free.swap_remove(index);
+                buffer.clear();
+                buffer.reserve(min_capacity);
+                buffer
+            }
+            None => Vec::with_capacity(min_capacity),
+        }
+    }
+
+    /// Return a buffer; it is freed instead if the pool is full or it is oversized
+    pub fn release(&mut self, mut buffer: Vec<u8>) {
+        if self.free.len() >= self.max_buffers || buffer.capacity() > self.max_buffer_bytes {
+            self.stats.dropped += 1;
+            return;
+        }
+        buffer.clear();
+        self.free.push(buffer);
+    }
+
+    /// Free every pooled buffer
+    pub fn trim(&mut self) {
+        self.free.clear();
+        self.free.shrink_to_fit();
+    }
+
+    pub fn stats(&self) -> PoolStats {
+        PoolStats {
+            pooled_buffers: self.free.len(),
+            pooled_bytes: self.free.iter().map(Vec::capacity).sum(),
+            ..self.stats
+        }
+    }
+}
+
+thread_local! {
+    // Message callbacks run outside the ECS (WebSocket and worker handlers), so the
+    // pool is thread-local rather than a resource
+    static MESSAGE_BUFFERS: RefCell<BufferPool> = RefCell::new(BufferPool::new(
+        get_message_pool_buffers(),
+        MESSAGE_POOL_MAX_BUFFER_BYTES,
+    ));
+}
+
+/// Capacity of the MQTT read buffer, reported by the web MQTT client
+static MQTT_READ_BUFFER_BYTES: AtomicUsize = AtomicUsize::new(0);
+
+/// Run `f` on a pooled scratch buffer of `len` zeroed bytes
+pub fn with_message_buffer<R>(len: usize, f: impl FnOnce(&mut [u8]) -> R) -> R {
+    let mut buffer = MESSAGE_BUFFERS.with_borrow_mut(|pool| pool.acquire(len));
+    buffer.resize(len, 0);
+    let result = f(&mut buffer);
+    MESSAGE_BUFFERS.with_borrow_mut(|pool| pool.release(buffer));
+    result
+}
+
+pub fn message_pool_stats() -> PoolStats {
+    MESSAGE_BUFFERS.with_borrow(BufferPool::stats)
+}
+
+pub fn trim_message_pool() {
+    MESSAGE_BUFFERS.with_borrow_mut(BufferPool::trim);
+}
+
+pub fn record_mqtt_read_buffer(capacity: usize) {
+    MQTT_READ_BUFFER_BYTES.store(capacity, Ordering::Relaxed);
+}
+
+/// Memory telemetry, refreshed by the governor and shown by the `memory` command
+#[derive(Resource, Debug, Clone, Default)]
+pub struct MemoryStats {
+    /// Size of the wasm linear memory (None on desktop)
+    pub heap_bytes: Option<usize>,
+    /// Bytes currently allocated on the wasm heap (None on desktop)
+    pub live_bytes: Option<usize>,
+    pub under_pressure: bool,
+    pub entity_count: usize,
+    pub block_entities: usize,
+    pub resident_chunks: usize,
+    pub evicted_chunks: usize,
+    pub max_resident_chunks: usize,
+    pub chunk_mesh_bytes: usize,
+    pub evictions: u64,
+    pub restores: u64,
+    pub message_pool: PoolStats,
+    pub mqtt_read_buffer_bytes: usize,
+}
+
+fn megabytes(bytes: usize) -> f64 {
+    bytes as f64 / (1024.0 * 1024.0)
+}
+
+impl MemoryStats {
+    /// Human-readable summary for the console
+    pub fn report(&self) -> String {
+        let heap = match (self.live_bytes, self.heap_bytes) {
+            (Some(live), Some(linear)) => format!(
+                "{:.1} MB live, {:.1} MB linear memory (pressure at {:.0} MB){}",
+                megabytes(live),
+                megabytes(linear),
+                MEMORY_WARNING_THRESHOLD_BYTES / (1024.0 * 1024.0),
+                if self.under_pressure {
+                    " - under pressure"
+                } else {
+                    ""
+                }
+            ),
+            _ => "n/a (native build)".to_string(),
+        };
+        let pool = &self.message_pool;
+        [
+            "Memory usage:".to_string(),
+            format!("  wasm heap: {}", heap),
+            format!(
+                "  entities: {} ({} block entities)",
+                self.entity_count, self.block_entities
+            ),
+            format!(
+                "  chunk meshes: {}/{} resident, {} evicted, {:.1} MB",
+                self.resident_chunks,
+                self.max_resident_chunks,
+                self.evicted_chunks,
+                megabytes(self.chunk_mesh_bytes)
+            ),
+            format!(
+                "  chunk evictions: {}, restores: {}",
+                self.evictions, self.restores
+            ),
+            format!(
+                "  message pool: {} buffers ({:.1} MB), {}/{} reused, {} dropped",
+                pool.pooled_buffers,
+                megabytes(pool.pooled_bytes),
+                pool.reused,
+                pool.acquired,
+                pool.dropped
+            ),
+            format!(
+                "  mqtt read buffer: {:.1} MB",
+                megabytes(self.mqtt_read_buffer_bytes)
+            ),
+        ]
+        .join("\n")
+    }
+}
+
+/// Governor state and tunables
+#[derive(Resource, Debug)]
+pub struct MemoryGovernor {
+    pub max_resident_chunks: usize,
+    pub restores_per_tick: usize,
+    pub under_pressure: bool,
+    tick: u64,
+    timer: Timer,
+}
+
+impl Default for MemoryGovernor {
+    fn default() -> Self {
+        Self {
+            max_resident_chunks: get_max_resident_chunk_meshes(),
+            restores_per_tick: RESTORES_PER_TICK,
+            under_pressure: false,
+            tick: 0,
+            timer: Timer::from_seconds(GOVERNOR_INTERVAL_SECS, TimerMode::Repeating),
+        }
+    }
+}
+
+/// Whether the heap is under pressure given `live_bytes` of live allocations.
+/// Pressure starts at the warning threshold and only lifts once usage is back below
+/// [`MEMORY_PRESSURE_RELEASE_BYTES`], so the chunk cap does not flap around one value.
+pub fn memory_pressure(was_under_pressure: bool, live_bytes: Option<usize>) -> bool {
+    let Some(live) = live_bytes.map(|bytes| bytes as f64) else {
+        return false;
+    };
+    if was_under_pressure {
+        live >= MEMORY_PRESSURE_RELEASE_BYTES
+    } else {
+        live >= MEMORY_WARNING_THRESHOLD_BYTES
+    }
+}
+
+/// Chunks to evict and to restore on one governor tick
+#[derive(Debug, Default, PartialEq)]
+pub struct ResidencyPlan {
+    pub evict: Vec<IVec3>,
+    pub restore: Vec<IVec3>,
+}
+
+fn chunk_center(chunk: IVec3) -> Vec3 {
+    chunk_origin(chunk) + Vec3::splat((MESH_CHUNK_SIZE - 1) as f32 / 2.0)
+}
+
+/// Mark chunks within `render_distance` of `camera` as used at `tick`, then pick the
+/// evicted ones to bring back (nearest first) and the least recently used resident
+/// ones to drop so that at most `max_resident` stay resident.
+pub fn plan_residency(
+    chunks: &mut HashMap<IVec3, MeshedChunk>,
+    camera: Vec3,
+    render_distance: f32,
+    max_resident: usize,
+    max_restore: usize,
+    tick: u64,
+) -> ResidencyPlan {
+    let mut restore = Vec::new();
+    let mut resident = Vec::new();
+    for (chunk, meshed) in chunks.iter_mut() {
+        let distance = chunk_center(*chunk).distance(camera);
+        if distance <= render_distance {
+            meshed.last_used = tick;
+            if meshed.evicted {
+                restore.push((distance, *chunk));
+            }
+        }
+        if !meshed.evicted {
+            resident.push((meshed.last_used, distance, *chunk));
+        }
+    }
+
+    restore.sort_by(|a, b| a.0.total_cmp(&b.0));
+    restore.truncate(max_restore);
+
+    // Oldest first, farthest first among equally old; chunks seen this tick are only
+    // candidates if the cap is smaller than what is in view
+    resident.sort_by(|a, b| a.0.cmp(&b.0).then(b.1.total_cmp(&a.1)));
+    let over = (resident.len() + restore.len()).saturating_sub(max_resident);
+    let evict: Vec<IVec3> = resident
+        .iter()
+        .filter(|(last_used, _, _)| *last_used < tick)
+        .take(over)
+        .map(|(_, _, chunk)| *chunk)
+        .collect();
+
+    // Do not restore what there is no room for
+    restore.truncate(restore.len() - (over - evict.len()).min(restore.len()));
+
+    ResidencyPlan {
+        evict,
+        restore: restore.into_iter().map(|(_, chunk)| chunk).collect(),
+    }
+}
+
+/// Plugin that keeps chunk meshes and pooled buffers within the platform budget
+pub struct MemoryGovernorPlugin;
+
+impl Plugin for MemoryGovernorPlugin {
+    fn build(&self, app: &mut App) {
+        app.init_resource::<MemoryGovernor>()
+            .init_resource::<MemoryStats>()
+            .add_systems(Update, govern_memory);
+    }
+}
+
+fn govern_memory(
+    time: Res<Time>,
+    mut governor: ResMut<MemoryGovernor>,
+    mut stats: ResMut<MemoryStats>,
+    mut meshed_chunks: ResMut<MeshedChunks>,
+    voxel_world: Res<VoxelWorld>,
+    shared_materials: Option<Res<SharedBlockMaterials>>,
+    camera_query: Query<&GlobalTransform, With<Camera3d>>,
+    block_entities: Query<(), With<VoxelBlock>>,
+    entities: &Entities,
+    mut commands: Commands,
+    mut meshes: ResMut<Assets<Mesh>>,
+) {
+    if !governor.timer.tick(time.delta()).just_finished() {
+        return;
+    }
+    governor.tick += 1;
+    let tick = governor.tick;
+
+    let heap_bytes = wasm_heap_bytes();
+    let live_bytes = live_heap_bytes();
+    let under_pressure = memory_pressure(governor.under_pressure, live_bytes);
+    if under_pressure && !governor.under_pressure {
+        log_performance_warning(&format!(
+            "live wasm heap reached {:.0} MB, halving resident chunk meshes",
+            megabytes(live_bytes.unwrap_or_default())
+        ));
+        trim_message_pool();
+    } else if !under_pressure && governor.under_pressure {
+        log_performance_warning(&format!(
+            "live wasm heap back to {:.0} MB, restoring the resident chunk mesh cap",
+            megabytes(live_bytes.unwrap_or_default())
+        ));
+    }
+    governor.under_pressure = under_pressure;
+    let max_resident = if under_pressure {
+        governor.max_resident_chunks / 2
+    } else {
+        governor.max_resident_chunks
+    };
+
+    if let (Ok(camera), Some(materials)) = (camera_query.single(), shared_materials.as_deref()) {
+        if !meshed_chunks.chunks.is_empty() {
+            let plan = plan_residency(
+                &mut meshed_chunks.chunks,
+                camera.translation(),
+                get_render_distance(),
+                max_resident,
+                governor.restores_per_tick,
+                tick,
+            );
+            for chunk in &plan.evict {
+                meshed_chunks.evict(&mut commands, *chunk);
+            }
+            if !plan.restore.is_empty() {
+                let restore: HashSet<IVec3> = plan.restore.iter().copied().collect();
+                remesh_chunks(
+                    &mut commands,
+                    &mut meshes,
+                    materials,
+                    &mut meshed_chunks,
+                    voxel_world.blocks(),
+                    &restore,
+                );
+                for chunk in &restore {
+                    if let Some(meshed) = meshed_chunks.chunks.get_mut(chunk) {
+                        meshed.last_used = tick;
+                    }
+                }
+            }
+            stats.evictions += plan.evict.len() as u64;
+            stats.restores += plan.restore.len() as u64;
+        }
+    }
+
+    let evicted_chunks = meshed_chunks.chunks.values().filter(|m| m.evicted).count();
+    stats.heap_bytes = heap_bytes;
+    stats.live_bytes = live_bytes;
+    stats.under_pressure = under_pressure;
+    stats.entity_count = entities.len() as usize;
+    stats.block_entities = block_entities.iter().count();
+    stats.resident_chunks = meshed_chunks.chunks.len() - evicted_chunks;
+    stats.evicted_chunks = evicted_chunks;
+    stats.max_resident_chunks = max_resident;
+    stats.chunk_mesh_bytes = meshed_chunks.chunks.values().map(|m| m.mesh_bytes).sum();
+    stats.message_pool = message_pool_stats();
+    stats.mqtt_read_buffer_bytes = MQTT_READ_BUFFER_BYTES.load(Ordering::Relaxed);
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_buffer_pool_reuses_and_bounds_buffers() {
+        let mut pool = BufferPool::new(2, 1024);
+        let a = pool.acquire(100);
+        let b = pool.acquire(500);
+        let c = pool.acquire(4096);
+        pool.release(a);
+        pool.release(b);
+        pool.release(c); // pool full and oversized
+        assert_eq!(pool.stats().pooled_buffers, 2);
+        assert_eq!(pool.stats().dropped, 1);
+
+        // Best fit: the 500-byte buffer serves a 200-byte request
+        let d = pool.acquire(200);
+        assert!(d.capacity() >= 500 && d.capacity() < 1024);
+        assert_eq!(pool.stats().reused, 1);
+        assert_eq!(pool.stats().acquired, 4);
+
+        pool.trim();
+        assert_eq!(pool.stats().pooled_bytes, 0);
+    }
+
+    #[test]
+    fn test_memory_pressure_has_hysteresis() {
+        let warning = MEMORY_WARNING_THRESHOLD_BYTES as usize;
+        let release = MEMORY_PRESSURE_RELEASE_BYTES as usize;
+        assert!(!memory_pressure(false, None));
+        assert!(!memory_pressure(false, Some(warning - 1)));
+        assert!(memory_pressure(false, Some(warning)));
+        // Freed memory between the two thresholds keeps the pressure on
+        assert!(memory_pressure(true, Some(release + 1)));
+        assert!(!memory_pressure(true, Some(release - 1)));
+    }
+
+    #[test]
+    fn test_plan_residency_evicts_least_recently_used_far_chunks() {
+        let mut chunks: HashMap<IVec3, MeshedChunk> = HashMap::new();
+        for x in 0..4 {
+            chunks.insert(
+                IVec3::new(x * 10, 0, 0),
+                MeshedChunk {
+                    last_used: x as u64,
+                    ..default()
+                },
+            );
+        }
+        // Only the chunk at the origin is in view; cap of two resident chunks
+        let plan = plan_residency(&mut chunks, Vec3::ZERO, 32.0, 2, 8, 10);
+        assert_eq!(plan.evict, vec![IVec3::new(10, 0, 0), IVec3::new(20, 0, 0)]);
+        assert!(plan.restore.is_empty());
+        assert_eq!(chunks[&IVec3::ZERO].last_used, 10);
+
+        for chunk in &plan.evict {
+            chunks.get_mut(chunk).unwrap().evicted = true;
+        }
+        // Walking to the evicted chunk at x = 10 brings it back and drops the least
+        // recently seen resident chunk
+        let camera = chunk_center(IVec3::new(10, 0, 0));
+        let plan = plan_residency(&mut chunks, camera, 20.0, 2, 8, 11);
+        assert_eq!(plan.restore, vec![IVec3::new(10, 0, 0)]);
+        assert_eq!(plan.evict, vec![IVec3::new(30, 0, 0)]);
+    }
+}
@@ -1,6 +1,8 @@
 #[cfg(not(target_arch = "wasm32"))]
+use crate::devices::DeviceIndex;
+#[cfg(not(target_arch = "wasm32"))]
 use crate::devices::device_types::{DeviceEntity, DeviceType};
-use crate::environment::{BlockType, VoxelWorld};
+use crate::environment::{BlockType, VoxelSet, VoxelWorld, WorldChanges};
 #[cfg(not(target_arch = "wasm32"))]
 use crate::interaction::interaction_types::LampState;
 use crate::ui::GameState;
@@ -23,6 +25,7 @@ impl Plugin for MinimapPlugin {
                 finish_minimap_texture_generation,
                 update_minimap_visibility,
             )
+                .in_set(VoxelSet::Read)
                 .run_if(in_state(GameState::InGame)),
         )
         .add_systems(OnEnter(GameState::InGame), setup_minimap)
@@ -69,6 +72,8 @@ pub struct MinimapTexture {
     pub last_update: f64,
     pub update_interval: f64,
     pub last_player_pos: Vec3, // Track player position to throttle updates
+    /// `VoxelWorld` generation the texture was drawn from
+    pub world_generation: u64,
 }
 
 /// Component to track async minimap generation tasks
@@ -123,7 +128,7 @@ fn get_block_color(block_type: BlockType, height: i32) -> [u8; 4] {
 }
 
 /// Generate a 2D minimap texture from the voxel world (now async-compatible)
-fn generate_minimap_texture_sync(
+pub fn generate_minimap_texture_sync(
     blocks: HashMap<IVec3, BlockType>, // Pass owned data for async
     devices: Vec<MinimapDevice>,       // Device data for rendering
     player_pos: Vec3,
@@ -370,6 +375,7 @@ fn setup_minimap(mut commands: Commands, mut images: ResMut<Assets<Image>>) {
                         0.8
                     }, // Faster updates for WASM testing
                     last_player_pos: Vec3::ZERO,
+                    world_generation: 0,
                 },
             ));
 
@@ -446,16 +452,30 @@ fn extract_yaw_from_transform(transform: &Transform) -> f32 {
     yaw
 }
 
+/// Whether blocks within `radius` columns of `center` changed since `generation`; a
+/// journal too short to tell counts as changed
+fn world_changed_near(
+    voxel_world: &VoxelWorld,
+    generation: u64,
+    center: IVec3,
+    radius: i32,
+) -> bool {
+    match voxel_world.changes_since(generation) {
+        WorldChanges::Edits(mut edits) => edits.any(|edit| {
+            (edit.position.x - center.x).abs() <= radius
+                && (edit.position.z - center.z).abs() <= radius
+        }),
+        WorldChanges::Resync => true,
+    }
+}
+
 /// System to start async minimap texture generation
 fn start_minimap_texture_generation(
     mut commands: Commands,
     mut minimap_textures: Query<(Entity, &mut MinimapTexture), Without<MinimapGenerationTask>>,
     player_camera_query: Query<&Transform, With<Camera>>,
-    #[cfg(not(target_arch = "wasm32"))] device_query: Query<(
-        &Transform,
-        &DeviceEntity,
-        Option<&LampState>,
-    )>,
+    #[cfg(not(target_arch = "wasm32"))] device_query: Query<(&DeviceEntity, Option<&LampState>)>,
+    #[cfg(not(target_arch = "wasm32"))] device_index: Option<Res<DeviceIndex>>,
     minimap_state: Res<MinimapState>,
     voxel_world: Res<VoxelWorld>,
     time: Res<Time>,
@@ -496,7 +516,7 @@ fn start_minimap_texture_generation(
                     &format!(
                         "🗺️ Minimap: Player position detected at {:?}, world has {} blocks",
                         pos,
-                        voxel_world.blocks.len()
+                        voxel_world.blocks().len()
                     )
                     .into(),
                 );
@@ -520,20 +540,30 @@ fn start_minimap_texture_generation(
         } else {
             3.0
         };
-        if minimap_texture.last_player_pos.distance(player_pos) < movement_threshold {
+        // Redraw when the player moved or blocks around them were edited
+        let player_x = player_pos.x as i32;
+        let player_z = player_pos.z as i32;
+        let world_radius = 25i32;
+        let moved = minimap_texture.last_player_pos.distance(player_pos) >= movement_threshold;
+        if !moved
+            && !world_changed_near(
+                &voxel_world,
+                minimap_texture.world_generation,
+                IVec3::new(player_x, 0, player_z),
+                world_radius,
+            )
+        {
             continue;
         }
 
         minimap_texture.last_update = current_time;
         minimap_texture.last_player_pos = player_pos;
+        minimap_texture.world_generation = voxel_world.generation();
 
         // Clone the blocks data for the async task (only relevant blocks for performance)
-        let player_x = player_pos.x as i32;
-        let player_z = player_pos.z as i32;
-        let world_radius = 25i32;
 
         let relevant_blocks: HashMap<IVec3, BlockType> = voxel_world
-            .blocks
+            .blocks()
             .iter()
             .filter(|(pos, _)| {
                 let dx = (pos.x - player_x).abs();
@@ -547,37 +577,29 @@ fn start_minimap_texture_generation(
         let devices: Vec<MinimapDevice> = {
             #[cfg(not(target_arch = "wasm32"))]
             {
-                device_query
-                    .iter()
-                    .filter_map(|(transform, device_entity, lamp_state)| {
-                        // Only include devices within minimap radius
-                        let device_pos = transform.translation;
-                        let dx = (device_pos.x - player_pos.x).abs();
-                        let dz = (device_pos.z - player_pos.z).abs();
-
-                        if dx <= world_radius as f32 && dz <= world_radius as f32 {
-                            // Parse device type from string
-                            if let Some(device_type) =
-                                DeviceType::from_str(&device_entity.device_type)
-                            {
-                                let is_on = match device_type {
-                                    DeviceType::Lamp => {
-                                        lamp_state.map(|state| state.is_on).unwrap_or(false)
-                                    }
-                                    _ => false, // For non-lamp devices, this field is not relevant
-                                };
-
-                                Some(MinimapDevice {
-                                    position: device_pos,
-                                    device_type,
-                                    is_on,
-                                })
-                            } else {
-                                None
+                // Only include devices within minimap radius
+                let nearby = device_index
+                    .as_ref()
+                    .map(|index| index.within_square(player_pos, world_radius as f32))
+                    .unwrap_or_default();
+                nearby
+                    .into_iter()
+                    .filter_map(|(entity, device_pos)| {
+                        let (device_entity, lamp_state) = device_query.get(entity).ok()?;
+                        // Parse device type from string
+                        let device_type = DeviceType::from_str(&device_entity.device_type)?;
+                        let is_on = match device_type {
+                            DeviceType::Lamp => {
+                                lamp_state.map(|state| state.is_on).unwrap_or(false)
                             }
-                        } else {
-                            None
-                        }
+                            _ => false, // For non-lamp devices, this field is not relevant
+                        };
+
+                        Some(MinimapDevice {
+                            position: device_pos,
+                            device_type,
+                            is_on,
+                        })
                     })
                     .collect()
             }
@@ -603,7 +625,7 @@ fn start_minimap_texture_generation(
                 relevant_blocks.len(),
                 devices.len(),
                 player_pos,
-                voxel_world.blocks.len()
+                voxel_world.blocks().len()
             )
             .into(),
         );
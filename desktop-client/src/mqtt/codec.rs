@@ -0,0 +1,716 @@
+//! Allocation-light MQTT 3.1.1 / 5 packet codec
+//!
+//! Used by the WASM client, which speaks MQTT directly over a WebSocket. Incoming
+//! WebSocket frames are appended to one reusable read buffer, so packets split
+//! across frames (or several packets in one frame) are handled transparently.
+//! Decoded packets are borrowed views into that buffer: a PUBLISH costs no topic
+//! or payload allocation. Outgoing packets are written in place into any `BufMut`.
+//!
+//! The codec is platform independent so it can be unit tested on desktop.
+
+use bytes::{Buf, BufMut, BytesMut};
+use std::fmt;
+
+/// Largest value representable by the MQTT variable byte integer
+pub const MAX_REMAINING_LENGTH: usize = 268_435_455;
+
+/// Default upper bound for a single packet (world snapshots can be several MB)
+pub const DEFAULT_MAX_PACKET_SIZE: usize = 64 * 1024 * 1024;
+
+/// Initial read buffer capacity
+const DEFAULT_READ_CAPACITY: usize = 16 * 1024;
+
+const CONNECT: u8 = 1;
+const CONNACK: u8 = 2;
+const PUBLISH: u8 = 3;
+const PUBACK: u8 = 4;
+const SUBSCRIBE: u8 = 8;
+const SUBACK: u8 = 9;
+const UNSUBACK: u8 = 11;
+const PINGREQ: u8 = 12;
+const PINGRESP: u8 = 13;
+
+/// MQTT protocol revision negotiated in CONNECT
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum ProtocolVersion {
+    #[default]
+    V311,
+    V5,
+}
+
+impl ProtocolVersion {
+    /// Protocol level byte sent in CONNECT
+    pub fn level(self) -> u8 {
+        match self {
+            ProtocolVersion::V311 => 4,
+            ProtocolVersion::V5 => 5,
+        }
+    }
+
+    /// MQTT 5 adds a (here always empty) property block to most packets
+    fn properties_len(self) -> usize {
+        match self {
+            ProtocolVersion::V311 => 0,
+            ProtocolVersion::V5 => 1,
+        }
+    }
+}
+
+/// Quality of service level
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum QoS {
+    AtMostOnce = 0,
+    AtLeastOnce = 1,
+    ExactlyOnce = 2,
+}
+
+impl QoS {
+    fn from_bits(bits: u8) -> Result<Self, CodecError> {
+        match bits {
+            0 => Ok(QoS::AtMostOnce),
+            1 => Ok(QoS::AtLeastOnce),
+            2 => Ok(QoS::ExactlyOnce),
+            _ => Err(CodecError::InvalidQoS(bits)),
+        }
+    }
+}
+
+/// Errors produced while decoding or encoding packets
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub enum CodecError {
+    /// Remaining length used more than four bytes
+    MalformedRemainingLength,
+    /// Packet exceeds the configured maximum size
+    PacketTooLarge(usize),
+    /// Packet body ended before a required field
+    Truncated(&'static str),
+    /// Topic name was not valid UTF-8
+    InvalidTopic,
+    /// QoS bits were set to the reserved value 3
+    InvalidQoS(u8),
+    /// A string field was longer than 65535 bytes
+    StringTooLong(usize),
+}
+
+impl fmt::Display for CodecError {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        match self {
+            CodecError::MalformedRemainingLength => write!(f, "malformed remaining length"),
+            CodecError::PacketTooLarge(size) => write!(f, "packet too large: {} bytes", size),
+            CodecError::Truncated(field) => write!(f, "packet truncated while reading {}", field),
+            CodecError::InvalidTopic => write!(f, "topic is not valid UTF-8"),
+            CodecError::InvalidQoS(bits) => write!(f, "invalid QoS bits: {}", bits),
+            CodecError::StringTooLong(len) => write!(f, "string too long: {} bytes", len),
+        }
+    }
+}
+
+impl std::error::Error for CodecError {}
+
+/// Borrowed view of a PUBLISH packet
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct PublishView<'a> {
+    pub topic: &'a str,
+    pub payload: &'a [u8],
+    pub qos: QoS,
+    pub retain: bool,
+    pub dup: bool,
+    pub packet_id: Option<u16>,
+}
+
+impl PublishView<'_> {
+    /// Packet id that must be acknowledged with PUBACK (QoS 1 only)
+    pub fn puback_id(&self) -> Option<u16> {
+        match self.qos {
+            QoS::AtLeastOnce => self.packet_id,
+            _ => None,
+        }
+    }
+}
+
+/// Decoded packet borrowing from the codec read buffer
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Packet<'a> {
+    ConnAck {
+        session_present: bool,
+        return_code: u8,
+    },
+    Publish(PublishView<'a>),
+    PubAck {
+        packet_id: u16,
+    },
+    SubAck {
+        packet_id: u16,
+        return_codes: &'a [u8],
+    },
+    UnsubAck {
+        packet_id: u16,
+    },
+    PingResp,
+    /// Any packet type the client does not act on
+    Other {
+        packet_type: u8,
+    },
+}
+
+/// Streaming decoder with a reusable read buffer
+pub struct MqttCodec {
+    version: ProtocolVersion,
+    read_buf: BytesMut,
+    /// Length of the packet handed out by the last `next_packet` call; released lazily
+    /// so the returned view can borrow the buffer.
+    consumed: usize,
+    max_packet_size: usize,
+}
+
+impl MqttCodec {
+    pub fn new(version: ProtocolVersion) -> Self {
+        Self::with_capacity(version, DEFAULT_READ_CAPACITY)
+    }
+
+    pub fn with_capacity(version: ProtocolVersion, capacity: usize) -> Self {
+        Self {
+            version,
+            read_buf: BytesMut::with_capacity(capacity),
+            consumed: 0,
+            max_packet_size: DEFAULT_MAX_PACKET_SIZE,
+        }
+    }
+
+    pub fn with_max_packet_size(mut self, max_packet_size: usize) -> Self {
+        self.max_packet_size = max_packet_size.min(MAX_REMAINING_LENGTH + 5);
+        self
+    }
+
+    pub fn version(&self) -> ProtocolVersion {
+        self.version
+    }
+
+    /// Bytes received but not yet decoded
+    pub fn buffered_len(&self) -> usize {
+        self.read_buf.len() - self.consumed
+    }
+
+    /// Current read buffer capacity, for memory telemetry
+    pub fn capacity(&self) -> usize {
+        self.read_buf.capacity()
+    }
+
+    /// Append a received WebSocket frame
+    pub fn push_frame(&mut self, frame: &[u8]) {
+        self.release_consumed();
+        self.read_buf.extend_from_slice(frame);
+    }
+
+    /// Append `len` bytes written directly into the read buffer by `fill`.
+    ///
+    /// Lets the web client copy a JS `Uint8Array` straight into the buffer without
+    /// an intermediate `Vec`.
+    pub fn push_with(&mut self, len: usize, fill: impl FnOnce(&mut [u8])) {
+        self.release_consumed();
+        let start = self.read_buf.len();
+        self.read_buf.resize(start + len, 0);
+        fill(&mut self.read_buf[start..]);
+    }
+
+    /// Drop any partially received data (e.g. after a reconnect)
+    pub fn reset(&mut self) {
+        self.read_buf.clear();
+        self.consumed = 0;
+    }
+
+    /// Give back a read buffer that grew for a large message (e.g. a world snapshot)
+    /// once nothing is pending. Returns whether the buffer was released.
+    pub fn shrink_if_idle(&mut self, max_idle_capacity: usize) -> bool {
+        if self.buffered_len() > 0 || self.read_buf.capacity() <= max_idle_capacity {
+            return false;
+        }
+        self.read_buf = BytesMut::with_capacity(DEFAULT_READ_CAPACITY.min(max_idle_capacity));
+        self.consumed = 0;
+        true
+    }
+
+    fn release_consumed(&mut self) {
+        if self.consumed > 0 {
+            self.read_buf.advance(self.consumed);
+            self.consumed = 0;
+        }
+    }
+
+    /// Decode the next complete packet, or `Ok(None)` if more data is needed.
+    ///
+    /// Framing errors discard the buffered data; a malformed packet body only skips
+    /// that packet.
+    pub fn next_packet(&mut self) -> Result<Option<Packet<'_>>, CodecError> {
+        self.release_consumed();
+
+        let (remaining_length, length_bytes) = match decode_remaining_length(&self.read_buf, 1) {
+            Ok(Some(decoded)) => decoded,
+            Ok(None) => return Ok(None),
+            Err(e) => {
+                self.reset();
+                return Err(e);
+            }
+        };
+
+        let total = 1 + length_bytes + remaining_length;
+        if total > self.max_packet_size {
+            self.reset();
+            return Err(CodecError::PacketTooLarge(total));
+        }
+        if self.read_buf.len() < total {
+            // Reserve the rest of the packet up front so large snapshots grow once
+            self.read_buf.reserve(total - self.read_buf.len());
+            return Ok(None);
+        }
+
+        self.consumed = total;
+        let header = self.read_buf[0];
+        let body = &self.read_buf[1 + length_bytes..total];
+        // A malformed body leaves framing intact, so only this packet is skipped
+        parse_packet(self.version, header, body).map(Some)
+    }
+}
+
+/// Decode an MQTT variable byte integer starting at `offset`.
+///
+/// Returns `(value, bytes_used)`, or `None` if the buffer ends first.
+pub fn decode_remaining_length(
+    data: &[u8],
+    offset: usize,
+) -> Result<Option<(usize, usize)>, CodecError> {
+    let mut value = 0usize;
+    for i in 0..4 {
+        let Some(&byte) = data.get(offset + i) else {
+            return Ok(None);
+        };
+        value |= ((byte & 0x7F) as usize) << (7 * i);
+        if byte & 0x80 == 0 {
+            return Ok(Some((value, i + 1)));
+        }
+    }
+    Err(CodecError::MalformedRemainingLength)
+}
+
+/// Number of bytes needed to encode `len` as a variable byte integer
+pub fn remaining_length_len(len: usize) -> usize {
+    match len {
+        0..=127 => 1,
+        128..=16_383 => 2,
+        16_384..=2_097_151 => 3,
+        _ => 4,
+    }
+}
+
+/// Write `len` as a variable byte integer
+pub fn put_remaining_length<B: BufMut>(dst: &mut B, len: usize) -> Result<(), CodecError> {
+    if len > MAX_REMAINING_LENGTH {
+        return Err(CodecError::PacketTooLarge(len));
+    }
+    let mut x = len;
+    loop {
+        let mut byte = (x % 128) as u8;
+        x /= 128;
+        if x > 0 {
+            byte |= 0x80;
+        }
+        dst.put_u8(byte);
+        if x == 0 {
+            return Ok(());
+        }
+    }
+}
+
+fn put_str<B: BufMut>(dst: &mut B, s: &str) -> Result<(), CodecError> {
+    let len = u16::try_from(s.len()).map_err(|_| CodecError::StringTooLong(s.len()))?;
+    dst.put_u16(len);
+    dst.put_slice(s.as_bytes());
+    Ok(())
+}
+
+fn put_empty_properties<B: BufMut>(dst: &mut B, version: ProtocolVersion) {
+    if version == ProtocolVersion::V5 {
+        dst.put_u8(0);
+    }
+}
+
+/// Write a CONNECT packet with clean session and the given keep-alive
+pub fn encode_connect<B: BufMut>(
+    dst: &mut B,
+    version: ProtocolVersion,
+    client_id: &str,
+    keep_alive_secs: u16,
+) -> Result<(), CodecError> {
+    // "MQTT" name + level + flags + keep alive + properties + client id
+    let remaining = 6 + 1 + 1 + 2 + version.properties_len() + 2 + client_id.len();
+    dst.put_u8(CONNECT << 4);
+    put_remaining_length(dst, remaining)?;
+    put_str(dst, "MQTT")?;
+    dst.put_u8(version.level());
+    dst.put_u8(0x02); // clean session / clean start
+    dst.put_u16(keep_alive_secs);
+    put_empty_properties(dst, version);
+    put_str(dst, client_id)
+}
+
+/// Write a SUBSCRIBE packet for a single topic filter
+pub fn encode_subscribe<B: BufMut>(
+    dst: &mut B,
+    version: ProtocolVersion,
+    topic_filter: &str,
+    packet_id: u16,
+    qos: QoS,
+) -> Result<(), CodecError> {
+    let remaining = 2 + version.properties_len() + 2 + topic_filter.len() + 1;
+    dst.put_u8((SUBSCRIBE << 4) | 0x02);
+    put_remaining_length(dst, remaining)?;
+    dst.put_u16(packet_id);
+    put_empty_properties(dst, version);
+    put_str(dst, topic_filter)?;
+    dst.put_u8(qos as u8);
+    Ok(())
+}
+
+/// Write a PUBLISH packet. `packet_id` is required for QoS 1 and 2.
+pub fn encode_publish<B: BufMut>(
+    dst: &mut B,
+    version: ProtocolVersion,
+    topic: &str,
+    payload: &[u8],
+    qos: QoS,
+    retain: bool,
+    packet_id: u16,
+) -> Result<(), CodecError> {
+    let id_len = if qos == QoS::AtMostOnce { 0 } else { 2 };
+    let remaining = 2 + topic.len() + id_len + version.properties_len() + payload.len();
+    dst.put_u8((PUBLISH << 4) | ((qos as u8) << 1) | u8::from(retain));
+    put_remaining_length(dst, remaining)?;
+    put_str(dst, topic)?;
+    if qos != QoS::AtMostOnce {
+        dst.put_u16(packet_id);
+    }
+    put_empty_properties(dst, version);
+    dst.put_slice(payload);
+    Ok(())
+}
+
+/// Write a PUBACK for a received QoS 1 PUBLISH
+pub fn encode_puback<B: BufMut>(dst: &mut B, packet_id: u16) {
+    // MQTT 5 allows omitting the reason code when it is Success
+    dst.put_u8(PUBACK << 4);
+    dst.put_u8(2);
+    dst.put_u16(packet_id);
+}
+
+/// Write a PINGREQ keep-alive packet
+pub fn encode_pingreq<B: BufMut>(dst: &mut B) {
+    dst.put_u8(PINGREQ << 4);
+    dst.put_u8(0);
+}
+
+fn read_u16(body: &[u8], offset: usize, field: &'static str) -> Result<u16, CodecError> {
+    match body.get(offset..offset + 2) {
+        Some(bytes) => Ok(u16::from_be_bytes([bytes[0], bytes[1]])),
+        None => Err(CodecError::Truncated(field)),
+    }
+}
+
+/// Skip an MQTT 5 property block, returning the offset just past it
+fn skip_properties(
+    version: ProtocolVersion,
+    body: &[u8],
+    offset: usize,
+) -> Result<usize, CodecError> {
+    if version != ProtocolVersion::V5 || offset >= body.len() {
+        return Ok(offset);
+    }
+    let (len, len_bytes) =
+        decode_remaining_length(body, offset)?.ok_or(CodecError::Truncated("properties"))?;
+    let end = offset + len_bytes + len;
+    if end > body.len() {
+        return Err(CodecError::Truncated("properties"));
+    }
+    Ok(end)
+}
+
+fn parse_packet(
+    version: ProtocolVersion,
+    header: u8,
+    body: &[u8],
+) -> Result<Packet<'_>, CodecError> {
+    let packet_type = header >> 4;
+    match packet_type {
+        CONNACK => {
+            if body.len() < 2 {
+                return Err(CodecError::Truncated("connack"));
+            }
+            Ok(Packet::ConnAck {
+                session_present: body[0] & 0x01 != 0,
+                return_code: body[1],
+            })
+        }
+        PUBLISH => {
+            let flags = header & 0x0F;
+            let qos = QoS::from_bits((flags >> 1) & 0x03)?;
+            let topic_len = read_u16(body, 0, "topic length")? as usize;
+            let topic_bytes = body
+                .get(2..2 + topic_len)
+                .ok_or(CodecError::Truncated("topic"))?;
+            let topic = std::str::from_utf8(topic_bytes).map_err(|_| CodecError::InvalidTopic)?;
+            let mut offset = 2 + topic_len;
+            let packet_id = if qos == QoS::AtMostOnce {
+                None
+            } else {
+                let id = read_u16(body, offset, "packet id")?;
+                offset += 2;
+                Some(id)
+            };
+            offset = skip_properties(version, body, offset)?;
+            Ok(Packet::Publish(PublishView {
+                topic,
+                payload: &body[offset..],
+                qos,
+                retain: flags & 0x01 != 0,
+                dup: flags & 0x08 != 0,
+                packet_id,
+            }))
+        }
+        PUBACK => Ok(Packet::PubAck {
+            packet_id: read_u16(body, 0, "packet id")?,
+        }),
+        SUBACK => {
+            let packet_id = read_u16(body, 0, "packet id")?;
+            let offset = skip_properties(version, body, 2)?;
+            Ok(Packet::SubAck {
+                packet_id,
+                return_codes: &body[offset..],
+            })
+        }
+        UNSUBACK => Ok(Packet::UnsubAck {
+            packet_id: read_u16(body, 0, "packet id")?,
+        }),
+        PINGRESP => Ok(Packet::PingResp),
+        _ => Ok(Packet::Other { packet_type }),
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn publish_bytes(version: ProtocolVersion, topic: &str, payload: &[u8], qos: QoS) -> BytesMut {
+        let mut buf = BytesMut::new();
+        encode_publish(&mut buf, version, topic, payload, qos, false, 7).unwrap();
+        buf
+    }
+
+    #[test]
+    fn test_remaining_length_round_trip() {
+        for len in [
+            0,
+            127,
+            128,
+            16_383,
+            16_384,
+            2_097_151,
+            2_097_152,
+            MAX_REMAINING_LENGTH,
+        ] {
+            let mut buf = BytesMut::new();
+            put_remaining_length(&mut buf, len).unwrap();
+            assert_eq!(buf.len(), remaining_length_len(len));
+            assert_eq!(
+                decode_remaining_length(&buf, 0).unwrap(),
+                Some((len, buf.len()))
+            );
+        }
+        assert!(put_remaining_length(&mut BytesMut::new(), MAX_REMAINING_LENGTH + 1).is_err());
+        assert_eq!(
+            decode_remaining_length(&[0xFF, 0xFF, 0xFF, 0xFF, 0x01], 0),
+            Err(CodecError::MalformedRemainingLength)
+        );
+        assert_eq!(decode_remaining_length(&[0x80], 0), Ok(None));
+    }
+
+    #[test]
+    fn test_publish_round_trip_borrowed() {
+        for version in [ProtocolVersion::V311, ProtocolVersion::V5] {
+            let bytes = publish_bytes(
+                version,
+                "iotcraft/worlds/w1/data",
+                b"{\"blocks\":[]}",
+                QoS::AtMostOnce,
+            );
+            let mut codec = MqttCodec::new(version);
+            codec.push_frame(&bytes);
+            match codec.next_packet().unwrap() {
+                Some(Packet::Publish(p)) => {
+                    assert_eq!(p.topic, "iotcraft/worlds/w1/data");
+                    assert_eq!(p.payload, b"{\"blocks\":[]}");
+                    assert_eq!(p.qos, QoS::AtMostOnce);
+                    assert_eq!(p.packet_id, None);
+                    assert_eq!(p.puback_id(), None);
+                }
+                other => panic!("unexpected packet: {:?}", other),
+            }
+            assert_eq!(codec.next_packet().unwrap(), None);
+            assert_eq!(codec.buffered_len(), 0);
+        }
+    }
+
+    #[test]
+    fn test_fragmented_across_frames() {
+        let mut stream = BytesMut::new();
+        stream.extend_from_slice(&publish_bytes(
+            ProtocolVersion::V311,
+            "a/b",
+            &[1; 300],
+            QoS::AtMostOnce,
+        ));
+        stream.extend_from_slice(&publish_bytes(
+            ProtocolVersion::V311,
+            "c/d",
+            &[2; 5],
+            QoS::AtLeastOnce,
+        ));
+        encode_pingreq(&mut stream);
+        // PINGREQ is client-to-server, decode it as an opaque packet
+        let mut codec = MqttCodec::new(ProtocolVersion::V311);
+        let mut topics = Vec::new();
+        for byte in stream.iter() {
+            codec.push_frame(std::slice::from_ref(byte));
+            while let Some(packet) = codec.next_packet().unwrap() {
+                match packet {
+                    Packet::Publish(p) => {
+                        topics.push((p.topic.to_string(), p.payload.len(), p.puback_id()))
+                    }
+                    Packet::Other { packet_type } => assert_eq!(packet_type, PINGREQ),
+                    other => panic!("unexpected packet: {:?}", other),
+                }
+            }
+        }
+        assert_eq!(
+            topics,
+            vec![
+                ("a/b".to_string(), 300, None),
+                ("c/d".to_string(), 5, Some(7))
+            ]
+        );
+    }
+
+    #[test]
+    fn test_multiple_packets_in_one_frame() {
+        let mut frame = BytesMut::new();
+        frame.extend_from_slice(&[0x20, 0x02, 0x00, 0x00]); // CONNACK accepted
+        frame.extend_from_slice(&[0x90, 0x03, 0x00, 0x05, 0x01]); // SUBACK id 5, QoS 1
+        frame.extend_from_slice(&[0x40, 0x02, 0x00, 0x09]); // PUBACK id 9
+        let mut codec = MqttCodec::new(ProtocolVersion::V311);
+        codec.push_with(frame.len(), |dst| dst.copy_from_slice(&frame));
+        assert_eq!(
+            codec.next_packet().unwrap(),
+            Some(Packet::ConnAck {
+                session_present: false,
+                return_code: 0
+            })
+        );
+        assert_eq!(
+            codec.next_packet().unwrap(),
+            Some(Packet::SubAck {
+                packet_id: 5,
+                return_codes: &[0x01]
+            })
+        );
+        assert_eq!(
+            codec.next_packet().unwrap(),
+            Some(Packet::PubAck { packet_id: 9 })
+        );
+        assert_eq!(codec.next_packet().unwrap(), None);
+    }
+
+    #[test]
+    fn test_v5_suback_skips_properties() {
+        // SUBACK id 3, 3-byte property block, reason code 0, split over two frames
+        let frame = [0x90, 0x07, 0x00, 0x03, 0x03, 0x1F, 0x00, 0x01, 0x00];
+        let mut codec = MqttCodec::new(ProtocolVersion::V5);
+        codec.push_frame(&frame[..frame.len() - 1]);
+        codec.push_frame(&[0x00]);
+        assert_eq!(
+            codec.next_packet().unwrap(),
+            Some(Packet::SubAck {
+                packet_id: 3,
+                return_codes: &[0x00]
+            })
+        );
+    }
+
+    #[test]
+    fn test_encoders_match_reference_bytes() {
+        let mut buf = BytesMut::new();
+        encode_connect(&mut buf, ProtocolVersion::V311, "id", 60).unwrap();
+        assert_eq!(
+            &buf[..],
+            &[
+                0x10, 14, 0, 4, b'M', b'Q', b'T', b'T', 4, 0x02, 0, 60, 0, 2, b'i', b'd'
+            ]
+        );
+
+        buf.clear();
+        encode_subscribe(&mut buf, ProtocolVersion::V311, "a/+", 4, QoS::AtLeastOnce).unwrap();
+        assert_eq!(&buf[..], &[0x82, 8, 0, 4, 0, 3, b'a', b'/', b'+', 1]);
+
+        buf.clear();
+        encode_publish(
+            &mut buf,
+            ProtocolVersion::V311,
+            "t",
+            b"x",
+            QoS::AtMostOnce,
+            true,
+            0,
+        )
+        .unwrap();
+        assert_eq!(&buf[..], &[0x31, 4, 0, 1, b't', b'x']);
+
+        buf.clear();
+        encode_puback(&mut buf, 0x0102);
+        assert_eq!(&buf[..], &[0x40, 2, 1, 2]);
+    }
+
+    #[test]
+    fn test_invalid_packets_are_rejected() {
+        let mut codec = MqttCodec::new(ProtocolVersion::V311).with_max_packet_size(16);
+        codec.push_frame(&publish_bytes(
+            ProtocolVersion::V311,
+            "topic",
+            &[0; 32],
+            QoS::AtMostOnce,
+        ));
+        assert!(matches!(
+            codec.next_packet(),
+            Err(CodecError::PacketTooLarge(_))
+        ));
+        assert_eq!(codec.buffered_len(), 0);
+
+        let mut codec = MqttCodec::new(ProtocolVersion::V311);
+        codec.push_frame(&[0x36, 0x03, 0x00, 0x01, b't']); // QoS bits = 3
+        assert_eq!(codec.next_packet(), Err(CodecError::InvalidQoS(3)));
+        // Framing survived, the next packet still decodes
+        codec.push_frame(&[0xD0, 0x00]);
+        assert_eq!(codec.next_packet().unwrap(), Some(Packet::PingResp));
+    }
+
+    #[test]
+    fn test_large_read_buffer_is_released_when_idle() {
+        let mut codec = MqttCodec::with_capacity(ProtocolVersion::V311, 64);
+        let big = publish_bytes(ProtocolVersion::V311, "w", &[7; 4096], QoS::AtMostOnce);
+        codec.push_frame(&big[..100]);
+        assert!(!codec.shrink_if_idle(1024), "pending data must be kept");
+
+        codec.push_frame(&big[100..]);
+        assert!(matches!(codec.next_packet(), Ok(Some(Packet::Publish(_)))));
+        assert!(codec.capacity() >= 4096);
+        assert!(codec.shrink_if_idle(1024));
+        assert!(codec.capacity() <= 1024);
+        assert!(!codec.shrink_if_idle(1024));
+    }
+}
@@ -2,7 +2,7 @@ use bevy::app::AppExit;
 use bevy::prelude::*;
 use rumqttc::{AsyncClient, Event, Incoming, MqttOptions, QoS};
 use std::sync::Mutex;
-use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::atomic::{AtomicBool, AtomicUsize, Ordering};
 use std::thread;
 use tokio::sync::mpsc;
 use tokio::time::Duration;
@@ -11,7 +11,9 @@ use super::mqtt_types::*;
 use crate::config::MqttConfig;
 use crate::devices::DeviceAnnouncementReceiver;
 use crate::multiplayer::mqtt_utils::generate_unique_client_id;
-use crate::multiplayer::{BlockChangeEvent, BlockChangeType, PoseRx, PoseTx};
+use crate::multiplayer::{
+    BlockChangeBatchMessage, BlockChangeEvent, BlockChangeType, PoseRx, PoseTx,
+};
 
 // Re-export key multiplayer types that are now handled by core service
 pub use crate::multiplayer::PoseMessage;
@@ -57,7 +59,18 @@ pub struct WorldDiscoveryReceiver(pub Mutex<std::sync::mpsc::Receiver<SharedWorl
 
 /// Resource for receiving world data messages (complete world save data)
 #[derive(Resource)]
-pub struct WorldDataReceiver(pub Mutex<std::sync::mpsc::Receiver<(String, WorldSaveData)>>);
+pub struct WorldDataReceiver(
+    pub Mutex<std::sync::mpsc::Receiver<(String, WorldSaveData, WorldDataSource)>>,
+);
+
+/// Where a received world snapshot came from
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum WorldDataSource {
+    /// The host's retained snapshot on `iotcraft/worlds/{id}/data`
+    Retained,
+    /// The broker's answer to this client's snapshot request
+    SnapshotReply,
+}
 
 /// Resource for sending world publishing events
 #[derive(Resource)]
@@ -80,6 +93,83 @@ pub struct CoreMqttConnectionStatus {
 /// Global shutdown flag for Core MQTT Service
 static MQTT_SERVICE_SHUTDOWN: AtomicBool = AtomicBool::new(false);
 
+/// Retained topic on which the IoTCraft broker advertises the requests it answers
+const BROKER_FEATURES_TOPIC: &str = "iotcraft/broker/features";
+
+/// Whether the broker advertised that it answers world snapshot requests
+static BROKER_SERVES_SNAPSHOTS: AtomicBool = AtomicBool::new(false);
+
+/// Whether joins can ask the broker for the current world; plain brokers never answer
+pub fn broker_serves_snapshots() -> bool {
+    BROKER_SERVES_SNAPSHOTS.load(Ordering::Relaxed)
+}
+
+/// Channels between the MQTT thread and the ECS, tracked for the profiler panel
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum MqttQueue {
+    Temperature,
+    Devices,
+    Poses,
+    WorldInfo,
+    WorldData,
+    BlockChanges,
+    Outgoing,
+}
+
+static MQTT_QUEUE_DEPTHS: [AtomicUsize; MqttQueue::ALL.len()] =
+    [const { AtomicUsize::new(0) }; MqttQueue::ALL.len()];
+
+impl MqttQueue {
+    pub const ALL: [MqttQueue; 7] = [
+        MqttQueue::Temperature,
+        MqttQueue::Devices,
+        MqttQueue::Poses,
+        MqttQueue::WorldInfo,
+        MqttQueue::WorldData,
+        MqttQueue::BlockChanges,
+        MqttQueue::Outgoing,
+    ];
+
+    pub fn name(self) -> &'static str {
+        match self {
+            MqttQueue::Temperature => "temperature",
+            MqttQueue::Devices => "devices",
+            MqttQueue::Poses => "poses",
+            MqttQueue::WorldInfo => "world_info",
+            MqttQueue::WorldData => "world_data",
+            MqttQueue::BlockChanges => "block_changes",
+            MqttQueue::Outgoing => "outgoing",
+        }
+    }
+
+    /// Messages sent but not yet received
+    pub fn depth(self) -> usize {
+        MQTT_QUEUE_DEPTHS[self as usize].load(Ordering::Relaxed)
+    }
+
+    /// Send on the queue's channel, counting the message as waiting until received
+    fn send<T>(self, tx: &std::sync::mpsc::Sender<T>, message: T) {
+        // Count first: the receiver may take the message before send returns
+        MQTT_QUEUE_DEPTHS[self as usize].fetch_add(1, Ordering::Relaxed);
+        if tx.send(message).is_err() {
+            self.dequeued();
+        }
+    }
+
+    /// Record a message taken off the queue
+    pub fn dequeued(self) {
+        let _ = MQTT_QUEUE_DEPTHS[self as usize].fetch_update(
+            Ordering::Relaxed,
+            Ordering::Relaxed,
+            |depth| Some(depth.saturating_sub(1)),
+        );
+    }
+
+    fn set_depth(self, depth: usize) {
+        MQTT_QUEUE_DEPTHS[self as usize].store(depth, Ordering::Relaxed);
+    }
+}
+
 /// Core MQTT service plugin that consolidates all MQTT functionality
 pub struct CoreMqttServicePlugin;
 
@@ -94,7 +184,8 @@ impl Plugin for CoreMqttServicePlugin {
                     update_temperature,
                     update_mqtt_connection_status,
                     handle_app_exit,
-                    process_incoming_block_changes,
+                    // Remote edits reach the voxel world in the frame they arrive
+                    process_incoming_block_changes.before(crate::environment::VoxelSet::Edit),
                 ),
             );
     }
@@ -114,7 +205,8 @@ pub fn initialize_core_mqtt_service(
     let (pose_tx, pose_rx) = std::sync::mpsc::channel::<PoseMessage>();
     let (outgoing_pose_tx, outgoing_pose_rx) = std::sync::mpsc::channel::<PoseMessage>();
     let (world_discovery_tx, world_discovery_rx) = std::sync::mpsc::channel::<SharedWorldInfo>();
-    let (world_data_tx, world_data_rx) = std::sync::mpsc::channel::<(String, WorldSaveData)>();
+    let (world_data_tx, world_data_rx) =
+        std::sync::mpsc::channel::<(String, WorldSaveData, WorldDataSource)>();
     let (world_publish_event_tx, world_publish_event_rx) =
         std::sync::mpsc::channel::<PublishWorldEvent>();
     let (mqtt_outgoing_tx, mut mqtt_outgoing_rx) = mpsc::unbounded_channel::<OutgoingMqttMessage>();
@@ -194,6 +286,11 @@ pub fn initialize_core_mqtt_service(
             // Only subscribe on first connection or if subscriptions were not established
             if !subscriptions_established {
                 info!("📡 Establishing subscriptions for the first time...");
+                // Snapshots the broker serves from its own world state on join
+                let snapshot_reply_topic =
+                    format!("iotcraft/worlds/+/clients/{}/data", player_id);
+                // Latency probes the broker times this client's deliveries with
+                let probe_topic = format!("iotcraft/worlds/+/clients/{}/probe", player_id);
                 let topics = vec![
                     "home/sensor/temperature",
                     "devices/announce",
@@ -202,6 +299,10 @@ pub fn initialize_core_mqtt_service(
                     "iotcraft/worlds/+/players/+/pose",
                     "iotcraft/worlds/+/state/blocks/placed",
                     "iotcraft/worlds/+/state/blocks/removed",
+                    "iotcraft/worlds/+/state/blocks/batch",
+                    snapshot_reply_topic.as_str(),
+                    probe_topic.as_str(),
+                    BROKER_FEATURES_TOPIC,
                 ];
 
                 for topic in &topics {
@@ -239,6 +340,14 @@ pub fn initialize_core_mqtt_service(
                                 }
                             }
                             Ok(Event::Incoming(Incoming::Publish(p))) => {
+                                // Echo probes right away: their round trip is this client's delivery lag.
+                                // Never wait for the request queue here, this task is the one draining it.
+                                if let Some(reply) = probe_reply_topic(&p.topic, &player_id) {
+                                    if let Err(e) = client.try_publish(reply, QoS::AtMostOnce, false, p.payload.to_vec()) {
+                                        error!("❌ Failed to answer latency probe: {}", e);
+                                    }
+                                    continue;
+                                }
                                 info!("📥 MQTT message received on topic '{}' - Size: {} bytes ({}MB)", 
                                      p.topic, p.payload.len(), p.payload.len() as f64 / 1048576.0);
                                 route_incoming_message(
@@ -275,6 +384,7 @@ pub fn initialize_core_mqtt_service(
 
                     // Handle outgoing messages (non-blocking)
                     msg = mqtt_outgoing_rx.recv() => {
+                        MqttQueue::Outgoing.set_depth(mqtt_outgoing_rx.len());
                         if let Some(outgoing_msg) = msg {
                             if connected {
                                 info!("📤 Processing outgoing message: {:?}", outgoing_msg);
@@ -349,15 +459,26 @@ pub fn initialize_core_mqtt_service(
     info!("✅ Core MQTT Service initialized");
 }
 
+/// Topic to echo a broker latency probe on, if `topic` is a probe addressed to this player
+fn probe_reply_topic(topic: &str, player_id: &str) -> Option<String> {
+    let world_id = topic
+        .strip_prefix("iotcraft/worlds/")?
+        .strip_suffix(&format!("/clients/{}/probe", player_id))?;
+    Some(format!(
+        "iotcraft/worlds/{}/players/{}/probe",
+        world_id, player_id
+    ))
+}
+
 /// Route incoming MQTT messages to the appropriate channels based on topic
-fn route_incoming_message(
+pub fn route_incoming_message(
     topic: &str,
     payload: &[u8],
     temp_tx: &std::sync::mpsc::Sender<f32>,
     device_tx: &std::sync::mpsc::Sender<String>,
     pose_tx: &std::sync::mpsc::Sender<PoseMessage>,
     world_discovery_tx: &std::sync::mpsc::Sender<SharedWorldInfo>,
-    world_data_tx: &std::sync::mpsc::Sender<(String, WorldSaveData)>,
+    world_data_tx: &std::sync::mpsc::Sender<(String, WorldSaveData, WorldDataSource)>,
     block_change_tx: &std::sync::mpsc::Sender<BlockChangeEvent>,
     local_player_id: &str,
 ) {
@@ -365,7 +486,7 @@ fn route_incoming_message(
         "home/sensor/temperature" => {
             if let Ok(temp_str) = String::from_utf8(payload.to_vec()) {
                 if let Ok(temp_val) = temp_str.parse::<f32>() {
-                    let _ = temp_tx.send(temp_val);
+                    MqttQueue::Temperature.send(temp_tx, temp_val);
                     info!("🌡️ Temperature update: {}°C", temp_val);
                 }
             }
@@ -373,9 +494,20 @@ fn route_incoming_message(
         "devices/announce" => {
             if let Ok(device_msg) = String::from_utf8(payload.to_vec()) {
                 info!("📢 Device announcement received: {}", device_msg);
-                let _ = device_tx.send(device_msg);
+                MqttQueue::Devices.send(device_tx, device_msg);
             }
         }
+        BROKER_FEATURES_TOPIC => {
+            let serves_snapshots = serde_json::from_slice::<serde_json::Value>(payload)
+                .ok()
+                .and_then(|features| features["snapshot_requests"].as_bool())
+                .unwrap_or(false);
+            info!(
+                "📣 Broker features received, snapshot requests answered: {}",
+                serves_snapshots
+            );
+            BROKER_SERVES_SNAPSHOTS.store(serves_snapshots, Ordering::Relaxed);
+        }
         _ => {
             // Handle pattern-based topics
             if topic.starts_with("iotcraft/worlds/") && topic.ends_with("/info") {
@@ -390,7 +522,7 @@ fn route_incoming_message(
                                 "🌍 Discovered world: {} ({})",
                                 world_info.world_name, world_info.world_id
                             );
-                            let _ = world_discovery_tx.send(world_info);
+                            MqttQueue::WorldInfo.send(world_discovery_tx, world_info);
                         } else {
                             error!("❌ Failed to parse world info JSON: {}", world_info_str);
                         }
@@ -429,7 +561,13 @@ fn route_incoming_message(
                                         world_id,
                                         world_data.blocks.len()
                                     );
-                                    let _ = world_data_tx.send((world_id, world_data));
+                                    let source = if topic.contains("/clients/") {
+                                        WorldDataSource::SnapshotReply
+                                    } else {
+                                        WorldDataSource::Retained
+                                    };
+                                    MqttQueue::WorldData
+                                        .send(world_data_tx, (world_id, world_data, source));
                                 }
                                 Err(e) => {
                                     error!(
@@ -460,12 +598,39 @@ fn route_incoming_message(
                 if let Ok(pose_str) = String::from_utf8(payload.to_vec()) {
                     if let Ok(pose_msg) = serde_json::from_str::<PoseMessage>(&pose_str) {
                         let player_name = pose_msg.player_name.clone();
-                        let _ = pose_tx.send(pose_msg);
+                        MqttQueue::Poses.send(pose_tx, pose_msg);
                         info!("📡 Received pose from player: {}", player_name);
                     } else {
                         error!("❌ Failed to parse pose message: {}", pose_str);
                     }
                 }
+            } else if topic.starts_with("iotcraft/worlds/")
+                && topic.ends_with("/state/blocks/batch")
+            {
+                // Bulk edits, up to BLOCK_BATCH_SIZE changes per message
+                let world_id = topic.split('/').nth(2).unwrap_or_default().to_string();
+                match serde_json::from_slice::<BlockChangeBatchMessage>(payload) {
+                    Ok(batch) if batch.player_id == local_player_id => {}
+                    Ok(batch) => {
+                        info!(
+                            "🧱 Received {} block changes from {} on {}",
+                            batch.changes.len(),
+                            batch.player_name,
+                            topic
+                        );
+                        for change_type in batch.changes {
+                            let block_change_event = BlockChangeEvent {
+                                world_id: world_id.clone(),
+                                player_id: batch.player_id.clone(),
+                                player_name: batch.player_name.clone(),
+                                change_type,
+                                source: crate::multiplayer::BlockChangeSource::Remote,
+                            };
+                            MqttQueue::BlockChanges.send(block_change_tx, block_change_event);
+                        }
+                    }
+                    Err(e) => error!("❌ Failed to parse block change batch on {}: {}", topic, e),
+                }
             } else if topic.starts_with("iotcraft/worlds/")
                 && topic.contains("/state/blocks/")
                 && (topic.ends_with("/placed") || topic.ends_with("/removed"))
@@ -524,7 +689,8 @@ fn route_incoming_message(
                                         player_name, block_change_event.change_type
                                     );
 
-                                    let _ = block_change_tx.send(block_change_event);
+                                    MqttQueue::BlockChanges
+                                        .send(block_change_tx, block_change_event);
                                 } else {
                                     error!(
                                         "❌ Failed to parse block change type from: {:?}",
@@ -562,6 +728,7 @@ pub fn update_temperature(
 ) {
     if let Ok(rx) = receiver.0.lock() {
         if let Ok(val) = rx.try_recv() {
+            MqttQueue::Temperature.dequeued();
             temp_res.value = Some(val);
         }
     }
@@ -577,6 +744,7 @@ pub fn process_incoming_block_changes(
     if let Ok(rx) = receiver.0.lock() {
         // Process all available block change messages
         while let Ok(block_change) = rx.try_recv() {
+            MqttQueue::BlockChanges.dequeued();
             // Skip messages from our own player to prevent infinite feedback loops
             if block_change.player_id == profile.player_id {
                 info!(
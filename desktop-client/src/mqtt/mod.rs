@@ -1,3 +1,4 @@
+pub mod codec;
 pub mod mqtt_helpers;
 pub mod mqtt_types;
 
@@ -10,6 +10,7 @@ fn generate_unique_client_id(prefix: &str) -> String {
 }
 
 use bevy::prelude::*;
+use bytes::BytesMut;
 use js_sys::Uint8Array;
 use std::cell::RefCell;
 use std::rc::Rc;
@@ -19,9 +20,12 @@ use wasm_bindgen::JsCast;
 use wasm_bindgen::prelude::*;
 use web_sys::{BinaryType, ErrorEvent, MessageEvent, WebSocket};
 
+use super::codec::{self, CodecError, MqttCodec, Packet, ProtocolVersion, QoS};
 use super::mqtt_types::*;
 use crate::config::MqttConfig;
 use crate::profile::PlayerProfile;
+use crate::world::chunk_mesh::{ChunkMeshData, PrebuiltChunkMeshes};
+use crate::world::web_worker::{self, DecodedWorld, WorldDecodeWorker};
 
 // Import multiplayer types
 use serde::{Deserialize, Serialize};
@@ -65,6 +69,7 @@ impl Plugin for WebMqttPlugin {
                     update_temperature,
                     update_world_discovery,
                     update_world_data_cache,
+                    update_prebuilt_chunk_meshes,
                     handle_world_publishing,
                     handle_refresh_events,
                 ),
@@ -75,262 +80,122 @@ impl Plugin for WebMqttPlugin {
     }
 }
 
-/// Simple MQTT packet builder for WebSocket
-struct SimpleMqttPackets;
-
-impl SimpleMqttPackets {
-    /// Encode variable length integer for MQTT protocol
-    fn encode_remaining_length(length: usize) -> Vec<u8> {
-        let mut encoded = Vec::new();
-        let mut x = length;
-
-        loop {
-            let mut encoded_byte = (x % 128) as u8;
-            x /= 128;
-            if x > 0 {
-                encoded_byte |= 0x80;
-            }
-            encoded.push(encoded_byte);
-            if x == 0 {
-                break;
-            }
-        }
-
-        encoded
-    }
-
-    /// Decode variable length integer from MQTT packet
-    fn decode_remaining_length(data: &[u8], start_offset: usize) -> Option<(usize, usize)> {
-        let mut value = 0usize;
-        let mut multiplier = 1;
-        let mut offset = start_offset;
-
-        loop {
-            if offset >= data.len() {
-                return None;
-            }
-
-            let encoded_byte = data[offset];
-            value += ((encoded_byte & 0x7F) as usize) * multiplier;
-
-            if multiplier > 128 * 128 * 128 {
-                return None; // Malformed remaining length
-            }
-
-            offset += 1;
-
-            if (encoded_byte & 0x80) == 0 {
-                break;
-            }
-
-            multiplier *= 128;
-        }
-
-        Some((value, offset - start_offset))
-    }
-
-    /// Parse MQTT SUBACK packet to check subscription acknowledgment
-    fn parse_suback_packet(data: &[u8]) -> Option<(u16, Vec<u8>)> {
-        if data.len() < 2 || (data[0] & 0xF0) != 0x90 {
-            return None; // Not a SUBACK packet
-        }
-
-        let (remaining_length, length_bytes) = Self::decode_remaining_length(data, 1)?;
-        let header_end = 1 + length_bytes;
+/// Reusable outgoing packet buffer: packets are encoded in place and flushed to the socket
+#[derive(Clone)]
+struct MqttWriter {
+    socket: WebSocket,
+    buf: Rc<RefCell<BytesMut>>,
+    version: ProtocolVersion,
+}
 
-        if data.len() < header_end + remaining_length {
-            return None; // Incomplete packet
+impl MqttWriter {
+    fn new(socket: WebSocket, version: ProtocolVersion) -> Self {
+        Self {
+            socket,
+            buf: Rc::new(RefCell::new(BytesMut::with_capacity(4 * 1024))),
+            version,
         }
-
-        // Extract packet identifier (2 bytes)
-        let packet_id = ((data[header_end] as u16) << 8) | (data[header_end + 1] as u16);
-
-        // Extract return codes (remaining bytes)
-        let return_codes = data[header_end + 2..header_end + remaining_length].to_vec();
-
-        Some((packet_id, return_codes))
     }
 
-    /// Parse MQTT CONNACK packet to check connection acknowledgment
-    fn parse_connack_packet(data: &[u8]) -> Option<u8> {
-        if data.len() < 2 || (data[0] & 0xF0) != 0x20 {
-            return None; // Not a CONNACK packet
-        }
-
-        let (remaining_length, length_bytes) = Self::decode_remaining_length(data, 1)?;
-        let header_end = 1 + length_bytes;
-
-        if data.len() < header_end + remaining_length || remaining_length < 2 {
-            return None; // Incomplete packet or invalid length
-        }
-
-        // Return code is in the second byte of variable header
-        Some(data[header_end + 1])
+    /// Encode one packet into the shared buffer and send it as a single binary frame
+    fn send(
+        &self,
+        encode: impl FnOnce(&mut BytesMut, ProtocolVersion) -> Result<(), CodecError>,
+    ) -> Result<usize, String> {
+        let mut buf = self.buf.borrow_mut();
+        buf.clear();
+        encode(&mut *buf, self.version).map_err(|e| e.to_string())?;
+        self.socket
+            .send_with_u8_array(&buf[..])
+            .map_err(|e| format!("{:?}", e))?;
+        Ok(buf.len())
     }
 
-    /// Create MQTT CONNECT packet
-    fn connect_packet(client_id: &str) -> Vec<u8> {
-        let mut packet = Vec::new();
-
-        // Fixed header: CONNECT (0x10)
-        packet.push(0x10);
-
-        let mut variable_header = Vec::new();
-
-        // Protocol name "MQTT"
-        variable_header.extend_from_slice(&[0x00, 0x04]); // Length
-        variable_header.extend_from_slice(b"MQTT");
-
-        // Protocol level (4 for MQTT 3.1.1)
-        variable_header.push(0x04);
-
-        // Connect flags (clean session = 1)
-        variable_header.push(0x02);
-
-        // Keep alive (60 seconds)
-        variable_header.extend_from_slice(&[0x00, 0x3C]);
-
-        // Payload: Client ID
-        let client_id_bytes = client_id.as_bytes();
-        variable_header.extend_from_slice(&[
-            (client_id_bytes.len() >> 8) as u8,
-            (client_id_bytes.len() & 0xFF) as u8,
-        ]);
-        variable_header.extend_from_slice(client_id_bytes);
-
-        // Add proper variable length encoding for remaining length
-        let remaining_length_bytes = Self::encode_remaining_length(variable_header.len());
-        packet.extend_from_slice(&remaining_length_bytes);
-
-        packet.extend_from_slice(&variable_header);
-        packet
-    }
-
-    /// Create MQTT SUBSCRIBE packet
-    fn subscribe_packet(topic: &str, packet_id: u16) -> Vec<u8> {
-        let mut packet = Vec::new();
-
-        // Fixed header: SUBSCRIBE (0x82)
-        packet.push(0x82);
-
-        let mut variable_header = Vec::new();
-
-        // Packet identifier
-        variable_header.extend_from_slice(&[(packet_id >> 8) as u8, (packet_id & 0xFF) as u8]);
-
-        // Payload: Topic filter
-        let topic_bytes = topic.as_bytes();
-        variable_header.extend_from_slice(&[
-            (topic_bytes.len() >> 8) as u8,
-            (topic_bytes.len() & 0xFF) as u8,
-        ]);
-        variable_header.extend_from_slice(topic_bytes);
-
-        // QoS level (0)
-        variable_header.push(0x00);
-
-        // Add proper variable length encoding for remaining length
-        let remaining_length_bytes = Self::encode_remaining_length(variable_header.len());
-        packet.extend_from_slice(&remaining_length_bytes);
-
-        packet.extend_from_slice(&variable_header);
-        packet
+    fn subscribe(&self, topic: &str, packet_id: u16, qos: QoS) -> Result<usize, String> {
+        self.send(|buf, version| codec::encode_subscribe(buf, version, topic, packet_id, qos))
     }
 
-    /// Create MQTT PUBLISH packet
-    fn publish_packet(topic: &str, payload: &[u8]) -> Vec<u8> {
-        let mut packet = Vec::new();
-
-        // Fixed header: PUBLISH (0x30) - no retain flag
-        packet.push(0x30);
-
-        let mut variable_header = Vec::new();
-
-        // Topic name
-        let topic_bytes = topic.as_bytes();
-        variable_header.extend_from_slice(&[
-            (topic_bytes.len() >> 8) as u8,
-            (topic_bytes.len() & 0xFF) as u8,
-        ]);
-        variable_header.extend_from_slice(topic_bytes);
-
-        // Payload
-        variable_header.extend_from_slice(payload);
-
-        // Add proper variable length encoding for remaining length
-        let remaining_length_bytes = Self::encode_remaining_length(variable_header.len());
-        packet.extend_from_slice(&remaining_length_bytes);
-
-        packet.extend_from_slice(&variable_header);
-        packet
+    fn publish(&self, topic: &str, payload: &[u8], retain: bool) -> Result<usize, String> {
+        self.send(|buf, version| {
+            codec::encode_publish(buf, version, topic, payload, QoS::AtMostOnce, retain, 0)
+        })
     }
 
-    /// Create MQTT PUBLISH packet with retain flag
-    fn publish_packet_retained(topic: &str, payload: &[u8]) -> Vec<u8> {
-        let mut packet = Vec::new();
-
-        // Fixed header: PUBLISH (0x31) - with retain flag set
-        packet.push(0x31);
-
-        let mut variable_header = Vec::new();
-
-        // Topic name
-        let topic_bytes = topic.as_bytes();
-        variable_header.extend_from_slice(&[
-            (topic_bytes.len() >> 8) as u8,
-            (topic_bytes.len() & 0xFF) as u8,
-        ]);
-        variable_header.extend_from_slice(topic_bytes);
-
-        // Payload
-        variable_header.extend_from_slice(payload);
-
-        // Add proper variable length encoding for remaining length
-        let remaining_length_bytes = Self::encode_remaining_length(variable_header.len());
-        packet.extend_from_slice(&remaining_length_bytes);
-
-        packet.extend_from_slice(&variable_header);
-        packet
+    fn puback(&self, packet_id: u16) -> Result<usize, String> {
+        self.send(|buf, _| {
+            codec::encode_puback(buf, packet_id);
+            Ok(())
+        })
     }
+}
 
-    /// Parse MQTT PUBLISH packet
-    fn parse_publish_packet(data: &[u8]) -> Option<(String, Vec<u8>)> {
-        if data.len() < 2 || (data[0] & 0xF0) != 0x30 {
-            return None; // Not a PUBLISH packet
-        }
-
-        let (remaining_length, length_bytes) = Self::decode_remaining_length(data, 1)?;
-        let header_end = 1 + length_bytes;
-
-        if data.len() < header_end + remaining_length {
-            return None; // Incomplete packet
-        }
-
-        let mut offset = header_end;
-
-        // Topic length (2 bytes)
-        if offset + 2 > data.len() {
-            return None;
+/// Browser benchmark of MQTT decode throughput.
+///
+/// Builds `packets` PUBLISH packets of `payload_size` bytes, splits the stream into
+/// 16 KiB WebSocket-sized frames and decodes it through `MqttCodec`. Call from the
+/// browser console after the module is loaded, e.g. `bench_mqtt_decode(100000, 256)`.
+/// Returns throughput in MB/s and logs packets/s.
+#[wasm_bindgen]
+pub fn bench_mqtt_decode(packets: u32, payload_size: u32) -> f64 {
+    const FRAME_SIZE: usize = 16 * 1024;
+
+    let payload = vec![b'x'; payload_size as usize];
+    let mut stream = BytesMut::new();
+    for i in 0..packets {
+        let topic = format!("iotcraft/worlds/bench/players/player-{}/pose", i % 64);
+        if codec::encode_publish(
+            &mut stream,
+            ProtocolVersion::V311,
+            &topic,
+            &payload,
+            QoS::AtMostOnce,
+            false,
+            0,
+        )
+        .is_err()
+        {
+            return 0.0;
         }
-        let topic_length = ((data[offset] as usize) << 8) | (data[offset + 1] as usize);
-        offset += 2;
+    }
 
-        // Topic name
-        if offset + topic_length > data.len() {
-            return None;
-        }
-        let topic = String::from_utf8_lossy(&data[offset..offset + topic_length]).to_string();
-        offset += topic_length;
+    let performance = web_sys::window().and_then(|w| w.performance());
+    let now = || {
+        performance
+            .as_ref()
+            .map(|p| p.now())
+            .unwrap_or_else(js_sys::Date::now)
+    };
 
-        // Payload (rest of the packet within remaining length)
-        let payload_end = header_end + remaining_length;
-        if offset > payload_end {
-            return None;
+    let mut mqtt_codec = MqttCodec::new(ProtocolVersion::V311);
+    let mut decoded = 0u32;
+    let mut payload_bytes = 0usize;
+    let start = now();
+    for frame in stream.chunks(FRAME_SIZE) {
+        mqtt_codec.push_frame(frame);
+        while let Ok(Some(packet)) = mqtt_codec.next_packet() {
+            if let Packet::Publish(publish) = packet {
+                decoded += 1;
+                payload_bytes += publish.topic.len() + publish.payload.len();
+            }
         }
-        let payload = data[offset..payload_end].to_vec();
-
-        Some((topic, payload))
     }
+    let elapsed_ms = (now() - start).max(0.001);
+
+    let mb_per_sec = (stream.len() as f64 / 1_000_000.0) / (elapsed_ms / 1000.0);
+    let packets_per_sec = decoded as f64 / (elapsed_ms / 1000.0);
+    web_sys::console::log_1(
+        &format!(
+            "📊 MQTT decode: {} packets ({} payload bytes, {} stream bytes) in {:.2} ms — {:.0} packets/s, {:.1} MB/s",
+            decoded,
+            payload_bytes,
+            stream.len(),
+            elapsed_ms,
+            packets_per_sec,
+            mb_per_sec
+        )
+        .into(),
+    );
+    mb_per_sec
 }
 
 /// Simplified device announcement receiver for web WASM
@@ -357,6 +222,10 @@ pub struct WorldPublishSender(pub Mutex<mpsc::Sender<PublishWorldEvent>>);
 #[derive(Resource)]
 pub struct WorldDataReceiver(pub Mutex<mpsc::Receiver<(String, crate::world::WorldSaveData)>>);
 
+/// Resource for receiving chunk meshes built by the world decode worker
+#[derive(Resource)]
+pub struct PrebuiltMeshReceiver(pub Mutex<mpsc::Receiver<(String, Vec<ChunkMeshData>)>>);
+
 /// Global WebSocket reference for publishing messages - Not used as Resource for thread safety
 pub struct WebSocketSender(pub Rc<RefCell<Option<WebSocket>>>);
 
@@ -383,6 +252,7 @@ pub fn spawn_web_mqtt_subscriber(
     let (world_discovery_tx, world_discovery_rx) = mpsc::channel::<SharedWorldInfo>();
     let (world_publish_tx, world_publish_rx) = mpsc::channel::<PublishWorldEvent>();
     let (world_data_tx, world_data_rx) = mpsc::channel::<(String, crate::world::WorldSaveData)>();
+    let (mesh_tx, mesh_rx) = mpsc::channel::<(String, Vec<ChunkMeshData>)>();
 
     commands.insert_resource(TemperatureReceiver(Mutex::new(temp_rx)));
     commands.insert_resource(DeviceAnnouncementReceiver(Mutex::new(device_rx)));
@@ -391,6 +261,7 @@ pub fn spawn_web_mqtt_subscriber(
     commands.insert_resource(WorldDiscoveryReceiver(Mutex::new(world_discovery_rx)));
     commands.insert_resource(WorldPublishSender(Mutex::new(world_publish_tx)));
     commands.insert_resource(WorldDataReceiver(Mutex::new(world_data_rx)));
+    commands.insert_resource(PrebuiltMeshReceiver(Mutex::new(mesh_rx)));
 
     let client_id = generate_unique_client_id("web-mqtt-client");
     let world_id = "default"; // Use default world for web client
@@ -437,176 +308,225 @@ pub fn spawn_web_mqtt_subscriber(
     let device_tx_clone = device_tx.clone();
     let pose_tx_clone = pose_tx.clone();
     let world_discovery_tx_clone = world_discovery_tx.clone();
-    let world_data_tx_clone = world_data_tx.clone();
+
+    // Decoded worlds (from the worker or the main-thread fallback) go to the world data
+    // cache; meshes prebuilt by the worker are kept for when the world is entered
+    let deliver_world = Rc::new(RefCell::new(move |decoded: DecodedWorld| {
+        info!(
+            "🌍 Web: Parsed world data for: {} ({} blocks, {} chunk meshes)",
+            decoded.world_id,
+            decoded.world_data.blocks.len(),
+            decoded.chunk_meshes.len()
+        );
+        // Sent even when empty so meshes of an older version of the world are dropped
+        let _ = mesh_tx.send((decoded.world_id.clone(), decoded.chunk_meshes));
+        if let Ok(tx) = world_data_tx.try_borrow() {
+            let _ = tx.send((decoded.world_id, decoded.world_data));
+        }
+    }));
+    let world_worker = {
+        let deliver_world = deliver_world.clone();
+        WorldDecodeWorker::spawn(move |decoded| {
+            if let Ok(mut deliver) = deliver_world.try_borrow_mut() {
+                (*deliver)(decoded);
+            }
+        })
+    };
     let subscriptions_confirmed_clone = subscriptions_confirmed.clone();
     let pose_subscription_confirmed_clone = pose_subscription_confirmed.clone();
 
+    // Shared codec: WebSocket frames are appended to one reusable buffer and complete
+    // packets are decoded in place, so packets split across frames are reassembled
+    let mqtt_codec = Rc::new(RefCell::new(MqttCodec::new(ProtocolVersion::V311)));
+    let writer = MqttWriter::new(websocket.clone(), ProtocolVersion::V311);
+    let ack_writer = writer.clone();
+
     // Message handler
     let onmessage_callback = Closure::<dyn FnMut(_)>::new(move |e: MessageEvent| {
-        if let Ok(array_buffer) = e.data().dyn_into::<js_sys::ArrayBuffer>() {
-            let uint8_array = Uint8Array::new(&array_buffer);
-            let data: Vec<u8> = uint8_array.to_vec();
-
-            // First check for CONNACK packet
-            if let Some(return_code) = SimpleMqttPackets::parse_connack_packet(&data) {
-                if return_code == 0 {
-                    info!("MQTT Web: Connection acknowledged successfully");
-                } else {
-                    error!(
-                        "MQTT Web: Connection failed with return code: {}",
-                        return_code
-                    );
-                }
-                return;
-            }
-
-            // Then check for SUBACK packet
-            if let Some((packet_id, return_codes)) = SimpleMqttPackets::parse_suback_packet(&data) {
-                info!(
-                    "MQTT Web: Subscription acknowledged for packet ID: {}, return codes: {:?}",
-                    packet_id, return_codes
-                );
-
-                // Check if subscription was successful (return code 0x00 or 0x01 for QoS 0/1)
-                if return_codes.iter().all(|&code| code <= 0x01) {
-                    if let Ok(mut confirmed) = subscriptions_confirmed_clone.try_borrow_mut() {
-                        *confirmed += 1;
-                        info!("MQTT Web: Subscriptions confirmed: {}/5", *confirmed);
+        let Ok(array_buffer) = e.data().dyn_into::<js_sys::ArrayBuffer>() else {
+            return;
+        };
+        let Ok(mut mqtt_codec) = mqtt_codec.try_borrow_mut() else {
+            return;
+        };
+        let uint8_array = Uint8Array::new(&array_buffer);
+        mqtt_codec.push_with(uint8_array.length() as usize, |dst| {
+            uint8_array.copy_to(dst)
+        });
 
-                        // Special handling for specific subscriptions
-                        if packet_id == 5 {
-                            if let Ok(mut pose_confirmed) =
-                                pose_subscription_confirmed_clone.try_borrow_mut()
-                            {
-                                *pose_confirmed = true;
-                            }
-                            info!(
-                                "🎉 MQTT Web: Pose subscription confirmed! Pose publishing enabled."
-                            );
-                            web_sys::console::log_1(
-                                &"🎉 Pose subscription confirmed! Multiplayer enabled.".into(),
-                            );
-                        } else if packet_id == 4 {
-                            info!(
-                                "🌍 MQTT Web: World discovery subscription confirmed! World discovery enabled."
-                            );
-                        } else if packet_id == 3 {
-                            info!(
-                                "🌍 MQTT Web: World data subscription confirmed! World loading enabled."
-                            );
-                        }
+        loop {
+            let packet = match mqtt_codec.next_packet() {
+                Ok(Some(packet)) => packet,
+                Ok(None) => break,
+                Err(e) => {
+                    error!("MQTT Web: Failed to decode packet: {}", e);
+                    continue;
+                }
+            };
 
-                        if *confirmed == 5 {
-                            info!("🎉 MQTT Web: All subscriptions confirmed!");
-                        }
+            match packet {
+                Packet::ConnAck { return_code, .. } => {
+                    if return_code == 0 {
+                        info!("MQTT Web: Connection acknowledged successfully");
+                    } else {
+                        error!(
+                            "MQTT Web: Connection failed with return code: {}",
+                            return_code
+                        );
                     }
-                } else {
-                    error!(
-                        "MQTT Web: Subscription failed for packet ID: {}, return codes: {:?}",
+                }
+                Packet::SubAck {
+                    packet_id,
+                    return_codes,
+                } => {
+                    info!(
+                        "MQTT Web: Subscription acknowledged for packet ID: {}, return codes: {:?}",
                         packet_id, return_codes
                     );
-                }
-                return;
-            }
 
-            // Finally check for PUBLISH packets
-            if let Some((topic, payload)) = SimpleMqttPackets::parse_publish_packet(&data) {
-                info!("MQTT Web: Received message on topic: {}", topic);
-
-                if topic.starts_with("iotcraft/worlds/") && topic.ends_with("/info") {
-                    // Handle world discovery messages
-                    if let Ok(world_info_str) = String::from_utf8(payload) {
-                        if !world_info_str.is_empty() {
-                            info!("🌍 Web: Received world info on topic: {}", topic);
-                            if let Ok(world_info) =
-                                serde_json::from_str::<SharedWorldInfo>(&world_info_str)
-                            {
+                    // Check if subscription was successful (return code 0x00 or 0x01 for QoS 0/1)
+                    if return_codes.iter().all(|&code| code <= 0x01) {
+                        if let Ok(mut confirmed) = subscriptions_confirmed_clone.try_borrow_mut() {
+                            *confirmed += 1;
+                            info!("MQTT Web: Subscriptions confirmed: {}/5", *confirmed);
+
+                            // Special handling for specific subscriptions
+                            if packet_id == 5 {
+                                if let Ok(mut pose_confirmed) =
+                                    pose_subscription_confirmed_clone.try_borrow_mut()
+                                {
+                                    *pose_confirmed = true;
+                                }
                                 info!(
-                                    "🌍 Web: Discovered world: {} ({})",
-                                    world_info.world_name, world_info.world_id
+                                    "🎉 MQTT Web: Pose subscription confirmed! Pose publishing enabled."
                                 );
-                                if let Ok(tx) = world_discovery_tx_clone.try_borrow() {
-                                    let _ = tx.send(world_info);
-                                }
-                            } else {
-                                error!(
-                                    "🌍 Web: Failed to parse world info JSON: {}",
-                                    world_info_str
+                                web_sys::console::log_1(
+                                    &"🎉 Pose subscription confirmed! Multiplayer enabled.".into(),
+                                );
+                            } else if packet_id == 4 {
+                                info!(
+                                    "🌍 MQTT Web: World discovery subscription confirmed! World discovery enabled."
+                                );
+                            } else if packet_id == 3 {
+                                info!(
+                                    "🌍 MQTT Web: World data subscription confirmed! World loading enabled."
                                 );
                             }
-                        } else {
-                            info!("🌍 Web: Empty world info (world unpublished): {}", topic);
+
+                            if *confirmed == 5 {
+                                info!("🎉 MQTT Web: All subscriptions confirmed!");
+                            }
+                        }
+                    } else {
+                        error!(
+                            "MQTT Web: Subscription failed for packet ID: {}, return codes: {:?}",
+                            packet_id, return_codes
+                        );
+                    }
+                }
+                Packet::Publish(publish) => {
+                    // Acknowledge QoS 1 deliveries (world info/data are subscribed at QoS 1)
+                    if let Some(packet_id) = publish.puback_id() {
+                        if let Err(e) = ack_writer.puback(packet_id) {
+                            error!("MQTT Web: Failed to send PUBACK {}: {}", packet_id, e);
                         }
                     }
-                } else if topic.starts_with("iotcraft/worlds/") && topic.ends_with("/data") {
-                    // Handle world data messages (complete world save data)
-                    if let Ok(world_data_str) = String::from_utf8(payload) {
-                        if !world_data_str.is_empty() {
-                            info!("🌍 Web: Received world data on topic: {}", topic);
-                            // Extract world ID from topic (iotcraft/worlds/{world_id}/data)
-                            let topic_parts: Vec<&str> = topic.split('/').collect();
-                            if topic_parts.len() >= 3 {
-                                let world_id = topic_parts[2].to_string();
-                                if let Ok(world_data) =
-                                    serde_json::from_str::<crate::world::WorldSaveData>(
-                                        &world_data_str,
-                                    )
+
+                    let topic = publish.topic;
+                    let payload = publish.payload;
+                    info!("MQTT Web: Received message on topic: {}", topic);
+
+                    if topic.starts_with("iotcraft/worlds/") && topic.ends_with("/info") {
+                        // Handle world discovery messages
+                        if let Ok(world_info_str) = std::str::from_utf8(payload) {
+                            if !world_info_str.is_empty() {
+                                info!("🌍 Web: Received world info on topic: {}", topic);
+                                if let Ok(world_info) =
+                                    serde_json::from_str::<SharedWorldInfo>(world_info_str)
                                 {
                                     info!(
-                                        "🌍 Web: Parsed world data for: {} ({} blocks)",
-                                        world_id,
-                                        world_data.blocks.len()
+                                        "🌍 Web: Discovered world: {} ({})",
+                                        world_info.world_name, world_info.world_id
                                     );
-                                    if let Ok(tx) = world_data_tx_clone.try_borrow() {
-                                        let _ = tx.send((world_id, world_data));
+                                    if let Ok(tx) = world_discovery_tx_clone.try_borrow() {
+                                        let _ = tx.send(world_info);
                                     }
                                 } else {
                                     error!(
-                                        "🌍 Web: Failed to parse world data JSON for: {}",
-                                        world_id
+                                        "🌍 Web: Failed to parse world info JSON: {}",
+                                        world_info_str
                                     );
                                 }
+                            } else {
+                                info!("🌍 Web: Empty world info (world unpublished): {}", topic);
                             }
-                        } else {
+                        }
+                    } else if topic.starts_with("iotcraft/worlds/") && topic.ends_with("/data") {
+                        // Handle world data messages (complete world save data). Decoding
+                        // is handed to the world worker so large worlds do not stall the page.
+                        if payload.is_empty() {
                             info!("🌍 Web: Empty world data (world removed): {}", topic);
+                        } else if let Some(world_id) = topic.split('/').nth(2) {
+                            info!("🌍 Web: Received world data on topic: {}", topic);
+                            let queued = world_worker
+                                .as_ref()
+                                .is_some_and(|worker| worker.decode(world_id, payload).is_ok());
+                            if !queued {
+                                match web_worker::decode_world_blocking(
+                                    world_id.to_string(),
+                                    payload,
+                                ) {
+                                    Ok(decoded) => {
+                                        if let Ok(mut deliver) = deliver_world.try_borrow_mut() {
+                                            (*deliver)(decoded);
+                                        }
+                                    }
+                                    Err(e) => error!("🌍 Web: {} ({})", e, world_id),
+                                }
+                            }
                         }
-                    }
-                } else if topic.starts_with("iotcraft/worlds/") && topic.contains("/pose") {
-                    // Handle multiplayer pose messages
-                    if let Ok(pose_str) = String::from_utf8(payload) {
-                        if let Ok(pose_msg) = serde_json::from_str::<PoseMessage>(&pose_str) {
-                            let player_name = pose_msg.player_name.clone();
-                            if let Ok(tx) = pose_tx_clone.try_borrow() {
-                                let _ = tx.send(pose_msg);
-                                info!("📡 Web: Received pose from player {}", player_name);
+                    } else if topic.starts_with("iotcraft/worlds/") && topic.contains("/pose") {
+                        // Handle multiplayer pose messages
+                        if let Ok(pose_str) = std::str::from_utf8(payload) {
+                            if let Ok(pose_msg) = serde_json::from_str::<PoseMessage>(pose_str) {
+                                let player_name = pose_msg.player_name.clone();
+                                if let Ok(tx) = pose_tx_clone.try_borrow() {
+                                    let _ = tx.send(pose_msg);
+                                    info!("📡 Web: Received pose from player {}", player_name);
+                                }
                             }
                         }
-                    }
-                } else {
-                    match topic.as_str() {
-                        "home/sensor/temperature" => {
-                            if let Ok(temp_str) = String::from_utf8(payload) {
-                                if let Ok(temp_val) = temp_str.parse::<f32>() {
-                                    if let Ok(tx) = temp_tx_clone.try_borrow() {
-                                        let _ = tx.send(temp_val);
+                    } else {
+                        match topic {
+                            "home/sensor/temperature" => {
+                                if let Ok(temp_str) = std::str::from_utf8(payload) {
+                                    if let Ok(temp_val) = temp_str.parse::<f32>() {
+                                        if let Ok(tx) = temp_tx_clone.try_borrow() {
+                                            let _ = tx.send(temp_val);
+                                        }
                                     }
                                 }
                             }
-                        }
-                        "devices/announce" => {
-                            if let Ok(device_msg) = String::from_utf8(payload) {
-                                if let Ok(tx) = device_tx_clone.try_borrow() {
-                                    let _ = tx.send(device_msg);
+                            "devices/announce" => {
+                                if let Ok(device_msg) = std::str::from_utf8(payload) {
+                                    if let Ok(tx) = device_tx_clone.try_borrow() {
+                                        let _ = tx.send(device_msg.to_string());
+                                    }
                                 }
                             }
-                        }
-                        _ => {
-                            info!("MQTT Web: Unhandled topic: {}", topic);
+                            _ => {
+                                info!("MQTT Web: Unhandled topic: {}", topic);
+                            }
                         }
                     }
                 }
+                _ => {}
             }
         }
+
+        // A world snapshot grows the read buffer to megabytes; give that back once idle
+        mqtt_codec.shrink_if_idle(crate::wasm_limits::MAX_IDLE_READ_BUFFER_BYTES);
+        crate::memory_governor::record_mqtt_read_buffer(mqtt_codec.capacity());
     });
 
     websocket.set_onmessage(Some(onmessage_callback.as_ref().unchecked_ref()));
@@ -614,7 +534,7 @@ pub fn spawn_web_mqtt_subscriber(
 
     // Connection open handler
     let client_id_clone = client_id.clone();
-    let websocket_clone = websocket.clone();
+    let writer_clone = writer.clone();
     let pose_subscribe_topic_clone = pose_subscribe_topic.clone();
     let outgoing_pose_rx_clone = outgoing_pose_rx.clone();
     let world_publish_rx_clone = world_publish_rx.clone();
@@ -626,23 +546,21 @@ pub fn spawn_web_mqtt_subscriber(
         info!("MQTT Web: Client ID: {}", client_id_clone);
 
         // Send CONNECT packet
-        let connect_packet = SimpleMqttPackets::connect_packet(&client_id_clone);
-        info!(
-            "MQTT Web: Sending CONNECT packet for client ID: {}, packet size: {} bytes",
-            client_id_clone,
-            connect_packet.len()
-        );
-        web_sys::console::log_1(&format!("MQTT CONNECT packet: {:?}", connect_packet).into());
-
-        if let Err(e) = websocket_clone.send_with_u8_array(&connect_packet) {
-            error!("MQTT Web: Failed to send CONNECT packet: {:?}", e);
-            return;
-        } else {
-            info!("MQTT Web: CONNECT packet sent successfully");
+        match writer_clone
+            .send(|buf, version| codec::encode_connect(buf, version, &client_id_clone, 60))
+        {
+            Ok(size) => info!(
+                "MQTT Web: CONNECT packet sent for client ID: {}, packet size: {} bytes",
+                client_id_clone, size
+            ),
+            Err(e) => {
+                error!("MQTT Web: Failed to send CONNECT packet: {}", e);
+                return;
+            }
         }
 
         // Send SUBSCRIBE packets after a short delay to allow CONNECT to process
-        let websocket_clone2 = websocket_clone.clone();
+        let writer_clone2 = writer_clone.clone();
         let pose_topic_clone2 = pose_subscribe_topic_clone.clone();
         let outgoing_rx_clone2 = outgoing_pose_rx_clone.clone();
         let world_publish_rx_clone2 = world_publish_rx_clone.clone();
@@ -654,26 +572,23 @@ pub fn spawn_web_mqtt_subscriber(
             // Strategy: Subscribe to working topics first, then publish pose to create the topic hierarchy
 
             // 1. Subscribe to temperature topic (this works)
-            let sub_temp_packet = SimpleMqttPackets::subscribe_packet("home/sensor/temperature", 1);
-            if let Err(e) = websocket_clone2.send_with_u8_array(&sub_temp_packet) {
+            if let Err(e) = writer_clone2.subscribe("home/sensor/temperature", 1, QoS::AtMostOnce) {
                 error!(
-                    "MQTT Web: Failed to send temperature SUBSCRIBE packet: {:?}",
+                    "MQTT Web: Failed to send temperature SUBSCRIBE packet: {}",
                     e
                 );
             }
 
             // 2. Subscribe to device announcements topic (this works)
-            let sub_device_packet = SimpleMqttPackets::subscribe_packet("devices/announce", 2);
-            if let Err(e) = websocket_clone2.send_with_u8_array(&sub_device_packet) {
-                error!("MQTT Web: Failed to send device SUBSCRIBE packet: {:?}", e);
+            if let Err(e) = writer_clone2.subscribe("devices/announce", 2, QoS::AtMostOnce) {
+                error!("MQTT Web: Failed to send device SUBSCRIBE packet: {}", e);
             }
 
             // 3. Subscribe to world discovery topic (iotcraft/worlds/+/info)
-            let sub_world_discovery_packet =
-                SimpleMqttPackets::subscribe_packet("iotcraft/worlds/+/info", 4);
-            if let Err(e) = websocket_clone2.send_with_u8_array(&sub_world_discovery_packet) {
+            // World info and data are retained and must not be lost, so use QoS 1
+            if let Err(e) = writer_clone2.subscribe("iotcraft/worlds/+/info", 4, QoS::AtLeastOnce) {
                 error!(
-                    "MQTT Web: Failed to send world discovery SUBSCRIBE packet: {:?}",
+                    "MQTT Web: Failed to send world discovery SUBSCRIBE packet: {}",
                     e
                 );
             } else {
@@ -681,11 +596,9 @@ pub fn spawn_web_mqtt_subscriber(
             }
 
             // 3.1. Subscribe to world data topic (iotcraft/worlds/+/data) for world reconstruction
-            let sub_world_data_packet =
-                SimpleMqttPackets::subscribe_packet("iotcraft/worlds/+/data", 3);
-            if let Err(e) = websocket_clone2.send_with_u8_array(&sub_world_data_packet) {
+            if let Err(e) = writer_clone2.subscribe("iotcraft/worlds/+/data", 3, QoS::AtLeastOnce) {
                 error!(
-                    "MQTT Web: Failed to send world data SUBSCRIBE packet: {:?}",
+                    "MQTT Web: Failed to send world data SUBSCRIBE packet: {}",
                     e
                 );
             } else {
@@ -708,10 +621,10 @@ pub fn spawn_web_mqtt_subscriber(
             };
 
             if let Ok(pose_payload) = serde_json::to_string(&initial_pose) {
-                let publish_packet =
-                    SimpleMqttPackets::publish_packet(&publish_topic, pose_payload.as_bytes());
-                if let Err(e) = websocket_clone2.send_with_u8_array(&publish_packet) {
-                    error!("🚀 Web: Failed to publish initial pose: {:?}", e);
+                if let Err(e) =
+                    writer_clone2.publish(&publish_topic, pose_payload.as_bytes(), false)
+                {
+                    error!("🚀 Web: Failed to publish initial pose: {}", e);
                 } else {
                     info!(
                         "🚀 Web: Published initial pose to CREATE topic: {}",
@@ -721,13 +634,12 @@ pub fn spawn_web_mqtt_subscriber(
             }
 
             // Small delay to let broker process the publish
-            let websocket_delay = websocket_clone2.clone();
+            let writer_delay = writer_clone2.clone();
             let pose_topic_delay = pose_topic_clone2.clone();
             let delay_callback = Closure::<dyn FnMut()>::new(move || {
                 // 5. NOW subscribe to multiplayer poses topic (after topic exists)
-                let sub_pose_packet = SimpleMqttPackets::subscribe_packet(&pose_topic_delay, 5);
-                if let Err(e) = websocket_delay.send_with_u8_array(&sub_pose_packet) {
-                    error!("MQTT Web: Failed to send pose SUBSCRIBE packet: {:?}", e);
+                if let Err(e) = writer_delay.subscribe(&pose_topic_delay, 5, QoS::AtMostOnce) {
+                    error!("MQTT Web: Failed to send pose SUBSCRIBE packet: {}", e);
                 } else {
                     info!(
                         "🌐 Web: NOW subscribed to multiplayer poses: {}",
@@ -748,12 +660,17 @@ pub fn spawn_web_mqtt_subscriber(
             info!("MQTT Web: Sent all SUBSCRIBE packets, waiting for confirmations...");
 
             // Set up delayed pose publishing - wait for subscriptions to be confirmed
-            let websocket_pub = websocket_clone2.clone();
+            let writer_pub = writer_clone2.clone();
             let outgoing_rx_pub = outgoing_rx_clone2.clone();
             let world_publish_rx_pub = world_publish_rx_clone2.clone();
             let player_id_pub = player_id_clone2.clone();
-            let world_id_pub = world_id_clone2.clone();
             let subs_confirmed_pub = subscriptions_confirmed_clone2.clone();
+            let pose_topic_pub = format!(
+                "iotcraft/worlds/{}/players/{}/pose",
+                world_id_clone2, player_id_pub
+            );
+            // Serialized pose JSON is written into one reused buffer
+            let mut pose_payload_buf: Vec<u8> = Vec::with_capacity(256);
 
             let publish_callback = Closure::<dyn FnMut()>::new(move || {
                 // Check subscription status and log it
@@ -814,18 +731,14 @@ pub fn spawn_web_mqtt_subscriber(
 
                         if let Ok(payload) = serde_json::to_string(&world_info) {
                             // Use retained publish for world info
-                            let publish_packet = SimpleMqttPackets::publish_packet_retained(
-                                &topic,
-                                payload.as_bytes(),
-                            );
                             info!(
                                 "🌍 Web: Publishing world info to topic '{}' with retain=true",
                                 topic
                             );
                             info!("🌍 Web: World payload: {}", payload);
 
-                            if let Err(e) = websocket_pub.send_with_u8_array(&publish_packet) {
-                                error!("🌍 Web: Failed to publish world info: {:?}", e);
+                            if let Err(e) = writer_pub.publish(&topic, payload.as_bytes(), true) {
+                                error!("🌍 Web: Failed to publish world info: {}", e);
                             } else {
                                 info!(
                                     "🌍 Web: Successfully published world '{}' with ID: {}",
@@ -841,16 +754,17 @@ pub fn spawn_web_mqtt_subscriber(
                 // Check for outgoing pose messages
                 if let Ok(rx) = outgoing_rx_pub.try_borrow() {
                     while let Ok(pose_msg) = rx.try_recv() {
-                        let topic = format!(
-                            "iotcraft/worlds/{}/players/{}/pose",
-                            world_id_pub, player_id_pub
-                        );
-                        if let Ok(payload) = serde_json::to_string(&pose_msg) {
-                            let publish_packet =
-                                SimpleMqttPackets::publish_packet(&topic, payload.as_bytes());
-                            info!("📡 Web: Publishing pose to topic '{}': {}", topic, payload);
-                            if let Err(e) = websocket_pub.send_with_u8_array(&publish_packet) {
-                                error!("📡 Web: Failed to publish pose: {:?}", e);
+                        pose_payload_buf.clear();
+                        if serde_json::to_writer(&mut pose_payload_buf, &pose_msg).is_ok() {
+                            info!(
+                                "📡 Web: Publishing pose to topic '{}' ({} bytes)",
+                                pose_topic_pub,
+                                pose_payload_buf.len()
+                            );
+                            if let Err(e) =
+                                writer_pub.publish(&pose_topic_pub, &pose_payload_buf, false)
+                            {
+                                error!("📡 Web: Failed to publish pose: {}", e);
                             } else {
                                 info!(
                                     "📡 Web: Successfully sent pose packet for player {}",
@@ -988,6 +902,25 @@ pub fn update_world_data_cache(
     }
 }
 
+/// Move chunk meshes built by the world decode worker into [`PrebuiltChunkMeshes`]
+pub fn update_prebuilt_chunk_meshes(
+    mut prebuilt_meshes: ResMut<PrebuiltChunkMeshes>,
+    mesh_receiver: Option<Res<PrebuiltMeshReceiver>>,
+) {
+    let Some(receiver) = mesh_receiver else {
+        return;
+    };
+    if let Ok(rx) = receiver.0.lock() {
+        while let Ok((world_id, chunk_meshes)) = rx.try_recv() {
+            if chunk_meshes.is_empty() {
+                prebuilt_meshes.worlds.remove(&world_id);
+            } else {
+                prebuilt_meshes.worlds.insert(world_id, chunk_meshes);
+            }
+        }
+    }
+}
+
 /// Handle world publishing events for WASM
 pub fn handle_world_publishing(
     mut publish_events: EventReader<PublishWorldEvent>,
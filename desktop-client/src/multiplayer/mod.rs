@@ -217,6 +217,7 @@ fn apply_remote_poses(
 
     // Process all available messages
     while let Ok(msg) = rx.try_recv() {
+        crate::mqtt::core_service::MqttQueue::Poses.dequeued();
         // Ignore our own messages
         if msg.player_id == profile.player_id {
             continue;
@@ -348,8 +348,7 @@ mod tests {
         // Add asset resources for block rendering
         world.insert_resource(Assets::<Mesh>::default());
         world.insert_resource(Assets::<StandardMaterial>::default());
-        // Create a minimal asset server for testing - skip for now due to complexity
-        // world.insert_resource(AssetServer::new(...));
+        world.insert_resource(crate::shared_materials::SharedBlockMaterials::default());
 
         // Set up WorldPublisher
         let (mqtt_tx, mqtt_rx) = mpsc::channel();
@@ -371,10 +370,13 @@ mod tests {
         });
         drop(place_events);
 
-        // Step 2: Run place_block_system (updates VoxelWorld and inventory)
+        // Step 2: Run place_block_system (updates inventory and queues the VoxelWorld edit)
         let mut place_system = IntoSystem::into_system(place_block_system);
         place_system.initialize(&mut world);
         let _ = place_system.run((), &mut world);
+        let mut apply_system = IntoSystem::into_system(crate::environment::apply_voxel_edits);
+        apply_system.initialize(&mut world);
+        let _ = apply_system.run((), &mut world);
 
         // Step 3: Run multiplayer sync system (emits BlockChangeEvent)
         let mut sync_system = IntoSystem::into_system(place_block_multiplayer_sync_system);
@@ -392,7 +394,7 @@ mod tests {
         let voxel_world = world.resource::<VoxelWorld>();
         assert!(voxel_world.is_block_at(IVec3::new(100, 200, 300)));
         assert_eq!(
-            voxel_world.blocks.get(&IVec3::new(100, 200, 300)),
+            voxel_world.blocks().get(&IVec3::new(100, 200, 300)),
             Some(&BlockType::Grass)
         );
 
@@ -4,8 +4,10 @@
 //! creates/removes visual block entities accordingly. This is the missing piece that
 //! makes real-time block placement/removal visible to other players.
 
-use crate::environment::{CUBE_SIZE, VoxelBlock, VoxelWorld};
+use crate::environment::{VoxelBlock, VoxelEdits};
 use crate::multiplayer::{BlockChangeEvent, BlockChangeSource, BlockChangeType};
+use crate::shared_materials::SharedBlockMaterials;
+use bevy::ecs::system::Deferred;
 use bevy::prelude::*;
 
 /// System to handle remote block changes from other players
@@ -13,10 +15,8 @@ use bevy::prelude::*;
 pub fn handle_remote_block_changes(
     mut commands: Commands,
     mut block_change_events: EventReader<BlockChangeEvent>,
-    mut voxel_world: ResMut<VoxelWorld>,
-    mut meshes: ResMut<Assets<Mesh>>,
-    mut materials: ResMut<Assets<StandardMaterial>>,
-    asset_server: Res<AssetServer>,
+    mut voxel_edits: Deferred<VoxelEdits>,
+    shared_materials: Res<SharedBlockMaterials>,
     existing_blocks: Query<(Entity, &VoxelBlock)>,
 ) {
     for event in block_change_events.read() {
@@ -43,42 +43,16 @@ pub fn handle_remote_block_changes(
             } => {
                 let position = IVec3::new(*x, *y, *z);
 
-                // Add block to voxel world data
-                voxel_world.set_block(position, *block_type);
+                // Queue the voxel world update for apply_voxel_edits
+                voxel_edits.place(position, *block_type);
 
-                // Create visual representation
-                let cube_mesh = meshes.add(Cuboid::new(CUBE_SIZE, CUBE_SIZE, CUBE_SIZE));
-
-                let material = match block_type {
-                    crate::environment::BlockType::Water => materials.add(StandardMaterial {
-                        base_color: Color::srgba(0.0, 0.35, 0.9, 0.6),
-                        alpha_mode: AlphaMode::Blend,
-                        ..default()
-                    }),
-                    _ => {
-                        let texture_path = match block_type {
-                            crate::environment::BlockType::Grass => "textures/grass.webp",
-                            crate::environment::BlockType::Dirt => "textures/dirt.webp",
-                            crate::environment::BlockType::Stone => "textures/stone.webp",
-                            crate::environment::BlockType::QuartzBlock => {
-                                "textures/quartz_block.webp"
-                            }
-                            crate::environment::BlockType::GlassPane => "textures/glass_pane.webp",
-                            crate::environment::BlockType::CyanTerracotta => {
-                                "textures/cyan_terracotta.webp"
-                            }
-                            _ => "textures/dirt.webp", // fallback
-                        };
-                        let texture = asset_server.load(texture_path);
-                        materials.add(StandardMaterial {
-                            base_color_texture: Some(texture),
-                            ..default()
-                        })
-                    }
-                };
+                // Create visual representation with the shared cube mesh and material
+                let material = shared_materials
+                    .get_material(*block_type)
+                    .unwrap_or_default();
 
                 commands.spawn((
-                    Mesh3d(cube_mesh),
+                    Mesh3d(shared_materials.shared_mesh.clone()),
                     MeshMaterial3d(material),
                     Transform::from_translation(Vec3::new(*x as f32, *y as f32, *z as f32)),
                     VoxelBlock { position },
@@ -93,8 +67,8 @@ pub fn handle_remote_block_changes(
             BlockChangeType::Removed { x, y, z } => {
                 let position = IVec3::new(*x, *y, *z);
 
-                // Remove from voxel world data
-                voxel_world.remove_block(&position);
+                // Queue the removal for apply_voxel_edits
+                voxel_edits.remove(position);
 
                 // Remove visual representation by finding the entity at this position
                 for (entity, block) in existing_blocks.iter() {
@@ -91,8 +91,13 @@ pub struct OnlineWorlds {
     pub worlds: HashMap<String, SharedWorldInfo>,
     pub world_data_cache: HashMap<String, crate::world::WorldSaveData>,
     pub last_updated: Option<std::time::Instant>,
+    /// World whose current snapshot was requested from the broker on join, and when
+    pub pending_snapshot: Option<(String, std::time::Instant)>,
 }
 
+/// How long a join waits for the broker's snapshot before loading the retained one
+const SNAPSHOT_REQUEST_TIMEOUT: std::time::Duration = std::time::Duration::from_secs(2);
+
 /// Player position information for multiplayer status
 #[derive(Debug, Clone, Serialize, Deserialize)]
 pub struct PlayerPosition {
@@ -161,6 +166,29 @@ pub struct BlockChangeEvent {
     pub source: BlockChangeSource,
 }
 
+/// Most changes one `state/blocks/batch` message carries, keeping each message far below
+/// the broker's smallest payload limit
+pub const BLOCK_BATCH_SIZE: usize = 2048;
+
+/// A local bulk edit, broadcast as `state/blocks/batch` messages of at most
+/// [`BLOCK_BATCH_SIZE`] changes instead of one message per block
+#[derive(Event, BufferedEvent)]
+pub struct BlockChangeBatchEvent {
+    pub world_id: String,
+    pub player_id: String,
+    pub player_name: String,
+    pub changes: Vec<BlockChangeType>,
+}
+
+/// Payload of `state/blocks/batch`
+#[derive(Debug, Serialize, Deserialize)]
+pub struct BlockChangeBatchMessage {
+    pub player_id: String,
+    pub player_name: String,
+    pub timestamp: i64,
+    pub changes: Vec<BlockChangeType>,
+}
+
 #[derive(Debug, Clone)]
 pub enum BlockChangeSource {
     Local,  // Event originated from local user input
@@ -198,6 +226,7 @@ impl Plugin for SharedWorldPlugin {
             .add_event::<RefreshOnlineWorldsEvent>()
             .add_event::<WorldStateReceivedEvent>()
             .add_event::<BlockChangeEvent>()
+            .add_event::<BlockChangeBatchEvent>()
             .add_event::<PlayerMoveEvent>()
             .add_systems(
                 Update,
@@ -205,12 +234,17 @@ impl Plugin for SharedWorldPlugin {
                     handle_publish_world_events,
                     handle_unpublish_world_events,
                     handle_join_shared_world_events,
+                    expire_pending_snapshot_requests,
                     handle_leave_shared_world_events,
                     handle_world_change_events,
                     handle_refresh_online_worlds_events,
                     handle_block_change_events,
-                    crate::multiplayer::remote_block_sync::handle_remote_block_changes,
-                    handle_world_state_received_events,
+                    handle_block_change_batch_events,
+                    crate::multiplayer::remote_block_sync::handle_remote_block_changes
+                        .in_set(crate::environment::VoxelSet::Edit),
+                    handle_world_state_received_events
+                        .run_if(on_event::<WorldStateReceivedEvent>)
+                        .in_set(crate::environment::VoxelSet::Replace),
                     auto_enable_multiplayer_when_mqtt_available,
                     auto_transition_to_game_on_multiplayer_changes,
                     track_local_player_position,
@@ -271,8 +305,10 @@ fn handle_unpublish_world_events(
 fn handle_join_shared_world_events(
     mut join_events: EventReader<JoinSharedWorldEvent>,
     mut multiplayer_mode: ResMut<MultiplayerMode>,
-    online_worlds: Res<OnlineWorlds>,
+    mut online_worlds: ResMut<OnlineWorlds>,
     mut world_state_events: EventWriter<WorldStateReceivedEvent>,
+    mqtt_outgoing_tx: Option<Res<crate::mqtt::core_service::MqttOutgoingTx>>,
+    player_profile: Option<Res<crate::profile::PlayerProfile>>,
 ) {
     for event in join_events.read() {
         info!("Attempting to join shared world: {}", event.world_id);
@@ -289,8 +325,24 @@ fn handle_join_shared_world_events(
                 world_info.world_name, world_info.host_name
             );
 
-            // Check if we have cached world data and load it
-            if let Some(world_data) = online_worlds.world_data_cache.get(&event.world_id) {
+            // Ask the broker for the current world first: the retained snapshot may
+            // predate edits made since the host published it. Only brokers that advertise
+            // snapshot requests answer them.
+            let serves_snapshots = crate::mqtt::core_service::broker_serves_snapshots();
+            let requested = match (&mqtt_outgoing_tx, &player_profile) {
+                (Some(mqtt_tx), Some(profile)) if serves_snapshots => {
+                    request_world_snapshot(mqtt_tx, &event.world_id, &profile.player_id)
+                }
+                _ => false,
+            };
+            if requested {
+                info!(
+                    "Requested current snapshot of {} from the broker",
+                    event.world_id
+                );
+                online_worlds.pending_snapshot =
+                    Some((event.world_id.clone(), std::time::Instant::now()));
+            } else if let Some(world_data) = online_worlds.world_data_cache.get(&event.world_id) {
                 info!(
                     "Found cached world data for: {}, triggering load",
                     event.world_id
@@ -327,6 +379,64 @@ fn handle_join_shared_world_events(
     }
 }
 
+/// Ask the broker's world state for a snapshot; it answers on
+/// `iotcraft/worlds/{world_id}/clients/{player_id}/data`, which the core MQTT service
+/// routes like any other world data. Returns whether the request was sent.
+fn request_world_snapshot(
+    mqtt_tx: &crate::mqtt::core_service::MqttOutgoingTx,
+    world_id: &str,
+    player_id: &str,
+) -> bool {
+    let message = crate::mqtt::core_service::OutgoingMqttMessage::GenericPublish {
+        topic: format!("iotcraft/worlds/{}/snapshot/request", world_id),
+        payload: serde_json::json!({ "client_id": player_id }).to_string(),
+        qos: rumqttc::QoS::AtLeastOnce,
+        retain: false,
+    };
+    match mqtt_tx.0.lock() {
+        Ok(tx) => match tx.send(message) {
+            Ok(()) => true,
+            Err(e) => {
+                error!("❌ Failed to request world snapshot: {}", e);
+                false
+            }
+        },
+        Err(_) => false,
+    }
+}
+
+/// Fall back to the retained world snapshot when the broker does not answer a join's
+/// snapshot request, e.g. a broker without server-side world state
+fn expire_pending_snapshot_requests(
+    mut online_worlds: ResMut<OnlineWorlds>,
+    mut world_state_events: EventWriter<WorldStateReceivedEvent>,
+) {
+    let Some((world_id, requested_at)) = &online_worlds.pending_snapshot else {
+        return;
+    };
+    if requested_at.elapsed() < SNAPSHOT_REQUEST_TIMEOUT {
+        return;
+    }
+    let world_id = world_id.clone();
+    online_worlds.pending_snapshot = None;
+    match online_worlds.world_data_cache.get(&world_id) {
+        Some(world_data) => {
+            warn!(
+                "Broker did not answer the snapshot request for {}, loading the retained world data",
+                world_id
+            );
+            world_state_events.write(WorldStateReceivedEvent {
+                world_id,
+                world_data: world_data.clone(),
+            });
+        }
+        None => warn!(
+            "Broker did not answer the snapshot request for {}, waiting for MQTT data",
+            world_id
+        ),
+    }
+}
+
 fn handle_leave_shared_world_events(
     mut leave_events: EventReader<LeaveSharedWorldEvent>,
     mut multiplayer_mode: ResMut<MultiplayerMode>,
@@ -464,14 +574,77 @@ fn handle_block_change_events(
     }
 }
 
+fn handle_block_change_batch_events(
+    mut batch_events: EventReader<BlockChangeBatchEvent>,
+    mqtt_outgoing_tx: Option<Res<crate::mqtt::core_service::MqttOutgoingTx>>,
+    multiplayer_mode: Res<MultiplayerMode>,
+) {
+    for event in batch_events.read() {
+        let (MultiplayerMode::HostingWorld { world_id, .. }
+        | MultiplayerMode::JoinedWorld { world_id, .. }) = &*multiplayer_mode
+        else {
+            continue;
+        };
+        if event.world_id != *world_id {
+            warn!(
+                "⚠️  World ID mismatch: batch world {} != current world {}",
+                event.world_id, world_id
+            );
+            continue;
+        }
+        let Some(mqtt_tx) = &mqtt_outgoing_tx else {
+            error!("❌ Core MQTT Service not available for block change publishing");
+            continue;
+        };
+        let Ok(tx) = mqtt_tx.0.lock() else {
+            error!("❌ Failed to acquire MQTT outgoing channel lock");
+            continue;
+        };
+
+        let topic = format!("iotcraft/worlds/{}/state/blocks/batch", world_id);
+        let timestamp = chrono::Utc::now().timestamp_millis();
+        let mut messages = 0;
+        for changes in event.changes.chunks(BLOCK_BATCH_SIZE) {
+            let batch_message = BlockChangeBatchMessage {
+                player_id: event.player_id.clone(),
+                player_name: event.player_name.clone(),
+                timestamp,
+                changes: changes.to_vec(),
+            };
+            let Ok(payload) = serde_json::to_string(&batch_message) else {
+                error!("❌ Failed to serialize block change batch");
+                break;
+            };
+            let mqtt_msg = crate::mqtt::core_service::OutgoingMqttMessage::GenericPublish {
+                topic: topic.clone(),
+                payload,
+                qos: rumqttc::QoS::AtLeastOnce,
+                retain: false,
+            };
+            if let Err(e) = tx.send(mqtt_msg) {
+                error!(
+                    "❌ Failed to send block change batch via Core MQTT Service: {}",
+                    e
+                );
+                break;
+            }
+            messages += 1;
+        }
+        info!(
+            "✅ Sent {} block changes to {} in {} messages",
+            event.changes.len(),
+            topic,
+            messages
+        );
+    }
+}
+
 fn handle_world_state_received_events(
     mut world_state_events: EventReader<WorldStateReceivedEvent>,
     mut commands: Commands,
     mut voxel_world: ResMut<crate::environment::VoxelWorld>,
     existing_blocks_query: Query<Entity, With<crate::environment::VoxelBlock>>,
-    mut meshes: ResMut<Assets<Mesh>>,
-    mut materials: ResMut<Assets<StandardMaterial>>,
-    asset_server: Res<AssetServer>,
+    shared_materials: Res<crate::shared_materials::SharedBlockMaterials>,
     mut inventory: ResMut<crate::inventory::PlayerInventory>,
     camera_query: Query<Entity, With<crate::camera_controllers::CameraController>>,
     multiplayer_mode: Res<MultiplayerMode>,
@@ -508,9 +681,7 @@ fn handle_world_state_received_events(
                     &mut commands,
                     &mut voxel_world,
                     &existing_blocks_query,
-                    &mut meshes,
-                    &mut materials,
-                    &asset_server,
+                    &shared_materials,
                     &mut inventory,
                     &camera_query,
                 );
@@ -535,9 +706,7 @@ fn load_shared_world_data(
     commands: &mut Commands,
     voxel_world: &mut crate::environment::VoxelWorld,
     existing_blocks_query: &Query<Entity, With<crate::environment::VoxelBlock>>,
-    meshes: &mut Assets<Mesh>,
-    materials: &mut Assets<StandardMaterial>,
-    asset_server: &AssetServer,
+    shared_materials: &crate::shared_materials::SharedBlockMaterials,
     inventory: &mut crate::inventory::PlayerInventory,
     camera_query: &Query<Entity, With<crate::camera_controllers::CameraController>>,
 ) {
@@ -565,8 +734,8 @@ fn load_shared_world_data(
         "🧹 [Bob Debug] Cleared {} existing block entities from scene",
         cleared_entities
     );
-    let old_blocks_count = voxel_world.blocks.len();
-    voxel_world.blocks.clear();
+    let old_blocks_count = voxel_world.blocks().len();
+    voxel_world.clear();
     info!(
         "🧹 [Bob Debug] Cleared {} existing blocks from VoxelWorld data structure",
         old_blocks_count
@@ -578,7 +747,7 @@ fn load_shared_world_data(
         world_data.blocks.len()
     );
     for (index, block_data) in world_data.blocks.iter().enumerate() {
-        voxel_world.blocks.insert(
+        voxel_world.set_block(
             IVec3::new(block_data.x, block_data.y, block_data.z),
             block_data.block_type,
         );
@@ -594,40 +763,24 @@ fn load_shared_world_data(
     }
     info!(
         "✅ [Bob Debug] Loaded {} blocks into VoxelWorld data structure",
-        voxel_world.blocks.len()
+        voxel_world.blocks().len()
     );
 
     // Spawn visual blocks
     info!(
         "🎨 [Bob Debug] Creating visual entities for {} blocks...",
-        voxel_world.blocks.len()
+        voxel_world.blocks().len()
     );
     let mut spawned_blocks = 0;
     let mut block_type_counts = std::collections::HashMap::new();
 
-    for (pos, block_type) in voxel_world.blocks.iter() {
-        let cube_mesh = meshes.add(Cuboid::new(
-            crate::environment::CUBE_SIZE,
-            crate::environment::CUBE_SIZE,
-            crate::environment::CUBE_SIZE,
-        ));
-        let texture_path = match block_type {
-            crate::environment::BlockType::Grass => "textures/grass.webp",
-            crate::environment::BlockType::Dirt => "textures/dirt.webp",
-            crate::environment::BlockType::Stone => "textures/stone.webp",
-            crate::environment::BlockType::QuartzBlock => "textures/quartz_block.webp",
-            crate::environment::BlockType::GlassPane => "textures/glass_pane.webp",
-            crate::environment::BlockType::CyanTerracotta => "textures/cyan_terracotta.webp",
-            crate::environment::BlockType::Water => "textures/water.webp",
-        };
-        let texture: Handle<Image> = asset_server.load(texture_path);
-        let material = materials.add(StandardMaterial {
-            base_color_texture: Some(texture),
-            ..default()
-        });
+    for (pos, block_type) in voxel_world.blocks().iter() {
+        let material = shared_materials
+            .get_material(*block_type)
+            .unwrap_or_default();
 
         commands.spawn((
-            Mesh3d(cube_mesh),
+            Mesh3d(shared_materials.shared_mesh.clone()),
             MeshMaterial3d(material),
             Transform::from_translation(pos.as_vec3()),
             crate::environment::VoxelBlock { position: *pos },
@@ -640,7 +793,7 @@ fn load_shared_world_data(
             info!(
                 "🎨 [Bob Debug] Spawned {} / {} visual block entities...",
                 spawned_blocks,
-                voxel_world.blocks.len()
+                voxel_world.blocks().len()
             );
         }
     }
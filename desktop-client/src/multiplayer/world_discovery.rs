@@ -48,9 +48,7 @@ fn load_shared_world_data(
     commands: &mut Commands,
     voxel_world: &mut crate::environment::VoxelWorld,
     existing_blocks_query: &Query<Entity, With<crate::environment::VoxelBlock>>,
-    meshes: &mut Assets<Mesh>,
-    materials: &mut Assets<StandardMaterial>,
-    asset_server: &AssetServer,
+    shared_materials: &crate::shared_materials::SharedBlockMaterials,
     inventory: &mut crate::inventory::PlayerInventory,
     camera_query: &Query<Entity, With<crate::camera_controllers::CameraController>>,
 ) {
@@ -63,40 +61,24 @@ fn load_shared_world_data(
     for entity in existing_blocks_query.iter() {
         commands.entity(entity).despawn();
     }
-    voxel_world.blocks.clear();
+    voxel_world.clear();
 
     // Load blocks
     for block_data in world_data.blocks {
-        voxel_world.blocks.insert(
+        voxel_world.set_block(
             IVec3::new(block_data.x, block_data.y, block_data.z),
             block_data.block_type,
         );
     }
 
     // Spawn visual blocks
-    for (pos, block_type) in voxel_world.blocks.iter() {
-        let cube_mesh = meshes.add(Cuboid::new(
-            crate::environment::CUBE_SIZE,
-            crate::environment::CUBE_SIZE,
-            crate::environment::CUBE_SIZE,
-        ));
-        let texture_path = match block_type {
-            crate::environment::BlockType::Grass => "textures/grass.webp",
-            crate::environment::BlockType::Dirt => "textures/dirt.webp",
-            crate::environment::BlockType::Stone => "textures/stone.webp",
-            crate::environment::BlockType::QuartzBlock => "textures/quartz_block.webp",
-            crate::environment::BlockType::GlassPane => "textures/glass_pane.webp",
-            crate::environment::BlockType::CyanTerracotta => "textures/cyan_terracotta.webp",
-            crate::environment::BlockType::Water => "textures/water.webp",
-        };
-        let texture: Handle<Image> = asset_server.load(texture_path);
-        let material = materials.add(StandardMaterial {
-            base_color_texture: Some(texture),
-            ..default()
-        });
+    for (pos, block_type) in voxel_world.blocks().iter() {
+        let material = shared_materials
+            .get_material(*block_type)
+            .unwrap_or_default();
 
         commands.spawn((
-            Mesh3d(cube_mesh),
+            Mesh3d(shared_materials.shared_mesh.clone()),
             MeshMaterial3d(material),
             Transform::from_translation(pos.as_vec3()),
             crate::environment::VoxelBlock { position: *pos },
@@ -124,9 +106,7 @@ fn apply_world_change(
     change: WorldChange,
     commands: &mut Commands,
     voxel_world: &mut crate::environment::VoxelWorld,
-    meshes: &mut Assets<Mesh>,
-    materials: &mut Assets<StandardMaterial>,
-    asset_server: &AssetServer,
+    shared_materials: &crate::shared_materials::SharedBlockMaterials,
 ) {
     match change.change_type {
         WorldChangeType::BlockPlaced {
@@ -136,31 +116,15 @@ fn apply_world_change(
             block_type,
         } => {
             let pos = IVec3::new(x, y, z);
-            voxel_world.blocks.insert(pos, block_type);
+            voxel_world.set_block(pos, block_type);
 
             // Spawn visual block
-            let cube_mesh = meshes.add(Cuboid::new(
-                crate::environment::CUBE_SIZE,
-                crate::environment::CUBE_SIZE,
-                crate::environment::CUBE_SIZE,
-            ));
-            let texture_path = match block_type {
-                crate::environment::BlockType::Grass => "textures/grass.webp",
-                crate::environment::BlockType::Dirt => "textures/dirt.webp",
-                crate::environment::BlockType::Stone => "textures/stone.webp",
-                crate::environment::BlockType::QuartzBlock => "textures/quartz_block.webp",
-                crate::environment::BlockType::GlassPane => "textures/glass_pane.webp",
-                crate::environment::BlockType::CyanTerracotta => "textures/cyan_terracotta.webp",
-                crate::environment::BlockType::Water => "textures/water.webp",
-            };
-            let texture: Handle<Image> = asset_server.load(texture_path);
-            let material = materials.add(StandardMaterial {
-                base_color_texture: Some(texture),
-                ..default()
-            });
+            let material = shared_materials
+                .get_material(block_type)
+                .unwrap_or_default();
 
             commands.spawn((
-                Mesh3d(cube_mesh),
+                Mesh3d(shared_materials.shared_mesh.clone()),
                 MeshMaterial3d(material),
                 Transform::from_translation(pos.as_vec3()),
                 crate::environment::VoxelBlock { position: pos },
@@ -173,7 +137,7 @@ fn apply_world_change(
         }
         WorldChangeType::BlockRemoved { x, y, z } => {
             let pos = IVec3::new(x, y, z);
-            voxel_world.blocks.remove(&pos);
+            voxel_world.remove_block(&pos);
 
             info!(
                 "Applied block removal from {}: ({}, {}, {})",
@@ -195,9 +159,7 @@ fn apply_block_change(
     commands: &mut Commands,
     voxel_world: &mut crate::environment::VoxelWorld,
     voxel_blocks_query: &Query<(Entity, &crate::environment::VoxelBlock)>,
-    meshes: &mut Assets<Mesh>,
-    materials: &mut Assets<StandardMaterial>,
-    asset_server: &AssetServer,
+    shared_materials: &crate::shared_materials::SharedBlockMaterials,
 ) {
     match change_type {
         super::shared_world::BlockChangeType::Placed {
@@ -207,31 +169,15 @@ fn apply_block_change(
             block_type,
         } => {
             let pos = IVec3::new(x, y, z);
-            voxel_world.blocks.insert(pos, block_type);
+            voxel_world.set_block(pos, block_type);
 
             // Spawn visual block
-            let cube_mesh = meshes.add(Cuboid::new(
-                crate::environment::CUBE_SIZE,
-                crate::environment::CUBE_SIZE,
-                crate::environment::CUBE_SIZE,
-            ));
-            let texture_path = match block_type {
-                crate::environment::BlockType::Grass => "textures/grass.webp",
-                crate::environment::BlockType::Dirt => "textures/dirt.webp",
-                crate::environment::BlockType::Stone => "textures/stone.webp",
-                crate::environment::BlockType::QuartzBlock => "textures/quartz_block.webp",
-                crate::environment::BlockType::GlassPane => "textures/glass_pane.webp",
-                crate::environment::BlockType::CyanTerracotta => "textures/cyan_terracotta.webp",
-                crate::environment::BlockType::Water => "textures/water.webp",
-            };
-            let texture: Handle<Image> = asset_server.load(texture_path);
-            let material = materials.add(StandardMaterial {
-                base_color_texture: Some(texture),
-                ..default()
-            });
+            let material = shared_materials
+                .get_material(block_type)
+                .unwrap_or_default();
 
             commands.spawn((
-                Mesh3d(cube_mesh),
+                Mesh3d(shared_materials.shared_mesh.clone()),
                 MeshMaterial3d(material),
                 Transform::from_translation(pos.as_vec3()),
                 crate::environment::VoxelBlock { position: pos },
@@ -244,7 +190,7 @@ fn apply_block_change(
         }
         super::shared_world::BlockChangeType::Removed { x, y, z } => {
             let pos = IVec3::new(x, y, z);
-            voxel_world.blocks.remove(&pos);
+            voxel_world.remove_block(&pos);
 
             // Despawn visual block by finding the entity at this position
             for (entity, block) in voxel_blocks_query.iter() {
@@ -287,6 +233,7 @@ fn process_core_mqtt_world_info(
     if let Some(receiver) = world_discovery_rx {
         if let Ok(rx) = receiver.0.lock() {
             while let Ok(world_info) = rx.try_recv() {
+                crate::mqtt::core_service::MqttQueue::WorldInfo.dequeued();
                 info!(
                     "🌍 Processing world info from Core MQTT Service: {} ({})",
                     world_info.world_name, world_info.world_id
@@ -328,10 +275,12 @@ fn process_core_mqtt_world_info(
 fn process_core_mqtt_world_data(
     world_data_rx: Option<Res<crate::mqtt::core_service::WorldDataReceiver>>,
     mut online_worlds: ResMut<OnlineWorlds>,
+    mut world_state_events: EventWriter<WorldStateReceivedEvent>,
 ) {
     if let Some(receiver) = world_data_rx {
         if let Ok(rx) = receiver.0.lock() {
-            while let Ok((world_id, world_data)) = rx.try_recv() {
+            while let Ok((world_id, world_data, source)) = rx.try_recv() {
+                crate::mqtt::core_service::MqttQueue::WorldData.dequeued();
                 info!(
                     "🌍 Processing world data from Core MQTT Service: {} ({} blocks)",
                     world_id,
@@ -348,6 +297,23 @@ fn process_core_mqtt_world_data(
                     world_id,
                     online_worlds.world_data_cache.len()
                 );
+
+                // The snapshot a join is waiting for; the retained one may arrive first and
+                // is only the fallback
+                let awaited = source == crate::mqtt::core_service::WorldDataSource::SnapshotReply
+                    && online_worlds
+                        .pending_snapshot
+                        .as_ref()
+                        .is_some_and(|(pending_id, _)| *pending_id == world_id);
+                if awaited {
+                    online_worlds.pending_snapshot = None;
+                    if let Some(world_data) = online_worlds.world_data_cache.get(&world_id) {
+                        world_state_events.write(WorldStateReceivedEvent {
+                            world_id: world_id.clone(),
+                            world_data: world_data.clone(),
+                        });
+                    }
+                }
             }
         }
     }
@@ -22,7 +22,7 @@ pub struct ChunkedWorldData {
 }
 
 /// Split world data into chunks that fit within MQTT message limits
-fn chunk_world_data(
+pub fn chunk_world_data(
     world_data: &WorldSaveData,
     world_id: &str,
 ) -> Result<Vec<ChunkedWorldData>, String> {
@@ -426,7 +426,7 @@ fn handle_world_publishing(
             use crate::world::{VoxelBlockData, WorldMetadata, WorldSaveData};
 
             let blocks: Vec<VoxelBlockData> = voxel_world
-                .blocks
+                .blocks()
                 .iter()
                 .map(|(pos, block_type)| VoxelBlockData {
                     x: pos.x,
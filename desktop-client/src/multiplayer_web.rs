@@ -166,9 +166,7 @@ fn handle_incoming_block_changes(
     mut commands: Commands,
     block_change_receiver: Option<Res<BlockChangeReceiver>>,
     mut voxel_world: ResMut<crate::environment::VoxelWorld>,
-    mut meshes: ResMut<Assets<Mesh>>,
-    mut materials: ResMut<Assets<StandardMaterial>>,
-    asset_server: Res<AssetServer>,
+    shared_materials: Res<crate::shared_materials::SharedBlockMaterials>,
     existing_blocks: Query<(Entity, &crate::environment::VoxelBlock)>,
     connection_status: Res<MultiplayerConnectionStatus>,
 ) {
@@ -202,39 +200,13 @@ fn handle_incoming_block_changes(
                 // Add block to voxel world
                 voxel_world.set_block(position, block_type);
 
-                // Create visual representation
-                let cube_mesh = meshes.add(Cuboid::new(1.0, 1.0, 1.0));
-
-                let material = match block_type {
-                    crate::environment::BlockType::Water => materials.add(StandardMaterial {
-                        base_color: Color::srgba(0.0, 0.35, 0.9, 0.6),
-                        alpha_mode: AlphaMode::Blend,
-                        ..default()
-                    }),
-                    _ => {
-                        let texture_path = match block_type {
-                            crate::environment::BlockType::Grass => "textures/grass.webp",
-                            crate::environment::BlockType::Dirt => "textures/dirt.webp",
-                            crate::environment::BlockType::Stone => "textures/stone.webp",
-                            crate::environment::BlockType::QuartzBlock => {
-                                "textures/quartz_block.webp"
-                            }
-                            crate::environment::BlockType::GlassPane => "textures/glass_pane.webp",
-                            crate::environment::BlockType::CyanTerracotta => {
-                                "textures/cyan_terracotta.webp"
-                            }
-                            _ => "textures/dirt.webp", // fallback
-                        };
-                        let texture = asset_server.load(texture_path);
-                        materials.add(StandardMaterial {
-                            base_color_texture: Some(texture),
-                            ..default()
-                        })
-                    }
-                };
+                // Create visual representation with the shared cube mesh and material
+                let material = shared_materials
+                    .get_material(block_type)
+                    .unwrap_or_default();
 
                 commands.spawn((
-                    Mesh3d(cube_mesh),
+                    Mesh3d(shared_materials.shared_mesh.clone()),
                     MeshMaterial3d(material),
                     Transform::from_translation(Vec3::new(x as f32, y as f32, z as f32)),
                     crate::environment::VoxelBlock { position },
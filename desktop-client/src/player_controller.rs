@@ -13,7 +13,8 @@ impl Plugin for PlayerControllerPlugin {
             (
                 enable_gravity_after_world_populated,
                 handle_mode_switch,
-                player_movement,
+                // Collision reads the world after this frame's edits
+                player_movement.in_set(crate::environment::VoxelSet::Read),
                 force_walking_mode_on_world_start,
             ),
         );
@@ -62,7 +63,7 @@ fn check_voxel_ground(
 
 /// Check if a position would collide with a voxel block
 /// Uses smart collision detection that prevents camera from entering cubes while avoiding false positives
-fn check_voxel_collision(
+pub fn check_voxel_collision(
     position: Vec3,
     player_height: f32,
     player_radius: f32,
@@ -426,7 +427,7 @@ fn enable_gravity_after_world_populated(
     voxel_world: Res<crate::environment::VoxelWorld>,
     mut camera_query: Query<(&mut Transform, &mut PlayerMovement), With<Camera>>,
 ) {
-    if voxel_world.blocks.is_empty() {
+    if voxel_world.blocks().is_empty() {
         return; // World not ready yet
     }
 
@@ -444,7 +445,7 @@ fn enable_gravity_after_world_populated(
             }
             info!(
                 "Gravity initialized after world population ({} blocks)",
-                voxel_world.blocks.len()
+                voxel_world.blocks().len()
             );
         }
     }
@@ -461,7 +462,7 @@ pub fn handle_physics_free_walking_movement_menu_only(
     let dt = time.delta_secs();
 
     // Early return if VoxelWorld is empty - wait for world generation to complete
-    if voxel_world.blocks.is_empty() {
+    if voxel_world.blocks().is_empty() {
         // Debug: Log every few seconds to see what's happening while waiting for world generation
         static mut LAST_EMPTY_WORLD_DEBUG: f64 = 0.0;
         let current_time = time.elapsed_secs_f64();
@@ -611,7 +612,7 @@ pub fn handle_physics_free_walking_movement(
     let dt = time.delta_secs();
 
     // Early return if VoxelWorld is empty - wait for world generation to complete
-    if voxel_world.blocks.is_empty() {
+    if voxel_world.blocks().is_empty() {
         // Debug: Log every few seconds to see what's happening while waiting for world generation
         static mut LAST_EMPTY_WORLD_DEBUG: f64 = 0.0;
         let current_time = time.elapsed_secs_f64();
@@ -643,7 +644,7 @@ pub fn handle_physics_free_walking_movement(
                 transform.translation,
                 movement.is_grounded,
                 movement.gravity_scale,
-                voxel_world.blocks.len()
+                voxel_world.blocks().len()
             );
         }
     }
@@ -712,11 +713,11 @@ pub fn handle_physics_free_walking_movement(
         info!("Player voxel position: {:?}", player_voxel);
 
         // Debug voxel world info
-        info!("VoxelWorld total blocks: {}", voxel_world.blocks.len());
+        info!("VoxelWorld total blocks: {}", voxel_world.blocks().len());
 
         // Show a few sample blocks from the voxel world
         let mut sample_count = 0;
-        for (pos, block_type) in voxel_world.blocks.iter() {
+        for (pos, block_type) in voxel_world.blocks().iter() {
             info!("Sample block: {:?} -> {:?}", pos, block_type);
             sample_count += 1;
             if sample_count >= 5 {
@@ -1,3 +1,4 @@
+pub mod script_compiler;
 pub mod script_helpers;
 pub mod script_systems;
 pub mod script_types;
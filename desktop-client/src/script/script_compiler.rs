@@ -0,0 +1,415 @@
+//! Script compiler
+//!
+//! Scripts used to be split into lines and queued as text, so every `place` and `wall`
+//! was tokenized by the command executor and applied to the world one block at a time.
+//! [`compile_script`] parses the whole script once into typed [`ScriptOp`]s, merging runs
+//! of `place`/`wall`/`remove` lines that add up to a box into a single region. The game
+//! queues [`CompiledScript::block_edits`] through `VoxelEdits` like any other edit;
+//! [`CompiledScript::execute`] applies them to a world directly as one bulk edit.
+//! Commands that do not touch blocks (`tp`, `give`, `spawn`, ...) are kept as text and
+//! queued after the block edits. [`ScriptCache`] keeps compiled scripts by content hash.
+
+use bevy::prelude::*;
+use std::collections::HashMap;
+use std::hash::{DefaultHasher, Hash, Hasher};
+use std::sync::Arc;
+
+use crate::environment::{BlockType, VoxelWorld};
+
+/// Compiled scripts kept by [`ScriptCache`] before it starts over
+const MAX_CACHED_SCRIPTS: usize = 32;
+
+/// A block operation over the inclusive box `min..=max`
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum ScriptOp {
+    Fill {
+        block_type: BlockType,
+        min: IVec3,
+        max: IVec3,
+    },
+    Clear {
+        min: IVec3,
+        max: IVec3,
+    },
+}
+
+impl ScriptOp {
+    /// Block written by the op (`None` clears) and its box
+    fn region(self) -> (Option<BlockType>, IVec3, IVec3) {
+        match self {
+            ScriptOp::Fill {
+                block_type,
+                min,
+                max,
+            } => (Some(block_type), min, max),
+            ScriptOp::Clear { min, max } => (None, min, max),
+        }
+    }
+
+    fn from_region(block_type: Option<BlockType>, min: IVec3, max: IVec3) -> Self {
+        match block_type {
+            Some(block_type) => ScriptOp::Fill {
+                block_type,
+                min,
+                max,
+            },
+            None => ScriptOp::Clear { min, max },
+        }
+    }
+
+    /// Number of block positions the op covers
+    pub fn volume(self) -> usize {
+        let (_, min, max) = self.region();
+        let size = max - min + IVec3::ONE;
+        size.x as usize * size.y as usize * size.z as usize
+    }
+}
+
+/// A script line that was skipped
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct ScriptDiagnostic {
+    /// 1-based source line
+    pub line: usize,
+    pub message: String,
+}
+
+/// A script parsed into block operations and pass-through commands
+#[derive(Debug, Clone, Default, PartialEq)]
+pub struct CompiledScript {
+    pub ops: Vec<ScriptOp>,
+    /// Non-block commands, in script order
+    pub commands: Vec<String>,
+    /// Invalid lines, skipped like the line-by-line executor skips them
+    pub diagnostics: Vec<ScriptDiagnostic>,
+    /// Command lines in the source
+    pub source_lines: usize,
+}
+
+impl CompiledScript {
+    /// Final block of every position the script touches
+    pub fn block_edits(&self) -> HashMap<IVec3, Option<BlockType>> {
+        let mut edits = HashMap::with_capacity(self.ops.iter().map(|op| op.volume()).sum());
+        for op in &self.ops {
+            let (block_type, min, max) = op.region();
+            for x in min.x..=max.x {
+                for y in min.y..=max.y {
+                    for z in min.z..=max.z {
+                        edits.insert(IVec3::new(x, y, z), block_type);
+                    }
+                }
+            }
+        }
+        edits
+    }
+
+    /// Apply the block operations to `voxel_world` as one bulk edit. Returns the positions
+    /// whose block actually changed, with their new block.
+    pub fn execute(&self, voxel_world: &mut VoxelWorld) -> Vec<(IVec3, Option<BlockType>)> {
+        let edits: Vec<(IVec3, Option<BlockType>)> = self
+            .block_edits()
+            .into_iter()
+            .filter(|(position, block_type)| {
+                voxel_world.blocks().get(position) != block_type.as_ref()
+            })
+            .collect();
+        voxel_world.apply_bulk(&edits);
+        edits
+    }
+}
+
+/// Parse block type from string
+fn parse_block_type(block_type_str: &str) -> Option<BlockType> {
+    match block_type_str.to_lowercase().as_str() {
+        "grass" => Some(BlockType::Grass),
+        "dirt" => Some(BlockType::Dirt),
+        "stone" => Some(BlockType::Stone),
+        "quartz_block" => Some(BlockType::QuartzBlock),
+        "glass_pane" => Some(BlockType::GlassPane),
+        "cyan_terracotta" => Some(BlockType::CyanTerracotta),
+        "water" => Some(BlockType::Water),
+        _ => None,
+    }
+}
+
+fn parse_position(args: &[&str]) -> Option<IVec3> {
+    match args {
+        [x, y, z] => Some(IVec3::new(
+            x.parse().ok()?,
+            y.parse().ok()?,
+            z.parse().ok()?,
+        )),
+        _ => None,
+    }
+}
+
+/// Union of two boxes when it is itself a box: one contains the other, or both have the
+/// same extent on two axes and overlap or touch on the third
+fn merge_boxes(a: (IVec3, IVec3), b: (IVec3, IVec3)) -> Option<(IVec3, IVec3)> {
+    let ((a_min, a_max), (b_min, b_max)) = (a, b);
+    if a_min.cmple(b_min).all() && b_max.cmple(a_max).all() {
+        return Some(a);
+    }
+    if b_min.cmple(a_min).all() && a_max.cmple(b_max).all() {
+        return Some(b);
+    }
+    (0..3)
+        .find(|&axis| {
+            (0..3)
+                .filter(|&other| other != axis)
+                .all(|other| a_min[other] == b_min[other] && a_max[other] == b_max[other])
+                && a_min[axis] <= b_max[axis] + 1
+                && b_min[axis] <= a_max[axis] + 1
+        })
+        .map(|_| (a_min.min(b_min), a_max.max(b_max)))
+}
+
+/// Append an op, folding it into the ops before it while each union is still a box of
+/// the same block. Rows of `place` lines collapse into a line, then rows into a plane.
+fn push_op(ops: &mut Vec<ScriptOp>, op: ScriptOp) {
+    let (block_type, mut min, mut max) = op.region();
+    while let Some(&previous) = ops.last() {
+        let (previous_type, previous_min, previous_max) = previous.region();
+        if previous_type != block_type {
+            break;
+        }
+        let Some(merged) = merge_boxes((previous_min, previous_max), (min, max)) else {
+            break;
+        };
+        (min, max) = merged;
+        ops.pop();
+    }
+    ops.push(ScriptOp::from_region(block_type, min, max));
+}
+
+fn compile_line(parts: &[&str], script: &mut CompiledScript) -> Result<(), String> {
+    match parts {
+        ["place", block, position @ ..] => {
+            let block_type =
+                parse_block_type(block).ok_or_else(|| format!("Invalid block type: {}", block))?;
+            let position = parse_position(position)
+                .ok_or("Usage: place <block_type> <x> <y> <z>".to_string())?;
+            push_op(
+                &mut script.ops,
+                ScriptOp::Fill {
+                    block_type,
+                    min: position,
+                    max: position,
+                },
+            );
+        }
+        ["wall", block, corners @ ..] => {
+            let block_type =
+                parse_block_type(block).ok_or_else(|| format!("Invalid block type: {}", block))?;
+            let usage = "Usage: wall <block_type> <x1> <y1> <z1> <x2> <y2> <z2>";
+            if corners.len() != 6 {
+                return Err(usage.to_string());
+            }
+            let (min, max) = parse_position(&corners[..3])
+                .zip(parse_position(&corners[3..]))
+                .ok_or(usage.to_string())?;
+            if !min.cmple(max).all() {
+                return Err("Wall corners must go from smaller to larger values".to_string());
+            }
+            push_op(
+                &mut script.ops,
+                ScriptOp::Fill {
+                    block_type,
+                    min,
+                    max,
+                },
+            );
+        }
+        ["remove", position @ ..] => {
+            let position =
+                parse_position(position).ok_or("Usage: remove <x> <y> <z>".to_string())?;
+            push_op(
+                &mut script.ops,
+                ScriptOp::Clear {
+                    min: position,
+                    max: position,
+                },
+            );
+        }
+        _ => script.commands.push(parts.join(" ")),
+    }
+    Ok(())
+}
+
+/// Parse a whole script; blank lines and `#` comments, including trailing ones, are skipped
+pub fn compile_script(source: &str) -> CompiledScript {
+    let mut script = CompiledScript::default();
+    for (index, line) in source.lines().enumerate() {
+        let line = line.split('#').next().unwrap_or_default().trim();
+        if line.is_empty() {
+            continue;
+        }
+        script.source_lines += 1;
+        let parts: Vec<&str> = line.split_whitespace().collect();
+        if let Err(message) = compile_line(&parts, &mut script) {
+            script.diagnostics.push(ScriptDiagnostic {
+                line: index + 1,
+                message,
+            });
+        }
+    }
+    script
+}
+
+/// Compiled scripts by content hash
+#[derive(Resource, Debug, Default)]
+pub struct ScriptCache {
+    scripts: HashMap<u64, Arc<CompiledScript>>,
+    pub hits: u64,
+    pub misses: u64,
+}
+
+impl ScriptCache {
+    /// The compiled form of `source`, compiling it on first use
+    pub fn compile(&mut self, source: &str) -> Arc<CompiledScript> {
+        let mut hasher = DefaultHasher::new();
+        source.hash(&mut hasher);
+        let key = hasher.finish();
+
+        if let Some(script) = self.scripts.get(&key) {
+            self.hits += 1;
+            return script.clone();
+        }
+        self.misses += 1;
+        if self.scripts.len() == MAX_CACHED_SCRIPTS {
+            self.scripts.clear();
+        }
+        let script = Arc::new(compile_script(source));
+        self.scripts.insert(key, script.clone());
+        script
+    }
+
+    pub fn len(&self) -> usize {
+        self.scripts.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.scripts.is_empty()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_place_rows_merge_into_one_region() {
+        let mut source = String::from("# 5x5 floor, row by row\n");
+        for z in -2..=2 {
+            for x in -2..=2 {
+                source.push_str(&format!("place stone {} 1 {}\n", x, z));
+            }
+        }
+        let script = compile_script(&source);
+        assert_eq!(script.source_lines, 25);
+        assert_eq!(
+            script.ops,
+            vec![ScriptOp::Fill {
+                block_type: BlockType::Stone,
+                min: IVec3::new(-2, 1, -2),
+                max: IVec3::new(2, 1, 2),
+            }]
+        );
+    }
+
+    #[test]
+    fn test_merging_keeps_script_order() {
+        let script = compile_script(
+            "wall grass 0 0 0 3 0 0\n\
+             place dirt 4 0 0\n\
+             place grass 5 0 0\n\
+             remove 1 0 0\n\
+             remove 2 0 0\n\
+             tp 0 5 0\n\
+             place grass 1 0 0",
+        );
+        assert_eq!(script.ops.len(), 5);
+        assert_eq!(
+            script.ops[3],
+            ScriptOp::Clear {
+                min: IVec3::new(1, 0, 0),
+                max: IVec3::new(2, 0, 0),
+            }
+        );
+        assert_eq!(script.commands, vec!["tp 0 5 0"]);
+
+        let edits = script.block_edits();
+        assert_eq!(edits[&IVec3::new(1, 0, 0)], Some(BlockType::Grass));
+        assert_eq!(edits[&IVec3::new(2, 0, 0)], None);
+        assert_eq!(edits[&IVec3::new(4, 0, 0)], Some(BlockType::Dirt));
+    }
+
+    #[test]
+    fn test_invalid_lines_are_reported_and_skipped() {
+        let script = compile_script(
+            "place lava 0 0 0\n\
+             \n\
+             wall stone 5 0 0 0 0 0\n\
+             place stone 1 2\n\
+             place stone 1 2 3  # trailing comment",
+        );
+        assert_eq!(script.ops.len(), 1);
+        let lines: Vec<usize> = script.diagnostics.iter().map(|d| d.line).collect();
+        assert_eq!(lines, vec![1, 3, 4]);
+        assert_eq!(script.diagnostics[0].message, "Invalid block type: lava");
+    }
+
+    #[test]
+    fn test_execute_reports_only_changed_blocks() {
+        let mut voxel_world = VoxelWorld::default();
+        voxel_world.set_block(IVec3::new(0, 0, 0), BlockType::Grass);
+        voxel_world.set_block(IVec3::new(9, 9, 9), BlockType::Stone);
+
+        let script = compile_script("wall grass 0 0 0 2 0 0\nremove 9 9 9\nremove 8 8 8");
+        let mut changed = script.execute(&mut voxel_world);
+        changed.sort_by_key(|(position, _)| position.to_array());
+        assert_eq!(
+            changed,
+            vec![
+                (IVec3::new(1, 0, 0), Some(BlockType::Grass)),
+                (IVec3::new(2, 0, 0), Some(BlockType::Grass)),
+                (IVec3::new(9, 9, 9), None),
+            ]
+        );
+        assert_eq!(voxel_world.blocks().len(), 3);
+    }
+
+    #[test]
+    fn test_cache_compiles_each_source_once() {
+        let mut cache = ScriptCache::default();
+        let first = cache.compile("place stone 0 0 0");
+        let again = cache.compile("place stone 0 0 0");
+        cache.compile("place dirt 0 0 0");
+        assert!(Arc::ptr_eq(&first, &again));
+        assert_eq!((cache.hits, cache.misses, cache.len()), (1, 2, 2));
+    }
+
+    #[test]
+    fn test_repo_scripts_compile_cleanly() {
+        let scripts_dir = concat!(env!("CARGO_MANIFEST_DIR"), "/scripts");
+        for name in [
+            "house.txt",
+            "room.txt",
+            "world_templates/default.txt",
+            "world_templates/medieval.txt",
+        ] {
+            let source = std::fs::read_to_string(format!("{}/{}", scripts_dir, name)).unwrap();
+            let script = compile_script(&source);
+            assert!(
+                script.diagnostics.is_empty(),
+                "{}: {:?}",
+                name,
+                script.diagnostics
+            );
+            assert!(
+                script.ops.len() < script.source_lines,
+                "{} did not merge",
+                name
+            );
+        }
+    }
+}
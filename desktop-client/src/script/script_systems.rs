@@ -1,4 +1,4 @@
-use super::{script_helpers::*, script_types::*};
+use super::{script_compiler::ScriptCache, script_helpers::*, script_types::*};
 use bevy::prelude::*;
 use log::info;
 
@@ -10,8 +10,63 @@ impl Plugin for ScriptPlugin {
             .insert_resource(PendingCommands {
                 commands: Vec::new(),
             })
+            .init_resource::<PendingScripts>()
+            .init_resource::<ScriptCache>()
             .add_systems(Update, script_execution_system);
+
+        #[cfg(not(target_arch = "wasm32"))]
+        app.add_systems(
+            PreUpdate,
+            execute_pending_scripts
+                .run_if(|pending_scripts: Res<PendingScripts>| !pending_scripts.scripts.is_empty()),
+        );
+    }
+}
+
+/// Compile queued scripts (or take them from the cache), queue their block edits for
+/// `apply_voxel_edits`, and queue the remaining commands for the command executor. Block
+/// visuals follow from the world's change journal like any other edit.
+#[cfg(not(target_arch = "wasm32"))]
+pub fn execute_pending_scripts(
+    mut pending_scripts: ResMut<PendingScripts>,
+    mut script_cache: ResMut<ScriptCache>,
+    mut pending_commands: ResMut<PendingCommands>,
+    voxel_world: Res<crate::environment::VoxelWorld>,
+    mut edits: bevy::ecs::system::Deferred<crate::environment::VoxelEdits>,
+) {
+    // Final block per position over all of this frame's scripts, later scripts winning
+    let mut block_edits = std::collections::HashMap::new();
+    for script in std::mem::take(&mut pending_scripts.scripts) {
+        let compiled = script_cache.compile(&script.source);
+        for diagnostic in &compiled.diagnostics {
+            warn!(
+                "{} line {}: {} (skipped)",
+                script.name, diagnostic.line, diagnostic.message
+            );
+        }
+
+        block_edits.extend(compiled.block_edits());
+        pending_commands
+            .commands
+            .extend(compiled.commands.iter().cloned());
+
+        info!(
+            "Executed script {}: {} lines as {} region ops, {} commands queued (cache {} hits / {} misses)",
+            script.name,
+            compiled.source_lines,
+            compiled.ops.len(),
+            compiled.commands.len(),
+            script_cache.hits,
+            script_cache.misses
+        );
     }
+
+    let changes: Vec<_> = block_edits
+        .into_iter()
+        .filter(|(position, block_type)| voxel_world.blocks().get(position) != block_type.as_ref())
+        .collect();
+    info!("Queued {} block edits from scripts", changes.len());
+    edits.extend(changes);
 }
 
 pub fn script_execution_system(
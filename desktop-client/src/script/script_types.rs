@@ -25,3 +25,17 @@ impl Default for ScriptExecutor {
 pub struct PendingCommands {
     pub commands: Vec<String>,
 }
+
+/// A whole script queued for compiled execution
+#[derive(Debug, Clone)]
+pub struct QueuedScript {
+    /// Shown in logs, e.g. the script's path
+    pub name: String,
+    pub source: String,
+}
+
+/// Scripts waiting to be compiled and applied as one bulk edit each
+#[derive(Resource, Default)]
+pub struct PendingScripts {
+    pub scripts: Vec<QueuedScript>,
+}
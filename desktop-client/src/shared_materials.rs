@@ -1,6 +1,57 @@
 use crate::environment::BlockType;
+use bevy::asset::{LoadState, RenderAssetUsages};
+use bevy::image::ImageSampler;
 use bevy::prelude::*;
+use bevy::render::render_resource::{Extent3d, TextureDimension, TextureFormat};
 use std::collections::HashMap;
+use std::time::Duration;
+
+/// Number of tiles in the block texture atlas, one per block type in `BlockType::ALL` order
+pub const ATLAS_LAYERS: u32 = BlockType::ALL.len() as u32;
+
+/// Part of a tile trimmed from its top and bottom edge so sampling never reaches the
+/// neighbouring tile (half a texel of a 32px texture)
+const ATLAS_TILE_INSET: f32 = 1.0 / 64.0;
+
+/// Texel used for tiles whose texture failed to load
+const MISSING_TEXEL: [u8; 4] = [255, 0, 255, 255];
+
+/// Blocks drawn with alpha blending; they cannot share the opaque atlas material
+pub fn is_translucent(block_type: BlockType) -> bool {
+    matches!(block_type, BlockType::Water)
+}
+
+/// Map a face UV of `block_type` into the block's tile of the texture atlas
+pub fn atlas_uv(block_type: BlockType, uv: [f32; 2]) -> [f32; 2] {
+    let v = uv[1].clamp(ATLAS_TILE_INSET, 1.0 - ATLAS_TILE_INSET);
+    [uv[0], (block_type.index() as f32 + v) / ATLAS_LAYERS as f32]
+}
+
+/// The material a block type is drawn with when it has an entity (or mesh) of its own
+pub fn block_material(block_type: BlockType, texture: Handle<Image>) -> StandardMaterial {
+    let (perceptual_roughness, metallic) = match block_type {
+        BlockType::QuartzBlock => (0.6, 0.1), // Slightly smoother and metallic
+        BlockType::GlassPane | BlockType::Water => (0.0, 0.0), // Smooth glass and water
+        _ => (0.8, 0.0),
+    };
+    if is_translucent(block_type) {
+        // Keeps its texture; only the alpha differs from the opaque blocks
+        return StandardMaterial {
+            base_color_texture: Some(texture),
+            base_color: Color::srgba(1.0, 1.0, 1.0, 0.8),
+            alpha_mode: AlphaMode::Blend,
+            perceptual_roughness,
+            metallic,
+            ..default()
+        };
+    }
+    StandardMaterial {
+        base_color_texture: Some(texture),
+        perceptual_roughness,
+        metallic,
+        ..default()
+    }
+}
 
 /// Resource that holds shared materials for all block types
 /// This prevents creating a new material for every block, which is a major performance bottleneck
@@ -8,6 +59,9 @@ use std::collections::HashMap;
 pub struct SharedBlockMaterials {
     pub materials: HashMap<BlockType, Handle<StandardMaterial>>,
     pub shared_mesh: Handle<Mesh>,
+    /// Opaque material textured with the block atlas, used by chunk meshes that mix
+    /// block types in one draw
+    pub atlas_material: Handle<StandardMaterial>,
 }
 
 impl Default for SharedBlockMaterials {
@@ -15,6 +69,7 @@ impl Default for SharedBlockMaterials {
         Self {
             materials: HashMap::new(),
             shared_mesh: Handle::default(),
+            atlas_material: Handle::default(),
         }
     }
 }
@@ -25,12 +80,26 @@ impl SharedBlockMaterials {
         self.materials.get(&block_type).cloned()
     }
 
+    /// Material for a chunk mesh: the atlas material for mixed opaque meshes (`None`),
+    /// the block's own material otherwise
+    pub fn chunk_material(&self, block_type: Option<BlockType>) -> Handle<StandardMaterial> {
+        match block_type {
+            Some(block_type) => self.get_material(block_type).unwrap_or_default(),
+            None => self.atlas_material.clone(),
+        }
+    }
+
+    /// Number of distinct block materials, including the atlas material
+    pub fn material_count(&self) -> usize {
+        self.materials.len() + 1
+    }
+
     /// Initialize all block materials and the shared mesh
     pub fn initialize(
         &mut self,
         materials: &mut Assets<StandardMaterial>,
         meshes: &mut Assets<Mesh>,
-        asset_server: &AssetServer,
+        atlas: &BlockTextureAtlas,
     ) {
         // Create shared mesh for all blocks
         self.shared_mesh = meshes.add(Cuboid::new(
@@ -39,61 +108,241 @@ impl SharedBlockMaterials {
             crate::environment::CUBE_SIZE,
         ));
 
-        // Create materials for each block type
-        let block_configs = [
-            (BlockType::Grass, "textures/grass.webp", 0.8, 0.0),
-            (BlockType::Dirt, "textures/dirt.webp", 0.8, 0.0),
-            (BlockType::Stone, "textures/stone.webp", 0.8, 0.0),
-            (
-                BlockType::QuartzBlock,
-                "textures/quartz_block.webp",
-                0.6,
-                0.1,
-            ), // Slightly smoother and metallic
-            (BlockType::GlassPane, "textures/glass_pane.webp", 0.0, 0.0), // Smooth glass
-            (
-                BlockType::CyanTerracotta,
-                "textures/cyan_terracotta.webp",
-                0.8,
-                0.0,
-            ),
-            (BlockType::Water, "textures/water.webp", 0.0, 0.0), // Smooth water
-        ];
-
-        for (block_type, texture_path, roughness, metallic) in block_configs {
-            let texture = asset_server.load(texture_path);
-            let material = materials.add(StandardMaterial {
-                base_color_texture: Some(texture),
-                perceptual_roughness: roughness,
-                metallic,
-                ..default()
-            });
+        // Create materials for each block type, sharing the atlas source textures
+        for (block_type, texture) in BlockType::ALL.into_iter().zip(&atlas.textures) {
+            let material = materials.add(block_material(block_type, texture.clone()));
             self.materials.insert(block_type, material);
         }
 
+        self.atlas_material = materials.add(StandardMaterial {
+            base_color_texture: Some(atlas.image.clone()),
+            perceptual_roughness: 0.8,
+            ..default()
+        });
+
         info!(
             "SharedBlockMaterials initialized with {} materials",
-            self.materials.len()
+            self.material_count()
         );
     }
 }
 
+/// All block textures stitched into one vertical strip, tile `n` holding the texture of
+/// `BlockType::ALL[n]`. Built once at startup when the source textures have loaded.
+#[derive(Resource, Debug, Default)]
+pub struct BlockTextureAtlas {
+    /// Source textures in `BlockType::ALL` order
+    pub textures: Vec<Handle<Image>>,
+    /// The stitched atlas (a 1x1 placeholder until all sources are decoded)
+    pub image: Handle<Image>,
+    /// Edge length of one tile in pixels
+    pub tile_size: u32,
+    /// Time from startup until the atlas was built
+    pub load_time: Option<Duration>,
+    started: Duration,
+}
+
+impl BlockTextureAtlas {
+    pub fn is_ready(&self) -> bool {
+        self.load_time.is_some()
+    }
+}
+
+/// Decoded RGBA8 pixels of one atlas source texture
+#[derive(Debug, Clone, Copy)]
+pub struct AtlasTile<'a> {
+    pub width: u32,
+    pub height: u32,
+    pub data: &'a [u8],
+}
+
+impl<'a> AtlasTile<'a> {
+    /// View an image as an atlas tile; `None` if it is not tightly packed RGBA8
+    fn from_image(image: &'a Image) -> Option<Self> {
+        let format = image.texture_descriptor.format;
+        if !matches!(
+            format,
+            TextureFormat::Rgba8UnormSrgb | TextureFormat::Rgba8Unorm
+        ) {
+            return None;
+        }
+        let data = image.data.as_deref()?;
+        let (width, height) = (image.width(), image.height());
+        (data.len() == width as usize * height as usize * 4).then_some(Self {
+            width,
+            height,
+            data,
+        })
+    }
+}
+
+/// Stitch tiles into a vertical strip of square tiles as wide as the widest source.
+///
+/// Sources of a different size are resampled (nearest); missing ones are filled with
+/// magenta. Returns the tile size and the RGBA8 pixel data.
+pub fn stitch_atlas(tiles: &[Option<AtlasTile>]) -> (u32, Vec<u8>) {
+    let tile_size = tiles.iter().flatten().map(|t| t.width).max().unwrap_or(1);
+    let size = tile_size.max(1) as usize;
+    let mut data = Vec::with_capacity(size * size * 4 * tiles.len());
+    for tile in tiles {
+        match tile {
+            Some(tile) => {
+                let (width, height) = (tile.width as usize, tile.height as usize);
+                for y in 0..size {
+                    let row = y * height / size * width;
+                    for x in 0..size {
+                        let texel = (row + x * width / size) * 4;
+                        data.extend_from_slice(&tile.data[texel..texel + 4]);
+                    }
+                }
+            }
+            None => {
+                for _ in 0..size * size {
+                    data.extend_from_slice(&MISSING_TEXEL);
+                }
+            }
+        }
+    }
+    (size as u32, data)
+}
+
 /// Plugin to setup shared materials
 pub struct SharedMaterialsPlugin;
 
 impl Plugin for SharedMaterialsPlugin {
     fn build(&self, app: &mut App) {
         app.insert_resource(SharedBlockMaterials::default())
-            .add_systems(Startup, setup_shared_materials);
+            .init_resource::<BlockTextureAtlas>()
+            .add_systems(Startup, setup_shared_materials)
+            .add_systems(Update, build_block_atlas);
     }
 }
 
 /// Setup system that initializes all shared materials
 fn setup_shared_materials(
     mut shared_materials: ResMut<SharedBlockMaterials>,
+    mut atlas: ResMut<BlockTextureAtlas>,
     mut materials: ResMut<Assets<StandardMaterial>>,
     mut meshes: ResMut<Assets<Mesh>>,
+    mut images: ResMut<Assets<Image>>,
+    asset_server: Res<AssetServer>,
+    time: Res<Time<Real>>,
+) {
+    // Request every block texture up front; the asset server decodes them concurrently
+    // on its task pools and the atlas is stitched once the last one arrives
+    atlas.started = time.elapsed();
+    atlas.textures = BlockType::ALL
+        .iter()
+        .map(|block_type| asset_server.load(block_type.texture_path()))
+        .collect();
+    atlas.image = images.add(atlas_image(1, 1, vec![255; 4]));
+
+    shared_materials.initialize(&mut materials, &mut meshes, &atlas);
+}
+
+fn atlas_image(width: u32, height: u32, data: Vec<u8>) -> Image {
+    let mut image = Image::new(
+        Extent3d {
+            width,
+            height,
+            depth_or_array_layers: 1,
+        },
+        TextureDimension::D2,
+        data,
+        TextureFormat::Rgba8UnormSrgb,
+        RenderAssetUsages::MAIN_WORLD | RenderAssetUsages::RENDER_WORLD,
+    );
+    image.sampler = ImageSampler::nearest();
+    image
+}
+
+/// Stitch the block atlas as soon as all source textures are decoded
+fn build_block_atlas(
+    mut atlas: ResMut<BlockTextureAtlas>,
+    mut images: ResMut<Assets<Image>>,
+    mut materials: ResMut<Assets<StandardMaterial>>,
+    shared_materials: Res<SharedBlockMaterials>,
     asset_server: Res<AssetServer>,
+    time: Res<Time<Real>>,
 ) {
-    shared_materials.initialize(&mut materials, &mut meshes, &asset_server);
+    if atlas.is_ready() || atlas.textures.is_empty() {
+        return;
+    }
+
+    let mut tiles = Vec::with_capacity(atlas.textures.len());
+    for texture in &atlas.textures {
+        match images.get(texture) {
+            Some(image) => tiles.push(AtlasTile::from_image(image)),
+            None if matches!(asset_server.load_state(texture), LoadState::Failed(_)) => {
+                warn!("Block texture {:?} failed to load", texture.path());
+                tiles.push(None);
+            }
+            // Still decoding
+            None => return,
+        }
+    }
+    let (tile_size, data) = stitch_atlas(&tiles);
+
+    let _ = images.insert(
+        atlas.image.id(),
+        atlas_image(tile_size, tile_size * ATLAS_LAYERS, data),
+    );
+    // Touch the atlas material so its bind group picks up the new image
+    materials.get_mut(&shared_materials.atlas_material);
+
+    let load_time = time.elapsed().saturating_sub(atlas.started);
+    atlas.tile_size = tile_size;
+    atlas.load_time = Some(load_time);
+    info!(
+        "Block texture atlas built in {:.1} ms: {} textures, {}px tiles, {} block materials",
+        load_time.as_secs_f64() * 1000.0,
+        ATLAS_LAYERS,
+        tile_size,
+        shared_materials.material_count()
+    );
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_stitch_atlas_resamples_and_fills_missing_tiles() {
+        // 2x2 tile and 1x1 tile, stitched to 2x2 tiles
+        let red = [255, 0, 0, 255];
+        let green = [0, 255, 0, 255];
+        let big: Vec<u8> = [red, green, green, red].concat();
+        let tiles = [
+            Some(AtlasTile {
+                width: 2,
+                height: 2,
+                data: &big,
+            }),
+            Some(AtlasTile {
+                width: 1,
+                height: 1,
+                data: &green,
+            }),
+            None,
+        ];
+        let (tile_size, data) = stitch_atlas(&tiles);
+        assert_eq!(tile_size, 2);
+        assert_eq!(data.len(), 2 * 2 * 4 * 3);
+        assert_eq!(&data[..16], big.as_slice());
+        assert_eq!(&data[16..32], [green; 4].concat().as_slice());
+        assert_eq!(&data[32..36], &MISSING_TEXEL);
+    }
+
+    #[test]
+    fn test_atlas_uv_stays_inside_block_tile() {
+        for block_type in BlockType::ALL {
+            let layer = block_type.index() as f32;
+            for uv in [[0.0, 0.0], [1.0, 1.0]] {
+                let [u, v] = atlas_uv(block_type, uv);
+                assert_eq!(u, uv[0]);
+                let local = v * ATLAS_LAYERS as f32 - layer;
+                assert!(local > 0.0 && local < 1.0, "{block_type:?} {uv:?} -> {v}");
+            }
+        }
+    }
 }
@@ -76,15 +76,7 @@ fn update_inventory_ui(
                     // Create slot with item if available
                     if let Some(item_stack) = slot {
                         let texture_path = match &item_stack.item_type {
-                            ItemType::Block(block_type) => match block_type {
-                                BlockType::Grass => "textures/grass.webp",
-                                BlockType::Dirt => "textures/dirt.webp",
-                                BlockType::Stone => "textures/stone.webp",
-                                BlockType::QuartzBlock => "textures/quartz_block.webp",
-                                BlockType::GlassPane => "textures/glass_pane.webp",
-                                BlockType::CyanTerracotta => "textures/cyan_terracotta.webp",
-                                BlockType::Water => "textures/water.webp",
-                            },
+                            ItemType::Block(block_type) => block_type.texture_path(),
                         };
 
                         // Slot with item image
@@ -206,13 +198,5 @@ mod tests {
 /// Pure function to get texture path for block type
 #[allow(dead_code)]
 pub fn get_block_texture_path(block_type: &BlockType) -> &'static str {
-    match block_type {
-        BlockType::Grass => "textures/grass.webp",
-        BlockType::Dirt => "textures/dirt.webp",
-        BlockType::Stone => "textures/stone.webp",
-        BlockType::QuartzBlock => "textures/quartz_block.webp",
-        BlockType::GlassPane => "textures/glass_pane.webp",
-        BlockType::CyanTerracotta => "textures/cyan_terracotta.webp",
-        BlockType::Water => "textures/water.webp",
-    }
+    block_type.texture_path()
 }
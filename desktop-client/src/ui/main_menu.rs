@@ -2874,8 +2874,9 @@ fn handle_world_state_received_events_wasm(
     mut voxel_world: ResMut<crate::environment::VoxelWorld>,
     existing_blocks_query: Query<Entity, With<crate::environment::VoxelBlock>>,
     mut meshes: ResMut<Assets<Mesh>>,
-    mut materials: ResMut<Assets<StandardMaterial>>,
-    asset_server: Res<AssetServer>,
+    shared_materials: Res<crate::shared_materials::SharedBlockMaterials>,
+    mut meshed_chunks: ResMut<crate::world::chunk_mesh::MeshedChunks>,
+    mut prebuilt_meshes: ResMut<crate::world::chunk_mesh::PrebuiltChunkMeshes>,
     mut inventory: ResMut<crate::inventory::PlayerInventory>,
     camera_query: Query<Entity, With<crate::camera_controllers::CameraController>>,
     multiplayer_mode: Res<multiplayer_stubs::MultiplayerMode>,
@@ -2906,13 +2907,14 @@ fn handle_world_state_received_events_wasm(
                 for entity in existing_blocks_query.iter() {
                     commands.entity(entity).despawn();
                 }
+                meshed_chunks.clear(&mut commands);
                 info!(
                     "🧹 WASM: Cleared {} existing block entities from scene",
                     cleared_entities
                 );
 
-                let old_blocks_count = voxel_world.blocks.len();
-                voxel_world.blocks.clear();
+                let old_blocks_count = voxel_world.blocks().len();
+                voxel_world.clear();
                 info!(
                     "🧹 WASM: Cleared {} existing blocks from VoxelWorld data structure",
                     old_blocks_count
@@ -2924,61 +2926,54 @@ fn handle_world_state_received_events_wasm(
                     event.world_data.blocks.len()
                 );
 
-                for block_data in &event.world_data.blocks {
-                    voxel_world.blocks.insert(
-                        IVec3::new(block_data.x, block_data.y, block_data.z),
-                        block_data.block_type,
-                    );
-                }
+                voxel_world.replace_blocks(
+                    event
+                        .world_data
+                        .blocks
+                        .iter()
+                        .map(|block_data| {
+                            (
+                                IVec3::new(block_data.x, block_data.y, block_data.z),
+                                block_data.block_type,
+                            )
+                        })
+                        .collect(),
+                );
 
                 info!(
                     "✅ WASM: Loaded {} blocks into VoxelWorld data structure",
-                    voxel_world.blocks.len()
+                    voxel_world.blocks().len()
                 );
 
-                // Spawn visual blocks
-                info!(
-                    "🎨 WASM: Creating visual entities for {} blocks...",
-                    voxel_world.blocks.len()
+                // Render the world as chunk meshes, using the ones the world worker built
+                // alongside the decode when available
+                let chunk_meshes = match prebuilt_meshes.worlds.remove(&event.world_id) {
+                    Some(chunk_meshes) => chunk_meshes,
+                    None => {
+                        info!("🎨 WASM: No prebuilt chunk meshes, meshing on main thread");
+                        crate::world::chunk_mesh::build_world_meshes(voxel_world.blocks())
+                    }
+                };
+                let chunks: std::collections::HashSet<IVec3> = voxel_world
+                    .blocks()
+                    .keys()
+                    .map(|position| crate::world::chunk_mesh::chunk_of(*position))
+                    .collect();
+                let spawned_meshes = crate::world::chunk_mesh::apply_chunk_meshes(
+                    &mut commands,
+                    &mut meshes,
+                    &shared_materials,
+                    &mut meshed_chunks,
+                    voxel_world.blocks(),
+                    &chunks,
+                    chunk_meshes,
                 );
 
-                let mut spawned_blocks = 0;
-                for (pos, block_type) in voxel_world.blocks.iter() {
-                    let cube_mesh = meshes.add(Cuboid::new(
-                        crate::environment::CUBE_SIZE,
-                        crate::environment::CUBE_SIZE,
-                        crate::environment::CUBE_SIZE,
-                    ));
-
-                    let texture_path = match block_type {
-                        crate::environment::BlockType::Grass => "textures/grass.webp",
-                        crate::environment::BlockType::Dirt => "textures/dirt.webp",
-                        crate::environment::BlockType::Stone => "textures/stone.webp",
-                        crate::environment::BlockType::QuartzBlock => "textures/quartz_block.webp",
-                        crate::environment::BlockType::GlassPane => "textures/glass_pane.webp",
-                        crate::environment::BlockType::CyanTerracotta => {
-                            "textures/cyan_terracotta.webp"
-                        }
-                        crate::environment::BlockType::Water => "textures/water.webp",
-                    };
-
-                    let texture: Handle<Image> = asset_server.load(texture_path);
-                    let material = materials.add(StandardMaterial {
-                        base_color_texture: Some(texture),
-                        ..default()
-                    });
-
-                    commands.spawn((
-                        Mesh3d(cube_mesh),
-                        MeshMaterial3d(material),
-                        Transform::from_translation(pos.as_vec3()),
-                        crate::environment::VoxelBlock { position: *pos },
-                    ));
-
-                    spawned_blocks += 1;
-                }
-
-                info!("✅ WASM: Spawned {} visual block entities", spawned_blocks);
+                info!(
+                    "✅ WASM: Spawned {} chunk mesh entities for {} chunks",
+                    spawned_meshes,
+                    meshed_chunks.chunks.len()
+                );
 
                 // Load inventory
                 let old_inventory_items =
@@ -19,10 +19,35 @@ pub const MAX_VISIBLE_CHUNKS_WASM: usize = 100; // 10x10 chunk grid
 pub const MAX_BLOCKS_PER_CHUNK_DESKTOP: usize = 4096; // 16x16x16 blocks
 pub const MAX_BLOCKS_PER_CHUNK_WASM: usize = 2048; // 16x16x8 or 12x12x12 blocks
 
+/// Maximum number of 16x16x16 chunk meshes kept resident (mesh assets + GPU buffers).
+/// Visible chunks are columns, so this allows for a couple of vertical layers each;
+/// chunks beyond this are evicted least-recently-seen first and remeshed on return.
+pub const MAX_RESIDENT_CHUNK_MESHES_DESKTOP: usize = MAX_VISIBLE_CHUNKS_DESKTOP * 4;
+pub const MAX_RESIDENT_CHUNK_MESHES_WASM: usize = MAX_VISIBLE_CHUNKS_WASM * 2;
+
+/// Pooled scratch buffers for transient message decoding
+pub const MESSAGE_POOL_BUFFERS_DESKTOP: usize = 32;
+pub const MESSAGE_POOL_BUFFERS_WASM: usize = 8;
+
+/// Largest buffer kept in the message pool; bigger ones are freed after use
+pub const MESSAGE_POOL_MAX_BUFFER_BYTES: usize = 8 * 1024 * 1024;
+
+/// Capacity the MQTT read buffer may keep while idle after a large message
+pub const MAX_IDLE_READ_BUFFER_BYTES: usize = 256 * 1024;
+
 /// Render distance in blocks
 pub const RENDER_DISTANCE_DESKTOP: f32 = 320.0;
 pub const RENDER_DISTANCE_WASM: f32 = 160.0;
 
+/// Distance in blocks at which chunk meshes drop to 2x level of detail
+/// (4x and 8x start at twice and four times this distance)
+pub const LOD_DISTANCE_DESKTOP: f32 = 96.0;
+pub const LOD_DISTANCE_WASM: f32 = 48.0;
+
+/// Background chunk LOD mesh builds allowed in flight at once
+pub const MAX_LOD_BUILDS_DESKTOP: usize = 16;
+pub const MAX_LOD_BUILDS_WASM: usize = 4;
+
 /// Maximum number of entities that can be safely managed
 pub const MAX_ENTITIES_DESKTOP: usize = 10000;
 pub const MAX_ENTITIES_WASM: usize = 3000;
@@ -49,6 +74,9 @@ pub const MEMORY_WARNING_THRESHOLD_BYTES: f64 = 1_500_000_000.0;
 /// Critical memory usage threshold (1.8GB = 90% of 2GB WASM limit)
 pub const MEMORY_CRITICAL_THRESHOLD_BYTES: f64 = 1_800_000_000.0;
 
+/// Live allocations must drop below this (1.2GB) before memory pressure is lifted again
+pub const MEMORY_PRESSURE_RELEASE_BYTES: f64 = 1_200_000_000.0;
+
 /// Performance warning threshold (30fps = 33.33ms per frame)
 pub const FRAME_TIME_WARNING_THRESHOLD: f32 = 0.0333;
 
@@ -95,6 +123,24 @@ pub fn get_max_blocks_per_chunk() -> usize {
     }
 }
 
+/// Get maximum resident chunk meshes based on platform
+pub fn get_max_resident_chunk_meshes() -> usize {
+    if IS_WASM {
+        MAX_RESIDENT_CHUNK_MESHES_WASM
+    } else {
+        MAX_RESIDENT_CHUNK_MESHES_DESKTOP
+    }
+}
+
+/// Get the message buffer pool size based on platform
+pub fn get_message_pool_buffers() -> usize {
+    if IS_WASM {
+        MESSAGE_POOL_BUFFERS_WASM
+    } else {
+        MESSAGE_POOL_BUFFERS_DESKTOP
+    }
+}
+
 /// Get render distance based on platform
 pub fn get_render_distance() -> f32 {
     if IS_WASM {
@@ -104,6 +150,24 @@ pub fn get_render_distance() -> f32 {
     }
 }
 
+/// Get the distance at which chunk meshes start using reduced detail
+pub fn get_lod_distance() -> f32 {
+    if IS_WASM {
+        LOD_DISTANCE_WASM
+    } else {
+        LOD_DISTANCE_DESKTOP
+    }
+}
+
+/// Get the number of concurrent chunk LOD builds based on platform
+pub fn get_max_lod_builds() -> usize {
+    if IS_WASM {
+        MAX_LOD_BUILDS_WASM
+    } else {
+        MAX_LOD_BUILDS_DESKTOP
+    }
+}
+
 /// Get maximum entities based on platform
 pub fn get_max_entities() -> usize {
     if IS_WASM {
@@ -149,23 +213,79 @@ pub fn get_max_particles() -> usize {
     }
 }
 
-/// Check if memory usage is within safe limits (WASM only)
+/// Size of the wasm linear memory in bytes. It only ever grows, so this is the
+/// high-water mark of the heap rather than live usage.
 #[cfg(target_arch = "wasm32")]
-pub fn check_memory_usage() -> Result<(), String> {
-    // Note: Memory usage checking in WASM is limited
-    // For now, we'll use a conservative approach and assume memory is OK
-    // In the future, we can implement more sophisticated memory tracking
+pub fn wasm_heap_bytes() -> Option<usize> {
+    Some(core::arch::wasm32::memory_size::<0>() * 65536)
+}
 
-    // TODO: Implement proper memory usage checking when web_sys supports it
-    // The Performance Memory API is not widely available in web_sys yet
+/// Desktop has no single linear memory to report
+#[cfg(not(target_arch = "wasm32"))]
+pub fn wasm_heap_bytes() -> Option<usize> {
+    None
+}
 
-    Ok(()) // Conservative approach - assume memory is OK for now
+/// Bytes currently allocated on the wasm heap. Unlike [`wasm_heap_bytes`] this goes
+/// down again when memory is freed.
+#[cfg(target_arch = "wasm32")]
+pub fn live_heap_bytes() -> Option<usize> {
+    Some(live_heap::LIVE_BYTES.load(std::sync::atomic::Ordering::Relaxed))
 }
 
-/// Check if memory usage is within safe limits (Desktop - always OK)
+/// Desktop does not count allocations
 #[cfg(not(target_arch = "wasm32"))]
-pub fn check_memory_usage() -> Result<(), String> {
-    Ok(()) // Desktop has no hard memory limits
+pub fn live_heap_bytes() -> Option<usize> {
+    None
+}
+
+/// Global allocator for the web build that counts live bytes for [`live_heap_bytes`]
+#[cfg(target_arch = "wasm32")]
+mod live_heap {
+    use std::alloc::{GlobalAlloc, Layout, System};
+    use std::sync::atomic::{AtomicUsize, Ordering};
+
+    pub static LIVE_BYTES: AtomicUsize = AtomicUsize::new(0);
+
+    struct CountingAllocator;
+
+    unsafe impl GlobalAlloc for CountingAllocator {
+        unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+            let ptr = unsafe { System.alloc(layout) };
+            if !ptr.is_null() {
+                LIVE_BYTES.fetch_add(layout.size(), Ordering::Relaxed);
+            }
+            ptr
+        }
+
+        unsafe fn alloc_zeroed(&self, layout: Layout) -> *mut u8 {
+            let ptr = unsafe { System.alloc_zeroed(layout) };
+            if !ptr.is_null() {
+                LIVE_BYTES.fetch_add(layout.size(), Ordering::Relaxed);
+            }
+            ptr
+        }
+
+        unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+            unsafe { System.dealloc(ptr, layout) };
+            LIVE_BYTES.fetch_sub(layout.size(), Ordering::Relaxed);
+        }
+
+        unsafe fn realloc(&self, ptr: *mut u8, layout: Layout, new_size: usize) -> *mut u8 {
+            let new_ptr = unsafe { System.realloc(ptr, layout, new_size) };
+            if !new_ptr.is_null() {
+                if new_size >= layout.size() {
+                    LIVE_BYTES.fetch_add(new_size - layout.size(), Ordering::Relaxed);
+                } else {
+                    LIVE_BYTES.fetch_sub(layout.size() - new_size, Ordering::Relaxed);
+                }
+            }
+            new_ptr
+        }
+    }
+
+    #[global_allocator]
+    static GLOBAL: CountingAllocator = CountingAllocator;
 }
 
 /// Get quality level based on performance metrics
@@ -246,12 +366,19 @@ mod tests {
         assert!(MAX_ENTITIES_WASM < MAX_ENTITIES_DESKTOP);
         assert!(MAX_IOT_DEVICES_WASM < MAX_IOT_DEVICES_DESKTOP);
         assert!(MAX_PLAYER_AVATARS_WASM < MAX_PLAYER_AVATARS_DESKTOP);
+        assert!(MAX_RESIDENT_CHUNK_MESHES_WASM < MAX_RESIDENT_CHUNK_MESHES_DESKTOP);
+        assert!(MAX_RESIDENT_CHUNK_MESHES_WASM >= MAX_VISIBLE_CHUNKS_WASM);
+        assert!(MESSAGE_POOL_BUFFERS_WASM < MESSAGE_POOL_BUFFERS_DESKTOP);
+        assert!(LOD_DISTANCE_WASM < RENDER_DISTANCE_WASM);
+        assert!(LOD_DISTANCE_DESKTOP < RENDER_DISTANCE_DESKTOP);
+        assert!(MAX_LOD_BUILDS_WASM < MAX_LOD_BUILDS_DESKTOP);
     }
 
     #[test]
     fn test_memory_thresholds() {
         assert!(MEMORY_WARNING_THRESHOLD_BYTES < MEMORY_CRITICAL_THRESHOLD_BYTES);
         assert!(MEMORY_CRITICAL_THRESHOLD_BYTES < 2_000_000_000.0); // Less than 2GB
+        assert!(MEMORY_PRESSURE_RELEASE_BYTES < MEMORY_WARNING_THRESHOLD_BYTES);
     }
 
     #[test]
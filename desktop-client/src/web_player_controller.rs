@@ -234,7 +234,7 @@ fn enable_gravity_after_world_populated_web(
     voxel_world: Res<crate::environment::VoxelWorld>,
     mut camera_query: Query<(&mut Transform, &mut PlayerMovement), With<Camera>>,
 ) {
-    if voxel_world.blocks.is_empty() {
+    if voxel_world.blocks().is_empty() {
         return; // World not ready yet
     }
 
@@ -252,13 +252,13 @@ fn enable_gravity_after_world_populated_web(
             }
             info!(
                 "Web: Gravity initialized after world population ({} blocks)",
-                voxel_world.blocks.len()
+                voxel_world.blocks().len()
             );
             #[cfg(target_arch = "wasm32")]
             web_sys::console::log_1(
                 &format!(
                     "Web: Gravity initialized after world population ({} blocks)",
-                    voxel_world.blocks.len()
+                    voxel_world.blocks().len()
                 )
                 .into(),
             );
@@ -2,7 +2,7 @@ use bevy::prelude::*;
 use log::{error, info};
 use std::collections::VecDeque;
 
-use crate::environment::{BlockType, VoxelWorld};
+use crate::environment::{BlockType, VoxelSet, VoxelWorld};
 use crate::ui::main_menu::GameState;
 use crate::world::world_types::WorldMetadata;
 
@@ -149,8 +149,12 @@ impl Plugin for AsyncWorldCreationPlugin {
             .add_systems(
                 Update,
                 (
-                    handle_start_world_creation_events,
-                    process_world_creation_chunks,
+                    handle_start_world_creation_events
+                        .run_if(on_event::<StartWorldCreationEvent>)
+                        .in_set(VoxelSet::Replace),
+                    process_world_creation_chunks
+                        .run_if(|task: Res<WorldCreationTask>| task.is_active)
+                        .in_set(VoxelSet::Replace),
                     log_world_creation_progress,
                     handle_world_creation_completion,
                 ),
@@ -173,7 +177,7 @@ fn handle_start_world_creation_events(
         );
 
         // Clear existing world
-        voxel_world.blocks.clear();
+        voxel_world.clear();
         info!("🧹 Cleared existing voxel world for new world creation");
 
         // Create metadata
@@ -268,7 +272,7 @@ fn process_world_creation_chunks(
 
     // Process pending blocks first (from expanded wall commands)
     while let Some((pos, block_type)) = world_creation_task.pending_blocks.pop_front() {
-        voxel_world.blocks.insert(pos, block_type);
+        voxel_world.set_block(pos, block_type);
         world_creation_task.blocks_created += 1;
         blocks_processed_this_frame += 1;
 
@@ -287,7 +291,7 @@ fn process_world_creation_chunks(
                 z,
             } => {
                 let pos = bevy::math::IVec3::new(x, y, z);
-                voxel_world.blocks.insert(pos, block_type);
+                voxel_world.set_block(pos, block_type);
                 world_creation_task.blocks_created += 1;
                 blocks_processed_this_frame += 1;
                 if world_creation_task.blocks_created % 100 == 0 {
@@ -424,7 +428,7 @@ fn log_world_creation_progress(
 }
 
 /// Parse a template file into commands
-fn parse_template_file(template_path: &str) -> Result<Vec<TemplateCommand>, String> {
+pub fn parse_template_file(template_path: &str) -> Result<Vec<TemplateCommand>, String> {
     let content = std::fs::read_to_string(template_path)
         .map_err(|e| format!("Failed to read template file: {}", e))?;
 
@@ -0,0 +1,155 @@
+//! Block visuals that follow the voxel world
+//!
+//! Writers only change [`VoxelWorld`]; [`sync_block_visuals`] reads its change journal
+//! once the frame's edits are in and spawns, despawns or recolours the per-block entities,
+//! remeshing the chunks that are drawn as chunk meshes instead.
+
+use bevy::prelude::*;
+use std::collections::{HashMap, HashSet};
+
+use crate::environment::{BlockType, VoxelBlock, VoxelWorld, WorldChanges};
+
+/// Visual block entity per position, so a sync only looks at the positions named by the
+/// journal. Kept up to date by [`sync_block_visuals`], from its own spawns and despawns
+/// and from the block entities other systems add or remove.
+#[derive(Resource, Debug, Default)]
+pub struct BlockEntities {
+    by_position: HashMap<IVec3, Entity>,
+    positions: HashMap<Entity, IVec3>,
+}
+
+impl BlockEntities {
+    pub fn get(&self, position: IVec3) -> Option<Entity> {
+        self.by_position.get(&position).copied()
+    }
+
+    fn insert(&mut self, position: IVec3, entity: Entity) {
+        match self.by_position.insert(position, entity) {
+            Some(previous) if previous != entity => {
+                self.positions.remove(&previous);
+            }
+            _ => {}
+        }
+        self.positions.insert(entity, position);
+    }
+
+    fn remove(&mut self, entity: Entity) {
+        let Some(position) = self.positions.remove(&entity) else {
+            return;
+        };
+        if self.by_position.get(&position) == Some(&entity) {
+            self.by_position.remove(&position);
+        }
+    }
+}
+
+/// System to synchronize visual block entities with VoxelWorld data
+/// This ensures blocks added by queued edits, scripts or MCP get visual representation,
+/// and that removed or retyped blocks lose or change theirs.
+/// Only the edits journaled since the last sync are visited, through [`BlockEntities`]; a
+/// full diff against the world runs when the journal no longer reaches back that far.
+pub fn sync_block_visuals(
+    voxel_world: Res<VoxelWorld>,
+    mut synced_generation: Local<u64>,
+    mut block_entities: ResMut<BlockEntities>,
+    added_blocks: Query<(Entity, &VoxelBlock), Added<VoxelBlock>>,
+    mut removed_blocks: RemovedComponents<VoxelBlock>,
+    block_materials: Query<&MeshMaterial3d<StandardMaterial>, With<VoxelBlock>>,
+    mut commands: Commands,
+    mut meshes: ResMut<Assets<Mesh>>,
+    mut meshed_chunks: ResMut<super::chunk_mesh::MeshedChunks>,
+    shared_materials: Res<crate::shared_materials::SharedBlockMaterials>,
+) {
+    // Follow block entities spawned or despawned elsewhere (loaders, console, remote edits)
+    for entity in removed_blocks.read() {
+        block_entities.remove(entity);
+    }
+    for (entity, block) in added_blocks.iter() {
+        block_entities.insert(block.position, entity);
+    }
+
+    // Nothing to do until the world changes; keep the edits until the materials exist
+    if voxel_world.generation() == *synced_generation || shared_materials.materials.is_empty() {
+        return;
+    }
+
+    let (edited, stale): (Vec<IVec3>, _) = match voxel_world.changes_since(*synced_generation) {
+        WorldChanges::Edits(edits) => {
+            let edited: HashSet<IVec3> = edits.map(|edit| edit.position).collect();
+            let stale = meshed_chunks.chunks_touched(edited.iter().copied());
+            (edited.into_iter().collect(), stale)
+        }
+        WorldChanges::Resync => {
+            // Every position that has a block or a visual
+            let mut positions: HashSet<IVec3> = voxel_world.blocks().keys().copied().collect();
+            positions.extend(block_entities.by_position.keys().copied());
+            (
+                positions.into_iter().collect(),
+                meshed_chunks.stale_chunks(voxel_world.blocks()),
+            )
+        }
+    };
+    *synced_generation = voxel_world.generation();
+
+    if !stale.is_empty() {
+        super::chunk_mesh::remesh_chunks(
+            &mut commands,
+            &mut meshes,
+            &shared_materials,
+            &mut meshed_chunks,
+            voxel_world.blocks(),
+            &stale,
+        );
+        debug!("Remeshed {} edited chunks", stale.len());
+    }
+
+    // Despawn visuals whose block is gone, recolour the ones whose block changed type and
+    // create the missing ones, outside meshed chunks
+    let (mut created_visuals, mut removed_visuals, mut updated_visuals) = (0, 0, 0);
+    for position in edited {
+        let block_type: Option<BlockType> = voxel_world.blocks().get(&position).copied();
+        match (block_entities.get(position), block_type) {
+            (Some(entity), None) => {
+                commands.entity(entity).despawn();
+                block_entities.remove(entity);
+                removed_visuals += 1;
+            }
+            (Some(entity), Some(block_type)) => {
+                let expected = shared_materials
+                    .get_material(block_type)
+                    .unwrap_or_default();
+                if block_materials
+                    .get(entity)
+                    .is_ok_and(|material| material.0 != expected)
+                {
+                    commands.entity(entity).insert(MeshMaterial3d(expected));
+                    updated_visuals += 1;
+                }
+            }
+            (None, Some(block_type)) if !meshed_chunks.contains_block(position) => {
+                let entity = commands
+                    .spawn((
+                        Mesh3d(shared_materials.shared_mesh.clone()),
+                        MeshMaterial3d(
+                            shared_materials
+                                .get_material(block_type)
+                                .unwrap_or_default(),
+                        ),
+                        Transform::from_translation(position.as_vec3()),
+                        VoxelBlock { position },
+                    ))
+                    .id();
+                block_entities.insert(position, entity);
+                created_visuals += 1;
+            }
+            _ => {}
+        }
+    }
+
+    if created_visuals + removed_visuals + updated_visuals > 0 {
+        info!(
+            "Synced visual entities for VoxelWorld blocks: {} created, {} removed, {} updated",
+            created_visuals, removed_visuals, updated_visuals
+        );
+    }
+}
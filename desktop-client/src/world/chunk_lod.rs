@@ -0,0 +1,825 @@
+//! Level of detail for distant chunk meshes
+//!
+//! Chunks beyond `ChunkLodSettings::lod_distance` are meshed from a downsampled copy of
+//! their voxels: every 2x2x2, 4x4x4 or 8x8x8 cell becomes one cube of its most common
+//! block type. Downsampling works on a palette-compressed copy of the chunk, and LOD
+//! meshes are built on the async compute pool and swapped in when ready.
+//!
+//! Seams: a border face of a downsampled chunk is only culled when the full-detail
+//! blocks behind it are all opaque. Any level of detail of the neighbour renders those
+//! blocks solid, so chunks of different levels never leave cracks between them; where
+//! the neighbour is open, the border face acts as a skirt over the height difference.
+//!
+//! Only chunk meshes (`MeshedChunks`, used by the web client and the MCP bulk paths)
+//! have levels of detail. Blocks rendered as individual `VoxelBlock` entities, as in
+//! desktop worlds loaded from a save, are always drawn at full detail.
+
+use bevy::prelude::*;
+use bevy::tasks::{AsyncComputeTaskPool, Task, block_on, futures_lite::future};
+use std::collections::{HashMap, HashSet};
+
+use super::chunk_mesh::{
+    ChunkFingerprint, ChunkMeshData, FACES, MESH_CHUNK_SIZE, MeshedChunks, apply_chunk_meshes,
+    blocks_in_chunks, build_chunk_mesh, chunk_of, chunk_origin, face_hidden, fingerprint_of,
+    is_see_through, push_face, remesh_chunks,
+};
+use crate::environment::{BlockType, VoxelBlock, VoxelWorld};
+use crate::shared_materials::SharedBlockMaterials;
+use crate::wasm_limits::{get_lod_distance, get_max_lod_builds};
+
+/// Coarsest level of detail (8x downsampling)
+pub const MAX_LOD: u8 = 3;
+
+/// Number of level-of-detail steps, including full detail
+pub const LOD_LEVELS: usize = MAX_LOD as usize + 1;
+
+/// Fraction of a distance threshold a chunk must move past before its level changes,
+/// so chunks on a boundary do not flip back and forth
+const LOD_HYSTERESIS: f32 = 0.1;
+
+/// Blocks per cell edge at a level of detail
+pub fn lod_factor(lod: u8) -> i32 {
+    1 << lod
+}
+
+/// Level of detail for a chunk `distance` blocks from the camera. Level n starts at
+/// `lod_distance * 2^(n-1)`; `current` is kept while within the hysteresis band.
+pub fn select_lod(distance: f32, lod_distance: f32, current: u8) -> u8 {
+    let level = |distance: f32| -> u8 {
+        if distance < lod_distance {
+            0
+        } else {
+            let octaves = (distance / lod_distance).log2().floor();
+            octaves.min(MAX_LOD as f32 - 1.0) as u8 + 1
+        }
+    };
+    let coarser = level(distance * (1.0 - LOD_HYSTERESIS));
+    let finer = level(distance * (1.0 + LOD_HYSTERESIS));
+    current.clamp(coarser, finer)
+}
+
+/// Palette-compressed voxel grid of one chunk, or a downsampled copy of it
+#[derive(Debug, Clone, PartialEq)]
+pub struct ChunkPalette {
+    /// Cells per edge
+    size: i32,
+    palette: Vec<BlockType>,
+    /// Per cell: 0 for air, otherwise palette index + 1
+    cells: Vec<u8>,
+}
+
+impl ChunkPalette {
+    fn empty(size: i32) -> Self {
+        Self {
+            size,
+            palette: Vec::new(),
+            cells: vec![0; (size * size * size) as usize],
+        }
+    }
+
+    /// Palette grid of the blocks inside `chunk`
+    pub fn from_blocks(chunk: IVec3, blocks: &[(IVec3, BlockType)]) -> Self {
+        let origin = chunk * MESH_CHUNK_SIZE;
+        let mut grid = Self::empty(MESH_CHUNK_SIZE);
+        for &(position, block_type) in blocks {
+            grid.set(position - origin, block_type);
+        }
+        grid
+    }
+
+    pub fn size(&self) -> i32 {
+        self.size
+    }
+
+    fn index(&self, cell: IVec3) -> Option<usize> {
+        let in_bounds = cell.cmpge(IVec3::ZERO).all() && cell.cmplt(IVec3::splat(self.size)).all();
+        in_bounds.then(|| ((cell.x * self.size + cell.y) * self.size + cell.z) as usize)
+    }
+
+    /// Block at `cell`; `None` for air and outside the grid
+    pub fn get(&self, cell: IVec3) -> Option<BlockType> {
+        let entry = *self.cells.get(self.index(cell)?)?;
+        entry.checked_sub(1).map(|i| self.palette[i as usize])
+    }
+
+    fn set(&mut self, cell: IVec3, block_type: BlockType) {
+        let Some(index) = self.index(cell) else {
+            return;
+        };
+        let entry = match self.palette.iter().position(|&b| b == block_type) {
+            Some(entry) => entry,
+            None => {
+                self.palette.push(block_type);
+                self.palette.len() - 1
+            }
+        };
+        self.cells[index] = entry as u8 + 1;
+    }
+
+    /// Merge `factor`^3 cells into one holding their most common block type (ties go to
+    /// the type seen first). A merged cell is solid if any of its cells is.
+    pub fn downsample(&self, factor: i32) -> Self {
+        let size = (self.size / factor).max(1);
+        let mut coarse = Self {
+            palette: self.palette.clone(),
+            ..Self::empty(size)
+        };
+        let mut counts = vec![0u32; self.palette.len() + 1];
+        for x in 0..size {
+            for y in 0..size {
+                for z in 0..size {
+                    counts.fill(0);
+                    let base = IVec3::new(x, y, z) * factor;
+                    for dx in 0..factor {
+                        for dy in 0..factor {
+                            for dz in 0..factor {
+                                if let Some(index) = self.index(base + IVec3::new(dx, dy, dz)) {
+                                    counts[self.cells[index] as usize] += 1;
+                                }
+                            }
+                        }
+                    }
+                    let dominant = (1..counts.len())
+                        .filter(|&entry| counts[entry] > 0)
+                        .max_by_key(|&entry| (counts[entry], std::cmp::Reverse(entry)));
+                    if let Some(entry) = dominant {
+                        let index = coarse.index(IVec3::new(x, y, z)).unwrap();
+                        coarse.cells[index] = entry as u8;
+                    }
+                }
+            }
+        }
+        coarse
+    }
+}
+
+/// Whether the `factor` x `factor` slab of full-detail blocks just beyond a border
+/// face is completely opaque
+fn slab_is_opaque(
+    world: &HashMap<IVec3, BlockType>,
+    min: IVec3,
+    factor: i32,
+    offset: IVec3,
+) -> bool {
+    let max = min + IVec3::splat(factor - 1);
+    // The slab is one block thick, right outside the face, and spans the cell
+    let start = IVec3::select(offset.cmpgt(IVec3::ZERO), max + offset, min);
+    let start = IVec3::select(offset.cmplt(IVec3::ZERO), min + offset, start);
+    let extent = IVec3::select(offset.cmpeq(IVec3::ZERO), IVec3::splat(factor), IVec3::ONE);
+    for x in 0..extent.x {
+        for y in 0..extent.y {
+            for z in 0..extent.z {
+                match world.get(&(start + IVec3::new(x, y, z))) {
+                    Some(&block_type) if !is_see_through(block_type) => {}
+                    _ => return false,
+                }
+            }
+        }
+    }
+    true
+}
+
+/// Build the downsampled meshes of a chunk at `lod` (at least 1).
+///
+/// `world` must hold the blocks around the chunk; it is only used for border faces.
+pub fn build_lod_mesh(
+    chunk: IVec3,
+    grid: &ChunkPalette,
+    world: &HashMap<IVec3, BlockType>,
+    lod: u8,
+) -> Vec<ChunkMeshData> {
+    let factor = lod_factor(lod);
+    let coarse = grid.downsample(factor);
+    let origin = chunk * MESH_CHUNK_SIZE;
+    let size = factor as f32 * crate::environment::CUBE_SIZE;
+    let mut by_material = Vec::new();
+
+    for x in 0..coarse.size() {
+        for y in 0..coarse.size() {
+            for z in 0..coarse.size() {
+                let cell = IVec3::new(x, y, z);
+                let Some(block_type) = coarse.get(cell) else {
+                    continue;
+                };
+                // Cell spans blocks cell * factor ..= cell * factor + factor - 1
+                let centre = (cell * factor).as_vec3() + Vec3::splat((factor - 1) as f32 / 2.0);
+                for (offset, normal, corners) in FACES {
+                    let neighbour = cell + offset;
+                    let hidden = if coarse.index(neighbour).is_some() {
+                        face_hidden(block_type, coarse.get(neighbour).as_ref())
+                    } else {
+                        slab_is_opaque(world, origin + cell * factor, factor, offset)
+                    };
+                    if !hidden {
+                        push_face(
+                            &mut by_material,
+                            (chunk, lod),
+                            block_type,
+                            centre,
+                            size,
+                            normal,
+                            corners,
+                        );
+                    }
+                }
+            }
+        }
+    }
+    by_material
+}
+
+/// Build the meshes of one chunk at a level of detail (0 is full detail)
+pub fn build_chunk_lod_mesh(
+    chunk: IVec3,
+    chunk_blocks: &[(IVec3, BlockType)],
+    world: &HashMap<IVec3, BlockType>,
+    lod: u8,
+) -> Vec<ChunkMeshData> {
+    if lod == 0 {
+        build_chunk_mesh(chunk, chunk_blocks, world)
+    } else {
+        let grid = ChunkPalette::from_blocks(chunk, chunk_blocks);
+        build_lod_mesh(chunk, &grid, world, lod)
+    }
+}
+
+/// Blocks of a chunk and the one-block shell around it, enough to mesh the chunk at
+/// any level of detail without the rest of the world
+fn chunk_neighbourhood(
+    world: &HashMap<IVec3, BlockType>,
+    chunk: IVec3,
+) -> HashMap<IVec3, BlockType> {
+    let min = chunk * MESH_CHUNK_SIZE - IVec3::ONE;
+    let edge = MESH_CHUNK_SIZE + 2;
+    let mut neighbourhood = HashMap::new();
+    for x in 0..edge {
+        for y in 0..edge {
+            for z in 0..edge {
+                let position = min + IVec3::new(x, y, z);
+                if let Some(block_type) = world.get(&position) {
+                    neighbourhood.insert(position, *block_type);
+                }
+            }
+        }
+    }
+    neighbourhood
+}
+
+/// Level-of-detail configuration
+#[derive(Resource, Debug, Clone)]
+pub struct ChunkLodSettings {
+    pub enabled: bool,
+    /// Distance in blocks at which chunks drop to 2x detail; 4x and 8x start at
+    /// twice and four times this distance
+    pub lod_distance: f32,
+    /// Background mesh builds allowed in flight at once
+    pub max_builds: usize,
+}
+
+impl Default for ChunkLodSettings {
+    fn default() -> Self {
+        Self {
+            enabled: true,
+            lod_distance: get_lod_distance(),
+            max_builds: get_max_lod_builds(),
+        }
+    }
+}
+
+/// A chunk mesh being rebuilt at another level of detail
+struct LodBuild {
+    fingerprint: ChunkFingerprint,
+    task: Task<Vec<ChunkMeshData>>,
+}
+
+#[derive(Resource)]
+pub struct ChunkLodState {
+    timer: Timer,
+    builds: HashMap<IVec3, LodBuild>,
+}
+
+impl Default for ChunkLodState {
+    fn default() -> Self {
+        Self {
+            timer: Timer::from_seconds(0.25, TimerMode::Repeating),
+            builds: HashMap::new(),
+        }
+    }
+}
+
+impl ChunkLodState {
+    pub fn pending_builds(&self) -> usize {
+        self.builds.len()
+    }
+}
+
+/// Resident chunk meshes and their triangles per level of detail
+#[derive(Resource, Debug, Default, Clone)]
+pub struct ChunkLodStats {
+    pub chunks: [usize; LOD_LEVELS],
+    pub triangles: [usize; LOD_LEVELS],
+    pub pending_builds: usize,
+    pub completed_builds: u64,
+    /// Result of the last `lod bench` run
+    pub last_benchmark: Option<String>,
+}
+
+impl ChunkLodStats {
+    pub fn total_triangles(&self) -> usize {
+        self.triangles.iter().sum()
+    }
+
+    /// Human readable summary for the console
+    pub fn report(&self, settings: &ChunkLodSettings) -> String {
+        let mut lines = vec![format!(
+            "LOD {} (2x from {:.0} blocks), {} builds pending, {} completed",
+            if settings.enabled { "on" } else { "off" },
+            settings.lod_distance,
+            self.pending_builds,
+            self.completed_builds
+        )];
+        for lod in 0..LOD_LEVELS {
+            lines.push(format!(
+                "  {}x: {} chunks, {} triangles",
+                lod_factor(lod as u8),
+                self.chunks[lod],
+                self.triangles[lod]
+            ));
+        }
+        if let Some(benchmark) = &self.last_benchmark {
+            lines.push(benchmark.clone());
+        }
+        lines.join("\n")
+    }
+}
+
+/// Plugin that renders distant chunk meshes at reduced detail
+pub struct ChunkLodPlugin;
+
+impl Plugin for ChunkLodPlugin {
+    fn build(&self, app: &mut App) {
+        app.init_resource::<ChunkLodSettings>()
+            .init_resource::<ChunkLodState>()
+            .init_resource::<ChunkLodStats>()
+            .init_resource::<LodBenchmark>()
+            .add_systems(Update, (update_chunk_lods, run_lod_benchmark).chain());
+    }
+}
+
+fn update_chunk_lods(
+    time: Res<Time>,
+    settings: Res<ChunkLodSettings>,
+    mut state: ResMut<ChunkLodState>,
+    mut stats: ResMut<ChunkLodStats>,
+    mut meshed_chunks: ResMut<MeshedChunks>,
+    voxel_world: Res<VoxelWorld>,
+    shared_materials: Option<Res<SharedBlockMaterials>>,
+    camera_query: Query<&GlobalTransform, With<Camera3d>>,
+    mut commands: Commands,
+    mut meshes: ResMut<Assets<Mesh>>,
+) {
+    let Some(materials) = shared_materials.as_deref() else {
+        return;
+    };
+
+    // Swap in finished builds, unless the chunk was edited, evicted or dropped meanwhile
+    let mut finished = Vec::new();
+    for (chunk, build) in state.builds.iter_mut() {
+        if let Some(chunk_meshes) = block_on(future::poll_once(&mut build.task)) {
+            finished.push((*chunk, build.fingerprint, chunk_meshes));
+        }
+    }
+    let mut swapped = HashSet::new();
+    let mut swapped_meshes = Vec::new();
+    for (chunk, fingerprint, chunk_meshes) in finished {
+        state.builds.remove(&chunk);
+        stats.completed_builds += 1;
+        if meshed_chunks.chunks.get(&chunk).is_some_and(|m| !m.evicted) {
+            swapped.insert(chunk);
+            swapped_meshes.push((chunk, fingerprint, chunk_meshes));
+        }
+    }
+    if !swapped.is_empty() {
+        let current = blocks_in_chunks(voxel_world.blocks(), &swapped);
+        let mut chunks = HashSet::new();
+        let mut chunk_meshes = Vec::new();
+        for (chunk, fingerprint, built) in swapped_meshes {
+            let blocks = current.get(&chunk).map(Vec::as_slice).unwrap_or_default();
+            if fingerprint_of(blocks) == fingerprint {
+                chunks.insert(chunk);
+                chunk_meshes.extend(built);
+            }
+        }
+        apply_chunk_meshes(
+            &mut commands,
+            &mut meshes,
+            materials,
+            &mut meshed_chunks,
+            voxel_world.blocks(),
+            &chunks,
+            chunk_meshes,
+        );
+    }
+
+    if !state.timer.tick(time.delta()).just_finished() {
+        return;
+    }
+
+    stats.chunks = [0; LOD_LEVELS];
+    stats.triangles = [0; LOD_LEVELS];
+    for meshed in meshed_chunks.chunks.values().filter(|m| !m.evicted) {
+        let lod = (meshed.lod as usize).min(MAX_LOD as usize);
+        stats.chunks[lod] += 1;
+        stats.triangles[lod] += meshed.triangles;
+    }
+
+    let Ok(camera) = camera_query.single() else {
+        stats.pending_builds = state.builds.len();
+        return;
+    };
+    let camera = camera.translation();
+    let half_chunk = Vec3::splat(MESH_CHUNK_SIZE as f32 / 2.0);
+
+    // Chunks without visible faces stay meshless; they would only gain border faces
+    let mut wanted: Vec<(f32, IVec3, u8)> = meshed_chunks
+        .chunks
+        .iter()
+        .filter(|(chunk, meshed)| {
+            !meshed.evicted
+                && (meshed.triangles > 0 || meshed.lod > 0)
+                && !state.builds.contains_key(*chunk)
+        })
+        .filter_map(|(chunk, meshed)| {
+            let distance = camera.distance(chunk_origin(*chunk) + half_chunk);
+            let lod = if settings.enabled {
+                select_lod(distance, settings.lod_distance, meshed.lod)
+            } else {
+                0
+            };
+            (lod != meshed.lod).then_some((distance, *chunk, lod))
+        })
+        .collect();
+    // Nearest first: refining what is close to the player matters most
+    wanted.sort_by(|a, b| a.0.total_cmp(&b.0));
+
+    let pool = AsyncComputeTaskPool::get();
+    let free = settings.max_builds.saturating_sub(state.builds.len());
+    for (_, chunk, lod) in wanted.into_iter().take(free) {
+        let neighbourhood = chunk_neighbourhood(voxel_world.blocks(), chunk);
+        let origin = chunk * MESH_CHUNK_SIZE;
+        let blocks: Vec<(IVec3, BlockType)> = neighbourhood
+            .iter()
+            .filter(|(position, _)| {
+                let local = **position - origin;
+                local.cmpge(IVec3::ZERO).all() && local.cmplt(IVec3::splat(MESH_CHUNK_SIZE)).all()
+            })
+            .map(|(position, block_type)| (*position, *block_type))
+            .collect();
+        let fingerprint = fingerprint_of(&blocks);
+        let task =
+            pool.spawn(async move { build_chunk_lod_mesh(chunk, &blocks, &neighbourhood, lod) });
+        state.builds.insert(chunk, LodBuild { fingerprint, task });
+    }
+    stats.pending_builds = state.builds.len();
+}
+
+/// Frames measured per benchmark pass
+const BENCHMARK_FRAMES: u32 = 240;
+
+/// Frames without pending LOD builds before a benchmark pass starts measuring
+const BENCHMARK_SETTLE_FRAMES: u32 = 60;
+
+#[derive(Debug, Default, Clone, Copy, PartialEq)]
+enum BenchmarkPhase {
+    #[default]
+    Idle,
+    Setup,
+    Settle {
+        lod: bool,
+    },
+    Measure {
+        lod: bool,
+    },
+}
+
+/// What the benchmark replaced, put back when it finishes
+#[derive(Debug)]
+struct SavedScene {
+    blocks: HashMap<IVec3, BlockType>,
+    /// Chunks that were rendered as chunk meshes; the other blocks had `VoxelBlock`
+    /// entities
+    meshed: HashSet<IVec3>,
+    camera: Option<Transform>,
+    lod_enabled: bool,
+}
+
+/// Benchmark scene comparing full-detail and LOD rendering of a large terrain seen
+/// from above, started with the `lod bench [radius]` console command. The player's
+/// world is set aside while it runs and restored afterwards.
+#[derive(Resource, Debug, Default)]
+pub struct LodBenchmark {
+    phase: BenchmarkPhase,
+    /// Terrain radius in chunks
+    radius: i32,
+    frames: u32,
+    frame_seconds: f64,
+    full_detail: Option<(f64, usize)>,
+    saved: Option<SavedScene>,
+}
+
+impl LodBenchmark {
+    pub fn start(&mut self, radius: i32) {
+        *self = Self {
+            phase: BenchmarkPhase::Setup,
+            radius: radius.clamp(1, 32),
+            ..default()
+        };
+    }
+
+    pub fn is_running(&self) -> bool {
+        self.phase != BenchmarkPhase::Idle
+    }
+}
+
+/// Rolling hills with a water level, `radius` chunks around the origin
+pub fn benchmark_terrain(radius: i32) -> HashMap<IVec3, BlockType> {
+    const WATER_LEVEL: i32 = 9;
+    let extent = radius * MESH_CHUNK_SIZE;
+    let mut world = HashMap::new();
+    for x in -extent..extent {
+        for z in -extent..extent {
+            let (fx, fz) = (x as f32, z as f32);
+            let height = 12.0
+                + 4.0 * (fx * 0.045).sin()
+                + 3.0 * (fz * 0.06).cos()
+                + 2.0 * ((fx + fz) * 0.021).sin();
+            let height = height as i32;
+            world.insert(IVec3::new(x, height, z), BlockType::Grass);
+            world.insert(IVec3::new(x, height - 1, z), BlockType::Dirt);
+            world.insert(IVec3::new(x, height - 2, z), BlockType::Stone);
+            for y in height + 1..=WATER_LEVEL {
+                world.insert(IVec3::new(x, y, z), BlockType::Water);
+            }
+        }
+    }
+    world
+}
+
+/// Put the world from before the benchmark back, respawning `VoxelBlock` entities for
+/// blocks outside the chunks that were meshed
+fn restore_world(
+    saved: SavedScene,
+    commands: &mut Commands,
+    meshes: &mut Assets<Mesh>,
+    materials: &SharedBlockMaterials,
+    meshed_chunks: &mut MeshedChunks,
+    voxel_world: &mut VoxelWorld,
+) {
+    meshed_chunks.clear(commands);
+    voxel_world.replace_blocks(saved.blocks);
+    remesh_chunks(
+        commands,
+        meshes,
+        materials,
+        meshed_chunks,
+        voxel_world.blocks(),
+        &saved.meshed,
+    );
+    for (position, block_type) in voxel_world.blocks().iter() {
+        if meshed_chunks.contains_block(*position) {
+            continue;
+        }
+        commands.spawn((
+            Mesh3d(materials.shared_mesh.clone()),
+            MeshMaterial3d(materials.get_material(*block_type).unwrap_or_default()),
+            Transform::from_translation(position.as_vec3()),
+            VoxelBlock {
+                position: *position,
+            },
+        ));
+    }
+}
+
+pub fn run_lod_benchmark(
+    mut benchmark: ResMut<LodBenchmark>,
+    mut settings: ResMut<ChunkLodSettings>,
+    mut stats: ResMut<ChunkLodStats>,
+    state: Res<ChunkLodState>,
+    time: Res<Time<Real>>,
+    mut voxel_world: ResMut<VoxelWorld>,
+    mut meshed_chunks: ResMut<MeshedChunks>,
+    shared_materials: Option<Res<SharedBlockMaterials>>,
+    block_entities: Query<Entity, With<VoxelBlock>>,
+    mut camera_query: Query<&mut Transform, With<Camera3d>>,
+    mut commands: Commands,
+    mut meshes: ResMut<Assets<Mesh>>,
+) {
+    match benchmark.phase {
+        BenchmarkPhase::Idle => {}
+        BenchmarkPhase::Setup => {
+            let Some(materials) = shared_materials.as_deref() else {
+                return;
+            };
+            benchmark.saved = Some(SavedScene {
+                blocks: voxel_world.blocks().clone(),
+                meshed: meshed_chunks.chunks.keys().copied().collect(),
+                camera: camera_query.single().ok().copied(),
+                lod_enabled: settings.enabled,
+            });
+
+            for entity in block_entities.iter() {
+                commands.entity(entity).despawn();
+            }
+            meshed_chunks.clear(&mut commands);
+            voxel_world.replace_blocks(benchmark_terrain(benchmark.radius));
+            let chunks: HashSet<IVec3> = voxel_world
+                .blocks()
+                .keys()
+                .map(|position| chunk_of(*position))
+                .collect();
+            remesh_chunks(
+                &mut commands,
+                &mut meshes,
+                materials,
+                &mut meshed_chunks,
+                voxel_world.blocks(),
+                &chunks,
+            );
+
+            // Look across the terrain towards the far corner
+            let far = (benchmark.radius * MESH_CHUNK_SIZE) as f32;
+            if let Ok(mut camera) = camera_query.single_mut() {
+                *camera = Transform::from_xyz(-far * 0.5, 48.0, -far * 0.5)
+                    .looking_at(Vec3::new(far, 0.0, far), Vec3::Y);
+            }
+
+            info!(
+                "LOD benchmark: {} blocks in {} chunks, measuring full detail",
+                voxel_world.blocks().len(),
+                chunks.len()
+            );
+            settings.enabled = false;
+            benchmark.phase = BenchmarkPhase::Settle { lod: false };
+            benchmark.frames = 0;
+        }
+        BenchmarkPhase::Settle { lod } => {
+            if state.pending_builds() > 0 {
+                benchmark.frames = 0;
+                return;
+            }
+            benchmark.frames += 1;
+            if benchmark.frames >= BENCHMARK_SETTLE_FRAMES {
+                benchmark.phase = BenchmarkPhase::Measure { lod };
+                benchmark.frames = 0;
+                benchmark.frame_seconds = 0.0;
+            }
+        }
+        BenchmarkPhase::Measure { lod } => {
+            benchmark.frames += 1;
+            benchmark.frame_seconds += time.delta_secs_f64();
+            if benchmark.frames < BENCHMARK_FRAMES {
+                return;
+            }
+
+            let ms_per_frame = benchmark.frame_seconds * 1000.0 / benchmark.frames as f64;
+            let triangles = stats.total_triangles();
+            if !lod {
+                benchmark.full_detail = Some((ms_per_frame, triangles));
+                settings.enabled = true;
+                benchmark.phase = BenchmarkPhase::Settle { lod: true };
+                benchmark.frames = 0;
+                return;
+            }
+
+            let (full_ms, full_triangles) = benchmark.full_detail.unwrap_or_default();
+            let report = format!(
+                "LOD benchmark ({} chunk radius, chunk meshes only): full detail {} triangles, \
+                 {:.2} ms/frame; LOD {} triangles ({:.0}% fewer), {:.2} ms/frame",
+                benchmark.radius,
+                full_triangles,
+                full_ms,
+                triangles,
+                100.0 * (1.0 - triangles as f64 / full_triangles.max(1) as f64),
+                ms_per_frame
+            );
+            info!("{}", report);
+            #[cfg(target_arch = "wasm32")]
+            web_sys::console::log_1(&report.clone().into());
+            stats.last_benchmark = Some(report);
+            benchmark.phase = BenchmarkPhase::Idle;
+
+            if let (Some(saved), Some(materials)) =
+                (benchmark.saved.take(), shared_materials.as_deref())
+            {
+                for entity in block_entities.iter() {
+                    commands.entity(entity).despawn();
+                }
+                if let (Ok(mut camera), Some(transform)) = (camera_query.single_mut(), saved.camera)
+                {
+                    *camera = transform;
+                }
+                settings.enabled = saved.lod_enabled;
+                restore_world(
+                    saved,
+                    &mut commands,
+                    &mut meshes,
+                    materials,
+                    &mut meshed_chunks,
+                    &mut voxel_world,
+                );
+                info!("LOD benchmark: restored the previous world");
+            }
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn solid_cube(size: i32, block_type: BlockType) -> HashMap<IVec3, BlockType> {
+        let mut world = HashMap::new();
+        for x in 0..size {
+            for y in 0..size {
+                for z in 0..size {
+                    world.insert(IVec3::new(x, y, z), block_type);
+                }
+            }
+        }
+        world
+    }
+
+    fn triangles(meshes: &[ChunkMeshData]) -> usize {
+        meshes.iter().map(ChunkMeshData::triangle_count).sum()
+    }
+
+    #[test]
+    fn test_select_lod_thresholds_and_hysteresis() {
+        assert_eq!(select_lod(50.0, 100.0, 0), 0);
+        assert_eq!(select_lod(150.0, 100.0, 0), 1);
+        assert_eq!(select_lod(250.0, 100.0, 0), 2);
+        assert_eq!(select_lod(1000.0, 100.0, 0), MAX_LOD);
+        // Just past a threshold keeps the current level in either direction
+        assert_eq!(select_lod(105.0, 100.0, 0), 0);
+        assert_eq!(select_lod(95.0, 100.0, 1), 1);
+        assert_eq!(select_lod(85.0, 100.0, 1), 0);
+    }
+
+    #[test]
+    fn test_palette_downsample_picks_dominant_type() {
+        let mut blocks: Vec<(IVec3, BlockType)> =
+            solid_cube(2, BlockType::Stone).into_iter().collect();
+        blocks.retain(|(p, _)| *p != IVec3::ZERO);
+        blocks.push((IVec3::ZERO, BlockType::Grass));
+        // A lone block in another cell still makes that cell solid
+        blocks.push((IVec3::new(5, 5, 5), BlockType::Dirt));
+
+        let grid = ChunkPalette::from_blocks(IVec3::ZERO, &blocks);
+        assert_eq!(grid.get(IVec3::ZERO), Some(BlockType::Grass));
+        let coarse = grid.downsample(2);
+        assert_eq!(coarse.size(), MESH_CHUNK_SIZE / 2);
+        assert_eq!(coarse.get(IVec3::ZERO), Some(BlockType::Stone));
+        assert_eq!(coarse.get(IVec3::new(2, 2, 2)), Some(BlockType::Dirt));
+        assert_eq!(coarse.get(IVec3::new(1, 0, 0)), None);
+    }
+
+    #[test]
+    fn test_lod_mesh_reduces_triangles() {
+        // A chunk-sized slab of terrain, alone in the world
+        let mut world = HashMap::new();
+        for x in 0..MESH_CHUNK_SIZE {
+            for z in 0..MESH_CHUNK_SIZE {
+                world.insert(IVec3::new(x, 0, z), BlockType::Grass);
+            }
+        }
+        let blocks: Vec<_> = world.iter().map(|(p, b)| (*p, *b)).collect();
+        let full = triangles(&build_chunk_lod_mesh(IVec3::ZERO, &blocks, &world, 0));
+        let half = build_chunk_lod_mesh(IVec3::ZERO, &blocks, &world, 1);
+        assert!(half.iter().all(|m| m.lod == 1));
+        // Top and bottom 8x8 faces plus 8 border faces per side
+        assert_eq!(triangles(&half), 2 * (2 * 64 + 4 * 8));
+        assert!(triangles(&half) < full / 3);
+        let coarsest = triangles(&build_chunk_lod_mesh(IVec3::ZERO, &blocks, &world, MAX_LOD));
+        assert_eq!(coarsest, 2 * (2 * 4 + 4 * 2));
+    }
+
+    #[test]
+    fn test_lod_border_faces_culled_only_against_opaque_blocks() {
+        // Two solid chunks side by side: the shared border is fully opaque
+        let mut world = solid_cube(MESH_CHUNK_SIZE, BlockType::Stone);
+        for (position, block_type) in solid_cube(MESH_CHUNK_SIZE, BlockType::Stone) {
+            world.insert(position + IVec3::X * MESH_CHUNK_SIZE, block_type);
+        }
+        let blocks: Vec<_> = solid_cube(MESH_CHUNK_SIZE, BlockType::Stone)
+            .into_iter()
+            .collect();
+        let meshes = build_chunk_lod_mesh(IVec3::ZERO, &blocks, &world, 1);
+        // Five open sides of 8x8 faces; the side towards the neighbour is culled
+        assert_eq!(triangles(&meshes), 2 * 5 * 64);
+
+        // Glass in the neighbour keeps the border faces
+        world.insert(IVec3::new(MESH_CHUNK_SIZE, 0, 0), BlockType::GlassPane);
+        let meshes = build_chunk_lod_mesh(IVec3::ZERO, &blocks, &world, 1);
+        assert_eq!(triangles(&meshes), 2 * 5 * 64 + 2);
+    }
+}
@@ -0,0 +1,670 @@
+//! Chunk mesh building for the voxel world
+//!
+//! Instead of one entity per block, blocks are grouped into 16x16x16 chunks. All
+//! opaque blocks of a chunk share one mesh drawn with the block texture atlas, so a
+//! chunk mixing block types is a single draw; translucent blocks get one mesh per type
+//! with their own blended material. Faces between two solid blocks are culled. The
+//! builder works on plain vectors and has no ECS dependency, so it can run off the
+//! main thread (e.g. in the web worker).
+
+use bevy::asset::RenderAssetUsages;
+use bevy::mesh::{Indices, PrimitiveTopology};
+use bevy::prelude::*;
+use std::collections::{HashMap, HashSet};
+
+use super::chunk_lod::build_chunk_lod_mesh;
+use crate::environment::{BlockType, CUBE_SIZE};
+use crate::shared_materials::{SharedBlockMaterials, atlas_uv, is_translucent};
+
+/// Edge length of a mesh chunk in blocks
+pub const MESH_CHUNK_SIZE: i32 = 16;
+
+/// Chunk coordinate containing a block position
+pub fn chunk_of(position: IVec3) -> IVec3 {
+    position.div_euclid(IVec3::splat(MESH_CHUNK_SIZE))
+}
+
+/// World-space origin of a chunk (the transform of its mesh entity)
+pub fn chunk_origin(chunk: IVec3) -> Vec3 {
+    (chunk * MESH_CHUNK_SIZE).as_vec3()
+}
+
+/// Component on entities that render a chunk mesh
+#[derive(Component, Debug, Clone, Copy, PartialEq, Eq)]
+pub struct ChunkMesh {
+    pub chunk: IVec3,
+    /// `None` for the chunk's atlas-textured opaque mesh
+    pub block_type: Option<BlockType>,
+}
+
+/// Order-independent summary of a chunk's blocks, used to notice edits without a diff
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct ChunkFingerprint {
+    pub block_count: usize,
+    pub hash: u64,
+}
+
+impl ChunkFingerprint {
+    pub fn add(&mut self, position: IVec3, block_type: BlockType) {
+        self.block_count += 1;
+        self.hash = self.hash.wrapping_add(block_hash(position, block_type));
+    }
+}
+
+/// splitmix64 finaliser over the packed position and type
+fn block_hash(position: IVec3, block_type: BlockType) -> u64 {
+    fn mix(mut x: u64) -> u64 {
+        x = (x ^ (x >> 30)).wrapping_mul(0xbf58_476d_1ce4_e5b9);
+        x = (x ^ (x >> 27)).wrapping_mul(0x94d0_49bb_1331_11eb);
+        x ^ (x >> 31)
+    }
+    let xy = position.x as u32 as u64 | (position.y as u32 as u64) << 32;
+    let z_type = position.z as u32 as u64 | (block_type.index() as u64) << 32;
+    mix(mix(xy) ^ z_type)
+}
+
+/// Fingerprints of the chunks accepted by `filter`
+pub fn chunk_fingerprints(
+    world: &HashMap<IVec3, BlockType>,
+    filter: impl Fn(&IVec3) -> bool,
+) -> HashMap<IVec3, ChunkFingerprint> {
+    let mut fingerprints: HashMap<IVec3, ChunkFingerprint> = HashMap::new();
+    for (position, block_type) in world {
+        let chunk = chunk_of(*position);
+        if filter(&chunk) {
+            fingerprints
+                .entry(chunk)
+                .or_default()
+                .add(*position, *block_type);
+        }
+    }
+    fingerprints
+}
+
+/// A chunk rendered through chunk meshes rather than per-block entities
+#[derive(Debug, Clone, Default)]
+pub struct MeshedChunk {
+    pub entities: Vec<Entity>,
+    pub fingerprint: ChunkFingerprint,
+    /// Approximate size of the chunk's mesh buffers
+    pub mesh_bytes: usize,
+    /// Memory governor tick at which the chunk was last within render distance
+    pub last_used: u64,
+    /// Mesh dropped by the memory governor; rebuilt when the player comes back
+    pub evicted: bool,
+    /// Level of detail of the current mesh (see `chunk_lod`)
+    pub lod: u8,
+    pub triangles: usize,
+}
+
+/// Chunks currently rendered as chunk meshes. Blocks inside them get no `VoxelBlock`
+/// entity; edits are picked up by comparing fingerprints and remeshing the chunk.
+#[derive(Resource, Debug, Default)]
+pub struct MeshedChunks {
+    pub chunks: HashMap<IVec3, MeshedChunk>,
+}
+
+impl MeshedChunks {
+    pub fn contains_block(&self, position: IVec3) -> bool {
+        self.chunks.contains_key(&chunk_of(position))
+    }
+
+    /// Meshed chunks whose blocks changed since they were meshed, plus their meshed
+    /// neighbours (whose border faces may have been uncovered or hidden)
+    pub fn stale_chunks(&self, world: &HashMap<IVec3, BlockType>) -> HashSet<IVec3> {
+        // Evicted chunks are rebuilt from the current world when restored anyway
+        let is_resident = |chunk: &IVec3| self.chunks.get(chunk).is_some_and(|m| !m.evicted);
+        let current = chunk_fingerprints(world, is_resident);
+        let mut stale = HashSet::new();
+        for (chunk, meshed) in &self.chunks {
+            if meshed.evicted {
+                continue;
+            }
+            if current.get(chunk).copied().unwrap_or_default() != meshed.fingerprint {
+                stale.insert(*chunk);
+                for (offset, _, _) in FACES {
+                    if is_resident(&(*chunk + offset)) {
+                        stale.insert(*chunk + offset);
+                    }
+                }
+            }
+        }
+        stale
+    }
+
+    /// Resident meshed chunks containing or bordering the given edited positions: the
+    /// journal-driven counterpart of [`stale_chunks`](Self::stale_chunks), which has to
+    /// fingerprint the whole world
+    pub fn chunks_touched(&self, positions: impl IntoIterator<Item = IVec3>) -> HashSet<IVec3> {
+        let mut touched = HashSet::new();
+        for position in positions {
+            let chunk = chunk_of(position);
+            for candidate in std::iter::once(chunk).chain(FACES.iter().map(|f| chunk + f.0)) {
+                if self.chunks.get(&candidate).is_some_and(|m| !m.evicted) {
+                    touched.insert(candidate);
+                }
+            }
+        }
+        touched
+    }
+
+    /// Drop the mesh entities of a chunk but keep tracking it, so its blocks still
+    /// do not get per-block entities
+    pub fn evict(&mut self, commands: &mut Commands, chunk: IVec3) {
+        if let Some(meshed) = self.chunks.get_mut(&chunk) {
+            for entity in meshed.entities.drain(..) {
+                commands.entity(entity).despawn();
+            }
+            meshed.mesh_bytes = 0;
+            meshed.evicted = true;
+        }
+    }
+
+    /// Despawn every chunk mesh entity and forget all chunks
+    pub fn clear(&mut self, commands: &mut Commands) {
+        for (_, chunk) in self.chunks.drain() {
+            for entity in chunk.entities {
+                commands.entity(entity).despawn();
+            }
+        }
+    }
+}
+
+/// Chunk meshes built ahead of time (by the web world worker), keyed by world id
+#[derive(Resource, Debug, Default)]
+pub struct PrebuiltChunkMeshes {
+    pub worlds: HashMap<String, Vec<ChunkMeshData>>,
+}
+
+/// Mesh buffers for one material within one chunk, in chunk-local coordinates
+#[derive(Debug, Clone, Default, PartialEq)]
+pub struct ChunkMeshData {
+    pub chunk: IVec3,
+    /// `None` for the opaque blocks (atlas UVs), the block type of a translucent mesh
+    pub block_type: Option<BlockType>,
+    /// Level of detail the mesh was built at; 0 is full detail
+    pub lod: u8,
+    pub positions: Vec<[f32; 3]>,
+    pub normals: Vec<[f32; 3]>,
+    pub uvs: Vec<[f32; 2]>,
+    pub indices: Vec<u32>,
+}
+
+impl ChunkMeshData {
+    pub fn is_empty(&self) -> bool {
+        self.indices.is_empty()
+    }
+
+    pub fn triangle_count(&self) -> usize {
+        self.indices.len() / 3
+    }
+
+    /// Size of the vertex and index buffers in bytes
+    pub fn byte_size(&self) -> usize {
+        self.positions.len() * size_of::<[f32; 3]>()
+            + self.normals.len() * size_of::<[f32; 3]>()
+            + self.uvs.len() * size_of::<[f32; 2]>()
+            + self.indices.len() * size_of::<u32>()
+    }
+
+    /// Convert into a Bevy mesh asset
+    pub fn into_mesh(self) -> Mesh {
+        Mesh::new(
+            PrimitiveTopology::TriangleList,
+            RenderAssetUsages::default(),
+        )
+        .with_inserted_attribute(Mesh::ATTRIBUTE_POSITION, self.positions)
+        .with_inserted_attribute(Mesh::ATTRIBUTE_NORMAL, self.normals)
+        .with_inserted_attribute(Mesh::ATTRIBUTE_UV_0, self.uvs)
+        .with_inserted_indices(Indices::U32(self.indices))
+    }
+}
+
+/// The six cube faces: neighbour offset, normal and the four corners (unit cube
+/// centred on the origin, counter-clockwise when viewed from outside).
+pub(super) const FACES: [(IVec3, [f32; 3], [[f32; 3]; 4]); 6] = [
+    (
+        IVec3::X,
+        [1.0, 0.0, 0.0],
+        [
+            [0.5, -0.5, 0.5],
+            [0.5, -0.5, -0.5],
+            [0.5, 0.5, -0.5],
+            [0.5, 0.5, 0.5],
+        ],
+    ),
+    (
+        IVec3::NEG_X,
+        [-1.0, 0.0, 0.0],
+        [
+            [-0.5, -0.5, -0.5],
+            [-0.5, -0.5, 0.5],
+            [-0.5, 0.5, 0.5],
+            [-0.5, 0.5, -0.5],
+        ],
+    ),
+    (
+        IVec3::Y,
+        [0.0, 1.0, 0.0],
+        [
+            [-0.5, 0.5, 0.5],
+            [0.5, 0.5, 0.5],
+            [0.5, 0.5, -0.5],
+            [-0.5, 0.5, -0.5],
+        ],
+    ),
+    (
+        IVec3::NEG_Y,
+        [0.0, -1.0, 0.0],
+        [
+            [-0.5, -0.5, -0.5],
+            [0.5, -0.5, -0.5],
+            [0.5, -0.5, 0.5],
+            [-0.5, -0.5, 0.5],
+        ],
+    ),
+    (
+        IVec3::Z,
+        [0.0, 0.0, 1.0],
+        [
+            [-0.5, -0.5, 0.5],
+            [0.5, -0.5, 0.5],
+            [0.5, 0.5, 0.5],
+            [-0.5, 0.5, 0.5],
+        ],
+    ),
+    (
+        IVec3::NEG_Z,
+        [0.0, 0.0, -1.0],
+        [
+            [0.5, -0.5, -0.5],
+            [-0.5, -0.5, -0.5],
+            [-0.5, 0.5, -0.5],
+            [0.5, 0.5, -0.5],
+        ],
+    ),
+];
+
+const FACE_UVS: [[f32; 2]; 4] = [[0.0, 1.0], [1.0, 1.0], [1.0, 0.0], [0.0, 0.0]];
+
+/// Blocks that do not hide the faces of their neighbours
+pub fn is_see_through(block_type: BlockType) -> bool {
+    matches!(block_type, BlockType::GlassPane | BlockType::Water)
+}
+
+/// Whether the face of `block` towards `neighbour` is hidden
+pub(super) fn face_hidden(block: BlockType, neighbour: Option<&BlockType>) -> bool {
+    match neighbour {
+        Some(&neighbour) => !is_see_through(neighbour) || neighbour == block,
+        None => false,
+    }
+}
+
+/// Group block positions by the chunk that contains them
+pub fn group_by_chunk<'a>(
+    blocks: impl IntoIterator<Item = (&'a IVec3, &'a BlockType)>,
+) -> HashMap<IVec3, Vec<(IVec3, BlockType)>> {
+    let mut chunks: HashMap<IVec3, Vec<(IVec3, BlockType)>> = HashMap::new();
+    for (position, block_type) in blocks {
+        chunks
+            .entry(chunk_of(*position))
+            .or_default()
+            .push((*position, *block_type));
+    }
+    chunks
+}
+
+/// Blocks of the given chunks, grouped by chunk.
+///
+/// Small chunk sets are looked up cell by cell instead of scanning the whole world,
+/// so remeshing a handful of chunks stays cheap in large worlds.
+pub fn blocks_in_chunks(
+    world: &HashMap<IVec3, BlockType>,
+    chunks: &HashSet<IVec3>,
+) -> HashMap<IVec3, Vec<(IVec3, BlockType)>> {
+    let cells_per_chunk = MESH_CHUNK_SIZE.pow(3) as usize;
+    if chunks.len() * cells_per_chunk >= world.len() {
+        return group_by_chunk(
+            world
+                .iter()
+                .filter(|(position, _)| chunks.contains(&chunk_of(**position))),
+        );
+    }
+
+    let mut grouped = HashMap::new();
+    for &chunk in chunks {
+        let origin = chunk * MESH_CHUNK_SIZE;
+        let mut blocks = Vec::new();
+        for x in 0..MESH_CHUNK_SIZE {
+            for y in 0..MESH_CHUNK_SIZE {
+                for z in 0..MESH_CHUNK_SIZE {
+                    let position = origin + IVec3::new(x, y, z);
+                    if let Some(block_type) = world.get(&position) {
+                        blocks.push((position, *block_type));
+                    }
+                }
+            }
+        }
+        if !blocks.is_empty() {
+            grouped.insert(chunk, blocks);
+        }
+    }
+    grouped
+}
+
+/// Fingerprint of one chunk's blocks
+pub fn fingerprint_of(blocks: &[(IVec3, BlockType)]) -> ChunkFingerprint {
+    let mut fingerprint = ChunkFingerprint::default();
+    for (position, block_type) in blocks {
+        fingerprint.add(*position, *block_type);
+    }
+    fingerprint
+}
+
+/// Build the meshes of one chunk: one atlas mesh for the opaque blocks and one per
+/// translucent block type present.
+///
+/// `chunk_blocks` are the blocks inside `chunk`; `world` is used to look up
+/// neighbours, including those across chunk borders.
+pub fn build_chunk_mesh(
+    chunk: IVec3,
+    chunk_blocks: &[(IVec3, BlockType)],
+    world: &HashMap<IVec3, BlockType>,
+) -> Vec<ChunkMeshData> {
+    let origin = chunk * MESH_CHUNK_SIZE;
+    let mut by_material: Vec<ChunkMeshData> = Vec::new();
+
+    for &(position, block_type) in chunk_blocks {
+        let local = (position - origin).as_vec3();
+        for (offset, normal, corners) in FACES {
+            if face_hidden(block_type, world.get(&(position + offset))) {
+                continue;
+            }
+
+            push_face(
+                &mut by_material,
+                (chunk, 0),
+                block_type,
+                local,
+                CUBE_SIZE,
+                normal,
+                corners,
+            );
+        }
+    }
+
+    by_material
+}
+
+/// Append one cube face of `block_type` to the mesh of its material, creating the
+/// mesh if needed. `centre` and `size` place the (possibly downsampled) cube.
+pub(super) fn push_face(
+    by_material: &mut Vec<ChunkMeshData>,
+    (chunk, lod): (IVec3, u8),
+    block_type: BlockType,
+    centre: Vec3,
+    size: f32,
+    normal: [f32; 3],
+    corners: [[f32; 3]; 4],
+) {
+    let translucent = is_translucent(block_type);
+    let key = translucent.then_some(block_type);
+    let mesh = match by_material.iter_mut().position(|m| m.block_type == key) {
+        Some(index) => &mut by_material[index],
+        None => {
+            by_material.push(ChunkMeshData {
+                chunk,
+                block_type: key,
+                lod,
+                ..default()
+            });
+            by_material.last_mut().unwrap()
+        }
+    };
+
+    let base = mesh.positions.len() as u32;
+    for (corner, uv) in corners.iter().zip(FACE_UVS) {
+        mesh.positions.push([
+            centre.x + corner[0] * size,
+            centre.y + corner[1] * size,
+            centre.z + corner[2] * size,
+        ]);
+        mesh.normals.push(normal);
+        mesh.uvs.push(if translucent {
+            uv
+        } else {
+            atlas_uv(block_type, uv)
+        });
+    }
+    mesh.indices
+        .extend_from_slice(&[base, base + 1, base + 2, base, base + 2, base + 3]);
+}
+
+/// Build meshes for every chunk of a world
+pub fn build_world_meshes(world: &HashMap<IVec3, BlockType>) -> Vec<ChunkMeshData> {
+    group_by_chunk(world)
+        .into_iter()
+        .flat_map(|(chunk, blocks)| build_chunk_mesh(chunk, &blocks, world))
+        .collect()
+}
+
+/// Replace the rendering of `chunks` with `chunk_meshes` (built from `world`).
+///
+/// Previous entities of those chunks are despawned; chunks that no longer hold any
+/// block are dropped from `meshed_chunks`. A chunk keeps its level of detail unless
+/// new meshes for it say otherwise. Returns the number of entities spawned.
+pub fn apply_chunk_meshes(
+    commands: &mut Commands,
+    meshes: &mut Assets<Mesh>,
+    materials: &SharedBlockMaterials,
+    meshed_chunks: &mut MeshedChunks,
+    world: &HashMap<IVec3, BlockType>,
+    chunks: &HashSet<IVec3>,
+    chunk_meshes: Vec<ChunkMeshData>,
+) -> usize {
+    let mut previous = HashMap::new();
+    for chunk in chunks {
+        if let Some(old) = meshed_chunks.chunks.remove(chunk) {
+            for entity in old.entities {
+                commands.entity(entity).despawn();
+            }
+            previous.insert(*chunk, (old.lod, old.last_used));
+        }
+    }
+
+    // Chunks fully enclosed by neighbours have no mesh but are still tracked, so their
+    // blocks do not fall back to per-block entities
+    for (chunk, blocks) in blocks_in_chunks(world, chunks) {
+        let fingerprint = fingerprint_of(&blocks);
+        let (lod, last_used) = previous.get(&chunk).copied().unwrap_or_default();
+        meshed_chunks.chunks.insert(
+            chunk,
+            MeshedChunk {
+                fingerprint,
+                lod,
+                last_used,
+                ..default()
+            },
+        );
+    }
+
+    let mut spawned = 0;
+    for data in chunk_meshes {
+        let (chunk, block_type) = (data.chunk, data.block_type);
+        let Some(meshed) = meshed_chunks.chunks.get_mut(&chunk) else {
+            continue;
+        };
+        meshed.mesh_bytes += data.byte_size();
+        meshed.triangles += data.triangle_count();
+        meshed.lod = data.lod;
+        let entity = commands
+            .spawn((
+                Mesh3d(meshes.add(data.into_mesh())),
+                MeshMaterial3d(materials.chunk_material(block_type)),
+                Transform::from_translation(chunk_origin(chunk)),
+                ChunkMesh { chunk, block_type },
+                Name::new(match block_type {
+                    Some(block_type) => format!(
+                        "ChunkMesh-{}-{}-{}-{:?}",
+                        chunk.x, chunk.y, chunk.z, block_type
+                    ),
+                    None => format!("ChunkMesh-{}-{}-{}", chunk.x, chunk.y, chunk.z),
+                }),
+            ))
+            .id();
+        meshed.entities.push(entity);
+        spawned += 1;
+    }
+    spawned
+}
+
+/// Remesh the given chunks from the current world contents, each at its current
+/// level of detail
+pub fn remesh_chunks(
+    commands: &mut Commands,
+    meshes: &mut Assets<Mesh>,
+    materials: &SharedBlockMaterials,
+    meshed_chunks: &mut MeshedChunks,
+    world: &HashMap<IVec3, BlockType>,
+    chunks: &HashSet<IVec3>,
+) -> usize {
+    let chunk_meshes = blocks_in_chunks(world, chunks)
+        .iter()
+        .flat_map(|(chunk, blocks)| {
+            let lod = meshed_chunks.chunks.get(chunk).map_or(0, |m| m.lod);
+            build_chunk_lod_mesh(*chunk, blocks, world, lod)
+        })
+        .collect();
+    apply_chunk_meshes(
+        commands,
+        meshes,
+        materials,
+        meshed_chunks,
+        world,
+        chunks,
+        chunk_meshes,
+    )
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_chunk_of_negative_positions() {
+        assert_eq!(chunk_of(IVec3::new(0, 0, 0)), IVec3::ZERO);
+        assert_eq!(chunk_of(IVec3::new(15, 15, 15)), IVec3::ZERO);
+        assert_eq!(chunk_of(IVec3::new(16, -1, -16)), IVec3::new(1, -1, -1));
+        assert_eq!(chunk_of(IVec3::new(-17, 0, 0)), IVec3::new(-2, 0, 0));
+    }
+
+    #[test]
+    fn test_single_block_has_six_faces() {
+        let mut world = HashMap::new();
+        world.insert(IVec3::new(1, 2, 3), BlockType::Stone);
+        let meshes = build_world_meshes(&world);
+        assert_eq!(meshes.len(), 1);
+        assert_eq!(meshes[0].triangle_count(), 12);
+        assert_eq!(meshes[0].positions.len(), 24);
+        assert_eq!(meshes[0].block_type, None);
+        // Stone is atlas tile 2 of 7
+        assert!(
+            meshes[0]
+                .uvs
+                .iter()
+                .all(|uv| uv[1] > 2.0 / 7.0 && uv[1] < 3.0 / 7.0)
+        );
+    }
+
+    #[test]
+    fn test_shared_faces_are_culled_across_chunks() {
+        let mut world = HashMap::new();
+        // Two adjacent blocks straddling the chunk border at x = 16
+        world.insert(IVec3::new(15, 0, 0), BlockType::Dirt);
+        world.insert(IVec3::new(16, 0, 0), BlockType::Grass);
+        let meshes = build_world_meshes(&world);
+        let triangles: usize = meshes.iter().map(ChunkMeshData::triangle_count).sum();
+        assert_eq!(meshes.len(), 2);
+        assert_eq!(triangles, 20);
+    }
+
+    #[test]
+    fn test_see_through_neighbours_keep_faces() {
+        let mut world = HashMap::new();
+        world.insert(IVec3::new(0, 0, 0), BlockType::Stone);
+        world.insert(IVec3::new(1, 0, 0), BlockType::GlassPane);
+        world.insert(IVec3::new(2, 0, 0), BlockType::GlassPane);
+        world.insert(IVec3::new(3, 0, 0), BlockType::Water);
+        let meshes = build_world_meshes(&world);
+        let count = |block_type| {
+            meshes
+                .iter()
+                .filter(|m| m.block_type == block_type)
+                .map(ChunkMeshData::triangle_count)
+                .sum::<usize>()
+        };
+        // Stone keeps its face towards the glass; glass hides its face towards stone
+        // and both faces between the two glass blocks. Stone and glass share the atlas
+        // mesh, water gets a mesh of its own.
+        assert_eq!(meshes.len(), 2);
+        assert_eq!(count(None), 12 + 18);
+        assert_eq!(count(Some(BlockType::Water)), 12);
+    }
+
+    #[test]
+    fn test_stale_chunks_detects_edits_and_neighbours() {
+        let mut world = HashMap::new();
+        world.insert(IVec3::new(0, 0, 0), BlockType::Stone);
+        world.insert(IVec3::new(16, 0, 0), BlockType::Stone);
+        world.insert(IVec3::new(64, 0, 0), BlockType::Stone);
+
+        let mut meshed = MeshedChunks::default();
+        for (chunk, fingerprint) in chunk_fingerprints(&world, |_| true) {
+            meshed.chunks.insert(
+                chunk,
+                MeshedChunk {
+                    fingerprint,
+                    ..default()
+                },
+            );
+        }
+        assert!(meshed.stale_chunks(&world).is_empty());
+
+        // Replacing a block keeps the count but changes the hash
+        world.insert(IVec3::new(1, 0, 0), BlockType::Dirt);
+        world.remove(&IVec3::new(0, 0, 0));
+        let stale = meshed.stale_chunks(&world);
+        assert_eq!(
+            stale,
+            HashSet::from([IVec3::ZERO, IVec3::new(1, 0, 0)]),
+            "edited chunk and its meshed neighbour are stale, the distant chunk is not"
+        );
+    }
+
+    #[test]
+    fn test_chunks_touched_by_edits() {
+        let mut meshed = MeshedChunks::default();
+        for chunk in [IVec3::ZERO, IVec3::new(1, 0, 0), IVec3::new(4, 0, 0)] {
+            meshed.chunks.insert(chunk, MeshedChunk::default());
+        }
+        meshed.chunks.insert(
+            IVec3::new(0, 1, 0),
+            MeshedChunk {
+                evicted: true,
+                ..default()
+            },
+        );
+
+        assert_eq!(
+            meshed.chunks_touched([IVec3::new(3, 15, 3)]),
+            HashSet::from([IVec3::ZERO, IVec3::new(1, 0, 0)]),
+            "edited chunk and resident neighbours, not evicted or distant ones"
+        );
+        // An edit outside any meshed chunk still touches the meshed chunks around it
+        assert_eq!(
+            meshed.chunks_touched([IVec3::new(40, 0, 0)]),
+            HashSet::from([IVec3::new(1, 0, 0)])
+        );
+        assert!(meshed.chunks_touched([IVec3::new(200, 0, 0)]).is_empty());
+    }
+}
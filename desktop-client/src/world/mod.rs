@@ -1,7 +1,14 @@
 pub mod async_world_creation;
+#[cfg(not(target_arch = "wasm32"))]
+pub mod block_visuals;
+pub mod chunk_lod;
+pub mod chunk_mesh;
 pub mod world_systems;
 pub mod world_types;
 
+#[cfg(target_arch = "wasm32")]
+pub mod web_worker;
+
 pub use async_world_creation::*;
 pub use world_systems::WorldPlugin as WorldSystemsPlugin;
 pub use world_types::*;
@@ -13,6 +20,20 @@ pub struct WorldPlugin;
 impl Plugin for WorldPlugin {
     fn build(&self, app: &mut App) {
         app.add_plugins(WorldSystemsPlugin)
-            .add_plugins(async_world_creation::AsyncWorldCreationPlugin);
+            .add_plugins(async_world_creation::AsyncWorldCreationPlugin)
+            .init_resource::<chunk_mesh::MeshedChunks>()
+            .init_resource::<chunk_mesh::PrebuiltChunkMeshes>()
+            .add_plugins(crate::memory_governor::MemoryGovernorPlugin)
+            .add_plugins(chunk_lod::ChunkLodPlugin);
+
+        // The web build syncs its visuals in lib_gradual
+        #[cfg(not(target_arch = "wasm32"))]
+        app.init_resource::<block_visuals::BlockEntities>()
+            .add_systems(
+                Update,
+                block_visuals::sync_block_visuals
+                    .in_set(crate::environment::VoxelSet::Read)
+                    .after(chunk_lod::run_lod_benchmark),
+            );
     }
 }
@@ -0,0 +1,327 @@
+//! World decoding in a Web Worker (WASM only)
+//!
+//! Parsing a multi-megabyte `/data` payload and meshing it used to run inside the
+//! WebSocket callback and the join frame, blocking the page for seconds. The raw
+//! payload is now transferred to `web/world_worker.js`, which loads this same wasm
+//! module and calls [`worker_decode_world`]. The worker returns the metadata, the
+//! blocks packed into an `Int32Array` and ready-made chunk mesh buffers, all as
+//! transferable typed arrays, so the main thread only copies them into place.
+//!
+//! Append `?world_worker=0` to the page URL to decode on the main thread instead.
+
+use bevy::prelude::*;
+use js_sys::{Array, Float32Array, Int32Array, Object, Reflect, Uint8Array, Uint32Array};
+use std::cell::Cell;
+use std::collections::HashMap;
+use std::rc::Rc;
+use wasm_bindgen::JsCast;
+use wasm_bindgen::prelude::*;
+use web_sys::{ErrorEvent, MessageEvent, Worker, WorkerOptions, WorkerType};
+
+use super::chunk_mesh::{ChunkMeshData, build_world_meshes};
+use super::world_types::{VoxelBlockData, WorldSaveData};
+use crate::environment::BlockType;
+use crate::memory_governor::with_message_buffer;
+
+const WORKER_SCRIPT: &str = "./world_worker.js";
+
+/// Number of `i32`s per packed block: x, y, z, block type index
+const PACKED_BLOCK_LEN: usize = 4;
+
+fn now_ms() -> f64 {
+    js_sys::global()
+        .dyn_into::<web_sys::WorkerGlobalScope>()
+        .ok()
+        .and_then(|scope| scope.performance())
+        .or_else(|| web_sys::window().and_then(|w| w.performance()))
+        .map(|p| p.now())
+        .unwrap_or_else(js_sys::Date::now)
+}
+
+fn set(target: &Object, key: &str, value: &JsValue) {
+    let _ = Reflect::set(target, &JsValue::from_str(key), value);
+}
+
+fn get(source: &JsValue, key: &str) -> JsValue {
+    Reflect::get(source, &JsValue::from_str(key)).unwrap_or(JsValue::UNDEFINED)
+}
+
+fn word(bytes: &[u8], index: usize) -> [u8; 4] {
+    let start = index * 4;
+    [
+        bytes[start],
+        bytes[start + 1],
+        bytes[start + 2],
+        bytes[start + 3],
+    ]
+}
+
+/// Decode a transferred typed array item by item through a pooled scratch buffer,
+/// instead of allocating an intermediate `Vec` per array
+fn read_items<T>(array: &JsValue, item_bytes: usize, decode: impl Fn(&[u8]) -> T) -> Vec<T> {
+    let (Ok(buffer), Some(offset), Some(len)) = (
+        get(array, "buffer").dyn_into::<js_sys::ArrayBuffer>(),
+        get(array, "byteOffset").as_f64(),
+        get(array, "byteLength").as_f64(),
+    ) else {
+        return Vec::new();
+    };
+    let bytes = Uint8Array::new_with_byte_offset_and_length(&buffer, offset as u32, len as u32);
+    with_message_buffer(len as usize, |scratch| {
+        bytes.copy_to(scratch);
+        scratch.chunks_exact(item_bytes).map(decode).collect()
+    })
+}
+
+fn read_f32s<const N: usize>(array: &JsValue) -> Vec<[f32; N]> {
+    read_items(array, N * 4, |b| {
+        std::array::from_fn(|i| f32::from_le_bytes(word(b, i)))
+    })
+}
+
+/// Decode a world data payload and build its chunk meshes (called from the worker).
+///
+/// Returns `{ meta, blocks, meshes, transfer, decodeMs, meshMs }` where `transfer`
+/// lists every buffer so the worker can post the result without copying.
+#[wasm_bindgen]
+pub fn worker_decode_world(payload: &[u8]) -> Result<Object, JsValue> {
+    let start = now_ms();
+    let mut world_data: WorldSaveData = serde_json::from_slice(payload)
+        .map_err(|e| JsValue::from_str(&format!("Failed to parse world data: {}", e)))?;
+
+    let blocks = std::mem::take(&mut world_data.blocks);
+    let mut packed = Vec::with_capacity(blocks.len() * PACKED_BLOCK_LEN);
+    let mut world = HashMap::with_capacity(blocks.len());
+    for block in blocks {
+        packed.extend_from_slice(&[block.x, block.y, block.z, block.block_type.index() as i32]);
+        world.insert(IVec3::new(block.x, block.y, block.z), block.block_type);
+    }
+    let meta = serde_json::to_string(&world_data)
+        .map_err(|e| JsValue::from_str(&format!("Failed to encode world metadata: {}", e)))?;
+    let decoded = now_ms();
+
+    let chunk_meshes = build_world_meshes(&world);
+    let meshed = now_ms();
+
+    let transfer = Array::new();
+    let packed = Int32Array::from(packed.as_slice());
+    transfer.push(&packed.buffer());
+
+    let meshes = Array::new();
+    for mesh in chunk_meshes {
+        let entry = Object::new();
+        let chunk = Int32Array::from(&mesh.chunk.to_array()[..]);
+        let positions = Float32Array::from(mesh.positions.as_flattened());
+        let normals = Float32Array::from(mesh.normals.as_flattened());
+        let uvs = Float32Array::from(mesh.uvs.as_flattened());
+        let indices = Uint32Array::from(mesh.indices.as_slice());
+        set(&entry, "chunk", &chunk);
+        // null marks the opaque atlas mesh
+        let block_type = mesh.block_type.map_or(JsValue::NULL, |t| t.index().into());
+        set(&entry, "blockType", &block_type);
+        set(&entry, "positions", &positions);
+        set(&entry, "normals", &normals);
+        set(&entry, "uvs", &uvs);
+        set(&entry, "indices", &indices);
+        for buffer in [
+            chunk.buffer(),
+            positions.buffer(),
+            normals.buffer(),
+            uvs.buffer(),
+            indices.buffer(),
+        ] {
+            transfer.push(&buffer);
+        }
+        meshes.push(&entry);
+    }
+
+    let result = Object::new();
+    set(&result, "meta", &JsValue::from_str(&meta));
+    set(&result, "blocks", &packed);
+    set(&result, "meshes", &meshes);
+    set(&result, "transfer", &transfer);
+    set(&result, "decodeMs", &JsValue::from(decoded - start));
+    set(&result, "meshMs", &JsValue::from(meshed - decoded));
+    Ok(result)
+}
+
+/// A world decoded off the main thread
+pub struct DecodedWorld {
+    pub world_id: String,
+    pub world_data: WorldSaveData,
+    pub chunk_meshes: Vec<ChunkMeshData>,
+}
+
+/// Rebuild a [`DecodedWorld`] from a worker result message
+fn read_decoded_world(world_id: String, result: &JsValue) -> Result<DecodedWorld, String> {
+    let meta = get(result, "meta")
+        .as_string()
+        .ok_or("world worker result has no metadata")?;
+    let mut world_data: WorldSaveData =
+        serde_json::from_str(&meta).map_err(|e| format!("Invalid world metadata: {}", e))?;
+
+    world_data.blocks = read_items(&get(result, "blocks"), PACKED_BLOCK_LEN * 4, |b| {
+        let field = |i| i32::from_le_bytes(word(b, i));
+        Some(VoxelBlockData {
+            x: field(0),
+            y: field(1),
+            z: field(2),
+            block_type: BlockType::from_index(field(3) as u32)?,
+        })
+    })
+    .into_iter()
+    .flatten()
+    .collect();
+
+    let meshes = get(result, "meshes")
+        .dyn_into::<Array>()
+        .map_err(|_| "world worker result has no meshes")?;
+    let mut chunk_meshes = Vec::with_capacity(meshes.length() as usize);
+    for entry in meshes.iter() {
+        let chunk = Int32Array::from(get(&entry, "chunk")).to_vec();
+        let block_type = match get(&entry, "blockType").as_f64() {
+            Some(index) => match BlockType::from_index(index as u32) {
+                Some(block_type) => Some(block_type),
+                None => continue,
+            },
+            None => None,
+        };
+        if chunk.len() != 3 {
+            continue;
+        }
+        chunk_meshes.push(ChunkMeshData {
+            chunk: IVec3::new(chunk[0], chunk[1], chunk[2]),
+            block_type,
+            positions: read_f32s(&get(&entry, "positions")),
+            normals: read_f32s(&get(&entry, "normals")),
+            uvs: read_f32s(&get(&entry, "uvs")),
+            indices: read_items(&get(&entry, "indices"), 4, |b| {
+                u32::from_le_bytes(word(b, 0))
+            }),
+        });
+    }
+
+    Ok(DecodedWorld {
+        world_id,
+        world_data,
+        chunk_meshes,
+    })
+}
+
+/// Decode a world payload on the current thread (fallback when no worker is available)
+pub fn decode_world_blocking(world_id: String, payload: &[u8]) -> Result<DecodedWorld, String> {
+    let world_data: WorldSaveData = serde_json::from_slice(payload)
+        .map_err(|e| format!("Failed to parse world data JSON: {}", e))?;
+    Ok(DecodedWorld {
+        world_id,
+        world_data,
+        // Meshes are built on demand when the world is entered
+        chunk_meshes: Vec::new(),
+    })
+}
+
+/// Whether the page URL allows the world worker (`?world_worker=0` disables it)
+fn worker_enabled() -> bool {
+    web_sys::window()
+        .and_then(|w| w.location().search().ok())
+        .map(|search| !search.contains("world_worker=0"))
+        .unwrap_or(true)
+}
+
+/// Main-thread handle to the world decode worker
+#[derive(Clone)]
+pub struct WorldDecodeWorker {
+    worker: Worker,
+    failed: Rc<Cell<bool>>,
+}
+
+impl WorldDecodeWorker {
+    /// Start the worker; `on_decoded` runs on the main thread for every decoded world.
+    /// Payloads the worker could not decode are decoded on the main thread instead.
+    pub fn spawn(mut on_decoded: impl FnMut(DecodedWorld) + 'static) -> Option<Self> {
+        if !worker_enabled() {
+            info!("🧵 World worker disabled by URL parameter");
+            return None;
+        }
+
+        let options = WorkerOptions::new();
+        options.set_type(WorkerType::Module);
+        let worker = match Worker::new_with_options(WORKER_SCRIPT, &options) {
+            Ok(worker) => worker,
+            Err(e) => {
+                warn!(
+                    "🧵 Failed to start world worker, decoding on main thread: {:?}",
+                    e
+                );
+                return None;
+            }
+        };
+        let failed = Rc::new(Cell::new(false));
+
+        let onmessage = Closure::<dyn FnMut(_)>::new(move |e: MessageEvent| {
+            let data = e.data();
+            let world_id = get(&data, "worldId").as_string().unwrap_or_default();
+            let result = get(&data, "result");
+
+            let decoded = if result.is_object() {
+                info!(
+                    "🧵 World {} decoded off-thread (parse {:.1} ms, mesh {:.1} ms)",
+                    world_id,
+                    get(&result, "decodeMs").as_f64().unwrap_or_default(),
+                    get(&result, "meshMs").as_f64().unwrap_or_default()
+                );
+                read_decoded_world(world_id, &result)
+            } else {
+                // The worker hands the payload back when it cannot decode it
+                warn!(
+                    "🧵 World worker failed for {}: {}, decoding on main thread",
+                    world_id,
+                    get(&data, "error").as_string().unwrap_or_default()
+                );
+                let payload = Uint8Array::new(&get(&data, "payload"));
+                with_message_buffer(payload.length() as usize, |buffer| {
+                    payload.copy_to(buffer);
+                    decode_world_blocking(world_id, buffer)
+                })
+            };
+
+            match decoded {
+                Ok(decoded) => on_decoded(decoded),
+                Err(e) => error!("🌍 Web: {}", e),
+            }
+        });
+        worker.set_onmessage(Some(onmessage.as_ref().unchecked_ref()));
+        onmessage.forget();
+
+        let failed_clone = failed.clone();
+        let onerror = Closure::<dyn FnMut(_)>::new(move |e: ErrorEvent| {
+            error!("🧵 World worker error: {}", e.message());
+            failed_clone.set(true);
+        });
+        worker.set_onerror(Some(onerror.as_ref().unchecked_ref()));
+        onerror.forget();
+
+        info!("🧵 World decode worker started");
+        Some(Self { worker, failed })
+    }
+
+    /// Whether the worker script failed to load or crashed
+    pub fn is_failed(&self) -> bool {
+        self.failed.get()
+    }
+
+    /// Copy `payload` into a fresh buffer and transfer it to the worker
+    pub fn decode(&self, world_id: &str, payload: &[u8]) -> Result<(), JsValue> {
+        if self.is_failed() {
+            return Err(JsValue::from_str("world worker unavailable"));
+        }
+        let bytes = Uint8Array::new_with_length(payload.len() as u32);
+        bytes.copy_from(payload);
+
+        let message = Object::new();
+        set(&message, "worldId", &JsValue::from_str(world_id));
+        set(&message, "payload", &bytes.buffer());
+        self.worker
+            .post_message_with_transfer(&message, &Array::of1(&bytes.buffer()))
+    }
+}
@@ -5,8 +5,11 @@ use std::path::Path;
 
 use super::world_types::*;
 use crate::camera_controllers::CameraController;
-use crate::environment::VoxelWorld;
+use crate::environment::{VoxelSet, VoxelWorld};
+#[cfg(target_arch = "wasm32")]
 use crate::script::script_types::PendingCommands;
+#[cfg(not(target_arch = "wasm32"))]
+use crate::script::script_types::{PendingScripts, QueuedScript};
 
 pub struct WorldPlugin;
 
@@ -19,12 +22,18 @@ impl Plugin for WorldPlugin {
             .init_resource::<DiscoveredWorlds>()
             .add_systems(Startup, discover_worlds)
             // World management systems should run early in Update to ensure
-            // world state changes are processed before other game logic
+            // world state changes are processed before other game logic. The ones that
+            // replace the voxel world only run when their event arrives, so they do not
+            // hold it exclusively on every frame.
             .add_systems(
                 Update,
                 (
-                    handle_load_world_events,
-                    handle_create_world_events,
+                    handle_load_world_events
+                        .run_if(on_event::<LoadWorldEvent>)
+                        .in_set(VoxelSet::Replace),
+                    handle_create_world_events
+                        .run_if(on_event::<CreateWorldEvent>)
+                        .in_set(VoxelSet::Replace),
                     handle_save_world_events,
                     handle_delete_world_events,
                 ),
@@ -114,6 +123,21 @@ fn load_world_info(world_path: &Path) -> Option<WorldInfo> {
     }
 }
 
+/// Read and parse a world's `world.json`
+pub fn load_world_save(world_data_path: &Path) -> Result<WorldSaveData, String> {
+    let content = fs::read_to_string(world_data_path)
+        .map_err(|e| format!("Failed to read world data: {}", e))?;
+    serde_json::from_str::<WorldSaveData>(&content)
+        .map_err(|e| format!("Failed to parse world data: {}", e))
+}
+
+/// Serialize and write a world's `world.json`
+pub fn store_world_save(world_data_path: &Path, save_data: &WorldSaveData) -> Result<(), String> {
+    let json = serde_json::to_string_pretty(save_data)
+        .map_err(|e| format!("Failed to serialize world data: {}", e))?;
+    fs::write(world_data_path, json).map_err(|e| format!("Failed to write world data: {}", e))
+}
+
 /// Load web-compatible template scripts for WASM builds
 #[cfg(target_arch = "wasm32")]
 fn load_web_template(
@@ -335,9 +359,6 @@ fn handle_load_world_events(
     camera_query: Query<Entity, With<CameraController>>,
     mut inventory: ResMut<crate::inventory::PlayerInventory>,
     existing_blocks_query: Query<Entity, With<crate::environment::VoxelBlock>>,
-    mut meshes: ResMut<Assets<Mesh>>,
-    mut materials: ResMut<Assets<StandardMaterial>>,
-    asset_server: Res<AssetServer>,
     shared_materials: Option<Res<crate::shared_materials::SharedBlockMaterials>>,
     mut error_resource: ResMut<crate::ui::error_indicator::ErrorResource>,
     time: Res<Time>,
@@ -355,159 +376,89 @@ fn handle_load_world_events(
 
             if world_data_path.exists() {
                 info!("Loading world data from: {:?}", world_data_path);
-                match fs::read_to_string(&world_data_path) {
-                    Ok(content) => {
-                        match serde_json::from_str::<WorldSaveData>(&content) {
-                            Ok(save_data) => {
-                                info!(
-                                    "Loaded world save data with {} blocks",
-                                    save_data.blocks.len()
-                                );
-                                for (i, block_data) in save_data.blocks.iter().take(5).enumerate() {
-                                    info!(
-                                        "  Block {}: {:?} at ({}, {}, {})",
-                                        i,
-                                        block_data.block_type,
-                                        block_data.x,
-                                        block_data.y,
-                                        block_data.z
-                                    );
-                                }
-
-                                // Clear existing voxel blocks from the scene
-                                let cleared_entities = existing_blocks_query.iter().count();
-                                for entity in existing_blocks_query.iter() {
-                                    commands.entity(entity).despawn();
-                                }
-                                info!(
-                                    "Cleared {} existing block entities from scene",
-                                    cleared_entities
-                                );
-
-                                // Clear and convert blocks into voxel world
-                                voxel_world.blocks.clear();
-                                for block_data in save_data.blocks {
-                                    voxel_world.blocks.insert(
-                                        IVec3::new(block_data.x, block_data.y, block_data.z),
-                                        block_data.block_type,
-                                    );
-                                }
-                                info!("Loaded {} blocks into VoxelWorld", voxel_world.blocks.len());
-
-                                // Spawn visual blocks for all loaded blocks using shared materials
-                                let mut spawned_blocks = 0;
-                                for (pos, block_type) in voxel_world.blocks.iter() {
-                                    let cube_mesh = meshes.add(Cuboid::new(
-                                        crate::environment::CUBE_SIZE,
-                                        crate::environment::CUBE_SIZE,
-                                        crate::environment::CUBE_SIZE,
-                                    ));
-
-                                    // Use SharedBlockMaterials if available, otherwise fall back to creating new materials
-                                    let material = if let Some(shared_materials) =
-                                        shared_materials.as_ref()
-                                    {
-                                        shared_materials.get_material(*block_type)
-                                            .unwrap_or_else(|| {
-                                                // Fallback to creating individual material
-                                                let texture_path = match block_type {
-                                                    crate::environment::BlockType::Grass => "textures/grass.webp",
-                                                    crate::environment::BlockType::Dirt => "textures/dirt.webp",
-                                                    crate::environment::BlockType::Stone => "textures/stone.webp",
-                                                    crate::environment::BlockType::QuartzBlock => "textures/quartz_block.webp",
-                                                    crate::environment::BlockType::GlassPane => "textures/glass_pane.webp",
-                                                    crate::environment::BlockType::CyanTerracotta => "textures/cyan_terracotta.webp",
-                                                    crate::environment::BlockType::Water => "textures/water.webp",
-                                                };
-                                                let texture: Handle<Image> = asset_server.load(texture_path);
-                                                materials.add(StandardMaterial {
-                                                    base_color_texture: Some(texture),
-                                                    ..default()
-                                                })
-                                            })
-                                    } else {
-                                        // Fallback when shared materials not available
-                                        let texture_path = match block_type {
-                                            crate::environment::BlockType::Grass => {
-                                                "textures/grass.webp"
-                                            }
-                                            crate::environment::BlockType::Dirt => {
-                                                "textures/dirt.webp"
-                                            }
-                                            crate::environment::BlockType::Stone => {
-                                                "textures/stone.webp"
-                                            }
-                                            crate::environment::BlockType::QuartzBlock => {
-                                                "textures/quartz_block.webp"
-                                            }
-                                            crate::environment::BlockType::GlassPane => {
-                                                "textures/glass_pane.webp"
-                                            }
-                                            crate::environment::BlockType::CyanTerracotta => {
-                                                "textures/cyan_terracotta.webp"
-                                            }
-                                            crate::environment::BlockType::Water => {
-                                                "textures/water.webp"
-                                            }
-                                        };
-                                        let texture: Handle<Image> =
-                                            asset_server.load(texture_path);
-                                        materials.add(StandardMaterial {
-                                            base_color_texture: Some(texture),
-                                            ..default()
-                                        })
-                                    };
-
-                                    commands.spawn((
-                                        Mesh3d(cube_mesh),
-                                        MeshMaterial3d(material),
-                                        Transform::from_translation(pos.as_vec3()),
-                                        crate::environment::VoxelBlock { position: *pos },
-                                    ));
-                                    spawned_blocks += 1;
-                                }
-                                info!("Spawned {} visual block entities", spawned_blocks);
-
-                                // Load inventory data and force change detection
-                                *inventory = save_data.inventory;
-                                inventory.ensure_proper_size();
-                                inventory.set_changed();
-
-                                // Update current world resource
-                                commands.insert_resource(CurrentWorld {
-                                    name: world_info.name.clone(),
-                                    path: world_info.path.clone(),
-                                    metadata: world_info.metadata.clone(),
-                                });
-
-                                // Set player position if camera exists
-                                if let Ok(camera_entity) = camera_query.single() {
-                                    commands.entity(camera_entity).insert(Transform {
-                                        translation: save_data.player_position,
-                                        rotation: save_data.player_rotation,
-                                        ..default()
-                                    });
-                                }
-
-                                info!("Successfully loaded world: {}", event.world_name);
-                            }
-                            Err(e) => {
-                                let error_message = format!(
-                                    "Failed to parse world data for {}: {}",
-                                    event.world_name, e
-                                );
-                                error!("{}", error_message);
-
-                                // Trigger error indicator
-                                error_resource.indicator_on = true;
-                                error_resource.last_error_time = time.elapsed_secs();
-                                error_resource.messages.push(error_message);
+                match load_world_save(&world_data_path) {
+                    Ok(save_data) => {
+                        info!(
+                            "Loaded world save data with {} blocks",
+                            save_data.blocks.len()
+                        );
+                        for (i, block_data) in save_data.blocks.iter().take(5).enumerate() {
+                            info!(
+                                "  Block {}: {:?} at ({}, {}, {})",
+                                i, block_data.block_type, block_data.x, block_data.y, block_data.z
+                            );
+                        }
+
+                        // Clear existing voxel blocks from the scene
+                        let cleared_entities = existing_blocks_query.iter().count();
+                        for entity in existing_blocks_query.iter() {
+                            commands.entity(entity).despawn();
+                        }
+                        info!(
+                            "Cleared {} existing block entities from scene",
+                            cleared_entities
+                        );
+
+                        // Clear and convert blocks into voxel world
+                        voxel_world.clear();
+                        for block_data in save_data.blocks {
+                            voxel_world.set_block(
+                                IVec3::new(block_data.x, block_data.y, block_data.z),
+                                block_data.block_type,
+                            );
+                        }
+                        info!(
+                            "Loaded {} blocks into VoxelWorld",
+                            voxel_world.blocks().len()
+                        );
+
+                        // Spawn visual blocks for all loaded blocks using shared materials;
+                        // apps without them (headless tests) only get the voxel data
+                        if let Some(shared_materials) = shared_materials.as_deref() {
+                            let mut spawned_blocks = 0;
+                            for (pos, block_type) in voxel_world.blocks().iter() {
+                                let material = shared_materials
+                                    .get_material(*block_type)
+                                    .unwrap_or_default();
+
+                                commands.spawn((
+                                    Mesh3d(shared_materials.shared_mesh.clone()),
+                                    MeshMaterial3d(material),
+                                    Transform::from_translation(pos.as_vec3()),
+                                    crate::environment::VoxelBlock { position: *pos },
+                                ));
+                                spawned_blocks += 1;
                             }
+                            info!("Spawned {} visual block entities", spawned_blocks);
+                        } else {
+                            warn!("No shared block materials, skipping block visuals");
                         }
+
+                        // Load inventory data and force change detection
+                        *inventory = save_data.inventory;
+                        inventory.ensure_proper_size();
+                        inventory.set_changed();
+
+                        // Update current world resource
+                        commands.insert_resource(CurrentWorld {
+                            name: world_info.name.clone(),
+                            path: world_info.path.clone(),
+                            metadata: world_info.metadata.clone(),
+                        });
+
+                        // Set player position if camera exists
+                        if let Ok(camera_entity) = camera_query.single() {
+                            commands.entity(camera_entity).insert(Transform {
+                                translation: save_data.player_position,
+                                rotation: save_data.player_rotation,
+                                ..default()
+                            });
+                        }
+
+                        info!("Successfully loaded world: {}", event.world_name);
                     }
                     Err(e) => {
-                        let error_message =
-                            format!("Failed to read world data for {}: {}", event.world_name, e);
+                        let error_message = format!("{} (world: {})", e, event.world_name);
                         error!("{}", error_message);
 
                         // Trigger error indicator
@@ -558,14 +509,14 @@ fn handle_save_world_events(
             // Convert blocks from HashMap to Vec for serialization
             info!(
                 "VoxelWorld contains {} blocks before saving",
-                voxel_world.blocks.len()
+                voxel_world.blocks().len()
             );
-            for (pos, block_type) in voxel_world.blocks.iter().take(5) {
+            for (pos, block_type) in voxel_world.blocks().iter().take(5) {
                 info!("  Block at {:?}: {:?}", pos, block_type);
             }
 
             let blocks: Vec<VoxelBlockData> = voxel_world
-                .blocks
+                .blocks()
                 .iter()
                 .map(|(pos, block_type)| VoxelBlockData {
                     x: pos.x,
@@ -592,18 +543,9 @@ fn handle_save_world_events(
 
             // Serialize and save
             info!("Saving world data to: {:?}", world_data_path);
-            match serde_json::to_string_pretty(&save_data) {
-                Ok(json) => {
-                    if let Err(e) = fs::write(&world_data_path, json) {
-                        error!("Failed to write world data for {}: {}", event.world_name, e);
-                    } else {
-                        info!("Successfully saved world: {}", event.world_name);
-                    }
-                }
-                Err(e) => error!(
-                    "Failed to serialize world data for {}: {}",
-                    event.world_name, e
-                ),
+            match store_world_save(&world_data_path, &save_data) {
+                Ok(()) => info!("Successfully saved world: {}", event.world_name),
+                Err(e) => error!("{} (world: {})", e, event.world_name),
             }
         } else {
             warn!("No current world to save");
@@ -617,7 +559,8 @@ fn handle_create_world_events(
     mut voxel_world: ResMut<VoxelWorld>,
     mut commands: Commands,
     mut discovered_worlds: ResMut<DiscoveredWorlds>,
-    mut pending_commands: ResMut<PendingCommands>,
+    #[cfg(target_arch = "wasm32")] mut pending_commands: ResMut<PendingCommands>,
+    #[cfg(not(target_arch = "wasm32"))] mut pending_scripts: ResMut<PendingScripts>,
     existing_blocks_query: Query<Entity, With<crate::environment::VoxelBlock>>,
 ) {
     for event in create_events.read() {
@@ -723,26 +666,14 @@ fn handle_create_world_events(
             if std::path::Path::new(&template_path).exists() {
                 match fs::read_to_string(&template_path) {
                     Ok(content) => {
-                        let script_commands = content
-                            .lines()
-                            .map(|line| line.trim())
-                            .filter(|line| !line.is_empty() && !line.starts_with('#'))
-                            .map(|line| line.to_string())
-                            .collect::<Vec<String>>();
-
                         info!(
-                            "Executing world template '{}' with {} commands for world {}",
-                            template_name,
-                            script_commands.len(),
-                            event.world_name
+                            "Executing world template '{}' for world {}",
+                            template_name, event.world_name
                         );
-
-                        // Debug: show first few commands being added
-                        for (i, cmd) in script_commands.iter().take(5).enumerate() {
-                            info!("  Template command {}: '{}'", i, cmd);
-                        }
-
-                        pending_commands.commands.extend(script_commands);
+                        pending_scripts.scripts.push(QueuedScript {
+                            name: template_path,
+                            source: content,
+                        });
                     }
                     Err(e) => {
                         error!("Failed to read world template '{}': {}", template_name, e);
@@ -758,19 +689,14 @@ fn handle_create_world_events(
                     );
                     match fs::read_to_string(fallback_script_path) {
                         Ok(content) => {
-                            let script_commands = content
-                                .lines()
-                                .map(|line| line.trim())
-                                .filter(|line| !line.is_empty() && !line.starts_with('#'))
-                                .map(|line| line.to_string())
-                                .collect::<Vec<String>>();
-
                             info!(
-                                "Executing fallback world script with {} commands for world {}",
-                                script_commands.len(),
+                                "Executing fallback world script for world {}",
                                 event.world_name
                             );
-                            pending_commands.commands.extend(script_commands);
+                            pending_scripts.scripts.push(QueuedScript {
+                                name: fallback_script_path.to_string(),
+                                source: content,
+                            });
                         }
                         Err(e) => {
                             error!("Failed to read fallback world script: {}", e);
@@ -810,7 +736,7 @@ fn create_empty_world(
     );
 
     // Clear existing blocks in voxel storage
-    voxel_world.blocks.clear();
+    voxel_world.clear();
 
     // Reset scene setup guard to allow template scripts to execute
     #[cfg(target_arch = "wasm32")]
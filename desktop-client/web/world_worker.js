@@ -0,0 +1,22 @@
+// IoTCraft world decode worker
+//
+// Loads the same wasm module as the page and decodes `/data` world payloads off the
+// main thread. Results (metadata, packed blocks and chunk mesh buffers) are posted
+// back with their ArrayBuffers transferred, so nothing is copied between threads.
+// On failure the original payload is handed back for main-thread decoding.
+import init, { worker_decode_world } from './iotcraft_web.js';
+
+const ready = init();
+
+self.onmessage = async event => {
+    const { worldId, payload } = event.data;
+    try {
+        await ready;
+        const result = worker_decode_world(new Uint8Array(payload));
+        const transfer = result.transfer;
+        delete result.transfer;
+        self.postMessage({ worldId, result }, transfer);
+    } catch (error) {
+        self.postMessage({ worldId, error: String(error?.message ?? error), payload }, [payload]);
+    }
+};
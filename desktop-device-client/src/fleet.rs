@@ -0,0 +1,711 @@
+//! Fleet emulator: many lamps, doors and sensors in one process.
+//!
+//! A fleet scenario (a RON file, like mcplay's scenarios) lists groups of devices with
+//! their announcement, command and telemetry rates. Every device has its own MQTT
+//! connection and uses the device topics the desktop client knows: it announces itself on
+//! `devices/announce` and applies `ON`/`OFF` commands from `home/{id}/light`, and sensors
+//! publish readings on `home/sensor/temperature`.
+//!
+//! Two topics are emulator additions that no firmware publishes: lamps and doors report
+//! the state a command left them in on `home/{id}/light/state`, and publish telemetry on
+//! `home/{id}/telemetry`. Fleet results therefore measure the broker, not the firmware.
+//!
+//! A controller connection plays the desktop client. It sends each lamp and door commands
+//! at the scenario's rate and times every command until the device's state report comes
+//! back. Intervals are jittered per device from the scenario's seed, so a run can be
+//! repeated against another broker with the same schedule.
+
+use super::load_test::{micros, LatencySummary};
+use super::{DeviceAnnouncement, DeviceLocation};
+use log::{debug, info, warn};
+use rand::rngs::StdRng;
+use rand::{Rng, SeedableRng};
+use rumqttc::{AsyncClient, Event, Incoming, MqttOptions, QoS};
+use serde::{Deserialize, Serialize};
+use std::cmp::Reverse;
+use std::collections::{BinaryHeap, HashMap, VecDeque};
+use std::sync::Arc;
+use std::time::Duration;
+use tokio::sync::broadcast;
+use tokio::time::{interval, sleep_until, Instant};
+
+/// Devices per row of the classroom grid
+const GRID_COLUMNS: usize = 25;
+/// Distance between neighbouring devices
+const GRID_SPACING: f32 = 1.5;
+/// Time a device gets to connect and subscribe before its first command
+const COMMAND_GRACE: Duration = Duration::from_secs(2);
+
+fn default_ramp_rate() -> f64 {
+    100.0
+}
+
+fn default_jitter() -> f64 {
+    0.2
+}
+
+fn default_ack_timeout() -> f64 {
+    5.0
+}
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, Serialize, Deserialize)]
+pub enum DeviceKind {
+    Lamp,
+    Door,
+    Sensor,
+}
+
+impl DeviceKind {
+    /// `device_type` in announcements
+    pub fn device_type(self) -> &'static str {
+        match self {
+            DeviceKind::Lamp => "lamp",
+            DeviceKind::Door => "door",
+            DeviceKind::Sensor => "sensor",
+        }
+    }
+
+    /// Whether the device takes commands on `home/{id}/light`
+    pub fn commanded(self) -> bool {
+        self != DeviceKind::Sensor
+    }
+}
+
+/// Devices of one kind sharing their rates
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct DeviceGroup {
+    pub kind: DeviceKind,
+    pub count: usize,
+    /// Device ids are `{id_prefix}-{n}`; defaults to `fleet-{device type}`
+    #[serde(default)]
+    pub id_prefix: Option<String>,
+    /// Commands per second the controller sends each device (lamps and doors)
+    #[serde(default)]
+    pub command_rate: f64,
+    /// Telemetry messages per second each device publishes
+    #[serde(default)]
+    pub telemetry_rate: f64,
+    /// Seconds between repeated announcements; 0 announces only on connect
+    #[serde(default)]
+    pub announce_interval_secs: f64,
+    /// Relative jitter of every interval, 0.2 for ±20%
+    #[serde(default = "default_jitter")]
+    pub jitter: f64,
+}
+
+/// A fleet scenario file
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct FleetScenario {
+    pub name: String,
+    #[serde(default)]
+    pub description: String,
+    /// Seconds the fleet runs after the last device started
+    pub duration_secs: f64,
+    /// Devices started per second
+    #[serde(default = "default_ramp_rate")]
+    pub ramp_rate: f64,
+    /// Seed of the per-device jitter
+    #[serde(default)]
+    pub seed: u64,
+    /// Seconds the controller waits for a state report before counting a command as lost
+    #[serde(default = "default_ack_timeout")]
+    pub ack_timeout_secs: f64,
+    pub groups: Vec<DeviceGroup>,
+}
+
+/// One emulated device
+#[derive(Debug, Clone, PartialEq)]
+pub struct FleetDevice {
+    pub id: String,
+    pub group: usize,
+    pub kind: DeviceKind,
+    pub position: [f32; 3],
+}
+
+impl FleetScenario {
+    pub fn parse(content: &str) -> Result<Self, String> {
+        ron::from_str(content).map_err(|e| format!("RON parsing error: {}", e))
+    }
+
+    pub fn load(path: &std::path::Path) -> Result<Self, String> {
+        let content = std::fs::read_to_string(path)
+            .map_err(|e| format!("Cannot read {}: {}", path.display(), e))?;
+        Self::parse(&content)
+    }
+
+    /// Every device of the scenario in start order, laid out on a grid like desks in a
+    /// classroom
+    pub fn devices(&self) -> Vec<FleetDevice> {
+        let mut devices = Vec::new();
+        for (group_index, group) in self.groups.iter().enumerate() {
+            let prefix = group
+                .id_prefix
+                .clone()
+                .unwrap_or_else(|| format!("fleet-{}", group.kind.device_type()));
+            for n in 0..group.count {
+                let slot = devices.len();
+                devices.push(FleetDevice {
+                    id: format!("{}-{}", prefix, n),
+                    group: group_index,
+                    kind: group.kind,
+                    position: [
+                        (slot % GRID_COLUMNS) as f32 * GRID_SPACING,
+                        0.5,
+                        (slot / GRID_COLUMNS) as f32 * GRID_SPACING,
+                    ],
+                });
+            }
+        }
+        devices
+    }
+
+    /// Offset from the start of the run at which the device with the given index starts
+    fn start_offset(&self, index: usize) -> Duration {
+        Duration::from_secs_f64(index as f64 / self.ramp_rate.max(1.0))
+    }
+
+    fn total_devices(&self) -> usize {
+        self.groups.iter().map(|group| group.count).sum()
+    }
+}
+
+/// `1 / rate` seconds scaled by a random factor within `±jitter`; `None` for a zero rate
+pub fn jittered_period(rate: f64, jitter: f64, rng: &mut StdRng) -> Option<Duration> {
+    if rate <= 0.0 {
+        return None;
+    }
+    let jitter = jitter.clamp(0.0, 0.99);
+    let factor = 1.0 + rng.gen_range(-jitter..=jitter);
+    Some(Duration::from_secs_f64(factor / rate))
+}
+
+fn device_rng(seed: u64, index: usize) -> StdRng {
+    StdRng::seed_from_u64(seed ^ (index as u64).wrapping_mul(0x9e37_79b9_7f4a_7c15))
+}
+
+/// Measurements of one device session
+#[derive(Debug, Clone, Default)]
+pub struct DeviceStats {
+    pub group: usize,
+    pub connect_us: Option<u32>,
+    pub announcements: u64,
+    pub commands_received: u64,
+    pub state_reports: u64,
+    pub telemetry: u64,
+    /// Messages not queued because the client's queue was full
+    pub dropped: u64,
+    pub errors: u64,
+}
+
+/// Measurements of the controller
+#[derive(Debug, Clone, Default)]
+pub struct ControllerStats {
+    pub commands_sent: u64,
+    pub dropped: u64,
+    pub acked: u64,
+    /// State reports that did not match the oldest pending command
+    pub mismatched: u64,
+    pub lost: u64,
+    pub latencies_us: Vec<u32>,
+    pub errors: u64,
+}
+
+fn announcement(device: &FleetDevice, state: &str) -> String {
+    serde_json::to_string(&DeviceAnnouncement {
+        device_id: device.id.clone(),
+        device_type: device.kind.device_type().to_string(),
+        state: state.to_string(),
+        location: DeviceLocation {
+            x: device.position[0],
+            y: device.position[1],
+            z: device.position[2],
+        },
+    })
+    .unwrap_or_default()
+}
+
+fn telemetry(device: &FleetDevice, started: Instant, rng: &mut StdRng) -> (String, String) {
+    match device.kind {
+        // Readings as the ESP32 sensor formats them
+        DeviceKind::Sensor => (
+            "home/sensor/temperature".to_string(),
+            format!("{:?}", 21.0 + rng.gen_range(-2.0f32..2.0)),
+        ),
+        _ => (
+            format!("home/{}/telemetry", device.id),
+            serde_json::json!({
+                "device_id": device.id,
+                "uptime_ms": started.elapsed().as_millis() as u64,
+                "rssi": rng.gen_range(-80..-40),
+            })
+            .to_string(),
+        ),
+    }
+}
+
+async fn run_device(
+    index: usize,
+    device: FleetDevice,
+    scenario: Arc<FleetScenario>,
+    host: Arc<str>,
+    port: u16,
+    deadline: Instant,
+    mut shutdown_rx: broadcast::Receiver<()>,
+) -> DeviceStats {
+    let group = &scenario.groups[device.group];
+    let mut stats = DeviceStats {
+        group: device.group,
+        ..Default::default()
+    };
+    let mut rng = device_rng(scenario.seed, index);
+    let mut options = MqttOptions::new(&device.id, host.as_ref(), port);
+    options.set_keep_alive(Duration::from_secs(30));
+    options.set_clean_session(true);
+    let (client, mut eventloop) = AsyncClient::new(options, 16);
+
+    let light_topic = format!("home/{}/light", device.id);
+    let state_topic = format!("home/{}/light/state", device.id);
+    let started = Instant::now();
+    // Spread the first message of each device over one period
+    let first = |rate: f64, rng: &mut StdRng| {
+        (rate > 0.0).then(|| started + Duration::from_secs_f64(rng.gen_range(0.0..1.0) / rate))
+    };
+    let mut next_telemetry = first(group.telemetry_rate, &mut rng);
+    let announce_rate = match group.announce_interval_secs {
+        secs if secs > 0.0 => 1.0 / secs,
+        _ => 0.0,
+    };
+    let mut next_announce = first(announce_rate, &mut rng);
+    let far = deadline + Duration::from_secs(3600);
+
+    loop {
+        tokio::select! {
+            event = eventloop.poll() => match event {
+                Ok(Event::Incoming(Incoming::ConnAck(_))) => {
+                    stats.connect_us.get_or_insert(micros(started.elapsed()));
+                    if device.kind.commanded() {
+                        let _ = client.try_subscribe(&light_topic, QoS::AtLeastOnce);
+                    }
+                    match client.try_publish("devices/announce", QoS::AtLeastOnce, false, announcement(&device, "online")) {
+                        Ok(()) => stats.announcements += 1,
+                        Err(_) => stats.dropped += 1,
+                    }
+                }
+                Ok(Event::Incoming(Incoming::Publish(p))) if p.topic == light_topic => {
+                    stats.commands_received += 1;
+                    // Report the state the command left the device in so the controller can
+                    // time the command
+                    let state = match &p.payload[..] {
+                        b"ON" => "ON",
+                        b"OFF" => "OFF",
+                        _ => continue,
+                    };
+                    match client.try_publish(&state_topic, QoS::AtMostOnce, false, state) {
+                        Ok(()) => stats.state_reports += 1,
+                        Err(_) => stats.dropped += 1,
+                    }
+                }
+                Ok(_) => {}
+                Err(e) => {
+                    stats.errors += 1;
+                    debug!("Fleet device {} connection error: {:?}", device.id, e);
+                    tokio::time::sleep(Duration::from_secs(1)).await;
+                }
+            },
+            _ = sleep_until(next_telemetry.unwrap_or(far)), if next_telemetry.is_some() && stats.connect_us.is_some() => {
+                let (topic, payload) = telemetry(&device, started, &mut rng);
+                match client.try_publish(topic, QoS::AtMostOnce, false, payload) {
+                    Ok(()) => stats.telemetry += 1,
+                    Err(_) => stats.dropped += 1,
+                }
+                next_telemetry = jittered_period(group.telemetry_rate, group.jitter, &mut rng)
+                    .map(|period| Instant::now() + period);
+            }
+            _ = sleep_until(next_announce.unwrap_or(far)), if next_announce.is_some() && stats.connect_us.is_some() => {
+                match client.try_publish("devices/announce", QoS::AtLeastOnce, false, announcement(&device, "online")) {
+                    Ok(()) => stats.announcements += 1,
+                    Err(_) => stats.dropped += 1,
+                }
+                next_announce = jittered_period(announce_rate, group.jitter, &mut rng)
+                    .map(|period| Instant::now() + period);
+            }
+            _ = sleep_until(deadline) => break,
+            _ = shutdown_rx.recv() => break,
+        }
+    }
+
+    if stats.connect_us.is_some() {
+        let _ = client.try_publish(
+            "devices/announce",
+            QoS::AtLeastOnce,
+            false,
+            announcement(&device, "offline"),
+        );
+    }
+    let _ = client.try_disconnect();
+    // Flush the offline announcement and the disconnect
+    let _ = tokio::time::timeout(Duration::from_millis(200), async {
+        while eventloop.poll().await.is_ok() {}
+    })
+    .await;
+    stats
+}
+
+/// Commands sent to one device and not yet acknowledged, oldest first
+#[derive(Default)]
+struct PendingCommands {
+    state_on: bool,
+    pending: VecDeque<(bool, Instant)>,
+}
+
+#[allow(clippy::too_many_arguments)]
+async fn run_controller(
+    devices: Arc<Vec<FleetDevice>>,
+    scenario: Arc<FleetScenario>,
+    run_id: Arc<str>,
+    host: Arc<str>,
+    port: u16,
+    run_started: Instant,
+    deadline: Instant,
+    mut shutdown_rx: broadcast::Receiver<()>,
+) -> ControllerStats {
+    let mut stats = ControllerStats::default();
+    let mut options = MqttOptions::new(format!("fleet-controller-{}", run_id), host.as_ref(), port);
+    options.set_keep_alive(Duration::from_secs(30));
+    options.set_clean_session(true);
+    let (client, mut eventloop) = AsyncClient::new(options, 4096);
+    let ack_timeout = Duration::from_secs_f64(scenario.ack_timeout_secs.max(0.0));
+
+    let index_of: HashMap<&str, usize> = devices
+        .iter()
+        .enumerate()
+        .map(|(index, device)| (device.id.as_str(), index))
+        .collect();
+    let mut commands: Vec<PendingCommands> =
+        devices.iter().map(|_| PendingCommands::default()).collect();
+    let mut rng = device_rng(scenario.seed, usize::MAX);
+    // Next command per device, earliest first
+    let mut schedule = BinaryHeap::new();
+    for (index, device) in devices.iter().enumerate() {
+        let group = &scenario.groups[device.group];
+        if !device.kind.commanded() || group.command_rate <= 0.0 {
+            continue;
+        }
+        let offset = rng.gen_range(0.0..1.0) / group.command_rate;
+        let at = run_started
+            + scenario.start_offset(index)
+            + COMMAND_GRACE
+            + Duration::from_secs_f64(offset);
+        schedule.push(Reverse((at, index)));
+    }
+    let mut expiry = interval(Duration::from_secs(1));
+    let far = deadline + Duration::from_secs(3600);
+
+    loop {
+        let next_command = schedule.peek().map(|Reverse((at, _))| *at);
+        tokio::select! {
+            event = eventloop.poll() => match event {
+                Ok(Event::Incoming(Incoming::ConnAck(_))) => {
+                    let _ = client.try_subscribe("home/+/light/state", QoS::AtMostOnce);
+                }
+                Ok(Event::Incoming(Incoming::Publish(p))) => {
+                    let Some(id) = p.topic.strip_prefix("home/").and_then(|rest| rest.strip_suffix("/light/state")) else {
+                        continue;
+                    };
+                    let Some(&index) = index_of.get(id) else {
+                        continue;
+                    };
+                    let Some((state_on, sent)) = commands[index].pending.pop_front() else {
+                        continue;
+                    };
+                    if (&p.payload[..] == b"ON") == state_on {
+                        stats.acked += 1;
+                        stats.latencies_us.push(micros(sent.elapsed()));
+                    } else {
+                        stats.mismatched += 1;
+                    }
+                }
+                Ok(_) => {}
+                Err(e) => {
+                    stats.errors += 1;
+                    debug!("Fleet controller connection error: {:?}", e);
+                    tokio::time::sleep(Duration::from_secs(1)).await;
+                }
+            },
+            _ = sleep_until(next_command.unwrap_or(far)), if next_command.is_some() => {
+                let Some(Reverse((_, index))) = schedule.pop() else {
+                    continue;
+                };
+                let device = &devices[index];
+                let group = &scenario.groups[device.group];
+                let command = &mut commands[index];
+                command.state_on = !command.state_on;
+                let payload = if command.state_on { "ON" } else { "OFF" };
+                let topic = format!("home/{}/light", device.id);
+                match client.try_publish(topic, QoS::AtMostOnce, false, payload) {
+                    Ok(()) => {
+                        stats.commands_sent += 1;
+                        command.pending.push_back((command.state_on, Instant::now()));
+                    }
+                    Err(_) => stats.dropped += 1,
+                }
+                if let Some(period) = jittered_period(group.command_rate, group.jitter, &mut rng) {
+                    schedule.push(Reverse((Instant::now() + period, index)));
+                }
+            }
+            _ = expiry.tick() => {
+                for command in &mut commands {
+                    while command.pending.front().is_some_and(|(_, sent)| sent.elapsed() > ack_timeout) {
+                        command.pending.pop_front();
+                        stats.lost += 1;
+                    }
+                }
+            }
+            _ = sleep_until(deadline) => break,
+            _ = shutdown_rx.recv() => break,
+        }
+    }
+
+    stats.lost += commands
+        .iter()
+        .map(|command| command.pending.len() as u64)
+        .sum::<u64>();
+    let _ = client.try_disconnect();
+    stats
+}
+
+/// Devices of one group in the report
+#[derive(Debug, Clone, Serialize)]
+pub struct GroupReport {
+    pub kind: DeviceKind,
+    pub devices: usize,
+    pub connected: usize,
+    pub announcements: u64,
+    pub commands_received: u64,
+    pub state_reports: u64,
+    pub telemetry: u64,
+    pub telemetry_rate_per_sec: f64,
+}
+
+#[derive(Debug, Clone, Default, Serialize)]
+pub struct CommandReport {
+    pub sent: u64,
+    pub dropped: u64,
+    pub acked: u64,
+    pub mismatched: u64,
+    pub lost: u64,
+    pub rate_per_sec: f64,
+    /// Command published until the device's state report arrived
+    pub latency_ms: LatencySummary,
+}
+
+/// Result of a fleet run, written as JSON for comparing brokers
+#[derive(Debug, Clone, Serialize)]
+pub struct FleetReport {
+    pub run_id: String,
+    pub started_at: String,
+    pub scenario: FleetScenario,
+    pub broker: String,
+    pub elapsed_secs: f64,
+    pub devices: usize,
+    pub connected: usize,
+    pub connect_latency_ms: LatencySummary,
+    pub groups: Vec<GroupReport>,
+    pub commands: CommandReport,
+    pub dropped: u64,
+    pub errors: u64,
+}
+
+impl FleetReport {
+    pub fn from_runs(
+        scenario: &FleetScenario,
+        run_id: &str,
+        started_at: String,
+        broker: String,
+        devices: Vec<DeviceStats>,
+        controller: ControllerStats,
+        elapsed: Duration,
+    ) -> Self {
+        let secs = elapsed.as_secs_f64().max(1e-9);
+        let mut groups: Vec<GroupReport> = scenario
+            .groups
+            .iter()
+            .map(|group| GroupReport {
+                kind: group.kind,
+                devices: group.count,
+                connected: 0,
+                announcements: 0,
+                commands_received: 0,
+                state_reports: 0,
+                telemetry: 0,
+                telemetry_rate_per_sec: 0.0,
+            })
+            .collect();
+        let mut connect_samples = Vec::new();
+        let mut dropped = controller.dropped;
+        let mut errors = controller.errors;
+        for device in &devices {
+            if let Some(group) = groups.get_mut(device.group) {
+                group.connected += usize::from(device.connect_us.is_some());
+                group.announcements += device.announcements;
+                group.commands_received += device.commands_received;
+                group.state_reports += device.state_reports;
+                group.telemetry += device.telemetry;
+            }
+            connect_samples.extend(device.connect_us);
+            dropped += device.dropped;
+            errors += device.errors;
+        }
+        for group in &mut groups {
+            group.telemetry_rate_per_sec = group.telemetry as f64 / secs;
+        }
+
+        Self {
+            run_id: run_id.to_string(),
+            started_at,
+            scenario: scenario.clone(),
+            broker,
+            elapsed_secs: elapsed.as_secs_f64(),
+            devices: scenario.total_devices(),
+            connected: connect_samples.len(),
+            connect_latency_ms: LatencySummary::from_micros(connect_samples),
+            groups,
+            commands: CommandReport {
+                sent: controller.commands_sent,
+                dropped: controller.dropped,
+                acked: controller.acked,
+                mismatched: controller.mismatched,
+                lost: controller.lost,
+                rate_per_sec: controller.commands_sent as f64 / secs,
+                latency_ms: LatencySummary::from_micros(controller.latencies_us),
+            },
+            dropped,
+            errors,
+        }
+    }
+
+    /// Human-readable summary for the log
+    pub fn summary(&self) -> String {
+        let commands = &self.commands;
+        let mut summary = format!(
+            "Fleet {} ({}) against {}: {}/{} devices connected, connect p50 {:.1} ms p99 {:.1} ms\n\
+             commands: {} sent ({:.1}/s), {} acked, {} lost, {} mismatched, \
+             command-to-ack p50 {:.2} ms p90 {:.2} ms p99 {:.2} ms max {:.2} ms",
+            self.scenario.name,
+            self.run_id,
+            self.broker,
+            self.connected,
+            self.devices,
+            self.connect_latency_ms.p50,
+            self.connect_latency_ms.p99,
+            commands.sent,
+            commands.rate_per_sec,
+            commands.acked,
+            commands.lost,
+            commands.mismatched,
+            commands.latency_ms.p50,
+            commands.latency_ms.p90,
+            commands.latency_ms.p99,
+            commands.latency_ms.max,
+        );
+        for group in &self.groups {
+            summary.push_str(&format!(
+                "\n{}: {}/{} connected, {} announcements, {} commands received, {} telemetry ({:.1}/s)",
+                group.kind.device_type(),
+                group.connected,
+                group.devices,
+                group.announcements,
+                group.commands_received,
+                group.telemetry,
+                group.telemetry_rate_per_sec,
+            ));
+        }
+        summary
+    }
+}
+
+/// Start every device of the scenario at its ramp rate, run the controller alongside and
+/// collect their measurements
+pub async fn run_fleet(scenario: FleetScenario, host: String, port: u16) -> FleetReport {
+    let scenario = Arc::new(scenario);
+    let run_id: String = uuid::Uuid::new_v4().simple().to_string()[..8].to_string();
+    let run_id: Arc<str> = run_id.into();
+    let started_at = chrono::Utc::now().to_rfc3339();
+    let devices = Arc::new(scenario.devices());
+    let host: Arc<str> = host.into();
+    let ramp = scenario.start_offset(devices.len());
+    info!(
+        "🏫 Fleet {} ({}): {} devices against {}:{}, ramping over {:.1}s, then {:.0}s",
+        scenario.name,
+        run_id,
+        devices.len(),
+        host,
+        port,
+        ramp.as_secs_f64(),
+        scenario.duration_secs
+    );
+
+    let (shutdown_tx, _) = broadcast::channel(1);
+    let signal_tx = shutdown_tx.clone();
+    tokio::spawn(async move {
+        if tokio::signal::ctrl_c().await.is_ok() {
+            warn!("🛑 Received CTRL+C, stopping fleet early");
+            let _ = signal_tx.send(());
+        }
+    });
+
+    let run_started = Instant::now();
+    let deadline = run_started + ramp + Duration::from_secs_f64(scenario.duration_secs.max(0.0));
+    let controller = tokio::spawn(run_controller(
+        devices.clone(),
+        scenario.clone(),
+        run_id.clone(),
+        host.clone(),
+        port,
+        run_started,
+        deadline,
+        shutdown_tx.subscribe(),
+    ));
+
+    let mut handles = Vec::with_capacity(devices.len());
+    let mut stop_rx = shutdown_tx.subscribe();
+    for (index, device) in devices.iter().enumerate() {
+        tokio::select! {
+            _ = sleep_until(run_started + scenario.start_offset(index)) => {}
+            _ = stop_rx.recv() => break,
+        }
+        handles.push(tokio::spawn(run_device(
+            index,
+            device.clone(),
+            scenario.clone(),
+            host.clone(),
+            port,
+            deadline,
+            shutdown_tx.subscribe(),
+        )));
+    }
+    info!(
+        "🏫 Started {} devices in {:.1}s",
+        handles.len(),
+        run_started.elapsed().as_secs_f64()
+    );
+
+    let mut stats = Vec::with_capacity(handles.len());
+    for handle in handles {
+        match handle.await {
+            Ok(device) => stats.push(device),
+            Err(e) => warn!("Fleet device failed: {}", e),
+        }
+    }
+    let controller = controller.await.unwrap_or_default();
+
+    FleetReport::from_runs(
+        &scenario,
+        &run_id,
+        started_at,
+        format!("{}:{}", host, port),
+        stats,
+        controller,
+        run_started.elapsed(),
+    )
+}
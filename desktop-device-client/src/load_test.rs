@@ -0,0 +1,797 @@
+//! Load generator: many device and player sessions in one process.
+//!
+//! Every session owns its own MQTT connection on the shared Tokio runtime and behaves like
+//! a single `desktop-device-client`: devices announce themselves and receive light
+//! commands, players publish poses with a movement pattern, and a share of the players
+//! join the world by requesting a snapshot from the broker.
+//!
+//! End-to-end latency is measured without relying on clocks across machines: each session
+//! subscribes to its own command or pose topic and times every message from publish until
+//! the broker delivers it back.
+//!
+//! Optional flooder sessions misbehave on purpose, publishing poses and snapshot requests
+//! far above any real client's rate. Comparing the well-behaved sessions' latencies and
+//! joins with and without flooders shows how well the broker isolates them. The server's
+//! client budgets only limit its own work for a flooder; every flooded pose is still
+//! routed to the other sessions.
+
+use super::{
+    generate_player_id, now_ts, update_player_position, DeviceAnnouncement, DeviceLocation,
+    PlayerState, PoseMessage,
+};
+use log::{debug, info, warn};
+use rumqttc::{AsyncClient, Event, Incoming, MqttOptions, QoS};
+use serde::{Deserialize, Serialize};
+use std::collections::VecDeque;
+use std::sync::Arc;
+use std::time::Duration;
+use tokio::sync::broadcast;
+use tokio::time::{interval, Instant, MissedTickBehavior};
+
+/// Most published messages a session waits on before counting the oldest as lost
+const MAX_IN_FLIGHT: usize = 1024;
+
+/// Movement patterns cycled through by sessions when the pattern is `mixed`
+const MIXED_PATTERNS: [&str; 3] = ["static", "circle", "random"];
+
+/// Parameters of one load-test run
+#[derive(Debug, Clone, Serialize)]
+pub struct LoadTestConfig {
+    pub host: String,
+    pub port: u16,
+    /// Concurrent sessions to start
+    pub sessions: usize,
+    /// Fraction of sessions emulating devices; the rest emulate players
+    pub device_ratio: f64,
+    /// Fraction of player sessions that join the world on connect
+    pub join_ratio: f64,
+    /// Sessions started per second while ramping up
+    pub ramp_rate: f64,
+    /// Seconds all sessions keep running after the ramp-up
+    pub duration_secs: f64,
+    /// Messages per second published by each session
+    pub publish_rate: f64,
+    /// Player movement pattern (`static`, `circle`, `random` or `mixed`)
+    pub movement_pattern: String,
+    pub world_id: String,
+    /// Number of worlds sessions are spread over; above one, worlds are named
+    /// `{world_id}-{n}`
+    pub worlds: usize,
+    /// `host:port` of every shard of an mqtt-server cluster, in shard order; sessions
+    /// connect to the shard owning their world. Empty for a single broker at `host:port`.
+    pub cluster: Vec<String>,
+    /// Seconds a joining session waits for its snapshot
+    pub join_timeout_secs: f64,
+    /// Misbehaving sessions started in addition to `sessions`
+    pub flooders: usize,
+    /// Poses and snapshot requests per second published by each flooder
+    pub flood_rate: f64,
+}
+
+impl LoadTestConfig {
+    /// World of the session with the given index
+    pub fn world_of(&self, index: usize) -> String {
+        if self.worlds > 1 {
+            format!("{}-{}", self.world_id, index % self.worlds)
+        } else {
+            self.world_id.clone()
+        }
+    }
+
+    /// Shard and broker address serving a world
+    pub fn broker_for(&self, world_id: &str) -> (usize, String, u16) {
+        if self.cluster.is_empty() {
+            return (0, self.host.clone(), self.port);
+        }
+        let shard = shard_for_world(world_id, self.cluster.len());
+        let (host, port) = self.cluster[shard]
+            .rsplit_once(':')
+            .and_then(|(host, port)| Some((host.to_string(), port.parse().ok()?)))
+            .unwrap_or_else(|| (self.host.clone(), self.port));
+        (shard, host, port)
+    }
+}
+
+/// Shard of an mqtt-server cluster owning a world: FNV-1a of the world id, as computed by
+/// the server
+pub fn shard_for_world(world_id: &str, shards: usize) -> usize {
+    let mut hash: u64 = 0xcbf2_9ce4_8422_2325;
+    for byte in world_id.bytes() {
+        hash ^= u64::from(byte);
+        hash = hash.wrapping_mul(0x0100_0000_01b3);
+    }
+    (hash % shards.max(1) as u64) as usize
+}
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum SessionRole {
+    Device,
+    Player {
+        joins: bool,
+    },
+    /// Publishes poses and snapshot requests at the flood rate
+    Flooder,
+}
+
+/// Whether `index` is one of the `ratio` share of `0..`, spread evenly over the indices
+fn in_share(index: usize, ratio: f64) -> bool {
+    let ratio = ratio.clamp(0.0, 1.0);
+    ((index + 1) as f64 * ratio).floor() > (index as f64 * ratio).floor()
+}
+
+/// Role of the session with the given index
+pub fn session_role(index: usize, config: &LoadTestConfig) -> SessionRole {
+    if index >= config.sessions {
+        return SessionRole::Flooder;
+    }
+    let device_ratio = config.device_ratio.clamp(0.0, 1.0);
+    if in_share(index, device_ratio) {
+        SessionRole::Device
+    } else {
+        // Spread joins over the players rather than over all sessions
+        let player_index = index - (index as f64 * device_ratio).floor() as usize;
+        SessionRole::Player {
+            joins: in_share(player_index, config.join_ratio),
+        }
+    }
+}
+
+/// Latency distribution in milliseconds
+#[derive(Debug, Clone, Default, PartialEq, Serialize)]
+pub struct LatencySummary {
+    pub count: usize,
+    pub mean: f64,
+    pub p50: f64,
+    pub p90: f64,
+    pub p99: f64,
+    pub p999: f64,
+    pub max: f64,
+}
+
+impl LatencySummary {
+    /// Summarize latencies given in microseconds
+    pub fn from_micros(mut samples: Vec<u32>) -> Self {
+        if samples.is_empty() {
+            return Self::default();
+        }
+        samples.sort_unstable();
+        let ms = |us: u32| f64::from(us) / 1000.0;
+        let percentile = |p: f64| {
+            let rank = (p * samples.len() as f64).ceil() as usize;
+            ms(samples[rank.clamp(1, samples.len()) - 1])
+        };
+        let total: u64 = samples.iter().map(|&us| u64::from(us)).sum();
+        Self {
+            count: samples.len(),
+            mean: total as f64 / samples.len() as f64 / 1000.0,
+            p50: percentile(0.50),
+            p90: percentile(0.90),
+            p99: percentile(0.99),
+            p999: percentile(0.999),
+            max: ms(samples[samples.len() - 1]),
+        }
+    }
+}
+
+/// What one session measured
+#[derive(Debug, Default)]
+pub struct SessionStats {
+    pub role: Option<SessionRole>,
+    /// Cluster shard the session connected to
+    pub shard: usize,
+    /// Time from starting the session to its first ConnAck
+    pub connect_us: Option<u32>,
+    /// When the first ConnAck arrived, relative to the start of the run
+    pub connected_at: Option<Duration>,
+    pub sent: u64,
+    pub received: u64,
+    /// Publishes refused because the client's request queue was full
+    pub dropped: u64,
+    /// Publishes that never came back
+    pub lost: u64,
+    pub latencies_us: Vec<u32>,
+    pub join_requested: bool,
+    pub join_us: Option<u32>,
+    pub join_bytes: usize,
+    pub errors: u64,
+}
+
+pub(crate) fn micros(elapsed: Duration) -> u32 {
+    elapsed.as_micros().min(u128::from(u32::MAX)) as u32
+}
+
+/// Pose payload of load-test players: a regular pose plus a sequence number for matching
+/// the echo; the desktop client ignores the extra field
+#[derive(Serialize)]
+struct LoadPose<'a> {
+    #[serde(flatten)]
+    pose: &'a PoseMessage,
+    seq: u64,
+}
+
+#[derive(Deserialize)]
+struct EchoSeq {
+    seq: u64,
+}
+
+/// Publishes a session is waiting to see delivered back, oldest first
+#[derive(Debug, Default)]
+struct InFlight {
+    pending: VecDeque<(u64, Instant)>,
+}
+
+impl InFlight {
+    fn push(&mut self, seq: u64, sent: Instant, stats: &mut SessionStats) {
+        if self.pending.len() >= MAX_IN_FLIGHT {
+            self.pending.pop_front();
+            stats.lost += 1;
+        }
+        self.pending.push_back((seq, sent));
+    }
+
+    /// Record the delivery of `seq` (or of the oldest publish when the payload carries no
+    /// sequence number); publishes skipped over were lost
+    fn complete(&mut self, seq: Option<u64>, stats: &mut SessionStats) {
+        while let Some((pending_seq, sent)) = self.pending.pop_front() {
+            match seq {
+                Some(seq) if pending_seq < seq => stats.lost += 1,
+                Some(seq) if pending_seq > seq => {
+                    // Older than anything pending: already counted as lost
+                    self.pending.push_front((pending_seq, sent));
+                    return;
+                }
+                _ => {
+                    stats.received += 1;
+                    stats.latencies_us.push(micros(sent.elapsed()));
+                    return;
+                }
+            }
+        }
+    }
+}
+
+/// Spread sessions over the world so players do not all stand on one spot
+fn spawn_position(index: usize) -> [f32; 3] {
+    let ring = (index / 16) as f32 * 2.0;
+    let angle = (index % 16) as f32 * std::f32::consts::TAU / 16.0;
+    [ring * angle.cos(), 2.0, ring * angle.sin()]
+}
+
+async fn run_session(
+    index: usize,
+    role: SessionRole,
+    config: Arc<LoadTestConfig>,
+    run_id: Arc<str>,
+    run_started: Instant,
+    deadline: Instant,
+    mut shutdown_rx: broadcast::Receiver<()>,
+) -> SessionStats {
+    let world_id = config.world_of(index);
+    let (shard, host, port) = config.broker_for(&world_id);
+    let mut stats = SessionStats {
+        role: Some(role),
+        shard,
+        ..Default::default()
+    };
+    let client_id = format!("loadtest-{}-{}", run_id, index);
+    let mut options = MqttOptions::new(&client_id, host, port);
+    options.set_keep_alive(Duration::from_secs(30));
+    options.set_clean_session(true);
+    // Joiners receive whole world snapshots
+    options.set_max_packet_size(5 * 1024 * 1024, 5 * 1024 * 1024);
+    let (client, mut eventloop) = AsyncClient::new(options, 64);
+
+    // The topic each session publishes to and listens on for its own echo
+    let echo_topic = match role {
+        SessionRole::Device => format!("home/{}/light", client_id),
+        SessionRole::Player { .. } | SessionRole::Flooder => {
+            format!("iotcraft/worlds/{}/players/{}/pose", world_id, client_id)
+        }
+    };
+    let join_reply_topic = format!("iotcraft/worlds/{}/clients/{}/data", world_id, client_id);
+    let pattern = match config.movement_pattern.as_str() {
+        "mixed" => MIXED_PATTERNS[index % MIXED_PATTERNS.len()],
+        pattern => pattern,
+    };
+    let mut player_state = PlayerState {
+        position: spawn_position(index),
+        ..Default::default()
+    };
+    let player_name = format!("LoadBot-{}", index);
+    let player_id = generate_player_id();
+
+    let mut in_flight = InFlight::default();
+    let mut seq = 0u64;
+    let mut join_started = None;
+    let started = Instant::now();
+    let mut last_tick = started;
+
+    let rate = match role {
+        SessionRole::Flooder => config.flood_rate,
+        _ => config.publish_rate,
+    };
+    let period = Duration::from_secs_f64(1.0 / rate.max(0.001));
+    let snapshot_request_topic = format!("iotcraft/worlds/{}/snapshot/request", world_id);
+    let mut publish_interval = interval(period);
+    publish_interval.set_missed_tick_behavior(MissedTickBehavior::Skip);
+    let end = tokio::time::sleep_until(deadline);
+    tokio::pin!(end);
+
+    loop {
+        tokio::select! {
+            event = eventloop.poll() => match event {
+                Ok(Event::Incoming(Incoming::ConnAck(_))) => {
+                    if stats.connect_us.is_none() {
+                        stats.connect_us = Some(micros(started.elapsed()));
+                        stats.connected_at = Some(run_started.elapsed());
+                    }
+                    if role == SessionRole::Flooder {
+                        // Counts the snapshots the broker still serves a flooder
+                        let _ = client.try_subscribe(&join_reply_topic, QoS::AtMostOnce);
+                    } else {
+                        let _ = client.try_subscribe(&echo_topic, QoS::AtMostOnce);
+                    }
+                    if role == SessionRole::Device {
+                        let announcement = DeviceAnnouncement {
+                            device_id: client_id.clone(),
+                            device_type: "lamp".to_string(),
+                            state: "online".to_string(),
+                            location: DeviceLocation {
+                                x: player_state.position[0],
+                                y: 0.5,
+                                z: player_state.position[2],
+                            },
+                        };
+                        if let Ok(payload) = serde_json::to_string(&announcement) {
+                            let _ = client.try_publish("devices/announce", QoS::AtLeastOnce, false, payload);
+                        }
+                    }
+                    if role == (SessionRole::Player { joins: true }) && !stats.join_requested {
+                        let _ = client.try_subscribe(&join_reply_topic, QoS::AtMostOnce);
+                        let request = serde_json::json!({ "client_id": client_id }).to_string();
+                        if client.try_publish(&snapshot_request_topic, QoS::AtLeastOnce, false, request).is_ok() {
+                            stats.join_requested = true;
+                            join_started = Some(Instant::now());
+                        }
+                    }
+                }
+                Ok(Event::Incoming(Incoming::Publish(p))) => {
+                    if role == SessionRole::Flooder {
+                        stats.received += u64::from(p.topic == join_reply_topic);
+                    } else if p.topic == echo_topic {
+                        let seq = match role {
+                            SessionRole::Device => None,
+                            SessionRole::Player { .. } | SessionRole::Flooder => serde_json::from_slice::<EchoSeq>(&p.payload)
+                                .ok()
+                                .map(|echo| echo.seq),
+                        };
+                        in_flight.complete(seq, &mut stats);
+                    } else if p.topic == join_reply_topic && stats.join_us.is_none() {
+                        stats.join_us = join_started.map(|t: Instant| micros(t.elapsed()));
+                        stats.join_bytes = p.payload.len();
+                    }
+                }
+                Ok(_) => {}
+                Err(e) => {
+                    stats.errors += 1;
+                    debug!("Load-test session {} connection error: {:?}", index, e);
+                    tokio::time::sleep(Duration::from_secs(1)).await;
+                }
+            },
+            _ = publish_interval.tick(), if stats.connect_us.is_some() => {
+                let now = Instant::now();
+                let payload = match role {
+                    SessionRole::Device => if seq % 2 == 0 { "ON".to_string() } else { "OFF".to_string() },
+                    SessionRole::Player { .. } | SessionRole::Flooder => {
+                        update_player_position(&mut player_state, pattern, (now - last_tick).as_secs_f32());
+                        let pose = PoseMessage {
+                            player_id: player_id.clone(),
+                            player_name: player_name.clone(),
+                            pos: player_state.position,
+                            yaw: player_state.yaw,
+                            pitch: player_state.pitch,
+                            ts: now_ts(),
+                        };
+                        serde_json::to_string(&LoadPose { pose: &pose, seq }).unwrap_or_default()
+                    }
+                };
+                last_tick = now;
+                match client.try_publish(&echo_topic, QoS::AtMostOnce, false, payload) {
+                    Ok(()) if role == SessionRole::Flooder => stats.sent += 1,
+                    Ok(()) => {
+                        stats.sent += 1;
+                        in_flight.push(seq, now, &mut stats);
+                    }
+                    Err(_) => stats.dropped += 1,
+                }
+                if role == SessionRole::Flooder {
+                    let request = serde_json::json!({ "client_id": client_id }).to_string();
+                    match client.try_publish(&snapshot_request_topic, QoS::AtMostOnce, false, request) {
+                        Ok(()) => stats.sent += 1,
+                        Err(_) => stats.dropped += 1,
+                    }
+                }
+                seq += 1;
+            }
+            _ = &mut end => break,
+            _ = shutdown_rx.recv() => break,
+        }
+    }
+
+    stats.lost += in_flight.pending.len() as u64;
+    if role == SessionRole::Device && stats.connect_us.is_some() {
+        let announcement = DeviceAnnouncement {
+            device_id: client_id.clone(),
+            device_type: "lamp".to_string(),
+            state: "offline".to_string(),
+            location: DeviceLocation {
+                x: player_state.position[0],
+                y: 0.5,
+                z: player_state.position[2],
+            },
+        };
+        if let Ok(payload) = serde_json::to_string(&announcement) {
+            let _ = client.try_publish("devices/announce", QoS::AtLeastOnce, false, payload);
+        }
+    }
+    let _ = client.try_disconnect();
+    // Flush the offline announcement and the disconnect
+    let _ = tokio::time::timeout(Duration::from_millis(200), async {
+        while eventloop.poll().await.is_ok() {}
+    })
+    .await;
+    stats
+}
+
+#[derive(Debug, Clone, Default, Serialize)]
+pub struct SessionCounts {
+    pub requested: usize,
+    pub devices: usize,
+    pub players: usize,
+    pub flooders: usize,
+    pub connected: usize,
+    pub failed: usize,
+}
+
+#[derive(Debug, Clone, Default, Serialize)]
+pub struct ConnectReport {
+    /// Sessions connected per second, from the start of the run to the last ConnAck
+    pub setup_rate_per_sec: f64,
+    pub latency_ms: LatencySummary,
+}
+
+#[derive(Debug, Clone, Default, Serialize)]
+pub struct MessageReport {
+    pub sent: u64,
+    pub received: u64,
+    pub dropped: u64,
+    pub lost: u64,
+    pub send_rate_per_sec: f64,
+    pub receive_rate_per_sec: f64,
+    /// Publish until the broker delivered the message back
+    pub latency_ms: LatencySummary,
+}
+
+#[derive(Debug, Clone, Default, Serialize)]
+pub struct JoinReport {
+    pub requested: usize,
+    pub completed: usize,
+    pub timed_out: usize,
+    /// Snapshot request until the snapshot arrived
+    pub latency_ms: LatencySummary,
+    pub mean_snapshot_bytes: f64,
+}
+
+/// What the flooder sessions sent and how much of it the broker still answered
+#[derive(Debug, Clone, Default, Serialize)]
+pub struct FloodReport {
+    pub sessions: usize,
+    /// Poses and snapshot requests
+    pub sent: u64,
+    pub send_rate_per_sec: f64,
+    pub snapshots_received: u64,
+}
+
+/// Traffic handled by one shard of a cluster
+#[derive(Debug, Clone, Default, Serialize)]
+pub struct ShardReport {
+    pub address: String,
+    pub sessions: usize,
+    pub connected: usize,
+    pub sent: u64,
+    pub received: u64,
+    pub receive_rate_per_sec: f64,
+}
+
+/// Result of a load-test run, written as JSON for comparing runs
+#[derive(Debug, Clone, Serialize)]
+pub struct LoadTestReport {
+    pub run_id: String,
+    pub started_at: String,
+    pub config: LoadTestConfig,
+    pub elapsed_secs: f64,
+    pub ramp_secs: f64,
+    pub sessions: SessionCounts,
+    pub connect: ConnectReport,
+    pub messages: MessageReport,
+    pub joins: JoinReport,
+    /// Flooder sessions, kept out of the other figures
+    pub flood: FloodReport,
+    /// Per-shard breakdown when testing a cluster
+    pub shards: Vec<ShardReport>,
+    pub errors: u64,
+}
+
+impl LoadTestReport {
+    pub fn from_sessions(
+        config: &LoadTestConfig,
+        run_id: &str,
+        started_at: String,
+        sessions: Vec<SessionStats>,
+        failed: usize,
+        ramp: Duration,
+        elapsed: Duration,
+    ) -> Self {
+        let secs = elapsed.as_secs_f64().max(1e-9);
+        let mut counts = SessionCounts {
+            requested: config.sessions,
+            failed,
+            ..Default::default()
+        };
+        let mut connect_samples = Vec::new();
+        let mut last_connect = Duration::ZERO;
+        let mut messages = MessageReport::default();
+        let mut latencies = Vec::new();
+        let mut joins = JoinReport::default();
+        let mut join_samples = Vec::new();
+        let mut join_bytes = 0usize;
+        let mut flood = FloodReport::default();
+        let mut errors = 0;
+        let mut shards: Vec<ShardReport> = config
+            .cluster
+            .iter()
+            .map(|address| ShardReport {
+                address: address.clone(),
+                ..Default::default()
+            })
+            .collect();
+
+        for session in sessions {
+            if session.role == Some(SessionRole::Flooder) {
+                counts.flooders += 1;
+                flood.sessions += 1;
+                flood.sent += session.sent;
+                flood.snapshots_received += session.received;
+                continue;
+            }
+            if let Some(shard) = shards.get_mut(session.shard) {
+                shard.sessions += 1;
+                shard.connected += usize::from(session.connect_us.is_some());
+                shard.sent += session.sent;
+                shard.received += session.received;
+            }
+            match session.role {
+                Some(SessionRole::Device) => counts.devices += 1,
+                Some(SessionRole::Player { .. }) => counts.players += 1,
+                Some(SessionRole::Flooder) | None => {}
+            }
+            if let (Some(connect_us), Some(at)) = (session.connect_us, session.connected_at) {
+                counts.connected += 1;
+                connect_samples.push(connect_us);
+                last_connect = last_connect.max(at);
+            }
+            messages.sent += session.sent;
+            messages.received += session.received;
+            messages.dropped += session.dropped;
+            messages.lost += session.lost;
+            latencies.extend(session.latencies_us);
+            if session.join_requested {
+                joins.requested += 1;
+                match session.join_us {
+                    Some(join_us) => {
+                        joins.completed += 1;
+                        join_samples.push(join_us);
+                        join_bytes += session.join_bytes;
+                    }
+                    None => joins.timed_out += 1,
+                }
+            }
+            errors += session.errors;
+        }
+
+        for shard in &mut shards {
+            shard.receive_rate_per_sec = shard.received as f64 / secs;
+        }
+        messages.send_rate_per_sec = messages.sent as f64 / secs;
+        flood.send_rate_per_sec = flood.sent as f64 / secs;
+        messages.receive_rate_per_sec = messages.received as f64 / secs;
+        messages.latency_ms = LatencySummary::from_micros(latencies);
+        if joins.completed > 0 {
+            joins.mean_snapshot_bytes = join_bytes as f64 / joins.completed as f64;
+        }
+        let join_timeout = micros(Duration::from_secs_f64(config.join_timeout_secs.max(0.0)));
+        // Snapshots later than the timeout count as timed out
+        let late = join_samples.iter().filter(|&&us| us > join_timeout).count();
+        joins.completed -= late;
+        joins.timed_out += late;
+        joins.latency_ms = LatencySummary::from_micros(join_samples);
+
+        Self {
+            run_id: run_id.to_string(),
+            started_at,
+            config: config.clone(),
+            elapsed_secs: elapsed.as_secs_f64(),
+            ramp_secs: ramp.as_secs_f64(),
+            connect: ConnectReport {
+                setup_rate_per_sec: counts.connected as f64 / last_connect.as_secs_f64().max(1e-9),
+                latency_ms: LatencySummary::from_micros(connect_samples),
+            },
+            sessions: counts,
+            messages,
+            joins,
+            flood,
+            shards,
+            errors,
+        }
+    }
+
+    /// Human-readable summary for the log
+    pub fn summary(&self) -> String {
+        let mut summary = format!(
+            "Load test {}: {}/{} sessions connected ({} devices, {} players) at {:.0}/s, \
+             connect p50 {:.1} ms p99 {:.1} ms\n\
+             messages: {} sent ({:.0}/s), {} received ({:.0}/s), {} dropped, {} lost, \
+             latency p50 {:.2} ms p90 {:.2} ms p99 {:.2} ms p99.9 {:.2} ms max {:.2} ms\n\
+             joins: {}/{} completed, {} timed out, p50 {:.1} ms p99 {:.1} ms, {:.0} bytes per snapshot",
+            self.run_id,
+            self.sessions.connected,
+            self.sessions.requested,
+            self.sessions.devices,
+            self.sessions.players,
+            self.connect.setup_rate_per_sec,
+            self.connect.latency_ms.p50,
+            self.connect.latency_ms.p99,
+            self.messages.sent,
+            self.messages.send_rate_per_sec,
+            self.messages.received,
+            self.messages.receive_rate_per_sec,
+            self.messages.dropped,
+            self.messages.lost,
+            self.messages.latency_ms.p50,
+            self.messages.latency_ms.p90,
+            self.messages.latency_ms.p99,
+            self.messages.latency_ms.p999,
+            self.messages.latency_ms.max,
+            self.joins.completed,
+            self.joins.requested,
+            self.joins.timed_out,
+            self.joins.latency_ms.p50,
+            self.joins.latency_ms.p99,
+            self.joins.mean_snapshot_bytes,
+        );
+        if self.flood.sessions > 0 {
+            summary.push_str(&format!(
+                "\nflooders: {} sessions sent {} poses and snapshot requests ({:.0}/s), \
+                 {} snapshots served to them (server budgets limit server-side cost only, \
+                 flooded poses still reach every subscriber)",
+                self.flood.sessions,
+                self.flood.sent,
+                self.flood.send_rate_per_sec,
+                self.flood.snapshots_received,
+            ));
+        }
+        for (index, shard) in self.shards.iter().enumerate() {
+            summary.push_str(&format!(
+                "\nshard {} ({}): {}/{} sessions connected, {} received ({:.0}/s)",
+                index,
+                shard.address,
+                shard.connected,
+                shard.sessions,
+                shard.received,
+                shard.receive_rate_per_sec,
+            ));
+        }
+        summary
+    }
+}
+
+/// Ramp up `config.sessions` sessions followed by the flooders, run them for the configured duration and collect
+/// their measurements
+pub async fn run_load_test(config: LoadTestConfig) -> LoadTestReport {
+    let config = Arc::new(config);
+    let run_id: Arc<str> = generate_player_id()
+        .trim_start_matches("player-")
+        .chars()
+        .take(8)
+        .collect::<String>()
+        .into();
+    let started_at = chrono::Utc::now().to_rfc3339();
+    let ramp_rate = config.ramp_rate.max(1.0);
+    let ramp = Duration::from_secs_f64(config.sessions as f64 / ramp_rate);
+
+    let target = if config.cluster.is_empty() {
+        format!("{}:{}", config.host, config.port)
+    } else {
+        format!("a cluster of {} shards", config.cluster.len())
+    };
+    info!(
+        "🏋️ Load test {}: {} sessions in {} worlds against {}, ramping at {:.0}/s over {:.1}s, then {:.0}s at {:.1} msg/s each",
+        run_id,
+        config.sessions,
+        config.worlds.max(1),
+        target,
+        ramp_rate,
+        ramp.as_secs_f64(),
+        config.duration_secs,
+        config.publish_rate
+    );
+    if config.flooders > 0 {
+        info!(
+            "🌊 Plus {} flooders publishing poses and snapshot requests at {:.0}/s each",
+            config.flooders, config.flood_rate
+        );
+    }
+
+    let (shutdown_tx, _) = broadcast::channel(1);
+    let signal_tx = shutdown_tx.clone();
+    tokio::spawn(async move {
+        if tokio::signal::ctrl_c().await.is_ok() {
+            warn!("🛑 Received CTRL+C, stopping load test early");
+            let _ = signal_tx.send(());
+        }
+    });
+
+    let run_started = Instant::now();
+    let deadline = run_started + ramp + Duration::from_secs_f64(config.duration_secs.max(0.0));
+    let total = config.sessions + config.flooders;
+    let mut handles = Vec::with_capacity(total);
+    let mut spawn_tick = interval(Duration::from_millis(10));
+    let mut stop_rx = shutdown_tx.subscribe();
+    while handles.len() < total {
+        tokio::select! {
+            _ = spawn_tick.tick() => {}
+            _ = stop_rx.recv() => break,
+        }
+        let due = ((run_started.elapsed().as_secs_f64() * ramp_rate).ceil() as usize).min(total);
+        while handles.len() < due {
+            let index = handles.len();
+            handles.push(tokio::spawn(run_session(
+                index,
+                session_role(index, &config),
+                config.clone(),
+                run_id.clone(),
+                run_started,
+                deadline,
+                shutdown_tx.subscribe(),
+            )));
+        }
+    }
+    let ramp_elapsed = run_started.elapsed();
+    info!(
+        "🏋️ Started {} sessions in {:.1}s",
+        handles.len(),
+        ramp_elapsed.as_secs_f64()
+    );
+
+    let mut sessions = Vec::with_capacity(handles.len());
+    let mut failed = config.sessions.saturating_sub(handles.len());
+    for handle in handles {
+        match handle.await {
+            Ok(stats) => sessions.push(stats),
+            Err(e) => {
+                warn!("Load-test session failed: {}", e);
+                failed += 1;
+            }
+        }
+    }
+
+    LoadTestReport::from_sessions(
+        &config,
+        &run_id,
+        started_at,
+        sessions,
+        failed,
+        ramp_elapsed,
+        run_started.elapsed(),
+    )
+}
@@ -9,6 +9,10 @@ use tokio::signal;
 use tokio::sync::{broadcast, RwLock};
 use tokio::time::{interval, MissedTickBehavior};
 
+mod fleet;
+mod load_test;
+mod world_stress;
+
 #[cfg(test)]
 mod tests;
 
@@ -75,6 +79,99 @@ struct Args {
     /// World description
     #[arg(long, default_value = "A new world")]
     world_description: String,
+
+    /// Blocks of the generated world published with --publish-world or --world-stress
+    #[arg(long, default_value_t = 100)]
+    world_blocks: usize,
+
+    /// Seed of generated worlds and edit streams
+    #[arg(long, default_value_t = 0)]
+    seed: u64,
+
+    /// Run a world sync stress test: publish a large world, replay edits and time how long
+    /// subscribers take to converge
+    #[arg(long)]
+    world_stress: bool,
+
+    /// Publish the blocks of this saved world instead of a generated one
+    #[arg(long, value_name = "PATH")]
+    world_file: Option<std::path::PathBuf>,
+
+    /// Replay this edit script (`place x y z Type` / `remove x y z` per line)
+    #[arg(long, value_name = "PATH")]
+    edit_script: Option<std::path::PathBuf>,
+
+    /// Edits generated when no edit script is given
+    #[arg(long, default_value_t = 1000)]
+    edits: usize,
+
+    /// Edits published per second
+    #[arg(long, default_value_t = 100.0)]
+    edit_rate: f64,
+
+    /// Sessions rebuilding the world in the stress test
+    #[arg(long, default_value_t = 4)]
+    subscribers: usize,
+
+    /// Seconds subscribers may take to converge after the last edit
+    #[arg(long, default_value_t = 60.0)]
+    converge_timeout: f64,
+
+    /// Run a load test: many device and player sessions in this process
+    #[arg(long)]
+    load_test: bool,
+
+    /// Number of concurrent sessions in load-test mode
+    #[arg(long, default_value_t = 1000)]
+    sessions: usize,
+
+    /// Fraction of load-test sessions emulating devices (the rest are players)
+    #[arg(long, default_value_t = 0.5)]
+    device_ratio: f64,
+
+    /// Fraction of load-test players that join the world by requesting a snapshot
+    #[arg(long, default_value_t = 0.1)]
+    join_ratio: f64,
+
+    /// Load-test sessions started per second
+    #[arg(long, default_value_t = 200.0)]
+    ramp_rate: f64,
+
+    /// Seconds the load test runs after all sessions started
+    #[arg(long, default_value_t = 30.0)]
+    duration: f64,
+
+    /// Messages per second published by each load-test session
+    #[arg(long, default_value_t = 10.0)]
+    publish_rate: f64,
+
+    /// Seconds a joining load-test session waits for its world snapshot
+    #[arg(long, default_value_t = 5.0)]
+    join_timeout: f64,
+
+    /// Number of worlds load-test sessions are spread over
+    #[arg(long, default_value_t = 1)]
+    worlds: usize,
+
+    /// Load-test an mqtt-server cluster: `host:port` of every shard, in shard order
+    #[arg(long, value_name = "ADDRS")]
+    cluster: Option<String>,
+
+    /// Misbehaving load-test sessions flooding the broker, started after the others
+    #[arg(long, default_value_t = 0)]
+    flooders: usize,
+
+    /// Poses and snapshot requests per second published by each flooder
+    #[arg(long, default_value_t = 1000.0)]
+    flood_rate: f64,
+
+    /// Run the device fleet described by this scenario file instead of a single device
+    #[arg(long, value_name = "SCENARIO")]
+    fleet: Option<std::path::PathBuf>,
+
+    /// Where the load test or fleet run writes its JSON report
+    #[arg(long, default_value = "load-test-report.json")]
+    report: std::path::PathBuf,
 }
 
 /// Device properties structure matching ESP32-C6 implementation
@@ -179,6 +276,8 @@ struct BlockData {
 struct WorldDataMessage {
     metadata: WorldMetadata,
     blocks: Vec<BlockData>,
+    player_position: [f32; 3],
+    player_rotation: [f32; 4],
 }
 
 /// World metadata for world data message
@@ -312,6 +411,67 @@ async fn main() -> Result<(), Box<dyn std::error::Error>> {
     env_logger::init();
     let args = Args::parse();
 
+    if args.load_test {
+        let config = load_test::LoadTestConfig {
+            host: args.host.clone(),
+            port: args.port,
+            sessions: args.sessions,
+            device_ratio: args.device_ratio,
+            join_ratio: args.join_ratio,
+            ramp_rate: args.ramp_rate,
+            duration_secs: args.duration,
+            publish_rate: args.publish_rate,
+            movement_pattern: args.movement_pattern.clone(),
+            world_id: args.world_id.clone(),
+            worlds: args.worlds,
+            cluster: args
+                .cluster
+                .iter()
+                .flat_map(|shards| shards.split(','))
+                .map(|shard| shard.trim().to_string())
+                .filter(|shard| !shard.is_empty())
+                .collect(),
+            join_timeout_secs: args.join_timeout,
+            flooders: args.flooders,
+            flood_rate: args.flood_rate,
+        };
+        let report = load_test::run_load_test(config).await;
+        info!("{}", report.summary());
+        std::fs::write(&args.report, serde_json::to_string_pretty(&report)?)?;
+        info!("📄 Load-test report written to {}", args.report.display());
+        return Ok(());
+    }
+
+    if args.world_stress {
+        let config = world_stress::WorldStressConfig {
+            host: args.host.clone(),
+            port: args.port,
+            world_id: args.world_id.clone(),
+            blocks: args.world_blocks,
+            world_file: args.world_file.clone(),
+            edit_script: args.edit_script.clone(),
+            edits: args.edits,
+            edit_rate: args.edit_rate,
+            subscribers: args.subscribers,
+            seed: args.seed,
+            converge_timeout_secs: args.converge_timeout,
+        };
+        let report = world_stress::run_world_stress(config).await?;
+        info!("{}", report.summary());
+        std::fs::write(&args.report, serde_json::to_string_pretty(&report)?)?;
+        info!("📄 World stress report written to {}", args.report.display());
+        return Ok(());
+    }
+
+    if let Some(path) = &args.fleet {
+        let scenario = fleet::FleetScenario::load(path)?;
+        let report = fleet::run_fleet(scenario, args.host.clone(), args.port).await;
+        info!("{}", report.summary());
+        std::fs::write(&args.report, serde_json::to_string_pretty(&report)?)?;
+        info!("📄 Fleet report written to {}", args.report.display());
+        return Ok(());
+    }
+
     // Check if device ID was explicitly provided for player-only mode detection
     let device_id_provided = args.device_id.is_some();
 
@@ -353,6 +513,13 @@ async fn main() -> Result<(), Box<dyn std::error::Error>> {
     let mut mqttoptions = MqttOptions::new(&device_id, &args.host, args.port);
     mqttoptions.set_keep_alive(Duration::from_secs(30));
     mqttoptions.set_clean_session(true);
+    if args.publish_world {
+        // Worlds go out in messages of up to the desktop client's limit
+        mqttoptions.set_max_packet_size(
+            world_stress::MAX_MQTT_MESSAGE_SIZE * 2,
+            world_stress::MAX_MQTT_MESSAGE_SIZE * 2,
+        );
+    }
 
     let (client, eventloop) = AsyncClient::new(mqttoptions, 10);
 
@@ -395,6 +562,10 @@ async fn main() -> Result<(), Box<dyn std::error::Error>> {
         let world_id = args.world_id.clone();
         let world_name = args.world_name.unwrap_or_else(|| args.world_id.clone());
         let world_description = args.world_description.clone();
+        let blocks = match &args.world_file {
+            Some(path) => world_stress::load_world_file(path)?,
+            None => world_stress::generate_world(args.world_blocks, args.seed),
+        };
         let player_id = args.player_id.unwrap_or_else(generate_player_id);
         let player_name = args.player_name.unwrap_or_else(|| whoami::username());
         let world_shutdown_rx = shutdown_tx.subscribe();
@@ -403,6 +574,7 @@ async fn main() -> Result<(), Box<dyn std::error::Error>> {
             world_id,
             world_name,
             world_description,
+            blocks,
             player_id,
             player_name,
             world_client,
@@ -516,10 +688,12 @@ async fn run_minimal_mqtt_client(
     }
 }
 
+#[allow(clippy::too_many_arguments)]
 async fn run_world_publisher(
     world_id: String,
     world_name: String,
     world_description: String,
+    blocks: Vec<BlockData>,
     host_player_id: String,
     host_player_name: String,
     client: AsyncClient,
@@ -546,7 +720,7 @@ async fn run_world_publisher(
         version: "1.0.0".to_string(),
     };
     
-    // Create world data message with some sample blocks
+    // Create world data message with the generated or loaded blocks
     let world_data = WorldDataMessage {
         metadata: WorldMetadata {
             name: world_name,
@@ -555,7 +729,9 @@ async fn run_world_publisher(
             last_played,
             version: "1.0.0".to_string(),
         },
-        blocks: generate_sample_blocks(100),
+        blocks,
+        player_position: [0.0, 2.0, 0.0],
+        player_rotation: [0.0, 0.0, 0.0, 1.0],
     };
     
     // Topic for world info
@@ -573,10 +749,11 @@ async fn run_world_publisher(
         }
     };
     
-    let data_payload = match serde_json::to_string(&world_data) {
-        Ok(payload) => payload,
+    // One retained message when the world fits, compressed chunks like the desktop client otherwise
+    let data_messages = match world_stress::world_messages(&world_id, &world_data) {
+        Ok((messages, _)) => messages,
         Err(e) => {
-            error!("Failed to serialize world data: {}", e);
+            error!("{}", e);
             return;
         }
     };
@@ -588,11 +765,19 @@ async fn run_world_publisher(
         info!("✅ Published world info to {}", info_topic);
     }
     
-    if let Err(e) = client.publish(&data_topic, QoS::AtLeastOnce, true, data_payload.clone()).await {
-        error!("Failed to publish world data: {}", e);
-    } else {
-        info!("✅ Published world data to {}", data_topic);
+    let data_count = data_messages.len();
+    for (topic, payload, retain) in data_messages {
+        if let Err(e) = client.publish(&topic, QoS::AtLeastOnce, retain, payload).await {
+            error!("Failed to publish world data: {}", e);
+            break;
+        }
     }
+    info!(
+        "✅ Published world data ({} blocks in {} messages) to {}",
+        world_data.blocks.len(),
+        data_count,
+        data_topic
+    );
     
     // Set up interval to periodically update world info (last_updated field)
     let mut update_interval = interval(Duration::from_secs(30)); // Update every 30 seconds
@@ -632,29 +817,6 @@ async fn run_world_publisher(
     }
 }
 
-// Generate sample blocks for the world
-fn generate_sample_blocks(count: usize) -> Vec<BlockData> {
-    let mut blocks = Vec::with_capacity(count);
-    let mut rng = rand::thread_rng();
-    
-    // Block types to randomly choose from
-    let block_types = ["Grass", "Stone", "Dirt", "Water"];
-    
-    for _ in 0..count {
-        // Generate random positions between -40 and 40
-        let x = rng.gen_range(-40..41);
-        let y = rng.gen_range(0..5); // Height between 0 and 4
-        let z = rng.gen_range(-40..41);
-        
-        // Randomly select a block type
-        let block_type = block_types[rng.gen_range(0..block_types.len())].to_string();
-        
-        blocks.push(BlockData { x, y, z, block_type });
-    }
-    
-    blocks
-}
-
 async fn run_device_client(
     device_id: String,
     device_type: String,
@@ -665,6 +827,7 @@ async fn run_device_client(
     // Subscribe to device topics
     let light_topic = format!("home/{}/light", device_id);
     let position_topic = format!("home/{}/position/set", device_id);
+    let state_topic = format!("home/{}/light/state", device_id);
 
     info!("Attempting to connect to MQTT broker...");
 
@@ -731,18 +894,32 @@ async fn run_device_client(
 
                     // Handle light control messages
                     if p.topic.ends_with("/light") {
-                        let mut state = device_state.write().await;
-                        match payload_str.as_str() {
-                            "ON" => {
-                                state.light_state = true;
-                                info!("💡 Light turned ON (device: {})", device_id);
-                            }
-                            "OFF" => {
-                                state.light_state = false;
-                                info!("🔹 Light turned OFF (device: {})", device_id);
+                        let reported = {
+                            let mut state = device_state.write().await;
+                            match payload_str.as_str() {
+                                "ON" => {
+                                    state.light_state = true;
+                                    info!("💡 Light turned ON (device: {})", device_id);
+                                    Some("ON")
+                                }
+                                "OFF" => {
+                                    state.light_state = false;
+                                    info!("🔹 Light turned OFF (device: {})", device_id);
+                                    Some("OFF")
+                                }
+                                cmd => {
+                                    warn!("Unknown light command '{}' for device {}", cmd, device_id);
+                                    None
+                                }
                             }
-                            cmd => {
-                                warn!("Unknown light command '{}' for device {}", cmd, device_id);
+                        };
+                        // Report the resulting state so controllers can confirm the command
+                        if let Some(reported) = reported {
+                            if let Err(e) = client
+                                .publish(&state_topic, QoS::AtMostOnce, false, reported)
+                                .await
+                            {
+                                error!("Failed to report light state: {}", e);
                             }
                         }
                     }
@@ -191,4 +191,356 @@ mod tests {
         let radius = (state.position[0].powi(2) + state.position[2].powi(2)).sqrt();
         assert!((radius - 5.0).abs() < 0.01); // Should maintain radius of 5.0
     }
+
+    fn load_test_config(
+        sessions: usize,
+        device_ratio: f64,
+        join_ratio: f64,
+    ) -> load_test::LoadTestConfig {
+        load_test::LoadTestConfig {
+            host: "localhost".to_string(),
+            port: 1883,
+            sessions,
+            device_ratio,
+            join_ratio,
+            ramp_rate: 100.0,
+            duration_secs: 1.0,
+            publish_rate: 10.0,
+            movement_pattern: "mixed".to_string(),
+            world_id: "default".to_string(),
+            worlds: 1,
+            cluster: Vec::new(),
+            join_timeout_secs: 1.0,
+            flooders: 0,
+            flood_rate: 1000.0,
+        }
+    }
+
+    #[test]
+    fn test_load_test_roles_follow_ratios() {
+        use load_test::{session_role, SessionRole};
+
+        let config = load_test_config(1000, 0.5, 0.1);
+        let roles: Vec<_> = (0..config.sessions)
+            .map(|i| session_role(i, &config))
+            .collect();
+        let devices = roles.iter().filter(|r| **r == SessionRole::Device).count();
+        let joiners = roles
+            .iter()
+            .filter(|r| **r == SessionRole::Player { joins: true })
+            .count();
+
+        assert_eq!(devices, 500);
+        // A tenth of the players join, not a tenth of all sessions
+        assert_eq!(joiners, 50);
+
+        let players_only = load_test_config(10, 0.0, 1.0);
+        assert!(
+            (0..10).all(|i| session_role(i, &players_only) == SessionRole::Player { joins: true })
+        );
+        // Flooders come after the regular sessions
+        assert_eq!(session_role(10, &players_only), SessionRole::Flooder);
+    }
+
+    #[test]
+    fn test_latency_summary_percentiles() {
+        let summary =
+            load_test::LatencySummary::from_micros((1..=1000).rev().map(|ms| ms * 1000).collect());
+
+        assert_eq!(summary.count, 1000);
+        assert_eq!(summary.p50, 500.0);
+        assert_eq!(summary.p90, 900.0);
+        assert_eq!(summary.p99, 990.0);
+        assert_eq!(summary.p999, 999.0);
+        assert_eq!(summary.max, 1000.0);
+        assert!((summary.mean - 500.5).abs() < 1e-9);
+
+        assert_eq!(load_test::LatencySummary::from_micros(Vec::new()).count, 0);
+    }
+
+    #[test]
+    fn test_load_test_report_aggregates_sessions() {
+        use load_test::{LoadTestReport, SessionRole, SessionStats};
+
+        let config = load_test_config(3, 0.5, 1.0);
+        let sessions = vec![
+            SessionStats {
+                role: Some(SessionRole::Device),
+                connect_us: Some(2_000),
+                connected_at: Some(Duration::from_millis(10)),
+                sent: 10,
+                received: 9,
+                lost: 1,
+                latencies_us: vec![1_000; 9],
+                ..Default::default()
+            },
+            SessionStats {
+                role: Some(SessionRole::Player { joins: true }),
+                connect_us: Some(4_000),
+                connected_at: Some(Duration::from_millis(20)),
+                sent: 10,
+                received: 10,
+                latencies_us: vec![3_000; 10],
+                join_requested: true,
+                join_us: Some(50_000),
+                join_bytes: 4096,
+                ..Default::default()
+            },
+            SessionStats {
+                role: Some(SessionRole::Player { joins: true }),
+                join_requested: true,
+                errors: 2,
+                ..Default::default()
+            },
+            SessionStats {
+                role: Some(SessionRole::Flooder),
+                connect_us: Some(1_000),
+                connected_at: Some(Duration::from_millis(40)),
+                sent: 4_000,
+                received: 5,
+                ..Default::default()
+            },
+        ];
+
+        let report = LoadTestReport::from_sessions(
+            &config,
+            "test",
+            String::new(),
+            sessions,
+            0,
+            Duration::from_millis(30),
+            Duration::from_secs(2),
+        );
+
+        assert_eq!(report.sessions.devices, 1);
+        assert_eq!(report.sessions.players, 2);
+        assert_eq!(report.sessions.connected, 2);
+        assert_eq!(report.connect.setup_rate_per_sec, 100.0);
+        assert_eq!(report.messages.sent, 20);
+        assert_eq!(report.messages.received, 19);
+        assert_eq!(report.messages.send_rate_per_sec, 10.0);
+        assert_eq!(report.messages.latency_ms.p50, 3.0);
+        assert_eq!(report.joins.requested, 2);
+        assert_eq!(report.joins.completed, 1);
+        assert_eq!(report.joins.timed_out, 1);
+        assert_eq!(report.joins.mean_snapshot_bytes, 4096.0);
+        assert_eq!(report.errors, 2);
+        // Flooders are reported on their own
+        assert_eq!(report.sessions.flooders, 1);
+        assert_eq!(report.flood.sent, 4_000);
+        assert_eq!(report.flood.send_rate_per_sec, 2_000.0);
+        assert_eq!(report.flood.snapshots_received, 5);
+        assert!(serde_json::to_string(&report).is_ok());
+    }
+
+    #[test]
+    fn test_load_test_routes_worlds_to_their_shards() {
+        let mut config = load_test_config(8, 0.0, 0.0);
+        config.worlds = 4;
+        config.cluster = vec!["127.0.0.1:1883".to_string(), "127.0.0.1:1884".to_string()];
+
+        assert_eq!(config.world_of(1), "default-1");
+        assert_eq!(config.world_of(5), "default-1");
+        // Must agree with the server's FNV-1a owner computation
+        assert_eq!(load_test::shard_for_world("", 4), 1);
+        for index in 0..8 {
+            let world = config.world_of(index);
+            let (shard, host, port) = config.broker_for(&world);
+            assert_eq!(shard, load_test::shard_for_world(&world, 2));
+            assert_eq!(host, "127.0.0.1");
+            assert_eq!(port, 1883 + shard as u16);
+        }
+
+        config.cluster.clear();
+        assert_eq!(
+            config.broker_for("default-3"),
+            (0, "localhost".to_string(), 1883)
+        );
+    }
+
+    #[test]
+    fn test_fleet_scenario_builds_classroom() {
+        use fleet::{DeviceKind, FleetScenario};
+        use std::collections::HashSet;
+
+        let scenario = FleetScenario::parse(include_str!("../fleets/classroom-500.ron")).unwrap();
+        let devices = scenario.devices();
+
+        assert_eq!(devices.len(), 500);
+        let ids: HashSet<_> = devices.iter().map(|device| device.id.as_str()).collect();
+        assert_eq!(ids.len(), 500);
+        let count = |kind| devices.iter().filter(|device| device.kind == kind).count();
+        assert_eq!(count(DeviceKind::Lamp), 300);
+        assert_eq!(count(DeviceKind::Door), 100);
+        assert_eq!(count(DeviceKind::Sensor), 100);
+        assert_eq!(devices[300].id, "classroom-door-0");
+        // Omitted fields take their defaults
+        assert_eq!(scenario.groups[2].command_rate, 0.0);
+        assert!(!DeviceKind::Sensor.commanded());
+
+        let mut rng = rand::SeedableRng::seed_from_u64(7);
+        for _ in 0..100 {
+            let period = fleet::jittered_period(0.1, 0.2, &mut rng).unwrap();
+            assert!(period >= Duration::from_secs(8) && period <= Duration::from_secs(12));
+        }
+        assert!(fleet::jittered_period(0.0, 0.2, &mut rng).is_none());
+    }
+
+    #[test]
+    fn test_fleet_report_aggregates_devices() {
+        use fleet::{ControllerStats, DeviceStats, FleetReport, FleetScenario};
+
+        let scenario = FleetScenario::parse(include_str!("../fleets/classroom-500.ron")).unwrap();
+        let devices = vec![
+            DeviceStats {
+                group: 0,
+                connect_us: Some(2_000),
+                announcements: 2,
+                commands_received: 10,
+                state_reports: 10,
+                ..Default::default()
+            },
+            DeviceStats {
+                group: 2,
+                connect_us: Some(4_000),
+                announcements: 1,
+                telemetry: 20,
+                dropped: 1,
+                ..Default::default()
+            },
+            DeviceStats {
+                group: 1,
+                errors: 3,
+                ..Default::default()
+            },
+        ];
+        let controller = ControllerStats {
+            commands_sent: 12,
+            acked: 9,
+            mismatched: 1,
+            lost: 2,
+            latencies_us: vec![5_000; 9],
+            ..Default::default()
+        };
+
+        let report = FleetReport::from_runs(
+            &scenario,
+            "test",
+            String::new(),
+            "localhost:1883".to_string(),
+            devices,
+            controller,
+            Duration::from_secs(2),
+        );
+
+        assert_eq!(report.devices, 500);
+        assert_eq!(report.connected, 2);
+        assert_eq!(report.groups[0].connected, 1);
+        assert_eq!(report.groups[0].state_reports, 10);
+        assert_eq!(report.groups[2].telemetry_rate_per_sec, 10.0);
+        assert_eq!(report.commands.rate_per_sec, 6.0);
+        assert_eq!(report.commands.latency_ms.p99, 5.0);
+        assert_eq!(report.commands.lost, 2);
+        assert_eq!(report.dropped, 1);
+        assert_eq!(report.errors, 3);
+        assert!(serde_json::to_string(&report).is_ok());
+    }
+
+    #[test]
+    fn test_world_stress_generates_deterministic_worlds() {
+        use world_stress::{
+            generate_edits, generate_world, parse_edit_script, ScriptedEdit, WorldModel,
+        };
+
+        let world = generate_world(10_000, 7);
+        assert_eq!(world.len(), 10_000);
+        let model = WorldModel::from_blocks(&world);
+        // Every position is distinct, and the same seed builds the same world
+        assert_eq!(model.len(), 10_000);
+        assert_eq!(
+            WorldModel::from_blocks(&generate_world(10_000, 7)).fingerprint(),
+            model.fingerprint()
+        );
+        assert_ne!(
+            WorldModel::from_blocks(&generate_world(10_000, 8)).fingerprint(),
+            model.fingerprint()
+        );
+        assert_eq!(
+            generate_edits(&world, 100, 7),
+            generate_edits(&world, 100, 7)
+        );
+
+        // Placing and removing a block restores the fingerprint
+        let mut edited = WorldModel::from_blocks(&world);
+        edited.place([1000, 0, 0], "Stone");
+        assert_ne!(edited.fingerprint(), model.fingerprint());
+        edited.remove([1000, 0, 0]);
+        assert_eq!(edited.fingerprint(), model.fingerprint());
+
+        let script = "# build a pillar\nplace 1 2 3 Stone\n\nremove -1 0 4  # and dig\n";
+        assert_eq!(
+            parse_edit_script(script).unwrap(),
+            vec![
+                ScriptedEdit::Place([1, 2, 3], "Stone".to_string()),
+                ScriptedEdit::Remove([-1, 0, 4]),
+            ]
+        );
+        assert!(parse_edit_script("place 1 2 Stone").is_err());
+    }
+
+    #[test]
+    fn test_world_stress_chunks_large_worlds() {
+        use world_stress::{
+            compress_world, generate_world, world_messages, ChunkAssembler, ChunkedWorldData,
+            WorldModel, MAX_MQTT_MESSAGE_SIZE,
+        };
+
+        let world = WorldDataMessage {
+            metadata: WorldMetadata {
+                name: "big".to_string(),
+                description: String::new(),
+                created_at: String::new(),
+                last_played: String::new(),
+                version: "1.0.0".to_string(),
+            },
+            blocks: generate_world(150_000, 1),
+            player_position: [0.0, 2.0, 0.0],
+            player_rotation: [0.0, 0.0, 0.0, 1.0],
+        };
+        let (messages, compressed) = world_messages("big", &world).unwrap();
+        assert!(compressed.is_some());
+        assert!(messages.iter().all(|(topic, payload, retain)| topic
+            == "iotcraft/worlds/big/data/chunk"
+            && payload.len() <= MAX_MQTT_MESSAGE_SIZE
+            && !retain));
+
+        // Reassembled in any order, the chunks give back the same world
+        let serialized = serde_json::to_vec(&world).unwrap();
+        let (chunks, _) = compress_world("big", &serialized, 4096).unwrap();
+        assert!(chunks.len() > 1);
+        let mut assembler = ChunkAssembler::default();
+        let mut restored = None;
+        for chunk in chunks.into_iter().rev() {
+            let chunk: ChunkedWorldData =
+                serde_json::from_slice(&serde_json::to_vec(&chunk).unwrap()).unwrap();
+            assert!(restored.is_none());
+            restored = assembler.add(chunk);
+        }
+        let restored: WorldDataMessage =
+            serde_json::from_slice(&restored.unwrap().unwrap()).unwrap();
+        assert_eq!(
+            WorldModel::from_blocks(&restored.blocks).fingerprint(),
+            WorldModel::from_blocks(&world.blocks).fingerprint()
+        );
+
+        // Small worlds stay a single retained message
+        let small = WorldDataMessage {
+            blocks: generate_world(100, 1),
+            ..world
+        };
+        let (messages, compressed) = world_messages("small", &small).unwrap();
+        assert!(compressed.is_none());
+        assert_eq!(messages.len(), 1);
+        assert!(messages[0].2);
+    }
 }
@@ -0,0 +1,882 @@
+//! World sync stress test: large worlds, scripted edits and subscriber convergence.
+//!
+//! A deterministic world of any size (generated from a seed, or loaded from a saved
+//! `world.json`) is published the way the desktop client's world publisher does it: as one
+//! retained `iotcraft/worlds/{id}/data` message when it fits, otherwise deflate-compressed
+//! and split into [`ChunkedWorldData`] messages on `iotcraft/worlds/{id}/data/chunk`. An
+//! edit stream (generated or read from a script) is then replayed on
+//! `state/blocks/placed|removed` at a fixed rate.
+//!
+//! Subscriber sessions rebuild the world from those messages and fingerprint it. A
+//! subscriber has converged once its fingerprint equals the one the publisher computed
+//! for the final world; the report gives how long loading the world and converging after
+//! the last edit took.
+
+use super::load_test::{micros, LatencySummary};
+use super::{now_ts, BlockData, WorldDataMessage, WorldInfoMessage, WorldMetadata};
+use flate2::read::DeflateDecoder;
+use flate2::write::DeflateEncoder;
+use log::{debug, info, warn};
+use rand::rngs::StdRng;
+use rand::{Rng, SeedableRng};
+use rumqttc::{AsyncClient, Event, Incoming, MqttOptions, QoS};
+use serde::{Deserialize, Serialize};
+use std::collections::HashMap;
+use std::io::{Read, Write};
+use std::path::PathBuf;
+use std::time::Duration;
+use tokio::sync::{mpsc, watch};
+use tokio::time::{interval, Instant};
+
+/// Largest MQTT message the desktop client publishes or accepts
+pub const MAX_MQTT_MESSAGE_SIZE: usize = 5_242_880;
+/// Compressed bytes per chunk. Chunk data is a JSON array of numbers, up to four
+/// characters per byte, so this keeps every chunk message under the limit.
+const CHUNK_DATA_SIZE: usize = (MAX_MQTT_MESSAGE_SIZE - 4096) / 4;
+/// Layers of terrain a generated world aims for; its footprint grows with the block count
+const TERRAIN_LAYERS: usize = 8;
+/// Block types edits place, as the desktop client names them
+const BLOCK_TYPES: [&str; 7] = [
+    "Grass",
+    "Dirt",
+    "Stone",
+    "QuartzBlock",
+    "GlassPane",
+    "CyanTerracotta",
+    "Water",
+];
+
+pub type BlockPos = [i32; 3];
+
+/// Chunk of a compressed world, as published by the desktop client
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct ChunkedWorldData {
+    pub chunk_id: String,
+    pub chunk_index: u32,
+    pub total_chunks: u32,
+    pub data: Vec<u8>,
+    pub world_id: String,
+}
+
+/// Any saved world; only the blocks are used
+#[derive(Deserialize)]
+struct SavedWorld {
+    blocks: Vec<BlockData>,
+}
+
+fn splitmix64(mut x: u64) -> u64 {
+    x = x.wrapping_add(0x9e37_79b9_7f4a_7c15);
+    x = (x ^ (x >> 30)).wrapping_mul(0xbf58_476d_1ce4_e5b9);
+    x = (x ^ (x >> 27)).wrapping_mul(0x94d0_49bb_1331_11eb);
+    x ^ (x >> 31)
+}
+
+fn position_hash(seed: u64, pos: BlockPos) -> u64 {
+    let packed =
+        (pos[0] as u32 as u64) ^ ((pos[1] as u32 as u64) << 21) ^ ((pos[2] as u32 as u64) << 42);
+    splitmix64(seed ^ splitmix64(packed))
+}
+
+/// Deterministic terrain of exactly `count` blocks: a square slab centred on the origin,
+/// filled from the bottom up with stone (and some quartz), then dirt, then grass with
+/// scattered water on top
+pub fn generate_world(count: usize, seed: u64) -> Vec<BlockData> {
+    let side = ((count as f64 / TERRAIN_LAYERS as f64).sqrt().ceil() as usize).max(1);
+    let layer = side * side;
+    let layers = count.div_ceil(layer);
+    let half = (side / 2) as i32;
+    let mut blocks = Vec::with_capacity(count);
+    'fill: for y in 0..layers {
+        for x in 0..side {
+            for z in 0..side {
+                if blocks.len() == count {
+                    break 'fill;
+                }
+                let pos = [x as i32 - half, y as i32, z as i32 - half];
+                let roll = position_hash(seed, pos) % 64;
+                let block_type = match layers - 1 - y {
+                    0 if roll == 0 => "Water",
+                    0 => "Grass",
+                    1 | 2 => "Dirt",
+                    _ if roll < 3 => "QuartzBlock",
+                    _ => "Stone",
+                };
+                blocks.push(BlockData {
+                    x: pos[0],
+                    y: pos[1],
+                    z: pos[2],
+                    block_type: block_type.to_string(),
+                });
+            }
+        }
+    }
+    blocks
+}
+
+/// Blocks of a saved world (`world.json` of the desktop client, or any JSON with a
+/// `blocks` array of `{x, y, z, block_type}`)
+pub fn load_world_file(path: &std::path::Path) -> Result<Vec<BlockData>, String> {
+    let content =
+        std::fs::read(path).map_err(|e| format!("Cannot read {}: {}", path.display(), e))?;
+    serde_json::from_slice::<SavedWorld>(&content)
+        .map(|world| world.blocks)
+        .map_err(|e| format!("Cannot parse {}: {}", path.display(), e))
+}
+
+/// One edit of a replayed stream
+#[derive(Debug, Clone, PartialEq)]
+pub enum ScriptedEdit {
+    Place(BlockPos, String),
+    Remove(BlockPos),
+}
+
+/// Parse an edit script: one `place x y z BlockType` or `remove x y z` per line, with
+/// blank lines and `#` comments ignored
+pub fn parse_edit_script(script: &str) -> Result<Vec<ScriptedEdit>, String> {
+    let mut edits = Vec::new();
+    for (number, line) in script.lines().enumerate() {
+        let line = line.split('#').next().unwrap_or("").trim();
+        if line.is_empty() {
+            continue;
+        }
+        let fields: Vec<_> = line.split_whitespace().collect();
+        let position = |fields: &[&str]| -> Option<BlockPos> {
+            Some([
+                fields.first()?.parse().ok()?,
+                fields.get(1)?.parse().ok()?,
+                fields.get(2)?.parse().ok()?,
+            ])
+        };
+        let edit = match fields.as_slice() {
+            ["place", rest @ ..] if rest.len() == 4 => {
+                position(rest).map(|pos| ScriptedEdit::Place(pos, rest[3].to_string()))
+            }
+            ["remove", rest @ ..] if rest.len() == 3 => position(rest).map(ScriptedEdit::Remove),
+            _ => None,
+        };
+        edits.push(edit.ok_or_else(|| format!("Line {}: cannot parse '{}'", number + 1, line))?);
+    }
+    Ok(edits)
+}
+
+/// `count` edits around the world: a third remove existing blocks, the rest place blocks
+/// on or just above them
+pub fn generate_edits(world: &[BlockData], count: usize, seed: u64) -> Vec<ScriptedEdit> {
+    let mut rng = StdRng::seed_from_u64(seed.wrapping_add(1));
+    (0..count)
+        .map(|_| {
+            let Some(block) = (!world.is_empty()).then(|| &world[rng.gen_range(0..world.len())])
+            else {
+                return ScriptedEdit::Place(
+                    [rng.gen_range(-8..8), 0, rng.gen_range(-8..8)],
+                    "Stone".to_string(),
+                );
+            };
+            if rng.gen_range(0..3) == 0 {
+                ScriptedEdit::Remove([block.x, block.y, block.z])
+            } else {
+                let block_type = BLOCK_TYPES[rng.gen_range(0..BLOCK_TYPES.len())];
+                ScriptedEdit::Place(
+                    [block.x, block.y + rng.gen_range(0..3), block.z],
+                    block_type.to_string(),
+                )
+            }
+        })
+        .collect()
+}
+
+/// Order-independent fingerprint of a world, updated block by block
+#[derive(Debug, Default)]
+pub struct WorldModel {
+    blocks: HashMap<BlockPos, u64>,
+    fingerprint: u64,
+}
+
+impl WorldModel {
+    pub fn from_blocks(blocks: &[BlockData]) -> Self {
+        let mut model = Self {
+            blocks: HashMap::with_capacity(blocks.len()),
+            fingerprint: 0,
+        };
+        for block in blocks {
+            model.place([block.x, block.y, block.z], &block.block_type);
+        }
+        model
+    }
+
+    pub fn place(&mut self, pos: BlockPos, block_type: &str) {
+        let type_hash = block_type
+            .bytes()
+            .fold(0xcbf2_9ce4_8422_2325u64, |hash, byte| {
+                (hash ^ byte as u64).wrapping_mul(0x0100_0000_01b3)
+            });
+        let hash = position_hash(type_hash, pos);
+        if let Some(old) = self.blocks.insert(pos, hash) {
+            self.fingerprint = self.fingerprint.wrapping_sub(old);
+        }
+        self.fingerprint = self.fingerprint.wrapping_add(hash);
+    }
+
+    pub fn remove(&mut self, pos: BlockPos) {
+        if let Some(old) = self.blocks.remove(&pos) {
+            self.fingerprint = self.fingerprint.wrapping_sub(old);
+        }
+    }
+
+    pub fn apply(&mut self, edit: &ScriptedEdit) {
+        match edit {
+            ScriptedEdit::Place(pos, block_type) => self.place(*pos, block_type),
+            ScriptedEdit::Remove(pos) => self.remove(*pos),
+        }
+    }
+
+    pub fn fingerprint(&self) -> u64 {
+        self.fingerprint
+    }
+
+    pub fn len(&self) -> usize {
+        self.blocks.len()
+    }
+}
+
+/// Messages carrying a world, as the desktop client publishes them: `(topic, payload,
+/// retain)`, plus the compressed size when the world had to be chunked
+pub fn world_messages(
+    world_id: &str,
+    world: &WorldDataMessage,
+) -> Result<(Vec<(String, Vec<u8>, bool)>, Option<usize>), String> {
+    let serialized =
+        serde_json::to_vec(world).map_err(|e| format!("Failed to serialize world data: {}", e))?;
+    if serialized.len() <= MAX_MQTT_MESSAGE_SIZE {
+        return Ok((
+            vec![(
+                format!("iotcraft/worlds/{}/data", world_id),
+                serialized,
+                true,
+            )],
+            None,
+        ));
+    }
+
+    let (chunks, compressed) = compress_world(world_id, &serialized, CHUNK_DATA_SIZE)?;
+    let topic = format!("iotcraft/worlds/{}/data/chunk", world_id);
+    let messages = chunks
+        .iter()
+        .map(|chunk| {
+            (
+                topic.clone(),
+                serde_json::to_vec(chunk).unwrap_or_default(),
+                false,
+            )
+        })
+        .collect();
+    Ok((messages, Some(compressed)))
+}
+
+/// Deflate a serialized world and split it into chunks of `chunk_size` compressed bytes;
+/// also returns the compressed size
+pub fn compress_world(
+    world_id: &str,
+    serialized: &[u8],
+    chunk_size: usize,
+) -> Result<(Vec<ChunkedWorldData>, usize), String> {
+    let mut encoder = DeflateEncoder::new(Vec::new(), flate2::Compression::best());
+    encoder
+        .write_all(serialized)
+        .map_err(|e| format!("Failed to compress world data: {}", e))?;
+    let compressed = encoder
+        .finish()
+        .map_err(|e| format!("Failed to finish compression: {}", e))?;
+    let chunk_id = format!("{}_{}", world_id, now_ts());
+    let total_chunks = compressed.len().div_ceil(chunk_size) as u32;
+    let chunks = compressed
+        .chunks(chunk_size)
+        .enumerate()
+        .map(|(index, data)| ChunkedWorldData {
+            chunk_id: chunk_id.clone(),
+            chunk_index: index as u32,
+            total_chunks,
+            data: data.to_vec(),
+            world_id: world_id.to_string(),
+        })
+        .collect();
+    Ok((chunks, compressed.len()))
+}
+
+/// Collects the chunks of a chunked world until it is complete
+#[derive(Default)]
+pub struct ChunkAssembler {
+    chunk_id: String,
+    parts: Vec<Option<Vec<u8>>>,
+    received: usize,
+}
+
+impl ChunkAssembler {
+    /// Add a chunk; returns the decompressed world once every chunk of it has arrived
+    pub fn add(&mut self, chunk: ChunkedWorldData) -> Option<Result<Vec<u8>, String>> {
+        if chunk.chunk_id != self.chunk_id {
+            // A newer world replaces a partially received one
+            self.chunk_id = chunk.chunk_id;
+            self.parts = vec![None; chunk.total_chunks as usize];
+            self.received = 0;
+        }
+        let slot = self.parts.get_mut(chunk.chunk_index as usize)?;
+        if slot.is_none() {
+            *slot = Some(chunk.data);
+            self.received += 1;
+        }
+        if self.received < self.parts.len() {
+            return None;
+        }
+        let compressed: Vec<u8> = self.parts.drain(..).flatten().flatten().collect();
+        self.received = 0;
+        let mut world = Vec::new();
+        Some(
+            DeflateDecoder::new(&compressed[..])
+                .read_to_end(&mut world)
+                .map(|_| world)
+                .map_err(|e| format!("Failed to decompress world data: {}", e)),
+        )
+    }
+}
+
+fn edit_message(world_id: &str, edit: &ScriptedEdit) -> (String, String) {
+    let (kind, change) = match edit {
+        ScriptedEdit::Place([x, y, z], block_type) => (
+            "placed",
+            serde_json::json!({"Placed": {"x": x, "y": y, "z": z, "block_type": block_type}}),
+        ),
+        ScriptedEdit::Remove([x, y, z]) => (
+            "removed",
+            serde_json::json!({"Removed": {"x": x, "y": y, "z": z}}),
+        ),
+    };
+    let payload = serde_json::json!({
+        "player_id": "world-stress",
+        "player_name": "World Stress",
+        "timestamp": now_ts(),
+        "change": change,
+    });
+    (
+        format!("iotcraft/worlds/{}/state/blocks/{}", world_id, kind),
+        payload.to_string(),
+    )
+}
+
+#[derive(Deserialize)]
+enum ChangeIn {
+    Placed {
+        x: i32,
+        y: i32,
+        z: i32,
+        block_type: String,
+    },
+    Removed {
+        x: i32,
+        y: i32,
+        z: i32,
+    },
+}
+
+#[derive(Deserialize)]
+struct EditIn {
+    #[serde(default)]
+    timestamp: u64,
+    change: ChangeIn,
+}
+
+impl From<ChangeIn> for ScriptedEdit {
+    fn from(change: ChangeIn) -> Self {
+        match change {
+            ChangeIn::Placed {
+                x,
+                y,
+                z,
+                block_type,
+            } => ScriptedEdit::Place([x, y, z], block_type),
+            ChangeIn::Removed { x, y, z } => ScriptedEdit::Remove([x, y, z]),
+        }
+    }
+}
+
+#[derive(Debug, Clone, Serialize)]
+pub struct WorldStressConfig {
+    pub host: String,
+    pub port: u16,
+    pub world_id: String,
+    /// Blocks of the generated world, when no world file is given
+    pub blocks: usize,
+    pub world_file: Option<PathBuf>,
+    pub edit_script: Option<PathBuf>,
+    /// Edits generated when no script is given
+    pub edits: usize,
+    /// Edits published per second
+    pub edit_rate: f64,
+    pub subscribers: usize,
+    pub seed: u64,
+    /// Seconds subscribers may take to converge after the last edit
+    pub converge_timeout_secs: f64,
+}
+
+fn mqtt_options(client_id: String, config: &WorldStressConfig) -> MqttOptions {
+    let mut options = MqttOptions::new(client_id, &config.host, config.port);
+    options.set_keep_alive(Duration::from_secs(30));
+    options.set_clean_session(true);
+    options.set_max_packet_size(MAX_MQTT_MESSAGE_SIZE * 2, MAX_MQTT_MESSAGE_SIZE * 2);
+    options
+}
+
+/// Measurements of one subscriber, as offsets from the start of the world publish
+#[derive(Debug, Clone, Default)]
+pub struct SubscriberStats {
+    pub world_at: Option<Duration>,
+    pub world_bytes: usize,
+    pub converged_at: Option<Duration>,
+    pub edits_received: u64,
+    pub edit_latencies_us: Vec<u32>,
+    pub errors: u64,
+}
+
+struct SubscriberRun {
+    index: usize,
+    run_world: String,
+    expected: u64,
+    edit_count: u64,
+    ready_tx: mpsc::Sender<()>,
+    published_rx: watch::Receiver<Option<Instant>>,
+    last_edit_rx: watch::Receiver<Option<Instant>>,
+    timeout: Duration,
+}
+
+async fn run_subscriber(config: WorldStressConfig, mut run: SubscriberRun) -> SubscriberStats {
+    let mut stats = SubscriberStats::default();
+    let options = mqtt_options(
+        format!("world-stress-{}-{}", run.run_world, run.index),
+        &config,
+    );
+    let (client, mut eventloop) = AsyncClient::new(options, 16);
+    let prefix = format!("iotcraft/worlds/{}/", run.run_world);
+    let mut model: Option<WorldModel> = None;
+    let mut early_edits = Vec::new();
+    let mut chunks = ChunkAssembler::default();
+    let mut subscribed = 0;
+    let mut check = interval(Duration::from_millis(100));
+
+    loop {
+        tokio::select! {
+            event = eventloop.poll() => match event {
+                Ok(Event::Incoming(Incoming::ConnAck(_))) => {
+                    for suffix in ["data", "data/chunk", "state/blocks/placed", "state/blocks/removed"] {
+                        let _ = client.try_subscribe(format!("{}{}", prefix, suffix), QoS::AtLeastOnce);
+                    }
+                }
+                Ok(Event::Incoming(Incoming::SubAck(_))) => {
+                    subscribed += 1;
+                    if subscribed == 4 {
+                        let _ = run.ready_tx.send(()).await;
+                    }
+                }
+                Ok(Event::Incoming(Incoming::Publish(p))) => {
+                    let Some(topic) = p.topic.strip_prefix(&prefix) else {
+                        continue;
+                    };
+                    let since_publish = || run.published_rx.borrow().map(|at| at.elapsed());
+                    let world = match topic {
+                        "data" if !p.payload.is_empty() => Some(Ok(p.payload.to_vec())),
+                        "data/chunk" => match serde_json::from_slice::<ChunkedWorldData>(&p.payload) {
+                            Ok(chunk) => chunks.add(chunk),
+                            Err(e) => Some(Err(e.to_string())),
+                        },
+                        "state/blocks/placed" | "state/blocks/removed" => {
+                            match serde_json::from_slice::<EditIn>(&p.payload) {
+                                Ok(edit) => {
+                                    stats.edits_received += 1;
+                                    let latency_ms = now_ts().saturating_sub(edit.timestamp);
+                                    stats.edit_latencies_us.push(micros(Duration::from_millis(latency_ms)));
+                                    match &mut model {
+                                        Some(model) => model.apply(&edit.change.into()),
+                                        None => early_edits.push(ScriptedEdit::from(edit.change)),
+                                    }
+                                }
+                                Err(_) => stats.errors += 1,
+                            }
+                            None
+                        }
+                        _ => None,
+                    };
+                    match world {
+                        Some(Ok(bytes)) => match serde_json::from_slice::<SavedWorld>(&bytes) {
+                            Ok(world) => {
+                                stats.world_at = since_publish();
+                                stats.world_bytes = bytes.len();
+                                let mut loaded = WorldModel::from_blocks(&world.blocks);
+                                for edit in early_edits.drain(..) {
+                                    loaded.apply(&edit);
+                                }
+                                model = Some(loaded);
+                            }
+                            Err(e) => {
+                                stats.errors += 1;
+                                warn!("World stress subscriber {} cannot parse world: {}", run.index, e);
+                            }
+                        },
+                        Some(Err(e)) => {
+                            stats.errors += 1;
+                            warn!("World stress subscriber {} cannot load world: {}", run.index, e);
+                        }
+                        None => {}
+                    }
+                    if stats.converged_at.is_none()
+                        && stats.edits_received >= run.edit_count
+                        && model.as_ref().is_some_and(|model| model.fingerprint() == run.expected)
+                    {
+                        stats.converged_at = since_publish();
+                        break;
+                    }
+                }
+                Ok(_) => {}
+                Err(e) => {
+                    stats.errors += 1;
+                    debug!("World stress subscriber {} connection error: {:?}", run.index, e);
+                    tokio::time::sleep(Duration::from_secs(1)).await;
+                }
+            },
+            _ = check.tick() => {
+                let last_edit = *run.last_edit_rx.borrow();
+                if last_edit.is_some_and(|at| at.elapsed() > run.timeout) {
+                    break;
+                }
+            }
+        }
+    }
+    let _ = client.try_disconnect();
+    stats
+}
+
+#[derive(Debug, Clone, Serialize)]
+pub struct WorldStressReport {
+    pub run_id: String,
+    pub started_at: String,
+    pub config: WorldStressConfig,
+    pub world_id: String,
+    pub blocks: usize,
+    pub payload_bytes: usize,
+    /// Deflated size when the world was published in chunks
+    pub compressed_bytes: Option<usize>,
+    pub world_messages: usize,
+    pub prepare_ms: f64,
+    pub edits_published: usize,
+    pub edit_rate_per_sec: f64,
+    pub subscribers: usize,
+    pub worlds_loaded: usize,
+    pub converged: usize,
+    /// Start of the world publish until a subscriber had the whole world
+    pub world_load_ms: LatencySummary,
+    /// Edit published until a subscriber received it
+    pub edit_latency_ms: LatencySummary,
+    /// Last edit published until a subscriber's world matched the publisher's
+    pub convergence_ms: LatencySummary,
+    pub errors: u64,
+}
+
+/// What the publisher measured, for [`WorldStressReport::from_runs`]
+#[derive(Debug, Clone, Default)]
+pub struct PublishStats {
+    pub blocks: usize,
+    pub payload_bytes: usize,
+    pub compressed_bytes: Option<usize>,
+    pub world_messages: usize,
+    pub prepare: Duration,
+    pub edits_published: usize,
+    /// Start of the world publish until the first and the last edit
+    pub first_edit_at: Duration,
+    pub last_edit_at: Duration,
+    pub errors: u64,
+}
+
+impl WorldStressReport {
+    pub fn from_runs(
+        config: &WorldStressConfig,
+        run_id: &str,
+        started_at: String,
+        world_id: String,
+        publish: PublishStats,
+        subscribers: Vec<SubscriberStats>,
+    ) -> Self {
+        let edit_secs = publish
+            .last_edit_at
+            .saturating_sub(publish.first_edit_at)
+            .as_secs_f64();
+        let mut world_samples = Vec::new();
+        let mut edit_samples = Vec::new();
+        let mut convergence_samples = Vec::new();
+        let mut errors = publish.errors;
+        for subscriber in &subscribers {
+            world_samples.extend(subscriber.world_at.map(micros));
+            edit_samples.extend_from_slice(&subscriber.edit_latencies_us);
+            convergence_samples.extend(
+                subscriber
+                    .converged_at
+                    .map(|at| micros(at.saturating_sub(publish.last_edit_at))),
+            );
+            errors += subscriber.errors;
+        }
+
+        Self {
+            run_id: run_id.to_string(),
+            started_at,
+            config: config.clone(),
+            world_id,
+            blocks: publish.blocks,
+            payload_bytes: publish.payload_bytes,
+            compressed_bytes: publish.compressed_bytes,
+            world_messages: publish.world_messages,
+            prepare_ms: publish.prepare.as_secs_f64() * 1000.0,
+            edits_published: publish.edits_published,
+            edit_rate_per_sec: match edit_secs {
+                secs if secs > 0.0 => publish.edits_published.saturating_sub(1) as f64 / secs,
+                _ => 0.0,
+            },
+            subscribers: subscribers.len(),
+            worlds_loaded: world_samples.len(),
+            converged: convergence_samples.len(),
+            world_load_ms: LatencySummary::from_micros(world_samples),
+            edit_latency_ms: LatencySummary::from_micros(edit_samples),
+            convergence_ms: LatencySummary::from_micros(convergence_samples),
+            errors,
+        }
+    }
+
+    /// Human-readable summary for the log
+    pub fn summary(&self) -> String {
+        format!(
+            "World stress {} ({}): {} blocks, {} KB in {} messages{}, prepared in {:.0} ms\n\
+             world load p50 {:.1} ms max {:.1} ms ({}/{} subscribers)\n\
+             {} edits at {:.1}/s, edit latency p50 {:.1} ms p99 {:.1} ms\n\
+             converged {}/{}: p50 {:.1} ms p99 {:.1} ms max {:.1} ms after the last edit",
+            self.world_id,
+            self.run_id,
+            self.blocks,
+            self.payload_bytes / 1024,
+            self.world_messages,
+            self.compressed_bytes
+                .map(|bytes| format!(" ({} KB compressed)", bytes / 1024))
+                .unwrap_or_default(),
+            self.prepare_ms,
+            self.world_load_ms.p50,
+            self.world_load_ms.max,
+            self.worlds_loaded,
+            self.subscribers,
+            self.edits_published,
+            self.edit_rate_per_sec,
+            self.edit_latency_ms.p50,
+            self.edit_latency_ms.p99,
+            self.converged,
+            self.subscribers,
+            self.convergence_ms.p50,
+            self.convergence_ms.p99,
+            self.convergence_ms.max,
+        )
+    }
+}
+
+/// Build the world and edit stream, publish them to subscribers and measure convergence
+pub async fn run_world_stress(config: WorldStressConfig) -> Result<WorldStressReport, String> {
+    let run_id = uuid::Uuid::new_v4().simple().to_string()[..8].to_string();
+    let started_at = chrono::Utc::now().to_rfc3339();
+    // A fresh world id per run, so retained messages of earlier runs never interfere
+    let run_world = format!("{}-stress-{}", config.world_id, run_id);
+
+    let prepare_started = Instant::now();
+    let blocks = match &config.world_file {
+        Some(path) => load_world_file(path)?,
+        None => generate_world(config.blocks, config.seed),
+    };
+    let edits = match &config.edit_script {
+        Some(path) => parse_edit_script(
+            &std::fs::read_to_string(path)
+                .map_err(|e| format!("Cannot read {}: {}", path.display(), e))?,
+        )?,
+        None => generate_edits(&blocks, config.edits, config.seed),
+    };
+    let mut expected = WorldModel::from_blocks(&blocks);
+    for edit in &edits {
+        expected.apply(edit);
+    }
+    let created_at = chrono::Utc::now().to_rfc3339();
+    let world = WorldDataMessage {
+        metadata: WorldMetadata {
+            name: run_world.clone(),
+            description: format!("World stress test with {} blocks", blocks.len()),
+            created_at: created_at.clone(),
+            last_played: created_at.clone(),
+            version: "1.0.0".to_string(),
+        },
+        blocks,
+        player_position: [0.0, 2.0, 0.0],
+        player_rotation: [0.0, 0.0, 0.0, 1.0],
+    };
+    let (messages, compressed_bytes) = world_messages(&run_world, &world)?;
+    let mut publish = PublishStats {
+        blocks: world.blocks.len(),
+        payload_bytes: messages.iter().map(|(_, payload, _)| payload.len()).sum(),
+        compressed_bytes,
+        world_messages: messages.len(),
+        prepare: prepare_started.elapsed(),
+        ..Default::default()
+    };
+    drop(world);
+    info!(
+        "🧱 World stress {}: {} blocks in {} messages, {} edits at {}/s, final world {} blocks",
+        run_world,
+        publish.blocks,
+        messages.len(),
+        edits.len(),
+        config.edit_rate,
+        expected.len()
+    );
+
+    let (ready_tx, mut ready_rx) = mpsc::channel(config.subscribers.max(1));
+    let (published_tx, published_rx) = watch::channel(None);
+    let (last_edit_tx, last_edit_rx) = watch::channel(None);
+    let timeout = Duration::from_secs_f64(config.converge_timeout_secs.max(0.0));
+    let handles: Vec<_> = (0..config.subscribers)
+        .map(|index| {
+            tokio::spawn(run_subscriber(
+                config.clone(),
+                SubscriberRun {
+                    index,
+                    run_world: run_world.clone(),
+                    expected: expected.fingerprint(),
+                    edit_count: edits.len() as u64,
+                    ready_tx: ready_tx.clone(),
+                    published_rx: published_rx.clone(),
+                    last_edit_rx: last_edit_rx.clone(),
+                    timeout,
+                },
+            ))
+        })
+        .collect();
+    drop(ready_tx);
+    let mut ready = 0;
+    while ready < config.subscribers {
+        match tokio::time::timeout(timeout, ready_rx.recv()).await {
+            Ok(Some(())) => ready += 1,
+            _ => break,
+        }
+    }
+    if ready < config.subscribers {
+        warn!(
+            "Only {}/{} subscribers are ready",
+            ready, config.subscribers
+        );
+    }
+
+    let (client, mut eventloop) = AsyncClient::new(
+        mqtt_options(format!("world-stress-{}", run_id), &config),
+        64,
+    );
+    let poller = tokio::spawn(async move {
+        let mut errors = 0;
+        loop {
+            match eventloop.poll().await {
+                Ok(Event::Outgoing(rumqttc::Outgoing::Disconnect)) => break,
+                Ok(_) => {}
+                Err(e) => {
+                    errors += 1;
+                    debug!("World stress publisher connection error: {:?}", e);
+                    tokio::time::sleep(Duration::from_secs(1)).await;
+                }
+            }
+        }
+        errors
+    });
+
+    let info = WorldInfoMessage {
+        world_id: run_world.clone(),
+        world_name: run_world.clone(),
+        description: "World sync stress test".to_string(),
+        host_player: "world-stress".to_string(),
+        host_name: "World Stress".to_string(),
+        created_at: created_at.clone(),
+        last_updated: created_at,
+        player_count: 1,
+        max_players: 10,
+        is_public: false,
+        version: "1.0.0".to_string(),
+    };
+    let info_topic = format!("iotcraft/worlds/{}/info", run_world);
+    let info_payload = serde_json::to_string(&info).unwrap_or_default();
+    let publish_started = Instant::now();
+    let _ = published_tx.send(Some(publish_started));
+    let mut publish_errors = 0;
+    if client
+        .publish(&info_topic, QoS::AtLeastOnce, true, info_payload)
+        .await
+        .is_err()
+    {
+        publish_errors += 1;
+    }
+    for (topic, payload, retain) in messages {
+        if client
+            .publish(topic, QoS::AtLeastOnce, retain, payload)
+            .await
+            .is_err()
+        {
+            publish_errors += 1;
+        }
+    }
+
+    let mut pace = interval(Duration::from_secs_f64(1.0 / config.edit_rate.max(0.001)));
+    for (index, edit) in edits.iter().enumerate() {
+        pace.tick().await;
+        let (topic, payload) = edit_message(&run_world, edit);
+        if client
+            .publish(topic, QoS::AtLeastOnce, false, payload)
+            .await
+            .is_err()
+        {
+            publish_errors += 1;
+            continue;
+        }
+        publish.edits_published += 1;
+        if index == 0 {
+            publish.first_edit_at = publish_started.elapsed();
+        }
+    }
+    publish.last_edit_at = publish_started.elapsed();
+    let _ = last_edit_tx.send(Some(Instant::now()));
+
+    let mut subscribers = Vec::with_capacity(handles.len());
+    for handle in handles {
+        match handle.await {
+            Ok(stats) => subscribers.push(stats),
+            Err(e) => warn!("World stress subscriber failed: {}", e),
+        }
+    }
+
+    // Remove the retained world so the broker does not keep every test world
+    let data_topic = format!("iotcraft/worlds/{}/data", run_world);
+    let _ = client
+        .publish(&info_topic, QoS::AtLeastOnce, true, "")
+        .await;
+    let _ = client
+        .publish(&data_topic, QoS::AtLeastOnce, true, "")
+        .await;
+    let _ = client.disconnect().await;
+    publish.errors = publish_errors
+        + tokio::time::timeout(Duration::from_secs(5), poller)
+            .await
+            .ok()
+            .and_then(Result::ok)
+            .unwrap_or_default();
+
+    Ok(WorldStressReport::from_runs(
+        &config,
+        &run_id,
+        started_at,
+        run_world,
+        publish,
+        subscribers,
+    ))
+}
@@ -0,0 +1,200 @@
+//! Encodings for bulk block edits
+//!
+//! `place_blocks` takes positions packed into one flat `[x0, y0, z0, x1, y1, z1, ...]`
+//! array. `copy_region` / `paste_region` exchange a [`BlockRegion`]: a box of cells
+//! relative to its minimum corner, listed layer by layer (y), row by row (z), x fastest,
+//! and run-length encoded as `[count, palette_index]` pairs where index 0 is air and `n`
+//! is `palette[n - 1]`. A walled room is then a few dozen numbers instead of one JSON
+//! object per block.
+
+use crate::types::{BlockType, ProtocolError};
+
+#[cfg(feature = "serde")]
+use serde::{Deserialize, Serialize};
+
+/// Most blocks (or region cells) a single bulk tool call may touch
+pub const MAX_BULK_BLOCKS: u64 = 1 << 22;
+
+/// Unpack a flat `[x, y, z, ...]` position array
+pub fn unpack_positions(packed: &[i64]) -> Result<Vec<[i32; 3]>, ProtocolError> {
+    if packed.len() % 3 != 0 {
+        return Err(ProtocolError::InvalidParameters(
+            "positions must hold x, y, z triples".to_string(),
+        ));
+    }
+    if (packed.len() / 3) as u64 > MAX_BULK_BLOCKS {
+        return Err(ProtocolError::InvalidParameters(format!(
+            "at most {} positions per call",
+            MAX_BULK_BLOCKS
+        )));
+    }
+    packed
+        .chunks_exact(3)
+        .map(|xyz| {
+            let coordinate = |v: i64| {
+                i32::try_from(v).map_err(|_| {
+                    ProtocolError::InvalidParameters(format!("coordinate {} out of range", v))
+                })
+            };
+            Ok([
+                coordinate(xyz[0])?,
+                coordinate(xyz[1])?,
+                coordinate(xyz[2])?,
+            ])
+        })
+        .collect()
+}
+
+/// Cells of an axis-aligned box between two corners (inclusive, in any order)
+pub fn region_cells(from: [i32; 3], to: [i32; 3]) -> u64 {
+    (0..3)
+        .map(|axis| (from[axis] as i64 - to[axis] as i64).unsigned_abs() + 1)
+        .fold(1, u64::saturating_mul)
+}
+
+/// Run-length encoded blocks of a box, see the module docs
+#[derive(Debug, Clone, PartialEq, Eq)]
+#[cfg_attr(feature = "serde", derive(Serialize, Deserialize))]
+pub struct BlockRegion {
+    /// Cells along x, y and z
+    pub size: [u32; 3],
+    pub palette: Vec<BlockType>,
+    /// `[count, palette_index]` pairs
+    pub runs: Vec<u32>,
+}
+
+impl BlockRegion {
+    /// Encode a box of `size` cells whose block at offset `[x, y, z]` is `block_at`
+    pub fn encode(size: [u32; 3], mut block_at: impl FnMut([u32; 3]) -> Option<BlockType>) -> Self {
+        let mut region = BlockRegion {
+            size,
+            palette: Vec::new(),
+            runs: Vec::new(),
+        };
+        for y in 0..size[1] {
+            for z in 0..size[2] {
+                for x in 0..size[0] {
+                    let index = match block_at([x, y, z]) {
+                        None => 0,
+                        Some(block_type) => {
+                            match region.palette.iter().position(|b| *b == block_type) {
+                                Some(i) => i as u32 + 1,
+                                None => {
+                                    region.palette.push(block_type);
+                                    region.palette.len() as u32
+                                }
+                            }
+                        }
+                    };
+                    match region.runs.as_mut_slice() {
+                        [.., count, last] if *last == index => *count += 1,
+                        _ => region.runs.extend([1, index]),
+                    }
+                }
+            }
+        }
+        region
+    }
+
+    /// Number of cells in the box
+    pub fn volume(&self) -> u64 {
+        self.size
+            .iter()
+            .fold(1, |cells, s| cells.saturating_mul(*s as u64))
+    }
+
+    /// Check the runs against the size and palette before anything is applied
+    pub fn validate(&self) -> Result<(), ProtocolError> {
+        let invalid = |message: String| Err(ProtocolError::InvalidParameters(message));
+        if self.volume() > MAX_BULK_BLOCKS {
+            return invalid(format!("region larger than {} cells", MAX_BULK_BLOCKS));
+        }
+        if self.runs.len() % 2 != 0 {
+            return invalid("runs must hold count, palette index pairs".to_string());
+        }
+        let mut cells = 0u64;
+        for run in self.runs.chunks_exact(2) {
+            if run[1] as usize > self.palette.len() {
+                return invalid(format!("palette index {} out of range", run[1]));
+            }
+            cells += run[0] as u64;
+        }
+        if cells != self.volume() {
+            return invalid(format!(
+                "runs cover {} cells, region has {}",
+                cells,
+                self.volume()
+            ));
+        }
+        Ok(())
+    }
+
+    /// Visit every cell as (offset from the minimum corner, block or air)
+    pub fn for_each_cell(
+        &self,
+        mut visit: impl FnMut([u32; 3], Option<BlockType>),
+    ) -> Result<(), ProtocolError> {
+        self.validate()?;
+        let [sx, _, sz] = self.size;
+        let mut cell = 0u64;
+        for run in self.runs.chunks_exact(2) {
+            let block_type = run[1].checked_sub(1).map(|i| self.palette[i as usize]);
+            for _ in 0..run[0] {
+                let x = (cell % sx as u64) as u32;
+                let z = (cell / sx as u64 % sz as u64) as u32;
+                let y = (cell / (sx as u64 * sz as u64)) as u32;
+                visit([x, y, z], block_type);
+                cell += 1;
+            }
+        }
+        Ok(())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_region_round_trip() {
+        // A 4x3x5 box: stone floor, glass at one corner of the middle layer, air elsewhere
+        let size = [4, 3, 5];
+        let block_at = |[x, y, z]: [u32; 3]| match (x, y, z) {
+            (_, 0, _) => Some(BlockType::Stone),
+            (0, 1, 0) => Some(BlockType::GlassPane),
+            _ => None,
+        };
+        let region = BlockRegion::encode(size, block_at);
+        assert_eq!(region.palette, vec![BlockType::Stone, BlockType::GlassPane]);
+        assert_eq!(region.runs, vec![20, 1, 1, 2, 39, 0]);
+
+        let mut cells = Vec::new();
+        region
+            .for_each_cell(|offset, block_type| cells.push((offset, block_type)))
+            .unwrap();
+        assert_eq!(cells.len(), 60);
+        assert!(cells
+            .iter()
+            .all(|(offset, block_type)| block_at(*offset) == *block_type));
+    }
+
+    #[test]
+    fn test_invalid_bulk_input() {
+        let mut region = BlockRegion::encode([2, 1, 1], |_| Some(BlockType::Dirt));
+        region.runs[0] = 3;
+        assert!(region.validate().is_err());
+        region.runs = vec![2, 2];
+        assert!(region.validate().is_err());
+        region.size = [u32::MAX; 3];
+        assert!(region.validate().is_err());
+
+        assert_eq!(
+            unpack_positions(&[1, 2, 3, -4, 5, -6]).unwrap(),
+            vec![[1, 2, 3], [-4, 5, -6]]
+        );
+        assert!(unpack_positions(&[1, 2]).is_err());
+        assert!(unpack_positions(&[0, 0, i64::MAX]).is_err());
+        assert_eq!(region_cells([0, 0, 0], [-1, 2, 0]), 6);
+        assert_eq!(region_cells([i32::MIN; 3], [i32::MAX; 3]), u64::MAX);
+    }
+}
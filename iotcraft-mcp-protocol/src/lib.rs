@@ -20,6 +20,7 @@
 //! println!("Protocol version: {}", PROTOCOL_VERSION);
 //! ```
 
+pub mod bulk;
 pub mod protocol;
 pub mod tools;
 pub mod types;
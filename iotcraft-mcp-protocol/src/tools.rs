@@ -135,6 +135,11 @@ fn world_building_tools() -> Vec<McpTool> {
         .iter()
         .map(|b| b.as_str().to_string())
         .collect();
+    let fill_types: Vec<String> = block_types
+        .iter()
+        .cloned()
+        .chain(["air".to_string()])
+        .collect();
 
     vec![
         McpTool {
@@ -226,6 +231,113 @@ fn world_building_tools() -> Vec<McpTool> {
                 "required": ["block_type", "x1", "y1", "z1", "x2", "y2", "z2"]
             }),
         },
+        McpTool {
+            name: "place_blocks".to_string(),
+            description: "Place many blocks of one type in a single call; positions are packed \
+                          as [x0, y0, z0, x1, y1, z1, ...]"
+                .to_string(),
+            input_schema: json!({
+                "type": "object",
+                "properties": {
+                    "block_type": {
+                        "type": "string",
+                        "enum": block_types,
+                        "description": "Type of block to place"
+                    },
+                    "positions": {
+                        "type": "array",
+                        "items": {"type": "integer"},
+                        "description": "Flat array of x, y, z triples"
+                    }
+                },
+                "required": ["block_type", "positions"]
+            }),
+        },
+        McpTool {
+            name: "fill_region".to_string(),
+            description: "Fill the box between two corners with one block type, or clear it \
+                          with \"air\""
+                .to_string(),
+            input_schema: json!({
+                "type": "object",
+                "properties": {
+                    "block_type": {
+                        "type": "string",
+                        "enum": fill_types,
+                        "description": "Type of block to fill with; \"air\" removes blocks"
+                    },
+                    "x1": {"type": "integer", "description": "First corner X"},
+                    "y1": {"type": "integer", "description": "First corner Y"},
+                    "z1": {"type": "integer", "description": "First corner Z"},
+                    "x2": {"type": "integer", "description": "Opposite corner X"},
+                    "y2": {"type": "integer", "description": "Opposite corner Y"},
+                    "z2": {"type": "integer", "description": "Opposite corner Z"}
+                },
+                "required": ["block_type", "x1", "y1", "z1", "x2", "y2", "z2"]
+            }),
+        },
+        McpTool {
+            name: "copy_region".to_string(),
+            description: "Copy the box between two corners as a compact run-length encoded \
+                          region for paste_region"
+                .to_string(),
+            input_schema: json!({
+                "type": "object",
+                "properties": {
+                    "x1": {"type": "integer", "description": "First corner X"},
+                    "y1": {"type": "integer", "description": "First corner Y"},
+                    "z1": {"type": "integer", "description": "First corner Z"},
+                    "x2": {"type": "integer", "description": "Opposite corner X"},
+                    "y2": {"type": "integer", "description": "Opposite corner Y"},
+                    "z2": {"type": "integer", "description": "Opposite corner Z"}
+                },
+                "required": ["x1", "y1", "z1", "x2", "y2", "z2"]
+            }),
+        },
+        McpTool {
+            name: "paste_region".to_string(),
+            description: "Paste a region from copy_region with its minimum corner at x, y, z"
+                .to_string(),
+            input_schema: json!({
+                "type": "object",
+                "properties": {
+                    "x": {"type": "integer", "description": "Minimum corner X"},
+                    "y": {"type": "integer", "description": "Minimum corner Y"},
+                    "z": {"type": "integer", "description": "Minimum corner Z"},
+                    "region": {
+                        "type": "object",
+                        "description": "Region as returned by copy_region",
+                        "properties": {
+                            "size": {
+                                "type": "array",
+                                "items": {"type": "integer"},
+                                "minItems": 3,
+                                "maxItems": 3,
+                                "description": "Cells along x, y and z"
+                            },
+                            "palette": {
+                                "type": "array",
+                                "items": {"type": "string", "enum": block_types},
+                                "description": "Block types referenced by the runs"
+                            },
+                            "runs": {
+                                "type": "array",
+                                "items": {"type": "integer"},
+                                "description": "[count, palette index] pairs over the cells, \
+                                                y-major then z, x fastest; index 0 is air and \
+                                                n is palette[n - 1]"
+                            }
+                        },
+                        "required": ["size", "palette", "runs"]
+                    },
+                    "include_air": {
+                        "type": "boolean",
+                        "description": "Also clear blocks where the region has air (default false)"
+                    }
+                },
+                "required": ["x", "y", "z", "region"]
+            }),
+        },
     ]
 }
 
@@ -1,5 +1,7 @@
 //! Input validation utilities for MCP tools
 
+#[cfg(feature = "serde")]
+use crate::bulk::{region_cells, unpack_positions, BlockRegion, MAX_BULK_BLOCKS};
 use crate::types::{BlockType, DeviceType, GameState, Position3D, ProtocolError};
 
 #[cfg(feature = "serde")]
@@ -17,6 +19,10 @@ impl ToolValidator {
             "place_block" => Self::validate_place_block_params(params),
             "remove_block" => Self::validate_remove_block_params(params),
             "create_wall" => Self::validate_create_wall_params(params),
+            "place_blocks" => Self::validate_place_blocks_params(params),
+            "fill_region" => Self::validate_fill_region_params(params),
+            "copy_region" => Self::validate_corners(params),
+            "paste_region" => Self::validate_paste_region_params(params),
             "spawn_device" => Self::validate_spawn_device_params(params),
             "control_device" => Self::validate_control_device_params(params),
             "move_device" => Self::validate_move_device_params(params),
@@ -76,6 +82,87 @@ impl ToolValidator {
         Ok(())
     }
 
+    /// Validate place_blocks parameters
+    #[cfg(feature = "serde")]
+    fn validate_place_blocks_params(params: &Value) -> Result<(), ProtocolError> {
+        let block_type_str = params
+            .get("block_type")
+            .and_then(|v| v.as_str())
+            .ok_or_else(|| {
+                ProtocolError::InvalidParameters("block_type is required".to_string())
+            })?;
+        BlockType::from_str(block_type_str)?;
+
+        let packed = params
+            .get("positions")
+            .and_then(|v| v.as_array())
+            .ok_or_else(|| ProtocolError::InvalidParameters("positions is required".to_string()))?
+            .iter()
+            .map(|v| {
+                v.as_i64().ok_or_else(|| {
+                    ProtocolError::InvalidParameters("positions must be integers".to_string())
+                })
+            })
+            .collect::<Result<Vec<_>, _>>()?;
+        unpack_positions(&packed)?;
+        Ok(())
+    }
+
+    /// Validate fill_region parameters
+    #[cfg(feature = "serde")]
+    fn validate_fill_region_params(params: &Value) -> Result<(), ProtocolError> {
+        match params.get("block_type").and_then(|v| v.as_str()) {
+            Some("air") => {}
+            Some(block_type_str) => {
+                BlockType::from_str(block_type_str)?;
+            }
+            None => {
+                return Err(ProtocolError::InvalidParameters(
+                    "block_type is required".to_string(),
+                ))
+            }
+        }
+        Self::validate_corners(params)
+    }
+
+    /// Validate paste_region parameters
+    #[cfg(feature = "serde")]
+    fn validate_paste_region_params(params: &Value) -> Result<(), ProtocolError> {
+        Self::validate_coordinates(params)?;
+        let region = params
+            .get("region")
+            .ok_or_else(|| ProtocolError::InvalidParameters("region is required".to_string()))?;
+        let region: BlockRegion = serde_json::from_value(region.clone())
+            .map_err(|e| ProtocolError::InvalidParameters(format!("invalid region: {}", e)))?;
+        region.validate()
+    }
+
+    /// Validate the two corners (x1..z2) of a bulk region and its size
+    #[cfg(feature = "serde")]
+    fn validate_corners(params: &Value) -> Result<(), ProtocolError> {
+        let corner = |suffix: &str| -> Result<[i32; 3], ProtocolError> {
+            let mut corner = [0; 3];
+            for (value, axis) in corner.iter_mut().zip(["x", "y", "z"]) {
+                let name = format!("{}{}", axis, suffix);
+                *value = params
+                    .get(&name)
+                    .and_then(|v| v.as_i64())
+                    .and_then(|v| i32::try_from(v).ok())
+                    .ok_or_else(|| {
+                        ProtocolError::InvalidParameters(format!("{} must be an integer", name))
+                    })?;
+            }
+            Ok(corner)
+        };
+        if region_cells(corner("1")?, corner("2")?) > MAX_BULK_BLOCKS {
+            return Err(ProtocolError::InvalidParameters(format!(
+                "region larger than {} cells",
+                MAX_BULK_BLOCKS
+            )));
+        }
+        Ok(())
+    }
+
     /// Validate spawn_device parameters
     #[cfg(feature = "serde")]
     fn validate_spawn_device_params(params: &Value) -> Result<(), ProtocolError> {
@@ -320,6 +407,30 @@ mod tests {
         assert!(validate_world_name("world:with:colons").is_err());
     }
 
+    #[cfg(feature = "serde")]
+    #[test]
+    fn test_validate_bulk_tools() {
+        use serde_json::json;
+
+        let place = json!({"block_type": "stone", "positions": [0, 1, 2, 3, 4, 5]});
+        assert!(ToolValidator::validate_tool_params("place_blocks", &place).is_ok());
+        let ragged = json!({"block_type": "stone", "positions": [0, 1]});
+        assert!(ToolValidator::validate_tool_params("place_blocks", &ragged).is_err());
+
+        let fill =
+            json!({"block_type": "air", "x1": 0, "y1": 0, "z1": 0, "x2": -3, "y2": 2, "z2": 9});
+        assert!(ToolValidator::validate_tool_params("fill_region", &fill).is_ok());
+        let huge = json!({"block_type": "dirt", "x1": 0, "y1": 0, "z1": 0, "x2": 4096, "y2": 4096, "z2": 1});
+        assert!(ToolValidator::validate_tool_params("fill_region", &huge).is_err());
+
+        let region =
+            BlockRegion::encode([2, 2, 2], |[x, _, _]| (x == 0).then_some(BlockType::Water));
+        let paste = json!({"x": 1, "y": 2, "z": 3, "region": region});
+        assert!(ToolValidator::validate_tool_params("paste_region", &paste).is_ok());
+        let truncated = json!({"x": 1, "y": 2, "z": 3, "region": {"size": [2, 2, 2], "palette": [], "runs": [4, 0]}});
+        assert!(ToolValidator::validate_tool_params("paste_region", &truncated).is_err());
+    }
+
     #[test]
     fn test_validate_position_bounds() {
         let valid_pos = Position3D::new(10.0, 20.0, 30.0);
@@ -0,0 +1,509 @@
+//! Benchmark mode: concurrent scenario runs with per-step latency statistics
+//!
+//! Every scenario instance gets its own block of ports (broker first, then one MCP port
+//! per client) so several scenarios, or several copies of one, can run side by side.
+//!
+//! A step is measured when it is an MCP call that lists an `MqttMessage` expectation:
+//! the MCP latency runs from sending the call to its response, the effect latency from
+//! sending the call to the first matching message seen on the instance's broker.
+//! All steps run once in order; measured steps then repeat until each ran `repeat`
+//! times. The resulting [`BenchReport`] can be stored and used as a baseline.
+
+use crate::scenario_types::{Action, Expectation, Scenario, Step};
+use crate::system_monitor::{render_usage, ProcessUsage};
+use regex::Regex;
+use serde::{Deserialize, Serialize};
+use std::fmt::Write;
+
+/// Ports reserved for each scenario instance
+pub const PORTS_PER_INSTANCE: u16 = 100;
+
+/// Wait for an expected MQTT message when the expectation sets no `within_ms`
+pub const DEFAULT_EFFECT_TIMEOUT_MS: u64 = 10_000;
+
+/// p95 increases below this are treated as noise, whatever their percentage
+pub const MIN_REGRESSION_MS: f64 = 2.0;
+
+/// Move scenario instance `index` onto its own port block starting at `first_port`
+pub fn isolate_ports(scenario: &mut Scenario, first_port: u16, index: usize) -> Result<(), String> {
+    if scenario.clients.len() + 2 > PORTS_PER_INSTANCE as usize {
+        return Err(format!(
+            "{} clients do not fit in a block of {} ports",
+            scenario.clients.len(),
+            PORTS_PER_INSTANCE
+        ));
+    }
+    let base = first_port as usize + index * PORTS_PER_INSTANCE as usize;
+    if base + PORTS_PER_INSTANCE as usize > u16::MAX as usize {
+        return Err(format!("no ports left for scenario instance {}", index));
+    }
+    let base = base as u16;
+
+    scenario.infrastructure.mqtt_server.port = base;
+    for (i, client) in scenario.clients.iter_mut().enumerate() {
+        client.mcp_port = base + 1 + i as u16;
+    }
+    if let Some(mcp_server) = &mut scenario.infrastructure.mcp_server {
+        mcp_server.port = base + 1 + scenario.clients.len() as u16;
+    }
+    Ok(())
+}
+
+/// Whether an MQTT topic filter (with `+` and `#` wildcards) matches a topic
+pub fn topic_matches(filter: &str, topic: &str) -> bool {
+    let mut levels = topic.split('/');
+    for part in filter.split('/') {
+        match (part, levels.next()) {
+            ("#", _) => return true,
+            ("+", Some(_)) => {}
+            (part, Some(level)) if part == level => {}
+            _ => return false,
+        }
+    }
+    levels.next().is_none()
+}
+
+/// The MQTT message that shows a measured step took effect
+#[derive(Debug, Clone)]
+pub struct EffectExpectation {
+    pub topic: String,
+    pub payload: Option<Regex>,
+    pub within_ms: u64,
+}
+
+impl EffectExpectation {
+    pub fn matches(&self, topic: &str, payload: &[u8]) -> bool {
+        topic_matches(&self.topic, topic)
+            && self.payload.as_ref().map_or(true, |pattern| {
+                pattern.is_match(&String::from_utf8_lossy(payload))
+            })
+    }
+}
+
+/// The effect a step is measured against, or `None` if the step is not measured
+pub fn expected_effect(step: &Step) -> Result<Option<EffectExpectation>, String> {
+    if !matches!(step.action, Action::McpCall { .. }) {
+        return Ok(None);
+    }
+    let Some(expectations) = &step.expectations else {
+        return Ok(None);
+    };
+    for expectation in expectations {
+        if let Expectation::MqttMessage {
+            topic,
+            payload_pattern,
+            within_ms,
+        } = expectation
+        {
+            let payload = payload_pattern
+                .as_deref()
+                .map(Regex::new)
+                .transpose()
+                .map_err(|e| format!("step '{}': bad payload_pattern: {}", step.name, e))?;
+            return Ok(Some(EffectExpectation {
+                topic: topic.clone(),
+                payload,
+                within_ms: within_ms.unwrap_or(DEFAULT_EFFECT_TIMEOUT_MS),
+            }));
+        }
+    }
+    Ok(None)
+}
+
+/// Summary of a set of latency samples in milliseconds
+#[derive(Debug, Clone, Default, PartialEq, Serialize, Deserialize)]
+pub struct LatencyStats {
+    pub samples: usize,
+    pub mean_ms: f64,
+    pub p50_ms: f64,
+    pub p95_ms: f64,
+    pub p99_ms: f64,
+    pub max_ms: f64,
+}
+
+impl LatencyStats {
+    pub fn from_samples(samples: &[f64]) -> Self {
+        if samples.is_empty() {
+            return Self::default();
+        }
+        let mut sorted = samples.to_vec();
+        sorted.sort_by(f64::total_cmp);
+        // Nearest-rank percentile
+        let percentile = |q: f64| sorted[((q * sorted.len() as f64).ceil() as usize).max(1) - 1];
+        Self {
+            samples: sorted.len(),
+            mean_ms: sorted.iter().sum::<f64>() / sorted.len() as f64,
+            p50_ms: percentile(0.50),
+            p95_ms: percentile(0.95),
+            p99_ms: percentile(0.99),
+            max_ms: sorted[sorted.len() - 1],
+        }
+    }
+}
+
+/// Latencies of one measured step
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct StepBench {
+    pub step: String,
+    pub mcp: LatencyStats,
+    /// Missing when the scenario has no broker to observe
+    pub effect: Option<LatencyStats>,
+    /// Runs whose expected message did not arrive in time
+    pub failures: usize,
+}
+
+impl StepBench {
+    /// The latency regressions are judged on: the effect if observed, else the MCP call
+    pub fn headline(&self) -> &LatencyStats {
+        self.effect.as_ref().unwrap_or(&self.mcp)
+    }
+}
+
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct ScenarioBench {
+    pub scenario: String,
+    pub instance: usize,
+    pub mqtt_port: u16,
+    /// Why the instance stopped early, if it did
+    pub error: Option<String>,
+    pub steps: Vec<StepBench>,
+    /// CPU and memory of the instance's broker and clients over the run
+    #[serde(default, skip_serializing_if = "Vec::is_empty")]
+    pub resources: Vec<ProcessUsage>,
+}
+
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct BenchReport {
+    pub timestamp: String,
+    pub repeat: usize,
+    pub scenarios: Vec<ScenarioBench>,
+}
+
+/// Samples collected while a scenario instance runs, in step order
+#[derive(Debug, Default)]
+pub struct ScenarioSamples {
+    steps: Vec<(String, Vec<f64>, Vec<f64>, usize)>,
+}
+
+impl ScenarioSamples {
+    fn entry(&mut self, step: &str) -> &mut (String, Vec<f64>, Vec<f64>, usize) {
+        let index = match self.steps.iter().position(|(name, ..)| name == step) {
+            Some(index) => index,
+            None => {
+                self.steps
+                    .push((step.to_string(), Vec::new(), Vec::new(), 0));
+                self.steps.len() - 1
+            }
+        };
+        &mut self.steps[index]
+    }
+
+    /// Record one run; `effect_ms` is `None` when nothing was observed for it
+    pub fn record(&mut self, step: &str, mcp_ms: f64, effect_ms: Option<f64>) {
+        let (_, mcp, effect, _) = self.entry(step);
+        mcp.push(mcp_ms);
+        effect.extend(effect_ms);
+    }
+
+    /// Record a run whose expected message never arrived
+    pub fn record_missed(&mut self, step: &str, mcp_ms: f64) {
+        let (_, mcp, _, failures) = self.entry(step);
+        mcp.push(mcp_ms);
+        *failures += 1;
+    }
+
+    pub fn finish(
+        self,
+        scenario: &Scenario,
+        instance: usize,
+        error: Option<String>,
+    ) -> ScenarioBench {
+        let observed = scenario.infrastructure.mqtt_server.required;
+        ScenarioBench {
+            scenario: scenario.name.clone(),
+            instance,
+            mqtt_port: scenario.infrastructure.mqtt_server.port,
+            error,
+            steps: self
+                .steps
+                .into_iter()
+                .map(|(step, mcp, effect, failures)| StepBench {
+                    step,
+                    mcp: LatencyStats::from_samples(&mcp),
+                    effect: observed.then(|| LatencyStats::from_samples(&effect)),
+                    failures,
+                })
+                .collect(),
+            resources: Vec::new(),
+        }
+    }
+}
+
+/// A step that got worse than the baseline allows
+#[derive(Debug, Clone, PartialEq)]
+pub struct Regression {
+    pub scenario: String,
+    pub step: String,
+    pub kind: RegressionKind,
+}
+
+#[derive(Debug, Clone, PartialEq)]
+pub enum RegressionKind {
+    /// The headline p95 grew by more than the allowed percentage
+    Slower {
+        baseline_p95_ms: f64,
+        current_p95_ms: f64,
+    },
+    /// Runs missed their expected message; a p95 over the remaining runs would hide that
+    Failures {
+        failures: usize,
+        runs: usize,
+        baseline_failures: Option<usize>,
+    },
+    /// Nothing was measured, so a p95 of zero would look like an improvement
+    NoSamples,
+}
+
+impl std::fmt::Display for RegressionKind {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        match self {
+            RegressionKind::Slower {
+                baseline_p95_ms,
+                current_p95_ms,
+            } => write!(
+                f,
+                "p95 {:.2} ms -> {:.2} ms",
+                baseline_p95_ms, current_p95_ms
+            ),
+            RegressionKind::Failures {
+                failures,
+                runs,
+                baseline_failures,
+            } => {
+                write!(f, "{} of {} runs missed their effect", failures, runs)?;
+                match baseline_failures {
+                    Some(before) => write!(f, " (baseline: {})", before),
+                    None => Ok(()),
+                }
+            }
+            RegressionKind::NoSamples => write!(f, "no latency samples"),
+        }
+    }
+}
+
+fn find_step<'a>(report: &'a BenchReport, scenario: &str, step: &str) -> Option<&'a StepBench> {
+    report
+        .scenarios
+        .iter()
+        .filter(|s| s.scenario == scenario)
+        .flat_map(|s| &s.steps)
+        .find(|s| s.step == step)
+}
+
+/// Steps that missed their effect or measured nothing, and steps present in both reports
+/// whose p95 grew by more than `max_regression_pct`
+pub fn compare(
+    current: &BenchReport,
+    baseline: &BenchReport,
+    max_regression_pct: f64,
+) -> Vec<Regression> {
+    let mut regressions = Vec::new();
+    for scenario in &current.scenarios {
+        for step in &scenario.steps {
+            let before = find_step(baseline, &scenario.scenario, &step.step);
+            let kind = if step.failures > 0 {
+                Some(RegressionKind::Failures {
+                    failures: step.failures,
+                    runs: step.mcp.samples,
+                    baseline_failures: before.map(|before| before.failures),
+                })
+            } else if step.headline().samples == 0 {
+                Some(RegressionKind::NoSamples)
+            } else {
+                before
+                    .map(|before| (before.headline().p95_ms, step.headline().p95_ms))
+                    .filter(|(was, now)| {
+                        now - was > MIN_REGRESSION_MS
+                            && *now > was * (1.0 + max_regression_pct / 100.0)
+                    })
+                    .map(|(was, now)| RegressionKind::Slower {
+                        baseline_p95_ms: was,
+                        current_p95_ms: now,
+                    })
+            };
+            if let Some(kind) = kind {
+                regressions.push(Regression {
+                    scenario: scenario.scenario.clone(),
+                    step: step.step.clone(),
+                    kind,
+                });
+            }
+        }
+    }
+    regressions
+}
+
+/// Text table of a report, with the p95 change against `baseline` when given
+pub fn render_summary(report: &BenchReport, baseline: Option<&BenchReport>) -> String {
+    let mut out = String::new();
+    for scenario in &report.scenarios {
+        let _ = writeln!(
+            out,
+            "\n🎭 {} (instance {}, broker port {})",
+            scenario.scenario, scenario.instance, scenario.mqtt_port
+        );
+        if let Some(error) = &scenario.error {
+            let _ = writeln!(out, "   ❌ stopped early: {}", error);
+        }
+        let _ = writeln!(
+            out,
+            "   {:<32} {:>5} {:>9} {:>9} {:>9} {:>9} {:>6} {:>9}",
+            "step", "runs", "mean ms", "p95 ms", "p99 ms", "mcp p95", "missed", "vs base"
+        );
+        for step in &scenario.steps {
+            let headline = step.headline();
+            let change = baseline
+                .filter(|_| headline.samples > 0)
+                .and_then(|b| find_step(b, &scenario.scenario, &step.step))
+                .map(|before| before.headline().p95_ms)
+                .filter(|was| *was > 0.0)
+                .map(|was| format!("{:+.1}%", (headline.p95_ms / was - 1.0) * 100.0))
+                .unwrap_or_else(|| "-".to_string());
+            let _ = writeln!(
+                out,
+                "   {:<32} {:>5} {:>9.2} {:>9.2} {:>9.2} {:>9.2} {:>6} {:>9}",
+                step.step,
+                step.mcp.samples,
+                headline.mean_ms,
+                headline.p95_ms,
+                headline.p99_ms,
+                step.mcp.p95_ms,
+                step.failures,
+                change
+            );
+        }
+        out.push_str(&render_usage(&scenario.resources));
+    }
+    out
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::scenario_types::*;
+
+    fn scenario(name: &str, clients: usize) -> Scenario {
+        Scenario {
+            name: name.to_string(),
+            description: String::new(),
+            version: String::new(),
+            infrastructure: InfrastructureConfig::default(),
+            clients: (0..clients)
+                .map(|i| ClientConfig {
+                    id: format!("client{}", i),
+                    player_id: format!("player{}", i),
+                    mcp_port: 8080,
+                    client_type: "desktop".to_string(),
+                    name: None,
+                    config: None,
+                })
+                .collect(),
+            steps: vec![],
+            config: None,
+        }
+    }
+
+    fn report(step: &str, effect_ms: &[f64]) -> BenchReport {
+        let mut samples = ScenarioSamples::default();
+        for ms in effect_ms {
+            samples.record(step, 1.0, Some(*ms));
+        }
+        BenchReport {
+            timestamp: String::new(),
+            repeat: effect_ms.len(),
+            scenarios: vec![samples.finish(&scenario("sync", 2), 0, None)],
+        }
+    }
+
+    #[test]
+    fn test_isolate_ports_and_topics() {
+        let mut s = scenario("sync", 3);
+        isolate_ports(&mut s, 20000, 2).unwrap();
+        assert_eq!(s.infrastructure.mqtt_server.port, 20200);
+        let ports: Vec<_> = s.clients.iter().map(|c| c.mcp_port).collect();
+        assert_eq!(ports, vec![20201, 20202, 20203]);
+        assert!(isolate_ports(&mut s, 65000, 6).is_err());
+
+        assert!(topic_matches(
+            "iotcraft/worlds/+/state/blocks/placed",
+            "iotcraft/worlds/w1/state/blocks/placed"
+        ));
+        assert!(topic_matches("iotcraft/#", "iotcraft/worlds/w1/info"));
+        assert!(!topic_matches(
+            "iotcraft/worlds/+",
+            "iotcraft/worlds/w1/info"
+        ));
+        assert!(!topic_matches(
+            "iotcraft/worlds/+/info",
+            "iotcraft/worlds/info"
+        ));
+    }
+
+    #[test]
+    fn test_stats_and_baseline_comparison() {
+        let samples: Vec<f64> = (1..=100).map(f64::from).collect();
+        let stats = LatencyStats::from_samples(&samples);
+        assert_eq!(stats.samples, 100);
+        assert_eq!(stats.mean_ms, 50.5);
+        assert_eq!(
+            (stats.p50_ms, stats.p95_ms, stats.p99_ms),
+            (50.0, 95.0, 99.0)
+        );
+        assert_eq!(LatencyStats::from_samples(&[]), LatencyStats::default());
+
+        let baseline = report("place", &[10.0; 20]);
+        assert!(compare(&report("place", &[11.0; 20]), &baseline, 20.0).is_empty());
+        let slower = compare(&report("place", &[30.0; 20]), &baseline, 20.0);
+        assert_eq!(slower.len(), 1);
+        assert_eq!(
+            slower[0].kind,
+            RegressionKind::Slower {
+                baseline_p95_ms: 10.0,
+                current_p95_ms: 30.0
+            }
+        );
+        // Steps missing from the baseline are new, not regressions
+        assert!(compare(&report("remove", &[30.0; 20]), &baseline, 20.0).is_empty());
+
+        // Missed effects fail the comparison even when the runs that arrived were fast
+        let mut missed = ScenarioSamples::default();
+        missed.record("place", 1.0, Some(5.0));
+        missed.record_missed("place", 1.0);
+        let missed = BenchReport {
+            timestamp: String::new(),
+            repeat: 2,
+            scenarios: vec![missed.finish(&scenario("sync", 2), 0, None)],
+        };
+        assert_eq!(
+            compare(&missed, &baseline, 20.0)[0].kind,
+            RegressionKind::Failures {
+                failures: 1,
+                runs: 2,
+                baseline_failures: Some(0)
+            }
+        );
+        // An empty sample set has a p95 of zero, which must not pass as an improvement
+        let mut empty = report("place", &[]);
+        empty.scenarios[0].steps.push(StepBench {
+            step: "place".to_string(),
+            mcp: LatencyStats::default(),
+            effect: Some(LatencyStats::default()),
+            failures: 0,
+        });
+        assert_eq!(
+            compare(&empty, &baseline, 20.0)[0].kind,
+            RegressionKind::NoSamples
+        );
+        assert!(render_summary(&report("place", &[30.0; 20]), Some(&baseline)).contains("+200.0%"));
+    }
+}
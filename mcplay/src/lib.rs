@@ -3,7 +3,11 @@
 //! This library provides functionality for parsing, validating, and executing
 //! multi-client scenarios for IoTCraft testing.
 
+pub mod bench;
+pub mod log_pipeline;
+pub mod mqtt_probe;
 pub mod scenario_types;
+pub mod system_monitor;
 
 pub use scenario_types::*;
 
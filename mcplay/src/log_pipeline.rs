@@ -0,0 +1,360 @@
+//! Batched log pipeline shared by the TUI and headless runs
+//!
+//! - Child process output is read through large buffered readers and handled a burst of
+//!   complete lines at a time ([`read_line_batches`]).
+//! - ANSI escape sequences are removed by a single-pass byte scanner ([`strip_ansi`]).
+//! - Every log file has exactly one writer thread ([`log_writer`]). It takes whatever is
+//!   queued as one batch, writes it through a `BufWriter` and flushes once the queue is
+//!   empty, so nothing opens a file per message.
+//! - The TUI reads from a bounded [`LogRing`] that drops its oldest entries (and counts
+//!   them) rather than letting a chatty client grow memory. Log files are always complete.
+
+use std::borrow::Cow;
+use std::collections::{HashMap, VecDeque};
+use std::fmt::Write as _;
+use std::fs::OpenOptions;
+use std::io::{BufWriter, Write};
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::mpsc::{channel, Receiver, Sender};
+use std::sync::{Mutex, OnceLock};
+use std::time::{Duration, Instant};
+use tokio::io::{AsyncBufReadExt, AsyncRead, BufReader};
+
+/// Read buffer per child process stream
+const READ_BUFFER_BYTES: usize = 64 * 1024;
+/// Write buffer per log file
+const WRITE_BUFFER_BYTES: usize = 64 * 1024;
+/// A "line" longer than this without a newline is passed on as is
+const MAX_LINE_BYTES: usize = 1024 * 1024;
+
+static LINES_WRITTEN: AtomicU64 = AtomicU64::new(0);
+static BYTES_WRITTEN: AtomicU64 = AtomicU64::new(0);
+static FIRST_WRITE: OnceLock<Instant> = OnceLock::new();
+static WRITERS: OnceLock<Mutex<HashMap<PathBuf, LogWriter>>> = OnceLock::new();
+
+/// Remove ANSI CSI sequences (`ESC [ params letter`), borrowing when there are none
+pub fn strip_ansi(text: &str) -> Cow<'_, str> {
+    let bytes = text.as_bytes();
+    let Some(first) = bytes.iter().position(|b| *b == 0x1b) else {
+        return Cow::Borrowed(text);
+    };
+    let mut out = String::with_capacity(text.len());
+    let mut copied = 0;
+    let mut i = first;
+    while i < bytes.len() {
+        if bytes[i] == 0x1b && bytes.get(i + 1) == Some(&b'[') {
+            let mut end = i + 2;
+            while end < bytes.len() && matches!(bytes[end], b'0'..=b'9' | b';' | b'?') {
+                end += 1;
+            }
+            if end < bytes.len() && bytes[end].is_ascii_alphabetic() {
+                // ESC and the final letter are ASCII, so both ends are char boundaries
+                out.push_str(&text[copied..i]);
+                copied = end + 1;
+                i = end + 1;
+                continue;
+            }
+        }
+        i += 1;
+    }
+    out.push_str(&text[copied..]);
+    Cow::Owned(out)
+}
+
+/// Append `[time] prefix message\n` to `out`, with ANSI escapes and trailing space removed
+pub fn push_entry(out: &mut String, time: &str, prefix: &str, message: &str) {
+    out.push('[');
+    out.push_str(time);
+    out.push_str("] ");
+    out.push_str(prefix);
+    out.push_str(strip_ansi(message).trim_end());
+    out.push('\n');
+}
+
+/// `HH:MM:SS.mmm` of the current time, formatted at most once per millisecond
+#[derive(Default)]
+pub struct LogClock {
+    millis: i64,
+    text: String,
+}
+
+impl LogClock {
+    pub fn now(&mut self) -> &str {
+        let now = chrono::Utc::now();
+        if now.timestamp_millis() != self.millis || self.text.is_empty() {
+            self.millis = now.timestamp_millis();
+            self.text.clear();
+            let _ = write!(self.text, "{}", now.format("%H:%M:%S%.3f"));
+        }
+        &self.text
+    }
+}
+
+/// Read `reader` to its end, passing each burst of complete lines to `handle`
+///
+/// Lines are split on `\n` with a trailing `\r` removed; invalid UTF-8 is replaced rather
+/// than ending the stream.
+pub async fn read_line_batches<R: AsyncRead + Unpin>(reader: R, mut handle: impl FnMut(&[&str])) {
+    let mut reader = BufReader::with_capacity(READ_BUFFER_BYTES, reader);
+    let mut partial: Vec<u8> = Vec::new();
+    loop {
+        let chunk = match reader.fill_buf().await {
+            Ok(chunk) if !chunk.is_empty() => chunk,
+            _ => break,
+        };
+        let consumed = chunk.len();
+        match chunk.iter().rposition(|b| *b == b'\n') {
+            Some(end) => {
+                partial.extend_from_slice(&chunk[..end]);
+                {
+                    let text = String::from_utf8_lossy(&partial);
+                    let lines: Vec<&str> = text
+                        .split('\n')
+                        .map(|line| line.trim_end_matches('\r'))
+                        .collect();
+                    handle(&lines);
+                }
+                partial.clear();
+                partial.extend_from_slice(&chunk[end + 1..]);
+            }
+            None => partial.extend_from_slice(chunk),
+        }
+        reader.consume(consumed);
+        if partial.len() > MAX_LINE_BYTES {
+            handle(&[String::from_utf8_lossy(&partial).trim_end_matches('\r')]);
+            partial.clear();
+        }
+    }
+    if !partial.is_empty() {
+        handle(&[String::from_utf8_lossy(&partial).trim_end_matches('\r')]);
+    }
+}
+
+enum WriterMessage {
+    Entry(String),
+    Flush(Sender<()>),
+}
+
+/// Handle to the writer thread of one log file
+#[derive(Clone)]
+pub struct LogWriter {
+    sender: Sender<WriterMessage>,
+}
+
+impl LogWriter {
+    fn spawn(path: &Path) -> Self {
+        let (sender, receiver) = channel();
+        let thread_path = path.to_path_buf();
+        if let Err(e) = std::thread::Builder::new()
+            .name("mcplay-log-writer".to_string())
+            .spawn(move || run_writer(&thread_path, receiver))
+        {
+            eprintln!("Failed to start log writer for {}: {}", path.display(), e);
+        }
+        Self { sender }
+    }
+
+    /// Queue complete log lines, each ending in `\n`
+    pub fn write(&self, entry: String) {
+        let _ = self.sender.send(WriterMessage::Entry(entry));
+    }
+
+    /// Wait (up to a second) until everything queued so far is written
+    pub fn flush(&self) {
+        let (ack, done) = channel();
+        if self.sender.send(WriterMessage::Flush(ack)).is_ok() {
+            let _ = done.recv_timeout(Duration::from_secs(1));
+        }
+    }
+}
+
+fn run_writer(path: &Path, receiver: Receiver<WriterMessage>) {
+    if let Some(dir) = path.parent() {
+        let _ = std::fs::create_dir_all(dir);
+    }
+    let file = match OpenOptions::new().create(true).append(true).open(path) {
+        Ok(file) => file,
+        Err(e) => {
+            eprintln!("Failed to open log file {}: {}", path.display(), e);
+            return;
+        }
+    };
+    let mut out = BufWriter::with_capacity(WRITE_BUFFER_BYTES, file);
+    let mut acks = Vec::new();
+    while let Ok(message) = receiver.recv() {
+        // Everything already queued goes out as one batch
+        let mut next = Some(message);
+        while let Some(message) = next {
+            match message {
+                WriterMessage::Entry(entry) => {
+                    let lines = entry.bytes().filter(|b| *b == b'\n').count();
+                    LINES_WRITTEN.fetch_add(lines as u64, Ordering::Relaxed);
+                    BYTES_WRITTEN.fetch_add(entry.len() as u64, Ordering::Relaxed);
+                    if let Err(e) = out.write_all(entry.as_bytes()) {
+                        eprintln!("Failed to write to log file {}: {}", path.display(), e);
+                    }
+                }
+                WriterMessage::Flush(ack) => acks.push(ack),
+            }
+            next = receiver.try_recv().ok();
+        }
+        if let Err(e) = out.flush() {
+            eprintln!("Failed to flush log file {}: {}", path.display(), e);
+        }
+        for ack in acks.drain(..) {
+            let _ = ack.send(());
+        }
+    }
+}
+
+/// The writer of `path`, started on first use; every caller shares the same thread
+pub fn log_writer(path: &Path) -> LogWriter {
+    let mut writers = WRITERS
+        .get_or_init(Default::default)
+        .lock()
+        .unwrap_or_else(|e| e.into_inner());
+    FIRST_WRITE.get_or_init(Instant::now);
+    writers
+        .entry(path.to_path_buf())
+        .or_insert_with(|| LogWriter::spawn(path))
+        .clone()
+}
+
+/// Wait until every log file has been written out
+pub fn flush_log_writers() {
+    let writers: Vec<LogWriter> = match WRITERS.get() {
+        Some(writers) => writers
+            .lock()
+            .unwrap_or_else(|e| e.into_inner())
+            .values()
+            .cloned()
+            .collect(),
+        None => return,
+    };
+    for writer in writers {
+        writer.flush();
+    }
+}
+
+/// Totals of everything written to log files so far
+#[derive(Debug, Clone, Copy)]
+pub struct PipelineStats {
+    pub lines: u64,
+    pub bytes: u64,
+    pub elapsed: Duration,
+}
+
+impl PipelineStats {
+    pub fn lines_per_sec(&self) -> f64 {
+        self.lines as f64 / self.elapsed.as_secs_f64().max(1e-3)
+    }
+}
+
+pub fn pipeline_stats() -> PipelineStats {
+    PipelineStats {
+        lines: LINES_WRITTEN.load(Ordering::Relaxed),
+        bytes: BYTES_WRITTEN.load(Ordering::Relaxed),
+        elapsed: FIRST_WRITE.get().map(|t| t.elapsed()).unwrap_or_default(),
+    }
+}
+
+/// Bounded queue between log producers and the TUI that drops the oldest entries
+pub struct LogRing<T> {
+    entries: Mutex<VecDeque<T>>,
+    capacity: usize,
+    dropped: AtomicU64,
+}
+
+impl<T> LogRing<T> {
+    pub fn new(capacity: usize) -> Self {
+        Self {
+            entries: Mutex::new(VecDeque::with_capacity(capacity)),
+            capacity: capacity.max(1),
+            dropped: AtomicU64::new(0),
+        }
+    }
+
+    pub fn push(&self, entry: T) {
+        let mut entries = self.entries.lock().unwrap_or_else(|e| e.into_inner());
+        if entries.len() == self.capacity {
+            entries.pop_front();
+            self.dropped.fetch_add(1, Ordering::Relaxed);
+        }
+        entries.push_back(entry);
+    }
+
+    /// Take every queued entry, plus how many were dropped since the last drain
+    pub fn drain(&self) -> (Vec<T>, u64) {
+        let entries = self
+            .entries
+            .lock()
+            .unwrap_or_else(|e| e.into_inner())
+            .drain(..)
+            .collect();
+        (entries, self.dropped.swap(0, Ordering::Relaxed))
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_strip_ansi() {
+        assert!(matches!(strip_ansi("plain 🎮 text"), Cow::Borrowed(_)));
+        assert_eq!(
+            strip_ansi("\x1b[1;32mINFO\x1b[0m ✅ ready\x1b[K"),
+            "INFO ✅ ready"
+        );
+        assert_eq!(strip_ansi("\x1b[?25hcursor"), "cursor");
+        // Not a complete CSI sequence: left alone, like the old regex did
+        assert_eq!(strip_ansi("a\x1b[12"), "a\x1b[12");
+        assert_eq!(strip_ansi("a\x1b]x"), "a\x1b]x");
+
+        let mut entry = String::new();
+        push_entry(
+            &mut entry,
+            "12:00:00.000",
+            "[STDERR] ",
+            "\x1b[31merror\x1b[0m",
+        );
+        assert_eq!(entry, "[12:00:00.000] [STDERR] error\n");
+    }
+
+    #[tokio::test]
+    async fn test_line_batches_and_ring() {
+        let input: &[u8] = b"one\r\ntwo\n\xffthree\npartial";
+        let mut lines = Vec::new();
+        read_line_batches(input, |batch| {
+            lines.extend(batch.iter().map(|line| line.to_string()))
+        })
+        .await;
+        assert_eq!(lines, vec!["one", "two", "\u{fffd}three", "partial"]);
+
+        let ring = LogRing::new(3);
+        for i in 0..5 {
+            ring.push(i);
+        }
+        assert_eq!(ring.drain(), (vec![2, 3, 4], 2));
+        assert_eq!(ring.drain(), (vec![], 0));
+    }
+
+    #[test]
+    fn test_writer_batches_to_one_file() {
+        let path = std::env::temp_dir().join(format!("mcplay_log_{}.log", std::process::id()));
+        let _ = std::fs::remove_file(&path);
+        let writer = log_writer(&path);
+        for i in 0..100 {
+            let mut entry = String::new();
+            push_entry(&mut entry, "t", "", &format!("line {}", i));
+            log_writer(&path).write(entry);
+        }
+        writer.flush();
+        let written = std::fs::read_to_string(&path).unwrap();
+        assert_eq!(written.lines().count(), 100);
+        assert!(written.ends_with("[t] line 99\n"));
+        assert!(pipeline_stats().lines >= 100);
+        let _ = std::fs::remove_file(&path);
+    }
+}
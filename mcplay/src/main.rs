@@ -5,7 +5,6 @@
 
 use anyhow::Result;
 use clap::{Arg, Command};
-use regex::Regex;
 use serde::{Deserialize, Serialize};
 use std::collections::HashMap;
 use std::io::{BufRead, Write};
@@ -15,7 +14,7 @@ use std::time::{Duration, Instant};
 use tokio::io::{AsyncBufReadExt, AsyncWriteExt, BufReader};
 use tokio::net::TcpStream;
 use tokio::process::{Child, Command as TokioCommand};
-use tokio::sync::{broadcast, Mutex};
+use tokio::sync::Mutex;
 use tokio::time::sleep;
 
 // Add chrono for timestamps
@@ -24,285 +23,8 @@ use chrono;
 // Import log collection module
 mod log_collector;
 use log_collector::{collect_process_logs, collect_process_logs_to_file};
-/// Strip ANSI escape codes from text for clean log files while preserving emojis
-fn strip_ansi_colors(text: &str) -> String {
-    // Regex to match ANSI escape sequences for colors and formatting
-    // This matches comprehensive ANSI patterns including:
-    // - Color codes: \x1B[31m, \x1B[1;32m, \x1B[0m
-    // - Cursor movement: \x1B[2J, \x1B[H
-    // - Other formatting: \x1B[K, \x1B[?25h
-    static ANSI_REGEX: std::sync::OnceLock<Regex> = std::sync::OnceLock::new();
-    let regex = ANSI_REGEX.get_or_init(|| {
-        // More comprehensive ANSI escape sequence pattern
-        // \x1B\[ - ESC[
-        // [0-9;?]* - parameter bytes (numbers, semicolons, question marks)
-        // [a-zA-Z] - final byte (letter commands like m, K, H, J, etc.)
-        Regex::new(r"\x1B\[[0-9;?]*[a-zA-Z]").expect("Valid ANSI regex")
-    });
-
-    regex.replace_all(text, "").to_string()
-}
-
-#[cfg(feature = "tui")]
-#[derive(Debug, Clone)]
-struct SystemInfo {
-    cpu_usage: f64,
-    memory_used_mb: u64,
-    memory_total_mb: u64,
-    memory_usage_percent: f64,
-    uptime_seconds: u64,
-    process_count: usize,
-    total_ram_mb: u64, // Cached total RAM, initialized once
-}
-
-#[cfg(feature = "tui")]
-impl SystemInfo {
-    fn new() -> Self {
-        Self {
-            cpu_usage: 0.0,
-            memory_used_mb: 0,
-            memory_total_mb: 0,
-            memory_usage_percent: 0.0,
-            uptime_seconds: 0,
-            process_count: 0,
-            total_ram_mb: 0, // Will be initialized in new_with_total_ram
-        }
-    }
-
-    /// Create SystemInfo with pre-fetched total RAM
-    async fn new_with_total_ram() -> Result<Self, Box<dyn std::error::Error + Send + Sync>> {
-        let total_ram_mb = Self::get_total_ram().await.unwrap_or(0);
-        Ok(Self {
-            cpu_usage: 0.0,
-            memory_used_mb: 0,
-            memory_total_mb: total_ram_mb,
-            memory_usage_percent: 0.0,
-            uptime_seconds: 0,
-            process_count: 0,
-            total_ram_mb,
-        })
-    }
-
-    /// Collect current system information asynchronously (using cached total RAM)
-    async fn collect_with_cached_ram(
-        &self,
-    ) -> Result<Self, Box<dyn std::error::Error + Send + Sync>> {
-        let (cpu_usage, memory_used_mb, uptime, process_count) = tokio::try_join!(
-            Self::get_cpu_usage(),
-            Self::get_memory_usage(self.total_ram_mb),
-            Self::get_uptime(),
-            Self::get_process_count()
-        )?;
-
-        let memory_usage_percent = if self.total_ram_mb > 0 {
-            (memory_used_mb as f64 / self.total_ram_mb as f64) * 100.0
-        } else {
-            0.0
-        };
-
-        Ok(Self {
-            cpu_usage,
-            memory_used_mb,
-            memory_total_mb: self.total_ram_mb,
-            memory_usage_percent,
-            uptime_seconds: uptime,
-            process_count,
-            total_ram_mb: self.total_ram_mb,
-        })
-    }
-
-    /// Get CPU usage percentage (macOS specific)
-    async fn get_cpu_usage() -> Result<f64, Box<dyn std::error::Error + Send + Sync>> {
-        #[cfg(target_os = "macos")]
-        {
-            let output = tokio::process::Command::new("top")
-                .args(&["-l", "2", "-n", "0", "-s", "1"])
-                .output()
-                .await?;
-
-            let output_str = String::from_utf8(output.stdout)?;
-            // Parse the CPU usage from top output
-            // Look for line like "CPU usage: 12.34% user, 5.67% sys, 82.99% idle"
-            for line in output_str.lines() {
-                if line.contains("CPU usage:") {
-                    // Extract user and sys percentages
-                    let parts: Vec<&str> = line.split_whitespace().collect();
-                    let mut user_cpu = 0.0;
-                    let mut sys_cpu = 0.0;
-
-                    for (i, part) in parts.iter().enumerate() {
-                        if *part == "user," && i > 0 {
-                            if let Ok(val) = parts[i - 1].trim_end_matches('%').parse::<f64>() {
-                                user_cpu = val;
-                            }
-                        }
-                        if *part == "sys," && i > 0 {
-                            if let Ok(val) = parts[i - 1].trim_end_matches('%').parse::<f64>() {
-                                sys_cpu = val;
-                            }
-                        }
-                    }
-
-                    return Ok(user_cpu + sys_cpu);
-                }
-            }
-            Ok(0.0)
-        }
-        #[cfg(not(target_os = "macos"))]
-        {
-            // Fallback for other platforms - could be extended for Linux, Windows
-            Ok(0.0)
-        }
-    }
-
-    /// Get total physical RAM in MB (called once at startup)
-    async fn get_total_ram() -> Result<u64, Box<dyn std::error::Error + Send + Sync>> {
-        #[cfg(target_os = "macos")]
-        {
-            let output = tokio::process::Command::new("sysctl")
-                .args(&["-n", "hw.memsize"])
-                .output()
-                .await?;
-            let output_str = String::from_utf8(output.stdout)?;
-            let total_bytes = output_str.trim().parse::<u64>().unwrap_or(0);
-            Ok(total_bytes / (1024 * 1024)) // Convert bytes to MB
-        }
-        #[cfg(not(target_os = "macos"))]
-        {
-            Ok(0)
-        }
-    }
-
-    /// Get current memory usage in MB (called periodically)
-    async fn get_memory_usage(
-        _total_ram_mb: u64,
-    ) -> Result<u64, Box<dyn std::error::Error + Send + Sync>> {
-        #[cfg(target_os = "macos")]
-        {
-            let output = tokio::process::Command::new("vm_stat").output().await?;
-            let output_str = String::from_utf8(output.stdout)?;
-            let mut page_size = 4096u64; // Default page size on macOS
-            let mut active_pages = 0u64;
-            let mut wired_pages = 0u64;
-            let mut compressed_pages = 0u64;
-
-            // Get the actual page size
-            if let Some(first_line) = output_str.lines().next() {
-                if first_line.contains("page size of") {
-                    let parts: Vec<&str> = first_line.split_whitespace().collect();
-                    for (i, part) in parts.iter().enumerate() {
-                        if *part == "of" && i + 1 < parts.len() {
-                            if let Ok(size) = parts[i + 1].parse::<u64>() {
-                                page_size = size;
-                                break;
-                            }
-                        }
-                    }
-                }
-            }
-
-            // Parse only the memory stats we need for "used" calculation
-            for line in output_str.lines() {
-                let parts: Vec<&str> = line.split_whitespace().collect();
-                if parts.len() >= 2 {
-                    if let Ok(pages) = parts
-                        .last()
-                        .map_or("", |v| v)
-                        .trim_end_matches('.')
-                        .parse::<u64>()
-                    {
-                        if line.contains("Pages active:") {
-                            active_pages = pages;
-                        } else if line.contains("Pages wired down:") {
-                            wired_pages = pages;
-                        } else if line.contains("compressed:") {
-                            compressed_pages = pages;
-                        }
-                    }
-                }
-            }
-
-            // Calculate used memory = active + wired + compressed (actual memory in use)
-            let used_pages = active_pages + wired_pages + compressed_pages;
-            let used_mb = (used_pages * page_size) / (1024 * 1024);
-            Ok(used_mb)
-        }
-        #[cfg(not(target_os = "macos"))]
-        {
-            Ok(0)
-        }
-    }
-
-    /// Get system uptime in seconds (macOS specific)
-    async fn get_uptime() -> Result<u64, Box<dyn std::error::Error + Send + Sync>> {
-        #[cfg(target_os = "macos")]
-        {
-            let output = tokio::process::Command::new("sysctl")
-                .args(&["-n", "kern.boottime"])
-                .output()
-                .await?;
-
-            let output_str = String::from_utf8(output.stdout)?;
-            // Parse boot time from sysctl output format
-            // Format: { sec = 1234567890, usec = 123456 }
-            if let Some(sec_start) = output_str.find("sec = ") {
-                if let Some(sec_end) = output_str[sec_start + 6..].find(',') {
-                    let boot_time_str = &output_str[sec_start + 6..sec_start + 6 + sec_end];
-                    if let Ok(boot_time) = boot_time_str.parse::<u64>() {
-                        let current_time = std::time::SystemTime::now()
-                            .duration_since(std::time::UNIX_EPOCH)?
-                            .as_secs();
-                        return Ok(current_time - boot_time);
-                    }
-                }
-            }
-            Ok(0)
-        }
-        #[cfg(not(target_os = "macos"))]
-        {
-            // Fallback for other platforms
-            Ok(0)
-        }
-    }
-
-    /// Get current process count (macOS specific)
-    async fn get_process_count() -> Result<usize, Box<dyn std::error::Error + Send + Sync>> {
-        #[cfg(target_os = "macos")]
-        {
-            let output = tokio::process::Command::new("ps")
-                .args(&["-ax"])
-                .output()
-                .await?;
-
-            let output_str = String::from_utf8(output.stdout)?;
-            // Count lines (excluding header)
-            let count = output_str.lines().count().saturating_sub(1);
-            Ok(count)
-        }
-        #[cfg(not(target_os = "macos"))]
-        {
-            // Fallback for other platforms
-            Ok(0)
-        }
-    }
-
-    /// Format as display string for UI
-    fn format_for_display(&self) -> Vec<String> {
-        vec![
-            format!("CPU: {:.1}%", self.cpu_usage),
-            format!(
-                "Memory: {:.1}% ({}/{}MB)",
-                self.memory_usage_percent, self.memory_used_mb, self.memory_total_mb
-            ),
-            format!(
-                "Uptime: {}h {}m",
-                self.uptime_seconds / 3600,
-                (self.uptime_seconds % 3600) / 60
-            ),
-            format!("Processes: {}", self.process_count),
-        ]
-    }
-}
+mod log_pipeline;
+use log_pipeline::{flush_log_writers, log_writer, pipeline_stats, push_entry, LogRing, LogWriter};
 
 #[cfg(feature = "tui")]
 use crossterm::{
@@ -328,6 +50,11 @@ use std::sync::atomic::{AtomicBool, Ordering};
 mod scenario_types;
 use scenario_types::*;
 
+mod bench;
+mod mqtt_probe;
+mod system_monitor;
+use system_monitor::{SystemMonitor, SAMPLE_INTERVAL};
+
 #[derive(Debug, Clone)]
 pub enum LogSource {
     Orchestrator,
@@ -336,6 +63,18 @@ pub enum LogSource {
     Client(String),
 }
 
+impl LogSource {
+    /// Name of the TUI pane and `log_files` key for this source
+    pub fn pane_name(&self) -> &str {
+        match self {
+            LogSource::Orchestrator => "Orchestrator",
+            LogSource::MqttServer => "MQTT Server",
+            LogSource::MqttObserver => "MQTT Observer",
+            LogSource::Client(id) => id,
+        }
+    }
+}
+
 #[derive(Debug, Clone)]
 pub struct LogMessage {
     pub source: LogSource,
@@ -343,29 +82,78 @@ pub struct LogMessage {
     pub timestamp: std::time::Instant,
 }
 
+/// Messages queued for the TUI before the oldest are dropped
+const LOG_RING_CAPACITY: usize = 10_000;
+
+/// Sends log messages to their log file and to the TUI
+///
+/// Files get every message; the TUI drains a bounded ring, so a flood of output can only
+/// cost it lines on screen, never memory or log file completeness.
 #[derive(Clone)]
 pub struct LogCollector {
-    sender: broadcast::Sender<LogMessage>,
+    ring: Arc<LogRing<LogMessage>>,
+    files: Arc<HashMap<String, LogWriter>>,
 }
 
 impl LogCollector {
-    pub fn new() -> (Self, broadcast::Receiver<LogMessage>) {
-        let (sender, receiver) = broadcast::channel(1000);
-        (Self { sender }, receiver)
+    pub fn new(log_files: &HashMap<String, PathBuf>) -> Self {
+        let files = log_files
+            .iter()
+            .map(|(pane_name, path)| (pane_name.clone(), log_writer(path)))
+            .collect();
+        Self {
+            ring: Arc::new(LogRing::new(LOG_RING_CAPACITY)),
+            files: Arc::new(files),
+        }
     }
 
     pub fn log(&self, source: LogSource, message: String) {
-        let log_msg = LogMessage {
+        if let Some(writer) = self.files.get(source.pane_name()) {
+            let mut entry = String::with_capacity(message.len() + 16);
+            push_entry(&mut entry, &log_timestamp(), "", &message);
+            writer.write(entry);
+        }
+        self.ring.push(LogMessage {
             source,
             message,
             timestamp: std::time::Instant::now(),
-        };
-        let _ = self.sender.send(log_msg);
+        });
     }
 
     pub fn log_str(&self, source: LogSource, message: &str) {
         self.log(source, message.to_string());
     }
+
+    /// Log a batch of process output lines with one file write
+    pub fn log_lines(&self, source: LogSource, prefix: &str, lines: &[&str]) {
+        if let Some(writer) = self.files.get(source.pane_name()) {
+            let time = log_timestamp();
+            let mut entry = String::with_capacity(lines.iter().map(|l| l.len() + 32).sum());
+            for line in lines {
+                push_entry(&mut entry, &time, prefix, line);
+            }
+            writer.write(entry);
+        }
+        for line in lines {
+            let line = line.trim();
+            if !line.is_empty() {
+                self.ring.push(LogMessage {
+                    source: source.clone(),
+                    message: format!("{}{}", prefix, line),
+                    timestamp: std::time::Instant::now(),
+                });
+            }
+        }
+    }
+
+    /// Messages logged since the last call, plus how many were dropped in between
+    pub fn drain(&self) -> (Vec<LogMessage>, u64) {
+        self.ring.drain()
+    }
+}
+
+fn log_timestamp() -> String {
+    chrono::Utc::now().format("%H:%M:%S%.3f").to_string()
 }
 
 #[cfg(feature = "tui")]
@@ -658,6 +446,10 @@ struct HealthProbe {
     is_healthy: bool,
 }
 
+/// Lines kept per TUI pane; the log files keep everything
+#[cfg(feature = "tui")]
+const MAX_PANE_LINES: usize = 1000;
+
 #[cfg(feature = "tui")]
 struct LoggingApp {
     logs: HashMap<String, Vec<String>>, // key: pane_name, value: log lines
@@ -673,7 +465,7 @@ struct LoggingApp {
     mcp_app: Option<McpInteractiveApp>,  // MCP message interface
     scenario: Scenario,                  // Store scenario for client connections
     scenario_file_path: Option<PathBuf>, // Store the scenario file path
-    system_info: SystemInfo,             // Current system information
+    system_info: system_monitor::SystemSnapshot, // Current system information
     last_system_update: std::time::Instant, // When system info was last updated
     service_statuses: HashMap<String, ServiceStatus>, // Track service status
     health_probes: HashMap<String, HealthProbe>, // Active health probes
@@ -885,13 +677,11 @@ impl LoggingApp {
             scroll_positions,
             auto_scroll: true,
             log_files,
-            ui_mode: UiMode::LogViewing, // Start in log viewing mode
-            mcp_app: None,               // No MCP app initially
-            scenario: scenario.clone(),  // Store scenario for client connections
-            scenario_file_path,          // Store the scenario file path
-            system_info: SystemInfo::new_with_total_ram()
-                .await
-                .unwrap_or_else(|_| SystemInfo::new()), // Initialize with total RAM
+            ui_mode: UiMode::LogViewing,     // Start in log viewing mode
+            mcp_app: None,                   // No MCP app initially
+            scenario: scenario.clone(),      // Store scenario for client connections
+            scenario_file_path,              // Store the scenario file path
+            system_info: Default::default(), // Filled in by the system monitor
             last_system_update: std::time::Instant::now(), // Track when system info was last updated
             service_statuses,
             health_probes,
@@ -906,46 +696,23 @@ impl LoggingApp {
         }
     }
 
+    /// Show a message in its pane; log files are written by `LogCollector`
     fn add_log(&mut self, source: &LogSource, message: String) {
-        let pane_name = match source {
-            LogSource::Orchestrator => "Orchestrator".to_string(),
-            LogSource::MqttServer => "MQTT Server".to_string(),
-            LogSource::MqttObserver => "MQTT Observer".to_string(),
-            LogSource::Client(id) => id.clone(),
-        };
+        let pane_name = source.pane_name().to_string();
 
         // Parse and update service status based on message content
         self.parse_and_update_status(&pane_name, &message);
 
-        // Write to log file (strip ANSI colors but preserve emojis)
-        if let Some(log_file_path) = self.log_files.get(&pane_name) {
-            let timestamp = chrono::Utc::now().format("%H:%M:%S%.3f");
-            let clean_message = strip_ansi_colors(&message);
-            let log_entry = format!("[{}] {}\n", timestamp, clean_message);
-            let _ = std::fs::OpenOptions::new()
-                .create(true)
-                .append(true)
-                .open(log_file_path)
-                .and_then(|mut file| {
-                    use std::io::Write;
-                    file.write_all(log_entry.as_bytes())
-                });
-        }
-
         if let Some(log_lines) = self.logs.get_mut(&pane_name) {
-            // Split message into lines and add each one
-            for line in message.lines() {
-                log_lines.push(line.to_string());
-
-                // Keep only last 1000 lines per pane to prevent memory issues
-                if log_lines.len() > 1000 {
-                    log_lines.remove(0);
-                    // Adjust scroll position if we're removing lines
-                    if let Some(scroll) = self.scroll_positions.get_mut(&pane_name) {
-                        if *scroll > 0 {
-                            *scroll = scroll.saturating_sub(1);
-                        }
-                    }
+            log_lines.extend(message.lines().map(str::to_string));
+
+            // Keep only the last MAX_PANE_LINES per pane, trimming in chunks rather than
+            // shifting the whole pane for every new line
+            if log_lines.len() > MAX_PANE_LINES + MAX_PANE_LINES / 4 {
+                let excess = log_lines.len() - MAX_PANE_LINES;
+                log_lines.drain(..excess);
+                if let Some(scroll) = self.scroll_positions.get_mut(&pane_name) {
+                    *scroll = scroll.saturating_sub(excess);
                 }
             }
 
@@ -957,6 +724,23 @@ impl LoggingApp {
         }
     }
 
+    /// Show everything logged since the last frame
+    fn drain_logs(&mut self, log_collector: &LogCollector) {
+        let (messages, dropped) = log_collector.drain();
+        if dropped > 0 {
+            self.add_log(
+                &LogSource::Orchestrator,
+                format!(
+                    "⚠️ {} log lines skipped in the display (log files are complete)",
+                    dropped
+                ),
+            );
+        }
+        for log_msg in messages {
+            self.add_log(&log_msg.source, log_msg.message);
+        }
+    }
+
     fn get_current_pane_name(&self) -> String {
         match &self.selected_pane {
             LogPane::Orchestrator => "Orchestrator".to_string(),
@@ -1204,10 +988,15 @@ struct OrchestratorState {
     start_time: Instant,
     log_files: HashMap<String, PathBuf>, // Track log files in non-TUI mode too
     variable_context: HashMap<String, serde_json::Value>, // Store variables extracted from responses
+    monitor: SystemMonitor,                               // CPU/RSS of every spawned process
 }
 
 impl OrchestratorState {
-    fn new(scenario: Scenario, scenario_file_path: Option<PathBuf>) -> Self {
+    fn new(
+        scenario: Scenario,
+        scenario_file_path: Option<PathBuf>,
+        monitor: SystemMonitor,
+    ) -> Self {
         // Create log files directory
         let log_dir = PathBuf::from("logs");
         let _ = std::fs::create_dir_all(&log_dir);
@@ -1259,30 +1048,16 @@ impl OrchestratorState {
             start_time: Instant::now(),
             log_files,
             variable_context: HashMap::new(),
+            monitor,
         }
     }
 
     /// Write a log message to the appropriate log file in non-TUI mode
     fn write_to_log_file(&self, source: &LogSource, message: &str) {
-        let pane_name = match source {
-            LogSource::Orchestrator => "Orchestrator".to_string(),
-            LogSource::MqttServer => "MQTT Server".to_string(),
-            LogSource::MqttObserver => "MQTT Observer".to_string(),
-            LogSource::Client(id) => id.clone(),
-        };
-
-        if let Some(log_file_path) = self.log_files.get(&pane_name) {
-            let timestamp = chrono::Utc::now().format("%H:%M:%S%.3f");
-            let clean_message = strip_ansi_colors(message);
-            let log_entry = format!("[{}] {}\n", timestamp, clean_message);
-            let _ = std::fs::OpenOptions::new()
-                .create(true)
-                .append(true)
-                .open(log_file_path)
-                .and_then(|mut file| {
-                    use std::io::Write;
-                    file.write_all(log_entry.as_bytes())
-                });
+        if let Some(log_file_path) = self.log_files.get(source.pane_name()) {
+            let mut entry = String::with_capacity(message.len() + 16);
+            push_entry(&mut entry, &log_timestamp(), "", message);
+            log_writer(log_file_path).write(entry);
         }
     }
 }
@@ -2035,6 +1810,50 @@ async fn main() -> Result<(), Box<dyn std::error::Error>> {
                 .value_name("DIR")
                 .default_value("logs"),
         )
+        .arg(
+            Arg::new("bench")
+                .long("bench")
+                .help("Benchmark scenarios: run them concurrently on isolated ports and report step latencies")
+                .value_name("FILE")
+                .num_args(1..)
+                .action(clap::ArgAction::Append),
+        )
+        .arg(
+            Arg::new("repeat")
+                .long("repeat")
+                .help("Runs of each measured step in bench mode")
+                .value_name("N")
+                .value_parser(clap::value_parser!(usize))
+                .default_value("10"),
+        )
+        .arg(
+            Arg::new("bench-port-base")
+                .long("bench-port-base")
+                .help("First port of the blocks assigned to bench scenario instances")
+                .value_name("PORT")
+                .value_parser(clap::value_parser!(u16))
+                .default_value("21000"),
+        )
+        .arg(
+            Arg::new("baseline")
+                .long("baseline")
+                .help("Bench results JSON to compare against; regressions fail the run")
+                .value_name("FILE"),
+        )
+        .arg(
+            Arg::new("bench-output")
+                .long("bench-output")
+                .help("File to write the bench results JSON to")
+                .value_name("FILE"),
+        )
+        .arg(
+            Arg::new("max-regression")
+                .long("max-regression")
+                .help("Allowed p95 increase over the baseline, in percent")
+                .value_name("PERCENT")
+                .value_parser(clap::value_parser!(f64))
+                .default_value("20"),
+        )
         .arg(
             Arg::new("mcp-server")
                 .long("mcp-server")
@@ -2066,6 +1885,18 @@ async fn main() -> Result<(), Box<dyn std::error::Error>> {
         return Ok(());
     }
 
+    if let Some(files) = matches.get_many::<String>("bench") {
+        let options = BenchOptions {
+            repeat: *matches.get_one::<usize>("repeat").unwrap(),
+            port_base: *matches.get_one::<u16>("bench-port-base").unwrap(),
+            baseline: matches.get_one::<String>("baseline").map(PathBuf::from),
+            output: matches.get_one::<String>("bench-output").map(PathBuf::from),
+            max_regression_pct: *matches.get_one::<f64>("max-regression").unwrap(),
+            verbose: matches.get_flag("verbose"),
+        };
+        return run_bench(files.map(PathBuf::from).collect(), options).await;
+    }
+
     // If no scenario file is provided, show TUI
     let scenario_file = match matches.get_one::<String>("scenario") {
         Some(file) => file,
@@ -2088,21 +1919,7 @@ async fn main() -> Result<(), Box<dyn std::error::Error>> {
     };
 
     let scenario_path = PathBuf::from(scenario_file);
-
-    // Load and parse scenario
-    let scenario_content = tokio::fs::read_to_string(&scenario_path)
-        .await
-        .map_err(|e| format!("Failed to read scenario file: {}", e))?;
-
-    // Try to parse as RON first, then JSON
-    let mut scenario: Scenario =
-        if scenario_path.extension().and_then(|s| s.to_str()) == Some("ron") {
-            ron::from_str(&scenario_content)
-                .map_err(|e| format!("Failed to parse RON scenario file: {}", e))?
-        } else {
-            serde_json::from_str(&scenario_content)
-                .map_err(|e| format!("Failed to parse JSON scenario file: {}", e))?
-        };
+    let mut scenario = load_scenario_file(&scenario_path).await?;
 
     // Override MQTT port if specified
     if let Some(mqtt_port) = matches.get_one::<u16>("mqtt-port") {
@@ -2123,6 +1940,22 @@ async fn main() -> Result<(), Box<dyn std::error::Error>> {
     Ok(())
 }
 
+/// Load a scenario file, as RON if it has a `.ron` extension and as JSON otherwise
+async fn load_scenario_file(path: &PathBuf) -> Result<Scenario, Box<dyn std::error::Error>> {
+    let scenario_content = tokio::fs::read_to_string(path)
+        .await
+        .map_err(|e| format!("Failed to read scenario file: {}", e))?;
+
+    let scenario = if path.extension().and_then(|s| s.to_str()) == Some("ron") {
+        ron::from_str(&scenario_content)
+            .map_err(|e| format!("Failed to parse RON scenario file: {}", e))?
+    } else {
+        serde_json::from_str(&scenario_content)
+            .map_err(|e| format!("Failed to parse JSON scenario file: {}", e))?
+    };
+    Ok(scenario)
+}
+
 async fn list_scenarios() -> Result<(), Box<dyn std::error::Error>> {
     let scenarios_dir = PathBuf::from("scenarios");
     if !scenarios_dir.exists() {
@@ -2343,6 +2176,7 @@ async fn run_scenario(
     let state = Arc::new(Mutex::new(OrchestratorState::new(
         scenario,
         scenario_file_path,
+        SystemMonitor::spawn(SAMPLE_INTERVAL),
     )));
 
     // Setup signal handler for graceful shutdown with force-exit on second Ctrl+C
@@ -2654,6 +2488,7 @@ async fn start_infrastructure(
                 }
             }
 
+            state.monitor.track("mqtt_server", mqtt_process.id());
             state
                 .infrastructure_processes
                 .insert("mqtt_server".to_string(), mqtt_process);
@@ -2773,6 +2608,7 @@ async fn start_infrastructure(
                 }
             }
 
+            state.monitor.track("mqtt_observer", observer_process.id());
             state
                 .infrastructure_processes
                 .insert("mqtt_observer".to_string(), observer_process);
@@ -2906,6 +2742,7 @@ async fn start_clients(
             }
         }
 
+        state.monitor.track(&client.id, client_process.id());
         state
             .client_processes
             .insert(client.id.clone(), client_process);
@@ -3546,6 +3383,256 @@ async fn execute_mcp_call(
         .unwrap_or(serde_json::json!({"status": "success"})))
 }
 
+/// Settings for `--bench`
+struct BenchOptions {
+    repeat: usize,
+    port_base: u16,
+    baseline: Option<PathBuf>,
+    output: Option<PathBuf>,
+    max_regression_pct: f64,
+    verbose: bool,
+}
+
+/// Run scenarios concurrently on isolated ports and report per-step latency statistics
+async fn run_bench(
+    scenario_paths: Vec<PathBuf>,
+    options: BenchOptions,
+) -> Result<(), Box<dyn std::error::Error>> {
+    let baseline: Option<bench::BenchReport> = match &options.baseline {
+        Some(path) => {
+            let content = tokio::fs::read_to_string(path)
+                .await
+                .map_err(|e| format!("Failed to read baseline {}: {}", path.display(), e))?;
+            Some(serde_json::from_str(&content)?)
+        }
+        None => None,
+    };
+
+    let mut states = Vec::new();
+    for (index, path) in scenario_paths.iter().enumerate() {
+        let mut scenario = load_scenario_file(path).await?;
+        validate_scenario(&scenario)?;
+        bench::isolate_ports(&mut scenario, options.port_base, index)?;
+        // The bench probe observes the broker itself
+        scenario.infrastructure.mqtt_observer = None;
+
+        let mut state = OrchestratorState::new(
+            scenario,
+            Some(path.clone()),
+            SystemMonitor::spawn(SAMPLE_INTERVAL),
+        );
+        for log_file in state.log_files.values_mut() {
+            if let Some(name) = log_file.file_name() {
+                let name = format!("bench{}_{}", index, name.to_string_lossy());
+                log_file.set_file_name(name);
+            }
+        }
+        states.push(Arc::new(Mutex::new(state)));
+    }
+
+    println!(
+        "⏱️  Benchmarking {} scenario instance(s) concurrently, {} run(s) per measured step",
+        states.len(),
+        options.repeat
+    );
+
+    // Instances share nothing but the runtime; a LocalSet lets them run side by side
+    // without requiring the orchestration futures to be Send
+    let local = tokio::task::LocalSet::new();
+    let runs = local.run_until(async {
+        let handles: Vec<_> = states
+            .iter()
+            .enumerate()
+            .map(|(index, state)| {
+                tokio::task::spawn_local(bench_instance(
+                    Arc::clone(state),
+                    index,
+                    options.repeat,
+                    options.verbose,
+                ))
+            })
+            .collect();
+        let mut runs = Vec::new();
+        for handle in handles {
+            runs.push(handle.await);
+        }
+        runs
+    });
+    let runs = tokio::select! {
+        runs = runs => Some(runs),
+        _ = tokio::signal::ctrl_c() => {
+            println!("\n🛑 Benchmark interrupted, cleaning up...");
+            None
+        }
+    };
+    // Dropping the LocalSet drops unfinished instances and releases their state locks
+    drop(local);
+
+    for state in &states {
+        let mut state = state.lock().await;
+        cleanup(&mut state, options.verbose).await?;
+    }
+
+    let Some(runs) = runs else {
+        return Err("Benchmark interrupted".into());
+    };
+    let mut scenarios = Vec::new();
+    for run in runs {
+        scenarios.push(run.map_err(|e| format!("Benchmark instance panicked: {}", e))?);
+    }
+    let report = bench::BenchReport {
+        timestamp: chrono::Utc::now().to_rfc3339(),
+        repeat: options.repeat,
+        scenarios,
+    };
+
+    println!("\n📊 Scenario Benchmark");
+    println!("====================");
+    print!("{}", bench::render_summary(&report, baseline.as_ref()));
+
+    if let Some(output_path) = &options.output {
+        std::fs::write(output_path, serde_json::to_string_pretty(&report)?)?;
+        println!("\n📄 Results written to: {}", output_path.display());
+    }
+
+    let failed: Vec<_> = report
+        .scenarios
+        .iter()
+        .filter(|s| s.error.is_some())
+        .map(|s| s.scenario.as_str())
+        .collect();
+    if !failed.is_empty() {
+        return Err(format!("Benchmark scenario(s) failed: {}", failed.join(", ")).into());
+    }
+
+    if let Some(baseline) = &baseline {
+        let regressions = bench::compare(&report, baseline, options.max_regression_pct);
+        for regression in &regressions {
+            println!(
+                "📉 {} / {}: {}",
+                regression.scenario, regression.step, regression.kind
+            );
+        }
+        if !regressions.is_empty() {
+            return Err(format!(
+                "{} step(s) failed or regressed more than {}% against the baseline",
+                regressions.len(),
+                options.max_regression_pct
+            )
+            .into());
+        }
+        println!("\n✅ No regressions against the baseline");
+    }
+
+    Ok(())
+}
+
+/// Run one scenario instance and summarise its measured steps
+async fn bench_instance(
+    state: Arc<Mutex<OrchestratorState>>,
+    index: usize,
+    repeat: usize,
+    verbose: bool,
+) -> bench::ScenarioBench {
+    let mut state = state.lock().await;
+    let mut samples = bench::ScenarioSamples::default();
+    let error = bench_steps(&mut state, index, repeat, &mut samples, verbose)
+        .await
+        .err()
+        .map(|e| e.to_string());
+    if let Some(error) = &error {
+        println!("❌ [{} #{}] {}", state.scenario.name, index, error);
+    }
+    let mut bench = samples.finish(&state.scenario, index, error);
+    bench.resources = state.monitor.latest().processes;
+    bench
+}
+
+/// Start the instance, run every step once, then repeat the measured steps
+async fn bench_steps(
+    state: &mut OrchestratorState,
+    index: usize,
+    repeat: usize,
+    samples: &mut bench::ScenarioSamples,
+    verbose: bool,
+) -> Result<(), Box<dyn std::error::Error>> {
+    start_infrastructure(state, verbose).await?;
+    start_clients(state, verbose).await?;
+
+    let probe = if state.scenario.infrastructure.mqtt_server.required {
+        let port = state.scenario.infrastructure.mqtt_server.port;
+        let client_id = format!("mcplay_bench_{}", index);
+        let probe = mqtt_probe::MqttProbe::connect("localhost", port, &client_id)
+            .await
+            .map_err(|e| format!("MQTT probe failed to connect to port {}: {}", port, e))?;
+        Some(probe)
+    } else {
+        None
+    };
+
+    let steps = state.scenario.steps.clone();
+    let effects = steps
+        .iter()
+        .map(bench::expected_effect)
+        .collect::<Result<Vec<_>, _>>()?;
+
+    for round in 0..repeat.max(1) {
+        for (step, effect) in steps.iter().zip(&effects) {
+            // Setup steps run once, measured steps every round
+            if round > 0 && effect.is_none() {
+                continue;
+            }
+            if step.wait_before > 0 {
+                sleep(Duration::from_millis(step.wait_before)).await;
+            }
+
+            // Subscribe before the call so an effect that beats the response is not missed
+            let mut messages = probe.as_ref().map(|probe| probe.subscribe());
+            let start = Instant::now();
+            let response = execute_step(step, state, verbose)
+                .await
+                .map_err(|e| format!("Step '{}' failed: {}", step.name, e))?;
+            let mcp_ms = start.elapsed().as_secs_f64() * 1000.0;
+
+            if let (Some(vars), Some(result_obj)) =
+                (&step.response_variables, response.get("result"))
+            {
+                for (name, path) in vars {
+                    if let Some(value) = extract_json_path(result_obj, path) {
+                        state.variable_context.insert(name.clone(), value.clone());
+                    }
+                }
+            }
+
+            if let Some(effect) = effect {
+                match messages.as_mut() {
+                    Some(messages) => {
+                        let deadline = start + Duration::from_millis(effect.within_ms);
+                        let seen = mqtt_probe::wait_for(messages, deadline, |message| {
+                            effect.matches(&message.topic, &message.payload)
+                        })
+                        .await;
+                        match seen {
+                            Some(at) => {
+                                let effect_ms = at.saturating_duration_since(start).as_secs_f64();
+                                samples.record(&step.name, mcp_ms, Some(effect_ms * 1000.0));
+                            }
+                            None => samples.record_missed(&step.name, mcp_ms),
+                        }
+                    }
+                    None => samples.record(&step.name, mcp_ms, None),
+                }
+            }
+
+            if step.wait_after > 0 {
+                sleep(Duration::from_millis(step.wait_after)).await;
+            }
+        }
+    }
+
+    Ok(())
+}
+
 /// Check if a command should be queued (needs longer timeout)
 fn is_queued_command(tool: &str) -> bool {
     matches!(
@@ -3553,6 +3640,10 @@ fn is_queued_command(tool: &str) -> bool {
         "create_world"
             | "place_block"
             | "create_wall"
+            | "place_blocks"
+            | "fill_region"
+            | "copy_region"
+            | "paste_region"
             | "get_client_info"
             | "get_world_status"
             | "get_mqtt_status"
@@ -3860,31 +3951,44 @@ async fn cleanup(
         }
     }
 
+    // Write out whatever the log pipeline still has queued
+    flush_log_writers();
+
     Ok(())
 }
 
 /// Ensure log files are synced to disk for accurate size reporting
 fn sync_log_files_to_disk(state: &OrchestratorState) {
-    use std::fs::OpenOptions;
-    use std::io::Write;
-
-    // Explicitly flush each log file to ensure accurate size reporting
+    // Wait for the log writers to drain their queues, then force the OS to write
+    flush_log_writers();
     for (_pane_name, log_file_path) in &state.log_files {
-        if log_file_path.exists() {
-            // Open the file in append mode and flush it
-            if let Ok(mut file) = OpenOptions::new()
-                .create(false)
-                .append(true)
-                .open(log_file_path)
-            {
-                let _ = file.flush();
-                let _ = file.sync_all(); // Force OS to write to disk
-            }
+        if let Ok(file) = std::fs::File::open(log_file_path) {
+            let _ = file.sync_all();
         }
     }
+}
 
-    // Small additional delay to ensure filesystem consistency
-    std::thread::sleep(std::time::Duration::from_millis(100));
+/// Print how much the log pipeline wrote and how fast
+fn show_log_pipeline_stats() {
+    let stats = pipeline_stats();
+    if stats.lines > 0 {
+        println!(
+            "📈 Log pipeline: {} lines, {} KB, {:.0} lines/s",
+            stats.lines,
+            stats.bytes / 1024,
+            stats.lines_per_sec()
+        );
+    }
+}
+
+/// Print what each spawned process cost over the run
+fn show_resource_usage(processes: &[system_monitor::ProcessUsage]) {
+    if processes.is_empty() {
+        return;
+    }
+    println!("\n🧮 Resource Usage");
+    println!("=================");
+    print!("{}", system_monitor::render_usage(processes));
 }
 
 /// Show log file summary for non-TUI mode
@@ -3894,6 +3998,7 @@ fn show_log_summary_non_tui(state: &OrchestratorState) {
 
     println!("\n📁 Log Files Summary");
     println!("====================");
+    show_log_pipeline_stats();
 
     // Show scenario file information
     if let Some(file_path) = &state.scenario_file_path {
@@ -3925,6 +4030,8 @@ fn show_log_summary_non_tui(state: &OrchestratorState) {
             );
         }
     }
+
+    show_resource_usage(&state.monitor.latest().processes);
 }
 
 // TUI Implementation
@@ -4652,100 +4759,59 @@ async fn run_scenario_with_tui(
 
     // Create logging app
     let mut logging_app = LoggingApp::new(&scenario, scenario_file_path.clone()).await;
-    let (log_collector, _) = LogCollector::new();
+    let log_collector = LogCollector::new(&logging_app.log_files);
 
     // Add initial log message
-    logging_app.add_log(
-        &LogSource::Orchestrator,
+    log_collector.log(
+        LogSource::Orchestrator,
         format!("🚀 Starting scenario: {}", scenario.name),
     );
-    logging_app.add_log(
-        &LogSource::Orchestrator,
+    log_collector.log(
+        LogSource::Orchestrator,
         format!("📖 Description: {}", scenario.description),
     );
-    logging_app.add_log(
-        &LogSource::Orchestrator,
+    log_collector.log(
+        LogSource::Orchestrator,
         format!("👥 Clients: {}", scenario.clients.len()),
     );
-    logging_app.add_log(
-        &LogSource::Orchestrator,
+    log_collector.log(
+        LogSource::Orchestrator,
         format!("📋 Steps: {}", scenario.steps.len()),
     );
-    logging_app.add_log(&LogSource::Orchestrator, "".to_string());
+    log_collector.log(LogSource::Orchestrator, "".to_string());
 
     // Clone the quit flag for the background task
     let quit_flag = Arc::clone(&logging_app.should_quit);
 
+    // System and per-process usage, sampled in the background for the TUI and the summary
+    let monitor = SystemMonitor::spawn(SAMPLE_INTERVAL);
+    let mut system_snapshots = monitor.subscribe();
+
     // Spawn the scenario execution task
     let scenario_task = tokio::spawn({
         let log_collector = log_collector.clone();
         let quit_flag = Arc::clone(&quit_flag);
+        let monitor = monitor.clone();
         async move {
             let result = run_scenario_with_logging(
                 scenario,
                 scenario_file_path.clone(),
                 log_collector,
                 quit_flag,
+                monitor,
             )
             .await;
             result
         }
     });
 
-    // Spawn log receiver task
-    let log_task = tokio::spawn({
-        let quit_flag = Arc::clone(&logging_app.should_quit);
-        let mut log_receiver = log_collector.sender.subscribe(); // Create a new receiver
-        async move {
-            let mut logs = Vec::new();
-            while !quit_flag.load(Ordering::Relaxed) {
-                match tokio::time::timeout(Duration::from_millis(100), log_receiver.recv()).await {
-                    Ok(Ok(log_msg)) => {
-                        logs.push(log_msg);
-                    }
-                    Ok(Err(_)) => break, // Channel closed
-                    Err(_) => {}         // Timeout, continue
-                }
-            }
-            logs
-        }
-    });
-
-    // Create channel for system info updates
-    let (system_info_sender, mut system_info_receiver) =
-        tokio::sync::mpsc::unbounded_channel::<SystemInfo>();
-
-    // Spawn system info collection task (runs every 3 seconds in background)
-    let _system_info_task = tokio::spawn({
-        let quit_flag = Arc::clone(&logging_app.should_quit);
-        let current_system_info = logging_app.system_info.clone(); // Get the initial system info with cached RAM
-        async move {
-            let mut interval = tokio::time::interval(Duration::from_secs(3));
-            let mut system_info = current_system_info;
-            while !quit_flag.load(Ordering::Relaxed) {
-                interval.tick().await;
-                if let Ok(updated_info) = system_info.collect_with_cached_ram().await {
-                    system_info = updated_info.clone();
-                    if system_info_sender.send(updated_info).is_err() {
-                        break; // Receiver dropped
-                    }
-                }
-            }
-        }
-    });
-
-    // Create a dedicated log receiver for the main loop
-    let mut main_log_receiver = log_collector.sender.subscribe();
-
     // Main TUI loop
     let mut last_draw = std::time::Instant::now();
     loop {
         // Check if scenario is done
         if scenario_task.is_finished() {
             // Process any remaining logs
-            while let Ok(log_msg) = main_log_receiver.try_recv() {
-                logging_app.add_log(&log_msg.source, log_msg.message);
-            }
+            logging_app.drain_logs(&log_collector);
 
             // Final render
             terminal.draw(|f| draw_logging_ui(f, &logging_app))?;
@@ -4756,13 +4822,11 @@ async fn run_scenario_with_tui(
         }
 
         // Process new log messages
-        while let Ok(log_msg) = main_log_receiver.try_recv() {
-            logging_app.add_log(&log_msg.source, log_msg.message);
-        }
+        logging_app.drain_logs(&log_collector);
 
-        // Update system information from background task (non-blocking)
-        while let Ok(new_system_info) = system_info_receiver.try_recv() {
-            logging_app.system_info = new_system_info;
+        // Update system information from the monitor (non-blocking)
+        if system_snapshots.has_changed().unwrap_or(false) {
+            logging_app.system_info = system_snapshots.borrow_and_update().clone();
             logging_app.last_system_update = std::time::Instant::now();
         }
 
@@ -4778,8 +4842,8 @@ async fn run_scenario_with_tui(
         // If any clients failed health checks, terminate the scenario (unless it's an indefinite scenario)
         if !failed_clients.is_empty() && !is_indefinite_scenario {
             for client_id in &failed_clients {
-                logging_app.add_log(
-                    &LogSource::Orchestrator,
+                log_collector.log(
+                    LogSource::Orchestrator,
                     format!(
                         "❌ Client {} failed liveness probe - terminating scenario",
                         client_id
@@ -4791,8 +4855,8 @@ async fn run_scenario_with_tui(
         } else if !failed_clients.is_empty() {
             // For indefinite scenarios, log the health issues but don't terminate
             for client_id in &failed_clients {
-                logging_app.add_log(
-                    &LogSource::Orchestrator,
+                log_collector.log(
+                    LogSource::Orchestrator,
                     format!(
                         "⚠️ Client {} failed liveness probe (indefinite scenario - continuing)",
                         client_id
@@ -4804,8 +4868,8 @@ async fn run_scenario_with_tui(
         // Check if scenario is completed and auto-exit is enabled
         if scenario_task.is_finished() && !logging_app.scenario_completed {
             logging_app.scenario_completed = true;
-            logging_app.add_log(
-                &LogSource::Orchestrator,
+            log_collector.log(
+                LogSource::Orchestrator,
                 "🎉 Scenario completed successfully!".to_string(),
             );
 
@@ -5122,8 +5186,8 @@ async fn run_scenario_with_tui(
                                                                 Some(response.clone());
                                                         }
                                                         // Also log to client pane for record keeping
-                                                        logging_app.add_log(
-                                                            &LogSource::Client(client_id.clone()),
+                                                        log_collector.log(
+                                                            LogSource::Client(client_id.clone()),
                                                             format!(
                                                                 "✅ MCP {}: {}",
                                                                 message.name, response
@@ -5142,8 +5206,8 @@ async fn run_scenario_with_tui(
                                                                 Some(e.to_string());
                                                         }
                                                         // Also log to client pane for record keeping
-                                                        logging_app.add_log(
-                                                            &LogSource::Client(client_id.clone()),
+                                                        log_collector.log(
+                                                            LogSource::Client(client_id.clone()),
                                                             format!(
                                                                 "❌ MCP {}: {}",
                                                                 message.name, e
@@ -5188,7 +5252,8 @@ async fn run_scenario_with_tui(
     execute!(terminal.backend_mut(), LeaveAlternateScreen)?;
     terminal.show_cursor()?;
 
-    // Show log files summary
+    // Show log files summary, with resource totals including processes that have exited
+    logging_app.system_info = monitor.latest();
     show_log_summary(&logging_app);
 
     // Simple completion message
@@ -5199,16 +5264,7 @@ async fn run_scenario_with_tui(
     }
 
     // Get scenario result
-    let _result = match scenario_task.await? {
-        Ok(_) => {
-            let _logs = log_task.await?;
-            Ok(())
-        }
-        Err(e) => {
-            let _logs = log_task.await?;
-            Err(e)
-        }
-    };
+    let _result = scenario_task.await?;
 
     // Clean exit - no forced exit
     Ok(())
@@ -6096,11 +6152,13 @@ async fn run_scenario_with_logging(
     scenario_file_path: Option<PathBuf>,
     log_collector: LogCollector,
     quit_flag: Arc<AtomicBool>,
+    monitor: SystemMonitor,
 ) -> Result<(), Box<dyn std::error::Error + Send + Sync>> {
     // Create shared state wrapped in Arc<Mutex> for signal handling
     let state = Arc::new(Mutex::new(OrchestratorState::new(
         scenario,
         scenario_file_path,
+        monitor,
     )));
 
     // Execute scenario with proper cleanup handling
@@ -6254,28 +6312,24 @@ async fn start_infrastructure_with_logging(
             if let Some(stdout) = mqtt_process.stdout.take() {
                 let log_collector = log_collector.clone();
                 tokio::spawn(async move {
-                    let mut reader = BufReader::new(stdout);
-                    let mut line = String::new();
-                    while reader.read_line(&mut line).await.is_ok() && !line.is_empty() {
-                        log_collector.log_str(LogSource::MqttServer, line.trim());
-                        line.clear();
-                    }
+                    log_pipeline::read_line_batches(stdout, |lines| {
+                        log_collector.log_lines(LogSource::MqttServer, "", lines)
+                    })
+                    .await;
                 });
             }
 
             if let Some(stderr) = mqtt_process.stderr.take() {
                 let log_collector = log_collector.clone();
                 tokio::spawn(async move {
-                    let mut reader = BufReader::new(stderr);
-                    let mut line = String::new();
-                    while reader.read_line(&mut line).await.is_ok() && !line.is_empty() {
-                        log_collector
-                            .log_str(LogSource::MqttServer, &format!("[stderr] {}", line.trim()));
-                        line.clear();
-                    }
+                    log_pipeline::read_line_batches(stderr, |lines| {
+                        log_collector.log_lines(LogSource::MqttServer, "[stderr] ", lines)
+                    })
+                    .await;
                 });
             }
 
+            state.monitor.track("mqtt_server", mqtt_process.id());
             state
                 .infrastructure_processes
                 .insert("mqtt_server".to_string(), mqtt_process);
@@ -6379,19 +6433,17 @@ async fn start_infrastructure_with_logging(
             if let Some(stdout) = observer_process.stdout.take() {
                 let log_collector = log_collector.clone();
                 tokio::spawn(async move {
-                    let mut reader = BufReader::new(stdout);
-                    let mut line = String::new();
                     let mut connection_established = false;
 
-                    while reader.read_line(&mut line).await.is_ok() && !line.is_empty() {
-                        let trimmed_line = line.trim();
-
+                    log_pipeline::read_line_batches(stdout, |lines| {
                         // Check for connection status in observer output
                         if !connection_established
-                            && (trimmed_line.contains("Connected to")
-                                || trimmed_line.contains("Connection successful")
-                                || trimmed_line.contains("Subscribed to")
-                                || trimmed_line.contains("MQTT client connected"))
+                            && lines.iter().any(|line| {
+                                line.contains("Connected to")
+                                    || line.contains("Connection successful")
+                                    || line.contains("Subscribed to")
+                                    || line.contains("MQTT client connected")
+                            })
                         {
                             connection_established = true;
                             log_collector.log_str(
@@ -6401,27 +6453,23 @@ async fn start_infrastructure_with_logging(
                         }
 
                         // Log the actual output
-                        log_collector.log_str(LogSource::MqttObserver, trimmed_line);
-                        line.clear();
-                    }
+                        log_collector.log_lines(LogSource::MqttObserver, "", lines);
+                    })
+                    .await;
                 });
             }
 
             if let Some(stderr) = observer_process.stderr.take() {
                 let log_collector = log_collector.clone();
                 tokio::spawn(async move {
-                    let mut reader = BufReader::new(stderr);
-                    let mut line = String::new();
-                    while reader.read_line(&mut line).await.is_ok() && !line.is_empty() {
-                        log_collector.log_str(
-                            LogSource::MqttObserver,
-                            &format!("[stderr] {}", line.trim()),
-                        );
-                        line.clear();
-                    }
+                    log_pipeline::read_line_batches(stderr, |lines| {
+                        log_collector.log_lines(LogSource::MqttObserver, "[stderr] ", lines)
+                    })
+                    .await;
                 });
             }
 
+            state.monitor.track("mqtt_observer", observer_process.id());
             state
                 .infrastructure_processes
                 .insert("mqtt_observer".to_string(), observer_process);
@@ -6671,12 +6719,10 @@ async fn start_clients_with_logging(
             let log_collector = log_collector.clone();
             let client_id = client.id.clone();
             tokio::spawn(async move {
-                let mut reader = BufReader::new(stdout);
-                let mut line = String::new();
-                while reader.read_line(&mut line).await.is_ok() && !line.is_empty() {
-                    log_collector.log_str(LogSource::Client(client_id.clone()), line.trim());
-                    line.clear();
-                }
+                log_pipeline::read_line_batches(stdout, |lines| {
+                    log_collector.log_lines(LogSource::Client(client_id.clone()), "", lines)
+                })
+                .await;
             });
         }
 
@@ -6684,15 +6730,14 @@ async fn start_clients_with_logging(
             let log_collector = log_collector.clone();
             let client_id = client.id.clone();
             tokio::spawn(async move {
-                let mut reader = BufReader::new(stderr);
-                let mut line = String::new();
-                while reader.read_line(&mut line).await.is_ok() && !line.is_empty() {
-                    log_collector.log_str(
+                log_pipeline::read_line_batches(stderr, |lines| {
+                    log_collector.log_lines(
                         LogSource::Client(client_id.clone()),
-                        &format!("[stderr] {}", line.trim()),
-                    );
-                    line.clear();
-                }
+                        "[stderr] ",
+                        lines,
+                    )
+                })
+                .await;
             });
         }
 
@@ -6721,6 +6766,7 @@ async fn start_clients_with_logging(
             }
         }
 
+        state.monitor.track(&client.id, client_process.id());
         state
             .client_processes
             .insert(client.id.clone(), client_process);
@@ -7958,29 +8004,12 @@ async fn send_mcp_message_to_client(
 
 #[cfg(feature = "tui")]
 fn show_log_summary(app: &LoggingApp) {
-    use std::fs::OpenOptions;
-    use std::io::Write;
-
-    // Explicitly flush each log file to ensure accurate size reporting
-    for (_pane_name, log_file_path) in &app.log_files {
-        if log_file_path.exists() {
-            // Open the file in append mode and flush it
-            if let Ok(mut file) = OpenOptions::new()
-                .create(false)
-                .append(true)
-                .open(log_file_path)
-            {
-                let _ = file.flush();
-                let _ = file.sync_all(); // Force OS to write to disk
-            }
-        }
-    }
-
-    // Small additional delay to ensure filesystem consistency
-    std::thread::sleep(std::time::Duration::from_millis(100));
+    // Wait for the log writers so the sizes below are final
+    flush_log_writers();
 
     println!("\n📁 Log Files Summary");
     println!("====================");
+    show_log_pipeline_stats();
 
     // Show scenario file information
     if let Some(file_path) = &app.scenario_file_path {
@@ -8012,6 +8041,8 @@ fn show_log_summary(app: &LoggingApp) {
             );
         }
     }
+
+    show_resource_usage(&app.system_info.processes);
 }
 
 /// Search and correlate events across multiple log files
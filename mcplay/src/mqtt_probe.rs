@@ -0,0 +1,258 @@
+//! Minimal MQTT 3.1.1 subscriber for bench mode
+//!
+//! Subscribes to `#` on a scenario's broker and timestamps each PUBLISH as soon as it is
+//! read, so step effects are timed by mcplay itself instead of being parsed back out of
+//! observer logs. Only what that needs is implemented: QoS 0 subscriptions and keep-alive
+//! pings.
+
+use std::time::{Duration, Instant};
+use tokio::io::{AsyncRead, AsyncReadExt, AsyncWriteExt, BufReader};
+use tokio::net::TcpStream;
+use tokio::sync::broadcast;
+use tokio::task::JoinHandle;
+
+const CONNECT: u8 = 1;
+const CONNACK: u8 = 2;
+const PUBLISH: u8 = 3;
+const SUBSCRIBE: u8 = 8;
+const PINGREQ: u8 = 12;
+
+const KEEP_ALIVE_SECS: u16 = 30;
+/// Messages buffered per receiver before it starts skipping (pose traffic is bursty)
+const CHANNEL_CAPACITY: usize = 4096;
+
+/// A message seen on the broker and when it was read
+#[derive(Debug, Clone)]
+pub struct ObservedMessage {
+    pub topic: String,
+    pub payload: Vec<u8>,
+    pub at: Instant,
+}
+
+pub struct MqttProbe {
+    messages: broadcast::Sender<ObservedMessage>,
+    tasks: Vec<JoinHandle<()>>,
+}
+
+impl MqttProbe {
+    /// Connect to the broker and start observing every topic
+    pub async fn connect(host: &str, port: u16, client_id: &str) -> std::io::Result<Self> {
+        let mut stream = TcpStream::connect((host, port)).await?;
+        stream.set_nodelay(true)?;
+        stream
+            .write_all(&encode_connect(client_id, KEEP_ALIVE_SECS))
+            .await?;
+        let (header, body) = read_packet(&mut stream).await?;
+        if header >> 4 != CONNACK || body.get(1) != Some(&0) {
+            return Err(std::io::Error::new(
+                std::io::ErrorKind::ConnectionRefused,
+                "broker refused the MQTT connection",
+            ));
+        }
+        stream.write_all(&encode_subscribe(1, "#")).await?;
+
+        let (reader, mut writer) = stream.into_split();
+        let (messages, _) = broadcast::channel(CHANNEL_CAPACITY);
+        let sender = messages.clone();
+        let read_task = tokio::spawn(async move {
+            let mut reader = BufReader::new(reader);
+            while let Ok((header, body)) = read_packet(&mut reader).await {
+                let at = Instant::now();
+                if header >> 4 != PUBLISH {
+                    continue;
+                }
+                if let Some((topic, payload)) = parse_publish(header, &body) {
+                    let _ = sender.send(ObservedMessage {
+                        topic,
+                        payload: payload.to_vec(),
+                        at,
+                    });
+                }
+            }
+        });
+        let ping_task = tokio::spawn(async move {
+            let mut ticker = tokio::time::interval(Duration::from_secs(KEEP_ALIVE_SECS as u64 / 2));
+            ticker.tick().await;
+            loop {
+                ticker.tick().await;
+                if writer.write_all(&[PINGREQ << 4, 0]).await.is_err() {
+                    break;
+                }
+            }
+        });
+
+        Ok(Self {
+            messages,
+            tasks: vec![read_task, ping_task],
+        })
+    }
+
+    /// Receive every message read from now on
+    pub fn subscribe(&self) -> broadcast::Receiver<ObservedMessage> {
+        self.messages.subscribe()
+    }
+}
+
+impl Drop for MqttProbe {
+    fn drop(&mut self) {
+        for task in &self.tasks {
+            task.abort();
+        }
+    }
+}
+
+/// Wait until `deadline` for a message accepted by `matches` and return when it was read
+pub async fn wait_for(
+    messages: &mut broadcast::Receiver<ObservedMessage>,
+    deadline: Instant,
+    mut matches: impl FnMut(&ObservedMessage) -> bool,
+) -> Option<Instant> {
+    let wait = async {
+        loop {
+            match messages.recv().await {
+                Ok(message) if matches(&message) => return Some(message.at),
+                Ok(_) | Err(broadcast::error::RecvError::Lagged(_)) => {}
+                Err(broadcast::error::RecvError::Closed) => return None,
+            }
+        }
+    };
+    tokio::time::timeout_at(deadline.into(), wait)
+        .await
+        .ok()
+        .flatten()
+}
+
+fn put_str(dst: &mut Vec<u8>, s: &str) {
+    dst.extend_from_slice(&(s.len() as u16).to_be_bytes());
+    dst.extend_from_slice(s.as_bytes());
+}
+
+fn packet(header: u8, body: &[u8]) -> Vec<u8> {
+    let mut packet = vec![header];
+    let mut len = body.len();
+    loop {
+        let byte = (len % 128) as u8;
+        len /= 128;
+        packet.push(if len > 0 { byte | 0x80 } else { byte });
+        if len == 0 {
+            break;
+        }
+    }
+    packet.extend_from_slice(body);
+    packet
+}
+
+/// CONNECT with a clean session and no credentials
+pub fn encode_connect(client_id: &str, keep_alive_secs: u16) -> Vec<u8> {
+    let mut body = Vec::new();
+    put_str(&mut body, "MQTT");
+    body.push(4); // protocol level 3.1.1
+    body.push(0x02); // clean session
+    body.extend_from_slice(&keep_alive_secs.to_be_bytes());
+    put_str(&mut body, client_id);
+    packet(CONNECT << 4, &body)
+}
+
+/// SUBSCRIBE to one filter at QoS 0
+pub fn encode_subscribe(packet_id: u16, filter: &str) -> Vec<u8> {
+    let mut body = packet_id.to_be_bytes().to_vec();
+    put_str(&mut body, filter);
+    body.push(0);
+    packet(SUBSCRIBE << 4 | 0x02, &body)
+}
+
+/// Topic and payload of a PUBLISH body
+pub fn parse_publish(header: u8, body: &[u8]) -> Option<(String, &[u8])> {
+    let topic_len = u16::from_be_bytes([*body.first()?, *body.get(1)?]) as usize;
+    let topic = std::str::from_utf8(body.get(2..2 + topic_len)?).ok()?;
+    let packet_id_len = if (header >> 1) & 0x03 > 0 { 2 } else { 0 };
+    Some((
+        topic.to_string(),
+        body.get(2 + topic_len + packet_id_len..)?,
+    ))
+}
+
+async fn read_packet<R: AsyncRead + Unpin>(reader: &mut R) -> std::io::Result<(u8, Vec<u8>)> {
+    let header = reader.read_u8().await?;
+    let mut len = 0usize;
+    for shift in (0..28).step_by(7) {
+        let byte = reader.read_u8().await?;
+        len |= ((byte & 0x7f) as usize) << shift;
+        if byte & 0x80 == 0 {
+            let mut body = vec![0; len];
+            reader.read_exact(&mut body).await?;
+            return Ok((header, body));
+        }
+    }
+    Err(std::io::Error::new(
+        std::io::ErrorKind::InvalidData,
+        "malformed MQTT remaining length",
+    ))
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use tokio::net::TcpListener;
+
+    #[test]
+    fn test_packet_encoding() {
+        let connect = encode_connect("bench", 30);
+        assert_eq!(connect[0], 0x10);
+        assert_eq!(connect[1] as usize, connect.len() - 2);
+        assert_eq!(&connect[4..8], b"MQTT");
+
+        let long = packet(PUBLISH << 4, &[0; 200]);
+        assert_eq!(&long[..3], &[0x30, 0xc8, 0x01]);
+
+        let mut body = Vec::new();
+        put_str(&mut body, "a/b");
+        body.extend_from_slice(&[0, 7]); // packet id, present at QoS 1
+        body.extend_from_slice(b"hi");
+        assert_eq!(
+            parse_publish(PUBLISH << 4 | 0x02, &body),
+            Some(("a/b".to_string(), &b"hi"[..]))
+        );
+        assert_eq!(parse_publish(PUBLISH << 4, &body[..4]), None);
+    }
+
+    #[tokio::test]
+    async fn test_probe_observes_publishes() {
+        let listener = TcpListener::bind("127.0.0.1:0").await.unwrap();
+        let port = listener.local_addr().unwrap().port();
+        let (go, wait_for_go) = tokio::sync::oneshot::channel::<()>();
+        let broker = tokio::spawn(async move {
+            let (mut stream, _) = listener.accept().await.unwrap();
+            let (header, _) = read_packet(&mut stream).await.unwrap();
+            assert_eq!(header >> 4, CONNECT);
+            stream.write_all(&[CONNACK << 4, 2, 0, 0]).await.unwrap();
+            let (header, body) = read_packet(&mut stream).await.unwrap();
+            assert_eq!(header, SUBSCRIBE << 4 | 0x02);
+            assert!(body.ends_with(&[0, 1, b'#', 0]));
+            wait_for_go.await.unwrap();
+            for topic in ["other/topic", "iotcraft/worlds/w/state/blocks/placed"] {
+                let mut publish = Vec::new();
+                put_str(&mut publish, topic);
+                publish.extend_from_slice(b"{}");
+                stream
+                    .write_all(&packet(PUBLISH << 4, &publish))
+                    .await
+                    .unwrap();
+            }
+            stream
+        });
+
+        let probe = MqttProbe::connect("127.0.0.1", port, "bench")
+            .await
+            .unwrap();
+        let mut messages = probe.subscribe();
+        let start = Instant::now();
+        go.send(()).unwrap();
+        let _stream = broker.await.unwrap();
+        let seen = wait_for(&mut messages, start + Duration::from_secs(5), |m| {
+            m.topic.ends_with("/placed")
+        })
+        .await;
+        assert!(seen.is_some_and(|at| at >= start));
+    }
+}
@@ -0,0 +1,674 @@
+//! Host and child process resource sampling
+//!
+//! One task samples at a fixed interval and publishes [`SystemSnapshot`]s on a watch
+//! channel, so readers never trigger a measurement themselves. On Linux everything is
+//! read from `/proc` into buffers reused between samples. On macOS the host figures come
+//! from `top`/`vm_stat`/`sysctl` and every process from a single `ps` call per sample.
+//!
+//! Tracked processes are usually `cargo run` wrappers, so each one is measured together
+//! with all of its descendants.
+
+use serde::{Deserialize, Serialize};
+use std::collections::HashMap;
+use std::fmt::Write as _;
+use std::sync::{Arc, Mutex};
+use std::time::{Duration, Instant};
+use tokio::sync::watch;
+use tokio::task::JoinHandle;
+
+/// How often the monitor samples
+pub const SAMPLE_INTERVAL: Duration = Duration::from_secs(1);
+
+/// Kernel clock ticks per second used by `/proc/<pid>/stat` (USER_HZ, 100 on every
+/// mainstream Linux ABI)
+#[cfg(target_os = "linux")]
+const CLOCK_TICKS_PER_SEC: f64 = 100.0;
+
+/// Resource use of one tracked process and its descendants
+#[derive(Debug, Clone, Default, Serialize, Deserialize)]
+pub struct ProcessUsage {
+    pub name: String,
+    pub pid: u32,
+    /// CPU over the last sample interval; 100% is one core
+    pub cpu_percent: f64,
+    /// CPU time used since tracking started
+    pub cpu_seconds: f64,
+    /// Average CPU since tracking started; 100% is one core
+    pub avg_cpu_percent: f64,
+    pub rss_mb: f64,
+    pub peak_rss_mb: f64,
+    pub running: bool,
+}
+
+#[derive(Debug, Clone, Default)]
+pub struct SystemSnapshot {
+    pub cpu_usage: f64,
+    pub memory_used_mb: u64,
+    pub memory_total_mb: u64,
+    pub memory_usage_percent: f64,
+    pub uptime_seconds: u64,
+    pub process_count: usize,
+    pub processes: Vec<ProcessUsage>,
+}
+
+impl SystemSnapshot {
+    /// Format as display string for UI
+    pub fn format_for_display(&self) -> Vec<String> {
+        let mut lines = vec![
+            format!("CPU: {:.1}%", self.cpu_usage),
+            format!(
+                "Memory: {:.1}% ({}/{}MB)",
+                self.memory_usage_percent, self.memory_used_mb, self.memory_total_mb
+            ),
+            format!(
+                "Uptime: {}h {}m",
+                self.uptime_seconds / 3600,
+                (self.uptime_seconds % 3600) / 60
+            ),
+            format!("Processes: {}", self.process_count),
+        ];
+        for process in &self.processes {
+            lines.push(if process.running {
+                format!(
+                    "{}: {:.0}% CPU, {:.0}MB",
+                    process.name, process.cpu_percent, process.rss_mb
+                )
+            } else {
+                format!("{}: exited", process.name)
+            });
+        }
+        lines
+    }
+}
+
+/// Resource table for scenario reports
+pub fn render_usage(processes: &[ProcessUsage]) -> String {
+    let mut out = String::new();
+    if processes.is_empty() {
+        return out;
+    }
+    let _ = writeln!(
+        out,
+        "   {:<20} {:>8} {:>9} {:>9} {:>9} {:>9}",
+        "process", "pid", "cpu s", "avg cpu", "rss MB", "peak MB"
+    );
+    for process in processes {
+        let _ = writeln!(
+            out,
+            "   {:<20} {:>8} {:>9.1} {:>8.1}% {:>9.1} {:>9.1}{}",
+            process.name,
+            process.pid,
+            process.cpu_seconds,
+            process.avg_cpu_percent,
+            process.rss_mb,
+            process.peak_rss_mb,
+            if process.running { "" } else { " (exited)" }
+        );
+    }
+    out
+}
+
+/// Handle to the sampling task; clones share the same task
+#[derive(Clone)]
+pub struct SystemMonitor {
+    snapshots: watch::Receiver<SystemSnapshot>,
+    tracked: Arc<Mutex<Vec<(String, u32)>>>,
+    _task: Arc<AbortOnDrop>,
+}
+
+struct AbortOnDrop(JoinHandle<()>);
+
+impl Drop for AbortOnDrop {
+    fn drop(&mut self) {
+        self.0.abort();
+    }
+}
+
+impl SystemMonitor {
+    /// Start sampling every `interval` on a background task
+    pub fn spawn(interval: Duration) -> Self {
+        let (sender, snapshots) = watch::channel(SystemSnapshot::default());
+        let tracked: Arc<Mutex<Vec<(String, u32)>>> = Arc::default();
+        let targets = Arc::clone(&tracked);
+        let task = tokio::spawn(async move {
+            let mut sampler = Sampler::default();
+            let mut ticker = tokio::time::interval(interval);
+            ticker.set_missed_tick_behavior(tokio::time::MissedTickBehavior::Delay);
+            loop {
+                ticker.tick().await;
+                let targets = targets.lock().unwrap_or_else(|e| e.into_inner()).clone();
+                let snapshot = sampler.sample(&targets).await;
+                if sender.send(snapshot).is_err() {
+                    break;
+                }
+            }
+        });
+        Self {
+            snapshots,
+            tracked,
+            _task: Arc::new(AbortOnDrop(task)),
+        }
+    }
+
+    /// Report the resource use of `pid` and its descendants under `name`
+    pub fn track(&self, name: &str, pid: Option<u32>) {
+        if let Some(pid) = pid {
+            self.tracked
+                .lock()
+                .unwrap_or_else(|e| e.into_inner())
+                .push((name.to_string(), pid));
+        }
+    }
+
+    /// Receive every new snapshot
+    pub fn subscribe(&self) -> watch::Receiver<SystemSnapshot> {
+        self.snapshots.clone()
+    }
+
+    /// The most recent snapshot
+    pub fn latest(&self) -> SystemSnapshot {
+        self.snapshots.borrow().clone()
+    }
+}
+
+/// One member of a tracked process tree at sample time
+struct MemberSample {
+    pid: u32,
+    cpu_seconds: f64,
+    rss_kb: u64,
+}
+
+struct TrackedProcess {
+    usage: ProcessUsage,
+    since: Instant,
+    /// CPU seconds per member at the previous sample
+    cpu_seen: HashMap<u32, f64>,
+}
+
+impl TrackedProcess {
+    fn new(name: &str, pid: u32, now: Instant) -> Self {
+        Self {
+            usage: ProcessUsage {
+                name: name.to_string(),
+                pid,
+                running: true,
+                ..Default::default()
+            },
+            since: now,
+            cpu_seen: HashMap::new(),
+        }
+    }
+
+    /// Fold one sample of the process tree in; an empty sample means the process exited
+    fn record(&mut self, members: &[MemberSample], elapsed: Duration, now: Instant) {
+        let usage = &mut self.usage;
+        if members.is_empty() {
+            usage.running = false;
+            usage.cpu_percent = 0.0;
+            usage.rss_mb = 0.0;
+            return;
+        }
+        let mut used = 0.0;
+        let mut rss_kb = 0;
+        for member in members {
+            // Members that appear after the first sample started after tracking did
+            let before = self.cpu_seen.insert(member.pid, member.cpu_seconds);
+            used += (member.cpu_seconds - before.unwrap_or(0.0)).max(0.0);
+            rss_kb += member.rss_kb;
+        }
+        self.cpu_seen
+            .retain(|pid, _| members.iter().any(|m| m.pid == *pid));
+
+        usage.running = true;
+        usage.cpu_seconds += used;
+        usage.cpu_percent = used / elapsed.as_secs_f64().max(1e-3) * 100.0;
+        usage.avg_cpu_percent =
+            usage.cpu_seconds / now.duration_since(self.since).as_secs_f64().max(1e-3) * 100.0;
+        usage.rss_mb = rss_kb as f64 / 1024.0;
+        usage.peak_rss_mb = usage.peak_rss_mb.max(usage.rss_mb);
+    }
+}
+
+#[derive(Default)]
+struct Sampler {
+    #[cfg(target_os = "linux")]
+    buf: String,
+    #[cfg(target_os = "linux")]
+    path: String,
+    last_sample: Option<Instant>,
+    /// Total and idle jiffies from `/proc/stat` at the previous sample
+    #[cfg(target_os = "linux")]
+    last_cpu: Option<(u64, u64)>,
+    #[cfg(target_os = "macos")]
+    total_ram_mb: Option<u64>,
+    processes: Vec<TrackedProcess>,
+}
+
+impl Sampler {
+    async fn sample(&mut self, targets: &[(String, u32)]) -> SystemSnapshot {
+        let now = Instant::now();
+        let elapsed = self
+            .last_sample
+            .map(|at| now.duration_since(at))
+            .unwrap_or(SAMPLE_INTERVAL);
+        self.last_sample = Some(now);
+
+        let mut snapshot = self.sample_host().await;
+        let trees = self.sample_trees(targets).await;
+        for ((name, pid), members) in targets.iter().zip(trees) {
+            let index = match self.processes.iter().position(|p| p.usage.pid == *pid) {
+                Some(index) => index,
+                None => {
+                    self.processes.push(TrackedProcess::new(name, *pid, now));
+                    self.processes.len() - 1
+                }
+            };
+            self.processes[index].record(&members, elapsed, now);
+        }
+        snapshot.processes = self.processes.iter().map(|p| p.usage.clone()).collect();
+        snapshot
+    }
+
+    #[cfg(target_os = "linux")]
+    async fn sample_host(&mut self) -> SystemSnapshot {
+        let mut snapshot = SystemSnapshot::default();
+
+        if read_proc(&mut self.buf, "/proc/stat") {
+            if let Some((total, idle)) = parse_cpu_times(&self.buf) {
+                if let Some((last_total, last_idle)) = self.last_cpu {
+                    let busy = (total - last_total).saturating_sub(idle - last_idle);
+                    snapshot.cpu_usage = busy as f64 / (total - last_total).max(1) as f64 * 100.0;
+                }
+                self.last_cpu = Some((total, idle));
+            }
+        }
+        if read_proc(&mut self.buf, "/proc/meminfo") {
+            let total_kb = parse_kb_field(&self.buf, "MemTotal:").unwrap_or(0);
+            let available_kb = parse_kb_field(&self.buf, "MemAvailable:").unwrap_or(total_kb);
+            snapshot.memory_total_mb = total_kb / 1024;
+            snapshot.memory_used_mb = total_kb.saturating_sub(available_kb) / 1024;
+        }
+        if read_proc(&mut self.buf, "/proc/uptime") {
+            snapshot.uptime_seconds = self
+                .buf
+                .split_whitespace()
+                .next()
+                .and_then(|s| s.parse::<f64>().ok())
+                .unwrap_or(0.0) as u64;
+        }
+        snapshot.process_count = std::fs::read_dir("/proc")
+            .map(|entries| {
+                entries
+                    .filter_map(|e| e.ok())
+                    .filter(|e| e.file_name().to_str().is_some_and(is_pid))
+                    .count()
+            })
+            .unwrap_or(0);
+        snapshot.memory_usage_percent = memory_percent(&snapshot);
+        snapshot
+    }
+
+    #[cfg(target_os = "linux")]
+    async fn sample_trees(&mut self, targets: &[(String, u32)]) -> Vec<Vec<MemberSample>> {
+        let mut trees = Vec::with_capacity(targets.len());
+        for (_, root) in targets {
+            let mut members = Vec::new();
+            let mut pending = vec![*root];
+            while let Some(pid) = pending.pop() {
+                self.path.clear();
+                let _ = write!(self.path, "/proc/{}/stat", pid);
+                if !read_proc(&mut self.buf, &self.path) {
+                    continue;
+                }
+                let Some(ticks) = parse_pid_cpu_ticks(&self.buf) else {
+                    continue;
+                };
+                self.path.clear();
+                let _ = write!(self.path, "/proc/{}/status", pid);
+                let rss_kb = if read_proc(&mut self.buf, &self.path) {
+                    parse_kb_field(&self.buf, "VmRSS:").unwrap_or(0)
+                } else {
+                    0
+                };
+                members.push(MemberSample {
+                    pid,
+                    cpu_seconds: ticks as f64 / CLOCK_TICKS_PER_SEC,
+                    rss_kb,
+                });
+
+                // Children are listed per thread that forked them
+                self.path.clear();
+                let _ = write!(self.path, "/proc/{}/task", pid);
+                let Ok(tasks) = std::fs::read_dir(&self.path) else {
+                    continue;
+                };
+                for task in tasks.filter_map(|t| t.ok()) {
+                    let mut children = task.path();
+                    children.push("children");
+                    self.buf.clear();
+                    if let Ok(mut file) = std::fs::File::open(children) {
+                        use std::io::Read;
+                        let _ = file.read_to_string(&mut self.buf);
+                        pending.extend(
+                            self.buf
+                                .split_whitespace()
+                                .filter_map(|c| c.parse::<u32>().ok()),
+                        );
+                    }
+                }
+            }
+            trees.push(members);
+        }
+        trees
+    }
+
+    #[cfg(target_os = "macos")]
+    async fn sample_host(&mut self) -> SystemSnapshot {
+        if self.total_ram_mb.is_none() {
+            self.total_ram_mb = Some(macos::total_ram_mb().await.unwrap_or(0));
+        }
+        let mut snapshot = SystemSnapshot {
+            memory_total_mb: self.total_ram_mb.unwrap_or(0),
+            ..Default::default()
+        };
+        let (cpu_usage, memory_used_mb, uptime_seconds) = tokio::join!(
+            macos::cpu_usage(),
+            macos::memory_used_mb(),
+            macos::uptime_seconds()
+        );
+        snapshot.cpu_usage = cpu_usage.unwrap_or(0.0);
+        snapshot.memory_used_mb = memory_used_mb.unwrap_or(0);
+        snapshot.uptime_seconds = uptime_seconds.unwrap_or(0);
+        snapshot.memory_usage_percent = memory_percent(&snapshot);
+        snapshot
+    }
+
+    #[cfg(target_os = "macos")]
+    async fn sample_trees(&mut self, targets: &[(String, u32)]) -> Vec<Vec<MemberSample>> {
+        // One `ps` for every process; the row count doubles as the process count
+        let rows = macos::process_table().await.unwrap_or_default();
+        let mut children: HashMap<u32, Vec<usize>> = HashMap::new();
+        for (index, row) in rows.iter().enumerate() {
+            children.entry(row.ppid).or_default().push(index);
+        }
+        targets
+            .iter()
+            .map(|(_, root)| {
+                let mut members = Vec::new();
+                let mut pending: Vec<usize> = rows
+                    .iter()
+                    .position(|r| r.pid == *root)
+                    .into_iter()
+                    .collect();
+                while let Some(index) = pending.pop() {
+                    let row = &rows[index];
+                    members.push(MemberSample {
+                        pid: row.pid,
+                        cpu_seconds: row.cpu_seconds,
+                        rss_kb: row.rss_kb,
+                    });
+                    pending.extend(children.get(&row.pid).into_iter().flatten());
+                }
+                members
+            })
+            .collect()
+    }
+
+    #[cfg(not(any(target_os = "linux", target_os = "macos")))]
+    async fn sample_host(&mut self) -> SystemSnapshot {
+        SystemSnapshot::default()
+    }
+
+    #[cfg(not(any(target_os = "linux", target_os = "macos")))]
+    async fn sample_trees(&mut self, targets: &[(String, u32)]) -> Vec<Vec<MemberSample>> {
+        targets.iter().map(|_| Vec::new()).collect()
+    }
+}
+
+#[cfg(any(target_os = "linux", target_os = "macos"))]
+fn memory_percent(snapshot: &SystemSnapshot) -> f64 {
+    if snapshot.memory_total_mb > 0 {
+        snapshot.memory_used_mb as f64 / snapshot.memory_total_mb as f64 * 100.0
+    } else {
+        0.0
+    }
+}
+
+#[cfg(target_os = "linux")]
+fn read_proc(buf: &mut String, path: &str) -> bool {
+    use std::io::Read;
+    buf.clear();
+    std::fs::File::open(path)
+        .and_then(|mut file| file.read_to_string(buf))
+        .is_ok()
+}
+
+#[cfg(any(target_os = "linux", test))]
+fn is_pid(name: &str) -> bool {
+    !name.is_empty() && name.bytes().all(|b| b.is_ascii_digit())
+}
+
+/// Total and idle (idle + iowait) jiffies from the aggregate `cpu` line of `/proc/stat`
+#[cfg(any(target_os = "linux", test))]
+fn parse_cpu_times(stat: &str) -> Option<(u64, u64)> {
+    let line = stat.lines().find(|line| line.starts_with("cpu "))?;
+    let fields: Vec<u64> = line
+        .split_whitespace()
+        .skip(1)
+        .take(8) // user nice system idle iowait irq softirq steal; guest is inside user
+        .filter_map(|f| f.parse().ok())
+        .collect();
+    if fields.len() < 4 {
+        return None;
+    }
+    let idle = fields[3] + fields.get(4).copied().unwrap_or(0);
+    Some((fields.iter().sum(), idle))
+}
+
+/// `utime + stime` in clock ticks from `/proc/<pid>/stat`
+#[cfg(any(target_os = "linux", test))]
+fn parse_pid_cpu_ticks(stat: &str) -> Option<u64> {
+    // The command name may contain spaces and parentheses; fields restart after the last ')'
+    let rest = &stat[stat.rfind(')')? + 1..];
+    let mut fields = rest.split_whitespace().skip(11);
+    let utime: u64 = fields.next()?.parse().ok()?;
+    let stime: u64 = fields.next()?.parse().ok()?;
+    Some(utime + stime)
+}
+
+/// A `Key:   123 kB` value from `/proc/meminfo` or `/proc/<pid>/status`
+#[cfg(any(target_os = "linux", test))]
+fn parse_kb_field(text: &str, key: &str) -> Option<u64> {
+    text.lines()
+        .find_map(|line| line.strip_prefix(key))?
+        .split_whitespace()
+        .next()?
+        .parse()
+        .ok()
+}
+
+/// `ps` cumulative CPU time (`[[dd-]hh:]mm:ss.ss`) in seconds
+#[cfg(any(target_os = "macos", test))]
+fn parse_ps_time(text: &str) -> Option<f64> {
+    let (days, clock) = match text.split_once('-') {
+        Some((days, clock)) => (days.parse::<f64>().ok()?, clock),
+        None => (0.0, text),
+    };
+    let mut seconds = 0.0;
+    for part in clock.split(':') {
+        seconds = seconds * 60.0 + part.parse::<f64>().ok()?;
+    }
+    Some(days * 86_400.0 + seconds)
+}
+
+#[cfg(target_os = "macos")]
+mod macos {
+    use super::parse_ps_time;
+
+    type Result<T> = std::result::Result<T, Box<dyn std::error::Error + Send + Sync>>;
+
+    pub struct PsRow {
+        pub pid: u32,
+        pub ppid: u32,
+        pub cpu_seconds: f64,
+        pub rss_kb: u64,
+    }
+
+    async fn run(program: &str, args: &[&str]) -> Result<String> {
+        let output = tokio::process::Command::new(program)
+            .args(args)
+            .output()
+            .await?;
+        Ok(String::from_utf8(output.stdout)?)
+    }
+
+    /// Every process with its parent, cumulative CPU time and RSS
+    pub async fn process_table() -> Result<Vec<PsRow>> {
+        let output = run("ps", &["-A", "-o", "pid=,ppid=,rss=,time="]).await?;
+        Ok(output
+            .lines()
+            .filter_map(|line| {
+                let mut fields = line.split_whitespace();
+                Some(PsRow {
+                    pid: fields.next()?.parse().ok()?,
+                    ppid: fields.next()?.parse().ok()?,
+                    rss_kb: fields.next()?.parse().ok()?,
+                    cpu_seconds: parse_ps_time(fields.next()?)?,
+                })
+            })
+            .collect())
+    }
+
+    /// Look for a line like "CPU usage: 12.34% user, 5.67% sys, 82.99% idle"
+    pub async fn cpu_usage() -> Result<f64> {
+        let output = run("top", &["-l", "2", "-n", "0", "-s", "1"]).await?;
+        // The first report covers all time since boot; the last one covers the interval
+        let Some(line) = output.lines().filter(|l| l.contains("CPU usage:")).last() else {
+            return Ok(0.0);
+        };
+        let parts: Vec<&str> = line.split_whitespace().collect();
+        let mut used = 0.0;
+        for (i, part) in parts.iter().enumerate() {
+            if (*part == "user," || *part == "sys,") && i > 0 {
+                used += parts[i - 1]
+                    .trim_end_matches('%')
+                    .parse::<f64>()
+                    .unwrap_or(0.0);
+            }
+        }
+        Ok(used)
+    }
+
+    pub async fn total_ram_mb() -> Result<u64> {
+        let output = run("sysctl", &["-n", "hw.memsize"]).await?;
+        Ok(output.trim().parse::<u64>().unwrap_or(0) / (1024 * 1024))
+    }
+
+    /// Active + wired + compressed pages from `vm_stat`
+    pub async fn memory_used_mb() -> Result<u64> {
+        let output = run("vm_stat", &[]).await?;
+        let page_size = output
+            .lines()
+            .next()
+            .and_then(|line| line.split("page size of ").nth(1))
+            .and_then(|rest| rest.split_whitespace().next())
+            .and_then(|size| size.parse::<u64>().ok())
+            .unwrap_or(4096);
+        let mut used_pages = 0;
+        for line in output.lines() {
+            if line.contains("Pages active:")
+                || line.contains("Pages wired down:")
+                || line.contains("occupied by compressor:")
+            {
+                used_pages += line
+                    .split_whitespace()
+                    .last()
+                    .and_then(|v| v.trim_end_matches('.').parse::<u64>().ok())
+                    .unwrap_or(0);
+            }
+        }
+        Ok(used_pages * page_size / (1024 * 1024))
+    }
+
+    /// Parse `{ sec = 1234567890, usec = 123456 }` from `kern.boottime`
+    pub async fn uptime_seconds() -> Result<u64> {
+        let output = run("sysctl", &["-n", "kern.boottime"]).await?;
+        let boot_time = output
+            .split("sec = ")
+            .nth(1)
+            .and_then(|rest| rest.split(',').next())
+            .and_then(|sec| sec.parse::<u64>().ok());
+        let now = std::time::SystemTime::now()
+            .duration_since(std::time::UNIX_EPOCH)?
+            .as_secs();
+        Ok(boot_time.map(|boot| now.saturating_sub(boot)).unwrap_or(0))
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_proc_parsing() {
+        let stat = "cpu  100 5 50 800 20 3 2 0 7 0\ncpu0 50 2 25 400 10 1 1 0 0 0\n";
+        assert_eq!(parse_cpu_times(stat), Some((980, 820)));
+
+        // Command names can contain spaces and parentheses
+        let pid_stat = "4242 (iotcraft (main)) S 1 4242 4242 0 -1 4194560 1 0 0 0 \
+                        250 75 0 0 20 0 12 0 100 1000000 5000";
+        assert_eq!(parse_pid_cpu_ticks(pid_stat), Some(325));
+
+        let status = "Name:\tcargo\nVmHWM:\t  90000 kB\nVmRSS:\t   81920 kB\n";
+        assert_eq!(parse_kb_field(status, "VmRSS:"), Some(81920));
+        assert_eq!(parse_kb_field(status, "VmSwap:"), None);
+
+        assert_eq!(parse_ps_time("0:01.50"), Some(1.5));
+        assert_eq!(parse_ps_time("1:02:03.00"), Some(3723.0));
+        assert_eq!(parse_ps_time("2-00:00:01"), Some(172_801.0));
+        assert!(is_pid("123") && !is_pid("self") && !is_pid(""));
+    }
+
+    #[test]
+    fn test_tracked_process_accumulates() {
+        let start = Instant::now();
+        let mut tracked = TrackedProcess::new("alice", 10, start);
+        let second = Duration::from_secs(1);
+        let member = |pid, cpu_seconds, rss_kb| MemberSample {
+            pid,
+            cpu_seconds,
+            rss_kb,
+        };
+
+        tracked.record(&[member(10, 0.5, 1024)], second, start + second);
+        // A child appears (cargo starting the client) and the wrapper keeps idling
+        tracked.record(
+            &[member(10, 0.5, 1024), member(11, 0.25, 3072)],
+            second,
+            start + 2 * second,
+        );
+        let usage = &tracked.usage;
+        assert_eq!(usage.cpu_seconds, 0.75);
+        assert_eq!(usage.cpu_percent, 25.0);
+        assert_eq!(usage.avg_cpu_percent, 37.5);
+        assert_eq!((usage.rss_mb, usage.peak_rss_mb), (4.0, 4.0));
+
+        tracked.record(&[], second, start + 3 * second);
+        assert!(!tracked.usage.running);
+        assert_eq!(tracked.usage.peak_rss_mb, 4.0);
+        assert!(render_usage(&[tracked.usage.clone()]).contains("(exited)"));
+    }
+
+    #[cfg(target_os = "linux")]
+    #[tokio::test]
+    async fn test_sampler_reads_own_process() {
+        let mut sampler = Sampler::default();
+        let targets = vec![("self".to_string(), std::process::id())];
+        sampler.sample(&targets).await;
+        let snapshot = sampler.sample(&targets).await;
+        assert!(snapshot.memory_total_mb > 0);
+        assert!(snapshot.process_count > 0);
+        let usage = &snapshot.processes[0];
+        assert!(usage.running && usage.rss_mb > 0.0);
+    }
+}
@@ -0,0 +1,452 @@
+//! Per-client publish budgets for the server-side links.
+//!
+//! rumqttd routes every publish before a link sees it, and its links can neither veto a
+//! publish nor close another connection. It has no hook before routing and does not expose
+//! a connection's outgoing queue, so neither a pre-routing budget nor a slow-consumer
+//! policy can be built on it: a flooding client's publishes still reach every subscriber at
+//! whatever rate it sends. Only the server-side cost is limited. What one misbehaving
+//! client can still ruin is the
+//! work this server does on its behalf: keeping up with its poses, answering its snapshot
+//! requests with whole worlds, and forwarding its poses to other shards. A
+//! [`ClientLimiter`] gives each client a message, byte and request budget for that work and
+//! decides what happens to the excess:
+//! - `drop`: excess messages are ignored,
+//! - `coalesce`: excess poses are held back and only the latest one per client is
+//!   applied when the budget allows; other excess messages are dropped,
+//! - `quarantine`: like `coalesce`, and clients that stay over budget are ignored
+//!   entirely for a while, as if disconnected.
+//!
+//! Only poses, probe echoes and snapshot and chunk requests are limited. Block edits, world
+//! changes and published worlds have already reached every subscribed client when a link
+//! sees them, so ignoring one would only make the world state and the other shards
+//! disagree with what clients applied; they are always accepted.
+//!
+//! Clients are identified the way IoTCraft names them: the player id in a pose topic and
+//! the `client_id` of snapshot and chunk requests, which is also where the reply goes.
+//! Requests without one share a budget per world. rumqttd has no publish ACLs and does not
+//! tell links which connection published a message, so these ids are claimed, not
+//! verified: a client posing as another one can at most hold back that player's poses in
+//! the server state and slow down the replies addressed to it.
+
+use crate::world_state::{WorldTopic, parse_topic};
+use bytes::Bytes;
+use clap::ValueEnum;
+use serde::{Deserialize, Serialize};
+use std::collections::HashMap;
+use std::time::{Duration, Instant};
+use tracing::warn;
+
+/// Consecutive exhausted budget windows before a client is quarantined
+const QUARANTINE_STRIKES: u32 = 3;
+/// Budget windows over which strikes are counted
+const STRIKE_WINDOW: Duration = Duration::from_secs(1);
+/// Idle clients whose budget is forgotten
+const IDLE_EXPIRY: Duration = Duration::from_secs(60);
+
+#[derive(Clone, Copy, Debug, PartialEq, Eq, ValueEnum)]
+pub enum OverLimitPolicy {
+    /// Ignore messages beyond the budget
+    Drop,
+    /// Keep the latest pose of clients over budget, drop other excess messages
+    Coalesce,
+    /// Coalesce, and ignore clients that stay over budget for a while
+    Quarantine,
+}
+
+#[derive(Clone, Copy, Debug, PartialEq)]
+pub struct ClientLimits {
+    pub messages_per_sec: f64,
+    pub bytes_per_sec: f64,
+    /// Snapshot and chunk requests, each answered with up to a whole world
+    pub requests_per_sec: f64,
+    /// Seconds of budget a quiet client may spend at once
+    pub burst_secs: f64,
+    pub policy: OverLimitPolicy,
+    pub quarantine: Duration,
+}
+
+impl Default for ClientLimits {
+    fn default() -> Self {
+        Self {
+            // Desktop clients send poses at 10 Hz; scripted builds place blocks in bursts
+            messages_per_sec: 200.0,
+            bytes_per_sec: 1024.0 * 1024.0,
+            requests_per_sec: 2.0,
+            burst_secs: 2.0,
+            policy: OverLimitPolicy::Coalesce,
+            quarantine: Duration::from_secs(30),
+        }
+    }
+}
+
+/// What to do with one message
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Verdict {
+    Accept,
+    /// Over budget: ignore it
+    Drop,
+    /// Over budget: held back as the client's latest pose
+    Coalesce,
+    /// The client is quarantined: ignore it
+    Quarantined,
+}
+
+/// How often each action was taken
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq, Serialize)]
+pub struct LimitStats {
+    pub accepted: u64,
+    pub dropped: u64,
+    pub dropped_bytes: u64,
+    pub coalesced: u64,
+    /// Coalesced poses later applied
+    pub coalesced_applied: u64,
+    /// Clients put into quarantine
+    pub quarantines: u64,
+    pub quarantined_messages: u64,
+}
+
+#[derive(Debug, Clone, Copy)]
+struct Bucket {
+    tokens: f64,
+    rate: f64,
+    capacity: f64,
+}
+
+impl Bucket {
+    fn new(rate: f64, burst_secs: f64) -> Self {
+        let capacity = (rate * burst_secs).max(1.0);
+        Self {
+            tokens: capacity,
+            rate,
+            capacity,
+        }
+    }
+
+    fn refill(&mut self, elapsed: Duration) {
+        self.tokens = (self.tokens + self.rate * elapsed.as_secs_f64()).min(self.capacity);
+    }
+
+    fn has(&self, cost: f64) -> bool {
+        self.tokens >= cost
+    }
+}
+
+#[derive(Debug)]
+struct ClientBudget {
+    messages: Bucket,
+    bytes: Bucket,
+    requests: Bucket,
+    last_refill: Instant,
+    /// Start of the window in which the client last ran out of budget
+    exhausted_window: Option<Instant>,
+    strikes: u32,
+    quarantined_until: Option<Instant>,
+}
+
+impl ClientBudget {
+    fn new(limits: &ClientLimits, now: Instant) -> Self {
+        Self {
+            messages: Bucket::new(limits.messages_per_sec, limits.burst_secs),
+            bytes: Bucket::new(limits.bytes_per_sec, limits.burst_secs),
+            requests: Bucket::new(limits.requests_per_sec, limits.burst_secs),
+            last_refill: now,
+            exhausted_window: None,
+            strikes: 0,
+            quarantined_until: None,
+        }
+    }
+
+    /// Count an exhausted budget; `true` once the client has been over budget in enough
+    /// consecutive windows
+    fn strike(&mut self, now: Instant) -> bool {
+        match self.exhausted_window {
+            Some(window) if now.duration_since(window) < STRIKE_WINDOW => return false,
+            Some(window) if now.duration_since(window) < STRIKE_WINDOW * 2 => self.strikes += 1,
+            _ => self.strikes = 1,
+        }
+        self.exhausted_window = Some(now);
+        self.strikes >= QUARANTINE_STRIKES
+    }
+}
+
+#[derive(Deserialize)]
+struct Requester<'a> {
+    #[serde(borrow)]
+    client_id: Option<&'a str>,
+}
+
+/// The client whose budget a world message is charged to; `None` for messages that are
+/// never limited
+fn sender<'a>(world_id: &'a str, kind: WorldTopic<'a>, payload: &'a [u8]) -> Option<String> {
+    match kind {
+        WorldTopic::Pose(player_id) | WorldTopic::ProbeReply(player_id) => {
+            Some(player_id.to_string())
+        }
+        WorldTopic::SnapshotRequest | WorldTopic::ChunkRequest => {
+            let id = serde_json::from_slice::<Requester>(payload)
+                .ok()
+                .and_then(|requester| requester.client_id);
+            Some(match id {
+                Some(id) => id.to_string(),
+                None => format!("world:{world_id}"),
+            })
+        }
+        // Already delivered to every subscriber, see the module docs
+        WorldTopic::Info
+        | WorldTopic::Data
+        | WorldTopic::DataChunk
+        | WorldTopic::BlockPlaced
+        | WorldTopic::BlockRemoved
+        | WorldTopic::BlockBatch
+        | WorldTopic::Changes => None,
+    }
+}
+
+/// Applies [`ClientLimits`] to the world messages a link receives
+#[derive(Debug)]
+pub struct ClientLimiter {
+    limits: ClientLimits,
+    clients: HashMap<String, ClientBudget>,
+    /// Latest held-back pose per topic
+    coalesced: HashMap<String, Bytes>,
+    last_expiry: Instant,
+    pub stats: LimitStats,
+}
+
+impl ClientLimiter {
+    pub fn new(limits: ClientLimits, now: Instant) -> Self {
+        Self {
+            limits,
+            clients: HashMap::new(),
+            coalesced: HashMap::new(),
+            last_expiry: now,
+            stats: LimitStats::default(),
+        }
+    }
+
+    /// Charge a message to its sender's budget. Coalesced payloads are kept and returned
+    /// by [`ClientLimiter::take_coalesced`]
+    pub fn check(&mut self, topic: &str, payload: &Bytes, now: Instant) -> Verdict {
+        let Some((world_id, kind)) = parse_topic(topic) else {
+            return Verdict::Accept;
+        };
+        let Some(client_id) = sender(world_id, kind, payload) else {
+            self.stats.accepted += 1;
+            return Verdict::Accept;
+        };
+        if now.duration_since(self.last_expiry) >= IDLE_EXPIRY {
+            self.clients.retain(|_, budget| {
+                now.duration_since(budget.last_refill) < IDLE_EXPIRY
+                    || budget.quarantined_until.is_some_and(|until| until > now)
+            });
+            self.last_expiry = now;
+        }
+
+        let limits = self.limits;
+        if !self.clients.contains_key(&client_id) {
+            self.clients
+                .insert(client_id.clone(), ClientBudget::new(&limits, now));
+        }
+        let Some(budget) = self.clients.get_mut(&client_id) else {
+            return Verdict::Accept;
+        };
+        if let Some(until) = budget.quarantined_until {
+            if now < until {
+                self.stats.quarantined_messages += 1;
+                return Verdict::Quarantined;
+            }
+            budget.quarantined_until = None;
+            budget.strikes = 0;
+        }
+        let elapsed = now.duration_since(budget.last_refill);
+        budget.last_refill = now;
+        budget.messages.refill(elapsed);
+        budget.bytes.refill(elapsed);
+        budget.requests.refill(elapsed);
+
+        let request = matches!(kind, WorldTopic::SnapshotRequest | WorldTopic::ChunkRequest);
+        let bytes = payload.len() as f64;
+        let within = budget.messages.has(1.0)
+            && budget.bytes.has(bytes.min(budget.bytes.capacity))
+            && (!request || budget.requests.has(1.0));
+        if within {
+            budget.messages.tokens -= 1.0;
+            budget.bytes.tokens -= bytes.min(budget.bytes.capacity);
+            if request {
+                budget.requests.tokens -= 1.0;
+            }
+            self.stats.accepted += 1;
+            return Verdict::Accept;
+        }
+
+        if limits.policy == OverLimitPolicy::Quarantine && budget.strike(now) {
+            budget.quarantined_until = Some(now + limits.quarantine);
+            self.stats.quarantines += 1;
+            self.stats.quarantined_messages += 1;
+            warn!(
+                "🚧 Quarantining client {} for {:?}: over its publish budget",
+                client_id, limits.quarantine
+            );
+            self.coalesced.remove(topic);
+            return Verdict::Quarantined;
+        }
+        if limits.policy != OverLimitPolicy::Drop && matches!(kind, WorldTopic::Pose(_)) {
+            self.stats.coalesced += 1;
+            self.coalesced.insert(topic.to_string(), payload.clone());
+            return Verdict::Coalesce;
+        }
+        self.stats.dropped += 1;
+        self.stats.dropped_bytes += payload.len() as u64;
+        Verdict::Drop
+    }
+
+    /// Held-back poses whose clients have budget again, latest first per topic
+    pub fn take_coalesced(&mut self, now: Instant) -> Vec<(String, Bytes)> {
+        let pending: Vec<_> = self.coalesced.drain().collect();
+        let mut ready = Vec::with_capacity(pending.len());
+        for (topic, payload) in pending {
+            match self.check(&topic, &payload, now) {
+                Verdict::Accept => {
+                    self.stats.coalesced_applied += 1;
+                    ready.push((topic, payload));
+                }
+                // Still over budget: check() kept it for the next round
+                Verdict::Coalesce => self.stats.coalesced -= 1,
+                Verdict::Drop | Verdict::Quarantined => {}
+            }
+        }
+        ready
+    }
+
+    /// Clients currently ignored
+    pub fn quarantined(&self, now: Instant) -> Vec<String> {
+        let mut clients: Vec<_> = self
+            .clients
+            .iter()
+            .filter(|(_, budget)| budget.quarantined_until.is_some_and(|until| until > now))
+            .map(|(id, _)| id.clone())
+            .collect();
+        clients.sort();
+        clients
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn pose(player: &str) -> (String, Bytes) {
+        (
+            format!("iotcraft/worlds/w/players/{player}/pose"),
+            Bytes::from(format!(
+                r#"{{"player_id":"{player}","pos":[0,0,0],"ts":0}}"#
+            )),
+        )
+    }
+
+    fn block_placed(player: &str) -> (String, Bytes) {
+        (
+            "iotcraft/worlds/w/state/blocks/placed".to_string(),
+            Bytes::from(format!(
+                r#"{{"player_id":"{player}","change":{{"Placed":{{"x":1,"y":2,"z":3,"block_type":"Stone"}}}}}}"#
+            )),
+        )
+    }
+
+    fn snapshot_request(client: &str) -> (String, Bytes) {
+        (
+            "iotcraft/worlds/w/snapshot/request".to_string(),
+            Bytes::from(format!(r#"{{"client_id":"{client}"}}"#)),
+        )
+    }
+
+    /// Ten seconds of 50 well-behaved players at 10 Hz and one client flooding poses and
+    /// snapshot requests at 1 kHz, through one limiter
+    fn flood(policy: OverLimitPolicy) -> (ClientLimiter, u64, u64) {
+        let start = Instant::now();
+        let mut limiter = ClientLimiter::new(
+            ClientLimits {
+                policy,
+                ..ClientLimits::default()
+            },
+            start,
+        );
+        let mut good_accepted = 0;
+        let mut flood_served = 0;
+        for ms in 0..10_000u64 {
+            let now = start + Duration::from_millis(ms);
+            for (topic, payload) in [pose("flood"), snapshot_request("flood")] {
+                if limiter.check(&topic, &payload, now) == Verdict::Accept
+                    && topic.ends_with("request")
+                {
+                    flood_served += 1;
+                }
+            }
+            if ms % 100 == 0 {
+                for player in 0..50 {
+                    let (topic, payload) = pose(&format!("player-{player}"));
+                    if limiter.check(&topic, &payload, now) == Verdict::Accept {
+                        good_accepted += 1;
+                    }
+                }
+                limiter.take_coalesced(now);
+            }
+        }
+        (limiter, good_accepted, flood_served)
+    }
+
+    #[test]
+    fn flooding_client_is_limited_without_affecting_others() {
+        let (mut limiter, good_accepted, flood_served) = flood(OverLimitPolicy::Coalesce);
+        assert_eq!(good_accepted, 50 * 100);
+        // Burst plus sustained request budget, not the 10 000 requests sent
+        assert!(
+            flood_served <= 4 + 2 * 10,
+            "{flood_served} snapshots served"
+        );
+        assert!(limiter.stats.dropped > 9000);
+        assert!(limiter.stats.coalesced > 0);
+        assert_eq!(limiter.stats.quarantines, 0);
+
+        // Once the flood stops, the flooder's latest pose is still applied
+        let ready = limiter.take_coalesced(Instant::now() + Duration::from_secs(11));
+        assert_eq!(ready, vec![pose("flood")]);
+        assert_eq!(limiter.stats.coalesced_applied, 1);
+    }
+
+    #[test]
+    fn persistent_flooder_is_quarantined() {
+        let (limiter, good_accepted, flood_served) = flood(OverLimitPolicy::Quarantine);
+        assert_eq!(good_accepted, 50 * 100);
+        assert!(flood_served <= 4 + 2 * 3);
+        assert_eq!(limiter.stats.quarantines, 1);
+        assert!(limiter.stats.quarantined_messages > 15_000);
+        let end = Instant::now() + Duration::from_secs(10);
+        assert_eq!(limiter.quarantined(end), vec!["flood".to_string()]);
+    }
+
+    #[test]
+    fn block_edits_are_never_limited() {
+        let (mut limiter, _, _) = flood(OverLimitPolicy::Quarantine);
+        let end = Instant::now() + Duration::from_secs(10);
+        assert_eq!(limiter.quarantined(end), vec!["flood".to_string()]);
+        let accepted = limiter.stats.accepted;
+        // Clients applied these edits already; the world state must not miss them, even
+        // from a quarantined client or far over any budget
+        for ms in 0..5_000u64 {
+            let (topic, payload) = block_placed("flood");
+            assert_eq!(
+                limiter.check(&topic, &payload, end + Duration::from_micros(ms)),
+                Verdict::Accept
+            );
+        }
+        assert_eq!(limiter.stats.accepted, accepted + 5_000);
+    }
+
+    #[test]
+    fn drop_policy_never_holds_back_poses() {
+        let (limiter, _, _) = flood(OverLimitPolicy::Drop);
+        assert_eq!(limiter.stats.coalesced, 0);
+        assert!(limiter.coalesced.is_empty());
+    }
+}
@@ -0,0 +1,728 @@
+//! Sharded cluster mode.
+//!
+//! Several broker processes form a cluster, each listed by address in the same order on
+//! every shard. A world belongs to the shard its id hashes to, and clients should connect
+//! to that shard; the world state of `world_state` is only kept there. Every shard runs a
+//! forwarder that keeps the cluster consistent for clients connected elsewhere:
+//!
+//! - world traffic published on a shard that does not own the world is sent to the owner,
+//!   so misrouted clients still reach the authoritative state
+//! - the owner sends world discovery (`info`) and per-client replies (`clients/...`) to
+//!   every other shard, so worlds are listed and joins answered cluster-wide
+//! - the owner sends the rest of a world's traffic to the shards whose clients published
+//!   in it recently, so misrouted clients see what clients of the owner do
+//!
+//! Shards exchange messages on `iotcraft/cluster/{shard}/{boot}/{seq}/{topic}`: the id of
+//! a message is the shard it was first published on, that shard's start time and a
+//! sequence number, so repeats of the same payload stay distinct messages. The receiving
+//! forwarder republishes a message on its own shard under the original topic, passes it on
+//! if it owns the world, never back to the shard it came from, and drops ids it has
+//! already seen within the last few seconds.
+//!
+//! Forwarding is subject to the same per-client budgets as the world state, and a shard
+//! that cannot keep up does not get every pose: while its queue is full, only the latest
+//! pose of each player waits for it.
+
+use crate::client_limits::{ClientLimiter, ClientLimits, Verdict};
+use crate::world_state::WORLD_TOPIC_FILTER;
+use bytes::Bytes;
+use rumqttc::{AsyncClient, Event, Incoming, MqttOptions, QoS};
+use rumqttd::{Broker, Notification};
+use std::collections::hash_map::DefaultHasher;
+use std::collections::{HashMap, HashSet, VecDeque};
+use std::hash::{Hash, Hasher};
+use std::process::Command;
+use std::time::{Duration, Instant, SystemTime, UNIX_EPOCH};
+use tracing::{debug, info, warn};
+
+const WORLDS_PREFIX: &str = "iotcraft/worlds/";
+const CLUSTER_PREFIX: &str = "iotcraft/cluster/";
+const CLUSTER_TOPIC_FILTER: &str = "iotcraft/cluster/#";
+
+/// How long a forwarder remembers messages it handled
+const SEEN_WINDOW: Duration = Duration::from_secs(5);
+const SEEN_CAPACITY: usize = 65_536;
+
+/// How long a shard counts as subscribed to a world after its clients last published there
+const SUBSCRIBER_WINDOW: Duration = Duration::from_secs(300);
+
+/// Largest message forwarded between shards, enough for big world snapshots
+const MAX_FORWARD_PACKET: usize = 16 * 1024 * 1024;
+
+/// How often held-back poses are offered to their shards again
+const FLUSH_INTERVAL: Duration = Duration::from_millis(100);
+
+/// Shard owning a world: FNV-1a of the world id, so every shard and client computes the
+/// same owner without coordination
+pub fn shard_for_world(world_id: &str, shards: usize) -> usize {
+    let mut hash: u64 = 0xcbf2_9ce4_8422_2325;
+    for byte in world_id.bytes() {
+        hash ^= u64::from(byte);
+        hash = hash.wrapping_mul(0x0100_0000_01b3);
+    }
+    (hash % shards.max(1) as u64) as usize
+}
+
+/// World id of a world topic
+pub fn world_of(topic: &str) -> Option<&str> {
+    let (world_id, _) = topic.strip_prefix(WORLDS_PREFIX)?.split_once('/')?;
+    (!world_id.is_empty()).then_some(world_id)
+}
+
+/// This shard's place in the cluster
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct Cluster {
+    pub index: usize,
+    /// `host:port` of every shard, in shard order
+    pub shards: Vec<String>,
+}
+
+impl Cluster {
+    /// Parse a comma-separated shard list
+    pub fn new(shards: &str, index: usize) -> anyhow::Result<Self> {
+        let shards: Vec<String> = shards
+            .split(',')
+            .map(str::trim)
+            .filter(|shard| !shard.is_empty())
+            .map(str::to_string)
+            .collect();
+        if shards.is_empty() {
+            anyhow::bail!("Cluster needs at least one shard address");
+        }
+        if index >= shards.len() {
+            anyhow::bail!(
+                "Shard index {} is outside the cluster of {} shards",
+                index,
+                shards.len()
+            );
+        }
+        for shard in &shards {
+            let port_ok = shard
+                .rsplit_once(':')
+                .is_some_and(|(host, port)| !host.is_empty() && port.parse::<u16>().is_ok());
+            if !port_ok {
+                anyhow::bail!("Shard address {} is not host:port", shard);
+            }
+        }
+        Ok(Self { index, shards })
+    }
+
+    /// Addresses of `count` shards on consecutive ports of one host
+    pub fn local_addresses(base_port: u16, count: usize) -> String {
+        (0..count)
+            .map(|i| format!("127.0.0.1:{}", usize::from(base_port) + i))
+            .collect::<Vec<_>>()
+            .join(",")
+    }
+
+    pub fn port(&self) -> u16 {
+        let (_, port) = self.shards[self.index].rsplit_once(':').unwrap();
+        port.parse().unwrap()
+    }
+
+    pub fn owns(&self, world_id: &str) -> bool {
+        shard_for_world(world_id, self.shards.len()) == self.index
+    }
+
+    /// Whether the world state of this shard should track `topic`: everything except
+    /// topics of worlds owned by other shards
+    pub fn tracks(&self, topic: &str) -> bool {
+        world_of(topic).is_none_or(|world_id| self.owns(world_id))
+    }
+
+    /// Shards a message seen on this shard must be forwarded to. A message first published
+    /// here (`origin` is this shard) goes to the owner of its world. The owner passes it on
+    /// to every other shard but `origin`: discovery and replies to all of them, the rest of
+    /// the world's traffic to the shards `subscribed` to the world.
+    pub fn route(
+        &self,
+        topic: &str,
+        origin: usize,
+        subscribed: impl Fn(usize) -> bool,
+    ) -> Vec<usize> {
+        let Some(world_id) = world_of(topic) else {
+            return Vec::new();
+        };
+        let owner = shard_for_world(world_id, self.shards.len());
+        if owner != self.index {
+            return if origin == self.index {
+                vec![owner]
+            } else {
+                Vec::new()
+            };
+        }
+        let rest = &topic[WORLDS_PREFIX.len() + world_id.len() + 1..];
+        let discovery = rest == "info" || rest.starts_with("clients/");
+        (0..self.shards.len())
+            .filter(|&i| i != self.index && i != origin && (discovery || subscribed(i)))
+            .collect()
+    }
+}
+
+/// Identity of a message in the cluster
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct MessageId {
+    /// Shard the message was first published on
+    pub shard: usize,
+    /// Start time of that shard, so a restarted shard does not repeat ids
+    pub boot: u64,
+    pub seq: u64,
+}
+
+impl MessageId {
+    /// Topic carrying a message of `topic` to another shard
+    pub fn envelope(&self, topic: &str) -> String {
+        format!(
+            "{CLUSTER_PREFIX}{}/{}/{}/{topic}",
+            self.shard, self.boot, self.seq
+        )
+    }
+
+    /// Id and original topic of a message received from another shard
+    pub fn open(envelope: &str) -> Option<(Self, &str)> {
+        let mut parts = envelope.strip_prefix(CLUSTER_PREFIX)?.splitn(4, '/');
+        let id = Self {
+            shard: parts.next()?.parse().ok()?,
+            boot: parts.next()?.parse().ok()?,
+            seq: parts.next()?.parse().ok()?,
+        };
+        Some((id, parts.next()?))
+    }
+}
+
+/// Ids of the messages first published on this shard
+struct Sequence {
+    shard: usize,
+    boot: u64,
+    seq: u64,
+}
+
+impl Sequence {
+    fn new(shard: usize) -> Self {
+        let boot = SystemTime::now()
+            .duration_since(UNIX_EPOCH)
+            .map_or(0, |since| since.as_millis() as u64);
+        Self {
+            shard,
+            boot,
+            seq: 0,
+        }
+    }
+
+    fn next(&mut self) -> MessageId {
+        self.seq += 1;
+        MessageId {
+            shard: self.shard,
+            boot: self.boot,
+            seq: self.seq,
+        }
+    }
+}
+
+/// Messages a forwarder handled recently
+#[derive(Debug, Default)]
+pub struct SeenMessages {
+    order: VecDeque<(MessageId, Instant)>,
+    ids: HashSet<MessageId>,
+}
+
+impl SeenMessages {
+    /// Remember a message; `false` when it was already seen within the window
+    pub fn insert(&mut self, id: MessageId, now: Instant) -> bool {
+        while let Some(&(old, at)) = self.order.front() {
+            if now.duration_since(at) < SEEN_WINDOW && self.order.len() < SEEN_CAPACITY {
+                break;
+            }
+            self.order.pop_front();
+            self.ids.remove(&old);
+        }
+        if !self.ids.insert(id) {
+            return false;
+        }
+        self.order.push_back((id, now));
+        true
+    }
+}
+
+/// Messages a forwarder republished on its own shard. Its subscription sees them again,
+/// and they must keep the id they arrived with instead of counting as published here.
+#[derive(Debug, Default)]
+pub struct Republished {
+    pending: HashMap<u64, VecDeque<(MessageId, Instant)>>,
+}
+
+impl Republished {
+    pub fn insert(&mut self, topic: &str, payload: &[u8], id: MessageId, now: Instant) {
+        self.pending
+            .entry(message_hash(topic, payload))
+            .or_default()
+            .push_back((id, now));
+    }
+
+    /// Id of a message this forwarder republished, if it is one
+    pub fn take(&mut self, topic: &str, payload: &[u8]) -> Option<MessageId> {
+        let hash = message_hash(topic, payload);
+        let pending = self.pending.get_mut(&hash)?;
+        let (id, _) = pending.pop_front()?;
+        if pending.is_empty() {
+            self.pending.remove(&hash);
+        }
+        Some(id)
+    }
+
+    /// Forget messages the broker never delivered back
+    pub fn expire(&mut self, now: Instant) {
+        self.pending.retain(|_, pending| {
+            pending.retain(|&(_, at)| now.duration_since(at) < SEEN_WINDOW);
+            !pending.is_empty()
+        });
+    }
+}
+
+fn message_hash(topic: &str, payload: &[u8]) -> u64 {
+    let mut hasher = DefaultHasher::new();
+    topic.hash(&mut hasher);
+    payload.hash(&mut hasher);
+    hasher.finish()
+}
+
+/// Shards whose clients published in a world recently, as seen by its owner
+#[derive(Debug, Default)]
+pub struct Subscribers {
+    last_seen: HashMap<(String, usize), Instant>,
+}
+
+impl Subscribers {
+    pub fn record(&mut self, world_id: &str, shard: usize, now: Instant) {
+        self.last_seen.insert((world_id.to_string(), shard), now);
+    }
+
+    pub fn contains(&self, world_id: &str, shard: usize, now: Instant) -> bool {
+        self.last_seen
+            .get(&(world_id.to_string(), shard))
+            .is_some_and(|&at| now.duration_since(at) < SUBSCRIBER_WINDOW)
+    }
+
+    pub fn expire(&mut self, now: Instant) {
+        self.last_seen
+            .retain(|_, &mut at| now.duration_since(at) < SUBSCRIBER_WINDOW);
+    }
+}
+
+#[derive(Debug, Default, Clone, Copy)]
+pub struct ForwardStats {
+    pub forwarded: u64,
+    pub duplicates: u64,
+    pub dropped: u64,
+    /// Poses replaced by a newer one while waiting for a full shard queue
+    pub superseded: u64,
+    /// Messages over their client's budget
+    pub limited: u64,
+}
+
+/// Peer connections and the poses waiting for each of them
+struct Peers {
+    clients: Vec<Option<AsyncClient>>,
+    backlog: Vec<HashMap<String, (MessageId, Bytes)>>,
+}
+
+impl Peers {
+    fn send(
+        &mut self,
+        target: usize,
+        id: MessageId,
+        topic: &str,
+        payload: &Bytes,
+        stats: &mut ForwardStats,
+    ) {
+        let Some(peer) = &self.clients[target] else {
+            return;
+        };
+        match peer.try_publish(
+            id.envelope(topic),
+            QoS::AtLeastOnce,
+            false,
+            payload.to_vec(),
+        ) {
+            Ok(()) => stats.forwarded += 1,
+            Err(e) if topic.ends_with("/pose") => {
+                debug!("Holding pose for shard {}: {}", target, e);
+                let pending = self.backlog[target].insert(topic.to_string(), (id, payload.clone()));
+                if pending.is_some() {
+                    stats.superseded += 1;
+                }
+            }
+            Err(e) => {
+                stats.dropped += 1;
+                debug!("Dropped message for shard {}: {}", target, e);
+            }
+        }
+    }
+
+    fn flush(&mut self, stats: &mut ForwardStats) {
+        for target in 0..self.backlog.len() {
+            let pending: Vec<_> = self.backlog[target].drain().collect();
+            for (topic, (id, payload)) in pending {
+                self.send(target, id, &topic, &payload, stats);
+            }
+        }
+    }
+}
+
+/// Connect to every other shard and forward world traffic seen by `broker` until its link
+/// closes, holding clients to `limits` if given. Must be called inside a Tokio runtime,
+/// which drives the peer connections.
+pub fn spawn_forwarder(cluster: Cluster, broker: &Broker, limits: Option<ClientLimits>) {
+    let (mut link_tx, mut link_rx) = match broker.link("cluster-forwarder") {
+        Ok(link) => link,
+        Err(e) => {
+            warn!("⚠️ Cluster forwarder cannot link to the broker: {}", e);
+            return;
+        }
+    };
+    for filter in [WORLD_TOPIC_FILTER, CLUSTER_TOPIC_FILTER] {
+        if let Err(e) = link_tx.subscribe(filter) {
+            warn!("⚠️ Cluster forwarder cannot subscribe: {}", e);
+            return;
+        }
+    }
+    let mut peers = Peers {
+        clients: (0..cluster.shards.len())
+            .map(|i| (i != cluster.index).then(|| connect_peer(&cluster, i)))
+            .collect(),
+        backlog: vec![HashMap::new(); cluster.shards.len()],
+    };
+    // Messages from other shards are republished through the broker itself so its
+    // clients and world state receive them, retained discovery included
+    let local = connect_peer(&cluster, cluster.index);
+
+    std::thread::spawn(move || {
+        // Keep the link open for as long as the forwarder runs
+        let _link_tx = link_tx;
+        let mut seen = SeenMessages::default();
+        let mut republished = Republished::default();
+        let mut subscribers = Subscribers::default();
+        let mut sequence = Sequence::new(cluster.index);
+        let mut stats = ForwardStats::default();
+        let mut limiter = limits.map(|limits| ClientLimiter::new(limits, Instant::now()));
+        let mut next_flush = Instant::now() + FLUSH_INTERVAL;
+        loop {
+            let deadline = next_flush;
+            let received = link_rx.recv_deadline(deadline);
+            let now = Instant::now();
+            if now >= deadline {
+                peers.flush(&mut stats);
+                republished.expire(now);
+                subscribers.expire(now);
+                if let Some(limiter) = &mut limiter {
+                    for (topic, payload) in limiter.take_coalesced(now) {
+                        let targets = cluster.route(&topic, cluster.index, |shard| {
+                            world_of(&topic)
+                                .is_some_and(|world_id| subscribers.contains(world_id, shard, now))
+                        });
+                        if targets.is_empty() {
+                            continue;
+                        }
+                        let id = sequence.next();
+                        for target in targets {
+                            peers.send(target, id, &topic, &payload, &mut stats);
+                        }
+                    }
+                }
+                next_flush = now + FLUSH_INTERVAL;
+            }
+            let notification = match received {
+                Ok(Some(notification)) => notification,
+                Ok(None) => continue,
+                // The deadline passed without a notification
+                Err(_) if now >= deadline => continue,
+                Err(e) => {
+                    warn!("⚠️ Cluster forwarder link closed: {}", e);
+                    break;
+                }
+            };
+            let Notification::Forward(forward) = notification else {
+                continue;
+            };
+            let Ok(topic) = std::str::from_utf8(&forward.publish.topic) else {
+                continue;
+            };
+            let payload = &forward.publish.payload;
+            if let Some((id, topic)) = MessageId::open(topic) {
+                if !seen.insert(id, now) {
+                    stats.duplicates += 1;
+                    continue;
+                }
+                if let Some(world_id) = world_of(topic).filter(|world_id| cluster.owns(world_id)) {
+                    subscribers.record(world_id, id.shard, now);
+                }
+                // Discovery must reach clients that subscribe later, like the original
+                let retain = topic.ends_with("/info");
+                match local.try_publish(topic, QoS::AtLeastOnce, retain, payload.to_vec()) {
+                    Ok(()) => republished.insert(topic, payload, id, now),
+                    Err(e) => {
+                        stats.dropped += 1;
+                        debug!("Dropped message from shard {}: {}", id.shard, e);
+                    }
+                }
+                continue;
+            }
+            let origin = republished.take(topic, payload);
+            let from = origin.map_or(cluster.index, |id| id.shard);
+            let targets = cluster.route(topic, from, |shard| {
+                world_of(topic).is_some_and(|world_id| subscribers.contains(world_id, shard, now))
+            });
+            if targets.is_empty() {
+                continue;
+            }
+            let id = match origin {
+                Some(id) => id,
+                None => {
+                    if let Some(limiter) = &mut limiter {
+                        if limiter.check(topic, payload, now) != Verdict::Accept {
+                            stats.limited += 1;
+                            continue;
+                        }
+                    }
+                    sequence.next()
+                }
+            };
+            for target in targets {
+                peers.send(target, id, topic, payload, &mut stats);
+            }
+        }
+        info!(
+            "🔀 Cluster forwarder stopped: {} forwarded, {} duplicates, {} dropped, \
+             {} superseded poses, {} over client limits",
+            stats.forwarded, stats.duplicates, stats.dropped, stats.superseded, stats.limited
+        );
+    });
+}
+
+/// Start `shards` shard processes of this binary on consecutive ports from `base_port`,
+/// each with `shard_args`, and stop them all on Ctrl+C or when one of them exits
+pub async fn run_local(shards: usize, base_port: u16, shard_args: &[String]) -> anyhow::Result<()> {
+    if shards == 0 || usize::from(base_port) + shards > usize::from(u16::MAX) + 1 {
+        anyhow::bail!("Cannot start {} shards from port {}", shards, base_port);
+    }
+    let exe = std::env::current_exe()?;
+    let addresses = Cluster::local_addresses(base_port, shards);
+    let mut children = Vec::with_capacity(shards);
+    for index in 0..shards {
+        let child = Command::new(&exe)
+            .args(["--cluster", &addresses, "--shard", &index.to_string()])
+            .args(shard_args)
+            .spawn();
+        match child {
+            Ok(child) => children.push(child),
+            Err(e) => {
+                for mut child in children {
+                    let _ = child.kill();
+                }
+                return Err(e.into());
+            }
+        }
+        info!(
+            "🔀 Started shard {} on port {}",
+            index,
+            usize::from(base_port) + index
+        );
+    }
+    info!("🔀 Local cluster of {} shards: {}", shards, addresses);
+
+    let ctrl_c = tokio::signal::ctrl_c();
+    tokio::pin!(ctrl_c);
+    loop {
+        tokio::select! {
+            _ = &mut ctrl_c => break,
+            _ = tokio::time::sleep(Duration::from_millis(200)) => {}
+        }
+        if let Some(index) = children
+            .iter_mut()
+            .position(|child| child.try_wait().ok().flatten().is_some())
+        {
+            warn!("⚠️ Shard {} exited, stopping the cluster", index);
+            break;
+        }
+    }
+
+    // Shards shut down on their own after Ctrl+C from a terminal; give them a moment
+    let deadline = Instant::now() + Duration::from_secs(3);
+    for mut child in children {
+        while child.try_wait().ok().flatten().is_none() && Instant::now() < deadline {
+            tokio::time::sleep(Duration::from_millis(50)).await;
+        }
+        let _ = child.kill();
+        let _ = child.wait();
+    }
+    info!("👋 Local cluster stopped");
+    Ok(())
+}
+
+fn connect_peer(cluster: &Cluster, peer: usize) -> AsyncClient {
+    let (host, port) = cluster.shards[peer].rsplit_once(':').unwrap();
+    let mut options = MqttOptions::new(
+        format!("iotcraft-shard-{}-to-{}", cluster.index, peer),
+        host,
+        port.parse().unwrap(),
+    );
+    options.set_keep_alive(Duration::from_secs(30));
+    options.set_max_packet_size(MAX_FORWARD_PACKET, MAX_FORWARD_PACKET);
+    let (client, mut eventloop) = AsyncClient::new(options, 1024);
+    let address = cluster.shards[peer].clone();
+    tokio::spawn(async move {
+        let mut connected = false;
+        loop {
+            match eventloop.poll().await {
+                Ok(Event::Incoming(Incoming::ConnAck(_))) => {
+                    connected = true;
+                    info!("🔀 Connected to shard {} at {}", peer, address);
+                }
+                Ok(_) => {}
+                Err(e) => {
+                    if connected {
+                        warn!("⚠️ Lost shard {} at {}: {}", peer, address, e);
+                    }
+                    connected = false;
+                    tokio::time::sleep(Duration::from_secs(1)).await;
+                }
+            }
+        }
+    });
+    client
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn cluster(index: usize) -> Cluster {
+        Cluster::new(&Cluster::local_addresses(1883, 4), index).unwrap()
+    }
+
+    /// World id owned by `shard` of a 4-shard cluster
+    fn world_on(shard: usize) -> String {
+        (0..)
+            .map(|i| format!("world-{i}"))
+            .find(|id| shard_for_world(id, 4) == shard)
+            .unwrap()
+    }
+
+    #[test]
+    fn worlds_spread_over_shards() {
+        // FNV-1a is part of the cluster protocol: clients compute the same owner
+        assert_eq!(
+            shard_for_world("", 4),
+            (0xcbf2_9ce4_8422_2325u64 % 4) as usize
+        );
+        let mut counts = [0usize; 4];
+        for i in 0..4000 {
+            counts[shard_for_world(&format!("world-{i}"), 4)] += 1;
+        }
+        assert!(
+            counts.iter().all(|&n| (800..1200).contains(&n)),
+            "{counts:?}"
+        );
+        assert_eq!(shard_for_world("anything", 1), 0);
+    }
+
+    #[test]
+    fn parses_shard_lists() {
+        let cluster = cluster(2);
+        assert_eq!(cluster.shards.len(), 4);
+        assert_eq!(cluster.port(), 1885);
+        assert!(Cluster::new("a:1,b:2", 2).is_err());
+        assert!(Cluster::new("a:1,b", 0).is_err());
+        assert!(Cluster::new(" , ", 0).is_err());
+    }
+
+    #[test]
+    fn routes_misrouted_traffic_to_the_owner_and_fans_out_discovery() {
+        let home = world_on(1);
+        let owner = cluster(1);
+        let other = cluster(3);
+
+        let pose = format!("iotcraft/worlds/{home}/players/p1/pose");
+        let info = format!("iotcraft/worlds/{home}/info");
+        let reply = format!("iotcraft/worlds/{home}/clients/c1/data");
+
+        let nobody = |_| false;
+        assert_eq!(other.route(&pose, 3, nobody), vec![1]);
+        assert_eq!(other.route(&info, 3, nobody), vec![1]);
+        assert!(owner.route(&pose, 1, nobody).is_empty());
+        assert_eq!(owner.route(&info, 1, nobody), vec![0, 2, 3]);
+        assert_eq!(owner.route(&reply, 1, nobody), vec![0, 2, 3]);
+        assert!(owner.route("devices/announce", 1, nobody).is_empty());
+
+        // The owner passes forwarded traffic on, but never back to where it came from,
+        // and other shards never pass on what they received
+        assert_eq!(owner.route(&info, 3, nobody), vec![0, 2]);
+        assert_eq!(owner.route(&pose, 3, |shard| shard != 2), vec![0]);
+        assert_eq!(owner.route(&pose, 1, |_| true), vec![0, 2, 3]);
+        assert!(other.route(&pose, 1, |_| true).is_empty());
+
+        assert!(owner.tracks(&pose));
+        assert!(!other.tracks(&pose));
+        assert!(other.tracks("devices/announce"));
+    }
+
+    fn id(shard: usize, seq: u64) -> MessageId {
+        MessageId {
+            shard,
+            boot: 1_700_000_000_000,
+            seq,
+        }
+    }
+
+    #[test]
+    fn envelopes_carry_the_message_id() {
+        let topic = "iotcraft/worlds/w/players/p1/pose";
+        let envelope = id(2, 7).envelope(topic);
+        assert_eq!(MessageId::open(&envelope), Some((id(2, 7), topic)));
+        assert_eq!(MessageId::open(topic), None);
+        assert_eq!(MessageId::open("iotcraft/cluster/2/x/7/t"), None);
+        assert_eq!(MessageId::open("iotcraft/cluster/2/1/7"), None);
+    }
+
+    #[test]
+    fn seen_messages_drop_redeliveries_but_not_repeats() {
+        let mut seen = SeenMessages::default();
+        let now = Instant::now();
+        assert!(seen.insert(id(0, 1), now));
+        assert!(!seen.insert(id(0, 1), now + Duration::from_secs(1)));
+        // The same payload published again is a new message
+        assert!(seen.insert(id(0, 2), now));
+        assert!(seen.insert(id(1, 1), now));
+        assert!(seen.insert(id(0, 1), now + SEEN_WINDOW + Duration::from_secs(1)));
+    }
+
+    #[test]
+    fn republished_messages_keep_their_id() {
+        let mut republished = Republished::default();
+        let now = Instant::now();
+        republished.insert("t", b"a", id(2, 1), now);
+        republished.insert("t", b"a", id(3, 1), now);
+        assert_eq!(republished.take("t", b"b"), None);
+        assert_eq!(republished.take("t", b"a"), Some(id(2, 1)));
+        assert_eq!(republished.take("t", b"a"), Some(id(3, 1)));
+        // A client publishing the same payload afterwards is a message of this shard
+        assert_eq!(republished.take("t", b"a"), None);
+
+        republished.insert("t", b"a", id(2, 2), now);
+        republished.expire(now + SEEN_WINDOW);
+        assert_eq!(republished.take("t", b"a"), None);
+    }
+
+    #[test]
+    fn subscribers_expire() {
+        let mut subscribers = Subscribers::default();
+        let now = Instant::now();
+        subscribers.record("w", 2, now);
+        assert!(subscribers.contains("w", 2, now + Duration::from_secs(1)));
+        assert!(!subscribers.contains("w", 3, now));
+        assert!(!subscribers.contains("v", 2, now));
+        assert!(!subscribers.contains("w", 2, now + SUBSCRIBER_WINDOW));
+        subscribers.expire(now + SUBSCRIBER_WINDOW);
+        assert!(subscribers.last_seen.is_empty());
+    }
+}
@@ -1,14 +1,33 @@
-use clap::Parser;
+use clap::{Parser, ValueEnum};
 use config::Config as FileConfig;
 use config::File as ConfigFile;
-use rumqttd::{Broker, Config};
+use rumqttd::{Broker, Config, Notification};
 use std::thread;
 use tokio::signal;
-use tracing::{error, info, warn};
+use tracing::{debug, error, info, warn};
 use tracing_subscriber;
 
+mod client_limits;
+mod cluster;
 mod mdns_service;
+mod metrics;
+mod profile_bench;
+mod profiles;
+mod region;
+mod status_page;
+mod world_state;
+use client_limits::{ClientLimiter, ClientLimits, OverLimitPolicy, Verdict};
+use cluster::Cluster;
 use mdns_service::MdnsService;
+use metrics::Metrics;
+use profiles::TrafficProfile;
+use region::Storage;
+use world_state::{CompactionPolicy, WorldStore};
+
+/// Half-width of the synthetic world served by `--bench-joins`
+const BENCH_WORLD_RADIUS: i32 = 64;
+/// How often the status page's metrics are refreshed
+const STATUS_INTERVAL: std::time::Duration = std::time::Duration::from_secs(1);
 
 #[derive(Parser, Debug)]
 #[command(name = "iotcraft-mqtt-server")]
@@ -25,6 +44,57 @@ struct Args {
     /// Disable mDNS service discovery (useful for online/cloud deployments)
     #[arg(long, conflicts_with = "enable_mdns")]
     disable_mdns: bool,
+
+    /// Measure serving this many concurrent world joins from server-side state, then exit
+    #[arg(long, value_name = "JOINS")]
+    bench_joins: Option<usize>,
+
+    /// Persist shared worlds to this directory and restore them on startup
+    #[arg(long, value_name = "DIR")]
+    world_dir: Option<std::path::PathBuf>,
+
+    /// Tune segment sizes, queues and connection limits for a kind of deployment
+    #[arg(long, value_enum, value_name = "PROFILE")]
+    profile: Option<TrafficProfile>,
+
+    /// Measure router latency and memory under the selected profile for this many
+    /// seconds, then exit
+    #[arg(long, value_name = "SECONDS")]
+    bench_profile: Option<u64>,
+
+    /// Run as one shard of a cluster: `host:port` of every shard, in shard order
+    #[arg(long, value_name = "ADDRS")]
+    cluster: Option<String>,
+
+    /// Index of this shard in `--cluster`
+    #[arg(long, default_value_t = 0, requires = "cluster")]
+    shard: usize,
+
+    /// Start a cluster of this many shards on consecutive ports of this host
+    #[arg(long, value_name = "SHARDS", conflicts_with = "cluster")]
+    local_cluster: Option<usize>,
+
+    /// Port of the status page with active worlds and slow clients (0 disables it);
+    /// shards add their index
+    #[arg(long, default_value_t = 9043)]
+    status_port: u16,
+
+    /// Poses and requests per second each client may have applied, answered or forwarded;
+    /// block edits are never limited (0 disables client limits)
+    #[arg(long, default_value_t = 200.0)]
+    client_rate: f64,
+
+    /// Bytes of poses and requests per second each client may publish into shared worlds
+    #[arg(long, default_value_t = 1024.0 * 1024.0)]
+    client_bytes: f64,
+
+    /// Snapshot and chunk requests per second each client may make
+    #[arg(long, default_value_t = 2.0)]
+    client_requests: f64,
+
+    /// What happens to messages of clients over their budget
+    #[arg(long, value_enum, default_value = "coalesce")]
+    over_limit: OverLimitPolicy,
 }
 
 #[tokio::main]
@@ -38,13 +108,37 @@ async fn main() -> anyhow::Result<()> {
     // Initialize logging
     tracing_subscriber::fmt().init();
 
+    if let Some(joins) = args.bench_joins {
+        let bench = world_state::bench_joins(BENCH_WORLD_RADIUS, joins);
+        info!("📊 {}", bench.report());
+        return Ok(());
+    }
+
+    if let Some(shards) = args.local_cluster {
+        return cluster::run_local(shards, args.port.unwrap_or(1883), &local_shard_args(&args))
+            .await;
+    }
+    let cluster = match &args.cluster {
+        Some(shards) => {
+            let cluster = Cluster::new(shards, args.shard)?;
+            info!(
+                "🔀 Running as shard {} of {}",
+                cluster.index,
+                cluster.shards.len()
+            );
+            Some(cluster)
+        }
+        None => None,
+    };
+    let listen_port = args.port.or(cluster.as_ref().map(Cluster::port));
+
     info!(
         "Starting IoTCraft MQTT Server (mDNS: {})",
         if enable_mdns { "enabled" } else { "disabled" }
     );
 
     // Check if another instance might be running on the requested port
-    if let Some(port) = args.port {
+    if let Some(port) = listen_port {
         if let Ok(_) = std::net::TcpStream::connect(format!("127.0.0.1:{}", port)) {
             warn!("⚠️ Another service appears to be running on port {}", port);
             warn!("💡 Consider using a different port or stopping the existing service");
@@ -52,7 +146,7 @@ async fn main() -> anyhow::Result<()> {
     }
 
     // Load broker configuration
-    let (rumq_cfg, actual_port): (Config, u16) = if let Some(port) = args.port {
+    let (file_cfg, actual_port): (FileConfig, u16) = if let Some(port) = listen_port {
         info!("Using dynamic port configuration: {}", port);
 
         // Create a minimal dynamic configuration
@@ -78,9 +172,11 @@ async fn main() -> anyhow::Result<()> {
             dynamic_filters = true
 
             [console]
-            listen = "0.0.0.0:3031"
+            listen = "0.0.0.0:{}"
             "#,
-            port
+            port,
+            // Shards on one host need their own console
+            3031 + cluster.as_ref().map_or(0, |cluster| cluster.index)
         );
 
         let config = FileConfig::builder()
@@ -89,8 +185,6 @@ async fn main() -> anyhow::Result<()> {
                 config::FileFormat::Toml,
             ))
             .build()
-            .unwrap()
-            .try_deserialize()
             .unwrap();
 
         (config, port)
@@ -99,16 +193,36 @@ async fn main() -> anyhow::Result<()> {
         let config = FileConfig::builder()
             .add_source(ConfigFile::with_name("rumqttd.toml"))
             .build()
-            .unwrap()
-            .try_deserialize()
             .unwrap();
         // Default port from rumqttd.toml is 1883
         (config, 1883)
     };
+    let file_cfg = match args.profile {
+        Some(profile) => {
+            info!("🎛️ Applying {:?} traffic profile", profile);
+            profiles::apply(file_cfg, profile)?
+        }
+        None => file_cfg,
+    };
+    let rumq_cfg: Config = file_cfg.try_deserialize()?;
+
+    if let Some(seconds) = args.bench_profile {
+        let bench = profile_bench::run(
+            rumq_cfg,
+            args.profile,
+            std::time::Duration::from_secs(seconds),
+        );
+        info!("📊 {}", bench.report());
+        return Ok(());
+    }
 
     // Initialize mDNS service before starting broker
     let mdns_service = if enable_mdns {
-        match MdnsService::new() {
+        let service = match &cluster {
+            Some(cluster) => MdnsService::for_shard(cluster),
+            None => MdnsService::new(),
+        };
+        match service {
             Ok(service) => {
                 info!("📡 mDNS service initialized");
                 Some(service)
@@ -147,7 +261,10 @@ async fn main() -> anyhow::Result<()> {
     }
 
     // Create a link to receive broker notifications
-    let (mut _link_tx, mut link_rx) = broker.link("mqtt-server").unwrap();
+    let (mut link_tx, mut link_rx) = broker.link("mqtt-server").unwrap();
+    if let Some(cluster) = &cluster {
+        cluster::spawn_forwarder(cluster.clone(), &broker, client_limits(&args));
+    }
 
     // Create a shutdown signal for the broker thread
     let (shutdown_tx, mut shutdown_rx) = tokio::sync::mpsc::channel::<()>(1);
@@ -184,6 +301,121 @@ async fn main() -> anyhow::Result<()> {
     });
 
     info!("🚀 MQTT broker started on port {}", actual_port);
+    tokio::spawn(advertise_features(actual_port));
+
+    // Keep authoritative world state from the IoTCraft topics and answer snapshot and
+    // chunk requests from it
+    if let Err(e) = link_tx.subscribe(world_state::WORLD_TOPIC_FILTER) {
+        error!("❌ Failed to subscribe world state link: {}", e);
+    }
+    // Shards keep their worlds apart so each restores only what it owns
+    let world_dir = args.world_dir.as_ref().map(|dir| match &cluster {
+        Some(cluster) => dir.join(format!("shard-{}", cluster.index)),
+        None => dir.clone(),
+    });
+    let mut store = match &world_dir {
+        Some(dir) => match Storage::open(dir)
+            .and_then(|storage| WorldStore::with_storage(storage, CompactionPolicy::default()))
+        {
+            Ok(store) => {
+                info!(
+                    "💾 Persisting worlds to {} ({} restored)",
+                    dir.display(),
+                    store.world_count()
+                );
+                store
+            }
+            Err(e) => {
+                error!("❌ Cannot use world directory {}: {}", dir.display(), e);
+                WorldStore::default()
+            }
+        },
+        None => WorldStore::default(),
+    };
+    let limits = client_limits(&args);
+    let status = status_page::SharedStatus::default();
+    if args.status_port != 0 {
+        let port = args.status_port + cluster.as_ref().map_or(0, |cluster| cluster.index as u16);
+        let status = status.clone();
+        tokio::spawn(async move {
+            if let Err(e) = status_page::serve(port, status).await {
+                warn!("⚠️ Status page unavailable on port {}: {}", port, e);
+            }
+        });
+    }
+    thread::spawn(move || {
+        let mut metrics = Metrics::new(std::time::Instant::now());
+        let mut limiter =
+            limits.map(|limits| ClientLimiter::new(limits, std::time::Instant::now()));
+        let mut next_sample = std::time::Instant::now() + STATUS_INTERVAL;
+        loop {
+            let deadline = next_sample;
+            let received = link_rx.recv_deadline(deadline);
+            let now = std::time::Instant::now();
+            // Every pass, including idle timeouts, so pending edits are compacted and
+            // persisted on time even when no message arrives
+            store.maintain(now);
+            if now >= deadline {
+                if let Some(limiter) = &mut limiter {
+                    // Poses held back from clients over budget, now within it again
+                    for (topic, payload) in limiter.take_coalesced(now) {
+                        store.handle(&topic, &payload);
+                    }
+                }
+                for (topic, payload) in metrics.probes(now) {
+                    if let Err(e) = link_tx.publish(topic, payload) {
+                        warn!("⚠️ Failed to publish latency probe: {}", e);
+                    }
+                }
+                let mut snapshot = metrics.sample(&store, now);
+                if let Some(limiter) = &limiter {
+                    snapshot.limits = limiter.stats;
+                    snapshot.quarantined = limiter.quarantined(now);
+                }
+                if let Ok(mut status) = status.lock() {
+                    *status = snapshot;
+                }
+                next_sample = now + STATUS_INTERVAL;
+            }
+            let notification = match received {
+                Ok(Some(notification)) => notification,
+                Ok(None) => continue,
+                // The deadline passed without a notification
+                Err(_) if now >= deadline => continue,
+                Err(e) => {
+                    warn!("⚠️ World state link closed: {}", e);
+                    break;
+                }
+            };
+            let Notification::Forward(forward) = notification else {
+                continue;
+            };
+            let Ok(topic) = std::str::from_utf8(&forward.publish.topic) else {
+                continue;
+            };
+            // Worlds of other shards are kept by their owners
+            if !cluster.as_ref().is_none_or(|cluster| cluster.tracks(topic)) {
+                continue;
+            }
+            metrics.observe(topic, &forward.publish.payload, now, wall_clock_ms());
+            // Only poses and requests are ever held back: clients have applied every edit
+            // rumqttd routed, so the state must too
+            if let Some(limiter) = &mut limiter {
+                if limiter.check(topic, &forward.publish.payload, now) != Verdict::Accept {
+                    continue;
+                }
+            }
+            if let Some(reply) = store.handle(topic, &forward.publish.payload) {
+                if let Err(e) = link_tx.publish(reply.topic, reply.payload) {
+                    warn!("⚠️ Failed to publish world state reply: {}", e);
+                }
+            }
+        }
+        info!(
+            "🌍 World state stopped after {} messages ({} snapshots, {} chunk requests served)",
+            store.stats.messages, store.stats.snapshots_served, store.stats.chunk_requests
+        );
+    });
 
     // Register mDNS services after broker is started
     if let Some(ref service) = mdns_service {
@@ -248,3 +480,89 @@ async fn main() -> anyhow::Result<()> {
     // Force exit to ensure clean termination
     std::process::exit(0);
 }
+
+/// Arguments passed on to every shard started by `--local-cluster`
+fn local_shard_args(args: &Args) -> Vec<String> {
+    let mut shard_args = Vec::new();
+    if !args.enable_mdns || args.disable_mdns {
+        shard_args.push("--disable-mdns".to_string());
+    }
+    if let Some(profile) = args.profile {
+        if let Some(value) = profile.to_possible_value() {
+            shard_args.extend(["--profile".to_string(), value.get_name().to_string()]);
+        }
+    }
+    if let Some(dir) = &args.world_dir {
+        // Each shard persists to its own subdirectory
+        shard_args.extend(["--world-dir".to_string(), dir.display().to_string()]);
+    }
+    // Each shard serves its status page on this port plus its index
+    shard_args.extend(["--status-port".to_string(), args.status_port.to_string()]);
+    shard_args.extend([
+        "--client-rate".to_string(),
+        args.client_rate.to_string(),
+        "--client-bytes".to_string(),
+        args.client_bytes.to_string(),
+        "--client-requests".to_string(),
+        args.client_requests.to_string(),
+    ]);
+    if let Some(value) = args.over_limit.to_possible_value() {
+        shard_args.extend(["--over-limit".to_string(), value.get_name().to_string()]);
+    }
+    shard_args
+}
+
+/// Publish the retained feature advertisement through a short-lived local client; the
+/// broker's own link cannot publish retained messages
+async fn advertise_features(port: u16) {
+    use rumqttc::{AsyncClient, Event, Incoming, MqttOptions, QoS};
+
+    let mut options = MqttOptions::new("mqtt-server-features", "127.0.0.1", port);
+    options.set_keep_alive(std::time::Duration::from_secs(5));
+    let (client, mut eventloop) = AsyncClient::new(options, 10);
+    let payload = world_state::features();
+    if let Err(e) = client
+        .publish(world_state::FEATURES_TOPIC, QoS::AtLeastOnce, true, payload)
+        .await
+    {
+        warn!("⚠️ Cannot advertise broker features: {}", e);
+        return;
+    }
+    // The broker thread may still be binding its listener; retry the connection a few times
+    for _ in 0..20 {
+        match eventloop.poll().await {
+            Ok(Event::Incoming(Incoming::PubAck(_))) => {
+                info!(
+                    "📣 Advertised broker features on {}",
+                    world_state::FEATURES_TOPIC
+                );
+                let _ = client.disconnect().await;
+                return;
+            }
+            Ok(_) => {}
+            Err(e) => {
+                debug!("Feature advertisement not delivered yet: {}", e);
+                tokio::time::sleep(std::time::Duration::from_millis(500)).await;
+            }
+        }
+    }
+    warn!("⚠️ Broker features were not advertised");
+}
+
+/// Per-client budgets from the command line; `None` when disabled
+fn client_limits(args: &Args) -> Option<ClientLimits> {
+    (args.client_rate > 0.0).then(|| ClientLimits {
+        messages_per_sec: args.client_rate,
+        bytes_per_sec: args.client_bytes,
+        requests_per_sec: args.client_requests,
+        policy: args.over_limit,
+        ..ClientLimits::default()
+    })
+}
+
+/// Milliseconds since the Unix epoch, the clock of pose timestamps
+fn wall_clock_ms() -> u64 {
+    std::time::SystemTime::now()
+        .duration_since(std::time::UNIX_EPOCH)
+        .map_or(0, |elapsed| elapsed.as_millis() as u64)
+}
@@ -1,5 +1,6 @@
 //! mDNS service registration for IoTCraft MQTT server discovery
 
+use crate::cluster::Cluster;
 use anyhow::Result;
 use mdns_sd::{ServiceDaemon, ServiceInfo};
 use tracing::{error, info, warn};
@@ -10,6 +11,8 @@ pub struct MdnsService {
     service_name: String,
     mqtt_service_type: String,
     iotcraft_service_type: String,
+    /// Shard metadata added to the IoTCraft service when running in a cluster
+    shard_properties: Vec<(&'static str, String)>,
 }
 
 impl MdnsService {
@@ -30,9 +33,24 @@ impl MdnsService {
             service_name,
             mqtt_service_type,
             iotcraft_service_type,
+            shard_properties: Vec::new(),
         })
     }
 
+    /// Create the mDNS service of one cluster shard. Every shard registers under its own
+    /// name and lists the whole cluster, so clients can find the shard owning a world.
+    pub fn for_shard(cluster: &Cluster) -> Result<Self> {
+        let mut service = Self::new()?;
+        service.service_name = format!("iotcraft-mqtt-server-shard-{}", cluster.index);
+        service.shard_properties = vec![
+            ("shard", cluster.index.to_string()),
+            ("shards", cluster.shards.len().to_string()),
+            ("cluster", cluster.shards.join(",")),
+            ("shard-hash", "fnv1a64".to_string()),
+        ];
+        Ok(service)
+    }
+
     /// Register the MQTT broker for discovery
     pub async fn register(&self, port: u16, enable_mdns: bool) -> Result<()> {
         if !enable_mdns {
@@ -135,20 +153,26 @@ impl MdnsService {
         port: u16,
         version: &str,
     ) -> Result<()> {
+        let mut properties = vec![
+            ("version", version),
+            ("service", "iotcraft-mqtt-server"),
+            ("description", "IoTCraft MQTT Broker"),
+            ("features", "mqtt,desktop,voxel-world"),
+            ("protocol", "MQTT"),
+            ("type", "mqtt-broker"),
+        ];
+        properties.extend(
+            self.shard_properties
+                .iter()
+                .map(|(key, value)| (*key, value.as_str())),
+        );
         let service_info = ServiceInfo::new(
             &self.iotcraft_service_type,
             &self.service_name,
             hostname,
             addresses,
             port,
-            &[
-                ("version", version),
-                ("service", "iotcraft-mqtt-server"),
-                ("description", "IoTCraft MQTT Broker"),
-                ("features", "mqtt,desktop,voxel-world"),
-                ("protocol", "MQTT"),
-                ("type", "mqtt-broker"),
-            ][..],
+            &properties[..],
         )
         .map_err(|e| anyhow::anyhow!("Failed to create IoTCraft service info: {}", e))?;
 
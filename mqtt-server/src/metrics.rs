@@ -0,0 +1,745 @@
+//! IoTCraft metrics collected from the broker link.
+//!
+//! rumqttd's own Prometheus exporter and console only know about connections and
+//! subscriptions. The world state link sees every IoTCraft publish, so it also feeds a
+//! [`Metrics`] collector with what operators care about: which worlds are active and how
+//! busy they are, how many block edits and poses flow through them, how large their
+//! snapshots are, and which clients fall behind.
+//!
+//! Two latencies are kept per client:
+//! - delivery lag, how far the broker's deliveries to the client are behind. Each client
+//!   is sent a probe on `iotcraft/worlds/{world}/clients/{client}/probe` and echoes it on
+//!   `iotcraft/worlds/{world}/players/{client}/probe`; the round trip is timed on the
+//!   server's clock. The probe waits behind everything queued for the client, and an
+//!   unanswered probe counts with its age, so a consumer that falls behind shows up here.
+//!   Clients that never answered a probe have none.
+//! - publish latency, the age of a pose when the broker routes it, taken from the pose's
+//!   `ts` (milliseconds since the Unix epoch). It includes the clock offset between client
+//!   and server, so only its trend means anything: a client whose latency keeps growing is
+//!   publishing from a backed-up connection.
+
+use crate::client_limits::LimitStats;
+use crate::world_state::{WorldStore, WorldTopic, parse_topic};
+use serde::{Deserialize, Serialize};
+use std::collections::HashMap;
+use std::fmt::Write;
+use std::time::{Duration, Instant};
+
+/// Smoothing of per-second rates; higher follows changes faster
+const RATE_SMOOTHING: f64 = 0.5;
+/// Smoothing of client latencies
+const LAG_SMOOTHING: f64 = 0.2;
+/// Clients whose delivery lag exceeds this are flagged as slow
+pub const SLOW_CLIENT_LAG_MS: f64 = 500.0;
+/// How often each client is probed
+const PROBE_INTERVAL: Duration = Duration::from_secs(2);
+/// Unanswered probes are sent again after this, in case the first one was lost
+const PROBE_RETRY: Duration = Duration::from_secs(5);
+/// Clients silent this long are dropped from the status
+const CLIENT_EXPIRY: Duration = Duration::from_secs(30);
+/// Most clients listed in the status, slowest first
+const MAX_LISTED_CLIENTS: usize = 100;
+
+/// Exponentially smoothed per-second rate of a growing counter
+#[derive(Debug, Default, Clone, Copy)]
+struct Rate {
+    last: u64,
+    per_sec: f64,
+}
+
+impl Rate {
+    fn update(&mut self, count: u64, elapsed: Duration) {
+        let secs = elapsed.as_secs_f64();
+        if secs > 0.0 {
+            let current = count.saturating_sub(self.last) as f64 / secs;
+            self.per_sec += RATE_SMOOTHING * (current - self.per_sec);
+        }
+        self.last = count;
+    }
+}
+
+#[derive(Debug, Default)]
+struct WorldCounters {
+    messages: u64,
+    bytes: u64,
+    message_rate: Rate,
+    edit_rate: Rate,
+    pose_rate: Rate,
+    /// Last known snapshot size, kept while edits wait for compaction
+    snapshot_bytes: usize,
+}
+
+/// Probe waiting for its echo
+#[derive(Debug, Clone, Copy)]
+struct Probe {
+    seq: u64,
+    sent: Instant,
+    /// First send of an unanswered probe, kept when it is sent again
+    waiting_since: Instant,
+}
+
+#[derive(Debug)]
+struct ClientCounters {
+    world_id: String,
+    poses: u64,
+    pose_rate: Rate,
+    publish_latency_ms: f64,
+    max_publish_latency_ms: f64,
+    /// Smoothed probe round trip; `None` until the client answers a probe
+    delivery_lag_ms: Option<f64>,
+    max_delivery_lag_ms: f64,
+    probe: Option<Probe>,
+    last_probe: Option<Instant>,
+    last_seen: Instant,
+}
+
+impl ClientCounters {
+    /// Delivery lag, counting an unanswered probe with its age
+    fn delivery_lag_ms(&self, now: Instant) -> Option<f64> {
+        let lag = self.delivery_lag_ms?;
+        let waiting = self.probe.map_or(0.0, |probe| {
+            now.duration_since(probe.waiting_since).as_secs_f64() * 1000.0
+        });
+        Some(lag.max(waiting))
+    }
+}
+
+#[derive(Deserialize)]
+struct PoseTimestamp {
+    ts: Option<u64>,
+}
+
+#[derive(Serialize, Deserialize)]
+struct ProbeMessage {
+    seq: u64,
+}
+
+#[derive(Debug, Clone, Default, Serialize)]
+pub struct WorldStatus {
+    pub world_id: String,
+    pub players: usize,
+    pub blocks: usize,
+    pub snapshot_bytes: usize,
+    pub messages_per_sec: f64,
+    pub block_edits_per_sec: f64,
+    pub poses_per_sec: f64,
+    /// Pose deliveries per second: every pose goes to each other player in the world
+    pub pose_fanout_per_sec: f64,
+}
+
+#[derive(Debug, Clone, Default, Serialize)]
+pub struct ClientStatus {
+    pub client_id: String,
+    pub world_id: String,
+    pub poses_per_sec: f64,
+    /// Probe round trip through the broker and the client
+    pub delivery_lag_ms: Option<f64>,
+    pub max_delivery_lag_ms: f64,
+    /// Age of the client's poses when routed, clock offset included
+    pub publish_latency_ms: f64,
+    pub max_publish_latency_ms: f64,
+    pub idle_secs: f64,
+    pub slow: bool,
+}
+
+#[derive(Debug, Clone, Default, Serialize)]
+pub struct Totals {
+    pub messages: u64,
+    pub bytes: u64,
+    pub messages_per_sec: f64,
+    pub active_worlds: usize,
+    pub players: usize,
+    pub block_edits_per_sec: f64,
+    pub pose_fanout_per_sec: f64,
+    pub snapshots_served: u64,
+    pub chunk_requests: u64,
+    pub bytes_served: u64,
+    pub slow_clients: usize,
+}
+
+/// Point-in-time view served by the status page, hottest worlds and slowest clients first
+#[derive(Debug, Clone, Default, Serialize)]
+pub struct StatusSnapshot {
+    pub uptime_secs: f64,
+    pub totals: Totals,
+    pub worlds: Vec<WorldStatus>,
+    pub clients: Vec<ClientStatus>,
+    /// Actions taken on clients over their publish budget
+    pub limits: LimitStats,
+    /// Clients whose messages are currently ignored
+    pub quarantined: Vec<String>,
+}
+
+/// Collects IoTCraft metrics from the publishes routed to the world state link
+#[derive(Debug)]
+pub struct Metrics {
+    started: Instant,
+    last_sample: Instant,
+    messages: u64,
+    bytes: u64,
+    message_rate: Rate,
+    worlds: HashMap<String, WorldCounters>,
+    clients: HashMap<String, ClientCounters>,
+    probe_seq: u64,
+}
+
+impl Metrics {
+    pub fn new(now: Instant) -> Self {
+        Self {
+            started: now,
+            last_sample: now,
+            messages: 0,
+            bytes: 0,
+            message_rate: Rate::default(),
+            worlds: HashMap::new(),
+            clients: HashMap::new(),
+            probe_seq: 0,
+        }
+    }
+
+    /// Count one publish; `wall_ms` is the current time in milliseconds since the Unix
+    /// epoch, compared against pose timestamps
+    pub fn observe(&mut self, topic: &str, payload: &[u8], now: Instant, wall_ms: u64) {
+        let Some((world_id, kind)) = parse_topic(topic) else {
+            return;
+        };
+        self.messages += 1;
+        self.bytes += payload.len() as u64;
+        let world = self.worlds.entry(world_id.to_string()).or_default();
+        world.messages += 1;
+        world.bytes += payload.len() as u64;
+
+        let player_id = match kind {
+            WorldTopic::Pose(player_id) => player_id,
+            WorldTopic::ProbeReply(player_id) => {
+                self.probe_answered(player_id, payload, now);
+                return;
+            }
+            _ => return,
+        };
+        let client = self
+            .clients
+            .entry(player_id.to_string())
+            .or_insert_with(|| ClientCounters {
+                world_id: world_id.to_string(),
+                poses: 0,
+                pose_rate: Rate::default(),
+                publish_latency_ms: 0.0,
+                max_publish_latency_ms: 0.0,
+                delivery_lag_ms: None,
+                max_delivery_lag_ms: 0.0,
+                probe: None,
+                last_probe: None,
+                last_seen: now,
+            });
+        if client.world_id != world_id {
+            client.world_id = world_id.to_string();
+        }
+        client.poses += 1;
+        client.last_seen = now;
+        if let Ok(PoseTimestamp { ts: Some(ts) }) = serde_json::from_slice(payload) {
+            let latency = wall_ms as f64 - ts as f64;
+            client.publish_latency_ms = if client.poses == 1 {
+                latency
+            } else {
+                client.publish_latency_ms + LAG_SMOOTHING * (latency - client.publish_latency_ms)
+            };
+            client.max_publish_latency_ms = client.max_publish_latency_ms.max(latency);
+        }
+    }
+
+    fn probe_answered(&mut self, client_id: &str, payload: &[u8], now: Instant) {
+        let Ok(ProbeMessage { seq }) = serde_json::from_slice(payload) else {
+            return;
+        };
+        let Some(client) = self.clients.get_mut(client_id) else {
+            return;
+        };
+        // Late echoes of probes sent again are ignored
+        let Some(probe) = client.probe.filter(|probe| probe.seq == seq) else {
+            return;
+        };
+        client.probe = None;
+        let lag = now.duration_since(probe.sent).as_secs_f64() * 1000.0;
+        client.delivery_lag_ms = Some(match client.delivery_lag_ms {
+            Some(smoothed) => smoothed + LAG_SMOOTHING * (lag - smoothed),
+            None => lag,
+        });
+        client.max_delivery_lag_ms = client.max_delivery_lag_ms.max(lag);
+    }
+
+    /// Probes due now, as topic and payload: one per client every [`PROBE_INTERVAL`], and
+    /// again after [`PROBE_RETRY`] while unanswered
+    pub fn probes(&mut self, now: Instant) -> Vec<(String, Vec<u8>)> {
+        let mut probes = Vec::new();
+        for (client_id, client) in &mut self.clients {
+            let due = match client.probe {
+                Some(probe) => now.duration_since(probe.sent) >= PROBE_RETRY,
+                None => client
+                    .last_probe
+                    .is_none_or(|at| now.duration_since(at) >= PROBE_INTERVAL),
+            };
+            if !due {
+                continue;
+            }
+            self.probe_seq += 1;
+            client.probe = Some(Probe {
+                seq: self.probe_seq,
+                sent: now,
+                waiting_since: client.probe.map_or(now, |probe| probe.waiting_since),
+            });
+            client.last_probe = Some(now);
+            let topic = format!(
+                "iotcraft/worlds/{}/clients/{}/probe",
+                client.world_id, client_id
+            );
+            let payload = serde_json::to_vec(&ProbeMessage {
+                seq: self.probe_seq,
+            })
+            .unwrap_or_default();
+            probes.push((topic, payload));
+        }
+        probes
+    }
+
+    /// Update rates and build the status from the collected counters and `store`
+    pub fn sample(&mut self, store: &WorldStore, now: Instant) -> StatusSnapshot {
+        let elapsed = now.duration_since(self.last_sample);
+        self.last_sample = now;
+        self.message_rate.update(self.messages, elapsed);
+        self.clients
+            .retain(|_, client| now.duration_since(client.last_seen) < CLIENT_EXPIRY);
+        // Worlds removed from the store (unpublished) are no longer reported
+        self.worlds
+            .retain(|world_id, _| store.world(world_id).is_some());
+
+        let mut totals = Totals {
+            messages: self.messages,
+            bytes: self.bytes,
+            messages_per_sec: self.message_rate.per_sec,
+            snapshots_served: store.stats.snapshots_served,
+            chunk_requests: store.stats.chunk_requests,
+            bytes_served: store.stats.bytes_served,
+            ..Totals::default()
+        };
+        let mut worlds = Vec::with_capacity(store.world_count());
+        for (world_id, world) in store.worlds() {
+            let counters = self.worlds.entry(world_id.to_string()).or_default();
+            counters.message_rate.update(counters.messages, elapsed);
+            counters.edit_rate.update(world.edit_count(), elapsed);
+            counters.pose_rate.update(world.pose_count(), elapsed);
+            if let Some(bytes) = world.snapshot_bytes() {
+                counters.snapshot_bytes = bytes;
+            }
+            let players = world.player_count();
+            let status = WorldStatus {
+                world_id: world_id.to_string(),
+                players,
+                blocks: world.block_count(),
+                snapshot_bytes: counters.snapshot_bytes,
+                messages_per_sec: counters.message_rate.per_sec,
+                block_edits_per_sec: counters.edit_rate.per_sec,
+                poses_per_sec: counters.pose_rate.per_sec,
+                pose_fanout_per_sec: counters.pose_rate.per_sec * players.saturating_sub(1) as f64,
+            };
+            if status.players > 0 || status.messages_per_sec >= 0.01 {
+                totals.active_worlds += 1;
+            }
+            totals.players += status.players;
+            totals.block_edits_per_sec += status.block_edits_per_sec;
+            totals.pose_fanout_per_sec += status.pose_fanout_per_sec;
+            worlds.push(status);
+        }
+        worlds.sort_by(|a, b| b.messages_per_sec.total_cmp(&a.messages_per_sec));
+
+        let mut clients: Vec<ClientStatus> = self
+            .clients
+            .iter_mut()
+            .map(|(client_id, client)| {
+                client.pose_rate.update(client.poses, elapsed);
+                let delivery_lag_ms = client.delivery_lag_ms(now);
+                ClientStatus {
+                    client_id: client_id.clone(),
+                    world_id: client.world_id.clone(),
+                    poses_per_sec: client.pose_rate.per_sec,
+                    delivery_lag_ms,
+                    max_delivery_lag_ms: client
+                        .max_delivery_lag_ms
+                        .max(delivery_lag_ms.unwrap_or(0.0)),
+                    publish_latency_ms: client.publish_latency_ms,
+                    max_publish_latency_ms: client.max_publish_latency_ms,
+                    idle_secs: now.duration_since(client.last_seen).as_secs_f64(),
+                    slow: delivery_lag_ms.is_some_and(|lag| lag > SLOW_CLIENT_LAG_MS),
+                }
+            })
+            .collect();
+        totals.slow_clients = clients.iter().filter(|client| client.slow).count();
+        let lag = |client: &ClientStatus| client.delivery_lag_ms.unwrap_or(-1.0);
+        clients.sort_by(|a, b| lag(b).total_cmp(&lag(a)));
+        clients.truncate(MAX_LISTED_CLIENTS);
+
+        StatusSnapshot {
+            uptime_secs: now.duration_since(self.started).as_secs_f64(),
+            totals,
+            worlds,
+            clients,
+            ..StatusSnapshot::default()
+        }
+    }
+}
+
+/// Escape a Prometheus label value
+fn label(value: &str) -> String {
+    value
+        .replace('\\', "\\\\")
+        .replace('"', "\\\"")
+        .replace('\n', "\\n")
+}
+
+/// Append one Prometheus metric family with `(labels, value)` samples
+fn family(out: &mut String, name: &str, kind: &str, help: &str, samples: &[(String, f64)]) {
+    let _ = writeln!(out, "# HELP {name} {help}");
+    let _ = writeln!(out, "# TYPE {name} {kind}");
+    for (labels, value) in samples {
+        let _ = writeln!(out, "{name}{labels} {value}");
+    }
+}
+
+impl StatusSnapshot {
+    /// Prometheus text exposition of the status
+    pub fn to_prometheus(&self) -> String {
+        let mut out = String::new();
+        let totals = &self.totals;
+        let single = |value: f64| [(String::new(), value)];
+        family(
+            &mut out,
+            "iotcraft_messages_total",
+            "counter",
+            "IoTCraft world messages routed",
+            &single(totals.messages as f64),
+        );
+        family(
+            &mut out,
+            "iotcraft_messages_per_second",
+            "gauge",
+            "IoTCraft world messages routed per second",
+            &single(totals.messages_per_sec),
+        );
+        family(
+            &mut out,
+            "iotcraft_active_worlds",
+            "gauge",
+            "Worlds with players or recent traffic",
+            &single(totals.active_worlds as f64),
+        );
+        family(
+            &mut out,
+            "iotcraft_players",
+            "gauge",
+            "Players with a known pose across all worlds",
+            &single(totals.players as f64),
+        );
+        family(
+            &mut out,
+            "iotcraft_slow_clients",
+            "gauge",
+            "Clients whose delivery lag exceeds the slow threshold",
+            &single(totals.slow_clients as f64),
+        );
+        family(
+            &mut out,
+            "iotcraft_snapshots_served_total",
+            "counter",
+            "World snapshots served to joining clients",
+            &single(totals.snapshots_served as f64),
+        );
+        family(
+            &mut out,
+            "iotcraft_bytes_served_total",
+            "counter",
+            "Bytes of snapshots and chunks served",
+            &single(totals.bytes_served as f64),
+        );
+
+        let limits = &self.limits;
+        let actions = [
+            ("dropped", limits.dropped),
+            ("coalesced", limits.coalesced),
+            ("quarantined", limits.quarantined_messages),
+        ];
+        let actions: Vec<_> = actions
+            .iter()
+            .map(|(action, count)| (format!("{{action=\"{action}\"}}"), *count as f64))
+            .collect();
+        family(
+            &mut out,
+            "iotcraft_client_limit_messages_total",
+            "counter",
+            "Messages of clients over their publish budget, by action taken",
+            &actions,
+        );
+        family(
+            &mut out,
+            "iotcraft_client_quarantines_total",
+            "counter",
+            "Clients put into quarantine for staying over their publish budget",
+            &single(limits.quarantines as f64),
+        );
+        family(
+            &mut out,
+            "iotcraft_quarantined_clients",
+            "gauge",
+            "Clients whose messages are currently ignored",
+            &single(self.quarantined.len() as f64),
+        );
+
+        let per_world = |value: fn(&WorldStatus) -> f64| -> Vec<(String, f64)> {
+            self.worlds
+                .iter()
+                .map(|w| (format!("{{world=\"{}\"}}", label(&w.world_id)), value(w)))
+                .collect()
+        };
+        family(
+            &mut out,
+            "iotcraft_world_players",
+            "gauge",
+            "Players in the world",
+            &per_world(|w| w.players as f64),
+        );
+        family(
+            &mut out,
+            "iotcraft_world_blocks",
+            "gauge",
+            "Blocks in the world",
+            &per_world(|w| w.blocks as f64),
+        );
+        family(
+            &mut out,
+            "iotcraft_world_snapshot_bytes",
+            "gauge",
+            "Size of the world snapshot served to joining clients",
+            &per_world(|w| w.snapshot_bytes as f64),
+        );
+        family(
+            &mut out,
+            "iotcraft_world_block_edits_per_second",
+            "gauge",
+            "Block edits applied per second",
+            &per_world(|w| w.block_edits_per_sec),
+        );
+        family(
+            &mut out,
+            "iotcraft_world_pose_fanout_per_second",
+            "gauge",
+            "Pose deliveries per second to the other players of the world",
+            &per_world(|w| w.pose_fanout_per_sec),
+        );
+        let client_labels = |c: &ClientStatus| {
+            format!(
+                "{{client=\"{}\",world=\"{}\"}}",
+                label(&c.client_id),
+                label(&c.world_id)
+            )
+        };
+        let delivery: Vec<_> = self
+            .clients
+            .iter()
+            .filter_map(|c| Some((client_labels(c), c.delivery_lag_ms?)))
+            .collect();
+        family(
+            &mut out,
+            "iotcraft_client_delivery_lag_milliseconds",
+            "gauge",
+            "Round trip of a broker probe through the client, including its queued deliveries",
+            &delivery,
+        );
+        let publish: Vec<_> = self
+            .clients
+            .iter()
+            .map(|c| (client_labels(c), c.publish_latency_ms))
+            .collect();
+        family(
+            &mut out,
+            "iotcraft_client_publish_latency_milliseconds",
+            "gauge",
+            "Age of the client's poses when routed, including the client's clock offset",
+            &publish,
+        );
+        out
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn pose(ts: u64) -> Vec<u8> {
+        format!(
+            r#"{{"player_id":"p","player_name":"P","pos":[0,2,0],"yaw":0,"pitch":0,"ts":{ts}}}"#
+        )
+        .into_bytes()
+    }
+
+    fn echo(metrics: &mut Metrics, topic: &str, payload: &[u8], now: Instant) {
+        let reply = topic.replace("/clients/", "/players/");
+        metrics.observe(&reply, payload, now, 0);
+    }
+
+    #[test]
+    fn tracks_world_rates_fanout_and_publish_latency() {
+        let start = Instant::now();
+        let mut store = WorldStore::default();
+        let mut metrics = Metrics::new(start);
+
+        // Three players in one world, each posing ten times over one second
+        for tick in 0..10u64 {
+            for player in ["a", "b", "c"] {
+                let topic = format!("iotcraft/worlds/w1/players/{player}/pose");
+                // Player c's poses arrive 800 ms after their timestamp
+                let lag = if player == "c" { 800 } else { 20 };
+                let payload = pose(1_000_000 + tick * 100);
+                store.handle(&topic, &payload);
+                metrics.observe(&topic, &payload, start, 1_000_000 + tick * 100 + lag);
+            }
+        }
+        let placed = br#"{"player_id":"a","player_name":"A","timestamp":0,"change":{"Placed":{"x":1,"y":2,"z":3,"block_type":"Stone"}}}"#;
+        store.handle("iotcraft/worlds/w1/state/blocks/placed", placed);
+        metrics.observe("iotcraft/worlds/w1/state/blocks/placed", placed, start, 0);
+
+        let status = metrics.sample(&store, start + Duration::from_secs(1));
+        let world = &status.worlds[0];
+        assert_eq!(world.world_id, "w1");
+        assert_eq!(world.players, 3);
+        assert_eq!(world.blocks, 1);
+        // Smoothed halfway from zero towards 30 poses/s and 1 edit/s
+        assert_eq!(world.poses_per_sec, 15.0);
+        assert_eq!(world.block_edits_per_sec, 0.5);
+        assert_eq!(world.pose_fanout_per_sec, 30.0);
+        assert_eq!(status.totals.active_worlds, 1);
+        assert_eq!(status.totals.messages, 31);
+
+        let c = status.clients.iter().find(|c| c.client_id == "c").unwrap();
+        assert!((c.publish_latency_ms - 800.0).abs() < 1e-9);
+        // Publish latency includes clock offsets, so it does not make a client slow
+        assert!(!c.slow);
+        assert_eq!(c.delivery_lag_ms, None);
+        assert_eq!(status.totals.slow_clients, 0);
+
+        let prometheus = status.to_prometheus();
+        assert!(prometheus.contains("iotcraft_world_players{world=\"w1\"} 3"));
+        assert!(prometheus.contains(
+            "iotcraft_client_publish_latency_milliseconds{client=\"c\",world=\"w1\"} 800"
+        ));
+        assert!(prometheus.contains("# TYPE iotcraft_messages_total counter"));
+    }
+
+    #[test]
+    fn probes_measure_delivery_lag() {
+        let start = Instant::now();
+        let mut store = WorldStore::default();
+        let mut metrics = Metrics::new(start);
+        for player in ["fast", "stuck", "legacy"] {
+            let topic = format!("iotcraft/worlds/w1/players/{player}/pose");
+            store.handle(&topic, &pose(1));
+            metrics.observe(&topic, &pose(1), start, 1);
+        }
+
+        let probes = metrics.probes(start);
+        assert_eq!(probes.len(), 3);
+        let probe = |player: &str| {
+            probes
+                .iter()
+                .find(|(topic, _)| topic == &format!("iotcraft/worlds/w1/clients/{player}/probe"))
+                .unwrap()
+                .clone()
+        };
+        let (fast, fast_payload) = probe("fast");
+        let (stuck, stuck_payload) = probe("stuck");
+        echo(
+            &mut metrics,
+            &fast,
+            &fast_payload,
+            start + Duration::from_millis(30),
+        );
+        echo(
+            &mut metrics,
+            &stuck,
+            &stuck_payload,
+            start + Duration::from_millis(40),
+        );
+        // No probe is due until the interval has passed
+        assert!(metrics.probes(start + Duration::from_secs(1)).is_empty());
+
+        // The stuck client stops answering: its waiting probe counts with its age
+        let later = start + PROBE_INTERVAL;
+        let probes = metrics.probes(later);
+        let (fast, fast_payload) = probes
+            .iter()
+            .find(|(topic, _)| topic.contains("/fast/"))
+            .unwrap()
+            .clone();
+        echo(
+            &mut metrics,
+            &fast,
+            &fast_payload,
+            later + Duration::from_millis(30),
+        );
+        let status = metrics.sample(&store, later + Duration::from_millis(900));
+        let client = |id: &str| status.clients.iter().find(|c| c.client_id == id).unwrap();
+        assert!((client("fast").delivery_lag_ms.unwrap() - 30.0).abs() < 1e-6);
+        assert!(!client("fast").slow);
+        assert!((client("stuck").delivery_lag_ms.unwrap() - 900.0).abs() < 1e-6);
+        assert!(client("stuck").slow);
+        // Clients that never echo a probe are not measured
+        assert_eq!(client("legacy").delivery_lag_ms, None);
+        assert!(!client("legacy").slow);
+        assert_eq!(status.clients[0].client_id, "stuck");
+        assert_eq!(status.totals.slow_clients, 1);
+        assert!(status.to_prometheus().contains(
+            "iotcraft_client_delivery_lag_milliseconds{client=\"stuck\",world=\"w1\"} 900"
+        ));
+
+        // An unanswered probe is sent again, still counting from the first send
+        let retry = later + PROBE_RETRY;
+        let probes = metrics.probes(retry);
+        let (stuck, stuck_payload) = probes
+            .iter()
+            .find(|(topic, _)| topic.contains("/stuck/"))
+            .unwrap()
+            .clone();
+        let status = metrics.sample(&store, retry);
+        let stuck_lag = status
+            .clients
+            .iter()
+            .find(|c| c.client_id == "stuck")
+            .unwrap()
+            .delivery_lag_ms;
+        assert!((stuck_lag.unwrap() - PROBE_RETRY.as_secs_f64() * 1000.0).abs() < 1e-6);
+        echo(
+            &mut metrics,
+            &stuck,
+            &stuck_payload,
+            retry + Duration::from_millis(10),
+        );
+        let status = metrics.sample(&store, retry + Duration::from_millis(10));
+        assert!(!status.clients.iter().any(|c| c.slow));
+    }
+
+    #[test]
+    fn forgets_silent_clients_and_unpublished_worlds() {
+        let start = Instant::now();
+        let mut store = WorldStore::default();
+        let mut metrics = Metrics::new(start);
+        let topic = "iotcraft/worlds/w1/players/a/pose";
+        store.handle(topic, &pose(5));
+        metrics.observe(topic, &pose(5), start, 10);
+        metrics.observe("devices/announce", b"{}", start, 10);
+        assert_eq!(metrics.sample(&store, start).clients.len(), 1);
+
+        store.handle("iotcraft/worlds/w1/info", b"");
+        let status = metrics.sample(&store, start + CLIENT_EXPIRY);
+        assert!(status.worlds.is_empty());
+        assert!(status.clients.is_empty());
+        assert_eq!(status.totals.messages, 1);
+    }
+}
@@ -0,0 +1,245 @@
+//! Router benchmark for comparing traffic profiles.
+//!
+//! Runs a fixed IoTCraft-like workload through rumqttd's router with in-process links:
+//! one publisher sends player poses and sensor readings at high rates plus a large world
+//! snapshot every second, and a set of subscribers receives all three. Every payload starts
+//! with its publish time, so subscribers measure the router's end-to-end latency directly.
+//! Process memory is read before and after, which shows what the profile's commit logs
+//! retain. Run it once per profile in a fresh process so the peaks do not mix.
+
+use crate::profiles::TrafficProfile;
+use rumqttd::{Broker, Config, Notification};
+use std::thread;
+use std::time::{Duration, Instant};
+
+const SUBSCRIBERS: usize = 32;
+const POSES_PER_SEC: usize = 2000;
+const SENSOR_READINGS_PER_SEC: usize = 500;
+const SNAPSHOT_INTERVAL: Duration = Duration::from_secs(1);
+const SNAPSHOT_BYTES: usize = 512 * 1024;
+const POSE_BYTES: usize = 160;
+const SENSOR_BYTES: usize = 32;
+const TICK: Duration = Duration::from_millis(10);
+
+const POSE_FILTER: &str = "iotcraft/worlds/+/players/+/pose";
+const SNAPSHOT_TOPIC: &str = "iotcraft/worlds/bench/data";
+const SNAPSHOT_FILTER: &str = "iotcraft/worlds/+/data";
+const SENSOR_TOPIC: &str = "home/sensor/temperature";
+const STOP_TOPIC: &str = "iotcraft/bench/stop";
+
+/// Latency percentiles in microseconds
+#[derive(Debug, Default, Clone, Copy)]
+pub struct Percentiles {
+    pub count: usize,
+    pub p50: u64,
+    pub p99: u64,
+    pub p999: u64,
+    pub max: u64,
+}
+
+impl Percentiles {
+    fn from_samples(mut samples: Vec<u64>) -> Self {
+        if samples.is_empty() {
+            return Self::default();
+        }
+        samples.sort_unstable();
+        let at = |p: f64| {
+            let rank = (p * samples.len() as f64).ceil() as usize;
+            samples[rank.clamp(1, samples.len()) - 1]
+        };
+        Self {
+            count: samples.len(),
+            p50: at(0.50),
+            p99: at(0.99),
+            p999: at(0.999),
+            max: samples[samples.len() - 1],
+        }
+    }
+
+    fn report(&self) -> String {
+        format!(
+            "{} delivered, p50 {} µs, p99 {} µs, p99.9 {} µs, max {} µs",
+            self.count, self.p50, self.p99, self.p999, self.max
+        )
+    }
+}
+
+pub struct ProfileBench {
+    pub profile: Option<TrafficProfile>,
+    pub duration: Duration,
+    pub published: usize,
+    pub publish_errors: usize,
+    pub poses: Percentiles,
+    pub sensors: Percentiles,
+    pub snapshots: Percentiles,
+    pub rss_before_kb: Option<u64>,
+    pub rss_after_kb: Option<u64>,
+    pub peak_rss_kb: Option<u64>,
+}
+
+impl ProfileBench {
+    pub fn report(&self) -> String {
+        let name = self
+            .profile
+            .map(|profile| format!("{profile:?}"))
+            .unwrap_or_else(|| "stock configuration".to_string());
+        let mb = |kb: Option<u64>| {
+            kb.map(|kb| format!("{:.1} MB", kb as f64 / 1024.0))
+                .unwrap_or_else(|| "n/a".to_string())
+        };
+        format!(
+            "{} over {:.1}s: {} messages published ({} errors) to {} subscribers\n  \
+             poses:     {}\n  \
+             sensors:   {}\n  \
+             snapshots: {}\n  \
+             memory: {} before, {} after, {} peak",
+            name,
+            self.duration.as_secs_f64(),
+            self.published,
+            self.publish_errors,
+            SUBSCRIBERS,
+            self.poses.report(),
+            self.sensors.report(),
+            self.snapshots.report(),
+            mb(self.rss_before_kb),
+            mb(self.rss_after_kb),
+            mb(self.peak_rss_kb),
+        )
+    }
+}
+
+/// Resident and peak memory of this process in KB, from `/proc/self/status`
+fn memory_kb() -> (Option<u64>, Option<u64>) {
+    let Ok(status) = std::fs::read_to_string("/proc/self/status") else {
+        return (None, None);
+    };
+    let field = |name: &str| {
+        status
+            .lines()
+            .find_map(|line| line.strip_prefix(name))
+            .and_then(|rest| rest.trim().trim_end_matches("kB").trim().parse().ok())
+    };
+    (field("VmRSS:"), field("VmHWM:"))
+}
+
+fn payload(len: usize, base: Instant) -> Vec<u8> {
+    let mut payload = vec![b'x'; len.max(8)];
+    let sent = base.elapsed().as_micros() as u64;
+    payload[..8].copy_from_slice(&sent.to_le_bytes());
+    payload
+}
+
+#[derive(Default)]
+struct Samples {
+    poses: Vec<u64>,
+    sensors: Vec<u64>,
+    snapshots: Vec<u64>,
+}
+
+/// Run the workload for `duration` through a broker built from `config`
+pub fn run(config: Config, profile: Option<TrafficProfile>, duration: Duration) -> ProfileBench {
+    let (rss_before_kb, _) = memory_kb();
+    let broker = Broker::new(config);
+    let base = Instant::now();
+    let give_up = base + duration + Duration::from_secs(10);
+
+    let mut subscribers = Vec::with_capacity(SUBSCRIBERS);
+    for i in 0..SUBSCRIBERS {
+        let (mut link_tx, mut link_rx) = broker.link(&format!("bench-subscriber-{i}")).unwrap();
+        for filter in [POSE_FILTER, SNAPSHOT_FILTER, SENSOR_TOPIC, STOP_TOPIC] {
+            link_tx.subscribe(filter).unwrap();
+        }
+        subscribers.push(thread::spawn(move || {
+            // Keep the link open until the subscriber is done
+            let _link_tx = link_tx;
+            let mut samples = Samples::default();
+            loop {
+                let notification = match link_rx.recv_deadline(give_up) {
+                    Ok(Some(notification)) => notification,
+                    Ok(None) => continue,
+                    Err(_) => break,
+                };
+                let Notification::Forward(forward) = notification else {
+                    continue;
+                };
+                let topic = &forward.publish.topic[..];
+                if topic == STOP_TOPIC.as_bytes() {
+                    break;
+                }
+                let Some(sent) = forward.publish.payload.get(..8) else {
+                    continue;
+                };
+                let sent = u64::from_le_bytes(sent.try_into().unwrap());
+                let latency = (base.elapsed().as_micros() as u64).saturating_sub(sent);
+                if topic == SENSOR_TOPIC.as_bytes() {
+                    samples.sensors.push(latency);
+                } else if topic == SNAPSHOT_TOPIC.as_bytes() {
+                    samples.snapshots.push(latency);
+                } else {
+                    samples.poses.push(latency);
+                }
+            }
+            samples
+        }));
+    }
+    // Let the router register the subscriptions before publishing
+    thread::sleep(Duration::from_millis(200));
+
+    let (mut publisher, _publisher_rx) = broker.link("bench-publisher").unwrap();
+    let started = Instant::now();
+    let ticks_per_sec = (Duration::from_secs(1).as_micros() / TICK.as_micros()) as usize;
+    let mut published = 0;
+    let mut publish_errors = 0;
+    let mut tick = 0usize;
+    let mut next_snapshot = started;
+    while started.elapsed() < duration {
+        let mut publish = |topic: String, payload: Vec<u8>| match publisher.publish(topic, payload)
+        {
+            Ok(_) => published += 1,
+            Err(_) => publish_errors += 1,
+        };
+        for i in 0..POSES_PER_SEC / ticks_per_sec {
+            let player = (tick * POSES_PER_SEC / ticks_per_sec + i) % 64;
+            publish(
+                format!("iotcraft/worlds/bench/players/player-{player}/pose"),
+                payload(POSE_BYTES, base),
+            );
+        }
+        for _ in 0..SENSOR_READINGS_PER_SEC / ticks_per_sec {
+            publish(SENSOR_TOPIC.to_string(), payload(SENSOR_BYTES, base));
+        }
+        if Instant::now() >= next_snapshot {
+            publish(SNAPSHOT_TOPIC.to_string(), payload(SNAPSHOT_BYTES, base));
+            next_snapshot += SNAPSHOT_INTERVAL;
+        }
+        tick += 1;
+        if let Some(wait) = (started + TICK * tick as u32).checked_duration_since(Instant::now()) {
+            thread::sleep(wait);
+        }
+    }
+    let elapsed = started.elapsed();
+    let _ = publisher.publish(STOP_TOPIC, payload(8, base));
+
+    let mut samples = Samples::default();
+    for subscriber in subscribers {
+        if let Ok(mut received) = subscriber.join() {
+            samples.poses.append(&mut received.poses);
+            samples.sensors.append(&mut received.sensors);
+            samples.snapshots.append(&mut received.snapshots);
+        }
+    }
+    let (rss_after_kb, peak_rss_kb) = memory_kb();
+
+    ProfileBench {
+        profile,
+        duration: elapsed,
+        published,
+        publish_errors,
+        poses: Percentiles::from_samples(samples.poses),
+        sensors: Percentiles::from_samples(samples.sensors),
+        snapshots: Percentiles::from_samples(samples.snapshots),
+        rss_before_kb,
+        rss_after_kb,
+        peak_rss_kb,
+    }
+}
@@ -0,0 +1,352 @@
+//! Broker tuning presets for typical IoTCraft deployments.
+//!
+//! rumqttd keeps a commit log per subscription filter, and a filter without a
+//! `custom_segment` entry gets the router-wide segment size. With one size for everything,
+//! a 100 MB segment meant for world snapshots also buffers each high-rate pose filter, and
+//! a reader catching up on a full segment can delay every other connection on its thread.
+//! A profile sizes the segments of the filters IoTCraft clients subscribe to separately,
+//! and sets the queue, inflight and connection-rate limits for its kind of traffic.
+//!
+//! Profiles are applied as a TOML overlay on top of the configuration the broker would
+//! otherwise use, whether that comes from `rumqttd.toml` or is built for `--port`. A
+//! profile never lowers the configured connection limit; it only raises one below what
+//! its traffic needs, and says so in the log.
+
+use clap::ValueEnum;
+use config::{Config, ConfigError, File, FileFormat};
+use std::fmt::Write;
+use tracing::info;
+
+/// Listener kinds in a rumqttd configuration, each a table of named servers
+const LISTENER_KINDS: [&str; 3] = ["v4", "v5", "ws"];
+
+const KB: usize = 1024;
+const MB: usize = 1024 * KB;
+
+#[derive(Clone, Copy, Debug, PartialEq, Eq, ValueEnum)]
+pub enum TrafficProfile {
+    /// A few dozen players on one LAN: small queues for low latency
+    LanClassroom,
+    /// Large shared worlds: room for multi-megabyte snapshots and join bursts
+    LargeWorld,
+    /// Thousands of devices and players publishing small messages at high rates
+    SensorHeavy,
+}
+
+/// Commit log limits for one subscription filter
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct SegmentLimits {
+    pub filter: &'static str,
+    pub max_segment_size: usize,
+    pub max_segment_count: usize,
+}
+
+impl SegmentLimits {
+    const fn new(filter: &'static str, max_segment_size: usize, max_segment_count: usize) -> Self {
+        Self {
+            filter,
+            max_segment_size,
+            max_segment_count,
+        }
+    }
+
+    /// Most bytes the filter's commit log holds before old segments are dropped
+    pub fn capacity(&self) -> usize {
+        self.max_segment_size * self.max_segment_count
+    }
+}
+
+/// Everything a profile sets
+#[derive(Clone, Debug, PartialEq)]
+pub struct ProfileLimits {
+    /// Least connection limit the profile needs; a higher configured limit is kept
+    pub max_connections: usize,
+    /// Packets the router hands a connection per batch
+    pub max_outgoing_packet_count: u64,
+    /// Segment limits of filters without their own entry
+    pub default_segment: SegmentLimits,
+    pub segments: &'static [SegmentLimits],
+    pub max_payload_size: usize,
+    pub max_inflight_count: usize,
+    /// Delay between accepted connections on each listener, bounding the connection rate
+    pub next_connection_delay_ms: u64,
+}
+
+const LAN_CLASSROOM_SEGMENTS: &[SegmentLimits] = &[
+    SegmentLimits::new("iotcraft/worlds/+/data", 8 * MB, 2),
+    SegmentLimits::new("iotcraft/worlds/+/info", 256 * KB, 2),
+    SegmentLimits::new("iotcraft/worlds/+/players/+/pose", MB, 2),
+    SegmentLimits::new("iotcraft/worlds/+/state/blocks/placed", MB, 2),
+    SegmentLimits::new("iotcraft/worlds/+/state/blocks/removed", MB, 2),
+    SegmentLimits::new("home/sensor/temperature", 256 * KB, 2),
+    SegmentLimits::new("devices/announce", 256 * KB, 2),
+];
+
+const LARGE_WORLD_SEGMENTS: &[SegmentLimits] = &[
+    SegmentLimits::new("iotcraft/worlds/+/data", 64 * MB, 3),
+    SegmentLimits::new("iotcraft/worlds/+/info", 512 * KB, 2),
+    SegmentLimits::new("iotcraft/worlds/+/players/+/pose", 2 * MB, 2),
+    SegmentLimits::new("iotcraft/worlds/+/state/blocks/placed", 8 * MB, 3),
+    SegmentLimits::new("iotcraft/worlds/+/state/blocks/removed", 8 * MB, 3),
+    SegmentLimits::new("home/sensor/temperature", 256 * KB, 2),
+    SegmentLimits::new("devices/announce", 512 * KB, 2),
+];
+
+const SENSOR_HEAVY_SEGMENTS: &[SegmentLimits] = &[
+    SegmentLimits::new("iotcraft/worlds/+/data", 16 * MB, 2),
+    SegmentLimits::new("iotcraft/worlds/+/info", 512 * KB, 2),
+    SegmentLimits::new("iotcraft/worlds/+/players/+/pose", 4 * MB, 3),
+    SegmentLimits::new("iotcraft/worlds/+/state/blocks/placed", 2 * MB, 2),
+    SegmentLimits::new("iotcraft/worlds/+/state/blocks/removed", 2 * MB, 2),
+    SegmentLimits::new("home/sensor/temperature", 4 * MB, 3),
+    SegmentLimits::new("devices/announce", 4 * MB, 3),
+];
+
+impl TrafficProfile {
+    pub fn limits(self) -> ProfileLimits {
+        match self {
+            TrafficProfile::LanClassroom => ProfileLimits {
+                max_connections: 256,
+                max_outgoing_packet_count: 100,
+                default_segment: SegmentLimits::new("", 4 * MB, 2),
+                segments: LAN_CLASSROOM_SEGMENTS,
+                max_payload_size: 4 * MB,
+                max_inflight_count: 100,
+                next_connection_delay_ms: 5,
+            },
+            TrafficProfile::LargeWorld => ProfileLimits {
+                max_connections: 1000,
+                // Fewer, larger packets per batch so one snapshot reader does not hold up
+                // the rest
+                max_outgoing_packet_count: 50,
+                default_segment: SegmentLimits::new("", 8 * MB, 3),
+                segments: LARGE_WORLD_SEGMENTS,
+                max_payload_size: 16 * MB,
+                max_inflight_count: 50,
+                // Joins arrive in bursts, and each one pulls a snapshot
+                next_connection_delay_ms: 10,
+            },
+            TrafficProfile::SensorHeavy => ProfileLimits {
+                max_connections: 10010,
+                max_outgoing_packet_count: 500,
+                default_segment: SegmentLimits::new("", 2 * MB, 3),
+                segments: SENSOR_HEAVY_SEGMENTS,
+                max_payload_size: MB,
+                max_inflight_count: 500,
+                next_connection_delay_ms: 1,
+            },
+        }
+    }
+
+    /// TOML setting this profile's limits on the router and the given listeners
+    /// (`"v4.1"`, `"ws.1"`, ...). `configured_connections` is the connection limit already
+    /// configured, kept when it is at least the profile's.
+    pub fn overlay_toml(
+        self,
+        listeners: &[String],
+        configured_connections: Option<usize>,
+    ) -> String {
+        let limits = self.limits();
+        let max_connections = configured_connections.map_or(limits.max_connections, |configured| {
+            configured.max(limits.max_connections)
+        });
+        let mut toml = String::new();
+        let _ = writeln!(toml, "[router]");
+        let _ = writeln!(toml, "max_connections = {}", max_connections);
+        let _ = writeln!(
+            toml,
+            "max_outgoing_packet_count = {}",
+            limits.max_outgoing_packet_count
+        );
+        let _ = writeln!(
+            toml,
+            "max_segment_size = {}",
+            limits.default_segment.max_segment_size
+        );
+        let _ = writeln!(
+            toml,
+            "max_segment_count = {}",
+            limits.default_segment.max_segment_count
+        );
+        for segment in limits.segments {
+            let _ = writeln!(toml, "[router.custom_segment.'{}']", segment.filter);
+            let _ = writeln!(toml, "max_segment_size = {}", segment.max_segment_size);
+            let _ = writeln!(toml, "max_segment_count = {}", segment.max_segment_count);
+        }
+        for listener in listeners {
+            let _ = writeln!(toml, "[{listener}]");
+            let _ = writeln!(
+                toml,
+                "next_connection_delay_ms = {}",
+                limits.next_connection_delay_ms
+            );
+            let _ = writeln!(toml, "[{listener}.connections]");
+            let _ = writeln!(toml, "max_payload_size = {}", limits.max_payload_size);
+            let _ = writeln!(toml, "max_inflight_count = {}", limits.max_inflight_count);
+        }
+        toml
+    }
+
+    /// Most bytes the router's commit logs hold for IoTCraft filters and `other_filters`
+    /// further subscription filters, before old segments are dropped
+    pub fn memory_budget(self, other_filters: usize) -> usize {
+        let limits = self.limits();
+        limits
+            .segments
+            .iter()
+            .map(SegmentLimits::capacity)
+            .sum::<usize>()
+            + limits.default_segment.capacity() * other_filters
+    }
+}
+
+/// Listeners configured in `config`, as `"<kind>.<name>"`
+fn listeners(config: &Config) -> Vec<String> {
+    let mut listeners = Vec::new();
+    for kind in LISTENER_KINDS {
+        if let Ok(servers) = config.get_table(kind) {
+            let mut names: Vec<_> = servers.into_keys().collect();
+            names.sort();
+            listeners.extend(names.into_iter().map(|name| format!("{kind}.{name}")));
+        }
+    }
+    listeners
+}
+
+/// `base` with the profile's limits merged over it
+pub fn apply(base: Config, profile: TrafficProfile) -> Result<Config, ConfigError> {
+    let configured = base
+        .get_int("router.max_connections")
+        .ok()
+        .and_then(|connections| usize::try_from(connections).ok());
+    let needed = profile.limits().max_connections;
+    if let Some(configured) = configured.filter(|&configured| configured < needed) {
+        info!(
+            "{:?} profile raises max_connections from {} to {}",
+            profile, configured, needed
+        );
+    }
+    let overlay = profile.overlay_toml(&listeners(&base), configured);
+    Config::builder()
+        .add_source(base)
+        .add_source(File::from_str(&overlay, FileFormat::Toml))
+        .build()
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    const BASE: &str = r#"
+        id = 0
+
+        [router]
+        id = 0
+        max_connections = 1000
+        max_outgoing_packet_count = 200
+        max_segment_size = 104857600
+        max_segment_count = 10
+
+        [v4.1]
+        name = "v4-1"
+        listen = "0.0.0.0:1883"
+        next_connection_delay_ms = 1
+        [v4.1.connections]
+        connection_timeout_ms = 60000
+        max_payload_size = 1048576
+        max_inflight_count = 100
+        dynamic_filters = true
+
+        [ws.1]
+        name = "ws-1"
+        listen = "0.0.0.0:8083"
+        next_connection_delay_ms = 1
+        [ws.1.connections]
+        connection_timeout_ms = 60000
+        max_payload_size = 1048576
+        max_inflight_count = 500
+    "#;
+
+    fn base() -> Config {
+        Config::builder()
+            .add_source(File::from_str(BASE, FileFormat::Toml))
+            .build()
+            .unwrap()
+    }
+
+    #[test]
+    fn overlay_keeps_unrelated_settings_and_only_touches_existing_listeners() {
+        let config = apply(base(), TrafficProfile::LargeWorld).unwrap();
+
+        assert_eq!(config.get_int("router.id").unwrap(), 0);
+        assert_eq!(
+            config.get_int("router.max_outgoing_packet_count").unwrap(),
+            50
+        );
+        assert_eq!(config.get_string("v4.1.listen").unwrap(), "0.0.0.0:1883");
+        assert_eq!(
+            config
+                .get_int("v4.1.connections.connection_timeout_ms")
+                .unwrap(),
+            60000
+        );
+        assert_eq!(
+            config.get_int("ws.1.connections.max_payload_size").unwrap(),
+            16 * MB as i64
+        );
+        assert_eq!(config.get_int("v4.1.next_connection_delay_ms").unwrap(), 10);
+        assert!(config.get_table("v5").is_err());
+    }
+
+    #[test]
+    fn profiles_never_lower_the_connection_limit() {
+        // The base allows 1000 connections, more than the classroom profile needs
+        let config = apply(base(), TrafficProfile::LanClassroom).unwrap();
+        assert_eq!(config.get_int("router.max_connections").unwrap(), 1000);
+        let config = apply(base(), TrafficProfile::LargeWorld).unwrap();
+        assert_eq!(config.get_int("router.max_connections").unwrap(), 1000);
+        // ...and fewer than the sensor profile needs
+        let config = apply(base(), TrafficProfile::SensorHeavy).unwrap();
+        assert_eq!(
+            config.get_int("router.max_connections").unwrap(),
+            TrafficProfile::SensorHeavy.limits().max_connections as i64
+        );
+    }
+
+    #[test]
+    fn custom_segments_are_keyed_by_topic_filter() {
+        let config = apply(base(), TrafficProfile::SensorHeavy).unwrap();
+        let segments = config.get_table("router.custom_segment").unwrap();
+
+        for segment in TrafficProfile::SensorHeavy.limits().segments {
+            let table = segments[segment.filter].clone().into_table().unwrap();
+            assert_eq!(
+                table["max_segment_size"].clone().into_int().unwrap(),
+                segment.max_segment_size as i64
+            );
+        }
+    }
+
+    #[test]
+    fn pose_and_sensor_logs_stay_far_below_the_snapshot_log() {
+        for profile in TrafficProfile::value_variants() {
+            let limits = profile.limits();
+            let capacity = |filter: &str| {
+                limits
+                    .segments
+                    .iter()
+                    .find(|s| s.filter == filter)
+                    .map(SegmentLimits::capacity)
+                    .unwrap()
+            };
+            let data = capacity("iotcraft/worlds/+/data");
+            assert!(capacity("iotcraft/worlds/+/players/+/pose") < data);
+            assert!(capacity("home/sensor/temperature") < data);
+            // A world snapshot always fits in one segment
+            assert!(limits.max_payload_size <= limits.segments[0].max_segment_size);
+            // All IoTCraft filters together stay well below the 1 GB that each single
+            // filter may hold with the stock configuration
+            assert!(profile.memory_budget(0) < 300 * MB);
+        }
+    }
+}
@@ -0,0 +1,505 @@
+//! On-disk form of the broker's world state.
+//!
+//! Every persisted world is a directory under the storage root, named after its world id:
+//!
+//! - `world.json`: world info, snapshot header and revision
+//! - `r.{x}.{y}.{z}.icr`: region files, each holding the blocks of 8x8x8 chunks
+//! - `edits.log`: block edits since the regions were last written, one per line
+//!
+//! Edits are appended to the journal as they arrive, so nothing is lost when the broker
+//! stops between flushes. A flush rewrites only the regions touched since the last one
+//! and then empties the journal; replaying a journal over regions that already contain
+//! its edits yields the same world, so a crash between the two steps is harmless.
+
+use crate::world_state::{BlockPos, CHUNK_SIZE, ChunkPos, Edit, WorldState, chunk_of};
+use serde_json::Value;
+use std::collections::{BTreeMap, HashMap, HashSet};
+use std::fs::{self, File, OpenOptions};
+use std::io::{self, Write};
+use std::path::{Path, PathBuf};
+use tracing::{info, warn};
+
+/// Chunks per region along each axis
+pub const REGION_CHUNKS: i32 = 8;
+
+pub type RegionPos = [i32; 3];
+
+const REGION_MAGIC: &[u8; 4] = b"ICRG";
+const REGION_VERSION: u16 = 1;
+const HEADER_FILE: &str = "world.json";
+const JOURNAL_FILE: &str = "edits.log";
+
+/// Region containing a chunk
+pub fn region_of(chunk: ChunkPos) -> RegionPos {
+    chunk.map(|c| c.div_euclid(REGION_CHUNKS))
+}
+
+fn region_file_name([x, y, z]: RegionPos) -> String {
+    format!("r.{x}.{y}.{z}.icr")
+}
+
+fn parse_region_file_name(name: &str) -> Option<RegionPos> {
+    let mut parts = name.strip_prefix("r.")?.strip_suffix(".icr")?.split('.');
+    let mut next = || parts.next()?.parse().ok();
+    Some([next()?, next()?, next()?])
+}
+
+fn invalid(message: &str) -> io::Error {
+    io::Error::new(io::ErrorKind::InvalidData, message.to_string())
+}
+
+/// Encode the blocks of one region.
+///
+/// Layout (little-endian): magic, `u16` version, `u16` palette length and the
+/// length-prefixed (`u8`) block type names, `u32` chunk count, then per chunk its
+/// `i32` position and `u16` block count followed by `(u16 cell, u16 palette)` pairs,
+/// where `cell = x + 16 * (y + 16 * z)` within the chunk.
+pub fn encode_region<'a>(blocks: impl IntoIterator<Item = (BlockPos, &'a str)>) -> Vec<u8> {
+    let mut palette: Vec<&str> = Vec::new();
+    let mut chunks: BTreeMap<ChunkPos, Vec<(u16, u16)>> = BTreeMap::new();
+    for (pos, block_type) in blocks {
+        let index = match palette.iter().position(|t| *t == block_type) {
+            Some(index) => index,
+            None => {
+                palette.push(block_type);
+                palette.len() - 1
+            }
+        };
+        let chunk = chunk_of(pos);
+        let [x, y, z]: BlockPos = std::array::from_fn(|i| pos[i] - chunk[i] * CHUNK_SIZE);
+        let cell = x + CHUNK_SIZE * (y + CHUNK_SIZE * z);
+        chunks
+            .entry(chunk)
+            .or_default()
+            .push((cell as u16, index as u16));
+    }
+
+    let mut out = Vec::new();
+    out.extend_from_slice(REGION_MAGIC);
+    out.extend_from_slice(&REGION_VERSION.to_le_bytes());
+    out.extend_from_slice(&(palette.len() as u16).to_le_bytes());
+    for name in &palette {
+        let name = &name.as_bytes()[..name.len().min(u8::MAX as usize)];
+        out.push(name.len() as u8);
+        out.extend_from_slice(name);
+    }
+    out.extend_from_slice(&(chunks.len() as u32).to_le_bytes());
+    for (chunk, cells) in &chunks {
+        for c in chunk {
+            out.extend_from_slice(&c.to_le_bytes());
+        }
+        out.extend_from_slice(&(cells.len() as u16).to_le_bytes());
+        for (cell, index) in cells {
+            out.extend_from_slice(&cell.to_le_bytes());
+            out.extend_from_slice(&index.to_le_bytes());
+        }
+    }
+    out
+}
+
+/// Reads little-endian values from a region file
+struct Reader<'a> {
+    data: &'a [u8],
+}
+
+impl<'a> Reader<'a> {
+    fn take(&mut self, len: usize) -> io::Result<&'a [u8]> {
+        if self.data.len() < len {
+            return Err(invalid("truncated region file"));
+        }
+        let (head, rest) = self.data.split_at(len);
+        self.data = rest;
+        Ok(head)
+    }
+
+    fn array<const N: usize>(&mut self) -> io::Result<[u8; N]> {
+        Ok(self.take(N)?.try_into().expect("took N bytes"))
+    }
+
+    fn u16(&mut self) -> io::Result<u16> {
+        Ok(u16::from_le_bytes(self.array()?))
+    }
+
+    fn u32(&mut self) -> io::Result<u32> {
+        Ok(u32::from_le_bytes(self.array()?))
+    }
+
+    fn i32(&mut self) -> io::Result<i32> {
+        Ok(i32::from_le_bytes(self.array()?))
+    }
+}
+
+/// Decode a region written by [`encode_region`]
+pub fn decode_region(data: &[u8]) -> io::Result<Vec<(BlockPos, String)>> {
+    let mut reader = Reader { data };
+    if reader.take(4)? != REGION_MAGIC {
+        return Err(invalid("not a region file"));
+    }
+    if reader.u16()? != REGION_VERSION {
+        return Err(invalid("unsupported region version"));
+    }
+    let mut palette = Vec::new();
+    for _ in 0..reader.u16()? {
+        let len = reader.take(1)?[0] as usize;
+        let name = std::str::from_utf8(reader.take(len)?)
+            .map_err(|_| invalid("block type is not UTF-8"))?;
+        palette.push(name.to_string());
+    }
+
+    let size = CHUNK_SIZE;
+    let mut blocks = Vec::new();
+    for _ in 0..reader.u32()? {
+        let chunk = [reader.i32()?, reader.i32()?, reader.i32()?];
+        for _ in 0..reader.u16()? {
+            let cell = i32::from(reader.u16()?);
+            let block_type = palette
+                .get(reader.u16()? as usize)
+                .ok_or_else(|| invalid("palette index out of range"))?;
+            let local = [cell % size, cell / size % size, cell / (size * size)];
+            let pos = std::array::from_fn(|i| chunk[i] * size + local[i]);
+            blocks.push((pos, block_type.clone()));
+        }
+    }
+    Ok(blocks)
+}
+
+/// One journal line: `P x y z Type` or `R x y z`
+fn format_edit(edit: &Edit) -> String {
+    match edit {
+        Edit::Place([x, y, z], block_type) => format!("P {x} {y} {z} {block_type}\n"),
+        Edit::Remove([x, y, z]) => format!("R {x} {y} {z}\n"),
+    }
+}
+
+fn parse_edit(line: &str) -> Option<Edit<'_>> {
+    let mut parts = line.split_ascii_whitespace();
+    let kind = parts.next()?;
+    let mut coord = || parts.next()?.parse().ok();
+    let pos = [coord()?, coord()?, coord()?];
+    match kind {
+        "P" => Some(Edit::Place(pos, parts.next()?)),
+        "R" => Some(Edit::Remove(pos)),
+        _ => None,
+    }
+}
+
+/// What a flush still has to write for one world
+#[derive(Debug, Default)]
+struct DirtyWorld {
+    header: bool,
+    /// The whole world was replaced; rewrite every region and drop stale ones
+    replaced: bool,
+    regions: HashSet<RegionPos>,
+}
+
+/// Persists a [`crate::world_state::WorldStore`] to disk in the region format
+#[derive(Debug)]
+pub struct Storage {
+    root: PathBuf,
+    dirty: HashMap<String, DirtyWorld>,
+    journals: HashMap<String, File>,
+}
+
+impl Storage {
+    pub fn open(root: impl Into<PathBuf>) -> io::Result<Self> {
+        let root = root.into();
+        fs::create_dir_all(&root)?;
+        Ok(Self {
+            root,
+            dirty: HashMap::new(),
+            journals: HashMap::new(),
+        })
+    }
+
+    /// Directory of a world; `None` for ids that are not safe as a file name
+    fn world_dir(&self, world_id: &str) -> Option<PathBuf> {
+        let safe = !world_id.is_empty()
+            && world_id
+                .chars()
+                .all(|c| c.is_ascii_alphanumeric() || c == '-' || c == '_');
+        safe.then(|| self.root.join(world_id))
+    }
+
+    pub fn has_pending(&self) -> bool {
+        !self.dirty.is_empty()
+    }
+
+    /// A world was replaced by a new snapshot, which should reach the disk right away
+    pub fn has_replaced(&self) -> bool {
+        self.dirty.values().any(|dirty| dirty.replaced)
+    }
+
+    /// Load every persisted world, replaying its journal
+    pub fn load(&self) -> io::Result<Vec<(String, WorldState)>> {
+        let mut worlds = Vec::new();
+        for entry in fs::read_dir(&self.root)? {
+            let entry = entry?;
+            let world_id = entry.file_name().to_string_lossy().into_owned();
+            if self.world_dir(&world_id).is_none() || !entry.file_type()?.is_dir() {
+                continue;
+            }
+            match load_world(&entry.path()) {
+                Ok(world) => worlds.push((world_id, world)),
+                Err(e) => warn!("Skipping persisted world {}: {}", world_id, e),
+            }
+        }
+        Ok(worlds)
+    }
+
+    /// Append an edit to the world's journal and remember its region for the next flush
+    pub fn record_edit(&mut self, world_id: &str, edit: &Edit) {
+        let Some(dir) = self.world_dir(world_id) else {
+            return;
+        };
+        let pos = match edit {
+            Edit::Place(pos, _) | Edit::Remove(pos) => *pos,
+        };
+        self.dirty
+            .entry(world_id.to_string())
+            .or_default()
+            .regions
+            .insert(region_of(chunk_of(pos)));
+
+        if !self.journals.contains_key(world_id) {
+            let journal = fs::create_dir_all(&dir).and_then(|()| {
+                OpenOptions::new()
+                    .create(true)
+                    .append(true)
+                    .open(dir.join(JOURNAL_FILE))
+            });
+            match journal {
+                Ok(file) => {
+                    self.journals.insert(world_id.to_string(), file);
+                }
+                Err(e) => {
+                    warn!("Cannot open edit journal of world {}: {}", world_id, e);
+                    return;
+                }
+            }
+        }
+        if let Some(journal) = self.journals.get_mut(world_id) {
+            if let Err(e) = journal.write_all(format_edit(edit).as_bytes()) {
+                warn!("Cannot journal edit of world {}: {}", world_id, e);
+            }
+        }
+    }
+
+    /// The world's info or snapshot header changed
+    pub fn mark_header(&mut self, world_id: &str) {
+        if self.world_dir(world_id).is_some() {
+            self.dirty.entry(world_id.to_string()).or_default().header = true;
+        }
+    }
+
+    /// The world was replaced by a new snapshot
+    pub fn mark_replaced(&mut self, world_id: &str) {
+        if self.world_dir(world_id).is_none() {
+            warn!(
+                "World id {:?} cannot be used as a directory, not persisting it",
+                world_id
+            );
+            return;
+        }
+        let dirty = self.dirty.entry(world_id.to_string()).or_default();
+        dirty.header = true;
+        dirty.replaced = true;
+    }
+
+    pub fn remove_world(&mut self, world_id: &str) {
+        self.dirty.remove(world_id);
+        self.journals.remove(world_id);
+        if let Some(dir) = self.world_dir(world_id) {
+            if dir.exists() {
+                if let Err(e) = fs::remove_dir_all(&dir) {
+                    warn!("Cannot remove persisted world {}: {}", world_id, e);
+                }
+            }
+        }
+    }
+
+    /// Write everything changed since the last flush; returns the number of regions written.
+    ///
+    /// Worlds are written one at a time. A world that fails stays dirty with its journal
+    /// intact, so the next flush retries it; the first error is returned once every world
+    /// has been tried.
+    pub fn flush(&mut self, worlds: &HashMap<String, WorldState>) -> io::Result<usize> {
+        let mut written = 0;
+        let mut first_error = None;
+        let world_ids: Vec<String> = self.dirty.keys().cloned().collect();
+        for world_id in world_ids {
+            let Some(dirty) = self.dirty.remove(&world_id) else {
+                continue;
+            };
+            let (Some(dir), Some(world)) = (self.world_dir(&world_id), worlds.get(&world_id))
+            else {
+                continue;
+            };
+            let persisted = write_world(&dir, world, &dirty).and_then(|regions| {
+                written += regions;
+                // The regions now hold every journaled edit
+                match self.journals.get(&world_id) {
+                    Some(journal) => journal.set_len(0),
+                    None if dir.join(JOURNAL_FILE).exists() => {
+                        File::create(dir.join(JOURNAL_FILE)).map(drop)
+                    }
+                    None => Ok(()),
+                }
+            });
+            if let Err(e) = persisted {
+                warn!("Cannot persist world {}: {}", world_id, e);
+                self.dirty.insert(world_id, dirty);
+                first_error.get_or_insert(e);
+            }
+        }
+        if written > 0 {
+            info!(
+                "Persisted {} world regions to {}",
+                written,
+                self.root.display()
+            );
+        }
+        match first_error {
+            Some(e) => Err(e),
+            None => Ok(written),
+        }
+    }
+}
+
+/// Write the dirty regions and the header of one world; returns the number of regions
+/// written
+fn write_world(dir: &Path, world: &WorldState, dirty: &DirtyWorld) -> io::Result<usize> {
+    fs::create_dir_all(dir)?;
+
+    let regions = if dirty.replaced {
+        let current = world.regions();
+        for entry in fs::read_dir(dir)? {
+            let name = entry?.file_name();
+            let stale = parse_region_file_name(&name.to_string_lossy())
+                .is_some_and(|region| !current.contains(&region));
+            if stale {
+                fs::remove_file(dir.join(name))?;
+            }
+        }
+        current
+    } else {
+        dirty.regions.clone()
+    };
+    for region in &regions {
+        let path = dir.join(region_file_name(*region));
+        let blocks = world.region_blocks(*region);
+        if blocks.is_empty() {
+            if path.exists() {
+                fs::remove_file(path)?;
+            }
+        } else {
+            write_atomic(&path, &encode_region(blocks))?;
+        }
+    }
+
+    if dirty.header || !regions.is_empty() {
+        let header = serde_json::to_vec_pretty(&world.persisted_header())?;
+        write_atomic(&dir.join(HEADER_FILE), &header)?;
+    }
+    Ok(regions.len())
+}
+
+fn write_atomic(path: &Path, data: &[u8]) -> io::Result<()> {
+    let tmp = path.with_extension("tmp");
+    fs::write(&tmp, data)?;
+    fs::rename(tmp, path)
+}
+
+fn load_world(dir: &Path) -> io::Result<WorldState> {
+    let header: Value = match fs::read(dir.join(HEADER_FILE)) {
+        Ok(data) => serde_json::from_slice(&data)?,
+        Err(e) if e.kind() == io::ErrorKind::NotFound => Value::Null,
+        Err(e) => return Err(e),
+    };
+    let mut world = WorldState::restore(&header);
+    for entry in fs::read_dir(dir)? {
+        let entry = entry?;
+        if parse_region_file_name(&entry.file_name().to_string_lossy()).is_some() {
+            for (pos, block_type) in decode_region(&fs::read(entry.path())?)? {
+                world.set_block(pos, &block_type);
+            }
+        }
+    }
+    match fs::read_to_string(dir.join(JOURNAL_FILE)) {
+        Ok(journal) => {
+            for edit in journal.lines().filter_map(parse_edit) {
+                world.apply(&edit);
+            }
+        }
+        Err(e) if e.kind() == io::ErrorKind::NotFound => {}
+        Err(e) => return Err(e),
+    }
+    Ok(world)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_region_round_trip() {
+        let blocks = [
+            ([0, 0, 0], "Grass"),
+            ([15, 15, 15], "Stone"),
+            ([-1, -17, 130], "Grass"),
+        ];
+        let data = encode_region(blocks);
+        let mut decoded = decode_region(&data).unwrap();
+        decoded.sort();
+        let mut expected: Vec<(BlockPos, String)> =
+            blocks.iter().map(|(p, t)| (*p, t.to_string())).collect();
+        expected.sort();
+        assert_eq!(decoded, expected);
+
+        assert!(decode_region(&data[..data.len() - 1]).is_err());
+        assert!(decode_region(b"nope").is_err());
+        assert_eq!(
+            parse_region_file_name(&region_file_name([-1, 0, 3])),
+            Some([-1, 0, 3])
+        );
+    }
+
+    #[test]
+    fn test_failed_world_stays_dirty() {
+        let root = std::env::temp_dir().join(format!("iotcraft-region-{}", std::process::id()));
+        let _ = fs::remove_dir_all(&root);
+        let mut storage = Storage::open(&root).unwrap();
+        let mut worlds = HashMap::new();
+        for world_id in ["w1", "w2"] {
+            let mut world = WorldState::default();
+            world.set_block([1, 2, 3], "Stone");
+            worlds.insert(world_id.to_string(), world);
+            storage.mark_replaced(world_id);
+        }
+        storage.record_edit("w2", &Edit::Place([1, 2, 3], "Stone"));
+        // A directory where w2's region file goes makes writing it fail
+        let region = root.join("w2").join(region_file_name([0, 0, 0]));
+        fs::create_dir_all(region.join("blocker")).unwrap();
+
+        assert!(storage.flush(&worlds).is_err());
+        assert!(root.join("w1").join(HEADER_FILE).exists());
+        assert!(storage.has_replaced());
+        let journal = root.join("w2").join(JOURNAL_FILE);
+        assert!(fs::metadata(&journal).unwrap().len() > 0);
+
+        fs::remove_dir_all(&region).unwrap();
+        assert_eq!(storage.flush(&worlds).unwrap(), 1);
+        assert!(!storage.has_pending());
+        assert_eq!(fs::metadata(&journal).unwrap().len(), 0);
+        assert_eq!(load_world(&root.join("w2")).unwrap().block_count(), 1);
+        let _ = fs::remove_dir_all(&root);
+    }
+
+    #[test]
+    fn test_journal_lines() {
+        let place = Edit::Place([1, -2, 3], "Dirt");
+        let line = format_edit(&place);
+        assert_eq!(parse_edit(line.trim_end()), Some(place));
+        assert_eq!(parse_edit("R 4 5 6"), Some(Edit::Remove([4, 5, 6])));
+        assert_eq!(parse_edit("X 1 2 3"), None);
+    }
+}
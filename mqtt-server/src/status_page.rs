@@ -0,0 +1,241 @@
+//! Built-in status page for operators.
+//!
+//! A small HTTP server that shows the latest [`StatusSnapshot`]:
+//! - `/` is an HTML page that reloads itself every few seconds,
+//! - `/status.json` is the snapshot as JSON,
+//! - `/metrics` is the same data in Prometheus text format.
+//!
+//! It answers each request from the shared snapshot and closes the connection, so a slow
+//! or stuck viewer never touches the world state link.
+
+use crate::metrics::{SLOW_CLIENT_LAG_MS, StatusSnapshot};
+use std::fmt::Write;
+use std::sync::{Arc, Mutex};
+use tokio::io::{AsyncReadExt, AsyncWriteExt};
+use tokio::net::TcpListener;
+use tracing::{info, warn};
+
+/// Seconds between reloads of the HTML page
+const REFRESH_SECS: u32 = 2;
+/// Largest request head read; status requests are a single short line
+const MAX_REQUEST_BYTES: usize = 4096;
+
+pub type SharedStatus = Arc<Mutex<StatusSnapshot>>;
+
+/// Serve the status page on `port` until the process exits
+pub async fn serve(port: u16, status: SharedStatus) -> std::io::Result<()> {
+    let listener = TcpListener::bind(("0.0.0.0", port)).await?;
+    info!("📈 Status page on http://0.0.0.0:{}/", port);
+    loop {
+        let (mut stream, _) = match listener.accept().await {
+            Ok(connection) => connection,
+            Err(e) => {
+                warn!("⚠️ Status page accept failed: {}", e);
+                continue;
+            }
+        };
+        let status = status.clone();
+        tokio::spawn(async move {
+            let mut request = vec![0u8; MAX_REQUEST_BYTES];
+            let Ok(len) = stream.read(&mut request).await else {
+                return;
+            };
+            let response = respond(&request[..len], &status);
+            let _ = stream.write_all(&response).await;
+            let _ = stream.shutdown().await;
+        });
+    }
+}
+
+fn respond(request: &[u8], status: &SharedStatus) -> Vec<u8> {
+    let path = std::str::from_utf8(request)
+        .ok()
+        .and_then(|request| request.lines().next())
+        .and_then(|line| line.strip_prefix("GET "))
+        .and_then(|rest| rest.split(' ').next())
+        .map(|target| target.split('?').next().unwrap_or(target));
+    let Some(path) = path else {
+        return response("405 Method Not Allowed", "text/plain", "GET only\n".into());
+    };
+    let snapshot = status.lock().map(|s| s.clone()).unwrap_or_default();
+    match path {
+        "/" | "/index.html" => {
+            response("200 OK", "text/html; charset=utf-8", render_html(&snapshot))
+        }
+        "/status.json" => response(
+            "200 OK",
+            "application/json",
+            serde_json::to_string(&snapshot).unwrap_or_default(),
+        ),
+        "/metrics" => response(
+            "200 OK",
+            "text/plain; version=0.0.4",
+            snapshot.to_prometheus(),
+        ),
+        _ => response("404 Not Found", "text/plain", "not found\n".into()),
+    }
+}
+
+fn response(status: &str, content_type: &str, body: String) -> Vec<u8> {
+    let mut response = format!(
+        "HTTP/1.1 {status}\r\nContent-Type: {content_type}\r\nContent-Length: {}\r\n\
+         Cache-Control: no-store\r\nConnection: close\r\n\r\n",
+        body.len()
+    )
+    .into_bytes();
+    response.extend_from_slice(body.as_bytes());
+    response
+}
+
+fn escape(text: &str) -> String {
+    text.replace('&', "&amp;")
+        .replace('<', "&lt;")
+        .replace('>', "&gt;")
+        .replace('"', "&quot;")
+}
+
+/// The status as a self-refreshing HTML page
+pub fn render_html(status: &StatusSnapshot) -> String {
+    let totals = &status.totals;
+    let mut html = String::new();
+    let _ = write!(
+        html,
+        "<!DOCTYPE html><html><head><meta charset=\"utf-8\">\
+         <meta http-equiv=\"refresh\" content=\"{REFRESH_SECS}\">\
+         <title>IoTCraft MQTT Server</title><style>\
+         body{{font-family:sans-serif;margin:2em}}\
+         table{{border-collapse:collapse;margin-bottom:2em}}\
+         th,td{{padding:.3em .8em;text-align:right;border-bottom:1px solid #ddd}}\
+         th:first-child,td:first-child{{text-align:left}}\
+         .slow{{background:#fdd}}</style></head><body>\
+         <h1>IoTCraft MQTT Server</h1>\
+         <p>Up {:.0}s &middot; {} active worlds &middot; {} players &middot; \
+         {:.1} msg/s &middot; {:.1} block edits/s &middot; {:.1} pose deliveries/s &middot; \
+         {} snapshots served ({} KB) &middot; {} slow clients</p>\
+         <p><a href=\"/status.json\">status.json</a> &middot; <a href=\"/metrics\">metrics</a></p>",
+        status.uptime_secs,
+        totals.active_worlds,
+        totals.players,
+        totals.messages_per_sec,
+        totals.block_edits_per_sec,
+        totals.pose_fanout_per_sec,
+        totals.snapshots_served,
+        totals.bytes_served / 1024,
+        totals.slow_clients,
+    );
+
+    let limits = &status.limits;
+    let _ = write!(
+        html,
+        "<p>Over client budgets: {} dropped ({} KB) &middot; {} poses coalesced, {} applied \
+         &middot; {} quarantines, {} messages ignored</p>",
+        limits.dropped,
+        limits.dropped_bytes / 1024,
+        limits.coalesced,
+        limits.coalesced_applied,
+        limits.quarantines,
+        limits.quarantined_messages,
+    );
+    if !status.quarantined.is_empty() {
+        let names: Vec<_> = status.quarantined.iter().map(|id| escape(id)).collect();
+        let _ = write!(
+            html,
+            "<p class=\"slow\">Quarantined: {}</p>",
+            names.join(", ")
+        );
+    }
+
+    html.push_str(
+        "<h2>Worlds</h2><table><tr><th>World</th><th>Players</th><th>Blocks</th>\
+         <th>Snapshot KB</th><th>msg/s</th><th>Edits/s</th><th>Poses/s</th>\
+         <th>Pose fan-out/s</th></tr>",
+    );
+    for world in &status.worlds {
+        let _ = write!(
+            html,
+            "<tr><td>{}</td><td>{}</td><td>{}</td><td>{:.1}</td><td>{:.1}</td>\
+             <td>{:.1}</td><td>{:.1}</td><td>{:.1}</td></tr>",
+            escape(&world.world_id),
+            world.players,
+            world.blocks,
+            world.snapshot_bytes as f64 / 1024.0,
+            world.messages_per_sec,
+            world.block_edits_per_sec,
+            world.poses_per_sec,
+            world.pose_fanout_per_sec,
+        );
+    }
+    html.push_str("</table>");
+
+    let _ = write!(
+        html,
+        "<h2>Clients</h2><p>Delivery lag is the round trip of a broker probe through the \
+         client, behind everything queued for it; clients above {SLOW_CLIENT_LAG_MS:.0} ms \
+         are highlighted. Publish latency is the age of a client's poses when routed and \
+         includes its clock offset.</p>\
+         <table><tr><th>Client</th><th>World</th><th>Poses/s</th><th>Delivery lag ms</th>\
+         <th>Max delivery lag ms</th><th>Publish latency ms</th><th>Idle s</th></tr>"
+    );
+    for client in &status.clients {
+        let delivery_lag = client
+            .delivery_lag_ms
+            .map_or_else(|| "-".to_string(), |lag| format!("{lag:.0}"));
+        let _ = write!(
+            html,
+            "<tr{}><td>{}</td><td>{}</td><td>{:.1}</td><td>{}</td><td>{:.0}</td>\
+             <td>{:.0}</td><td>{:.1}</td></tr>",
+            if client.slow { " class=\"slow\"" } else { "" },
+            escape(&client.client_id),
+            escape(&client.world_id),
+            client.poses_per_sec,
+            delivery_lag,
+            client.max_delivery_lag_ms,
+            client.publish_latency_ms,
+            client.idle_secs,
+        );
+    }
+    html.push_str("</table></body></html>");
+    html
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::metrics::{ClientStatus, WorldStatus};
+
+    #[test]
+    fn routes_requests_and_escapes_names() {
+        let status: SharedStatus = Arc::new(Mutex::new(StatusSnapshot {
+            worlds: vec![WorldStatus {
+                world_id: "<script>".to_string(),
+                players: 2,
+                ..WorldStatus::default()
+            }],
+            clients: vec![ClientStatus {
+                client_id: "laggy".to_string(),
+                slow: true,
+                ..ClientStatus::default()
+            }],
+            ..StatusSnapshot::default()
+        }));
+        let get = |path: &str| {
+            let request = format!("GET {path} HTTP/1.1\r\nHost: localhost\r\n\r\n");
+            String::from_utf8(respond(request.as_bytes(), &status)).unwrap()
+        };
+
+        let page = get("/");
+        assert!(page.starts_with("HTTP/1.1 200 OK"));
+        assert!(page.contains("&lt;script&gt;"));
+        assert!(!page.contains("<td><script>"));
+        assert!(page.contains("class=\"slow\""));
+
+        assert!(get("/status.json?pretty").contains("\"world_id\":\"<script>\""));
+        assert!(get("/metrics").contains("iotcraft_world_players"));
+        assert!(get("/nope").starts_with("HTTP/1.1 404"));
+        assert!(
+            String::from_utf8(respond(b"POST / HTTP/1.1\r\n\r\n", &status))
+                .unwrap()
+                .starts_with("HTTP/1.1 405")
+        );
+    }
+}
@@ -0,0 +1,1602 @@
+//! Authoritative world state kept by the broker itself.
+//!
+//! The broker's extension link subscribes to [`WORLD_TOPIC_FILTER`] and feeds every
+//! publish through [`WorldStore::handle`]. World snapshots, block changes and player poses
+//! keep one [`WorldState`] per world id, so snapshot and chunk requests from joining
+//! clients are answered from memory instead of waiting for the hosting desktop client to
+//! re-publish its world.
+//!
+//! Snapshots too large for one message arrive deflated and split into parts on
+//! `iotcraft/worlds/{id}/data/chunk`; the store reassembles and inflates them and then
+//! treats the result like a snapshot published on `data`.
+//!
+//! Edits are folded into a fresh snapshot by compaction, either when a joiner asks for
+//! the world or when [`WorldStore::maintain`] finds too many or too old pending edits. With
+//! a [`Storage`] attached, worlds are also kept on disk in the region format of
+//! [`crate::region`] and restored when the broker restarts.
+//!
+//! Request topics (replies go to the requesting client only):
+//!
+//! - `iotcraft/worlds/{id}/snapshot/request` with `{"client_id"}` is answered on
+//!   `iotcraft/worlds/{id}/clients/{client_id}/data` with the full `WorldSaveData` JSON
+//! - `iotcraft/worlds/{id}/chunks/request` with `{"client_id", "chunks": [[cx, cy, cz]]}`
+//!   is answered on `iotcraft/worlds/{id}/clients/{client_id}/chunks`
+//!
+//! The broker advertises these requests with a retained [`features`] message on
+//! [`FEATURES_TOPIC`], so clients of a plain broker do not wait for answers that never come.
+
+use crate::region::{RegionPos, Storage, region_of};
+use bytes::Bytes;
+use serde::{Deserialize, Serialize};
+use serde_json::Value;
+use std::collections::{HashMap, HashSet};
+use std::time::{Duration, Instant};
+use tracing::{debug, info, warn};
+
+/// Topic filter the extension link subscribes to
+pub const WORLD_TOPIC_FILTER: &str = "iotcraft/worlds/#";
+
+/// Retained topic on which the broker advertises what it answers
+pub const FEATURES_TOPIC: &str = "iotcraft/broker/features";
+
+/// Payload of [`FEATURES_TOPIC`]
+pub fn features() -> String {
+    serde_json::json!({
+        "snapshot_requests": true,
+        "chunk_requests": true,
+        "chunk_size": CHUNK_SIZE,
+    })
+    .to_string()
+}
+
+/// Edge length of the cubic chunks answered by chunk requests (matches the client's meshes)
+pub const CHUNK_SIZE: i32 = 16;
+
+/// Most chunks answered by one chunk request
+pub const MAX_CHUNKS_PER_REQUEST: usize = 256;
+
+/// Most parts a chunked snapshot may be split into (the desktop client's own limit)
+const MAX_SNAPSHOT_PARTS: u32 = 1000;
+
+/// Largest chunked snapshot accepted, both deflated and inflated
+const MAX_SNAPSHOT_BYTES: usize = 256 * 1024 * 1024;
+
+/// An incomplete chunked snapshot is dropped after this long without a new part
+const SNAPSHOT_ASSEMBLY_TIMEOUT: Duration = Duration::from_secs(30);
+
+const WORLDS_PREFIX: &str = "iotcraft/worlds/";
+
+/// Block type names the desktop client's `BlockType` serializes to; edits and snapshots
+/// naming anything else are rejected, so clients cannot grow a world's palette
+pub const BLOCK_TYPES: [&str; 7] = [
+    "Grass",
+    "Dirt",
+    "Stone",
+    "QuartzBlock",
+    "GlassPane",
+    "CyanTerracotta",
+    "Water",
+];
+
+/// Most distinct block types one world stores; blocks of further types are dropped
+const MAX_PALETTE_SIZE: usize = 256;
+
+/// Most worlds the store keeps; messages for further world ids are rejected
+pub const MAX_WORLDS: usize = 1024;
+
+fn known_block_type(block_type: &str) -> bool {
+    BLOCK_TYPES.contains(&block_type)
+}
+
+pub type BlockPos = [i32; 3];
+pub type ChunkPos = [i32; 3];
+
+/// Chunk containing a block position
+pub fn chunk_of(pos: BlockPos) -> ChunkPos {
+    pos.map(|c| c.div_euclid(CHUNK_SIZE))
+}
+
+/// A message the extension publishes back through the broker
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct Reply {
+    pub topic: String,
+    pub payload: Bytes,
+}
+
+/// What a topic under `iotcraft/worlds/{id}/` carries
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub(crate) enum WorldTopic<'a> {
+    Info,
+    Data,
+    DataChunk,
+    BlockPlaced,
+    BlockRemoved,
+    /// Many block edits in one message, as sent for the bulk editing tools
+    BlockBatch,
+    Changes,
+    Pose(&'a str),
+    /// A client's echo of a latency probe, see `metrics`
+    ProbeReply(&'a str),
+    SnapshotRequest,
+    ChunkRequest,
+}
+
+/// Split a topic into its world id and kind; `None` for topics the store does not track,
+/// including the replies it publishes itself
+pub(crate) fn parse_topic(topic: &str) -> Option<(&str, WorldTopic<'_>)> {
+    let (world_id, rest) = topic.strip_prefix(WORLDS_PREFIX)?.split_once('/')?;
+    let kind = match rest {
+        "info" => WorldTopic::Info,
+        "data" => WorldTopic::Data,
+        "data/chunk" => WorldTopic::DataChunk,
+        "state/blocks/placed" => WorldTopic::BlockPlaced,
+        "state/blocks/removed" => WorldTopic::BlockRemoved,
+        "state/blocks/batch" => WorldTopic::BlockBatch,
+        "changes" => WorldTopic::Changes,
+        "snapshot/request" => WorldTopic::SnapshotRequest,
+        "chunks/request" => WorldTopic::ChunkRequest,
+        _ => {
+            let player = rest.strip_prefix("players/")?;
+            match player.strip_suffix("/pose") {
+                Some(player_id) => WorldTopic::Pose(player_id),
+                None => WorldTopic::ProbeReply(player.strip_suffix("/probe")?),
+            }
+        }
+    };
+    (!world_id.is_empty()).then_some((world_id, kind))
+}
+
+/// Client ids become a topic level of the reply, so they must not contain separators or
+/// wildcards
+fn valid_client_id(client_id: &str) -> bool {
+    !client_id.is_empty() && client_id.len() <= 128 && !client_id.contains(['/', '+', '#'])
+}
+
+#[derive(Debug, Serialize, Deserialize)]
+struct BlockData<'a> {
+    x: i32,
+    y: i32,
+    z: i32,
+    #[serde(borrow)]
+    block_type: std::borrow::Cow<'a, str>,
+}
+
+/// `WorldSaveData` as published by the desktop client. Everything except the blocks is
+/// kept opaque so the server does not need the client's types.
+#[derive(Debug, Deserialize)]
+struct SaveDataIn<'a> {
+    metadata: Value,
+    #[serde(borrow)]
+    blocks: Vec<BlockData<'a>>,
+    player_position: Value,
+    player_rotation: Value,
+    #[serde(default)]
+    inventory: Value,
+}
+
+#[derive(Debug, Serialize)]
+struct SaveDataOut<'a> {
+    metadata: &'a Value,
+    blocks: Vec<BlockData<'a>>,
+    player_position: &'a Value,
+    player_rotation: &'a Value,
+    #[serde(skip_serializing_if = "is_null")]
+    inventory: &'a Value,
+}
+
+fn is_null(value: &&Value) -> bool {
+    value.is_null()
+}
+
+#[derive(Debug, Deserialize)]
+enum BlockChange {
+    Placed {
+        x: i32,
+        y: i32,
+        z: i32,
+        block_type: String,
+    },
+    Removed {
+        x: i32,
+        y: i32,
+        z: i32,
+    },
+}
+
+/// Payload of `state/blocks/placed|removed`
+#[derive(Debug, Deserialize)]
+struct BlockChangeIn {
+    change: BlockChange,
+}
+
+/// Payload of `state/blocks/batch`
+#[derive(Debug, Deserialize)]
+struct BlockBatchIn {
+    changes: Vec<BlockChange>,
+}
+
+#[derive(Debug, Deserialize)]
+enum WorldChangeKind {
+    BlockPlaced {
+        x: i32,
+        y: i32,
+        z: i32,
+        block_type: String,
+    },
+    BlockRemoved {
+        x: i32,
+        y: i32,
+        z: i32,
+    },
+    PlayerJoined {
+        player_id: String,
+    },
+    PlayerLeft {
+        player_id: String,
+    },
+}
+
+/// Payload of `changes`
+#[derive(Debug, Deserialize)]
+struct WorldChangeIn {
+    change_type: WorldChangeKind,
+}
+
+/// One part of a deflated snapshot, as published on `data/chunk` by the desktop client
+#[derive(Debug, Deserialize)]
+struct SnapshotPart {
+    chunk_id: String,
+    chunk_index: u32,
+    total_chunks: u32,
+    data: Vec<u8>,
+}
+
+/// The parts of one chunked snapshot received so far
+#[derive(Debug)]
+struct SnapshotAssembly {
+    chunk_id: String,
+    parts: Vec<Option<Vec<u8>>>,
+    received: usize,
+    bytes: usize,
+    updated: Instant,
+}
+
+impl SnapshotAssembly {
+    fn new(chunk_id: String, total_chunks: u32, now: Instant) -> Self {
+        Self {
+            chunk_id,
+            parts: vec![None; total_chunks as usize],
+            received: 0,
+            bytes: 0,
+            updated: now,
+        }
+    }
+
+    fn is_complete(&self) -> bool {
+        self.received == self.parts.len()
+    }
+}
+
+/// Inflate a reassembled snapshot, refusing anything larger than [`MAX_SNAPSHOT_BYTES`]
+fn inflate_snapshot(deflated: &[u8]) -> std::io::Result<Vec<u8>> {
+    use std::io::Read;
+    let mut json = Vec::new();
+    flate2::read::DeflateDecoder::new(deflated)
+        .take(MAX_SNAPSHOT_BYTES as u64 + 1)
+        .read_to_end(&mut json)?;
+    if json.len() > MAX_SNAPSHOT_BYTES {
+        return Err(std::io::Error::new(
+            std::io::ErrorKind::InvalidData,
+            "inflated snapshot too large",
+        ));
+    }
+    Ok(json)
+}
+
+#[derive(Debug, Deserialize)]
+struct SnapshotRequest {
+    client_id: String,
+}
+
+#[derive(Debug, Deserialize)]
+struct ChunkRequest {
+    client_id: String,
+    chunks: Vec<ChunkPos>,
+}
+
+/// A block edit, as applied to a [`WorldState`] and journaled by [`crate::region::Storage`]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Edit<'a> {
+    Place(BlockPos, &'a str),
+    Remove(BlockPos),
+}
+
+/// When edits are folded into a fresh snapshot and written to disk
+#[derive(Debug, Clone, Copy)]
+pub struct CompactionPolicy {
+    /// Compact once this many edits are pending
+    pub max_edits: usize,
+    /// Compact once the oldest pending edit is this old
+    pub max_age: Duration,
+    /// Least time between two flushes to disk
+    pub persist_interval: Duration,
+}
+
+impl Default for CompactionPolicy {
+    fn default() -> Self {
+        Self {
+            max_edits: 256,
+            max_age: Duration::from_secs(2),
+            persist_interval: Duration::from_secs(10),
+        }
+    }
+}
+
+/// Everything of a world snapshot except its blocks
+#[derive(Debug, Clone, Serialize, Deserialize)]
+struct SnapshotHeader {
+    metadata: Value,
+    player_position: Value,
+    player_rotation: Value,
+    #[serde(default)]
+    inventory: Value,
+}
+
+/// Blocks of one chunk and their serialized form
+#[derive(Debug, Default)]
+struct Chunk {
+    blocks: HashMap<BlockPos, u16>,
+    /// The blocks as comma-separated `VoxelBlockData` JSON objects; `None` while the chunk
+    /// has edits that were not compacted yet
+    fragment: Option<Bytes>,
+}
+
+/// Server-side state of one shared world
+///
+/// Blocks live in 16³ chunks. An edit only marks its chunk dirty; compaction re-serializes
+/// the dirty chunks and splices every chunk's cached JSON into a fresh snapshot, so the
+/// cost of keeping the snapshot current grows with the edits, not with the world.
+#[derive(Debug, Default)]
+pub struct WorldState {
+    /// Last `SharedWorldInfo` published for the world
+    info: Option<Value>,
+    /// Set once a full snapshot was received; snapshots are only served after that
+    header: Option<SnapshotHeader>,
+    /// Block type names, indexed by the values stored in `chunks`
+    palette: Vec<String>,
+    chunks: HashMap<ChunkPos, Chunk>,
+    block_count: usize,
+    /// Last pose payload per player id
+    players: HashMap<String, Value>,
+    /// Bumped on every change to the blocks or snapshot header
+    revision: u64,
+    /// Serialized snapshot of the current revision
+    snapshot: Option<Bytes>,
+    /// Edits applied since the last compaction, and when the first of them arrived
+    pending_edits: usize,
+    oldest_edit: Option<Instant>,
+    /// Edits and poses received over the world's lifetime
+    edits: u64,
+    poses: u64,
+}
+
+impl WorldState {
+    pub fn block_count(&self) -> usize {
+        self.block_count
+    }
+
+    pub fn chunk_count(&self) -> usize {
+        self.chunks.len()
+    }
+
+    pub fn player_count(&self) -> usize {
+        self.players.len()
+    }
+
+    pub fn revision(&self) -> u64 {
+        self.revision
+    }
+
+    pub fn has_snapshot(&self) -> bool {
+        self.header.is_some()
+    }
+
+    pub fn pending_edits(&self) -> usize {
+        self.pending_edits
+    }
+
+    pub fn info(&self) -> Option<&Value> {
+        self.info.as_ref()
+    }
+
+    pub fn edit_count(&self) -> u64 {
+        self.edits
+    }
+
+    pub fn pose_count(&self) -> u64 {
+        self.poses
+    }
+
+    /// Size of the current snapshot; `None` while edits wait for compaction
+    pub fn snapshot_bytes(&self) -> Option<usize> {
+        self.snapshot.as_ref().map(Bytes::len)
+    }
+
+    pub fn block_at(&self, pos: BlockPos) -> Option<&str> {
+        let index = *self.chunks.get(&chunk_of(pos))?.blocks.get(&pos)?;
+        Some(&self.palette[index as usize])
+    }
+
+    /// Palette index of `block_type`, added if new; `None` once the palette is full
+    fn palette_index(&mut self, block_type: &str) -> Option<u16> {
+        if let Some(index) = self.palette.iter().position(|t| t == block_type) {
+            return Some(index as u16);
+        }
+        if self.palette.len() >= MAX_PALETTE_SIZE {
+            return None;
+        }
+        self.palette.push(block_type.to_string());
+        Some((self.palette.len() - 1) as u16)
+    }
+
+    fn touch(&mut self) {
+        self.edits += 1;
+        self.revision += 1;
+        self.snapshot = None;
+        self.pending_edits += 1;
+        self.oldest_edit.get_or_insert_with(Instant::now);
+    }
+
+    pub fn apply(&mut self, edit: &Edit) {
+        match *edit {
+            Edit::Place(pos, block_type) => self.set_block(pos, block_type),
+            Edit::Remove(pos) => self.remove_block(pos),
+        }
+    }
+
+    pub fn set_block(&mut self, pos: BlockPos, block_type: &str) {
+        if self.insert_block(pos, block_type) {
+            self.touch();
+        }
+    }
+
+    /// Store a block without bumping the revision; returns whether anything changed
+    fn insert_block(&mut self, pos: BlockPos, block_type: &str) -> bool {
+        let Some(index) = self.palette_index(block_type) else {
+            warn!("Palette full, dropping block of type {:?}", block_type);
+            return false;
+        };
+        let chunk = self.chunks.entry(chunk_of(pos)).or_default();
+        let previous = chunk.blocks.insert(pos, index);
+        if previous == Some(index) {
+            return false;
+        }
+        chunk.fragment = None;
+        if previous.is_none() {
+            self.block_count += 1;
+        }
+        true
+    }
+
+    pub fn remove_block(&mut self, pos: BlockPos) {
+        let chunk_pos = chunk_of(pos);
+        let Some(chunk) = self.chunks.get_mut(&chunk_pos) else {
+            return;
+        };
+        if chunk.blocks.remove(&pos).is_none() {
+            return;
+        }
+        chunk.fragment = None;
+        if chunk.blocks.is_empty() {
+            self.chunks.remove(&chunk_pos);
+        }
+        self.block_count -= 1;
+        self.touch();
+    }
+
+    /// Replace the whole world with a published snapshot. `payload` is the snapshot's
+    /// JSON and is served as-is until the next change.
+    fn load_snapshot(&mut self, data: SaveDataIn, payload: Bytes) {
+        self.chunks.clear();
+        self.block_count = 0;
+        for block in &data.blocks {
+            self.insert_block([block.x, block.y, block.z], &block.block_type);
+        }
+        self.header = Some(SnapshotHeader {
+            metadata: data.metadata,
+            player_position: data.player_position,
+            player_rotation: data.player_rotation,
+            inventory: data.inventory,
+        });
+        self.revision += 1;
+        self.pending_edits = 0;
+        self.oldest_edit = None;
+        self.snapshot = Some(payload);
+    }
+
+    /// Whether `policy` asks for the pending edits to be compacted at `now`
+    fn needs_compaction(&self, policy: &CompactionPolicy, now: Instant) -> bool {
+        self.pending_edits >= policy.max_edits
+            || self
+                .oldest_edit
+                .is_some_and(|oldest| now.duration_since(oldest) >= policy.max_age)
+    }
+
+    /// Serialize the dirty chunks; returns how many were rebuilt
+    fn compact_chunks(&mut self) -> usize {
+        let mut rebuilt = 0;
+        for chunk in self.chunks.values_mut() {
+            if chunk.fragment.is_some() {
+                continue;
+            }
+            let mut fragment = Vec::with_capacity(chunk.blocks.len() * 48);
+            for (&[x, y, z], &index) in &chunk.blocks {
+                if !fragment.is_empty() {
+                    fragment.push(b',');
+                }
+                let block = BlockData {
+                    x,
+                    y,
+                    z,
+                    block_type: self.palette[index as usize].as_str().into(),
+                };
+                // Writing plain structs into a Vec cannot fail
+                let _ = serde_json::to_writer(&mut fragment, &block);
+            }
+            chunk.fragment = Some(Bytes::from(fragment));
+            rebuilt += 1;
+        }
+        self.pending_edits = 0;
+        self.oldest_edit = None;
+        rebuilt
+    }
+
+    /// Fold pending edits into a fresh snapshot; returns how many chunks were rebuilt
+    pub fn compact(&mut self) -> usize {
+        let rebuilt = self.compact_chunks();
+        let Some(header) = &self.header else {
+            return rebuilt;
+        };
+        let fragments = self.chunks.values().filter_map(|c| c.fragment.as_ref());
+        let mut out =
+            Vec::with_capacity(fragments.clone().map(|f| f.len() + 1).sum::<usize>() + 512);
+        out.extend_from_slice(br#"{"metadata":"#);
+        let _ = serde_json::to_writer(&mut out, &header.metadata);
+        out.extend_from_slice(br#","blocks":["#);
+        for (i, fragment) in fragments.enumerate() {
+            if i > 0 {
+                out.push(b',');
+            }
+            out.extend_from_slice(fragment);
+        }
+        out.extend_from_slice(br#"],"player_position":"#);
+        let _ = serde_json::to_writer(&mut out, &header.player_position);
+        out.extend_from_slice(br#","player_rotation":"#);
+        let _ = serde_json::to_writer(&mut out, &header.player_rotation);
+        if !header.inventory.is_null() {
+            out.extend_from_slice(br#","inventory":"#);
+            let _ = serde_json::to_writer(&mut out, &header.inventory);
+        }
+        out.push(b'}');
+        self.snapshot = Some(Bytes::from(out));
+        rebuilt
+    }
+
+    /// `WorldSaveData` JSON of the current revision, compacting pending edits first
+    pub fn snapshot(&mut self) -> Option<Bytes> {
+        if self.snapshot.is_none() {
+            self.compact();
+        }
+        self.snapshot.clone()
+    }
+
+    /// JSON answer to a chunk request; requested chunks without blocks are listed empty
+    fn chunk_reply(&mut self, world_id: &str, chunks: &[ChunkPos]) -> Bytes {
+        self.compact_chunks();
+        let mut out = Vec::new();
+        out.extend_from_slice(br#"{"world_id":"#);
+        let _ = serde_json::to_writer(&mut out, world_id);
+        out.extend_from_slice(
+            format!(
+                r#","revision":{},"chunk_size":{},"chunks":["#,
+                self.revision, CHUNK_SIZE
+            )
+            .as_bytes(),
+        );
+        for (i, &[x, y, z]) in chunks.iter().take(MAX_CHUNKS_PER_REQUEST).enumerate() {
+            if i > 0 {
+                out.push(b',');
+            }
+            out.extend_from_slice(format!(r#"{{"chunk":[{x},{y},{z}],"blocks":["#).as_bytes());
+            if let Some(fragment) = self
+                .chunks
+                .get(&[x, y, z])
+                .and_then(|c| c.fragment.as_ref())
+            {
+                out.extend_from_slice(fragment);
+            }
+            out.extend_from_slice(b"]}");
+        }
+        out.extend_from_slice(b"]}");
+        Bytes::from(out)
+    }
+
+    /// Regions holding at least one block
+    pub fn regions(&self) -> HashSet<RegionPos> {
+        self.chunks.keys().map(|&chunk| region_of(chunk)).collect()
+    }
+
+    /// Blocks inside one region
+    pub fn region_blocks(&self, region: RegionPos) -> Vec<(BlockPos, &str)> {
+        let mut blocks = Vec::new();
+        for (chunk_pos, chunk) in &self.chunks {
+            if region_of(*chunk_pos) != region {
+                continue;
+            }
+            blocks.extend(
+                chunk
+                    .blocks
+                    .iter()
+                    .map(|(&pos, &index)| (pos, self.palette[index as usize].as_str())),
+            );
+        }
+        blocks
+    }
+
+    /// Everything but the blocks, as stored in a persisted world's `world.json`
+    pub fn persisted_header(&self) -> Value {
+        serde_json::json!({
+            "revision": self.revision,
+            "info": self.info,
+            "snapshot": self.header,
+        })
+    }
+
+    /// An empty world with the info and header of [`WorldState::persisted_header`]
+    pub fn restore(persisted: &Value) -> Self {
+        Self {
+            info: persisted
+                .get("info")
+                .filter(|info| !info.is_null())
+                .cloned(),
+            header: persisted
+                .get("snapshot")
+                .and_then(|header| serde_json::from_value(header.clone()).ok()),
+            revision: persisted
+                .get("revision")
+                .and_then(Value::as_u64)
+                .unwrap_or(0),
+            ..Self::default()
+        }
+    }
+}
+
+/// Counters of the work done by a [`WorldStore`]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct StoreStats {
+    pub messages: u64,
+    pub rejected: u64,
+    pub snapshots_served: u64,
+    pub chunk_requests: u64,
+    pub bytes_served: u64,
+    pub compactions: u64,
+    pub chunks_compacted: u64,
+}
+
+/// Server-side state of every shared world, keyed by world id
+#[derive(Debug, Default)]
+pub struct WorldStore {
+    worlds: HashMap<String, WorldState>,
+    /// Chunked snapshots being received, by world id
+    assemblies: HashMap<String, SnapshotAssembly>,
+    policy: CompactionPolicy,
+    storage: Option<Storage>,
+    last_persist: Option<Instant>,
+    /// The last flush failed; replaced worlds then wait for the persist interval too
+    persist_failed: bool,
+    pub stats: StoreStats,
+}
+
+impl WorldStore {
+    /// A store persisting to `storage`, starting from the worlds saved there
+    pub fn with_storage(storage: Storage, policy: CompactionPolicy) -> std::io::Result<Self> {
+        let worlds: HashMap<String, WorldState> = storage.load()?.into_iter().collect();
+        for (world_id, world) in &worlds {
+            info!(
+                "Restored world {}: {} blocks in {} chunks",
+                world_id,
+                world.block_count(),
+                world.chunk_count()
+            );
+        }
+        Ok(Self {
+            worlds,
+            policy,
+            storage: Some(storage),
+            ..Self::default()
+        })
+    }
+
+    pub fn world(&self, world_id: &str) -> Option<&WorldState> {
+        self.worlds.get(world_id)
+    }
+
+    pub fn world_count(&self) -> usize {
+        self.worlds.len()
+    }
+
+    pub fn worlds(&self) -> impl Iterator<Item = (&str, &WorldState)> {
+        self.worlds
+            .iter()
+            .map(|(world_id, world)| (world_id.as_str(), world))
+    }
+
+    /// The world `world_id`, created if the store has room for it
+    fn world_mut(&mut self, world_id: &str) -> Option<&mut WorldState> {
+        if !self.worlds.contains_key(world_id) {
+            if self.worlds.len() >= MAX_WORLDS {
+                self.stats.rejected += 1;
+                warn!(
+                    "Already keeping {} worlds, ignoring world {}",
+                    MAX_WORLDS, world_id
+                );
+                return None;
+            }
+            self.worlds
+                .insert(world_id.to_string(), WorldState::default());
+        }
+        self.worlds.get_mut(world_id)
+    }
+
+    fn apply_edit(&mut self, world_id: &str, edit: Edit) {
+        if let Edit::Place(_, block_type) = edit {
+            if !known_block_type(block_type) {
+                self.stats.rejected += 1;
+                warn!(
+                    "Ignoring edit of world {} with unknown block type {:?}",
+                    world_id, block_type
+                );
+                return;
+            }
+        }
+        let Some(world) = self.world_mut(world_id) else {
+            return;
+        };
+        world.apply(&edit);
+        if let Some(storage) = &mut self.storage {
+            storage.record_edit(world_id, &edit);
+        }
+    }
+
+    fn apply_block_change(&mut self, world_id: &str, change: BlockChange) {
+        match change {
+            BlockChange::Placed {
+                x,
+                y,
+                z,
+                block_type,
+            } => self.apply_edit(world_id, Edit::Place([x, y, z], &block_type)),
+            BlockChange::Removed { x, y, z } => self.apply_edit(world_id, Edit::Remove([x, y, z])),
+        }
+    }
+
+    /// Apply one publish routed by the broker; returns the reply to publish, if any
+    pub fn handle(&mut self, topic: &str, payload: &[u8]) -> Option<Reply> {
+        let (world_id, kind) = parse_topic(topic)?;
+        self.stats.messages += 1;
+        let reply = match kind {
+            WorldTopic::Info | WorldTopic::Data if payload.is_empty() => {
+                // Hosts unpublish a world by clearing its retained topics
+                self.assemblies.remove(world_id);
+                if self.worlds.remove(world_id).is_some() {
+                    info!("World {} unpublished, dropped its server state", world_id);
+                }
+                if let Some(storage) = &mut self.storage {
+                    storage.remove_world(world_id);
+                }
+                Ok(None)
+            }
+            WorldTopic::Info => serde_json::from_slice(payload).map(|info| {
+                if let Some(world) = self.world_mut(world_id) {
+                    world.info = Some(info);
+                    if let Some(storage) = &mut self.storage {
+                        storage.mark_header(world_id);
+                    }
+                }
+                None
+            }),
+            WorldTopic::Data => self
+                .store_snapshot(world_id, Bytes::copy_from_slice(payload))
+                .map(|()| None),
+            WorldTopic::DataChunk => serde_json::from_slice::<SnapshotPart>(payload).map(|part| {
+                self.add_snapshot_part(world_id, part, Instant::now());
+                None
+            }),
+            WorldTopic::BlockPlaced | WorldTopic::BlockRemoved => {
+                serde_json::from_slice::<BlockChangeIn>(payload).map(|message| {
+                    self.apply_block_change(world_id, message.change);
+                    None
+                })
+            }
+            WorldTopic::BlockBatch => {
+                serde_json::from_slice::<BlockBatchIn>(payload).map(|batch| {
+                    for change in batch.changes {
+                        self.apply_block_change(world_id, change);
+                    }
+                    None
+                })
+            }
+            WorldTopic::Changes => serde_json::from_slice::<WorldChangeIn>(payload).map(|change| {
+                match change.change_type {
+                    WorldChangeKind::BlockPlaced {
+                        x,
+                        y,
+                        z,
+                        block_type,
+                    } => self.apply_edit(world_id, Edit::Place([x, y, z], &block_type)),
+                    WorldChangeKind::BlockRemoved { x, y, z } => {
+                        self.apply_edit(world_id, Edit::Remove([x, y, z]))
+                    }
+                    WorldChangeKind::PlayerJoined { player_id } => {
+                        if let Some(world) = self.world_mut(world_id) {
+                            world.players.entry(player_id).or_insert(Value::Null);
+                        }
+                    }
+                    WorldChangeKind::PlayerLeft { player_id } => {
+                        if let Some(world) = self.worlds.get_mut(world_id) {
+                            world.players.remove(&player_id);
+                        }
+                    }
+                }
+                None
+            }),
+            WorldTopic::Pose(player_id) => serde_json::from_slice(payload).map(|pose| {
+                if let Some(world) = self.world_mut(world_id) {
+                    world.players.insert(player_id.to_string(), pose);
+                    world.poses += 1;
+                }
+                None
+            }),
+            // Timed by the metrics, nothing to keep
+            WorldTopic::ProbeReply(_) => Ok(None),
+            WorldTopic::SnapshotRequest => serde_json::from_slice::<SnapshotRequest>(payload)
+                .map(|request| self.serve_snapshot(world_id, &request.client_id)),
+            WorldTopic::ChunkRequest => serde_json::from_slice::<ChunkRequest>(payload)
+                .map(|request| self.serve_chunks(world_id, &request.client_id, &request.chunks)),
+        };
+
+        match reply {
+            Ok(reply) => {
+                if let Some(reply) = &reply {
+                    self.stats.bytes_served += reply.payload.len() as u64;
+                }
+                reply
+            }
+            Err(e) => {
+                self.stats.rejected += 1;
+                warn!("Ignoring malformed payload on {}: {}", topic, e);
+                None
+            }
+        }
+    }
+
+    /// Replace a world with a snapshot; `payload` is its `WorldSaveData` JSON
+    fn store_snapshot(&mut self, world_id: &str, payload: Bytes) -> serde_json::Result<()> {
+        let data = serde_json::from_slice::<SaveDataIn>(&payload)?;
+        if let Some(block) = data
+            .blocks
+            .iter()
+            .find(|b| !known_block_type(&b.block_type))
+        {
+            self.stats.rejected += 1;
+            warn!(
+                "Rejecting snapshot of world {}: unknown block type {:?}",
+                world_id, block.block_type
+            );
+            return Ok(());
+        }
+        let Some(world) = self.world_mut(world_id) else {
+            return Ok(());
+        };
+        world.load_snapshot(data, payload.clone());
+        info!(
+            "World {} snapshot stored: {} blocks in {} chunks (revision {})",
+            world_id,
+            world.block_count(),
+            world.chunk_count(),
+            world.revision()
+        );
+        if let Some(storage) = &mut self.storage {
+            storage.mark_replaced(world_id);
+        }
+        Ok(())
+    }
+
+    /// Collect one part of a chunked snapshot; the last part to arrive stores the world
+    fn add_snapshot_part(&mut self, world_id: &str, part: SnapshotPart, now: Instant) {
+        if part.total_chunks == 0
+            || part.total_chunks > MAX_SNAPSHOT_PARTS
+            || part.chunk_index >= part.total_chunks
+        {
+            self.stats.rejected += 1;
+            warn!(
+                "Ignoring snapshot part {}/{} of world {}",
+                part.chunk_index, part.total_chunks, world_id
+            );
+            return;
+        }
+        if !self.worlds.contains_key(world_id) && self.worlds.len() >= MAX_WORLDS {
+            self.stats.rejected += 1;
+            warn!(
+                "Already keeping {} worlds, ignoring snapshot of world {}",
+                MAX_WORLDS, world_id
+            );
+            return;
+        }
+
+        let assembly = self
+            .assemblies
+            .entry(world_id.to_string())
+            .or_insert_with(|| {
+                SnapshotAssembly::new(part.chunk_id.clone(), part.total_chunks, now)
+            });
+        // A new upload supersedes one still in progress
+        if assembly.chunk_id != part.chunk_id || assembly.parts.len() != part.total_chunks as usize
+        {
+            *assembly = SnapshotAssembly::new(part.chunk_id, part.total_chunks, now);
+        }
+        let slot = &mut assembly.parts[part.chunk_index as usize];
+        if let Some(previous) = slot.replace(part.data) {
+            assembly.bytes -= previous.len();
+        } else {
+            assembly.received += 1;
+        }
+        assembly.bytes += slot.as_ref().map_or(0, Vec::len);
+        assembly.updated = now;
+
+        if assembly.bytes > MAX_SNAPSHOT_BYTES {
+            self.assemblies.remove(world_id);
+            self.stats.rejected += 1;
+            warn!("Chunked snapshot of world {} too large, dropped", world_id);
+            return;
+        }
+        if !assembly.is_complete() {
+            return;
+        }
+
+        let Some(assembly) = self.assemblies.remove(world_id) else {
+            return;
+        };
+        let deflated: Vec<u8> = assembly.parts.into_iter().flatten().flatten().collect();
+        let stored = inflate_snapshot(&deflated)
+            .map_err(|e| e.to_string())
+            .and_then(|json| {
+                debug!(
+                    "Reassembled snapshot of world {} from {} parts ({} -> {} bytes)",
+                    world_id,
+                    assembly.received,
+                    deflated.len(),
+                    json.len()
+                );
+                self.store_snapshot(world_id, Bytes::from(json))
+                    .map_err(|e| e.to_string())
+            });
+        if let Err(e) = stored {
+            self.stats.rejected += 1;
+            warn!("Ignoring chunked snapshot of world {}: {}", world_id, e);
+        }
+    }
+
+    /// Compact worlds whose pending edits exceed the policy and flush changes to disk
+    /// once the persist interval has passed
+    pub fn maintain(&mut self, now: Instant) {
+        self.assemblies.retain(|world_id, assembly| {
+            let alive = now.duration_since(assembly.updated) < SNAPSHOT_ASSEMBLY_TIMEOUT;
+            if !alive {
+                warn!(
+                    "Chunked snapshot of world {} timed out with {}/{} parts",
+                    world_id,
+                    assembly.received,
+                    assembly.parts.len()
+                );
+            }
+            alive
+        });
+
+        for (world_id, world) in &mut self.worlds {
+            if !world.needs_compaction(&self.policy, now) {
+                continue;
+            }
+            let edits = world.pending_edits();
+            let rebuilt = world.compact();
+            self.stats.compactions += 1;
+            self.stats.chunks_compacted += rebuilt as u64;
+            debug!(
+                "Compacted {} edits of world {} into a fresh snapshot ({} chunks rebuilt)",
+                edits, world_id, rebuilt
+            );
+        }
+
+        let Some(storage) = &mut self.storage else {
+            return;
+        };
+        let due = self
+            .last_persist
+            .is_none_or(|last| now.duration_since(last) >= self.policy.persist_interval);
+        let urgent = storage.has_replaced() && !self.persist_failed;
+        if (due || urgent) && storage.has_pending() {
+            let flushed = storage.flush(&self.worlds);
+            if let Err(e) = &flushed {
+                warn!("Failed to persist world state: {}", e);
+            }
+            self.persist_failed = flushed.is_err();
+            self.last_persist = Some(now);
+        }
+    }
+
+    fn serve_snapshot(&mut self, world_id: &str, client_id: &str) -> Option<Reply> {
+        if !valid_client_id(client_id) {
+            warn!("Snapshot request for {} with invalid client id", world_id);
+            return None;
+        }
+        let Some(snapshot) = self.worlds.get_mut(world_id).and_then(WorldState::snapshot) else {
+            debug!(
+                "No snapshot of world {} for {} yet, leaving it to the host",
+                world_id, client_id
+            );
+            return None;
+        };
+        self.stats.snapshots_served += 1;
+        debug!(
+            "Serving snapshot of world {} to {} ({} bytes)",
+            world_id,
+            client_id,
+            snapshot.len()
+        );
+        Some(Reply {
+            topic: format!("{WORLDS_PREFIX}{world_id}/clients/{client_id}/data"),
+            payload: snapshot,
+        })
+    }
+
+    fn serve_chunks(
+        &mut self,
+        world_id: &str,
+        client_id: &str,
+        chunks: &[ChunkPos],
+    ) -> Option<Reply> {
+        if !valid_client_id(client_id) {
+            warn!("Chunk request for {} with invalid client id", world_id);
+            return None;
+        }
+        let payload = self.worlds.get_mut(world_id)?.chunk_reply(world_id, chunks);
+        self.stats.chunk_requests += 1;
+        Some(Reply {
+            topic: format!("{WORLDS_PREFIX}{world_id}/clients/{client_id}/chunks"),
+            payload,
+        })
+    }
+}
+
+/// Timings of serving a burst of joins from a [`WorldStore`]
+#[derive(Debug, Clone)]
+pub struct JoinBench {
+    pub blocks: usize,
+    pub joins: usize,
+    pub snapshot_bytes: usize,
+    /// Parsing and indexing the published snapshot
+    pub ingest: Duration,
+    /// All joins arriving together, served from the cached snapshot
+    pub burst: Duration,
+    /// The same joins sent at once from `threads` client threads, each copying its
+    /// reply as a socket write would
+    pub parallel: Duration,
+    pub threads: usize,
+    /// Every join preceded by a block edit, so each one compacts the edited chunk
+    pub edited: Duration,
+    /// Every join fetching the 27 chunks around the spawn point instead of the snapshot
+    pub chunked: Duration,
+    pub chunk_bytes: usize,
+}
+
+impl JoinBench {
+    pub fn report(&self) -> String {
+        let rate = |elapsed: Duration| self.joins as f64 / elapsed.as_secs_f64().max(1e-9);
+        let mb = |bytes: usize, elapsed: Duration| {
+            (bytes * self.joins) as f64 / 1_048_576.0 / elapsed.as_secs_f64().max(1e-9)
+        };
+        format!(
+            "{} joins of a {} block world ({:.2} MB snapshot), ingest {:.1} ms\n  \
+             burst (cached snapshot): {:.0} joins/s\n  \
+             parallel ({} threads):   {:.0} joins/s, {:.0} MB/s\n  \
+             edit between joins:      {:.0} joins/s, {:.0} MB/s\n  \
+             spawn chunks only:       {:.0} joins/s ({} bytes per join)",
+            self.joins,
+            self.blocks,
+            self.snapshot_bytes as f64 / 1_048_576.0,
+            self.ingest.as_secs_f64() * 1000.0,
+            rate(self.burst),
+            self.threads,
+            rate(self.parallel),
+            mb(self.snapshot_bytes, self.parallel),
+            rate(self.edited),
+            mb(self.snapshot_bytes, self.edited),
+            rate(self.chunked),
+            self.chunk_bytes,
+        )
+    }
+}
+
+/// `WorldSaveData` JSON of a flat three-layer world spanning `-radius..=radius`
+pub fn synthetic_world(radius: i32) -> Vec<u8> {
+    let layers = [(0, "Stone"), (1, "Dirt"), (2, "Grass")];
+    let mut blocks = Vec::new();
+    for x in -radius..=radius {
+        for z in -radius..=radius {
+            for (y, block_type) in layers {
+                blocks.push(BlockData {
+                    x,
+                    y,
+                    z,
+                    block_type: block_type.into(),
+                });
+            }
+        }
+    }
+    let metadata = serde_json::json!({
+        "name": "bench",
+        "description": "Synthetic join benchmark world",
+        "created_at": "",
+        "last_played": "",
+        "version": "1.0.0",
+    });
+    let position = serde_json::json!([0.0, 4.0, 0.0]);
+    let rotation = serde_json::json!([0.0, 0.0, 0.0, 1.0]);
+    serde_json::to_vec(&SaveDataOut {
+        metadata: &metadata,
+        blocks,
+        player_position: &position,
+        player_rotation: &rotation,
+        inventory: &Value::Null,
+    })
+    .unwrap_or_default()
+}
+
+/// Client threads sending joins at once in the parallel part of [`bench_joins`]
+const BENCH_CLIENT_THREADS: usize = 8;
+
+/// Send `requests` from [`BENCH_CLIENT_THREADS`] client threads at once and answer them on
+/// the calling thread, the way the broker's link serializes them into the store. Returns
+/// the time until every client has its reply and the number of client threads.
+fn parallel_joins(store: &mut WorldStore, topic: &str, requests: &[Vec<u8>]) -> (Duration, usize) {
+    use std::sync::{Barrier, mpsc};
+
+    let shares: Vec<&[Vec<u8>]> = requests
+        .chunks(requests.len().div_ceil(BENCH_CLIENT_THREADS).max(1))
+        .collect();
+    let barrier = Barrier::new(shares.len() + 1);
+    let (request_tx, request_rx) = mpsc::channel::<(&[u8], mpsc::Sender<Bytes>)>();
+
+    let start = std::thread::scope(|scope| {
+        for share in &shares {
+            let request_tx = request_tx.clone();
+            let barrier = &barrier;
+            scope.spawn(move || {
+                let (reply_tx, reply_rx) = mpsc::channel();
+                barrier.wait();
+                for request in *share {
+                    let _ = request_tx.send((request.as_slice(), reply_tx.clone()));
+                }
+                drop(reply_tx);
+                for reply in reply_rx {
+                    std::hint::black_box(reply.to_vec());
+                }
+            });
+        }
+        drop(request_tx);
+        barrier.wait();
+        let start = Instant::now();
+        for (request, reply_tx) in request_rx {
+            if let Some(reply) = store.handle(topic, request) {
+                let _ = reply_tx.send(reply.payload);
+            }
+        }
+        start
+    });
+    (start.elapsed(), shares.len())
+}
+
+/// Serve `joins` joining clients a synthetic world of the given radius and time it
+pub fn bench_joins(radius: i32, joins: usize) -> JoinBench {
+    const WORLD: &str = "bench";
+    let data = synthetic_world(radius);
+    let mut store = WorldStore::default();
+
+    let start = Instant::now();
+    store.handle(&format!("{WORLDS_PREFIX}{WORLD}/data"), &data);
+    let ingest = start.elapsed();
+    let blocks = store.world(WORLD).map_or(0, WorldState::block_count);
+
+    let requests: Vec<Vec<u8>> = (0..joins)
+        .map(|i| format!(r#"{{"client_id":"bench-{i}"}}"#).into_bytes())
+        .collect();
+    let snapshot_topic = format!("{WORLDS_PREFIX}{WORLD}/snapshot/request");
+
+    let start = Instant::now();
+    let mut snapshot_bytes = 0;
+    for request in &requests {
+        if let Some(reply) = store.handle(&snapshot_topic, request) {
+            snapshot_bytes = reply.payload.len();
+        }
+    }
+    let burst = start.elapsed();
+
+    let (parallel, threads) = parallel_joins(&mut store, &snapshot_topic, &requests);
+
+    let placed_topic = format!("{WORLDS_PREFIX}{WORLD}/state/blocks/placed");
+    let start = Instant::now();
+    for (i, request) in requests.iter().enumerate() {
+        // Alternate the block type so every edit really changes the world
+        let block_type = if i % 2 == 0 { "Stone" } else { "Dirt" };
+        let edit = format!(
+            r#"{{"change":{{"Placed":{{"x":0,"y":3,"z":0,"block_type":"{block_type}"}}}}}}"#
+        );
+        store.handle(&placed_topic, edit.as_bytes());
+        store.handle(&snapshot_topic, request);
+    }
+    let edited = start.elapsed();
+
+    let chunk_topic = format!("{WORLDS_PREFIX}{WORLD}/chunks/request");
+    let spawn_chunks: Vec<ChunkPos> = (-1..=1)
+        .flat_map(|x| (-1..=1).flat_map(move |y| (-1..=1).map(move |z| [x, y, z])))
+        .collect();
+    let chunk_requests: Vec<Vec<u8>> = (0..joins)
+        .map(|i| {
+            serde_json::to_vec(&serde_json::json!({
+                "client_id": format!("bench-{i}"),
+                "chunks": spawn_chunks,
+            }))
+            .unwrap_or_default()
+        })
+        .collect();
+    let start = Instant::now();
+    let mut chunk_bytes = 0;
+    for request in &chunk_requests {
+        if let Some(reply) = store.handle(&chunk_topic, request) {
+            chunk_bytes = reply.payload.len();
+        }
+    }
+    let chunked = start.elapsed();
+
+    JoinBench {
+        blocks,
+        joins,
+        snapshot_bytes,
+        ingest,
+        burst,
+        parallel,
+        threads,
+        edited,
+        chunked,
+        chunk_bytes,
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn world_data(blocks: &[(BlockPos, &str)]) -> Vec<u8> {
+        let blocks: Vec<Value> = blocks
+            .iter()
+            .map(|([x, y, z], block_type)| {
+                serde_json::json!({"x": x, "y": y, "z": z, "block_type": block_type})
+            })
+            .collect();
+        serde_json::to_vec(&serde_json::json!({
+            "metadata": {"name": "test"},
+            "blocks": blocks,
+            "player_position": [0.0, 2.0, 0.0],
+            "player_rotation": [0.0, 0.0, 0.0, 1.0],
+        }))
+        .unwrap()
+    }
+
+    #[test]
+    fn test_parse_topic() {
+        assert_eq!(
+            parse_topic("iotcraft/worlds/w1/data"),
+            Some(("w1", WorldTopic::Data))
+        );
+        assert_eq!(
+            parse_topic("iotcraft/worlds/w1/players/p1/pose"),
+            Some(("w1", WorldTopic::Pose("p1")))
+        );
+        assert_eq!(
+            parse_topic("iotcraft/worlds/w1/snapshot/request"),
+            Some(("w1", WorldTopic::SnapshotRequest))
+        );
+        assert_eq!(
+            parse_topic("iotcraft/worlds/w1/players/p1/probe"),
+            Some(("w1", WorldTopic::ProbeReply("p1")))
+        );
+        // The store's own replies and unrelated topics are not tracked
+        assert_eq!(parse_topic("iotcraft/worlds/w1/clients/c1/data"), None);
+        assert_eq!(parse_topic("iotcraft/worlds/w1/clients/c1/probe"), None);
+        assert_eq!(
+            parse_topic("iotcraft/worlds/w1/data/chunk"),
+            Some(("w1", WorldTopic::DataChunk))
+        );
+        assert_eq!(parse_topic("home/sensor/temperature"), None);
+    }
+
+    #[test]
+    fn test_block_changes_update_snapshot() {
+        let mut store = WorldStore::default();
+        store.handle(
+            "iotcraft/worlds/w1/data",
+            &world_data(&[([0, 0, 0], "Grass"), ([20, 0, 0], "Stone")]),
+        );
+        store.handle(
+            "iotcraft/worlds/w1/state/blocks/placed",
+            br#"{"player_id":"p","player_name":"P","timestamp":1,"change":{"Placed":{"x":1,"y":0,"z":0,"block_type":"Dirt"}}}"#,
+        );
+        store.handle(
+            "iotcraft/worlds/w1/state/blocks/removed",
+            br#"{"player_id":"p","player_name":"P","timestamp":2,"change":{"Removed":{"x":20,"y":0,"z":0}}}"#,
+        );
+
+        let world = store.world("w1").unwrap();
+        assert_eq!(world.block_count(), 2);
+        assert_eq!(world.chunk_count(), 1);
+        assert_eq!(world.block_at([1, 0, 0]), Some("Dirt"));
+        assert_eq!(world.block_at([20, 0, 0]), None);
+
+        // Bulk edits arrive many to a message
+        store.handle(
+            "iotcraft/worlds/w1/state/blocks/batch",
+            br#"{"player_id":"p","player_name":"P","timestamp":3,"changes":[{"Placed":{"x":2,"y":0,"z":0,"block_type":"Stone"}},{"Placed":{"x":3,"y":0,"z":0,"block_type":"Stone"}},{"Removed":{"x":1,"y":0,"z":0}}]}"#,
+        );
+        let world = store.world("w1").unwrap();
+        assert_eq!(world.block_count(), 3);
+        assert_eq!(world.block_at([1, 0, 0]), None);
+        assert_eq!(world.block_at([3, 0, 0]), Some("Stone"));
+
+        let reply = store
+            .handle(
+                "iotcraft/worlds/w1/snapshot/request",
+                br#"{"client_id":"joiner"}"#,
+            )
+            .unwrap();
+        assert_eq!(reply.topic, "iotcraft/worlds/w1/clients/joiner/data");
+        let snapshot: Value = serde_json::from_slice(&reply.payload).unwrap();
+        assert_eq!(snapshot["blocks"].as_array().unwrap().len(), 3);
+        assert_eq!(snapshot["metadata"]["name"], "test");
+        assert!(snapshot.get("inventory").is_none());
+        assert_eq!(store.stats.snapshots_served, 1);
+
+        // Unpublishing drops the world
+        store.handle("iotcraft/worlds/w1/data", b"");
+        assert!(store.world("w1").is_none());
+    }
+
+    #[test]
+    fn test_unknown_block_types_and_world_cap() {
+        let mut store = WorldStore::default();
+        store.handle(
+            "iotcraft/worlds/w1/data",
+            &world_data(&[([0, 0, 0], "Grass"), ([1, 0, 0], "Lava")]),
+        );
+        assert!(store.world("w1").is_none());
+        store.handle(
+            "iotcraft/worlds/w1/state/blocks/placed",
+            br#"{"player_id":"p","player_name":"P","timestamp":1,"change":{"Placed":{"x":1,"y":0,"z":0,"block_type":"Lava"}}}"#,
+        );
+        assert!(store.world("w1").is_none());
+        assert_eq!(store.stats.rejected, 2);
+
+        for i in 0..MAX_WORLDS + 1 {
+            store.handle(
+                &format!("iotcraft/worlds/w{}/players/p/pose", i),
+                br#"{"x":0}"#,
+            );
+        }
+        assert_eq!(store.worlds.len(), MAX_WORLDS);
+        assert!(store.world(&format!("w{}", MAX_WORLDS)).is_none());
+        assert_eq!(store.stats.rejected, 3);
+    }
+
+    #[test]
+    fn test_chunk_request_and_invalid_requests() {
+        let mut store = WorldStore::default();
+        store.handle(
+            "iotcraft/worlds/w1/data",
+            &world_data(&[([0, 0, 0], "Grass"), ([-1, 0, 0], "Stone")]),
+        );
+
+        let reply = store
+            .handle(
+                "iotcraft/worlds/w1/chunks/request",
+                br#"{"client_id":"c","chunks":[[-1,0,0],[5,5,5]]}"#,
+            )
+            .unwrap();
+        assert_eq!(reply.topic, "iotcraft/worlds/w1/clients/c/chunks");
+        let chunks: Value = serde_json::from_slice(&reply.payload).unwrap();
+        assert_eq!(chunks["chunks"][0]["blocks"][0]["block_type"], "Stone");
+        assert_eq!(chunks["chunks"][1]["blocks"].as_array().unwrap().len(), 0);
+
+        // Wildcards in the client id, unknown worlds and malformed payloads get no reply
+        assert!(
+            store
+                .handle(
+                    "iotcraft/worlds/w1/snapshot/request",
+                    br#"{"client_id":"+"}"#
+                )
+                .is_none()
+        );
+        assert!(
+            store
+                .handle(
+                    "iotcraft/worlds/w2/snapshot/request",
+                    br#"{"client_id":"c"}"#
+                )
+                .is_none()
+        );
+        assert!(store.handle("iotcraft/worlds/w1/data", b"{").is_none());
+        assert_eq!(store.stats.rejected, 1);
+    }
+
+    #[test]
+    fn test_compaction_rebuilds_only_edited_chunks() {
+        let mut store = WorldStore::default();
+        store.handle(
+            "iotcraft/worlds/w1/data",
+            &world_data(&[([0, 0, 0], "Grass"), ([40, 0, 0], "Stone")]),
+        );
+        let world = store.worlds.get_mut("w1").unwrap();
+        // The first compaction serializes every chunk of the published snapshot
+        world.set_block([1, 0, 0], "Dirt");
+        assert_eq!(world.compact(), 2);
+
+        world.set_block([41, 0, 0], "Dirt");
+        world.remove_block([40, 0, 0]);
+        assert_eq!(world.pending_edits(), 2);
+        assert_eq!(world.compact(), 1);
+        assert_eq!(world.pending_edits(), 0);
+
+        let snapshot: Value = serde_json::from_slice(&world.snapshot().unwrap()).unwrap();
+        let mut blocks: Vec<(i64, &str)> = snapshot["blocks"]
+            .as_array()
+            .unwrap()
+            .iter()
+            .map(|b| (b["x"].as_i64().unwrap(), b["block_type"].as_str().unwrap()))
+            .collect();
+        blocks.sort();
+        assert_eq!(blocks, [(0, "Grass"), (1, "Dirt"), (41, "Dirt")]);
+        assert_eq!(snapshot["player_position"][1], 2.0);
+
+        // Maintenance compacts once the policy's edit budget is used up
+        store.policy.max_edits = 2;
+        for x in 0..2 {
+            store.handle(
+                "iotcraft/worlds/w1/state/blocks/removed",
+                format!(r#"{{"change":{{"Removed":{{"x":{x},"y":0,"z":0}}}}}}"#).as_bytes(),
+            );
+        }
+        store.maintain(Instant::now());
+        assert_eq!(store.stats.compactions, 1);
+        assert_eq!(store.world("w1").unwrap().pending_edits(), 0);
+    }
+
+    #[test]
+    fn test_storage_restores_regions_and_journal() {
+        let dir = std::env::temp_dir().join(format!("iotcraft-world-state-{}", std::process::id()));
+        let _ = std::fs::remove_dir_all(&dir);
+        let policy = CompactionPolicy::default();
+
+        let mut store = WorldStore::with_storage(Storage::open(&dir).unwrap(), policy).unwrap();
+        store.handle(
+            "iotcraft/worlds/w1/data",
+            &world_data(&[([0, 0, 0], "Grass"), ([300, 0, 0], "Stone")]),
+        );
+        store.handle("iotcraft/worlds/w1/info", br#"{"world_name":"Test"}"#);
+        store.maintain(Instant::now());
+        // Journaled but not flushed
+        store.handle(
+            "iotcraft/worlds/w1/state/blocks/placed",
+            br#"{"change":{"Placed":{"x":5,"y":1,"z":5,"block_type":"Dirt"}}}"#,
+        );
+        drop(store);
+
+        let mut store = WorldStore::with_storage(Storage::open(&dir).unwrap(), policy).unwrap();
+        let world = store.world("w1").unwrap();
+        assert_eq!(world.block_count(), 3);
+        assert_eq!(world.block_at([300, 0, 0]), Some("Stone"));
+        assert_eq!(world.block_at([5, 1, 5]), Some("Dirt"));
+        assert_eq!(world.info().unwrap()["world_name"], "Test");
+        assert!(
+            store
+                .handle(
+                    "iotcraft/worlds/w1/snapshot/request",
+                    br#"{"client_id":"c"}"#
+                )
+                .is_some()
+        );
+
+        // Unpublishing removes the world from disk
+        store.handle("iotcraft/worlds/w1/info", b"");
+        assert!(!dir.join("w1").exists());
+        let _ = std::fs::remove_dir_all(&dir);
+    }
+
+    /// `data/chunk` payloads the way the desktop client splits a deflated snapshot
+    fn snapshot_parts(data: &[u8], part_size: usize) -> Vec<Vec<u8>> {
+        use std::io::Write;
+        let mut encoder =
+            flate2::write::DeflateEncoder::new(Vec::new(), flate2::Compression::fast());
+        encoder.write_all(data).unwrap();
+        let deflated = encoder.finish().unwrap();
+        let parts: Vec<&[u8]> = deflated.chunks(part_size).collect();
+        parts
+            .iter()
+            .enumerate()
+            .map(|(i, part)| {
+                serde_json::to_vec(&serde_json::json!({
+                    "chunk_id": "w1_1",
+                    "chunk_index": i,
+                    "total_chunks": parts.len(),
+                    "data": part,
+                    "world_id": "w1",
+                }))
+                .unwrap()
+            })
+            .collect()
+    }
+
+    #[test]
+    fn test_chunked_snapshot_is_reassembled() {
+        // Over the client's 5 MB single-message limit, so it would be published chunked
+        let data = synthetic_world(110);
+        assert!(data.len() > 5 * 1024 * 1024);
+        let mut parts = snapshot_parts(&data, 16 * 1024);
+        assert!(parts.len() > 2);
+
+        let mut store = WorldStore::default();
+        // Parts arrive in any order and may be repeated
+        let last = parts.remove(0);
+        for part in parts.iter().rev().chain(parts.first()) {
+            store.handle("iotcraft/worlds/w1/data/chunk", part);
+            assert!(store.world("w1").is_none());
+        }
+        store.handle("iotcraft/worlds/w1/data/chunk", &last);
+        assert_eq!(store.world("w1").unwrap().block_count(), 221 * 221 * 3);
+        assert_eq!(store.stats.rejected, 0);
+
+        let reply = store
+            .handle(
+                "iotcraft/worlds/w1/snapshot/request",
+                br#"{"client_id":"c1"}"#,
+            )
+            .unwrap();
+        assert_eq!(reply.payload.len(), data.len());
+
+        // An incomplete upload is dropped once it stalls
+        let parts = snapshot_parts(&world_data(&[([0, 0, 0], "Stone")]), 8);
+        store.handle("iotcraft/worlds/w2/data/chunk", &parts[0]);
+        store.maintain(Instant::now() + SNAPSHOT_ASSEMBLY_TIMEOUT);
+        for part in &parts[1..] {
+            store.handle("iotcraft/worlds/w2/data/chunk", part);
+        }
+        assert!(store.world("w2").is_none());
+    }
+
+    #[test]
+    fn test_bench_joins_serves_every_join() {
+        let bench = bench_joins(4, 8);
+        assert_eq!(bench.blocks, 9 * 9 * 3);
+        assert!(bench.snapshot_bytes > 0);
+        assert!(bench.chunk_bytes > 0);
+        assert!(bench.threads >= 1);
+        assert!(bench.report().contains("8 joins"));
+    }
+}
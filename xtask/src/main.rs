@@ -159,6 +159,20 @@ enum Commands {
         #[command(subcommand)]
         action: GithubAction,
     },
+    /// Run the headless desktop client benchmarks and compare against a baseline
+    Bench {
+        /// Save the results as a named baseline
+        #[arg(long)]
+        save_baseline: Option<String>,
+        /// Compare against a previously saved baseline and fail on regressions
+        #[arg(long)]
+        baseline: Option<String>,
+        /// Largest allowed slowdown of a benchmark's mean, in percent
+        #[arg(long, default_value = "10")]
+        max_regression: f64,
+        /// Only run benchmarks whose name matches this filter
+        filter: Option<String>,
+    },
 }
 
 #[derive(Deserialize)]
@@ -219,11 +233,158 @@ fn main() -> Result<()> {
         Commands::Github { action } => {
             handle_github_action(action)?;
         }
+        Commands::Bench {
+            save_baseline,
+            baseline,
+            max_regression,
+            filter,
+        } => {
+            run_benchmarks(
+                save_baseline.as_deref(),
+                baseline.as_deref(),
+                *max_regression,
+                filter.as_deref(),
+            )?;
+        }
+    }
+
+    Ok(())
+}
+
+/// Run the desktop client's Criterion benchmarks, optionally saving or checking a baseline
+fn run_benchmarks(
+    save_baseline: Option<&str>,
+    baseline: Option<&str>,
+    max_regression: f64,
+    filter: Option<&str>,
+) -> Result<()> {
+    println!("⏱️  Running desktop client benchmarks...");
+
+    let mut cmd = Command::new("cargo");
+    cmd.args(&[
+        "bench",
+        "-p",
+        "iotcraft-dekstop-client",
+        "--bench",
+        "hot_paths",
+        "--",
+    ]);
+    if let Some(filter) = filter {
+        cmd.arg(filter);
+    }
+    if let Some(name) = save_baseline {
+        cmd.args(&["--save-baseline", name]);
+        println!("   Saving baseline: {}", name);
+    }
+    if let Some(name) = baseline {
+        cmd.args(&["--baseline", name]);
+        println!("   Comparing against baseline: {}", name);
+    }
+
+    let status = cmd.status().context("Failed to run cargo bench")?;
+    if !status.success() {
+        return Err(anyhow::anyhow!("Benchmarks failed"));
+    }
+
+    let Some(baseline) = baseline else {
+        println!("✅ Benchmarks complete");
+        return Ok(());
+    };
+
+    let criterion_dir = criterion_output_dir()?;
+    let mut changes = Vec::new();
+    collect_benchmark_changes(&criterion_dir, &criterion_dir, baseline, &mut changes)?;
+    if changes.is_empty() {
+        return Err(anyhow::anyhow!(
+            "No results for baseline '{}' found in {}",
+            baseline,
+            criterion_dir.display()
+        ));
+    }
+    changes.sort_by(|a, b| b.1.total_cmp(&a.1));
+
+    println!();
+    println!("📊 Change in mean time against baseline '{}':", baseline);
+    let mut regressions = 0;
+    for (name, change) in &changes {
+        let marker = if *change > max_regression {
+            regressions += 1;
+            "❌"
+        } else {
+            "  "
+        };
+        println!("{} {:>+8.2}%  {}", marker, change, name);
+    }
+
+    if regressions > 0 {
+        return Err(anyhow::anyhow!(
+            "{} benchmark(s) regressed by more than {}%",
+            regressions,
+            max_regression
+        ));
+    }
+    println!("✅ No benchmark regressed by more than {}%", max_regression);
+    Ok(())
+}
+
+/// Where Criterion writes its results (same lookup order as Criterion itself)
+fn criterion_output_dir() -> Result<PathBuf> {
+    if let Some(home) = std::env::var_os("CRITERION_HOME") {
+        return Ok(PathBuf::from(home));
+    }
+    if let Some(target) = std::env::var_os("CARGO_TARGET_DIR") {
+        return Ok(PathBuf::from(target).join("criterion"));
+    }
+    let output = Command::new("cargo")
+        .args(&["metadata", "--format-version", "1", "--no-deps"])
+        .output()
+        .context("Failed to run cargo metadata")?;
+    let metadata: serde_json::Value =
+        serde_json::from_slice(&output.stdout).context("Failed to parse cargo metadata")?;
+    let target = metadata["target_directory"]
+        .as_str()
+        .context("cargo metadata has no target_directory")?;
+    Ok(Path::new(target).join("criterion"))
+}
+
+/// Percent change of each benchmark's mean between `baseline` and the latest run
+fn collect_benchmark_changes(
+    root: &Path,
+    dir: &Path,
+    baseline: &str,
+    changes: &mut Vec<(String, f64)>,
+) -> Result<()> {
+    let new = dir.join("new").join("estimates.json");
+    let old = dir.join(baseline).join("estimates.json");
+    if new.exists() && old.exists() {
+        let new_mean = read_mean_estimate(&new)?;
+        let old_mean = read_mean_estimate(&old)?;
+        if old_mean > 0.0 {
+            let name = dir.strip_prefix(root).unwrap_or(dir).display().to_string();
+            changes.push((name, (new_mean / old_mean - 1.0) * 100.0));
+        }
+        return Ok(());
     }
 
+    for entry in fs::read_dir(dir).with_context(|| format!("Failed to read {}", dir.display()))? {
+        let path = entry?.path();
+        if path.is_dir() && path.file_name().map_or(false, |n| n != "report") {
+            collect_benchmark_changes(root, &path, baseline, changes)?;
+        }
+    }
     Ok(())
 }
 
+fn read_mean_estimate(path: &Path) -> Result<f64> {
+    let content =
+        fs::read_to_string(path).with_context(|| format!("Failed to read {}", path.display()))?;
+    let estimates: serde_json::Value = serde_json::from_str(&content)
+        .with_context(|| format!("Failed to parse {}", path.display()))?;
+    estimates["mean"]["point_estimate"]
+        .as_f64()
+        .with_context(|| format!("No mean estimate in {}", path.display()))
+}
+
 /// Run comprehensive tests across workspace components
 fn run_tests(
     mode: &TestMode,
@@ -1191,7 +1352,12 @@ fn serve_web(port: u16, serve_dir_name: &str) -> Result<()> {
     println!();
 
     // Check if required files exist
-    let required_files = ["index.html", "iotcraft_web.js", "iotcraft_web_bg.wasm"];
+    let required_files = [
+        "index.html",
+        "world_worker.js",
+        "iotcraft_web.js",
+        "iotcraft_web_bg.wasm",
+    ];
     for file in &required_files {
         if !web_dir.join(file).exists() {
             return Err(anyhow::anyhow!(